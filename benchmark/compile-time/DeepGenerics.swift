@@ -0,0 +1,84 @@
+//===--- DeepGenerics.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Nested generic types with associated type constraints, which stress
+// generic signature building, substitution and specialization.
+
+public protocol Container {
+  associatedtype Element
+  var first: Element { get }
+  func map<T>(_ f: (Element) -> T) -> Wrap<T>
+}
+
+public struct Wrap<T> : Container {
+  public var first: T
+  public init(_ value: T) { first = value }
+  public func map<U>(_ f: (T) -> U) -> Wrap<U> { return Wrap<U>(f(first)) }
+}
+
+public struct Pair<A : Container, B : Container> : Container
+    where A.Element == B.Element {
+  public var a: A
+  public var b: B
+  public init(_ a: A, _ b: B) { self.a = a; self.b = b }
+  public var first: A.Element { return a.first }
+  public func map<T>(_ f: (A.Element) -> T) -> Wrap<T> {
+    return Wrap<T>(f(b.first))
+  }
+}
+
+public struct Zip<A : Container, B : Container> : Container {
+  public var a: A
+  public var b: B
+  public init(_ a: A, _ b: B) { self.a = a; self.b = b }
+  public var first: (A.Element, B.Element) { return (a.first, b.first) }
+  public func map<T>(_ f: ((A.Element, B.Element)) -> T) -> Wrap<T> {
+    return Wrap<T>(f(first))
+  }
+}
+
+public func pair<A : Container, B : Container>(_ a: A, _ b: B) -> Pair<A, B>
+    where A.Element == B.Element {
+  return Pair(a, b)
+}
+
+public func zip<A : Container, B : Container>(_ a: A, _ b: B) -> Zip<A, B> {
+  return Zip(a, b)
+}
+
+public func deep<T>(_ x: T) -> Wrap<((((T, T), (T, T)), ((T, T), (T, T))), T)> {
+  let w = Wrap(x)
+  let z1 = zip(w, w)
+  let z2 = zip(z1, z1)
+  let z3 = zip(z2, z2)
+  return zip(z3, pair(w, w)).map { $0 }
+}
+
+public func deepInt() -> Int {
+  let d = deep(1)
+  let p = pair(pair(Wrap(1), Wrap(2)), pair(Wrap(3), Wrap(4)))
+  let q = zip(zip(d, p), zip(p, d))
+  return q.first.0.first.1 + q.first.1.first.first
+}
+
+public func deepString() -> String {
+  let d = deep("a")
+  let z = zip(zip(zip(d, d), zip(d, d)), zip(zip(d, d), zip(d, d)))
+  return z.first.0.0.first.1 + z.map { $0.1.1.first.1 }.first
+}
+
+public func deepArrays() -> [[Int]] {
+  let d = deep([1, 2, 3])
+  let z = zip(zip(d, Wrap([4])), zip(Wrap([5]), d))
+  return [z.first.0.0.first.1, z.first.1.0, z.first.0.1] +
+         z.map { [$0.1.1.first.1, $0.0.1] }.first
+}
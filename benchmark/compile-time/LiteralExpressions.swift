@@ -0,0 +1,51 @@
+//===--- LiteralExpressions.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Literal-heavy expressions with overloaded operators and no type
+// annotations, which stress the constraint solver.
+
+public func mixedArithmetic(_ x: Double, _ y: Int) -> Double {
+  let a = 1 + 2.0 * 3 - 4 / 5.0 + 6 * 7 - 8.0
+  let b = (x + 1) * (x - 2) / (x + 3) + (x - 4) * 5 + 6 * x - 7.5
+  let c = Double(y) * 0.5 + Double(y + 1) * 0.25 - Double(y - 1) * 0.125
+  return a + b * c - (a - b) / (c + 1) + -a * -b + (1 - 2 + 3 - 4 + 5.0)
+}
+
+public func nestedCollections() -> [String: [[Double]]] {
+  return [
+    "a": [[1, 2.5, 3], [4, 5, 6.5], [7, 8, 9]],
+    "b": [[1.5, 2, 3], [4, 5.5, 6], [7, 8.5, 9], [10, 11, 12]],
+    "c": [[1, 2, 3.5], [4, 5, 6], [7.5, 8, 9], [10, 11, 12.5], [13, 14, 15]],
+    "d": [[0.5], [1, 2], [3, 4.5, 5], [6, 7, 8, 9.5]],
+  ]
+}
+
+public func tuples() -> [(Int, Double, String, [Int])] {
+  return [
+    (1, 2, "three", [4, 5]), (6, 7.5, "eight", [9]), (10, 11, "twelve", []),
+    (13, 14, "fifteen", [16, 17, 18]), (19, 20.5, "twenty-one", [22]),
+    (23, 24, "twenty-five", [26, 27]), (28, 29, "thirty", [31, 32, 33]),
+  ]
+}
+
+public func closures(_ values: [Int]) -> [Double] {
+  return values.map { $0 * 2 + 1 }
+               .filter { $0 % 3 != 0 }
+               .map { Double($0) / 2 + 0.5 }
+               .map { $0 * $0 - 1 }
+               .sorted { $0 > $1 }
+}
+
+public func strings(_ n: Int) -> String {
+  return "a" + String(n) + "b" + String(n * 2) + "c" + String(n + 3) +
+         "d" + String(n - 4) + "e" + String(n / 5) + "f" + String(n % 6)
+}
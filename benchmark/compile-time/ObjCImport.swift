@@ -0,0 +1,69 @@
+//===--- ObjCImport.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Uses of many imported Objective-C types and members, which stress the
+// Clang importer and member lookup in imported modules.
+
+import Foundation
+
+public func formatDate(_ interval: TimeInterval) -> String {
+  let formatter = DateFormatter()
+  formatter.dateStyle = .medium
+  formatter.timeStyle = .short
+  formatter.locale = Locale(identifier: "en_US_POSIX")
+  return formatter.string(from: Date(timeIntervalSince1970: interval))
+}
+
+public func parseJSON(_ text: String) -> [String: Any]? {
+  guard let data = text.data(using: .utf8) else { return nil }
+  let object = try? JSONSerialization.jsonObject(with: data, options: [])
+  return object as? [String: Any]
+}
+
+public func files(in directory: String) -> [URL] {
+  let manager = FileManager.default
+  let url = URL(fileURLWithPath: directory, isDirectory: true)
+  let contents = try? manager.contentsOfDirectory(
+    at: url, includingPropertiesForKeys: [.fileSizeKey, .isDirectoryKey],
+    options: [.skipsHiddenFiles])
+  return (contents ?? []).sorted { $0.lastPathComponent < $1.lastPathComponent }
+}
+
+public func attributes(_ string: String) -> NSAttributedString {
+  let result = NSMutableAttributedString(string: string)
+  let range = NSRange(location: 0, length: (string as NSString).length)
+  result.addAttribute("Link", value: URL(string: "http://swift.org")!,
+                      range: range)
+  return result
+}
+
+public func notify(_ name: String) {
+  let center = NotificationCenter.default
+  let observer = center.addObserver(
+    forName: Notification.Name(name), object: nil, queue: OperationQueue.main) {
+      print($0.userInfo ?? [:])
+  }
+  center.post(name: Notification.Name(name), object: nil,
+              userInfo: ["time": ProcessInfo.processInfo.systemUptime])
+  center.removeObserver(observer)
+}
+
+public func scan(_ text: String) -> [Double] {
+  let scanner = Scanner(string: text)
+  scanner.charactersToBeSkipped = CharacterSet.whitespacesAndNewlines
+  var values: [Double] = []
+  var value = 0.0
+  while scanner.scanDouble(&value) {
+    values.append(value)
+  }
+  return values
+}
@@ -15,6 +15,8 @@
 
 import argparse
 import csv
+import json
+import math
 import sys
 
 TESTNAME = 1
@@ -74,6 +76,90 @@ PAIN_DETAIL = """
 RATIO_MIN = None
 RATIO_MAX = None
 
+# Two-sided critical values of Student's t distribution at the 95% level, by
+# degrees of freedom. Larger degrees of freedom use the normal distribution.
+T_CRITICAL_95 = [12.71, 4.30, 3.18, 2.78, 2.57, 2.45, 2.36, 2.31, 2.26, 2.23,
+                 2.20, 2.18, 2.16, 2.14, 2.13, 2.12, 2.11, 2.10, 2.09, 2.09,
+                 2.08, 2.07, 2.07, 2.06, 2.06, 2.06, 2.05, 2.05, 2.05, 2.04]
+
+# The number of runs per benchmark kept in the noise history.
+NOISE_HISTORY_LENGTH = 20
+
+
+def add_sample_stats(stats, row):
+    """
+    Add the sample count, mean and standard deviation of a result row to the
+    (count, mean, variance) of all runs of the test in `stats`
+    """
+    count, mean, sd = int(row[SAMPLES]), float(row[MEAN]), float(row[SD])
+    if row[TESTNAME] not in stats:
+        stats[row[TESTNAME]] = (count, mean, sd * sd)
+        return
+    old_count, old_mean, old_variance = stats[row[TESTNAME]]
+    total = old_count + count
+    new_mean = (old_count * old_mean + count * mean) / total
+    new_variance = ((old_count * (old_variance + (old_mean - new_mean) ** 2) +
+                     count * (sd * sd + (mean - new_mean) ** 2)) / total)
+    stats[row[TESTNAME]] = (total, new_mean, new_variance)
+
+
+def is_significant(old_stats, new_stats):
+    """
+    Returns whether the means of two results differ significantly according to
+    Welch's t-test at the 95% level. Results without a sample variance are
+    always considered significant.
+    """
+    if old_stats is None or new_stats is None:
+        return True
+    (n1, m1, v1), (n2, m2, v2) = old_stats, new_stats
+    if n1 < 2 or n2 < 2 or (v1 == 0 and v2 == 0):
+        return True
+    se1, se2 = v1 / n1, v2 / n2
+    t = abs(m1 - m2) / math.sqrt(se1 + se2)
+    df = (se1 + se2) ** 2 / (se1 ** 2 / (n1 - 1) + se2 ** 2 / (n2 - 1))
+    df = int(df)
+    critical = T_CRITICAL_95[df - 1] if 1 <= df <= len(T_CRITICAL_95) \
+        else 1.96
+    return t > critical
+
+
+def read_noise_history(file_name):
+    """
+    Returns the noise history: a dict of the relative standard deviations of
+    the previous runs of each test.
+    """
+    try:
+        with open(file_name) as f:
+            return json.load(f)
+    except (IOError, ValueError):
+        return {}
+
+
+def update_noise_history(file_name, history, stats):
+    """
+    Add the relative standard deviations of the results in `stats` to the
+    noise history and write it to `file_name`.
+    """
+    for key, (count, mean, variance) in stats.items():
+        if count < 2 or mean <= 0:
+            continue
+        noise = history.setdefault(key, [])
+        noise.append(round(math.sqrt(variance) / mean, 4))
+        del noise[:-NOISE_HISTORY_LENGTH]
+    with open(file_name, 'w') as f:
+        json.dump(history, f, indent=2, sort_keys=True)
+
+
+def noise_threshold(history, key, threshold, factor):
+    """
+    Returns the relative delta threshold of a test: the given threshold, or
+    `factor` times the median noise of its previous runs if that is larger.
+    """
+    noise = sorted(history.get(key, []))
+    if not noise:
+        return threshold
+    return max(threshold, factor * noise[len(noise) // 2])
+
 
 def main():
     global RATIO_MIN
@@ -110,6 +196,17 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--no-significance-test',
+                        help='Report all changes above the delta threshold, '
+                        'even if they are not statistically significant',
+                        action='store_true')
+    parser.add_argument('--noise-history',
+                        help='JSON file with the noise of previous runs of '
+                        'each test, which raises the delta threshold of '
+                        'noisy tests. It is updated with the new results.')
+    parser.add_argument('--noise-factor',
+                        help='multiple of the median noise of a test which '
+                        'its delta must exceed', default="2")
 
     args = parser.parse_args()
 
@@ -125,8 +222,12 @@ def main():
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
 
+    old_stats = {}
+    new_stats = {}
+
     for row in old_data:
         if (len(row) > 7 and row[MIN].isdigit()):
+            add_sample_stats(old_stats, row)
             if row[TESTNAME] in old_results:
                 if old_results[row[TESTNAME]] > int(row[MIN]):
                     old_results[row[TESTNAME]] = int(row[MIN])
@@ -138,6 +239,7 @@ def main():
 
     for row in new_data:
         if (len(row) > 7 and row[MIN].isdigit()):
+            add_sample_stats(new_stats, row)
             if row[TESTNAME] in new_results:
                 if int(new_results[row[TESTNAME]]) > int(row[MIN]):
                     new_results[row[TESTNAME]] = int(row[MIN])
@@ -147,8 +249,22 @@ def main():
                 new_results[row[TESTNAME]] = int(row[MIN])
                 new_max_results[row[TESTNAME]] = int(row[MAX])
 
+    noise_history = {}
+    if args.noise_history:
+        noise_history = read_noise_history(args.noise_history)
+    noise_factor = float(args.noise_factor)
+
+    significant = {}
+    thresholds = {}
     ratio_total = 0
     for key in new_results.keys():
+            significant[key] = (args.no_significance_test or
+                                is_significant(old_stats.get(key),
+                                               new_stats.get(key)))
+            threshold = noise_threshold(noise_history, key,
+                                        float(args.delta_threshold),
+                                        noise_factor)
+            thresholds[key] = (1 - threshold, 1 + threshold)
             ratio = (old_results[key] + 0.001) / (new_results[key] + 0.001)
             ratio_list[key] = round(ratio, 2)
             ratio_total *= ratio
@@ -160,13 +276,19 @@ def main():
                 (new_results[key] < old_results[key] and
                     old_results[key] < new_max_results[key])):
                     unknown_list[key] = "(?)"
+            elif not significant[key]:
+                    unknown_list[key] = "(?)"
             else:
                     unknown_list[key] = ""
 
+    if args.noise_history:
+        update_noise_history(args.noise_history, noise_history, new_stats)
+
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only,
+                                         significant, thresholds)
 
     """
     Create markdown formatted table
@@ -254,7 +376,8 @@ def main():
             """
             html_data = convert_to_html(ratio_list, old_results, new_results,
                                         delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+                                        new_branch, args.changes_only,
+                                        significant, thresholds)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -270,17 +393,19 @@ def main():
 
 
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+                    unknown_list, old_branch, new_branch, changes_only,
+                    significant=None, thresholds=None):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, changes_only,
+                                         significant, thresholds)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in decreased_perf_list:
             color = "red"
-        elif ratio_list[key] > RATIO_MAX:
+        elif key in increased_perf_list:
             color = "green"
         else:
             color = "black"
@@ -319,9 +444,12 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def sort_ratio_list(ratio_list, changes_only=False, significant=None,
+                    thresholds=None):
     """
     Return 3 sorted list improvement, regression and normal.
+    Changes which are not significant, or below the threshold of their test,
+    count as normal.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -329,9 +457,13 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        ratio_min, ratio_max = (thresholds or {}).get(key,
+                                                     (RATIO_MIN, RATIO_MAX))
+        if significant is not None and not significant.get(key, True):
+            normal_perf_list[key] = v
+        elif ratio_list[key] < ratio_min:
             decreased_perf_list.append(key)
-        elif ratio_list[key] > RATIO_MAX:
+        elif ratio_list[key] > ratio_max:
             increased_perf_list.append(key)
         else:
             normal_perf_list[key] = v
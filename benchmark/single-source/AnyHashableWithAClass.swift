@@ -14,6 +14,8 @@
 // upcast the instance to the type that introduces the Hashable
 // conformance.
 
+import TestsUtils
+
 class TestHashableBase : Hashable {
   var value: Int
   init(_ value: Int) {
@@ -44,3 +46,27 @@ public func run_AnyHashableWithAClass(_ N: Int) {
   }
 }
 
+
+@inline(never)
+func makeAnyHashable<T : Hashable>(_ value: T) -> AnyHashable {
+  return AnyHashable(value)
+}
+
+// Builds the keys from a generic context and looks them up in a dictionary
+// keyed by AnyHashable, which hashes and compares through the boxed
+// Hashable conformance.
+@inline(never)
+public func run_AnyHashableWithAClassInDictionary(_ N: Int) {
+  var d = [AnyHashable: Int]()
+  for i in 0..<100 {
+    d[makeAnyHashable(TestHashableDerived5(i))] = i
+  }
+  var sum = 0
+  for _ in 0...(N*5000) {
+    for i in 0..<100 {
+      sum += d[makeAnyHashable(TestHashableDerived5(i))]!
+    }
+  }
+  CheckResults(sum == 4950 * (N*5000 + 1),
+               "Incorrect results in AnyHashableWithAClassInDictionary")
+}
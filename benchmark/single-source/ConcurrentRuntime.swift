@@ -0,0 +1,295 @@
+//===--- ConcurrentRuntime.swift ------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These benchmarks measure how the runtime entry points scale with the number
+// of threads which call them at the same time. Each iteration does the same
+// total amount of work, split evenly across 1, 2, 4 or 8 threads, so on a
+// machine with enough cores a runtime path without contention shows a time
+// which goes down with the thread count, and a contended one a time which
+// stays flat or goes up.
+
+import Darwin
+import TestsUtils
+
+final class ThreadBody {
+  let index: Int
+  let body: (Int) -> ()
+  init(index: Int, body: @escaping (Int) -> ()) {
+    self.index = index
+    self.body = body
+  }
+}
+
+/// Run `body` on `numThreads` threads at once, passing each its index, and
+/// wait for all of them.
+func runOnThreads(_ numThreads: Int, _ body: @escaping (Int) -> ()) {
+  var threads = [pthread_t?](repeating: nil, count: numThreads)
+  for i in 0..<numThreads {
+    let context = Unmanaged.passRetained(ThreadBody(index: i, body: body))
+    let result = pthread_create(&threads[i], nil, { context in
+      let threadBody =
+        Unmanaged<ThreadBody>.fromOpaque(context).takeRetainedValue()
+      threadBody.body(threadBody.index)
+      return nil
+    }, context.toOpaque())
+    CheckResults(result == 0, "pthread_create failed: \(result)")
+  }
+  for thread in threads {
+    pthread_join(thread!, nil)
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Retain and release of one object shared by all threads
+//===----------------------------------------------------------------------===//
+
+final class SharedObject {}
+
+let retainReleaseCount = 400_000
+
+@inline(never)
+func retainRelease(_ object: SharedObject, _ count: Int) {
+  let unmanaged = Unmanaged.passUnretained(object)
+  for _ in 0..<count {
+    _ = unmanaged.retain()
+    unmanaged.release()
+  }
+}
+
+@inline(never)
+func concurrentRetainRelease(_ N: Int, threads: Int) {
+  let object = SharedObject()
+  for _ in 0..<N {
+    runOnThreads(threads) { _ in
+      retainRelease(object, retainReleaseCount / threads)
+    }
+  }
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease1(_ N: Int) {
+  concurrentRetainRelease(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease2(_ N: Int) {
+  concurrentRetainRelease(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease4(_ N: Int) {
+  concurrentRetainRelease(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentRetainRelease8(_ N: Int) {
+  concurrentRetainRelease(N, threads: 8)
+}
+
+//===----------------------------------------------------------------------===//
+// Generic metadata lookups
+//===----------------------------------------------------------------------===//
+
+final class Box<T> {
+  var value: T
+  init(_ value: T) { self.value = value }
+}
+
+protocol MetadataSource {}
+
+extension MetadataSource {
+  /// Since Self is only known at runtime when this is called through an
+  /// existential metatype, the metadata of Box<Self> is looked up in the
+  /// runtime's generic metadata cache on every call.
+  static func boxType() -> Any.Type {
+    return Box<Self>.self
+  }
+}
+
+struct M0 : MetadataSource {}
+struct M1 : MetadataSource {}
+struct M2 : MetadataSource {}
+struct M3 : MetadataSource {}
+struct M4 : MetadataSource {}
+struct M5 : MetadataSource {}
+struct M6 : MetadataSource {}
+struct M7 : MetadataSource {}
+
+let metadataSources: [MetadataSource.Type] = [
+  M0.self, M1.self, M2.self, M3.self, M4.self, M5.self, M6.self, M7.self
+]
+
+let metadataLookupCount = 200_000
+
+@inline(never)
+func lookupMetadata(_ sources: [MetadataSource.Type], _ count: Int) -> Int {
+  var found = 0
+  for i in 0..<count {
+    if sources[i & 7].boxType() != Int.self {
+      found += 1
+    }
+  }
+  return found
+}
+
+@inline(never)
+func concurrentMetadataLookup(_ N: Int, threads: Int) {
+  for _ in 0..<N {
+    runOnThreads(threads) { _ in
+      let count = metadataLookupCount / threads
+      CheckResults(lookupMetadata(metadataSources, count) == count,
+                   "unexpected metadata")
+    }
+  }
+}
+
+@inline(never)
+public func run_ConcurrentMetadataLookup1(_ N: Int) {
+  concurrentMetadataLookup(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentMetadataLookup2(_ N: Int) {
+  concurrentMetadataLookup(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentMetadataLookup4(_ N: Int) {
+  concurrentMetadataLookup(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentMetadataLookup8(_ N: Int) {
+  concurrentMetadataLookup(N, threads: 8)
+}
+
+//===----------------------------------------------------------------------===//
+// Dynamic casts to a protocol
+//===----------------------------------------------------------------------===//
+
+protocol CastTarget {
+  var castValue: Int { get }
+}
+
+struct Conforming0 : CastTarget { var castValue: Int { return 1 } }
+struct Conforming1 : CastTarget { var castValue: Int { return 1 } }
+struct Conforming2 : CastTarget { var castValue: Int { return 1 } }
+struct Conforming3 : CastTarget { var castValue: Int { return 1 } }
+struct NotConforming0 {}
+struct NotConforming1 {}
+struct NotConforming2 {}
+struct NotConforming3 {}
+
+let castValues: [Any] = [
+  Conforming0(), NotConforming0(), Conforming1(), NotConforming1(),
+  Conforming2(), NotConforming2(), Conforming3(), NotConforming3()
+]
+
+let protocolCastCount = 200_000
+
+@inline(never)
+func castToProtocol(_ values: [Any], _ count: Int) -> Int {
+  var sum = 0
+  for i in 0..<count {
+    if let target = values[i & 7] as? CastTarget {
+      sum += target.castValue
+    }
+  }
+  return sum
+}
+
+@inline(never)
+func concurrentProtocolCast(_ N: Int, threads: Int) {
+  for _ in 0..<N {
+    runOnThreads(threads) { _ in
+      let count = protocolCastCount / threads
+      CheckResults(castToProtocol(castValues, count) == count / 2,
+                   "unexpected cast results")
+    }
+  }
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast1(_ N: Int) {
+  concurrentProtocolCast(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast2(_ N: Int) {
+  concurrentProtocolCast(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast4(_ N: Int) {
+  concurrentProtocolCast(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentProtocolCast8(_ N: Int) {
+  concurrentProtocolCast(N, threads: 8)
+}
+
+//===----------------------------------------------------------------------===//
+// Allocation of short-lived objects
+//===----------------------------------------------------------------------===//
+
+final class Allocated {
+  var value: Int
+  init(_ value: Int) { self.value = value }
+}
+
+let allocationCount = 200_000
+
+@inline(never)
+func allocate(_ value: Int) -> Allocated {
+  return Allocated(value)
+}
+
+@inline(never)
+func allocateMany(_ count: Int) -> Int {
+  var sum = 0
+  for i in 0..<count {
+    sum += allocate(i & 1).value
+  }
+  return sum
+}
+
+@inline(never)
+func concurrentAllocation(_ N: Int, threads: Int) {
+  for _ in 0..<N {
+    runOnThreads(threads) { _ in
+      let count = allocationCount / threads
+      CheckResults(allocateMany(count) == count / 2,
+                   "unexpected allocation results")
+    }
+  }
+}
+
+@inline(never)
+public func run_ConcurrentAllocation1(_ N: Int) {
+  concurrentAllocation(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation2(_ N: Int) {
+  concurrentAllocation(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation4(_ N: Int) {
+  concurrentAllocation(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentAllocation8(_ N: Int) {
+  concurrentAllocation(N, threads: 8)
+}
@@ -0,0 +1,49 @@
+//===--- FloatingPointPrinting.swift --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks performance of converting floating point values to String.
+// It covers the integers and short decimals that are printed without printf,
+// as well as values that need all of their digits.
+import TestsUtils
+
+@inline(never)
+func getDescriptionLength<T : CustomStringConvertible>(_ values: [T]) -> Int {
+  var length = 0
+  for value in values {
+    length += value.description.utf8.count
+  }
+  return length
+}
+
+@inline(never)
+public func run_FloatingPointPrinting(_ N: Int) {
+  var doubles: [Double] = []
+  var floats: [Float] = []
+  for i in 0..<100 {
+    doubles.append(Double(i * 1_000))             // integers
+    doubles.append(Double(i) / 8 + 0.25)          // short decimals
+    doubles.append(Double(i) * 0.1 + 1.0 / 3.0)   // full precision
+    floats.append(Float(i) / 4)
+    floats.append(Float(i) / 3)
+  }
+  let ref_result = getDescriptionLength(doubles) + getDescriptionLength(floats)
+
+  var result = 0
+  for _ in 1...100*N {
+    result = getDescriptionLength(doubles) + getDescriptionLength(floats)
+    if result != ref_result {
+      break
+    }
+  }
+  CheckResults(result == ref_result,
+               "IncorrectResults in FloatingPointPrinting: \(result) != \(ref_result)")
+}
@@ -0,0 +1,43 @@
+//===--- IntToStr.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks performance of Int to String conversion, the counterpart
+// of StrToInt.
+import TestsUtils
+
+@inline(never)
+public func run_IntToStr(_ N: Int) {
+  // 64 numbers of increasing magnitude, half of them negative.
+  var input: [Int] = []
+  var magnitude = 7
+  for i in 0..<64 {
+    input.append(i % 2 == 0 ? magnitude : -magnitude)
+    magnitude = magnitude &* 3 &+ i
+    if magnitude < 0 { magnitude = 7 }
+  }
+  func DoOneIter(_ arr: [Int]) -> Int {
+    var r = 0
+    for n in arr {
+      r += String(n).utf8.count
+    }
+    return r
+  }
+  let ref_result = DoOneIter(input)
+  var res = 0
+  for _ in 1...1000*N {
+    res = DoOneIter(input)
+    if res != ref_result {
+      break
+    }
+  }
+  CheckResults(res == ref_result, "IncorrectResults in IntToStr: \(res) != \(ref_result)")
+}
@@ -0,0 +1,60 @@
+//===--- MirrorChildren.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test visits all of the children of structs and classes with many
+// fields through Mirror, the way a generic serializer does.
+import TestsUtils
+
+struct Record {
+  var id = 1
+  var name = "record"
+  var enabled = true
+  var score = 2.5
+  var count = 3
+  var label = "label"
+  var width = 4
+  var height = 5
+  var depth = 6
+  var weight = 7.5
+  var visible = false
+  var tag = "tag"
+}
+
+final class RecordBox {
+  var first = Record()
+  var second = Record()
+  var index = 0
+  var note = "note"
+}
+
+@inline(never)
+func countNamedChildren(_ value: Any) -> Int {
+  var count = 0
+  for child in Mirror(reflecting: value).children {
+    if let label = child.label {
+      count += label.utf8.count
+      count += countNamedChildren(child.value)
+    }
+  }
+  return count
+}
+
+@inline(never)
+public func run_MirrorChildren(_ N: Int) {
+  let box = RecordBox()
+  var count = 0
+  for _ in 1...N*100 {
+    count += countNamedChildren(box)
+  }
+  CheckResults(count == N*100*(5 + 6 + 5 + 4 + 2*60),
+               "IncorrectResults in MirrorChildren")
+}
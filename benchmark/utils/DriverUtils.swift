@@ -12,6 +12,28 @@
 
 import Darwin
 
+/// Event counts of one iteration of a benchmark, see --counters.
+struct BenchCounters {
+  var instructions: UInt64 = 0
+  var cycles: UInt64 = 0
+  var branchMisses: UInt64 = 0
+  var cacheMisses: UInt64 = 0
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+  var allocations: UInt64 = 0
+
+  /// The names of the counter columns in the output.
+  static let columns = [
+    "INSTRUCTIONS", "CYCLES", "BRANCH_MISSES", "CACHE_MISSES",
+    "RETAINS", "RELEASES", "ALLOCS"
+  ]
+
+  var values: [UInt64] {
+    return [instructions, cycles, branchMisses, cacheMisses,
+            retains, releases, allocations]
+  }
+}
+
 struct BenchResults {
   var delim: String  = ","
   var sampleCount: UInt64 = 0
@@ -20,6 +42,7 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  var counters: BenchCounters? = nil
   init() {}
   init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
     self.delim = delim
@@ -41,7 +64,13 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     var result = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     if let counters = counters {
+       for value in counters.values {
+         result += "\(delim)\(value)"
+       }
+     }
+     return result
   }
 }
 
@@ -88,6 +117,21 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// The number of unmeasured runs of each test before its samples are
+  /// taken, to warm up caches and let lazy initialization happen.
+  var numWarmups: Int = 1
+
+  /// The time in milliseconds that each sample should take, if the number of
+  /// iterations is not fixed.
+  var sampleTime: UInt64 = 1000
+
+  /// Should samples which are outliers be dropped before computing the
+  /// results?
+  var rejectOutliers: Bool = false
+
+  /// Should hardware and runtime event counts be reported for each test?
+  var collectCounters: Bool = false
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -103,7 +147,8 @@ struct TestConfig {
 
   mutating func processArguments() -> TestAction {
     let validOptions = [
-      "--iter-scale", "--num-samples", "--num-iters",
+      "--iter-scale", "--num-samples", "--num-iters", "--num-warmups",
+      "--sample-time", "--reject-outliers", "--counters",
       "--verbose", "--delim", "--run-all", "--list", "--sleep"
     ]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
@@ -131,6 +176,26 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--num-warmups"] {
+      if x.isEmpty { return .Fail("--num-warmups requires a value") }
+      numWarmups = Int(x)!
+    }
+
+    if let x = benchArgs.optionalArgsMap["--sample-time"] {
+      guard let v = UInt64(x), v > 0 else {
+        return .Fail("--sample-time requires a positive number of milliseconds")
+      }
+      sampleTime = v
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--reject-outliers"] {
+      rejectOutliers = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--counters"] {
+      collectCounters = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -217,6 +282,22 @@ func internalMedian(_ inputs: [UInt64]) -> UInt64 {
   return inputs.sorted()[inputs.count / 2]
 }
 
+/// Returns the samples of \p inputs which are within Tukey's fences, i.e. at
+/// most 1.5 interquartile ranges outside of the first and third quartiles.
+func internalRejectOutliers(_ inputs: [UInt64]) -> [UInt64] {
+  // With fewer samples the quartiles are not meaningful.
+  if inputs.count < 4 {
+    return inputs
+  }
+  let sorted = inputs.sorted()
+  let q1 = Double(sorted[sorted.count / 4])
+  let q3 = Double(sorted[(sorted.count * 3) / 4])
+  let iqr = q3 - q1
+  let lower = q1 - 1.5 * iqr
+  let upper = q3 + 1.5 * iqr
+  return sorted.filter { Double($0) >= lower && Double($0) <= upper }
+}
+
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
 
 @_silgen_name("swift_leaks_startTrackingObjects")
@@ -226,6 +307,176 @@ func stopTrackingObjects(_: UnsafeMutableRawPointer) -> Int
 
 #endif
 
+/// The number of calls of swift_retain, swift_release and swift_allocObject
+/// while counting runtime calls. The counters are not atomic; the benchmarks
+/// which spawn threads are only approximately counted.
+var numRetains: UInt64 = 0
+var numReleases: UInt64 = 0
+var numAllocations: UInt64 = 0
+
+typealias RetainReleaseFn = @convention(c) (UnsafeMutableRawPointer?) -> Void
+typealias AllocObjectFn =
+  @convention(c) (UnsafeRawPointer?, Int, Int) -> UnsafeMutableRawPointer?
+
+var originalRetain: RetainReleaseFn? = nil
+var originalRelease: RetainReleaseFn? = nil
+var originalAllocObject: AllocObjectFn? = nil
+
+/// Returns the function pointer variable through which the runtime calls the
+/// implementation of an entry point. These are exported for Instruments, see
+/// swift/Runtime/InstrumentsSupport.h.
+func lookupRuntimeHook<T>(_ name: String, _: T.Type) -> UnsafeMutablePointer<T>? {
+  // RTLD_DEFAULT
+  let handle = UnsafeMutableRawPointer(bitPattern: -2)
+  return dlsym(handle, name)?.assumingMemoryBound(to: T.self)
+}
+
+/// Starts counting the calls of runtime entry points by redirecting their
+/// function pointers. Returns false if the runtime doesn't export them.
+func startCountingRuntimeCalls() -> Bool {
+  guard let retain = lookupRuntimeHook("_swift_retain", RetainReleaseFn.self),
+        let release = lookupRuntimeHook("_swift_release", RetainReleaseFn.self),
+        let allocObject =
+          lookupRuntimeHook("_swift_allocObject", AllocObjectFn.self) else {
+    return false
+  }
+  numRetains = 0
+  numReleases = 0
+  numAllocations = 0
+  originalRetain = retain.pointee
+  originalRelease = release.pointee
+  originalAllocObject = allocObject.pointee
+  retain.pointee = { object in
+    numRetains += 1
+    originalRetain!(object)
+  }
+  release.pointee = { object in
+    numReleases += 1
+    originalRelease!(object)
+  }
+  allocObject.pointee = { metadata, size, alignMask in
+    numAllocations += 1
+    return originalAllocObject!(metadata, size, alignMask)
+  }
+  return true
+}
+
+/// Restores the function pointers replaced by startCountingRuntimeCalls.
+func stopCountingRuntimeCalls() {
+  lookupRuntimeHook("_swift_retain", RetainReleaseFn.self)!.pointee =
+    originalRetain!
+  lookupRuntimeHook("_swift_release", RetainReleaseFn.self)!.pointee =
+    originalRelease!
+  lookupRuntimeHook("_swift_allocObject", AllocObjectFn.self)!.pointee =
+    originalAllocObject!
+}
+
+/// Reads the hardware performance counters of the current thread through the
+/// kperf framework, which only root may use. Besides the fixed counters for
+/// instructions and cycles, two configurable counters are programmed with
+/// the architectural events for mispredicted branches and last level cache
+/// misses, which only exist in this form on x86.
+final class HardwareCounters {
+  typealias SetClassesFn = @convention(c) (UInt32) -> Int32
+  typealias GetCountFn = @convention(c) (UInt32) -> UInt32
+  typealias SetConfigFn =
+    @convention(c) (UInt32, UnsafeMutablePointer<UInt64>) -> Int32
+  typealias GetThreadCountersFn =
+    @convention(c) (UInt32, UInt32, UnsafeMutablePointer<UInt64>) -> Int32
+  typealias ForceAllCountersFn = @convention(c) (Int32) -> Int32
+
+  static let fixedClass: UInt32 = 1 << 0
+  static let configurableClass: UInt32 = 1 << 1
+
+  // Event select, unit mask and the user and kernel mode bits.
+  static let branchMissesEvent: UInt64 = 0xC5 | (0x00 << 8) | (3 << 16)
+  static let cacheMissesEvent: UInt64 = 0x2E | (0x41 << 8) | (3 << 16)
+
+  let getThreadCounters: GetThreadCountersFn
+  let numFixedCounters: Int
+  var buffer: [UInt64]
+
+  init?() {
+#if arch(x86_64)
+    guard let kperf = dlopen(
+      "/System/Library/PrivateFrameworks/kperf.framework/kperf",
+      RTLD_LAZY) else {
+      return nil
+    }
+    func load<T>(_ name: String, _: T.Type) -> T? {
+      return dlsym(kperf, name).map { unsafeBitCast($0, to: T.self) }
+    }
+    guard let forceAllCounters =
+            load("kpc_force_all_ctrs_set", ForceAllCountersFn.self),
+          let setCounting = load("kpc_set_counting", SetClassesFn.self),
+          let setThreadCounting =
+            load("kpc_set_thread_counting", SetClassesFn.self),
+          let setConfig = load("kpc_set_config", SetConfigFn.self),
+          let getConfigCount = load("kpc_get_config_count", GetCountFn.self),
+          let getCounterCount = load("kpc_get_counter_count", GetCountFn.self),
+          let getThreadCounters =
+            load("kpc_get_thread_counters", GetThreadCountersFn.self) else {
+      return nil
+    }
+
+    let classes = HardwareCounters.fixedClass |
+                  HardwareCounters.configurableClass
+    var config = [UInt64](
+      repeating: 0,
+      count: Int(getConfigCount(HardwareCounters.configurableClass)))
+    guard config.count >= 2, forceAllCounters(1) == 0 else {
+      return nil
+    }
+    config[0] = HardwareCounters.branchMissesEvent
+    config[1] = HardwareCounters.cacheMissesEvent
+    guard setConfig(HardwareCounters.configurableClass, &config) == 0,
+          setCounting(classes) == 0,
+          setThreadCounting(classes) == 0 else {
+      return nil
+    }
+
+    self.getThreadCounters = getThreadCounters
+    numFixedCounters = Int(getCounterCount(HardwareCounters.fixedClass))
+    buffer = [UInt64](repeating: 0, count: Int(getCounterCount(classes)))
+#else
+    return nil
+#endif
+  }
+
+  /// Returns instructions, cycles, branch misses and cache misses so far.
+  func read() -> (UInt64, UInt64, UInt64, UInt64) {
+    if getThreadCounters(0, UInt32(buffer.count), &buffer) != 0 {
+      return (0, 0, 0, 0)
+    }
+    return (buffer[0], buffer[1],
+            buffer[numFixedCounters], buffer[numFixedCounters + 1])
+  }
+}
+
+/// Runs \p num_iters iterations of a test and returns its event counts per
+/// iteration. Hardware counts which are not available are zero.
+func measureCounters(_ fn: (Int) -> Void, num_iters: UInt) -> BenchCounters {
+  var counters = BenchCounters()
+  let hardware = HardwareCounters()
+  let countRuntimeCalls = startCountingRuntimeCalls()
+
+  let start = hardware?.read() ?? (0, 0, 0, 0)
+  fn(Int(num_iters))
+  let end = hardware?.read() ?? (0, 0, 0, 0)
+
+  if countRuntimeCalls {
+    stopCountingRuntimeCalls()
+    counters.retains = numRetains / UInt64(num_iters)
+    counters.releases = numReleases / UInt64(num_iters)
+    counters.allocations = numAllocations / UInt64(num_iters)
+  }
+  counters.instructions = (end.0 &- start.0) / UInt64(num_iters)
+  counters.cycles = (end.1 &- start.1) / UInt64(num_iters)
+  counters.branchMisses = (end.2 &- start.2) / UInt64(num_iters)
+  counters.cacheMisses = (end.3 &- start.3) / UInt64(num_iters)
+  return counters
+}
+
 class SampleRunner {
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
   init() {
@@ -261,28 +512,31 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
   }
 
   let sampler = SampleRunner()
-  for s in 0..<c.numSamples {
-    let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
-
-    var scale : UInt
-    var elapsed_time : UInt64 = 0
-    if c.fixedNumIters == 0 {
-      elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
-      scale = UInt(time_per_sample / elapsed_time)
-    } else {
-      // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
-      scale = c.fixedNumIters
-    }
 
-    // Rerun the test with the computed scale factor.
-    if scale > 1 {
-      if c.verbose {
-        print("    Measuring with scale \(scale).")
-      }
-      elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
-    } else {
-      scale = 1
-    }
+  // Run the test a few times without measuring it. The fastest of these
+  // runs, and of one more run, determines the number of iterations which
+  // fill a sample, so that a slow first run doesn't make all samples short.
+  var time_per_iter: UInt64 = UInt64.max
+  for _ in 0..<max(c.numWarmups, 0) {
+    time_per_iter = min(time_per_iter, sampler.run(name, fn: fn, num_iters: 1))
+  }
+
+  var scale: UInt = 1
+  if c.fixedNumIters == 0 {
+    let time_per_sample: UInt64 =
+      c.sampleTime * 1_000_000 * UInt64(c.iterationScale)
+    time_per_iter = min(time_per_iter, sampler.run(name, fn: fn, num_iters: 1))
+    scale = UInt(time_per_sample / max(time_per_iter, 1))
+  } else {
+    scale = c.fixedNumIters
+  }
+  scale = max(scale, 1)
+  if c.verbose {
+    print("    Measuring with scale \(scale).")
+  }
+
+  for s in 0..<c.numSamples {
+    let elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
     // save result in microseconds or k-ticks
     samples[s] = elapsed_time / UInt64(scale) / 1000
     if c.verbose {
@@ -290,18 +544,38 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     }
   }
 
+  if c.rejectOutliers {
+    let kept = internalRejectOutliers(samples)
+    if c.verbose && kept.count != samples.count {
+      print("    Rejected \(samples.count - kept.count) outliers.")
+    }
+    samples = kept
+  }
+
   let (mean, sd) = internalMeanSD(samples)
 
   // Return our benchmark results.
-  return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
-                      min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+  var results =
+    BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
+                 min: samples.min()!, max: samples.max()!,
+                 mean: mean, sd: sd, median: internalMedian(samples))
+
+  // Count the events in a separate run, so that counting retains and
+  // releases doesn't slow down the samples.
+  if c.collectCounters {
+    results.counters = measureCounters(fn, num_iters: scale)
+  }
+  return results
 }
 
 func printRunInfo(_ c: TestConfig) {
   if c.verbose {
     print("--- CONFIG ---")
     print("NumSamples: \(c.numSamples)")
+    print("NumWarmups: \(c.numWarmups)")
+    print("SampleTime: \(c.sampleTime)ms")
+    print("RejectOutliers: \(c.rejectOutliers)")
+    print("Counters: \(c.collectCounters)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
     if c.fixedNumIters != 0 {
@@ -322,7 +596,13 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
+  if c.collectCounters {
+    for column in BenchCounters.columns {
+      header += "\(c.delim)\(column)"
+    }
+  }
+  print(header)
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
 
@@ -70,12 +70,22 @@ TOTALRE = re.compile(r"()(Totals),[ \t]*([\d.]+),[ \t]*([\d.]+)")
 KEYGROUP = 2
 VALGROUP = 4
 
+# The index of the first column after MEDIAN. With --counters, the benchmark
+# drivers print the event counts of each test in these columns, and each
+# count is reported as a test named "<test>.<column>", e.g.
+# "Ackermann.INSTRUCTIONS".
+FIRSTCOUNTERCOLUMN = 8
+
 if __name__ == "__main__":
     data = {}
     data['Tests'] = []
     data['Machine'] = {}
     data['Run'] = {}
+    counter_columns = []
     for line in sys.stdin:
+        if line.startswith('#'):
+            counter_columns = line.strip().split(',')[FIRSTCOUNTERCOLUMN:]
+            continue
         m = SCORERE.match(line)
         if not m:
             m = TOTALRE.match(line)
@@ -86,4 +96,11 @@ if __name__ == "__main__":
         test['Info'] = {}
         test['Name'] = [m.group(KEYGROUP)]
         data['Tests'].append(test)
+        if m.group(KEYGROUP) == 'Totals':
+            continue
+        counters = line.strip().split(',')[FIRSTCOUNTERCOLUMN:]
+        for column, value in zip(counter_columns, counters):
+            data['Tests'].append({
+                'Data': [int(value)], 'Info': {},
+                'Name': [m.group(KEYGROUP) + '.' + column]})
     print(json.dumps(data, sort_keys=True, indent=4))
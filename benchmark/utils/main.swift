@@ -38,6 +38,7 @@ import Calculator
 import CaptureProp
 import Chars
 import ClassArrayGetter
+import ConcurrentRuntime
 import DeadArray
 import DictTest
 import DictTest2
@@ -48,16 +49,19 @@ import DictionaryRemove
 import DictionarySwap
 import ErrorHandling
 import Fibonacci
+import FloatingPointPrinting
 import GlobalClass
 import Hanoi
 import Hash
 import Histogram
+import IntToStr
 import Integrate
 import IterateData
 import Join
 import LinkedList
 import MapReduce
 import Memset
+import MirrorChildren
 import MonteCarloE
 import MonteCarloPi
 import NSDictionaryCastToSwift
@@ -103,6 +107,7 @@ import XorLoop
 precommitTests = [
   "AngryPhonebook": run_AngryPhonebook,
   "AnyHashableWithAClass": run_AnyHashableWithAClass,
+  "AnyHashableWithAClassInDictionary": run_AnyHashableWithAClassInDictionary,
   "Array2D": run_Array2D,
   "ArrayAppend": run_ArrayAppend,
   "ArrayAppendReserved": run_ArrayAppendReserved,
@@ -123,6 +128,22 @@ precommitTests = [
   "CaptureProp": run_CaptureProp,
   "Chars": run_Chars,
   "ClassArrayGetter": run_ClassArrayGetter,
+  "ConcurrentAllocation1": run_ConcurrentAllocation1,
+  "ConcurrentAllocation2": run_ConcurrentAllocation2,
+  "ConcurrentAllocation4": run_ConcurrentAllocation4,
+  "ConcurrentAllocation8": run_ConcurrentAllocation8,
+  "ConcurrentMetadataLookup1": run_ConcurrentMetadataLookup1,
+  "ConcurrentMetadataLookup2": run_ConcurrentMetadataLookup2,
+  "ConcurrentMetadataLookup4": run_ConcurrentMetadataLookup4,
+  "ConcurrentMetadataLookup8": run_ConcurrentMetadataLookup8,
+  "ConcurrentProtocolCast1": run_ConcurrentProtocolCast1,
+  "ConcurrentProtocolCast2": run_ConcurrentProtocolCast2,
+  "ConcurrentProtocolCast4": run_ConcurrentProtocolCast4,
+  "ConcurrentProtocolCast8": run_ConcurrentProtocolCast8,
+  "ConcurrentRetainRelease1": run_ConcurrentRetainRelease1,
+  "ConcurrentRetainRelease2": run_ConcurrentRetainRelease2,
+  "ConcurrentRetainRelease4": run_ConcurrentRetainRelease4,
+  "ConcurrentRetainRelease8": run_ConcurrentRetainRelease8,
   "DeadArray": run_DeadArray,
   "Dictionary": run_Dictionary,
   "Dictionary2": run_Dictionary2,
@@ -137,16 +158,19 @@ precommitTests = [
   "DictionarySwap": run_DictionarySwap,
   "DictionarySwapOfObjects": run_DictionarySwapOfObjects,
   "ErrorHandling": run_ErrorHandling,
+  "FloatingPointPrinting": run_FloatingPointPrinting,
   "GlobalClass": run_GlobalClass,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
   "Histogram": run_Histogram,
+  "IntToStr": run_IntToStr,
   "Integrate": run_Integrate,
   "IterateData": run_IterateData,
   "Join": run_Join,
   "LinkedList": run_LinkedList,
   "MapReduce": run_MapReduce,
   "Memset": run_Memset,
+  "MirrorChildren": run_MirrorChildren,
   "MonteCarloE": run_MonteCarloE,
   "MonteCarloPi": run_MonteCarloPi,
   "NSDictionaryCastToSwift": run_NSDictionaryCastToSwift,
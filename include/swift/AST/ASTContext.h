@@ -36,6 +36,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -55,6 +56,7 @@ namespace swift {
   class Decl;
   class DeclContext;
   class DefaultArgumentInitializer;
+  class Expr;
   class ExtensionDecl;
   class ForeignRepresentationInfo;
   class FuncDecl;
@@ -104,6 +106,18 @@ enum class AllocationArena {
   ConstraintSolver
 };
 
+/// The kinds of names of a declaration which ASTContext can remember once
+/// they have been mangled, see ASTContext::getCachedMangledName().
+enum class DeclMangling : unsigned {
+  /// The USR of the declaration.
+  USR,
+  /// The USR of the type of the declaration.
+  TypeUSR,
+  /// The USR of an accessor of a storage declaration. The AccessorKind is
+  /// added to this value.
+  AccessorUSR
+};
+
 /// Lists the set of "known" Foundation entities that are used in the
 /// compiler.
 ///
@@ -231,6 +245,17 @@ public:
   /// Cache of remapped types (useful for diagnostics).
   llvm::StringMap<Type> RemappedTypes;
 
+  /// Set from another thread by a client such as SourceKit whose result is
+  /// no longer needed, e.g. because the file was edited again. Semantic
+  /// analysis checks it between declarations and function bodies and stops
+  /// early, leaving an incomplete AST which the client must discard.
+  std::shared_ptr<std::atomic<bool>> CancellationFlag;
+
+  /// Whether the client asked to stop semantic analysis.
+  bool isCancellationRequested() const {
+    return CancellationFlag && CancellationFlag->load(std::memory_order_relaxed);
+  }
+
 private:
   /// \brief The current generation number, which reflects the number of
   /// times that external modules have been loaded.
@@ -353,8 +378,14 @@ public:
 
   /// getIdentifier - Return the uniqued and AST-Context-owned version of the
   /// specified string.
+  ///
+  /// This is safe to call from multiple threads.
   Identifier getIdentifier(StringRef Str) const;
 
+  /// Return the uniqued version of \p Str, whose IdentifierTable::hashText is
+  /// \p Hash, e.g. as computed by the lexer.
+  Identifier getIdentifier(StringRef Str, unsigned Hash) const;
+
   /// Decide how to interpret two precedence groups.
   Associativity associateInfixOperators(PrecedenceGroupDecl *left,
                                         PrecedenceGroupDecl *right) const;
@@ -625,7 +656,31 @@ public:
   /// module import.
   ///
   /// \returns the previous generation number.
-  unsigned bumpGeneration() { return CurrentGeneration++; }
+  unsigned bumpGeneration() {
+    invalidateConformanceLookupCache();
+    return CurrentGeneration++;
+  }
+
+  /// Retrieve the result of an earlier \c Module::lookupConformance() of
+  /// \p protocol by \p type from \p module, if it is still valid.
+  ///
+  /// \returns true if there is a result, which is stored in \p result.
+  bool getCachedConformanceLookup(Module *module, Type type,
+                                  ProtocolDecl *protocol,
+                                  Optional<ProtocolConformanceRef> &result);
+
+  /// Record the result of \c Module::lookupConformance() of \p protocol by
+  /// \p type from \p module, until the conformances in the AST change.
+  ///
+  /// Negative results are recorded as well. The type must not contain type
+  /// variables.
+  void cacheConformanceLookup(Module *module, Type type,
+                              ProtocolDecl *protocol,
+                              Optional<ProtocolConformanceRef> result);
+
+  /// Forget the cached results of conformance lookups, because a
+  /// conformance, an extension or a superclass was added to the AST.
+  void invalidateConformanceLookupCache();
 
   /// \brief Produce a "normal" conformance for a nominal type.
   NormalProtocolConformance *
@@ -775,6 +830,19 @@ public:
   ArchetypeBuilder *getOrCreateArchetypeBuilder(CanGenericSignature sig,
                                                 ModuleDecl *mod);
 
+  /// Retrieve the result of an earlier
+  /// \c GenericSignature::getCanonicalTypeInContext() of \p type in the
+  /// context of the given canonical generic signature and module, or a null
+  /// type if there is none.
+  CanType getCachedCanonicalTypeInContext(CanGenericSignature sig,
+                                          ModuleDecl *mod, CanType type);
+
+  /// Record the result of \c GenericSignature::getCanonicalTypeInContext()
+  /// of \p type in the context of the given canonical generic signature and
+  /// module.
+  void cacheCanonicalTypeInContext(CanGenericSignature sig, ModuleDecl *mod,
+                                   CanType type, CanType result);
+
   /// Retrieve the inherited name set for the given class.
   const InheritedNameSet *getAllPropertyNames(ClassDecl *classDecl,
                                               bool forInstance);
@@ -784,6 +852,18 @@ public:
                             clang::ObjCInterfaceDecl *classDecl,
                             bool forInstance);
 
+  /// Retrieve the name of kind \p Kind which was mangled for \p D before,
+  /// if any.
+  Optional<StringRef> getCachedMangledName(const ValueDecl *D,
+                                           unsigned Kind);
+
+  /// Remember the mangled name \p Name of kind \p Kind of \p D.
+  ///
+  /// Only names which no longer change, e.g. after the declaration has been
+  /// type-checked, should be cached.
+  void setCachedMangledName(const ValueDecl *D, unsigned Kind,
+                            StringRef Name);
+
 private:
   friend class Decl;
   Optional<RawComment> getRawComment(const Decl *D);
@@ -792,6 +872,10 @@ private:
   Optional<StringRef> getBriefComment(const Decl *D);
   void setBriefComment(const Decl *D, StringRef Comment);
 
+  friend class Expr;
+  SourceLoc getExprTrailingSemiLoc(const Expr *E);
+  void setExprTrailingSemiLoc(const Expr *E, SourceLoc Loc);
+
   friend class TypeBase;
 
   /// \brief Set the substitutions for the given bound generic type.
@@ -18,6 +18,7 @@
 #define SWIFT_AST_AST_SCOPE_H
 
 #include "swift/AST/ASTNode.h"
+#include "swift/AST/Identifier.h"
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/SourceManager.h"
 #include "llvm/ADT/PointerIntPair.h"
@@ -43,6 +44,7 @@ class GuardStmt;
 class IfStmt;
 class IterableDeclContext;
 class LabeledConditionalStmt;
+class LocalBindingTable;
 class ParamDecl;
 class PatternBindingDecl;
 class RepeatWhileStmt;
@@ -251,6 +253,11 @@ class ASTScope {
     struct {
       BraceStmt *stmt;
 
+      /// The local bindings of the brace statement by base name, built by
+      /// the first \c lookupLocalBindings() into a brace statement with many
+      /// of them.
+      mutable LocalBindingTable *bindingTable;
+
       /// The next element in the brace statement that should be expanded.
       mutable unsigned nextElement;
     } braceStmt;
@@ -405,6 +412,7 @@ class ASTScope {
   ASTScope(const ASTScope *parent, BraceStmt *braceStmt)
       : ASTScope(ASTScopeKind::BraceStmt, parent) {
     this->braceStmt.stmt = braceStmt;
+    this->braceStmt.bindingTable = nullptr;
     this->braceStmt.nextElement = 0;
   }
 
@@ -625,6 +633,16 @@ public:
   /// client can perform such lookups using the result of \c getDeclContext().
   SmallVector<ValueDecl *, 4> getLocalBindings() const;
 
+  /// Retrieve the declarations bound by this scope whose base name is
+  /// that of \p name.
+  ///
+  /// This produces a subset of \c getLocalBindings(); the client still has
+  /// to match the full names. The bindings of brace statements, which can
+  /// contain any number of local functions and types, are looked up in a
+  /// table which is built on the first lookup.
+  void lookupLocalBindings(DeclName name,
+                           SmallVectorImpl<ValueDecl *> &result) const;
+
   /// Expand the entire scope map.
   ///
   /// Normally, the scope map will be expanded only as needed by its queries,
@@ -4668,8 +4668,12 @@ public:
 
   /// \brief Note that the body was skipped for this function.  Function body
   /// cannot be attached after this call.
+  ///
+  /// A parsed body may be skipped as well, if it is not going to be
+  /// type-checked.
   void setBodySkipped(SourceRange bodyRange) {
-    assert(getBodyKind() == BodyKind::None);
+    assert(getBodyKind() == BodyKind::None ||
+           getBodyKind() == BodyKind::Parsed);
     BodyRange = bodyRange;
     setBodyKind(BodyKind::Skipped);
   }
@@ -428,6 +428,10 @@ namespace swift {
     /// state such as fatality into account.
     Behavior determineBehavior(DiagID id);
 
+    /// \brief Figure out the Behavior which the given diagnostic would get if
+    /// it were emitted now, without recording it.
+    Behavior computeBehavior(DiagID id) const;
+
     bool hadAnyError() const { return anyErrorOccurred; }
     bool hasFatalErrorOccurred() const { return fatalErrorOccurred; }
 
@@ -696,6 +700,16 @@ namespace swift {
     /// option.
     bool isDiagnosticPointsToFirstBadToken(DiagID id) const;
 
+    /// \returns true if a diagnostic with the given ID which is emitted now
+    /// will not reach any consumer, e.g. because warnings are suppressed or
+    /// the engine only swallows diagnostics.
+    ///
+    /// This is cheap, so that callers can avoid computing expensive arguments
+    /// or fix-its for diagnostics which are discarded anyway. Diagnostics in
+    /// an open transaction are only classified when it commits, so they are
+    /// only known to be discarded if there is no consumer.
+    bool isDiagnosticDiscarded(DiagID id) const;
+
   private:
     /// \brief Flush the active diagnostic.
     void flushActiveDiagnostic();
@@ -703,6 +717,12 @@ namespace swift {
     /// \brief Retrieve the active diagnostic.
     Diagnostic &getActiveDiagnostic() { return *ActiveDiagnostic; }
 
+    /// \brief Whether the active diagnostic is discarded, so that there is no
+    /// point in computing its ranges and fix-its.
+    bool isActiveDiagnosticDiscarded() const {
+      return isDiagnosticDiscarded(ActiveDiagnostic->getID());
+    }
+
     /// \brief Send \c diag to all diagnostic consumers.
     void emitDiagnostic(const Diagnostic &diag);
 
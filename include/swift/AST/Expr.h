@@ -491,7 +491,11 @@ public:
   SourceLoc getLoc() const { return (SUBEXPR)->getLoc(); } \
   SourceRange getSourceRange() const { return (SUBEXPR)->getSourceRange(); }
 
-  SourceLoc TrailingSemiLoc;
+  /// The location of the semicolon after this expression, if it is a
+  /// statement followed by one. Rarely set, so it is kept in a side table of
+  /// the ASTContext instead of in every expression.
+  SourceLoc getTrailingSemiLoc(ASTContext &Ctx) const;
+  void setTrailingSemiLoc(ASTContext &Ctx, SourceLoc Loc);
 
   /// getSemanticsProvidingExpr - Find the smallest subexpression
   /// which obeys the property that evaluating it is exactly
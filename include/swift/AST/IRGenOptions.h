@@ -93,6 +93,10 @@ public:
   /// Whether or not to run optimization passes.
   unsigned Optimize : 1;
 
+  /// Whether the optimization passes should prefer small code size over
+  /// speed.
+  unsigned OptimizeForSize : 1;
+
   /// Which sanitizer is turned on.
   SanitizerKind Sanitize : 2;
 
@@ -158,9 +162,22 @@ public:
   /// measurements on a non-clean build directory.
   unsigned UseIncrementalLLVMCodeGen : 1;
 
+  /// If non-empty, a directory in which object files are kept by the hash of
+  /// the LLVM IR they were generated from. An object file with the same hash
+  /// is copied from there instead of running the LLVM passes.
+  std::string ObjectCachePath;
+
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Emit every function and global variable into its own section, so that
+  /// the linker can strip the unused ones.
+  unsigned FunctionSections : 1;
+
+  /// Emit the metadata of fully concrete instantiations of generic structs
+  /// as constant data, instead of instantiating it at runtime.
+  unsigned PrespecializeGenericMetadata : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -169,7 +186,8 @@ public:
 
   IRGenOptions()
       : DWARFVersion(2), OutputKind(IRGenOutputKind::LLVMAssembly),
-        Verify(true), Optimize(false), Sanitize(SanitizerKind::None),
+        Verify(true), Optimize(false), OptimizeForSize(false),
+        Sanitize(SanitizerKind::None),
         DebugInfoKind(IRGenDebugInfoKind::None), UseJIT(false),
         DisableLLVMOptzns(false), DisableLLVMARCOpts(false),
         DisableLLVMSLPVectorizer(false), DisableFPElim(true), Playground(false),
@@ -177,7 +195,8 @@ public:
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
-        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false), CmdArgs(),
+        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
+        FunctionSections(false), PrespecializeGenericMetadata(false), CmdArgs(),
         SanitizeCoverage(llvm::SanitizerCoverageOptions()) {}
 
   /// Gets the name of the specified output filename.
@@ -193,8 +212,10 @@ public:
   unsigned getLLVMCodeGenOptionsHash() {
     unsigned Hash = 0;
     Hash = (Hash << 1) | Optimize;
+    Hash = (Hash << 1) | OptimizeForSize;
     Hash = (Hash << 1) | DisableLLVMOptzns;
     Hash = (Hash << 1) | DisableLLVMARCOpts;
+    Hash = (Hash << 1) | FunctionSections;
     return Hash;
   }
 
@@ -0,0 +1,101 @@
+//===--- IdentifierTable.h - Uniquing table for identifiers -----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the IdentifierTable, which uniques the text of the
+// identifiers of an ASTContext.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_AST_IDENTIFIERTABLE_H
+#define SWIFT_AST_IDENTIFIERTABLE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
+#include <atomic>
+
+namespace swift {
+
+/// Uniques strings into NUL-terminated copies which live as long as the
+/// table.
+///
+/// The table is safe to use from multiple threads. Looking up a string which
+/// is already in the table doesn't take a lock; only inserting a new string
+/// locks one of several independent shards of the table.
+///
+/// Clients which have already scanned a string, like the lexer, can pass its
+/// hash as computed by hashText, so that the string is not scanned again
+/// unless it needs to be compared or copied.
+class IdentifierTable {
+public:
+  /// Adds \p c to the hash \p hash of the characters before it.
+  static unsigned hashStep(unsigned hash, char c) {
+    return hash * 33 + (unsigned char)c;
+  }
+
+  /// The hash of \p text which the table uses.
+  static unsigned hashText(StringRef text) {
+    unsigned hash = 0;
+    for (char c : text)
+      hash = hashStep(hash, c);
+    return hash;
+  }
+
+private:
+  /// The number of shards, each with its own lock, buckets and allocator.
+  static const unsigned NumShards = 16;
+
+  /// An open-addressed array of buckets, each of which is null or points to
+  /// the text of an entry.
+  ///
+  /// A bucket array is never freed or shrunk while the table is alive, so that
+  /// lookups which don't take the lock can still probe an array which was
+  /// replaced by a bigger one in the meantime.
+  struct BucketArray {
+    unsigned NumBuckets;
+    std::atomic<const char *> Buckets[1];
+  };
+
+  struct Shard {
+    llvm::sys::Mutex Lock;
+    std::atomic<BucketArray *> Buckets;
+    unsigned NumEntries = 0;
+    llvm::BumpPtrAllocator Allocator;
+
+    Shard() : Buckets(nullptr) {}
+  };
+
+  Shard Shards[NumShards];
+
+  IdentifierTable(const IdentifierTable &) = delete;
+  IdentifierTable &operator=(const IdentifierTable &) = delete;
+
+public:
+  IdentifierTable() = default;
+
+  /// Returns the unique copy of \p text, inserting it if necessary.
+  const char *get(StringRef text) {
+    return get(text, hashText(text));
+  }
+
+  /// Returns the unique copy of \p text, whose hashText is \p hash,
+  /// inserting it if necessary.
+  const char *get(StringRef text, unsigned hash);
+
+  /// Returns the number of bytes which the table has allocated.
+  size_t getMemorySize() const;
+};
+
+} // end namespace swift
+
+#endif // SWIFT_AST_IDENTIFIERTABLE_H
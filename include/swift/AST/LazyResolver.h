@@ -17,6 +17,7 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
 #include "swift/AST/TypeLoc.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
 
@@ -26,7 +27,7 @@ class AssociatedTypeDecl;
 class Decl;
 class DeclContext;
 class ExtensionDecl;
-class Identifier;
+class IterableDeclContext;
 class NominalTypeDecl;
 class NormalProtocolConformance;
 class ProtocolConformance;
@@ -204,6 +205,19 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates \p members with the members of \p D which have the base name
+  /// \p name, without loading all of the members of \p D.
+  ///
+  /// The implementation should \em not add the members to \p D.
+  ///
+  /// \returns true if the members cannot be loaded by name, in which case
+  /// the caller has to load all members instead.
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *D, Identifier name,
+                   uint64_t contextData, SmallVectorImpl<ValueDecl *> &members) {
+    return true;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -36,6 +36,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MD5.h"
+#include <array>
 
 namespace clang {
   class Module;
@@ -332,6 +333,14 @@ public:
   Optional<ProtocolConformanceRef>
   lookupConformance(Type type, ProtocolDecl *protocol, LazyResolver *resolver);
 
+private:
+  /// The uncached part of \c lookupConformance() for a type whose nominal
+  /// type declaration is \p nominal.
+  Optional<ProtocolConformanceRef>
+  lookupNominalConformance(Type type, NominalTypeDecl *nominal,
+                           ProtocolDecl *protocol, LazyResolver *resolver);
+
+public:
   /// Find a member named \p name in \p container that was declared in this
   /// module.
   ///
@@ -810,6 +819,36 @@ private:
   /// this source file so far.
   llvm::MD5 InterfaceHash;
 
+public:
+  /// The kinds of per-declaration interface hashes.
+  ///
+  /// \sa getDeclInterfaceHash
+  enum class DeclInterfaceHashKind : unsigned {
+    /// The tokens of the declaration and its members, except for private
+    /// members which don't affect the layout of a type.
+    Interface,
+    /// The tokens of the declaration and all of its members.
+    AllMembers,
+    /// The tokens of the declaration and the members which affect its layout:
+    /// stored properties, enum cases and nested types.
+    Layout,
+  };
+  enum : unsigned { NumDeclInterfaceHashKinds = 3 };
+
+private:
+  /// Hashes of the interface-contributing tokens of the declarations that are
+  /// being parsed, innermost last, one per DeclInterfaceHashKind.
+  SmallVector<std::array<llvm::MD5, NumDeclInterfaceHashKinds>, 4>
+      DeclInterfaceHashStack;
+
+  /// The interface hashes of each declaration parsed in this file, if they
+  /// are being tracked.
+  ///
+  /// \sa getDeclInterfaceHash
+  llvm::DenseMap<const Decl *,
+                 std::array<std::string, NumDeclInterfaceHashKinds>>
+      DeclInterfaceHashes;
+
   /// \brief The ID for the memory buffer containing this file's source.
   ///
   /// May be -1, to indicate no association with a buffer.
@@ -1043,6 +1082,43 @@ public:
     // Add null byte to separate tokens.
     uint8_t a[1] = {0};
     InterfaceHash.update(a);
+
+    if (!DeclInterfaceHashStack.empty()) {
+      for (auto &hash : DeclInterfaceHashStack.back()) {
+        hash.update(token);
+        hash.update(a);
+      }
+    }
+  }
+
+  /// Start hashing the interface tokens of a declaration that is about to be
+  /// parsed. Must be balanced by a call to endDeclInterfaceHash.
+  void beginDeclInterfaceHash() {
+    DeclInterfaceHashStack.emplace_back();
+  }
+
+  /// Finish the hashes started by the matching beginDeclInterfaceHash and
+  /// record them for each of \p decls, the declarations parsed in between.
+  ///
+  /// The hashes of an enclosing declaration cover its own tokens, plus the
+  /// hashes of its nested declarations: all of them for the AllMembers hash,
+  /// those for which \p isPrivate is false or \p affectsLayout is true for
+  /// the Interface hash, and those for which \p affectsLayout is true for the
+  /// Layout hash.
+  void endDeclInterfaceHash(ArrayRef<Decl *> decls, bool isPrivate,
+                            bool affectsLayout);
+
+  /// Returns the hash of the interface tokens of \p D of the given kind, or
+  /// an empty string if it isn't known.
+  ///
+  /// Changing the body of a function doesn't change any of its hashes.
+  StringRef getDeclInterfaceHash(
+      const Decl *D,
+      DeclInterfaceHashKind kind = DeclInterfaceHashKind::Interface) const {
+    auto found = DeclInterfaceHashes.find(D);
+    if (found == DeclInterfaceHashes.end())
+      return StringRef();
+    return found->second[unsigned(kind)];
   }
 
   const llvm::MD5 &getInterfaceHashState() { return InterfaceHash; }
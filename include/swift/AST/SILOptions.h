@@ -49,6 +49,7 @@ public:
     None,
     Debug,
     Optimize,
+    OptimizeForSize,
     OptimizeUnchecked
   };
 
@@ -101,6 +102,14 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The path to a .profdata file with execution counts which guide the
+  /// optimizer. Empty if no profile is used.
+  std::string UseProfile;
+
+  /// Call the pre-specializations of the SwiftOnoneSupport library instead of
+  /// creating new specializations, even in optimized builds.
+  bool UsePrespecializations = false;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -108,6 +117,11 @@ public:
   /// conventions.
   bool EnableGuaranteedClosureContexts = false;
 
+  /// Pass the normal parameters of Swift functions using the +0
+  /// caller-guaranteed ARC convention, like 'self'. Initializers, enum
+  /// element constructors and setters still take their parameters at +1.
+  bool EnableGuaranteedNormalArguments = false;
+
   /// The name of the SIL outputfile if compiled with SIL debugging (-gsil).
   std::string SILOutputFileNameForDebugging;
 };
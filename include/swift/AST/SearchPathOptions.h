@@ -52,6 +52,11 @@ public:
 
   /// Don't look in for compiler-provided modules.
   bool SkipRuntimeLibraryImportPath = false;
+
+  /// Read the contents of each module search path once, instead of probing
+  /// it for every module which is imported. Entries which are added to a
+  /// search path later are not found.
+  bool CacheSearchPathContents = false;
 };
 
 }
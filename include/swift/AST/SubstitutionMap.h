@@ -41,6 +41,32 @@ class SubstitutionMap {
   llvm::DenseMap<TypeBase *, ArrayRef<ProtocolConformanceRef>> conformanceMap;
   llvm::DenseMap<TypeBase *, SmallVector<ParentType, 1>> parentMap;
 
+  /// The results of \c Type::subst() with this map, by original type and
+  /// substitution options. Cleared whenever the map changes.
+  ///
+  /// A copy of the map starts out with an empty cache, so that copying a
+  /// map doesn't copy its cache too.
+  class SubstCache {
+    llvm::DenseMap<std::pair<TypeBase *, unsigned>, Type> Results;
+
+  public:
+    SubstCache() = default;
+    SubstCache(const SubstCache &) {}
+    SubstCache &operator=(const SubstCache &) {
+      Results.clear();
+      return *this;
+    }
+
+    Type lookup(TypeBase *type, unsigned options) const {
+      return Results.lookup({type, options});
+    }
+    void insert(TypeBase *type, unsigned options, Type result) {
+      Results[{type, options}] = result;
+    }
+    void clear() { Results.clear(); }
+  };
+  mutable SubstCache substCache;
+
   Optional<ProtocolConformanceRef>
   lookupConformance(ProtocolDecl *proto,
                     ArrayRef<ProtocolConformanceRef> conformances) const;
@@ -64,6 +90,17 @@ public:
                  AssociatedTypeDecl *assocType);
 
   void removeType(CanType type);
+
+  /// Retrieve the result of an earlier substitution of \p type with this
+  /// map, or a null type.
+  Type getCachedSubstitution(Type type, SubstOptions options) const {
+    return substCache.lookup(type.getPointer(), options.toRaw());
+  }
+
+  /// Record the result of substituting \p type with this map.
+  void cacheSubstitution(Type type, SubstOptions options, Type result) const {
+    substCache.insert(type.getPointer(), options.toRaw(), result);
+  }
 };
 
 } // end namespace swift
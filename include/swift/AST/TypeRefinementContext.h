@@ -157,6 +157,14 @@ private:
 
   std::vector<TypeRefinementContext *> Children;
 
+  /// The number of leading children for which ChildrenAreOrdered was
+  /// checked.
+  unsigned NumOrderedChildrenChecked = 0;
+
+  /// Whether the children checked so far have disjoint source ranges and are
+  /// sorted by their start locations, so that they can be binary searched.
+  bool ChildrenAreOrdered = true;
+
   TypeRefinementContext(ASTContext &Ctx, IntroNode Node,
                         TypeRefinementContext *Parent, SourceRange SrcRange,
                         const AvailabilityContext &Info);
@@ -113,6 +113,26 @@ class BlotMapVector {
       Vector.clear();
     }
 
+    /// Remove the blotted entries from the vector, so that iterating over the
+    /// map does not become slower with each blot. Unlike blot, this
+    /// invalidates all iterators.
+    void compact() {
+      if (Map.size() == Vector.size())
+        return;
+
+      size_t Num = 0;
+      for (size_t i = 0, e = Vector.size(); i != e; ++i) {
+        if (!Vector[i].hasValue())
+          continue;
+        if (i != Num) {
+          Map[Vector[i]->first] = Num;
+          Vector[Num] = std::move(Vector[i]);
+        }
+        ++Num;
+      }
+      Vector.erase(Vector.begin() + Num, Vector.end());
+    }
+
     unsigned size() const { return Map.size(); }
 
     ValueT lookup(const KeyT &Val) const {
@@ -73,6 +73,13 @@ class ClusteredBitVector {
     return (value + ChunkSizeInBits - 1) / ChunkSizeInBits;
   }
 
+  /// Return a chunk with the low N bits set.
+  static ChunkType getLowBitsMask(size_t numBits) {
+    assert(numBits <= ChunkSizeInBits);
+    return numBits == ChunkSizeInBits ? ~ChunkType(0)
+                                      : (ChunkType(1) << numBits) - 1;
+  }
+
   /// Either:
   ///   - a uint64_t * with at least enough storage for
   ///     getNumChunksForBits(LengthInBits) or
@@ -436,12 +443,12 @@ public:
       return *this;
     }
 
-    // Otherwise, &= the chunks pairwise.
-    auto chunks = getChunks();
-    auto oi = other.getChunksPtr();
-    for (auto i = chunks.begin(), e = chunks.end(); i != e; ++i, ++oi) {
-      *i &= *oi;
-    }
+    // Otherwise, &= the chunks pairwise.  This is written as a plain loop
+    // over distinct arrays so that the compiler can vectorize it.
+    ChunkType *chunks = getChunksPtr();
+    const ChunkType *otherChunks = other.getChunksPtr();
+    for (size_t i = 0, e = getLengthInChunks(); i != e; ++i)
+      chunks[i] &= otherChunks[i];
     return *this;
   }
 
@@ -459,11 +466,10 @@ public:
     }
 
     // Otherwise, |= the chunks pairwise.
-    auto chunks = getChunks();
-    auto oi = other.getChunksPtr();
-    for (auto i = chunks.begin(), e = chunks.end(); i != e; ++i, ++oi) {
-      *i |= *oi;
-    }
+    ChunkType *chunks = getChunksPtr();
+    const ChunkType *otherChunks = other.getChunksPtr();
+    for (size_t i = 0, e = getLengthInChunks(); i != e; ++i)
+      chunks[i] |= otherChunks[i];
     return *this;
   }
 
@@ -502,7 +508,7 @@ public:
       chunk = ~chunk;
     }
     if (auto tailBits = size() % ChunkSizeInBits) {
-      getChunks().back() &= ((ChunkType(1) << tailBits) - 1);
+      getChunks().back() &= getLowBitsMask(tailBits);
     }
   }
 
@@ -657,14 +663,10 @@ private:
   /// that it's known to contain enough capacity for them.
   void appendConstantBitsReserved(size_t numBits, bool addOnes);
 
-  /// Append bits from the given array to this vector.
+  /// Append bits from the given array to this vector, given that it's
+  /// known to contain enough capacity for them.
   void appendReserved(size_t numBits, const ChunkType *nextChunk);
 
-  /// Append bits to this vector, given that it's known to contain
-  /// enough capacity for them all.
-  void appendReserved(size_t numBits,
-                llvm::function_ref<ChunkType(size_t numBitsWanted)> generator);
-
   /// The slow case of equality-checking.
   static bool equalsSlowCase(const ClusteredBitVector &lhs,
                              const ClusteredBitVector &rhs);
@@ -82,6 +82,7 @@ enum class FunctionSigSpecializationParamKind : unsigned {
   ClosureProp = 5,
   BoxToValue = 6,
   BoxToStack = 7,
+  ExistentialToGeneric = 8,
 
   // Option Set Flags use bits 6-31. This gives us 26 bits to use for option
   // flags.
@@ -101,6 +102,7 @@ enum class SpecializationPass : uint8_t {
   CapturePropagation,
   FunctionSignatureOpts,
   GenericSpecializer,
+  ExistentialSpecializer,
 };
 
 static inline char encodeSpecializationPass(SpecializationPass Pass) {
@@ -135,7 +137,9 @@ enum class Directness {
   Direct, Indirect
 };
 
-class Node : public std::enable_shared_from_this<Node> {
+class NodeFactory;
+
+class Node {
 public:
   enum class Kind : uint16_t {
 #define NODE(ID) ID,
@@ -157,25 +161,43 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
+  /// The number of children stored inline in the node itself.  Almost all
+  /// nodes in a demangling tree have at most this many children; nodes with
+  /// more spill into separately allocated storage.
+  enum : uint32_t { NumInlineChildren = 2 };
+
+  NodePointer InlineChildren[NumInlineChildren];
+  NodePointer *Children;
+  uint32_t NumChildren;
+  uint32_t ReservedChildren;
+
+  /// The arena this node was allocated in, or null if it was allocated on
+  /// the heap.  Spilled child storage comes from the same place.
+  NodeFactory *Factory;
 
-  Node(Kind k)
-      : NodeKind(k), NodePayloadKind(PayloadKind::None) {
+  Node(NodeFactory *F, Kind k)
+      : NodeKind(k), NodePayloadKind(PayloadKind::None),
+        Children(InlineChildren), NumChildren(0),
+        ReservedChildren(NumInlineChildren), Factory(F) {
   }
-  Node(Kind k, std::string &&t)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
+  Node(NodeFactory *F, Kind k, std::string &&t)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Text),
+        Children(InlineChildren), NumChildren(0),
+        ReservedChildren(NumInlineChildren), Factory(F) {
     new (&TextPayload) std::string(std::move(t));
   }
-  Node(Kind k, IndexType index)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
+  Node(NodeFactory *F, Kind k, IndexType index)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Index),
+        Children(InlineChildren), NumChildren(0),
+        ReservedChildren(NumInlineChildren), Factory(F) {
     IndexPayload = index;
   }
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
+  void growChildren();
+
+  friend class NodeFactory;
 
 public:
   ~Node();
@@ -194,19 +216,25 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(NumChildren != 0 && "node has no children");
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren && "child index out of range");
+    return Children[index];
+  }
 
   /// Add a new node as a child of this one.
   ///
@@ -214,7 +242,9 @@ public:
   /// \returns child
   NodePointer addChild(NodePointer child) {
     assert(child && "adding null child!");
-    Children.push_back(child);
+    if (NumChildren == ReservedChildren)
+      growChildren();
+    Children[NumChildren++] = child;
     return child;
   }
 
@@ -225,6 +255,128 @@ public:
   }
 };
 
+/// Creates the nodes of demangling trees.
+///
+/// The static create() functions allocate every node on the heap, and the
+/// resulting trees can be kept around for as long as the client likes.
+///
+/// A NodeFactory instance instead hands out nodes from a bump-pointer arena.
+/// The nodes, their shared_ptr control blocks, and any spilled child storage
+/// all live in the arena, so building a tree does not touch malloc at all and
+/// destroying one does not free anything.  Trees created by a factory must
+/// not outlive it, nor be used after the next call to clear(), which rewinds
+/// the arena so that it can be reused for the next symbol.
+class NodeFactory {
+  struct Slab {
+    Slab *Next;
+    size_t Size;
+  };
+
+  /// The slabs owned by this factory, most recently allocated first.
+  Slab *Slabs = nullptr;
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+
+  enum : size_t { InitialSlabSize = 4096, MaxSlabSize = 1024 * 1024 };
+
+  /// An allocator for shared_ptr control blocks that draws from the arena.
+  template <typename T>
+  struct ArenaAllocator {
+    typedef T value_type;
+
+    NodeFactory *Factory;
+
+    explicit ArenaAllocator(NodeFactory *Factory) : Factory(Factory) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &Other) : Factory(Other.Factory) {}
+
+    T *allocate(size_t N) {
+      return static_cast<T *>(Factory->allocate(N * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *, size_t) {
+      // Arena memory is only reclaimed in bulk.
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &Other) const {
+      return Factory == Other.Factory;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &Other) const {
+      return Factory != Other.Factory;
+    }
+  };
+
+  /// Runs the destructor of an arena-allocated node without freeing it.
+  struct ArenaDestroyer {
+    void operator()(Node *N) const { N->~Node(); }
+  };
+
+  void *allocateSlow(size_t Size, size_t Alignment);
+
+  template <typename... Args>
+  NodePointer createInArena(Args &&... args) {
+    void *Mem = allocate(sizeof(Node), alignof(Node));
+    Node *N = new (Mem) Node(this, std::forward<Args>(args)...);
+    return NodePointer(N, ArenaDestroyer(), ArenaAllocator<Node>(this));
+  }
+
+public:
+  NodeFactory() = default;
+  NodeFactory(const NodeFactory &) = delete;
+  NodeFactory &operator=(const NodeFactory &) = delete;
+  ~NodeFactory();
+
+  /// Allocate \p Size bytes of arena memory.
+  void *allocate(size_t Size, size_t Alignment) {
+    uintptr_t Aligned = (uintptr_t(CurPtr) + Alignment - 1) & ~(Alignment - 1);
+    if (!CurPtr || Aligned + Size > uintptr_t(End))
+      return allocateSlow(Size, Alignment);
+    CurPtr = reinterpret_cast<char *>(Aligned + Size);
+    return reinterpret_cast<void *>(Aligned);
+  }
+
+  /// Release all nodes created by this factory so that the arena can be
+  /// reused.  The largest slab is kept around for the next tree.
+  ///
+  /// No tree created by this factory may be alive when this is called.
+  void clear();
+
+  NodePointer createNode(Node::Kind K) {
+    return createInArena(K);
+  }
+  NodePointer createNode(Node::Kind K, Node::IndexType Index) {
+    return createInArena(K, Index);
+  }
+  NodePointer createNode(Node::Kind K, llvm::StringRef Text) {
+    return createInArena(K, Text.str());
+  }
+  NodePointer createNode(Node::Kind K, std::string &&Text) {
+    return createInArena(K, std::move(Text));
+  }
+  template <size_t N>
+  NodePointer createNode(Node::Kind K, const char (&Text)[N]) {
+    return createInArena(K, std::string(Text));
+  }
+
+  static NodePointer create(Node::Kind K) {
+    return NodePointer(new Node(nullptr, K));
+  }
+  static NodePointer create(Node::Kind K, Node::IndexType Index) {
+    return NodePointer(new Node(nullptr, K, Index));
+  }
+  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
+    return NodePointer(new Node(nullptr, K, Text.str()));
+  }
+  static NodePointer create(Node::Kind K, std::string &&Text) {
+    return NodePointer(new Node(nullptr, K, std::move(Text)));
+  }
+  template <size_t N>
+  static NodePointer create(Node::Kind K, const char (&Text)[N]) {
+    return NodePointer(new Node(nullptr, K, std::string(Text)));
+  }
+};
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
@@ -250,6 +402,15 @@ demangleSymbolAsNode(const std::string &mangledName,
   return demangleSymbolAsNode(mangledName.data(), mangledName.size(), options);
 }
 
+/// \brief Demangle the given string as a Swift symbol, allocating the nodes
+/// of the resulting tree in \p Factory.
+///
+/// The returned tree is only valid until \p Factory is cleared or destroyed.
+NodePointer
+demangleSymbolAsNode(const char *mangledName, size_t mangledNameLength,
+                     NodeFactory &Factory,
+                     const DemangleOptions &options = DemangleOptions());
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
@@ -300,6 +461,15 @@ demangleTypeAsNode(const std::string &mangledName,
   return demangleTypeAsNode(mangledName.data(), mangledName.size(), options);
 }
 
+/// \brief Demangle the given string as a Swift type, allocating the nodes of
+/// the resulting tree in \p Factory.
+///
+/// The returned tree is only valid until \p Factory is cleared or destroyed.
+NodePointer
+demangleTypeAsNode(const char *mangledName, size_t mangledNameLength,
+                   NodeFactory &Factory,
+                   const DemangleOptions &options = DemangleOptions());
+
 /// \brief Demangle the given string as a Swift type mangling.
 ///
 /// \param mangledName The mangled string.
@@ -350,25 +520,6 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
-  static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
-  }
-  static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
-  }
-  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
-  }
-  static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
-  }
-  template <size_t N>
-  static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
-  }
-};
-
   /// A class for printing to a std::string.
 class DemanglerPrinter {
 public:
@@ -27,6 +27,7 @@ namespace swift {
 namespace demangle_wrappers {
 
 using swift::Demangle::Node;
+using swift::Demangle::NodeFactory;
 using swift::Demangle::NodePointer;
 using swift::Demangle::DemangleOptions;
 
@@ -43,6 +44,10 @@ NodePointer
 demangleSymbolAsNode(StringRef MangledName,
                      const DemangleOptions &Options = DemangleOptions());
 
+NodePointer
+demangleSymbolAsNode(StringRef MangledName, NodeFactory &Factory,
+                     const DemangleOptions &Options = DemangleOptions());
+
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
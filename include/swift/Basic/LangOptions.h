@@ -121,6 +121,10 @@ namespace swift {
     /// This is for testing purposes.
     std::string DebugForbidTypecheckPrefix;
 
+    /// If non-empty, write the source range, type-check time and constraint
+    /// solver statistics of each expression to this file as JSON.
+    std::string ExpressionTypeCheckStatsPath;
+
     /// Number of parallel processes performing AST verification.
     unsigned ASTVerifierProcessCount = 1U;
 
@@ -153,6 +157,10 @@ namespace swift {
     /// Should we use \c ASTScope-based resolution for unqualified name lookup?
     bool EnableASTScopeLookup = false;
 
+    /// Should lookups into lazily-loaded types only load the members with the
+    /// base name being looked up?
+    bool NamedLazyMemberLoading = false;
+
     /// Whether to use the import as member inference system
     ///
     /// When importing a global, try to infer whether we can import it as a
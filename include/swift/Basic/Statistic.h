@@ -0,0 +1,84 @@
+//===--- Statistic.h - Per-job statistics for -stats-output-dir -*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_STATISTIC_H
+#define SWIFT_BASIC_STATISTIC_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/MapVector.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace swift {
+
+/// Collects the statistics of one driver or frontend job and writes them
+/// as one JSON object to a new file in the -stats-output-dir directory when
+/// it is destroyed.
+///
+/// The record holds the wall time of each SharedTimer phase, nested phases
+/// keyed by the path of their enclosing phases (e.g.
+/// "time.swift.IRGen.LLVM optimization.wall"), the counters the job set
+/// with setCounter (e.g. "AST.NumDecls" or "SIL.NumFunctions"), and the LLVM
+/// statistics, which include the deserialization and constraint solver
+/// counts. Since every job writes a file of its own, the records of all jobs
+/// of a build can be put in one directory and summed up by
+/// utils/process-stats-dir.py.
+///
+/// There is at most one reporter at a time, which can be reached through
+/// get().
+class UnifiedStatsReporter {
+  std::string Directory;
+  std::string ProgramName;
+  std::string AuxName;
+  std::chrono::steady_clock::time_point StartTime;
+
+  llvm::MapVector<std::string, int64_t> Counters;
+  llvm::MapVector<std::string, double> Timers;
+
+  struct Phase {
+    std::string Path;
+    std::chrono::steady_clock::time_point Start;
+  };
+  std::vector<Phase> Phases;
+
+  static UnifiedStatsReporter *Current;
+
+public:
+  /// \param ProgramName The name of the job's program, e.g. "swift-frontend".
+  /// \param AuxName Distinguishes the jobs of one program in a build, e.g.
+  ///   the module name and the primary input file.
+  /// \param Directory The directory to write the record to.
+  UnifiedStatsReporter(StringRef ProgramName, StringRef AuxName,
+                       StringRef Directory);
+  ~UnifiedStatsReporter();
+
+  UnifiedStatsReporter(const UnifiedStatsReporter &) = delete;
+  UnifiedStatsReporter &operator=(const UnifiedStatsReporter &) = delete;
+
+  /// The reporter of this process, or null if stats aren't collected.
+  static UnifiedStatsReporter *get() { return Current; }
+
+  void setCounter(StringRef Name, int64_t Value);
+  void addToCounter(StringRef Name, int64_t Delta);
+
+  /// Start timing a phase nested in the currently running phases.
+  void beginPhase(StringRef Name);
+
+  /// Stop timing the innermost running phase and add its time to the phase's
+  /// total.
+  void endPhase();
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_STATISTIC_H
@@ -21,6 +21,7 @@
 #include <functional>
 #include <memory>
 #include <queue>
+#include <string>
 
 namespace swift {
 namespace sys {
@@ -36,6 +37,10 @@ enum class TaskFinishedResponse {
   /// Indicates that execution should stop (no new tasks will begin execution,
   /// but tasks which are currently executing will be allowed to finish).
   StopExecution,
+  /// Indicates that execution should stop, and that the other tasks which are
+  /// currently executing should be terminated. (This may not be supported on
+  /// all platforms, in which case it behaves like StopExecution.)
+  TerminateExecution,
 };
 
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
@@ -46,6 +51,10 @@ class TaskQueue {
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+  /// The path of the socket of a compile server which runs frontend tasks,
+  /// or empty.
+  std::string ServerSocketPath;
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
@@ -95,6 +104,23 @@ public:
   typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef ErrorMsg,
                                              StringRef Output, void *Context)>
     TaskSignalledCallback;
+
+  /// \brief A callback which will be executed when a task produced output,
+  /// while the task is still executing.
+  ///
+  /// If this callback is given, all of the output of a task is passed to it
+  /// before the TaskFinishedCallback or TaskSignalledCallback of the task is
+  /// called. Those callbacks still receive the complete output.
+  ///
+  /// \param Pid the ProcessId of the task which produced output.
+  /// \param Output the output which the task produced since the last call.
+  /// \param Context the context which was passed when the task was added
+  ///
+  /// \returns a TaskFinishedResponse indicating whether or not execution
+  /// should proceed
+  typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef Output,
+                                             void *Context)>
+    TaskOutputCallback;
 #pragma clang diagnostic pop
 
   /// \brief Indicates whether TaskQueue supports buffering output on the
@@ -113,6 +139,14 @@ public:
   /// parallel
   unsigned getNumberOfParallelTasks() const;
 
+  /// \brief Run tasks which invoke the frontend in the compile server which
+  /// is listening on the Unix domain socket \p Path (see 'swift
+  /// -frontend-server'), instead of starting a new process for each task.
+  ///
+  /// A task falls back to starting a new process if the server cannot be
+  /// reached or can't run it. This is only supported on Unix.
+  void setServerSocketPath(StringRef Path) { ServerSocketPath = Path; }
+
   /// \brief Adds a task to the TaskQueue.
   ///
   /// \param ExecPath the path to the executable which the task should execute
@@ -130,12 +164,15 @@ public:
   /// \param Finished a callback which will be called when a task finishes
   /// \param Signalled a callback which will be called if a task exited
   /// abnormally due to a signal
+  /// \param Output a callback which will be called when an executing task
+  /// produced output, if the platform supports buffering output
   ///
   /// \returns true if all tasks did not execute successfully
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskOutputCallback Output = TaskOutputCallback());
 
   /// Returns true if there are any tasks that have been queued but have not
   /// yet been executed.
@@ -173,7 +210,8 @@ public:
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskOutputCallback Output = TaskOutputCallback());
 };
 
 } // end namespace sys
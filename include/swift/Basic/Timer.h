@@ -14,12 +14,17 @@
 #define SWIFT_BASIC_TIMER_H
 
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Statistic.h"
+#include "swift/Basic/TraceEvents.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Timer.h"
 
 namespace swift {
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
+  ///
+  /// The time is also recorded as a phase of the UnifiedStatsReporter and as
+  /// an event of the TraceEventRecorder, if there are any.
   class SharedTimer {
     enum class State {
       Initial,
@@ -29,15 +34,32 @@ namespace swift {
     static State CompilationTimersEnabled;
 
     Optional<llvm::NamedRegionTimer> Timer;
+    UnifiedStatsReporter *Stats;
+    TraceEventRecorder *Trace;
 
   public:
-    explicit SharedTimer(StringRef name) {
+    explicit SharedTimer(StringRef name)
+      : Stats(UnifiedStatsReporter::get()), Trace(TraceEventRecorder::get()) {
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
         CompilationTimersEnabled = State::Skipped;
+      if (Stats)
+        Stats->beginPhase(name);
+      if (Trace)
+        Trace->begin(name, "phase");
     }
 
+    ~SharedTimer() {
+      if (Trace)
+        Trace->end();
+      if (Stats)
+        Stats->endPhase();
+    }
+
+    SharedTimer(const SharedTimer &) = delete;
+    SharedTimer &operator=(const SharedTimer &) = delete;
+
     /// Must be called before any SharedTimers have been created.
     static void enableCompilationTimers() {
       assert(CompilationTimersEnabled != State::Skipped &&
@@ -0,0 +1,116 @@
+//===--- TraceEvents.h - Chrome trace events --------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_TRACEEVENTS_H
+#define SWIFT_BASIC_TRACEEVENTS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace swift {
+
+/// Records the phases of a driver or frontend job as events in the Chrome
+/// trace event format, which chrome://tracing and other trace viewers show
+/// as a timeline.
+///
+/// The driver writes one trace file with the scheduling and execution of
+/// its jobs. Each frontend job writes its events as a fragment, one event
+/// per line, to a file of its own in a directory the driver passes with
+/// -trace-events-dir; the driver adds the fragments to its trace once all
+/// jobs are done. Timestamps are microseconds of the system clock, so the
+/// events of all processes line up.
+///
+/// There is at most one recorder at a time, which can be reached through
+/// get(). It can be used from several threads, such as those of
+/// multi-threaded LLVM code generation; the events of each thread are shown
+/// in a row of their own.
+class TraceEventRecorder {
+  std::string OutputPath;
+  bool IsFragment;
+  int64_t Pid;
+
+  std::mutex Lock;
+  std::vector<std::string> Events;
+
+  struct OpenEvent {
+    std::string Name;
+    std::string Category;
+    int64_t Start;
+  };
+  struct ThreadState {
+    int64_t Tid;
+    std::vector<OpenEvent> OpenEvents;
+  };
+  std::map<std::thread::id, ThreadState> Threads;
+
+  /// The state of the calling thread. Must be called with Lock held.
+  ThreadState &getThreadState();
+  void addEvent(std::string &&Event);
+
+  static TraceEventRecorder *Current;
+
+public:
+  /// \param OutputPath The trace file to write, or for a fragment the
+  ///   directory to create a fragment file in.
+  /// \param ProcessName The name of the process's row in the timeline.
+  /// \param IsFragment Whether to write a fragment for the driver to merge
+  ///   instead of a complete trace file.
+  ///
+  /// The events of the thread creating the recorder are shown in row 0.
+  TraceEventRecorder(StringRef OutputPath, StringRef ProcessName,
+                     bool IsFragment);
+  ~TraceEventRecorder();
+
+  TraceEventRecorder(const TraceEventRecorder &) = delete;
+  TraceEventRecorder &operator=(const TraceEventRecorder &) = delete;
+
+  /// The recorder of this process, or null if no trace is recorded.
+  static TraceEventRecorder *get() { return Current; }
+
+  /// Microseconds since the epoch.
+  static int64_t now();
+
+  /// Start an event which lasts until the matching call to end().
+  void begin(StringRef Name, StringRef Category);
+
+  /// Finish the innermost event the calling thread started with begin().
+  /// Events shorter than
+  /// \p MinDuration microseconds are dropped, to keep traces of many small
+  /// events, such as SIL function passes, at a manageable size.
+  void end(int64_t MinDuration = 0);
+
+  /// Add an event which started at \p Start and took \p Duration
+  /// microseconds.
+  ///
+  /// \param Detail Shown as the "detail" argument of the event, if not empty.
+  /// \param Tid The row of the event, or -1 for the row of the calling
+  ///   thread.
+  void addCompleteEvent(StringRef Name, StringRef Category, int64_t Start,
+                        int64_t Duration, StringRef Detail = StringRef(),
+                        int64_t Tid = -1);
+
+  /// Add an event which marks a point in time.
+  void addInstantEvent(StringRef Name, StringRef Category, int64_t Time);
+
+  /// Add the events of the fragments in \p Directory, and remove them.
+  void addFragments(StringRef Directory);
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_TRACEEVENTS_H
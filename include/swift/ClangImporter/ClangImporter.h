@@ -70,6 +70,13 @@ private:
   ClangImporter(ASTContext &ctx, const ClangImporterOptions &clangImporterOpts,
                 DependencyTracker *tracker);
 
+  /// Imports the modules of the precompiled bridging header \p pchPath into
+  /// the shared imported header module.
+  ///
+  /// \sa importBridgingHeader
+  bool importBridgingPCH(StringRef pchPath, ModuleDecl *adapter,
+                         SourceLoc diagLoc);
+
 public:
   /// \brief Create a new Clang importer that can import a suitable Clang
   /// module into the given ASTContext.
@@ -189,7 +196,8 @@ public:
   /// Imports an Objective-C header file into the shared imported header module.
   ///
   /// \param header A header name or full path, to be used in a \#import
-  ///        directive.
+  ///        directive. This may also be the path of a precompiled bridging
+  ///        header, if it is the bridging header of the importer options.
   /// \param adapter The module that depends on the contents of this header.
   /// \param diagLoc A location to attach any diagnostics to if import fails.
   /// \param trackParsedSymbols If true, tracks decls and macros that were
@@ -202,6 +210,15 @@ public:
                             SourceLoc diagLoc = {},
                             bool trackParsedSymbols = false);
 
+  /// Emits a precompiled header for the bridging header \p headerPath.
+  ///
+  /// The precompiled header carries the Swift name lookup table for the
+  /// header, so frontend jobs which import it with -import-objc-header don't
+  /// need to parse the header or build the lookup table again.
+  ///
+  /// \returns true if there was an error emitting the precompiled header.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   /// Returns the module that contains imports and declarations from all loaded
   /// Objective-C header files.
   ///
@@ -24,12 +24,29 @@ public:
   /// The module cache path which the Clang importer should use.
   std::string ModuleCachePath;
 
+  /// A file whose modification time is the start time of the build session.
+  ///
+  /// \see ValidateModulesOnce
+  std::string BuildSessionFilePath;
+
+  /// If true, Clang modules in the module cache which were validated or built
+  /// after the start of the build session are used without checking their
+  /// inputs again. This saves the concurrent frontend jobs of a build from
+  /// each re-checking, and racing to rebuild, the same modules.
+  bool ValidateModulesOnce = false;
+
   /// Extra arguments which should be passed to the Clang importer.
   std::vector<std::string> ExtraArgs;
 
   /// A directory for overriding Clang's resource directory.
   std::string OverrideResourceDir;
 
+  /// The bridging header or precompiled bridging header to import.
+  ///
+  /// A precompiled bridging header is loaded while Clang is set up, which
+  /// also makes its serialized Swift name lookup table available.
+  std::string BridgingHeader;
+
   /// The target CPU to compile for.
   ///
   /// Equivalent to Clang's -mcpu=.
@@ -40,6 +40,7 @@ namespace swift {
 
 namespace driver {
   class Driver;
+  class OutputInfo;
   class ToolChain;
 
 /// An enum providing different levels of output which should be produced
@@ -121,6 +122,15 @@ private:
   /// even if they returned an error status.
   bool ContinueBuildingAfterErrors = false;
 
+  /// Indicates whether the output of subtasks should be shown while they are
+  /// executing, rather than once they finished.
+  bool StreamJobOutput = false;
+
+  /// Indicates whether subtasks which are executing should be terminated as
+  /// soon as one of them reports an error. Ignored if
+  /// ContinueBuildingAfterErrors is set.
+  bool CancelOnFirstError = false;
+
   /// Indicates whether tasks should only be executed if their output is out
   /// of date.
   bool EnableIncrementalBuild;
@@ -136,6 +146,17 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When non-null, compile jobs that are ready to run at the same time are
+  /// combined into batch jobs, constructed by this ToolChain.
+  const ToolChain *BatchModeToolChain = nullptr;
+
+  /// The OutputInfo used to construct batch jobs in batch mode.
+  std::unique_ptr<const OutputInfo> BatchModeOutputInfo;
+
+  /// When non-empty, frontend jobs are run by the compile server listening on
+  /// this socket.
+  std::string FrontendServerSocket;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -190,10 +211,33 @@ public:
     ContinueBuildingAfterErrors = Value;
   }
 
+  void setStreamJobOutput(bool Value = true) {
+    StreamJobOutput = Value;
+  }
+
+  void setCancelOnFirstError(bool Value = true) {
+    CancelOnFirstError = Value;
+  }
+
   void setShowsIncrementalBuildDecisions(bool value = true) {
     ShowIncrementalBuildDecisions = value;
   }
 
+  bool getBatchModeEnabled() const {
+    return BatchModeToolChain != nullptr;
+  }
+
+  /// Lets compile jobs in this compilation share frontend invocations, so
+  /// that files scheduled together are compiled by a single frontend process
+  /// with several primary files.
+  void enableBatchMode(const ToolChain &TC, const OutputInfo &OI);
+
+  /// Lets frontend jobs run in the compile server listening on \p Path,
+  /// instead of in new processes.
+  void setFrontendServerSocket(StringRef Path) {
+    FrontendServerSocket = Path;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
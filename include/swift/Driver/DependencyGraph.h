@@ -129,6 +129,22 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
+  /// The per-declaration hashes for each node, keyed by the kind and name of
+  /// the "provides" entry they belong to. These let a change to a node's
+  /// interface be narrowed down to the names it actually affects.
+  ///
+  /// \sa SourceFile::getDeclInterfaceHash
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>> DeclHashes;
+
+  /// The hash of the layouts of the types declared by each node. When it
+  /// changes, the node's per-declaration hashes aren't used.
+  llvm::DenseMap<const void *, std::string> TypeLayoutHashes;
+
+  /// The "provides" entries whose hashes changed in the most recent load of
+  /// each node. When present, marking through the node only follows these
+  /// entries.
+  llvm::DenseMap<const void *, std::vector<ProvidesEntryTy>> ChangedProvides;
+
   LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
@@ -182,6 +198,11 @@ protected:
     return Marked.count(node);
   }
 
+  bool hasDeclHashes(const void *node) const;
+
+  void getDirectDependents(SmallVectorImpl<const void *> &dependents,
+                           const void *node) const;
+
 public:
   llvm::iterator_range<StringSetIterator> getExternalDependencies() const {
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
@@ -243,6 +264,11 @@ public:
   /// ("depends") are not cleared; new dependencies are considered additive.
   ///
   /// If \p node has already been marked, only its outgoing edges are updated.
+  ///
+  /// If both this load and the previous one had per-declaration hashes and
+  /// the interface changed, only the "provides" entries whose hashes changed
+  /// are considered to affect downstream nodes; the next #markTransitive
+  /// starting at \p node follows just those entries.
   LoadResult loadFromPath(T node, StringRef path) {
     return DependencyGraphImpl::loadFromPath(Traits::getAsVoidPointer(node),
                                              path);
@@ -269,6 +295,10 @@ public:
   /// Marks \p node and all nodes that depend on \p node, and places any nodes
   /// that get transitively marked into \p visited.
   ///
+  /// If the last load of \p node narrowed its interface change down to some
+  /// of its "provides" entries, only dependents of those entries are
+  /// traversed from \p node.
+  ///
   /// Nodes that have been previously marked are not included in \p newlyMarked,
   /// nor are their successors traversed, <em>even if their "provides" set has
   /// been updated since it was marked.</em> (However, nodes that depend on the
@@ -312,6 +342,25 @@ public:
   bool isMarked(T node) const {
     return DependencyGraphImpl::isMarked(Traits::getAsVoidPointer(node));
   }
+
+  /// Returns true if the last load of \p node included per-declaration
+  /// hashes, so that a later change to it can be narrowed down to the names
+  /// it affects.
+  bool hasDeclHashes(T node) const {
+    return DependencyGraphImpl::hasDeclHashes(Traits::getAsVoidPointer(node));
+  }
+
+  /// Places the nodes which directly depend on something \p node provides
+  /// into \p dependents, without marking anything.
+  ///
+  /// A node which is not in the graph has no dependents.
+  template <unsigned N>
+  void getDirectDependents(SmallVector<T, N> &dependents, T node) const {
+    SmallVector<const void *, N> rawDependents;
+    DependencyGraphImpl::getDirectDependents(rawDependents,
+                                             Traits::getAsVoidPointer(node));
+    copyBack(dependents, rawDependents);
+  }
 };
 
 } // end namespace swift
@@ -26,6 +26,7 @@
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace swift {
@@ -46,7 +47,13 @@ class CommandOutput {
   /// from which the output file is derived.
   SmallVector<StringRef, 1> BaseInputs;
 
-  llvm::SmallDenseMap<types::ID, std::string, 4> AdditionalOutputsMap;
+  /// The additional outputs of the command, keyed by type.
+  ///
+  /// Usually there is one set for the whole command. A batch of compile jobs
+  /// has one set for each of its primary inputs, in the same order as the
+  /// primary outputs.
+  SmallVector<llvm::SmallDenseMap<types::ID, std::string, 4>, 1>
+      AdditionalOutputsMaps;
 
 public:
   CommandOutput(types::ID PrimaryOutputType)
@@ -70,8 +77,16 @@ public:
     return PrimaryOutputFilenames;
   }
   
-  void setAdditionalOutputForType(types::ID type, StringRef OutputFilename);
-  const std::string &getAdditionalOutputForType(types::ID type) const;
+  void setAdditionalOutputForType(types::ID type, StringRef OutputFilename,
+                                  unsigned Index = 0);
+  const std::string &getAdditionalOutputForType(types::ID type,
+                                                unsigned Index = 0) const;
+
+  /// Returns the number of sets of additional outputs, which is only greater
+  /// than one for a batch of compile jobs.
+  unsigned getNumAdditionalOutputSets() const {
+    return std::max<unsigned>(AdditionalOutputsMaps.size(), 1);
+  }
 
   const std::string &getAnyOutputForType(types::ID type) const;
 
@@ -80,6 +95,11 @@ public:
 
 class Job {
 public:
+  enum class Kind {
+    Standard,
+    Batch
+  };
+
   enum class Condition {
     Always,
     RunWithoutCascading,
@@ -120,19 +140,39 @@ private:
   /// The modification time of the main input file, if any.
   llvm::sys::TimeValue InputModTime = llvm::sys::TimeValue::MaxTime();
 
-public:
-  Job(const JobAction &Source,
+  /// Whether this is a plain Job or a BatchJob.
+  Kind JobKind;
+
+protected:
+  Job(Kind JobKind,
+      const JobAction &Source,
       SmallVectorImpl<const Job *> &&Inputs,
       std::unique_ptr<CommandOutput> Output,
       const char *Executable,
       llvm::opt::ArgStringList Arguments,
-      EnvironmentVector ExtraEnvironment = {},
-      FilelistInfo Info = {})
+      EnvironmentVector ExtraEnvironment,
+      FilelistInfo Info)
       : SourceAndCondition(&Source, Condition::Always),
         Inputs(std::move(Inputs)), Output(std::move(Output)),
         Executable(Executable), Arguments(std::move(Arguments)),
         ExtraEnvironment(std::move(ExtraEnvironment)),
-        FilelistFileInfo(std::move(Info)) {}
+        FilelistFileInfo(std::move(Info)), JobKind(JobKind) {}
+
+public:
+  Job(const JobAction &Source,
+      SmallVectorImpl<const Job *> &&Inputs,
+      std::unique_ptr<CommandOutput> Output,
+      const char *Executable,
+      llvm::opt::ArgStringList Arguments,
+      EnvironmentVector ExtraEnvironment = {},
+      FilelistInfo Info = {})
+      : Job(Kind::Standard, Source, std::move(Inputs), std::move(Output),
+            Executable, std::move(Arguments), std::move(ExtraEnvironment),
+            std::move(Info)) {}
+
+  virtual ~Job() = default;
+
+  Kind getKind() const { return JobKind; }
 
   const JobAction &getSource() const {
     return *SourceAndCondition.getPointer();
@@ -181,6 +221,31 @@ public:
                              const llvm::opt::ArgStringList &Args);
 };
 
+/// A Job that compiles the primary files of several compile Jobs in a single
+/// frontend invocation, so that the work they share (such as parsing the
+/// other files in the module and loading imported modules) is only done
+/// once.
+///
+/// A BatchJob is formed when its constituent Jobs are about to run; it is not
+/// part of the Compilation's list of Jobs.
+class BatchJob : public Job {
+  /// The Jobs whose work this Job performs.
+  SmallVector<const Job *, 4> CombinedJobs;
+
+public:
+  BatchJob(const JobAction &Source,
+           std::unique_ptr<CommandOutput> Output,
+           const char *Executable,
+           llvm::opt::ArgStringList Arguments,
+           EnvironmentVector ExtraEnvironment,
+           FilelistInfo Info,
+           ArrayRef<const Job *> Combined);
+
+  ArrayRef<const Job *> getCombinedJobs() const { return CombinedJobs; }
+
+  static bool classof(const Job *J) { return J->getKind() == Kind::Batch; }
+};
+
 } // end namespace driver
 } // end namespace swift
 
@@ -33,6 +33,10 @@ using swift::sys::ProcessId;
 /// \brief Emits a "began" message to the given stream.
 void emitBeganMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid);
 
+/// \brief Emits an "output" message to the given stream.
+void emitOutputMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
+                       StringRef Output);
+
 /// \brief Emits a "finished" message to the given stream.
 void emitFinishedMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
                          int ExitStatus, StringRef Output);
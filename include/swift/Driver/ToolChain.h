@@ -23,6 +23,7 @@
 
 namespace swift {
 namespace driver {
+  class BatchJob;
   class CommandOutput;
   class Compilation;
   class Driver;
@@ -122,6 +123,9 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual InvocationInfo
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
@@ -142,6 +146,10 @@ protected:
   /// This method is invoked by findProgramRelativeToSwift().
   virtual std::string findProgramRelativeToSwiftImpl(StringRef name) const;
 
+  /// Returns the path of the executable to use for \p invocationInfo.
+  const char *getExecutablePath(Compilation &C,
+                                const InvocationInfo &invocationInfo) const;
+
 public:
   virtual ~ToolChain() = default;
 
@@ -160,6 +168,16 @@ public:
                                     std::unique_ptr<CommandOutput> output,
                                     const OutputInfo &OI) const;
 
+  /// Construct a single Job that performs the work of all of \p jobs, which
+  /// must all be compile Jobs with a single primary input that were
+  /// constructed with the given \p OI.
+  ///
+  /// The resulting frontend invocation treats the primary input of each Job
+  /// as a primary file and produces all of their outputs.
+  std::unique_ptr<BatchJob> constructBatchJob(ArrayRef<const Job *> jobs,
+                                              Compilation &C,
+                                              const OutputInfo &OI) const;
+
   /// Return the default language type to use for the given extension.
   virtual types::ID lookupTypeForExtension(StringRef Ext) const;
 };
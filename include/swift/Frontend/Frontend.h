@@ -26,6 +26,7 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/LinkLibrary.h"
 #include "swift/AST/Module.h"
+#include "swift/AST/ReferencedNameTracker.h"
 #include "swift/AST/SearchPathOptions.h"
 #include "swift/AST/SILOptions.h"
 #include "swift/Parse/CodeCompletionCallbacks.h"
@@ -330,9 +331,28 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// The buffers and source files of FrontendOptions::BatchPrimaries, in the
+  /// same order.
+  SmallVector<unsigned, 4> BatchPrimaryBufferIDs;
+  SmallVector<SourceFile *, 4> BatchPrimarySourceFiles;
+
+  /// Name trackers for BatchPrimarySourceFiles, created when dependencies are
+  /// being tracked for the first primary file.
+  std::vector<std::unique_ptr<ReferencedNameTracker>> BatchNameTrackers;
+
+  /// The parser state of performSema(), which code completion keeps to parse
+  /// the declaration with the completion point again.
+  std::unique_ptr<PersistentParserState> PersistentState;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
+  /// Records \p SF as the primary source file for the buffer \p BufferID, if
+  /// it is one.
+  void notePossiblePrimarySourceFile(SourceFile *SF, unsigned BufferID);
+
+  bool isPrimaryBuffer(unsigned BufferID) const;
+
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
 
@@ -403,12 +423,43 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Gets the SourceFiles for the primary inputs after the first, in the
+  /// order of FrontendOptions::BatchPrimaries.
+  ArrayRef<SourceFile *> getBatchPrimarySourceFiles() const {
+    return BatchPrimarySourceFiles;
+  }
+
+  /// Returns true if \p SF is one of the primary inputs, or if there are no
+  /// primary inputs and so the whole module is being compiled.
+  bool isPrimarySourceFile(const SourceFile *SF) const;
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
   /// Parses and type-checks all input files.
   void performSema();
 
+  /// For code completion, after performSema() completed: the offsets of the
+  /// start of the declaration which contains the code completion point, and
+  /// of its last token, in the code completion buffer.
+  ///
+  /// \returns false if the code completion point is not in a declaration
+  /// that can be parsed again.
+  bool getCodeCompletionDeclRange(unsigned &StartOffset,
+                                  unsigned &EndOffset) const;
+
+  /// Complete again in \p NewBuffer, a new version of the code completion
+  /// buffer which only differs from it in the declaration given by
+  /// getCodeCompletionDeclRange(). The last token of the declaration starts
+  /// \p EndDelta bytes later in it, and the code completion point is at
+  /// \p Offset.
+  ///
+  /// Only this declaration is parsed and type-checked again; the rest of the
+  /// type-checked AST and the loaded modules are reused.
+  void performCodeCompletionAgain(llvm::MemoryBuffer *NewBuffer,
+                                  unsigned Offset, int EndDelta,
+                                  CodeCompletionCallbacksFactory *Factory);
+
   /// Parses the input file but does no type-checking or module imports.
   /// Note that this only supports parsing an invocation with a single file.
   void performParseOnly();
@@ -74,6 +74,27 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// An additional primary input, for a frontend invocation that compiles a
+  /// batch of primary files, and the outputs specific to it.
+  struct BatchPrimary {
+    /// The index of this primary file in InputFilenames.
+    unsigned InputIndex;
+
+    std::string OutputFilename;
+    std::string ModuleOutputPath;
+    std::string ModuleDocOutputPath;
+    std::string DependenciesFilePath;
+    std::string ReferenceDependenciesFilePath;
+  };
+
+  /// The primary inputs after the first, when several were given with
+  /// -primary-file.
+  ///
+  /// The first primary input is always described by PrimaryInput and the
+  /// usual output paths; these ones get code generated and outputs emitted
+  /// the same way, one after the other.
+  std::vector<BatchPrimary> BatchPrimaries;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -163,6 +184,8 @@ public:
     EmitIR, ///< Emit LLVM IR
     EmitBC, ///< Emit LLVM BC
     EmitObject, ///< Emit object file
+
+    EmitPCH, ///< Emit a precompiled bridging header
   };
 
   /// Indicates the action the user requested that the frontend perform.
@@ -175,6 +198,10 @@ public:
   /// debugger to use.
   bool AlwaysSerializeDebuggingOptions = false;
 
+  /// If set, an emitted module file which replaces a module with the same
+  /// interface keeps the modification time of the replaced file.
+  bool PreserveTimestampIfInterfaceUnchanged = false;
+
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
@@ -188,6 +215,10 @@ public:
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// If set, a job which only emits a module doesn't type-check the bodies of
+  /// functions which are not serialized into the module.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -219,6 +250,10 @@ public:
   /// \see ResilienceStrategy::Fragile
   bool SILSerializeAll = false;
 
+  /// Serialize the SIL of small public functions, even if they are not
+  /// fragile, so that client modules can inline and specialize them.
+  bool SILSerializeSmallFunctions = false;
+
   /// Indicates whether or not the frontend should print statistics upon
   /// termination.
   bool PrintStats = false;
@@ -227,6 +262,12 @@ public:
   /// termination.
   bool PrintClangStats = false;
 
+  /// The directory to write the JSON statistics of this job to, or empty.
+  std::string StatsOutputDir;
+
+  /// The directory to write the trace events of this job to, or empty.
+  std::string TraceEventsDir;
+
   /// Indicates whether the playground transformation should be applied.
   bool PlaygroundTransform = false;
 
@@ -392,10 +392,18 @@ public:
   SourceLoc consumeIdentifier(Identifier *Result = nullptr) {
     assert(Tok.isAny(tok::identifier, tok::kw_self, tok::kw_Self, tok::kw_throws));
     if (Result)
-      *Result = Context.getIdentifier(Tok.getText());
+      *Result = getIdentifierForToken(Tok);
     return consumeToken();
   }
 
+  /// \brief Retrieve the identifier for the text of \p T, reusing the hash
+  /// which the lexer computed for identifier tokens.
+  Identifier getIdentifierForToken(const Token &T) const {
+    if (T.hasIdentifierHash())
+      return Context.getIdentifier(T.getText(), T.getIdentifierHash());
+    return Context.getIdentifier(T.getText());
+  }
+
   /// \brief Retrieve the location just past the end of the previous
   /// source location.
   SourceLoc getEndOfPreviousLoc();
@@ -24,6 +24,7 @@
 
 namespace swift {
   class AbstractFunctionDecl;
+  class SourceManager;
 
 /// \brief Parser state persistent across multiple parses.
 class PersistentParserState {
@@ -160,6 +161,23 @@ public:
     return std::move(CodeCompletionDelayedDeclState);
   }
 
+  /// Keep the state of the delayed declaration once it was parsed, so that
+  /// it can be parsed again for a new version of its buffer.
+  void restoreDelayedDeclState(std::unique_ptr<DelayedDeclState> State) {
+    CodeCompletionDelayedDeclState = std::move(State);
+  }
+
+  /// The start of the last token of the delayed declaration.
+  SourceLoc getDelayedDeclEnd() {
+    return CodeCompletionDelayedDeclState->BodyEnd;
+  }
+
+  /// Move the delayed declaration from buffer \p OldBufferID to
+  /// \p NewBufferID, in which it starts at the same offset and its last token
+  /// starts \p EndDelta bytes later.
+  void moveDelayedDecl(SourceManager &SM, unsigned OldBufferID,
+                       unsigned NewBufferID, int EndDelta);
+
   TopLevelContext &getTopLevelContext() {
     return TopLevelCode;
   }
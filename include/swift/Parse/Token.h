@@ -68,6 +68,13 @@ class Token {
   
   /// \brief Whether this token is an escaped `identifier` token.
   unsigned EscapedIdentifier : 1;
+
+  /// \brief Whether IdentifierHash is set.
+  unsigned HasIdentifierHash : 1;
+
+  /// \brief The IdentifierTable hash of the text of an identifier token, which
+  /// the lexer computes while scanning it.
+  unsigned IdentifierHash;
   
   /// Text - The actual string covered by the token in the source buffer.
   StringRef Text;
@@ -80,7 +87,8 @@ class Token {
 
 public:
   Token() : Kind(tok::NUM_TOKENS), AtStartOfLine(false), CommentLength(0),
-            EscapedIdentifier(false) {}
+            EscapedIdentifier(false), HasIdentifierHash(false),
+            IdentifierHash(0) {}
   
   tok getKind() const { return Kind; }
   void setKind(tok K) { Kind = K; }
@@ -269,7 +277,10 @@ public:
     return Text;
   }
 
-  void setText(StringRef T) { Text = T; }
+  void setText(StringRef T) {
+    Text = T;
+    HasIdentifierHash = false;
+  }
 
   /// \brief Set the token to the specified kind and source range.
   void setToken(tok K, StringRef T, unsigned CommentLength = 0) {
@@ -277,6 +288,20 @@ public:
     Text = T;
     this->CommentLength = CommentLength;
     EscapedIdentifier = false;
+    HasIdentifierHash = false;
+  }
+
+  /// \brief Whether the lexer computed the hash of the text of this token.
+  bool hasIdentifierHash() const { return HasIdentifierHash; }
+
+  unsigned getIdentifierHash() const {
+    assert(HasIdentifierHash && "no hash computed for this token");
+    return IdentifierHash;
+  }
+
+  void setIdentifierHash(unsigned Hash) {
+    HasIdentifierHash = true;
+    IdentifierHash = Hash;
   }
 };
   
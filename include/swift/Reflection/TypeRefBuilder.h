@@ -296,6 +296,22 @@ public:
 private:
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The descriptors of the reflection infos indexed so far, by mangled
+  /// type name or remote address. If several images describe the same type,
+  /// the first one wins.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldTypeInfoIndex;
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeInfoIndex;
+  std::unordered_map<uintptr_t, const CaptureDescriptor *>
+    CaptureDescriptorIndex;
+
+  /// The number of reflection infos which are in the indexes.
+  unsigned NumIndexedReflectionInfos = 0;
+
+  /// Add the descriptors of any reflection infos added since the last lookup
+  /// to the indexes.
+  void indexReflectionInfos();
+
 public:
   TypeConverter &getTypeConverter() { return TC; }
 
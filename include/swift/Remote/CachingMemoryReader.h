@@ -0,0 +1,193 @@
+//===--- CachingMemoryReader.h - Page cache for remote memory ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares a MemoryReader which caches the memory of another
+//  MemoryReader in pages, so that many small reads from the same part of a
+//  remote process turn into a few large ones.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace swift {
+namespace remote {
+
+/// A MemoryReader which reads the memory of an underlying reader a page at
+/// a time and keeps the pages it has read.
+///
+/// The cache assumes that the remote memory doesn't change while it is in
+/// use. Clients which let the remote process run, or which read mutable
+/// memory such as heap objects across such a point, must invalidate the
+/// affected pages.
+class CachingMemoryReader final : public MemoryReader {
+  std::shared_ptr<MemoryReader> Underlying;
+  uint64_t PageSize;
+  size_t MaxCachedPages;
+
+  /// The cached pages, by page index.
+  std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  /// Returns the cached copy of the page with the given index, reading it
+  /// if necessary, or null if the page cannot be read as a whole.
+  const uint8_t *getPage(uint64_t pageIndex) {
+    auto found = Pages.find(pageIndex);
+    if (found != Pages.end())
+      return found->second.get();
+
+    if (Pages.size() >= MaxCachedPages)
+      Pages.clear();
+
+    std::unique_ptr<uint8_t[]> page(new uint8_t[PageSize]);
+    if (!Underlying->readBytes(RemoteAddress(pageIndex * PageSize),
+                               page.get(), PageSize))
+      return nullptr;
+    return (Pages[pageIndex] = std::move(page)).get();
+  }
+
+public:
+  /// \param pageSize The granularity of the reads from \p underlying; a
+  ///   power of two.
+  /// \param maxCachedPages The number of pages after which the cache is
+  ///   flushed.
+  CachingMemoryReader(std::shared_ptr<MemoryReader> underlying,
+                      uint64_t pageSize = 4096,
+                      size_t maxCachedPages = 16384)
+    : Underlying(std::move(underlying)), PageSize(pageSize),
+      MaxCachedPages(maxCachedPages) {
+    assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0 &&
+           "page size must be a power of two");
+  }
+
+  uint8_t getPointerSize() override {
+    return Underlying->getPointerSize();
+  }
+
+  uint8_t getSizeSize() override {
+    return Underlying->getSizeSize();
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return Underlying->getSymbolAddress(name);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    uint64_t addr = address.getAddressData();
+    uint64_t copied = 0;
+    while (copied < size) {
+      uint64_t offsetInPage = (addr + copied) & (PageSize - 1);
+      auto page = getPage((addr + copied) / PageSize);
+      // The range may end right before an unreadable page; let the
+      // underlying reader decide.
+      if (!page)
+        return Underlying->readBytes(RemoteAddress(addr + copied),
+                                     dest + copied, size - copied);
+      uint64_t chunk = std::min(PageSize - offsetInPage, size - copied);
+      memcpy(dest + copied, page + offsetInPage, chunk);
+      copied += chunk;
+    }
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    uint64_t addr = address.getAddressData();
+    std::string result;
+    while (true) {
+      uint64_t offsetInPage = addr & (PageSize - 1);
+      auto page = getPage(addr / PageSize);
+      if (!page) {
+        std::string rest;
+        if (!Underlying->readString(RemoteAddress(addr), rest))
+          return false;
+        dest = result + rest;
+        return true;
+      }
+      auto begin = reinterpret_cast<const char *>(page + offsetInPage);
+      uint64_t available = PageSize - offsetInPage;
+      if (auto end = static_cast<const char *>(memchr(begin, 0, available))) {
+        result.append(begin, end);
+        dest = std::move(result);
+        return true;
+      }
+      result.append(begin, available);
+      addr += available;
+    }
+  }
+
+  /// Read all pages in the given range into the cache with one read from
+  /// the underlying reader, ahead of many small reads from it.
+  ///
+  /// Returns false if the range could not be read; any pages which are
+  /// already cached stay valid.
+  bool prefetch(RemoteAddress address, uint64_t size) {
+    if (size == 0)
+      return true;
+    uint64_t firstPage = address.getAddressData() / PageSize;
+    uint64_t lastPage = (address.getAddressData() + size - 1) / PageSize;
+    uint64_t numPages = lastPage - firstPage + 1;
+    if (numPages > MaxCachedPages)
+      return false;
+    if (Pages.size() + numPages > MaxCachedPages)
+      Pages.clear();
+
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[numPages * PageSize]);
+    if (!Underlying->readBytes(RemoteAddress(firstPage * PageSize),
+                               buffer.get(), numPages * PageSize))
+      return false;
+
+    for (uint64_t i = 0; i < numPages; ++i) {
+      auto &page = Pages[firstPage + i];
+      if (!page)
+        page.reset(new uint8_t[PageSize]);
+      memcpy(page.get(), buffer.get() + i * PageSize, PageSize);
+    }
+    return true;
+  }
+
+  /// Drop the cached pages which overlap the given range.
+  void invalidate(RemoteAddress address, uint64_t size) {
+    if (size == 0)
+      return;
+    uint64_t firstPage = address.getAddressData() / PageSize;
+    uint64_t lastPage = (address.getAddressData() + size - 1) / PageSize;
+    if (lastPage - firstPage >= Pages.size()) {
+      for (auto it = Pages.begin(); it != Pages.end();) {
+        if (it->first >= firstPage && it->first <= lastPage)
+          it = Pages.erase(it);
+        else
+          ++it;
+      }
+      return;
+    }
+    for (uint64_t page = firstPage; page <= lastPage; ++page)
+      Pages.erase(page);
+  }
+
+  /// Drop all cached pages.
+  void invalidateAll() {
+    Pages.clear();
+  }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
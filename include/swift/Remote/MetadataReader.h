@@ -493,8 +493,9 @@ private:
     std::unique_ptr<const TargetProtocolDescriptor<Runtime>, delete_with_free>;
 
   /// Cached isa mask.
-  StoredPointer isaMask;
+  StoredPointer isaMask = 0;
   bool hasIsaMask = false;
+  bool triedToReadIsaMask = false;
 
 public:
   BuilderType Builder;
@@ -529,6 +530,11 @@ public:
 
   /// Get the remote process's swift_isaMask.
   std::pair<bool, StoredPointer> readIsaMask() {
+    // The mask is read for every instance, so only look up the symbol once.
+    if (triedToReadIsaMask)
+      return {hasIsaMask, isaMask};
+    triedToReadIsaMask = true;
+
     auto address = Reader->getSymbolAddress("swift_isaMask");
     if (!address)
       return {false, 0};
@@ -905,7 +911,10 @@ public:
       return std::make_pair(false, 0);
 
     auto heapMeta = cast<TargetHeapLocalVariableMetadata<Runtime>>(meta);
-    return std::make_pair(true, heapMeta->CaptureDescription);
+    if (heapMeta->CaptureDescription.isNull())
+      return std::make_pair(true, 0);
+    return std::make_pair(true, resolveRelativeOffset<int32_t>(
+        meta.getAddress() + heapMeta->offsetToCaptureDescriptionOffset()));
   }
 
 protected:
@@ -18,5 +18,16 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <stddef.h>
+
+namespace swift {
+
+/// If \p ptr was allocated by the runtime's magazine allocator, return the
+/// usable size of its block; otherwise return 0.  Anything that asks the
+/// system allocator for the size of memory from swift_slowAlloc must check
+/// this first.
+size_t _swift_getMagazineBlockSize(const void *ptr);
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
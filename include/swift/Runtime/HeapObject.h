@@ -635,6 +635,10 @@ static inline void swift_unownedTakeAssign(UnownedReference *dest,
 /*****************************************************************************/
 
 /// A weak reference value object.  This is ABI.
+///
+/// A native weak reference points to an entry in the runtime's weak reference
+/// side table rather than to the object, so that it doesn't keep the memory
+/// of a deallocated object alive. Its contents are private to the runtime.
 struct WeakReference {
   uintptr_t Value;
 };
@@ -66,6 +66,32 @@ extern "C" int _swift_sizeToIndex(size_t size);
 SWIFT_RUNTIME_EXPORT
 extern "C" void _swift_zone_init(void);
 
+/// Counters maintained by the runtime's optional magazine allocator, which
+/// serves small allocations from per-thread free lists.  Allocation and
+/// deallocation counts are published by each thread in batches, so they may
+/// lag slightly behind.
+struct SwiftMagazineAllocatorStatistics {
+  uint64_t MappedBytes;
+  uint64_t Allocations;
+  uint64_t Deallocations;
+  uint64_t DepotRefills;
+  uint64_t DepotFlushes;
+};
+
+/// Fill in \p stats and return true, or return false if the magazine
+/// allocator is not in use.
+SWIFT_RUNTIME_EXPORT
+extern "C" bool _swift_getMagazineAllocatorStatistics(
+    SwiftMagazineAllocatorStatistics *stats);
+
+/// Print the hits, misses and lock waits of the runtime's metadata and
+/// conformance caches and the bytes allocated for metadata to stderr, and
+/// return true, or return false if the process was not started with
+/// SWIFT_DEBUG_RUNTIME_STATISTICS set.  With it set, they are also printed
+/// when the process exits.
+SWIFT_RUNTIME_EXPORT
+extern "C" bool _swift_printRuntimeStatistics();
+
 };
 
 #endif
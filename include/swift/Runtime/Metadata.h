@@ -1801,7 +1801,15 @@ struct TargetHeapLocalVariableMetadata
   : public TargetHeapMetadata<Runtime> {
   using StoredPointer = typename Runtime::StoredPointer;
   uint32_t OffsetToFirstCapture;
-  TargetPointer<Runtime, const char> CaptureDescription;
+  /// The capture descriptor of the reflection metadata, or null. This is
+  /// relative so that the metadata doesn't need a rebase fixup for it.
+  TargetRelativeDirectPointer<Runtime, const char, /*nullable*/ true>
+    CaptureDescription;
+
+  StoredPointer offsetToCaptureDescriptionOffset() const {
+    return offsetof(TargetHeapLocalVariableMetadata<Runtime>,
+                    CaptureDescription);
+  }
 
   static bool classof(const TargetMetadata<Runtime> *metadata) {
     return metadata->getKind() == MetadataKind::HeapLocalVariable;
@@ -2516,6 +2524,12 @@ struct TargetGenericMetadata {
   /// The offset of the address point in the template in bytes.
   uint16_t AddressPoint;
 
+  /// A null-terminated list of instantiations which the compiler emitted as
+  /// constant data, or null.  Each element points to a cache entry, which is
+  /// preceded by the key arguments and followed by the metadata.  They are
+  /// added to the cache before the pattern is instantiated for the first time.
+  TargetPointer<Runtime, const TargetPointer<Runtime, void>> Prespecializations;
+
   /// Data that the runtime can use for its own purposes.  It is guaranteed
   /// to be zero-filled by the compiler.
   TargetPointer<Runtime, void>
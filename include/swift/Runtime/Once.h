@@ -32,11 +32,23 @@ typedef long swift_once_t;
 // On Cygwin, std::once_flag can not be used because it is larger than the
 // platform word.
 typedef uintptr_t swift_once_t;
-#else
 
-// On other platforms swift_once_t is std::once_flag
+#elif defined(_MSC_VER)
+
+// On Windows swift_once_t is std::once_flag
 typedef std::once_flag swift_once_t;
 
+#else
+
+// On other platforms swift_once_t is a word which the runtime moves from 0 to
+// SWIFT_ONCE_RUNNING while the initializer runs, and to SWIFT_ONCE_DONE once
+// it has returned. The "done" value is ABI: the compiler checks for it inline
+// and only calls swift_once if the token has a different value.
+typedef uintptr_t swift_once_t;
+
+#define SWIFT_ONCE_RUNNING ((swift_once_t)1)
+#define SWIFT_ONCE_DONE (~(swift_once_t)0)
+
 #endif
 
 /// Runs the given function with the given context argument exactly once.
@@ -39,6 +39,19 @@ public:
 
   void verify() const;
 
+  /// Update the tree after the edge \p From -> \p To was added to the CFG.
+  ///
+  /// Edges which cannot change the dominator tree are handled in constant
+  /// time. Otherwise the tree is recalculated.
+  void insertEdge(SILBasicBlock *From, SILBasicBlock *To);
+
+  /// Update the tree after the edge \p From -> \p To was removed from the
+  /// CFG.
+  ///
+  /// Edges which cannot change the dominator tree are handled in constant
+  /// time. Otherwise the tree is recalculated.
+  void deleteEdge(SILBasicBlock *From, SILBasicBlock *To);
+
   /// Return true if the other dominator tree does not match this dominator
   /// tree.
   inline bool errorOccurredOnComparison(const DominanceInfo &Other) const {
@@ -125,6 +125,14 @@ public:
   SILArgument(SILFunction::iterator ParentBB, SILType Ty,
               const ValueDecl *D = nullptr)
       : SILArgument(&*ParentBB, Ty, D) {}
+
+  /// Arguments are allocated with the module's argument allocator, which
+  /// reuses the memory of deleted arguments.
+  template <typename ContextTy>
+  void *operator new(size_t Bytes, const ContextTy &C,
+                     size_t Alignment = alignof(SILArgument)) {
+    return C.allocateArgument(Bytes, Alignment);
+  }
   SILArgument(SILFunction::iterator ParentBB, SILBasicBlock::bbarg_iterator Pos,
               SILType Ty, const ValueDecl *D = nullptr)
       : SILArgument(&*ParentBB, Pos, Ty, D) {}
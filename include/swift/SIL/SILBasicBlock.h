@@ -55,6 +55,14 @@ public:
   SILBasicBlock(SILFunction *F, SILBasicBlock *afterBB = nullptr);
   ~SILBasicBlock();
 
+  /// Blocks are allocated with the module's block allocator, which reuses the
+  /// memory of deleted blocks.
+  template <typename ContextTy>
+  void *operator new(size_t Bytes, const ContextTy &C,
+                     size_t Alignment = alignof(SILBasicBlock)) {
+    return C.allocateBlock(Bytes, Alignment);
+  }
+
   /// Gets the ID (= index in the function's block list) of the block.
   ///
   /// Returns -1 if the block is not contained in a function.
@@ -340,7 +348,7 @@ public:
   SILBasicBlock *provideInitialHead() const { return createSentinel(); }
   SILBasicBlock *ensureHead(SILBasicBlock*) const { return createSentinel(); }
   static void noteHead(SILBasicBlock*, SILBasicBlock*) {}
-  static void deleteNode(SILBasicBlock *BB) { BB->~SILBasicBlock(); }
+  static void deleteNode(SILBasicBlock *BB);
 
   void addNodeToList(SILBasicBlock *BB) {
   }
@@ -164,6 +164,10 @@ private:
   /// The function's effects attribute.
   EffectsKind EffectsKindAttr;
 
+  /// The number of times the function was entered according to the profile
+  /// passed with -profile-use, or None if there is no profile data for it.
+  Optional<uint64_t> EntryCount;
+
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
   bool Inlined = false;
@@ -176,6 +180,14 @@ private:
   ///    method itself. In this case we need to create a vtable stub for it.
   bool Zombie = false;
 
+  /// The epoch with which instructions of this function are stamped when
+  /// they change. See SILInstruction::getModificationEpoch().
+  unsigned ModificationEpoch = 1;
+
+  /// Whether instructions are stamped with ModificationEpoch when they
+  /// change. Only set once a pass asks for it.
+  bool TracksModifications = false;
+
   SILFunction(SILModule &module, SILLinkage linkage,
               StringRef mangledName, CanSILFunctionType loweredType,
               GenericEnvironment *genericEnv,
@@ -211,6 +223,22 @@ public:
 
   SILModule &getModule() const { return Module; }
 
+  /// Returns the current modification epoch of the function's instructions.
+  unsigned getModificationEpoch() const { return ModificationEpoch; }
+
+  /// Ends the current modification epoch and returns it. Instructions which
+  /// change from now on have a later epoch, so a pass can remember the
+  /// returned epoch to find the instructions which changed after it ran.
+  unsigned endModificationEpoch() { return ModificationEpoch++; }
+
+  /// Returns true if instructions are stamped with the modification epoch
+  /// when they change.
+  bool tracksModifications() const { return TracksModifications; }
+
+  /// Starts stamping instructions with the modification epoch when they
+  /// change. Instructions which changed before have an epoch of zero.
+  void startTrackingModifications() { TracksModifications = true; }
+
   SILType getLoweredType() const {
     return SILType::getPrimitiveObjectType(LoweredType);
   }
@@ -497,6 +525,13 @@ public:
     EffectsKindAttr = E;
   }
 
+  /// Get the profiled entry count of the function, if there is one.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+  void setEntryCount(Optional<uint64_t> Count) { EntryCount = Count; }
+
+  /// Returns true if the profile shows that the function was never entered.
+  bool isColdInProfile() const { return EntryCount && *EntryCount == 0; }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
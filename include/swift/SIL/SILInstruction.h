@@ -69,6 +69,10 @@ class SILInstruction : public ValueBase,public llvm::ilist_node<SILInstruction>{
   /// used for debug info and diagnostics.
   SILDebugLocation Location;
 
+  /// The modification epoch of the function at the last change of this
+  /// instruction.
+  unsigned ModificationEpoch = 0;
+
   friend struct llvm::ilist_sentinel_traits<SILInstruction>;
   SILInstruction() = delete;
   void operator=(const SILInstruction &) = delete;
@@ -128,6 +132,21 @@ public:
 
   SILModule &getModule() const;
 
+  /// Returns the modification epoch of the function at the last time this
+  /// instruction was inserted into a block, one of its operands was changed
+  /// or a use of it was added or removed.
+  ///
+  /// Passes which only look at an instruction, its operands and its uses can
+  /// compare this with SILFunction::endModificationEpoch() at the end of
+  /// their last run to skip instructions which didn't change since.
+  unsigned getModificationEpoch() const { return ModificationEpoch; }
+
+  /// Stamps this instruction with the current modification epoch of its
+  /// function. Does nothing if it is not in a block yet, in which case it is
+  /// stamped when it is inserted, or if the function doesn't track
+  /// modifications.
+  void markModified();
+
   /// This instruction's source location (AST node).
   SILLocation getLoc() const;
   const SILDebugScope *getDebugScope() const;
@@ -102,6 +102,18 @@ private:
   /// Allocator that manages the memory of all the pieces of the SILModule.
   mutable llvm::BumpPtrAllocator BPA;
 
+  /// The number of bytes requested through allocate and allocateInst.
+  mutable size_t BytesAllocated = 0;
+
+  /// The memory of deleted basic blocks and block arguments.
+  ///
+  /// Blocks and arguments are allocated from BPA, which does not free any
+  /// memory before the module is destroyed. So their memory is recycled for
+  /// new blocks and arguments, e.g. created by the inliner after dead function
+  /// elimination or SimplifyCFG erased others.
+  mutable std::vector<void *> FreeBlocks;
+  mutable std::vector<void *> FreeArguments;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -594,9 +606,27 @@ public:
   /// Allocate memory for an instruction using the module's internal allocator.
   void *allocateInst(unsigned Size, unsigned Align) const;
 
+  /// Returns the number of bytes allocated through allocate and allocateInst
+  /// so far. Memory which has been freed again is not subtracted.
+  size_t getBytesAllocated() const { return BytesAllocated; }
+
   /// Deallocate memory of an instruction.
   void deallocateInst(SILInstruction *I);
 
+  /// Allocate memory for a basic block, reusing the memory of a deleted block
+  /// if possible.
+  void *allocateBlock(unsigned Size, unsigned Align) const;
+
+  /// Deallocate memory of a destroyed basic block.
+  void deallocateBlock(SILBasicBlock *BB);
+
+  /// Allocate memory for a block argument, reusing the memory of a deleted
+  /// argument if possible.
+  void *allocateArgument(unsigned Size, unsigned Align) const;
+
+  /// Deallocate memory of a destroyed block argument.
+  void deallocateArgument(SILArgument *Arg);
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
@@ -264,6 +264,7 @@ private:
     if (!Back) return;
     *Back = NextUse;
     if (NextUse) NextUse->Back = Back;
+    markUseChanged();
   }
 
   void insertIntoCurrent() {
@@ -271,8 +272,13 @@ private:
     NextUse = TheValue->FirstUse;
     if (NextUse) NextUse->Back = &NextUse;
     TheValue->FirstUse = this;
+    markUseChanged();
   }
 
+  /// Updates the modification epochs of the user and of the instruction
+  /// which defines the used value.
+  void markUseChanged();
+
   friend class ValueBaseUseIterator;
   friend class ValueUseIterator;
   template <unsigned N> friend class FixedOperandList;
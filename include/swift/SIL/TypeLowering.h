@@ -402,8 +402,7 @@ class TypeConverter {
   friend class TypeLowering;
 
   llvm::BumpPtrAllocator IndependentBPA;
-  /// BumpPtrAllocator for types dependent on contextual generic parameters,
-  /// which is reset when the generic context is popped.
+  /// BumpPtrAllocator for types dependent on contextual generic parameters.
   llvm::BumpPtrAllocator DependentBPA;
 
   enum : unsigned {
@@ -494,12 +493,19 @@ class TypeConverter {
   /// Insert a mapping into the cache.
   void insert(TypeKey k, const TypeLowering *tl);
   
-  /// Mapping for types independent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
+  /// Mapping for types independent on contextual generic parameters.
   llvm::DenseMap<CachingTypeKey, const TypeLowering *> IndependentTypes;
-  /// Mapping for types dependent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
-  llvm::DenseMap<CachingTypeKey, const TypeLowering *> DependentTypes;
+
+  /// A type dependent on contextual generic parameters, together with the
+  /// generic context it is lowered in.
+  using DependentTypeKey = std::pair<GenericSignature *, CachingTypeKey>;
+
+  /// Mapping for types dependent on contextual generic parameters.
+  ///
+  /// The lowering of such a type only depends on the canonical signature of
+  /// the generic context, so the entries are kept when the context is popped
+  /// and reused by all functions with the same generic signature.
+  llvm::DenseMap<DependentTypeKey, const TypeLowering *> DependentTypes;
   
   llvm::DenseMap<SILDeclRef, SILConstantInfo> ConstantTypes;
   
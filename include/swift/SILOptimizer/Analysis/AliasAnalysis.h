@@ -14,10 +14,12 @@
 #define SWIFT_SILOPTIMIZER_ANALYSIS_ALIASANALYSIS_H
 
 #include "swift/Basic/ValueEnumerator.h"
+#include "swift/SIL/Projection.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 
 using swift::RetainObserveKind;
 
@@ -127,6 +129,31 @@ private:
   /// because doing so could give rise to collisions in the other cache.
   ValueEnumerator<ValueBase*> MemoryBehaviorValueBaseToIndex;
 
+  /// The underlying object of a value and the projection path from the
+  /// object to the value.
+  struct AccessPath {
+    SILValue Object;
+    Optional<ProjectionPath> Path;
+    bool HasPath = false;
+  };
+
+  /// Caches the access paths of the values which appear in alias queries.
+  /// Each value is queried against many other values, and computing the
+  /// access path walks the whole chain of its projections.
+  ///
+  /// Like the other caches, this cache is valid until the analysis is
+  /// invalidated.
+  llvm::DenseMap<ValueBase *, AccessPath> AccessPathCache;
+
+  /// The underlying objects in AccessPathCache.
+  llvm::DenseSet<ValueBase *> AccessPathObjects;
+
+  /// Returns the underlying object of \p V.
+  SILValue getUnderlyingObjectCached(SILValue V);
+
+  /// Returns the projection path from the underlying object of \p V to \p V.
+  Optional<ProjectionPath> getProjectionPathCached(SILValue V);
+
   AliasResult aliasAddressProjection(SILValue V1, SILValue V2,
                                      SILValue O1, SILValue O2);
 
@@ -144,6 +171,15 @@ private:
     // from the cache that translates pointers to indices.
     AliasValueBaseToIndex.invalidateValue(I);
     MemoryBehaviorValueBaseToIndex.invalidateValue(I);
+
+    // A new value may be allocated at the same address, so the entry of I
+    // must go away, too. This is rare for underlying objects, which are
+    // kept alive by their projections, so just flush the cache then.
+    AccessPathCache.erase(I);
+    if (AccessPathObjects.count(I)) {
+      AccessPathCache.clear();
+      AccessPathObjects.clear();
+    }
   }
 
   virtual bool needsNotifications() override { return true; }
@@ -266,6 +302,8 @@ public:
   virtual void invalidate(SILAnalysis::InvalidationKind K) override {
     AliasCache.clear();
     MemoryBehaviorCache.clear();
+    AccessPathCache.clear();
+    AccessPathObjects.clear();
   }
 
   virtual void invalidate(SILFunction *,
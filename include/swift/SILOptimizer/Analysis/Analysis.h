@@ -16,6 +16,8 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "swift/SIL/Notifications.h"
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_ANALYSIS_ANALYSIS_H
@@ -62,14 +64,25 @@ namespace swift {
       /// recomputed so that they are not holding dangling pointers.
       Functions = 0x8,
 
+      /// The pass modified some branches, but kept the dominator tree and the
+      /// loop info up to date.
+      ///
+      /// Analyses which are derived from the CFG in other ways, like the
+      /// PostOrder Analysis, must still be invalidated.
+      BranchesPreservingDominance = 0x10,
+
       /// Convenience states:
       FunctionBody = Calls | Branches | Instructions,
 
+      FunctionBodyPreservingDominance =
+          Calls | BranchesPreservingDominance | Instructions,
+
       CallsAndInstructions = Calls | Instructions,
 
       BranchesAndInstructions = Branches | Instructions,
 
-      Everything = Functions | Calls | Branches | Instructions,
+      Everything = Functions | Calls | Branches | BranchesPreservingDominance |
+                   Instructions,
     };
 
     /// A list of the known analysis.
@@ -87,7 +100,21 @@ namespace swift {
     /// this analysis.
     bool invalidationLock;
 
+    /// The number of pass managers which are running function passes on
+    /// several threads.
+    static std::atomic<unsigned> NumParallelPassManagers;
+
   public:
+    /// Returns true if function passes may be running on several threads, in
+    /// which case analyses must guard their caches.
+    static bool isRunningInParallel() {
+      return NumParallelPassManagers.load(std::memory_order_relaxed) != 0;
+    }
+
+    /// Called by the pass manager before it starts and after it has joined
+    /// the threads running function passes.
+    static void beginRunningInParallel() { ++NumParallelPassManagers; }
+    static void endRunningInParallel() { --NumParallelPassManagers; }
 
     /// Returns the kind of derived class.
     AnalysisKind getKind() const { return Kind; }
@@ -144,6 +171,27 @@ namespace swift {
     static void verifyFunction(SILFunction *F);
   };
 
+  /// A lock guard which only takes its mutex while function passes may be
+  /// running on several threads, so that serial pipelines don't pay for it.
+  template<typename MutexTy>
+  class ParallelPassLockGuard {
+    MutexTy *Lock;
+
+  public:
+    explicit ParallelPassLockGuard(MutexTy &M)
+        : Lock(SILAnalysis::isRunningInParallel() ? &M : nullptr) {
+      if (Lock)
+        Lock->lock();
+    }
+    ~ParallelPassLockGuard() {
+      if (Lock)
+        Lock->unlock();
+    }
+
+    ParallelPassLockGuard(const ParallelPassLockGuard &) = delete;
+    ParallelPassLockGuard &operator=(const ParallelPassLockGuard &) = delete;
+  };
+
   /// An abstract base class that implements the boiler plate of caching and
   /// invalidating analysis for specific functions.
   template<typename AnalysisTy>
@@ -154,6 +202,10 @@ namespace swift {
     /// Maps functions to their analysis provider.
     StorageTy Storage;
 
+    /// Guards Storage while function passes run on different functions at
+    /// the same time, so that they can query and invalidate the analysis.
+    std::mutex StorageLock;
+
     /// Construct a new empty analysis for a specific function \p F.
     virtual AnalysisTy *newFunctionAnalysis(SILFunction *F) = 0;
 
@@ -172,15 +224,29 @@ namespace swift {
       // Check that the analysis can handle this function.
       verifyFunction(F);
 
+      {
+        ParallelPassLockGuard<std::mutex> Guard(StorageLock);
+        if (AnalysisTy *A = Storage.lookup(F))
+          return A;
+      }
+
+      // Compute the analysis without holding the lock, so that other
+      // functions can be analyzed at the same time.
+      AnalysisTy *A = newFunctionAnalysis(F);
+
+      ParallelPassLockGuard<std::mutex> Guard(StorageLock);
       auto &it = Storage.FindAndConstruct(F);
-      if (!it.second)
-        it.second = newFunctionAnalysis(F);
+      if (it.second)
+        delete A;
+      else
+        it.second = A;
       return it.second;
     }
 
     virtual void invalidate(SILAnalysis::InvalidationKind K) override {
       if (!shouldInvalidate(K)) return;
 
+      ParallelPassLockGuard<std::mutex> Guard(StorageLock);
       for (auto D : Storage)
         delete D.second;
 
@@ -191,6 +257,7 @@ namespace swift {
                             SILAnalysis::InvalidationKind K) override {
       if (!shouldInvalidate(K)) return;
 
+      ParallelPassLockGuard<std::mutex> Guard(StorageLock);
       auto &it = Storage.FindAndConstruct(F);
       if (it.second) {
         delete it.second;
@@ -66,6 +66,9 @@ public:
     return IndirectSubclassesCache[C];
   }
 
+  /// Returns a list of the types in the current module which conform to the
+  /// protocol \p P, including types of other modules which are extended to
+  /// conform to \p P.
   const NominalTypeList &getProtocolImplementations(ProtocolDecl *P) {
     return ProtocolImplementationsCache[P];
   }
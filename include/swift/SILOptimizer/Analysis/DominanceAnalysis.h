@@ -74,7 +74,8 @@ public:
   }
 
   virtual bool shouldInvalidate(SILAnalysis::InvalidationKind K) override {
-    return K & InvalidationKind::Branches;
+    return K & (InvalidationKind::Branches |
+                InvalidationKind::BranchesPreservingDominance);
   }
 };
 
@@ -98,7 +98,8 @@ protected:
   }
 
   virtual bool shouldInvalidate(SILAnalysis::InvalidationKind K) override {
-    return K & InvalidationKind::Branches;
+    return K & (InvalidationKind::Branches |
+                InvalidationKind::BranchesPreservingDominance);
   }
 
 public:
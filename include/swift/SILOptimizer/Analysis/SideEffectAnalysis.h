@@ -20,6 +20,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include <mutex>
 
 namespace swift {
 
@@ -40,6 +41,17 @@ enum class RetainObserveKind {
 /// objects? etc.
 /// For details see SideEffectAnalysis::FunctionEffects and
 /// SideEffectAnalysis::Effects.
+///
+/// The effects are recomputed in every frontend invocation. Caching them on
+/// disk keyed by a hash of the function body would not be sound by itself:
+/// the effects of a function include those of its transitive callees, so the
+/// key would have to cover the bodies of the whole call graph below it, and
+/// of all overrides reachable through class_method and witness_method, which
+/// BasicCalleeAnalysis and ClassHierarchyAnalysis only know for the current
+/// module. Those two analyses have no per-function state worth caching; they
+/// are a single walk over the module's vtables, witness tables and classes.
+/// Effects which are known from another module come from the effects
+/// attribute which the ExportFunctionEffects pass serializes.
 class SideEffectAnalysis : public BottomUpIPAnalysis {
 public:
 
@@ -322,6 +334,11 @@ private:
   /// Callee analysis, used for determining the callees at call sites.
   BasicCalleeAnalysis *BCA;
 
+  /// Serializes queries and invalidations while function passes run on
+  /// several threads. It is recursive because computing
+  /// the effects of a call site queries the effects of its callees.
+  std::recursive_mutex Lock;
+
   /// Get the side-effects of a function, which has an @effects attribute.
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
@@ -370,6 +387,7 @@ public:
   
   /// Get the side-effects of a function.
   const FunctionEffects &getEffects(SILFunction *F) {
+    ParallelPassLockGuard<std::recursive_mutex> Guard(Lock);
     FunctionInfo *FInfo = getFunctionInfo(F);
     if (!FInfo->isValid())
       recompute(FInfo);
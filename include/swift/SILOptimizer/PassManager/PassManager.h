@@ -15,8 +15,10 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <mutex>
 #include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
@@ -24,6 +26,7 @@
 
 namespace swift {
 
+class BottomUpFunctionOrder;
 class SILFunction;
 class SILFunctionTransform;
 class SILModule;
@@ -75,6 +78,12 @@ class SILPassManager {
   /// A completed-passes mask for each function.
   llvm::DenseMap<SILFunction *, CompletedPasses> CompletedPassesMap;
 
+  /// For each function, the modification epochs of the function at the end
+  /// of the last runs of passes on it, by pass kind. Only passes which use
+  /// setLastRunEpoch have an entry.
+  llvm::DenseMap<SILFunction *, llvm::SmallDenseMap<unsigned, unsigned, 2>>
+    LastRunEpochs;
+
   /// Stores for each function the number of levels of specializations it is
   /// derived from an original function. E.g. if a function is a signature
   /// optimized specialization of a generic specialization, it has level 2.
@@ -85,10 +94,23 @@ class SILPassManager {
   /// Set to true when a pass invalidates an analysis.
   bool CurrentPassHasInvalidated = false;
 
+  /// Set to true when a pass invalidates the analyses of the whole module,
+  /// rather than of single functions.
+  bool CurrentPassHasInvalidatedModule = false;
+
+  /// The functions whose analyses the current module pass has invalidated.
+  /// With -sil-verify-invalidated-only only these are verified after the
+  /// pass.
+  llvm::DenseSet<SILFunction *> InvalidatedFunctions;
+
   /// True if we need to stop running passes and restart again on the
   /// same function.
   bool RestartPipeline = false;
 
+  /// Guards the pass manager's bookkeeping and the broadcast of
+  /// invalidations while function passes run on several threads.
+  std::mutex ParallelLock;
+
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
   /// in Analysis.def.
@@ -132,11 +154,30 @@ public:
         AP->invalidate(K);
 
     CurrentPassHasInvalidated = true;
+    CurrentPassHasInvalidatedModule = true;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
   }
 
+  /// Returns the modification epoch of \p F at the end of the last run of
+  /// the pass \p Kind on it, or zero if it didn't record one. Instructions
+  /// with a later epoch changed since; see
+  /// SILInstruction::getModificationEpoch().
+  unsigned getLastRunEpoch(PassKind Kind, SILFunction *F) const {
+    auto Epochs = LastRunEpochs.find(F);
+    if (Epochs == LastRunEpochs.end())
+      return 0;
+    auto Epoch = Epochs->second.find((unsigned)Kind);
+    return Epoch == Epochs->second.end() ? 0 : Epoch->second;
+  }
+
+  /// Records the modification epoch of \p F at the end of a run of the pass
+  /// \p Kind on it.
+  void setLastRunEpoch(PassKind Kind, SILFunction *F, unsigned Epoch) {
+    LastRunEpochs[F][(unsigned)Kind] = Epoch;
+  }
+
   /// \brief Add the function \p F to the function pass worklist.
   /// If not null, the function \p DerivedFrom is the function from which \p F
   /// is derived. This is used to avoid an infinite amount of functions pushed
@@ -154,31 +195,13 @@ public:
 
   /// \brief Broadcast the invalidation of the function to all analysis.
   void invalidateAnalysis(SILFunction *F,
-                          SILAnalysis::InvalidationKind K) {
-    // Invalidate the analysis (unless they are locked)
-    for (auto AP : Analysis)
-      if (!AP->isLocked())
-        AP->invalidate(F, K);
-    
-    CurrentPassHasInvalidated = true;
-    // Any change let all passes run again.
-    CompletedPassesMap[F].reset();
-  }
+                          SILAnalysis::InvalidationKind K);
 
   /// \brief Broadcast the invalidation of the function to all analysis.
   /// And we also know this function is dead and will be removed from the
   /// module.
   void invalidateAnalysisForDeadFunction(SILFunction *F,
-                                         SILAnalysis::InvalidationKind K) {
-    // Invalidate the analysis (unless they are locked)
-    for (auto AP : Analysis)
-      if (!AP->isLocked())
-        AP->invalidateForDeadFunction(F, K);
-    
-    CurrentPassHasInvalidated = true;
-    // Any change let all passes run again.
-    CompletedPassesMap[F].reset();
-  }
+                                         SILAnalysis::InvalidationKind K);
 
   /// \brief Reset the state of the pass manager and remove all transformation
   /// owned by the pass manager. Analysis passes will be kept.
@@ -190,6 +213,10 @@ public:
   /// D'tor.
   ~SILPassManager();
 
+  /// Returns true if the pass which just ran should be followed by
+  /// verification, according to -sil-verify-sample-rate.
+  bool shouldVerifyAfterPass() const;
+
   /// Verify all analyses.
   void verifyAnalyses() const {
     for (auto *A : Analysis) {
@@ -228,11 +255,25 @@ private:
   /// Run the pass \p SFT on the function \p F.
   void runPassOnFunction(SILFunctionTransform *SFT, SILFunction *F);
 
+  /// Run the pass \p SFT on the function \p F from a worker thread of
+  /// runFunctionPassesInParallel.
+  void runPassOnFunctionInParallel(SILFunctionTransform *SFT, SILFunction *F);
+
   /// Run the passes in \p FuncTransforms. Return true
   /// if the pass manager requested to stop the execution
   /// of the optimization cycle (this is a debug feature).
   void runFunctionPasses(PassList FuncTransforms);
 
+  /// Return true if the passes in \p FuncTransforms may run on several
+  /// functions at the same time.
+  bool canRunFunctionPassesInParallel(PassList FuncTransforms);
+
+  /// Run the passes in \p FuncTransforms on several threads. Functions are
+  /// scheduled so that a function's callees are processed before it, as in
+  /// the serial bottom-up order \p BottomUpOrder.
+  void runFunctionPassesInParallel(PassList FuncTransforms,
+                                   BottomUpFunctionOrder &BottomUpOrder);
+
   /// A helper function that returns (based on SIL stage and debug
   /// options) whether we should continue running passes.
   bool continueTransforming();
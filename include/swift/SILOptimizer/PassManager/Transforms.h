@@ -90,6 +90,16 @@ namespace swift {
     /// The entry point to the transformation.
     virtual void run() = 0;
 
+    /// Returns true if the pass can run on several functions at the same
+    /// time, each on its own instance of the pass.
+    ///
+    /// Such a pass must not create or delete functions, and must not change
+    /// the SIL, because SILModule allocation and delete notifications are not
+    /// thread-safe. It may only query analyses which tolerate concurrent
+    /// queries: the ones derived from FunctionAnalysisBase, and
+    /// SideEffectAnalysis.
+    virtual bool isParallelSafe() const { return false; }
+
     static bool classof(const SILTransform *S) {
       return S->getKind() == TransformKind::Function;
     }
@@ -0,0 +1,46 @@
+//===--- ConstantEvaluation.h - Evaluate calls at compile time --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a small SIL interpreter which evaluates calls of functions
+// with constant arguments at compile time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_UTILS_CONSTANTEVALUATION_H
+#define SWIFT_SILOPTIMIZER_UTILS_CONSTANTEVALUATION_H
+
+#include "swift/SIL/SILInstruction.h"
+
+namespace swift {
+
+/// Returns true if \p AI is a call which constantEvaluateApply might be able
+/// to fold: a direct call of a non-generic function with a body, whose
+/// arguments are integer literals, thin metatypes or structs and tuples of
+/// them, and whose result is returned directly.
+bool isConstantEvaluationCandidate(ApplyInst *AI);
+
+/// Evaluates the call \p AI at compile time, by interpreting the body of the
+/// callee and of the functions it calls.
+///
+/// Only integer builtins, structs, tuples, branches and calls are
+/// interpreted. Evaluation gives up on anything else, e.g. memory
+/// operations, on a cond_fail which fails and after \p StepLimit
+/// instructions.
+///
+/// \returns the result of the call, built from literals right before \p AI,
+/// or a null value if the call could not be evaluated. \p AI itself is not
+/// changed.
+SILValue constantEvaluateApply(ApplyInst *AI, unsigned StepLimit);
+
+} // end namespace swift
+
+#endif
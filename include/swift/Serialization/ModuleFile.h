@@ -287,6 +287,27 @@ private:
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
 
+  /// A Bloom filter of the names in a decl table.
+  class DeclNameFilter {
+    StringRef Bits;
+    unsigned NumHashes = 0;
+
+  public:
+    void set(StringRef bits, unsigned numHashes) {
+      Bits = bits;
+      NumHashes = numHashes;
+    }
+
+    /// Returns false if \p name is definitely not in the table, and true if
+    /// it may be, or if there is no filter.
+    bool mayContain(Identifier name) const;
+  };
+
+  DeclNameFilter TopLevelDeclsFilter;
+  DeclNameFilter OperatorDeclsFilter;
+  DeclNameFilter ExtensionDeclsFilter;
+  DeclNameFilter OperatorMethodDeclsFilter;
+
   class ObjCMethodTableInfo;
   using SerializedObjCMethodTable =
     llvm::OnDiskIterableChainedHashTable<ObjCMethodTableInfo>;
@@ -24,6 +24,7 @@
 #include "llvm/Bitcode/RecordLayout.h"
 #include "llvm/Bitcode/BitCodes.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
+#include "llvm/ADT/StringExtras.h"
 
 namespace swift {
 namespace serialization {
@@ -54,7 +55,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 273; // Last change: partial_apply ownership control
+const uint16_t VERSION_MINOR = 277; // Last change: decl name filters
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -446,7 +447,8 @@ namespace options_block {
     XCC,
     IS_SIB,
     IS_TESTABLE,
-    RESILIENCE_STRATEGY
+    RESILIENCE_STRATEGY,
+    INTERFACE_HASH
   };
 
   using SDKPathLayout = BCRecordLayout<
@@ -472,6 +474,11 @@ namespace options_block {
     RESILIENCE_STRATEGY,
     BCFixed<2>
   >;
+
+  using InterfaceHashLayout = BCRecordLayout<
+    INTERFACE_HASH,
+    BCBlob // hash of everything clients of the module can depend on
+  >;
 }
 
 /// The record types within the input block.
@@ -1458,11 +1465,15 @@ namespace index_block {
     NORMAL_CONFORMANCE_OFFSETS,
 
     PRECEDENCE_GROUPS,
+
+    /// A Bloom filter of the names in one of the decl tables, which rules out
+    /// most names which aren't in the table without probing it.
+    DECL_NAME_FILTER,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
     BCFixed<4>,  // record ID
-    BCArray<BitOffsetField>
+    BCBlob  // little-endian uint32_t bit offsets, one per entity
   >;
 
   using DeclListLayout = BCGenericRecordLayout<
@@ -1486,6 +1497,30 @@ namespace index_block {
     ENTRY_POINT,
     DeclIDField  // the ID of the main class; 0 if there was a main source file
   >;
+
+  using DeclNameFilterLayout = BCRecordLayout<
+    DECL_NAME_FILTER,
+    BCFixed<4>,  // the record ID of the decl table
+    BCVBR<4>,    // the number of bits which are set for each name
+    BCBlob       // the bits of the filter, least significant bit first
+  >;
+
+  /// Calls \p fn with the index of each of the \p numHashes bits of a
+  /// DECL_NAME_FILTER of \p numBits bits which are set for \p name.
+  template <typename Fn>
+  inline void forEachDeclNameFilterBit(StringRef name, unsigned numHashes,
+                                       uint64_t numBits, Fn fn) {
+    // Combine two independent hashes, the one of the decl tables and FNV-1a,
+    // to get as many hashes as needed.
+    uint32_t hash1 = llvm::HashString(name);
+    uint32_t hash2 = 2166136261u;
+    for (unsigned char c : name) {
+      hash2 ^= c;
+      hash2 *= 16777619u;
+    }
+    for (unsigned i = 0; i != numHashes; ++i)
+      fn((hash1 + i * uint64_t(hash2)) % numBits);
+  }
 }
 
 /// \sa COMMENT_BLOCK_ID
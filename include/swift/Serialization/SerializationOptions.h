@@ -37,8 +37,14 @@ namespace swift {
 
     bool AutolinkForceLoad = false;
     bool SerializeAllSIL = false;
+    bool SerializeSmallFunctions = false;
     bool SerializeOptionsForDebugging = false;
     bool IsSIB = false;
+
+    /// If set, a whole module records a hash of its interface. If the
+    /// module is written over a module with the same interface hash, it keeps
+    /// the modification time of the old file.
+    bool PreserveTimestampIfInterfaceUnchanged = false;
   };
 
 } // end namespace swift
@@ -15,6 +15,7 @@
 
 #include "swift/AST/Module.h"
 #include "swift/AST/ModuleLoader.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace swift {
@@ -29,8 +30,22 @@ private:
   using LoadedModulePair = std::pair<std::unique_ptr<ModuleFile>, unsigned>;
   std::vector<LoadedModulePair> LoadedModuleFiles;
 
+  /// The names of the entries of each search path which was looked at, if
+  /// SearchPathOptions::CacheSearchPathContents is set, or null if the
+  /// directory could not be read.
+  llvm::StringMap<std::unique_ptr<llvm::StringSet<>>> SearchPathContents;
+
   explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker);
 
+  /// Returns false if the directory \p dirName is known not to contain an
+  /// entry named \p name, so that looking for a module there can be skipped.
+  bool searchPathMayContain(StringRef dirName, StringRef name);
+
+  bool findModule(std::pair<Identifier, SourceLoc> moduleID,
+                  std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
+                  std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
+                  bool &isFramework);
+
 public:
   /// \brief Create a new importer that can load serialized Swift modules
   /// into the given ASTContext.
@@ -95,6 +95,10 @@ public:
   lookupSILFunction(StringRef Name, bool declarationOnly = false,
                     SILLinkage linkage = SILLinkage::Private);
   bool hasSILFunction(StringRef Name, SILLinkage linkage = SILLinkage::Private);
+  /// Returns the number of instructions in the serialized body of the
+  /// function \p Name, without deserializing it, or None if no module has a
+  /// body for the function.
+  Optional<unsigned> getSILFunctionBodySize(StringRef Name);
   SILVTable *lookupVTable(Identifier Name);
   SILVTable *lookupVTable(const ClassDecl *C) {
     return lookupVTable(C->getName());
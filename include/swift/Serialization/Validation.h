@@ -85,6 +85,7 @@ struct ValidationInfo {
 class ExtendedValidationInfo {
   SmallVector<StringRef, 4> ExtraClangImporterOpts;
   StringRef SDKPath;
+  StringRef InterfaceHash;
   struct {
     unsigned IsSIB : 1;
     unsigned IsTestable : 1;
@@ -99,6 +100,14 @@ public:
     SDKPath = path;
   }
 
+  /// The hash of the module's interface, or an empty string if the module
+  /// doesn't record one.
+  StringRef getInterfaceHash() const { return InterfaceHash; }
+  void setInterfaceHash(StringRef hash) {
+    assert(InterfaceHash.empty());
+    InterfaceHash = hash;
+  }
+
   ArrayRef<StringRef> getExtraClangImporterOptions() const {
     return ExtraClangImporterOpts;
   }
@@ -120,6 +120,12 @@ namespace swift {
                              PersistentParserState &PersistentState,
                              CodeCompletionCallbacksFactory *Factory);
 
+  /// \brief Parse the declaration with the code completion point again, after
+  /// performDelayedParsing parsed it and it was moved to a new version of its
+  /// buffer with PersistentParserState::moveDelayedDecl.
+  void performCodeCompletionReparsing(PersistentParserState &PersistentState,
+                                      CodeCompletionCallbacksFactory *Factory);
+
   /// \brief Lex and return a vector of tokens for the given buffer.
   std::vector<Token> tokenize(const LangOptions &LangOpts,
                               const SourceManager &SM, unsigned BufferID,
@@ -154,7 +160,11 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// Don't type-check the bodies of functions which are not serialized
+    /// into the module, for jobs which only emit a module.
+    SkipNonInlinableFunctionBodies = 1 << 3
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -262,6 +272,22 @@ namespace swift {
                       StringRef ModuleName, llvm::LLVMContext &LLVMContext,
                       unsigned StartElem = 0);
 
+  /// Like performIRGeneration above, but takes ownership of \p SILMod and
+  /// frees it as soon as the LLVM IR is generated, so that it doesn't add to
+  /// the memory usage of the LLVM passes.
+  std::unique_ptr<llvm::Module>
+  performIRGeneration(IRGenOptions &Opts, ModuleDecl *M,
+                      std::unique_ptr<SILModule> SILMod,
+                      StringRef ModuleName, llvm::LLVMContext &LLVMContext);
+
+  /// Like performIRGeneration above, but takes ownership of \p SILMod and
+  /// frees it as soon as the LLVM IR is generated, so that it doesn't add to
+  /// the memory usage of the LLVM passes.
+  std::unique_ptr<llvm::Module>
+  performIRGeneration(IRGenOptions &Opts, SourceFile &SF,
+                      std::unique_ptr<SILModule> SILMod,
+                      StringRef ModuleName, llvm::LLVMContext &LLVMContext);
+
   /// Given an already created LLVM module, construct a pass pipeline and run
   /// the Swift LLVM Pipeline upon it. This does not cause the module to be
   /// printed, only to be optimized.
@@ -276,6 +302,13 @@ namespace swift {
   bool performLLVM(IRGenOptions &Opts, ASTContext &Ctx,
                    llvm::Module *Module);
 
+  /// Returns the MD5 hash of the LLVM module \p Module, including the
+  /// compiler version and the options which influence its code generation,
+  /// as a string of hex digits. The native code generated from modules with
+  /// the same hash is the same.
+  std::string getLLVMModuleHash(IRGenOptions &Opts, ASTContext &Ctx,
+                                llvm::Module *Module);
+
   /// A convenience wrapper for Parser functionality.
   class ParserUnit {
   public:
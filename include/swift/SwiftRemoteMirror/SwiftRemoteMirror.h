@@ -30,7 +30,7 @@
 
 /// Minor version changes when new APIs are added in ABI- and source-compatible
 /// way.
-#define SWIFT_REFLECTION_VERSION_MINOR 0
+#define SWIFT_REFLECTION_VERSION_MINOR 1
 
 #ifdef __cplusplus
 extern "C" {
@@ -130,6 +130,32 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
                                  uintptr_t Object,
                                  unsigned Index);
 
+/// Stores an opaque type reference for each of `Count` class or closure
+/// context instance pointers into `OutTypeRefs`, or NULL for an instance
+/// whose type reference can't be constructed.
+///
+/// This is equivalent to calling swift_reflection_typeRefForInstance() for
+/// each instance, but is meant for walking large heaps: the layout of each
+/// class is only computed once per context.
+void
+swift_reflection_typeRefsForInstances(SwiftReflectionContextRef ContextRef,
+                                      const uintptr_t *Objects,
+                                      size_t Count,
+                                      swift_typeref_t *OutTypeRefs);
+
+/// Stores a structure describing the layout of each of `Count` class or
+/// closure context instances into `OutInfos`, like
+/// swift_reflection_infoForInstance(). The fields of an instance are then
+/// available through swift_reflection_childOfInstance().
+///
+/// A reflection context must only be used by one thread at a time. Walking a
+/// heap from several threads requires a separate context for each thread.
+void
+swift_reflection_infosForInstances(SwiftReflectionContextRef ContextRef,
+                                   const uintptr_t *Objects,
+                                   size_t Count,
+                                   swift_typeinfo_t *OutInfos);
+
 /// Returns the number of generic arguments of a typeref.
 unsigned
 swift_reflection_genericArgumentCountOfTypeRef(swift_typeref_t OpaqueTypeRef);
@@ -24,6 +24,7 @@
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/GenericEnvironment.h"
+#include "swift/AST/IdentifierTable.h"
 #include "swift/AST/KnownProtocols.h"
 #include "swift/AST/LazyResolver.h"
 #include "swift/AST/ModuleLoader.h"
@@ -40,6 +41,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include <algorithm>
@@ -47,6 +49,15 @@
 
 using namespace swift;
 
+#define DEBUG_TYPE "ASTContext"
+
+STATISTIC(NumConformanceLookupCacheHits,
+          "# of conformance lookups answered from the cache");
+STATISTIC(NumConformanceLookupCacheMisses,
+          "# of conformance lookups not found in the cache");
+STATISTIC(NumConformanceLookupCacheInvalidations,
+          "# of times the conformance lookup cache was invalidated");
+
 LazyResolver::~LazyResolver() = default;
 DelegatingLazyResolver::~DelegatingLazyResolver() = default;
 void ModuleLoader::anchor() {}
@@ -91,7 +102,8 @@ struct ASTContext::Implementation {
   /// The last resolver.
   LazyResolver *Resolver = nullptr;
 
-  llvm::StringMap<char, llvm::BumpPtrAllocator&> IdentifierTable;
+  /// The uniqued text of all identifiers.
+  swift::IdentifierTable IdentifierTable;
 
   /// The declaration of Swift.AssignmentPrecedence.
   PrecedenceGroupDecl *AssignmentPrecedence = nullptr;
@@ -185,6 +197,20 @@ struct ASTContext::Implementation {
   /// \brief Map from Swift declarations to brief comments.
   llvm::DenseMap<const Decl *, StringRef> BriefComments;
 
+  /// \brief Map from Swift declarations and the kinds of their mangled names
+  /// (see DeclMangling) to the names, in the permanent arena.
+  llvm::DenseMap<std::pair<const ValueDecl *, unsigned>, StringRef>
+    MangledNames;
+
+  /// \brief Map from expressions to the locations of the semicolons which
+  /// follow them.
+  llvm::DenseMap<const Expr *, SourceLoc> ExprTrailingSemiLocs;
+
+  /// \brief The results of Module::lookupConformance() for types without
+  /// type variables, including negative results.
+  llvm::DenseMap<std::pair<std::pair<Module *, TypeBase *>, ProtocolDecl *>,
+                 Optional<ProtocolConformanceRef>> ConformanceLookupCache;
+
   /// \brief Map from local declarations to their discriminators.
   /// Missing entries implicitly have value 0.
   llvm::DenseMap<const ValueDecl *, unsigned> LocalDiscriminators;
@@ -219,6 +245,12 @@ struct ASTContext::Implementation {
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
                  std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
 
+  /// \brief The canonical types in the context of the generic signatures
+  /// of the stored archetype builders.
+  llvm::DenseMap<std::pair<std::pair<GenericSignature *, ModuleDecl *>,
+                           TypeBase *>,
+                 CanType> CanonicalTypesInContext;
+
   /// The set of property names that show up in the defining module of a
   /// class.
   llvm::DenseMap<std::pair<const ClassDecl *, char>,
@@ -356,8 +388,7 @@ struct ASTContext::Implementation {
   }
 };
 
-ASTContext::Implementation::Implementation()
- : IdentifierTable(Allocator) {}
+ASTContext::Implementation::Implementation() {}
 ASTContext::Implementation::~Implementation() {
   for (auto &cleanup : Cleanups)
     cleanup();
@@ -477,8 +508,13 @@ Identifier ASTContext::getIdentifier(StringRef Str) const {
   // Make sure null pointers stay null.
   if (Str.data() == nullptr) return Identifier(0);
 
-  auto I = Impl.IdentifierTable.insert(std::make_pair(Str, char())).first;
-  return Identifier(I->getKeyData());
+  return Identifier(Impl.IdentifierTable.get(Str));
+}
+
+Identifier ASTContext::getIdentifier(StringRef Str, unsigned Hash) const {
+  if (Str.data() == nullptr) return Identifier(0);
+
+  return Identifier(Impl.IdentifierTable.get(Str, Hash));
 }
 
 void ASTContext::lookupInSwiftModule(
@@ -1266,6 +1302,20 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   return builder;
 }
 
+CanType ASTContext::getCachedCanonicalTypeInContext(CanGenericSignature sig,
+                                                   ModuleDecl *mod,
+                                                   CanType type) {
+  return Impl.CanonicalTypesInContext.lookup({{sig, mod}, type.getPointer()});
+}
+
+void ASTContext::cacheCanonicalTypeInContext(CanGenericSignature sig,
+                                             ModuleDecl *mod, CanType type,
+                                             CanType result) {
+  assert(!type->hasTypeVariable() &&
+         "types with type variables don't outlive the constraint solver");
+  Impl.CanonicalTypesInContext[{{sig, mod}, type.getPointer()}] = result;
+}
+
 Module *
 ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   assert(!ModulePath.empty());
@@ -1324,6 +1374,47 @@ void ASTContext::setRawComment(const Decl *D, RawComment RC) {
   Impl.RawComments[D] = RC;
 }
 
+SourceLoc ASTContext::getExprTrailingSemiLoc(const Expr *E) {
+  return Impl.ExprTrailingSemiLocs.lookup(E);
+}
+
+void ASTContext::setExprTrailingSemiLoc(const Expr *E, SourceLoc Loc) {
+  if (Loc.isValid())
+    Impl.ExprTrailingSemiLocs[E] = Loc;
+  else
+    Impl.ExprTrailingSemiLocs.erase(E);
+}
+
+bool ASTContext::getCachedConformanceLookup(
+       Module *module, Type type, ProtocolDecl *protocol,
+       Optional<ProtocolConformanceRef> &result) {
+  auto known = Impl.ConformanceLookupCache.find({{module, type.getPointer()},
+                                                 protocol});
+  if (known == Impl.ConformanceLookupCache.end()) {
+    ++NumConformanceLookupCacheMisses;
+    return false;
+  }
+  ++NumConformanceLookupCacheHits;
+  result = known->second;
+  return true;
+}
+
+void ASTContext::cacheConformanceLookup(
+       Module *module, Type type, ProtocolDecl *protocol,
+       Optional<ProtocolConformanceRef> result) {
+  assert(!type->hasTypeVariable() &&
+         "types with type variables don't outlive the constraint solver");
+  Impl.ConformanceLookupCache[{{module, type.getPointer()}, protocol}] =
+      result;
+}
+
+void ASTContext::invalidateConformanceLookupCache() {
+  if (Impl.ConformanceLookupCache.empty())
+    return;
+  ++NumConformanceLookupCacheInvalidations;
+  Impl.ConformanceLookupCache.clear();
+}
+
 Optional<StringRef> ASTContext::getBriefComment(const Decl *D) {
   auto Known = Impl.BriefComments.find(D);
   if (Known == Impl.BriefComments.end())
@@ -1336,6 +1427,20 @@ void ASTContext::setBriefComment(const Decl *D, StringRef Comment) {
   Impl.BriefComments[D] = Comment;
 }
 
+Optional<StringRef> ASTContext::getCachedMangledName(const ValueDecl *D,
+                                                     unsigned Kind) {
+  auto Known = Impl.MangledNames.find({D, Kind});
+  if (Known == Impl.MangledNames.end())
+    return None;
+
+  return Known->second;
+}
+
+void ASTContext::setCachedMangledName(const ValueDecl *D, unsigned Kind,
+                                      StringRef Name) {
+  Impl.MangledNames[{D, Kind}] = AllocateCopy(Name);
+}
+
 unsigned ValueDecl::getLocalDiscriminator() const {
   assert(getDeclContext()->isLocalContext());
   auto &discriminators = getASTContext().Impl.LocalDiscriminators;
@@ -1478,10 +1583,15 @@ size_t ASTContext::getTotalMemory() const {
     // RemappedTypes ?
     sizeof(Impl) +
     Impl.Allocator.getTotalMemory() +
+    Impl.IdentifierTable.getMemorySize() +
     Impl.Cleanups.capacity() +
     llvm::capacity_in_bytes(Impl.ModuleLoaders) +
     llvm::capacity_in_bytes(Impl.RawComments) +
     llvm::capacity_in_bytes(Impl.BriefComments) +
+    llvm::capacity_in_bytes(Impl.MangledNames) +
+    llvm::capacity_in_bytes(Impl.ExprTrailingSemiLocs) +
+    llvm::capacity_in_bytes(Impl.ConformanceLookupCache) +
+    llvm::capacity_in_bytes(Impl.CanonicalTypesInContext) +
     llvm::capacity_in_bytes(Impl.LocalDiscriminators) +
     llvm::capacity_in_bytes(Impl.ModuleTypes) +
     llvm::capacity_in_bytes(Impl.GenericParamTypes) +
@@ -25,6 +25,8 @@
 #include "swift/AST/Stmt.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/STLExtras.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/TinyPtrVector.h"
 #include <algorithm>
 using namespace swift;
 
@@ -1903,6 +1905,60 @@ SmallVector<ValueDecl *, 4> ASTScope::getLocalBindings() const {
   return result;
 }
 
+namespace swift {
+/// The local bindings of a brace statement scope, keyed by base name.
+class LocalBindingTable {
+public:
+  llvm::DenseMap<Identifier, TinyPtrVector<ValueDecl *>> Bindings;
+
+  /// The number of elements of the brace statement when the table was
+  /// built, to catch elements which were added later.
+  unsigned NumElements;
+};
+}
+
+/// Brace statements with at most this many local bindings are searched
+/// linearly.
+static const unsigned MaxLinearLocalBindings = 8;
+
+void ASTScope::lookupLocalBindings(DeclName name,
+                                   SmallVectorImpl<ValueDecl *> &result) const {
+  Identifier baseName = name.getBaseName();
+  if (getKind() != ASTScopeKind::BraceStmt) {
+    for (auto local : getLocalBindings())
+      if (local->getName() == baseName)
+        result.push_back(local);
+    return;
+  }
+
+  auto table = braceStmt.bindingTable;
+  unsigned numElements = braceStmt.stmt->getNumElements();
+  if (!table || table->NumElements != numElements) {
+    auto bindings = getLocalBindings();
+    if (!table && bindings.size() <= MaxLinearLocalBindings) {
+      for (auto local : bindings)
+        if (local->getName() == baseName)
+          result.push_back(local);
+      return;
+    }
+
+    if (!table) {
+      ASTContext &ctx = getASTContext();
+      table = ctx.Allocate<LocalBindingTable>();
+      ctx.addDestructorCleanup(*table);
+      braceStmt.bindingTable = table;
+    }
+    table->Bindings.clear();
+    for (auto local : bindings)
+      table->Bindings[local->getName()].push_back(local);
+    table->NumElements = numElements;
+  }
+
+  auto found = table->Bindings.find(baseName);
+  if (found != table->Bindings.end())
+    result.append(found->second.begin(), found->second.end());
+}
+
 void ASTScope::expandAll() const {
   if (!isExpanded())
     expand();
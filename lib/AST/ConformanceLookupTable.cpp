@@ -473,6 +473,7 @@ bool ConformanceLookupTable::addProtocol(NominalTypeDecl *nominal,
   /// Build the conformance entry (if it hasn't been built before).
   ConformanceEntry *entry = new (ctx) ConformanceEntry(loc, protocol, source);
   conformanceEntries.push_back(entry);
+  ctx.invalidateConformanceLookupCache();
 
   // Record this as a conformance within the given declaration
   // context.
@@ -860,6 +861,9 @@ void ConformanceLookupTable::registerProtocolConformance(
   auto dc = conformance->getDeclContext();
   auto nominal = dc->getAsNominalTypeOrNominalTypeExtensionContext();
 
+  ASTContext &ctx = nominal->getASTContext();
+  ctx.invalidateConformanceLookupCache();
+
   // If there is an entry to update, do so.
   auto &dcConformances = AllConformances[dc];
   for (auto entry : dcConformances) {
@@ -878,7 +882,6 @@ void ConformanceLookupTable::registerProtocolConformance(
     = inherited ? ConformanceSource::forInherited(cast<ClassDecl>(nominal))
                 : ConformanceSource::forExplicit(dc);
 
-  ASTContext &ctx = nominal->getASTContext();
   ConformanceEntry *entry = new (ctx) ConformanceEntry(SourceLoc(),
                                                        protocol,
                                                        source);
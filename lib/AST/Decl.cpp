@@ -2160,6 +2160,7 @@ ExtensionRange NominalTypeDecl::getExtensions() {
 void NominalTypeDecl::addExtension(ExtensionDecl *extension) {
   assert(!extension->NextExtension.getInt() && "Already added extension");
   extension->NextExtension.setInt(true);
+  getASTContext().invalidateConformanceLookupCache();
   
   // First extension; set both first and last.
   if (!FirstExtension) {
@@ -4978,4 +4979,5 @@ void ClassDecl::setSuperclass(Type superclass) {
   assert((!superclass || !superclass->hasArchetype())
          && "superclass must be interface type");
   LazySemanticInfo.Superclass.setPointerAndInt(superclass, true);
+  getASTContext().invalidateConformanceLookupCache();
 }
@@ -127,7 +127,7 @@ static char extractCharBefore(SourceManager &SM, SourceLoc Loc) {
 
 InFlightDiagnostic &InFlightDiagnostic::highlight(SourceRange R) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
-  if (Engine && R.isValid())
+  if (Engine && R.isValid() && !Engine->isActiveDiagnosticDiscarded())
     Engine->getActiveDiagnostic()
         .addRange(toCharSourceRange(Engine->SourceMgr, R));
   return *this;
@@ -136,7 +136,7 @@ InFlightDiagnostic &InFlightDiagnostic::highlight(SourceRange R) {
 InFlightDiagnostic &InFlightDiagnostic::highlightChars(SourceLoc Start,
                                                        SourceLoc End) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
-  if (Engine && Start.isValid())
+  if (Engine && Start.isValid() && !Engine->isActiveDiagnosticDiscarded())
     Engine->getActiveDiagnostic()
         .addRange(toCharSourceRange(Engine->SourceMgr, Start, End));
   return *this;
@@ -147,6 +147,9 @@ InFlightDiagnostic &InFlightDiagnostic::highlightChars(SourceLoc Start,
 ///
 InFlightDiagnostic &InFlightDiagnostic::fixItInsertAfter(SourceLoc L,
                                                          StringRef Str) {
+  assert(IsActive && "Cannot modify an inactive diagnostic");
+  if (!Engine || Engine->isActiveDiagnosticDiscarded())
+    return *this;
   L = Lexer::getLocForEndOfToken(Engine->SourceMgr, L);
   return fixItInsert(L, Str);
 }
@@ -155,7 +158,8 @@ InFlightDiagnostic &InFlightDiagnostic::fixItInsertAfter(SourceLoc L,
 /// diagnostic.
 InFlightDiagnostic &InFlightDiagnostic::fixItRemove(SourceRange R) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
-  if (R.isInvalid() || !Engine) return *this;
+  if (R.isInvalid() || !Engine || Engine->isActiveDiagnosticDiscarded())
+    return *this;
 
   // Convert from a token range to a CharSourceRange, which points to the end of
   // the token we want to remove.
@@ -183,7 +187,8 @@ InFlightDiagnostic &InFlightDiagnostic::fixItReplace(SourceRange R,
     return fixItRemove(R);
 
   assert(IsActive && "Cannot modify an inactive diagnostic");
-  if (R.isInvalid() || !Engine) return *this;
+  if (R.isInvalid() || !Engine || Engine->isActiveDiagnosticDiscarded())
+    return *this;
 
   auto &SM = Engine->SourceMgr;
   auto charRange = toCharSourceRange(SM, R);
@@ -207,7 +212,7 @@ InFlightDiagnostic &InFlightDiagnostic::fixItReplaceChars(SourceLoc Start,
                                                           SourceLoc End,
                                                           StringRef Str) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
-  if (Engine && Start.isValid())
+  if (Engine && Start.isValid() && !Engine->isActiveDiagnosticDiscarded())
     Engine->getActiveDiagnostic().addFixIt(Diagnostic::FixIt(
         toCharSourceRange(Engine->SourceMgr, Start, End), Str));
   return *this;
@@ -216,6 +221,8 @@ InFlightDiagnostic &InFlightDiagnostic::fixItReplaceChars(SourceLoc Start,
 InFlightDiagnostic &InFlightDiagnostic::fixItExchange(SourceRange R1,
                                                       SourceRange R2) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
+  if (!Engine || Engine->isActiveDiagnosticDiscarded())
+    return *this;
 
   auto &SM = Engine->SourceMgr;
   // Convert from a token range to a CharSourceRange
@@ -245,6 +252,14 @@ bool DiagnosticEngine::isDiagnosticPointsToFirstBadToken(DiagID ID) const {
   return storedDiagnosticInfos[(unsigned) ID].pointsToFirstBadToken;
 }
 
+bool DiagnosticEngine::isDiagnosticDiscarded(DiagID ID) const {
+  if (Consumers.empty())
+    return true;
+  if (TransactionCount != 0)
+    return false;
+  return state.computeBehavior(ID) == DiagnosticState::Behavior::Ignore;
+}
+
 /// \brief Skip forward to one of the given delimiters.
 ///
 /// \param Text The text to search through, which will be updated to point
@@ -525,18 +540,19 @@ static DiagnosticKind toDiagnosticKind(DiagnosticState::Behavior behavior) {
 }
 
 DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
-  auto set = [this](DiagnosticState::Behavior lvl) {
-    if (lvl == Behavior::Fatal) {
-      fatalErrorOccurred = true;
-      anyErrorOccurred = true;
-    } else if (lvl == Behavior::Error) {
-      anyErrorOccurred = true;
-    }
+  auto lvl = computeBehavior(id);
+  if (lvl == Behavior::Fatal) {
+    fatalErrorOccurred = true;
+    anyErrorOccurred = true;
+  } else if (lvl == Behavior::Error) {
+    anyErrorOccurred = true;
+  }
 
-    previousBehavior = lvl;
-    return lvl;
-  };
+  previousBehavior = lvl;
+  return lvl;
+}
 
+DiagnosticState::Behavior DiagnosticState::computeBehavior(DiagID id) const {
   // We determine how to handle a diagnostic based on the following rules
   //   1) If current state dictates a certain behavior, follow that
   //   2) If the user provided a behavior for this specific diagnostic, follow
@@ -552,36 +568,36 @@ DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
 
   // Notes relating to ignored diagnostics should also be ignored
   if (previousBehavior == Behavior::Ignore && isNote)
-    return set(Behavior::Ignore);
+    return Behavior::Ignore;
 
   // Suppress diagnostics when in a fatal state, except for follow-on notes
   if (fatalErrorOccurred)
     if (!showDiagnosticsAfterFatalError && !isNote)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
 
   //   2) If the user provided a behavior for this specific diagnostic, follow
   //      that
 
   if (perDiagnosticBehavior[(unsigned)id] != Behavior::Unspecified)
-    return set(perDiagnosticBehavior[(unsigned)id]);
+    return perDiagnosticBehavior[(unsigned)id];
 
   //   3) If the user provided a behavior for this diagnostic's kind, follow
   //      that
   if (diagInfo.kind == DiagnosticKind::Warning) {
     if (suppressWarnings)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
     if (warningsAsErrors)
-      return set(Behavior::Error);
+      return Behavior::Error;
   }
 
   //   4) Otherwise remap the diagnostic kind
   switch (diagInfo.kind) {
   case DiagnosticKind::Note:
-    return set(Behavior::Note);
+    return Behavior::Note;
   case DiagnosticKind::Error:
-    return set(diagInfo.isFatal ? Behavior::Fatal : Behavior::Error);
+    return diagInfo.isFatal ? Behavior::Fatal : Behavior::Error;
   case DiagnosticKind::Warning:
-    return set(Behavior::Warning);
+    return Behavior::Warning;
   }
 }
 
@@ -607,6 +623,11 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   if (behavior == DiagnosticState::Behavior::Ignore)
     return;
 
+  // Nothing renders the diagnostic, so don't pretty-print declarations or
+  // format the arguments.
+  if (Consumers.empty())
+    return;
+
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
   if (loc.isInvalid() && diagnostic.getDecl()) {
@@ -53,6 +53,14 @@ void *Expr::operator new(size_t Bytes, ASTContext &C,
   return C.Allocate(Bytes, Alignment);
 }
 
+SourceLoc Expr::getTrailingSemiLoc(ASTContext &Ctx) const {
+  return Ctx.getExprTrailingSemiLoc(this);
+}
+
+void Expr::setTrailingSemiLoc(ASTContext &Ctx, SourceLoc Loc) {
+  Ctx.setExprTrailingSemiLoc(this, Loc);
+}
+
 StringRef Expr::getKindName(ExprKind K) {
   switch (K) {
 #define EXPR(Id, Parent) case ExprKind::Id: return #Id;
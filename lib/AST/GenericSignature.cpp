@@ -405,6 +405,20 @@ CanType GenericSignature::getCanonicalTypeInContext(Type type, ModuleDecl &mod)
   if (!type->hasTypeParameter())
     return CanType(type);
 
+  // Canonicalization resolves every type parameter of the type in the
+  // archetype builder. The builders of canonical signatures don't change, so
+  // the results can be reused by all signatures with the same canonical
+  // signature.
+  auto &ctx = getASTContext();
+  auto canSig = getCanonicalSignature();
+  auto canType = CanType(type);
+  bool canCache = !type->hasTypeVariable();
+  if (canCache) {
+    if (auto cached = ctx.getCachedCanonicalTypeInContext(canSig, &mod,
+                                                          canType))
+      return cached;
+  }
+
   auto &builder = *getArchetypeBuilder(mod);
 
   // Replace non-canonical type parameters.
@@ -426,5 +440,7 @@ CanType GenericSignature::getCanonicalTypeInContext(Type type, ModuleDecl &mod)
 
   auto result = type->getCanonicalType();
   assert(isCanonicalTypeInContext(result, mod));
+  if (canCache)
+    ctx.cacheCanonicalTypeInContext(canSig, &mod, canType, result);
   return result;
 }
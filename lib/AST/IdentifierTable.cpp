@@ -0,0 +1,135 @@
+//===--- IdentifierTable.cpp - Uniquing table for identifiers -------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Each entry of the table is allocated as an EntryHeader followed by the
+// NUL-terminated text, which is what the buckets and the clients point to.
+// Entries are never changed or removed once they are published to a bucket
+// with a release store, so readers can compare them without a lock.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/IdentifierTable.h"
+#include <cstring>
+#include <new>
+
+using namespace swift;
+
+namespace {
+struct EntryHeader {
+  unsigned Hash;
+  unsigned Length;
+};
+} // end anonymous namespace
+
+static const EntryHeader &getHeader(const char *text) {
+  return reinterpret_cast<const EntryHeader *>(text)[-1];
+}
+
+/// Scrambles the hash, whose low and high bits are poor for short strings,
+/// before taking bits of it for the shard and bucket indices.
+static unsigned mixHash(unsigned hash) {
+  return hash * 0x9E3779B1U;
+}
+
+static unsigned getShardIndex(unsigned mixedHash, unsigned numShards) {
+  return (mixedHash >> 24) % numShards;
+}
+
+/// Returns the entry for \p text in \p buckets, or null if there is none,
+/// in which case \p emptyBucket is set to the bucket which the text would be
+/// inserted into.
+static const char *probe(unsigned numBuckets,
+                         const std::atomic<const char *> *buckets,
+                         StringRef text, unsigned hash, unsigned mixedHash,
+                         unsigned *emptyBucket = nullptr) {
+  for (unsigned i = mixedHash & (numBuckets - 1);;
+       i = (i + 1) & (numBuckets - 1)) {
+    const char *entry = buckets[i].load(std::memory_order_acquire);
+    if (!entry) {
+      if (emptyBucket)
+        *emptyBucket = i;
+      return nullptr;
+    }
+    const EntryHeader &header = getHeader(entry);
+    if (header.Hash == hash && header.Length == text.size() &&
+        memcmp(entry, text.data(), text.size()) == 0)
+      return entry;
+  }
+}
+
+const char *IdentifierTable::get(StringRef text, unsigned hash) {
+  assert(hash == hashText(text) && "wrong precomputed hash");
+  unsigned mixedHash = mixHash(hash);
+  Shard &shard = Shards[getShardIndex(mixedHash, NumShards)];
+
+  // Most lookups find an existing entry without taking the lock.
+  if (auto *array = shard.Buckets.load(std::memory_order_acquire)) {
+    if (auto *entry = probe(array->NumBuckets, array->Buckets, text,
+                            hash, mixedHash))
+      return entry;
+  }
+
+  llvm::sys::ScopedLock locked(shard.Lock);
+
+  // Grow the buckets before they are three quarters full. Another thread may
+  // have inserted the text since the lookup above, which the probe below
+  // finds.
+  auto *array = shard.Buckets.load(std::memory_order_relaxed);
+  if (!array || (shard.NumEntries + 1) * 4 > array->NumBuckets * 3) {
+    unsigned numBuckets = array ? array->NumBuckets * 2 : 64;
+    size_t size = sizeof(BucketArray) +
+                  (numBuckets - 1) * sizeof(std::atomic<const char *>);
+    void *mem = shard.Allocator.Allocate(size, alignof(BucketArray));
+    auto *newArray = static_cast<BucketArray *>(mem);
+    newArray->NumBuckets = numBuckets;
+    for (unsigned i = 0; i != numBuckets; ++i)
+      new (&newArray->Buckets[i]) std::atomic<const char *>(nullptr);
+
+    if (array) {
+      for (unsigned i = 0, e = array->NumBuckets; i != e; ++i) {
+        const char *entry = array->Buckets[i].load(std::memory_order_relaxed);
+        if (!entry)
+          continue;
+        unsigned j = mixHash(getHeader(entry).Hash) & (numBuckets - 1);
+        while (newArray->Buckets[j].load(std::memory_order_relaxed))
+          j = (j + 1) & (numBuckets - 1);
+        newArray->Buckets[j].store(entry, std::memory_order_relaxed);
+      }
+    }
+
+    shard.Buckets.store(newArray, std::memory_order_release);
+    array = newArray;
+  }
+
+  unsigned emptyBucket;
+  if (auto *entry = probe(array->NumBuckets, array->Buckets, text, hash,
+                          mixedHash, &emptyBucket))
+    return entry;
+
+  void *mem = shard.Allocator.Allocate(sizeof(EntryHeader) + text.size() + 1,
+                                       alignof(EntryHeader));
+  auto *header = new (mem) EntryHeader{hash, unsigned(text.size())};
+  char *entry = reinterpret_cast<char *>(header + 1);
+  memcpy(entry, text.data(), text.size());
+  entry[text.size()] = '\0';
+
+  array->Buckets[emptyBucket].store(entry, std::memory_order_release);
+  ++shard.NumEntries;
+  return entry;
+}
+
+size_t IdentifierTable::getMemorySize() const {
+  size_t size = 0;
+  for (auto &shard : Shards)
+    size += shard.Allocator.getTotalMemory();
+  return size;
+}
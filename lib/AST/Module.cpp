@@ -757,6 +757,30 @@ Module::lookupConformance(Type type, ProtocolDecl *protocol,
   // If we don't have a nominal type, there are no conformances.
   if (!nominal) return None;
 
+  // The same conformances of nominal types are looked up over and over again
+  // by the type checker, and forming specialized and inherited conformances
+  // is expensive, so remember the results. Lookups without a resolver might
+  // miss conformances which haven't been resolved yet, so only the results of
+  // lookups with a resolver are recorded.
+  bool canCache = resolver && !type->hasTypeVariable();
+  if (canCache) {
+    Optional<ProtocolConformanceRef> cached;
+    if (ctx.getCachedConformanceLookup(this, type, protocol, cached))
+      return cached;
+  }
+
+  auto result = lookupNominalConformance(type, nominal, protocol, resolver);
+  if (canCache)
+    ctx.cacheConformanceLookup(this, type, protocol, result);
+  return result;
+}
+
+Optional<ProtocolConformanceRef>
+Module::lookupNominalConformance(Type type, NominalTypeDecl *nominal,
+                                 ProtocolDecl *protocol,
+                                 LazyResolver *resolver) {
+  ASTContext &ctx = getASTContext();
+
   // Find the (unspecialized) conformance.
   SmallVector<ProtocolConformance *, 2> conformances;
   if (!nominal->lookupConformance(this, protocol, conformances))
@@ -1385,6 +1409,38 @@ bool SourceFile::hasTestableImport(const swift::Module *module) const {
   });
 }
 
+void SourceFile::endDeclInterfaceHash(ArrayRef<Decl *> decls, bool isPrivate,
+                                      bool affectsLayout) {
+  assert(!DeclInterfaceHashStack.empty() && "unbalanced decl hash");
+  std::array<std::string, NumDeclInterfaceHashKinds> strs;
+  for (unsigned i = 0; i != NumDeclInterfaceHashKinds; ++i) {
+    llvm::MD5::MD5Result result;
+    DeclInterfaceHashStack.back()[i].final(result);
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    strs[i] = str.str();
+  }
+  DeclInterfaceHashStack.pop_back();
+
+  for (const Decl *D : decls)
+    DeclInterfaceHashes[D] = strs;
+
+  if (DeclInterfaceHashStack.empty())
+    return;
+
+  auto &parent = DeclInterfaceHashStack.back();
+  auto addToParent = [&](DeclInterfaceHashKind kind) {
+    uint8_t a[1] = {0};
+    parent[unsigned(kind)].update(strs[unsigned(kind)]);
+    parent[unsigned(kind)].update(a);
+  };
+  addToParent(DeclInterfaceHashKind::AllMembers);
+  if (!isPrivate || affectsLayout)
+    addToParent(DeclInterfaceHashKind::Interface);
+  if (affectsLayout)
+    addToParent(DeclInterfaceHashKind::Layout);
+}
+
 void SourceFile::clearLookupCache() {
   if (!Cache)
     return;
@@ -26,10 +26,19 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Name lookup"
+
+STATISTIC(NumNamedLazyMemberLoads,
+          "# of lazily-loaded contexts whose members were loaded by name");
+STATISTIC(NumNamedLazyMemberLoadFailures,
+          "# of lazily-loaded contexts whose members couldn't be loaded by "
+          "name");
+
 void DebuggerClient::anchor() {}
 
 void AccessFilteringDeclConsumer::foundDecl(ValueDecl *D,
@@ -487,7 +496,8 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
     for (auto currentScope = lookupScope; currentScope;
          currentScope = currentScope->getParent()) {
       // Perform local lookup within this scope.
-      auto localBindings = currentScope->getLocalBindings();
+      SmallVector<ValueDecl *, 4> localBindings;
+      currentScope->lookupLocalBindings(Name, localBindings);
       for (auto local : localBindings) {
         Consumer.foundDecl(local,
                            getLocalDeclVisibilityKind(currentScope));
@@ -527,7 +537,7 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
               if (singleVar->getAttrs().hasAttribute<LazyAttr>()) {
 
               // 'self' will be listed in the local bindings.
-              for (auto local : localBindings) {
+              for (auto local : currentScope->getLocalBindings()) {
                 auto param = dyn_cast<ParamDecl>(local);
                 if (!param) continue;
 
@@ -992,6 +1002,12 @@ class swift::MemberLookupTable {
   /// Lookup table mapping names to the set of declarations with that name.
   LookupTable Lookup;
 
+  /// The base names whose members were loaded by name while the nominal type
+  /// still had lazily-loaded members, mapped to the last extension whose
+  /// members with that base name were added to the table (or null if only
+  /// the members of the nominal type itself were added).
+  llvm::DenseMap<Identifier, ExtensionDecl *> LazilyLoadedNames;
+
 public:
   /// Create a new member lookup table.
   explicit MemberLookupTable(ASTContext &ctx);
@@ -1008,6 +1024,14 @@ public:
   /// \brief Add the given members to the lookup table.
   void addMembers(DeclRange members);
 
+  /// Add the members of \p nominal and of its extensions which have the base
+  /// name \p name, without loading any other members.
+  ///
+  /// \returns true if the members of the nominal type itself cannot be loaded
+  /// by name, in which case all of its members have to be loaded.
+  bool loadNamedMembers(NominalTypeDecl *nominal, Identifier name,
+                        bool ignoreNewExtensions);
+
   /// \brief The given extension has been extended with new members; add them
   /// if appropriate.
   void addExtensionMembers(NominalTypeDecl *nominal,
@@ -1143,6 +1167,72 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
   }
 }
 
+/// Add the members in \p members with the base name \p name to \p table.
+static void addMembersWithBaseName(MemberLookupTable &table, DeclRange members,
+                                   Identifier name) {
+  for (auto member : members) {
+    auto vd = dyn_cast<ValueDecl>(member);
+    if (vd && vd->getFullName().getBaseName() == name)
+      table.addMember(vd);
+  }
+}
+
+/// Add the members of \p IDC with the base name \p name to \p table, using
+/// the lazy member loader of \p IDC if its members haven't been loaded yet.
+///
+/// \returns true if the loader cannot load the members by name.
+static bool addNamedMembers(MemberLookupTable &table, IterableDeclContext *IDC,
+                            Identifier name) {
+  addMembersWithBaseName(table, IDC->getCurrentMembersWithoutLoading(), name);
+  if (!IDC->isLazy())
+    return false;
+
+  SmallVector<ValueDecl *, 4> members;
+  if (IDC->getLoader()->loadNamedMembers(IDC, name,
+                                         IDC->getLoaderContextData(),
+                                         members)) {
+    ++NumNamedLazyMemberLoadFailures;
+    return true;
+  }
+
+  ++NumNamedLazyMemberLoads;
+  for (auto member : members)
+    table.addMember(member);
+  return false;
+}
+
+bool MemberLookupTable::loadNamedMembers(NominalTypeDecl *nominal,
+                                         Identifier name,
+                                         bool ignoreNewExtensions) {
+  // Loading the members can look up the same name again; record the name
+  // before loading so that the nested lookup doesn't load the members again.
+  if (!LazilyLoadedNames.count(name)) {
+    LazilyLoadedNames[name] = nullptr;
+    if (addNamedMembers(*this, nominal, name))
+      return true;
+  }
+
+  if (ignoreNewExtensions)
+    return false;
+
+  // Add the members of the extensions which were added since the last lookup
+  // of this name. Loading members can add entries to LazilyLoadedNames, so
+  // don't keep a reference into it.
+  ExtensionDecl *last = LazilyLoadedNames[name];
+  for (auto next = last ? last->NextExtension.getPointer()
+                        : nominal->FirstExtension;
+       next; next = next->NextExtension.getPointer()) {
+    LazilyLoadedNames[name] = next;
+
+    // An extension whose members cannot be loaded by name, such as one in a
+    // serialized Swift module, is usually small; load all of its members
+    // instead of all members of the nominal type.
+    if (addNamedMembers(*this, next, name))
+      addMembersWithBaseName(*this, next->getMembers(), name);
+  }
+  return false;
+}
+
 void MemberLookupTable::destroy() {
   this->~MemberLookupTable();
 }
@@ -1205,13 +1295,35 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
-  // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
-  if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
+  // If the members of this type haven't been loaded yet, try to only load the
+  // members with the base name we're looking for.
+  if (isLazy() && getASTContext().LangOpts.NamedLazyMemberLoading) {
+    if (!ignoreNewExtensions)
+      (void)getExtensions();
+
+    if (!LookupTable.getPointer()) {
+      auto &ctx = getASTContext();
+      LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
+    }
+
+    if (!LookupTable.getPointer()->loadNamedMembers(this, name.getBaseName(),
+                                                    ignoreNewExtensions)) {
+      auto known = LookupTable.getPointer()->find(name);
+      if (known == LookupTable.getPointer()->end())
+        return { };
+      return { known->second.begin(), known->second.size() };
+    }
+
+    // Otherwise fall back to loading all members.
   }
 
+  // Make sure we have the complete list of extensions. Their members are
+  // loaded when they are added to the lookup table, so only the extensions
+  // which are new since the last lookup are visited, rather than all of
+  // them on every lookup.
+  if (!ignoreNewExtensions)
+    (void)getExtensions();
+
   (void)getMembers();
 
   prepareLookupTable(ignoreNewExtensions);
@@ -93,6 +93,7 @@ addSubstitution(CanType type, Type replacement) {
   auto result = subMap.insert(std::make_pair(type.getPointer(), replacement));
   assert(result.second);
   (void) result;
+  substCache.clear();
 }
 
 void SubstitutionMap::
@@ -104,16 +105,19 @@ addConformances(CanType type, ArrayRef<ProtocolConformanceRef> conformances) {
       std::make_pair(type.getPointer(), conformances));
   assert(result.second);
   (void) result;
+  substCache.clear();
 }
 
 void SubstitutionMap::
 addParent(CanType type, CanType parent, AssociatedTypeDecl *assocType) {
   assert(type && parent && assocType);
   parentMap[type.getPointer()].push_back(std::make_pair(parent, assocType));
+  substCache.clear();
 }
 
 void SubstitutionMap::removeType(CanType type) {
   subMap.erase(type.getPointer());
   conformanceMap.erase(type.getPointer());
   parentMap.erase(type.getPointer());
+  substCache.clear();
 }
@@ -2867,6 +2867,19 @@ static Type substType(
     llvm::PointerUnion<ModuleDecl *, const SubstitutionMap *> conformances,
     const TypeSubstitutionMap &substitutions,
     SubstOptions options) {
+  // Only archetypes and type parameters are substituted, so a type which
+  // contains neither stays the same. Lowered polymorphic function types hide
+  // their type parameters, so they are always visited.
+  //
+  // Check the canonical type, because sugared types don't always have their
+  // properties set: deserialized NameAliasTypes have none, yet transform()
+  // still substitutes their underlying types.
+  if (derivedType && !options.contains(SubstFlags::AllowLoweredTypes)) {
+    auto canType = derivedType->getCanonicalType();
+    if (!canType->hasArchetype() && !canType->hasTypeParameter())
+      return derivedType;
+  }
+
   return derivedType.transform([&](Type type) -> Type {
     assert((options.contains(SubstFlags::AllowLoweredTypes) ||
             !isa<SILFunctionType>(type.getPointer())) &&
@@ -2942,7 +2955,16 @@ Type Type::subst(Module *module,
 
 Type Type::subst(const SubstitutionMap &substitutions,
                  SubstOptions options) const {
-  return substType(*this, &substitutions, substitutions.getMap(), options);
+  // The cloners and SILGen substitute the same types with the same map over
+  // and over again.
+  if (auto cached = substitutions.getCachedSubstitution(*this, options))
+    return cached;
+
+  auto result = substType(*this, &substitutions, substitutions.getMap(),
+                          options);
+  if (result)
+    substitutions.cacheSubstitution(*this, options, result);
+  return result;
 }
 
 Type TypeBase::getSuperclassForDecl(const ClassDecl *baseClass,
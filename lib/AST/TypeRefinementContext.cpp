@@ -145,11 +145,34 @@ TypeRefinementContext::findMostRefinedSubContext(SourceLoc Loc,
   if (SrcRange.isValid() && !SM.rangeContainsTokenLoc(SrcRange, Loc))
     return nullptr;
 
-  // For the moment, we perform a linear search here, but we can and should
-  // do something more efficient.
-  for (TypeRefinementContext *Child : Children) {
-    if (auto *Found = Child->findMostRefinedSubContext(Loc, SM)) {
-      return Found;
+  // Children are added in source order while walking the AST, so their
+  // ranges are normally sorted and disjoint. Check this for the children
+  // added since the last query.
+  for (; ChildrenAreOrdered && NumOrderedChildrenChecked < Children.size();
+       ++NumOrderedChildrenChecked) {
+    if (NumOrderedChildrenChecked == 0)
+      continue;
+    SourceRange Prev = Children[NumOrderedChildrenChecked - 1]->SrcRange;
+    SourceRange Next = Children[NumOrderedChildrenChecked]->SrcRange;
+    if (!SM.isBeforeInBuffer(Prev.End, Next.Start))
+      ChildrenAreOrdered = false;
+  }
+
+  if (ChildrenAreOrdered) {
+    // Only the last child which starts at or before Loc can contain it.
+    auto Next = std::upper_bound(Children.begin(), Children.end(), Loc,
+                                 [&SM](SourceLoc Loc,
+                                       TypeRefinementContext *Child) {
+      return SM.isBeforeInBuffer(Loc, Child->SrcRange.Start);
+    });
+    if (Next != Children.begin())
+      if (auto *Found = (*std::prev(Next))->findMostRefinedSubContext(Loc, SM))
+        return Found;
+  } else {
+    for (TypeRefinementContext *Child : Children) {
+      if (auto *Found = Child->findMostRefinedSubContext(Loc, SM)) {
+        return Found;
+      }
     }
   }
 
@@ -38,15 +38,46 @@ bool ide::printTypeUSR(Type Ty, raw_ostream &OS) {
   return false;
 }
 
+/// Print the name of kind \p Kind of \p D with \p Print, or the name which
+/// was printed for it before. Names are cached in the ASTContext, since
+/// indexing and cursor info ask for the USRs of the same declarations many
+/// times. Declarations which have not been type-checked yet are not cached,
+/// since their names may still change.
+template <typename F>
+static bool printCachedUSR(const ValueDecl *D, unsigned Kind, raw_ostream &OS,
+                           F Print) {
+  if (!D->hasType())
+    return Print(OS);
+
+  ASTContext &Ctx = D->getASTContext();
+  if (auto Cached = Ctx.getCachedMangledName(D, Kind)) {
+    OS << *Cached;
+    return false;
+  }
+
+  llvm::SmallString<128> Buf;
+  {
+    llvm::raw_svector_ostream BufOS(Buf);
+    if (Print(BufOS))
+      return true;
+  }
+  Ctx.setCachedMangledName(D, Kind, Buf);
+  OS << Buf;
+  return false;
+}
+
 bool ide::printDeclTypeUSR(const ValueDecl *D, raw_ostream &OS) {
   using namespace Mangle;
-  Mangler Mangler(true);
-  Mangler.mangleDeclTypeForDebugger(D);
-  Mangler.finalize(OS);
-  return false;
+  return printCachedUSR(D, unsigned(DeclMangling::TypeUSR), OS,
+                        [D](raw_ostream &OS) {
+    Mangler Mangler(true);
+    Mangler.mangleDeclTypeForDebugger(D);
+    Mangler.finalize(OS);
+    return false;
+  });
 }
 
-bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+static bool printDeclUSRImpl(const ValueDecl *D, raw_ostream &OS) {
   using namespace Mangle;
 
   if (!isa<FuncDecl>(D) && !D->hasName())
@@ -142,8 +173,15 @@ bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
   return false;
 }
 
-bool ide::printAccessorUSR(const AbstractStorageDecl *D, AccessorKind AccKind,
-                           llvm::raw_ostream &OS) {
+bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+  return printCachedUSR(D, unsigned(DeclMangling::USR), OS,
+                        [D](raw_ostream &OS) {
+    return printDeclUSRImpl(D, OS);
+  });
+}
+
+static bool printAccessorUSRImpl(const AbstractStorageDecl *D,
+                                 AccessorKind AccKind, llvm::raw_ostream &OS) {
   using namespace Mangle;
 
   // AccKind should always be either IsGetter or IsSetter here, based
@@ -166,6 +204,15 @@ bool ide::printAccessorUSR(const AbstractStorageDecl *D, AccessorKind AccKind,
   return false;
 }
 
+bool ide::printAccessorUSR(const AbstractStorageDecl *D, AccessorKind AccKind,
+                           llvm::raw_ostream &OS) {
+  return printCachedUSR(D,
+                        unsigned(DeclMangling::AccessorUSR) + unsigned(AccKind),
+                        OS, [D, AccKind](raw_ostream &OS) {
+    return printAccessorUSRImpl(D, AccKind, OS);
+  });
+}
+
 bool ide::printExtensionUSR(const ExtensionDecl *ED, raw_ostream &OS) {
   if (ED->getExtendedType().isNull())
     return true;
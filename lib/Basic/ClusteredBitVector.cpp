@@ -22,15 +22,19 @@
 using namespace swift;
 
 ClusteredBitVector ClusteredBitVector::fromAPInt(const llvm::APInt &bits) {
-  // This is not a very efficient algorithm.
   ClusteredBitVector result;
-  for (unsigned i = 0, e = bits.getBitWidth(); i != e; ++i) {
-    if (bits[i]) {
-      result.appendSetBits(1);
-    } else {
-      result.appendClearBits(1);
-    }
+  auto numBits = bits.getBitWidth();
+  if (!bits.getBoolValue()) {
+    result.appendClearBits(numBits);
+    return result;
   }
+
+  // This assumes that the chunk size is the same as APInt's, which keeps
+  // the unused high bits of its last word clear, like we do.
+  static_assert(sizeof(ChunkType) == sizeof(llvm::integerPart),
+                "chunk size doesn't match APInt's word size");
+  result.reserve(numBits);
+  result.appendReserved(numBits, bits.getRawData());
   return result;
 }
 
@@ -76,100 +80,66 @@ void ClusteredBitVector::reallocate(size_t newCapacityInChunks) {
   }
 }
 
-void ClusteredBitVector::appendReserved(size_t numBits,
-                llvm::function_ref<ChunkType(size_t numBitsWanted)> generator) {
+void ClusteredBitVector::appendConstantBitsReserved(size_t numBits,
+                                                    bool addOnes) {
   assert(LengthInBits + numBits <= getCapacityInBits());
   assert(numBits > 0);
 
-  auto getMoreBits =
-    [&](size_t numBitsWanted) -> ChunkType {
-    auto result = generator(numBitsWanted);
-    assert((numBitsWanted == ChunkSizeInBits ||
-            result <= (ChunkType(1) << numBitsWanted)) &&
-           "generator returned out-of-range value!");
-    return result;
-  };
-
-  // Check whether the current end of the vector is a clean multiple
-  // of the chunk size.
   auto offset = LengthInBits % ChunkSizeInBits;
   ChunkType *nextChunk = &getChunksPtr()[LengthInBits / ChunkSizeInBits];
-
-  // Now we can go ahead and add in the right number of extra bits.
   LengthInBits += numBits;
 
-  // If not, we need to combine the generator result with that last chunk.
+  // Fill up the current last chunk, whose extra bits are guaranteed to be
+  // zero.
   if (offset) {
     auto claimedBits = std::min(numBits, size_t(ChunkSizeInBits - offset));
-
-    // The extra bits in data[chunkIndex] are guaranteed to be zero.
-    *nextChunk++ |= (getMoreBits(claimedBits) << offset);
-    
+    if (addOnes)
+      *nextChunk |= getLowBitsMask(claimedBits) << offset;
+    ++nextChunk;
     numBits -= claimedBits;
     if (numBits == 0) return;
   }
 
-  // For the rest, just generator chunks one at a time.
-  do {
-    auto claimedBits = std::min(numBits, size_t(ChunkSizeInBits));
-    *nextChunk++ = getMoreBits(claimedBits);
-    numBits -= claimedBits;
-  } while (numBits);
+  // Then fill whole chunks at once, and the new last chunk.
+  auto numWholeChunks = numBits / ChunkSizeInBits;
+  memset(nextChunk, addOnes ? 0xFF : 0, numWholeChunks * sizeof(ChunkType));
+  if (auto tailBits = numBits % ChunkSizeInBits)
+    nextChunk[numWholeChunks] = addOnes ? getLowBitsMask(tailBits) : 0;
 }
 
-void ClusteredBitVector::appendConstantBitsReserved(size_t numBits,
-                                                    bool addOnes) {
+void ClusteredBitVector::appendReserved(size_t numBits,
+                                        const ChunkType *nextChunk) {
   assert(LengthInBits + numBits <= getCapacityInBits());
   assert(numBits > 0);
 
-  ChunkType pattern = (addOnes ? ~ChunkType(0) : ChunkType(0));
-  appendReserved(numBits, [=](size_t numBitsWanted) -> ChunkType {
-    return (pattern >> (ChunkSizeInBits - numBitsWanted));
-  });
-}
+  auto offset = LengthInBits % ChunkSizeInBits;
+  ChunkType *destChunks = &getChunksPtr()[LengthInBits / ChunkSizeInBits];
+  LengthInBits += numBits;
+
+  auto numSourceChunks = getNumChunksForBits(numBits);
+  auto tailMask = getLowBitsMask(numBits - (numSourceChunks - 1) *
+                                             ChunkSizeInBits);
 
-void ClusteredBitVector::appendReserved(size_t numBits,
-                                        const ChunkType *nextChunk) {
   // This is easy if we're not currently at an offset.
-  // (Note that this special case generator relies on the exact
-  // implementation of the main appendReserved routine.)
-  auto offset = LengthInBits % ChunkSizeInBits;
   if (!offset) {
-    appendReserved(numBits, [&](size_t numBitsWanted) -> ChunkType {
-      return *nextChunk++;
-    });
+    memcpy(destChunks, nextChunk, numSourceChunks * sizeof(ChunkType));
+    destChunks[numSourceChunks - 1] &= tailMask;
     return;
   }
 
-  // But if we are, we need to be constantly mixing values.
-  ChunkType prevChunk = 0;
-  size_t bitsRemaining = 0;
-  appendReserved(numBits, [&](size_t numBitsWanted) -> ChunkType {
-    auto resultMask = (numBitsWanted == ChunkSizeInBits
-                         ? ~ChunkType(0)
-                         : ((ChunkType(1) << numBitsWanted) - 1));
-
-    // If we can resolve the desired bits out of the current chunk,
-    // all the better.
-    if (numBitsWanted <= bitsRemaining) {
-      assert(numBitsWanted != ChunkSizeInBits);
-      auto result = prevChunk & resultMask;
-      bitsRemaining -= numBitsWanted;
-      prevChunk >>= numBitsWanted;
-      return result;
-    }
-
-    // |-- bitsRemaining --|-------- ChunkSizeInBits --------|
-    // |     prevChunk     |             nextChunk           |
-    // |------ numBitsWanted ------|----- bitsRemaining' ----|
-    //                             |        prevChunk'       |
-
-    auto newChunk = *nextChunk++;
-    auto result = (prevChunk | (newChunk << bitsRemaining)) & resultMask;
-    prevChunk = newChunk >> (numBitsWanted - bitsRemaining);
-    bitsRemaining = ChunkSizeInBits + bitsRemaining - numBitsWanted;
-    return result;
-  });
+  // But if we are, the low bits of each source chunk go into the high bits
+  // of a chunk of this vector, and its high bits into the low bits of the
+  // chunk after that one.  The extra bits of the current last chunk are
+  // guaranteed to be zero, and the chunks after it are uninitialized.
+  auto numDestChunks = getNumChunksForBits(offset + numBits);
+  for (size_t i = 0; i != numSourceChunks; ++i) {
+    ChunkType chunk = nextChunk[i];
+    if (i + 1 == numSourceChunks)
+      chunk &= tailMask;
+    destChunks[i] |= chunk << offset;
+    if (i + 1 != numDestChunks)
+      destChunks[i + 1] = chunk >> (ChunkSizeInBits - offset);
+  }
 }
 
 bool ClusteredBitVector::equalsSlowCase(const ClusteredBitVector &lhs,
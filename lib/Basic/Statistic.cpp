@@ -0,0 +1,141 @@
+//===--- Statistic.cpp - Per-job statistics for -stats-output-dir ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Statistic.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cassert>
+#include <cctype>
+
+#if LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace swift;
+
+UnifiedStatsReporter *UnifiedStatsReporter::Current = nullptr;
+
+/// Turn \p Name into something which can be part of a file name.
+static std::string cleanName(StringRef Name) {
+  std::string Result;
+  for (char C : Name) {
+    if (isalnum(C) || C == '-' || C == '_' || C == '.')
+      Result += C;
+    else
+      Result += '_';
+  }
+  return Result;
+}
+
+UnifiedStatsReporter::UnifiedStatsReporter(StringRef ProgramName,
+                                           StringRef AuxName,
+                                           StringRef Directory)
+  : Directory(Directory), ProgramName(ProgramName), AuxName(AuxName),
+    StartTime(std::chrono::steady_clock::now()) {
+  assert(!Current && "only one stats reporter at a time");
+  Current = this;
+}
+
+void UnifiedStatsReporter::setCounter(StringRef Name, int64_t Value) {
+  Counters[Name] = Value;
+}
+
+void UnifiedStatsReporter::addToCounter(StringRef Name, int64_t Delta) {
+  Counters[Name] += Delta;
+}
+
+void UnifiedStatsReporter::beginPhase(StringRef Name) {
+  std::string Path;
+  if (!Phases.empty()) {
+    Path = Phases.back().Path;
+    Path += '.';
+  }
+  Path += Name;
+  Phases.push_back({std::move(Path), std::chrono::steady_clock::now()});
+}
+
+void UnifiedStatsReporter::endPhase() {
+  assert(!Phases.empty() && "no phase is running");
+  auto Elapsed = std::chrono::steady_clock::now() - Phases.back().Start;
+  Timers["time.swift." + Phases.back().Path + ".wall"] +=
+      std::chrono::duration<double>(Elapsed).count();
+  Phases.pop_back();
+}
+
+UnifiedStatsReporter::~UnifiedStatsReporter() {
+  assert(Current == this);
+  Current = nullptr;
+
+  auto Elapsed = std::chrono::steady_clock::now() - StartTime;
+  Timers["time." + ProgramName + ".wall"] =
+      std::chrono::duration<double>(Elapsed).count();
+  Counters["Memory.MallocUsageBytes"] = llvm::sys::Process::GetMallocUsage();
+#if LLVM_ON_UNIX
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) == 0) {
+    // ru_maxrss is in bytes on Darwin and in kilobytes elsewhere.
+#if defined(__APPLE__)
+    Counters["Memory.MaxRSSBytes"] = Usage.ru_maxrss;
+#else
+    Counters["Memory.MaxRSSBytes"] = int64_t(Usage.ru_maxrss) * 1024;
+#endif
+  }
+#endif
+
+  if (auto EC = llvm::sys::fs::create_directories(Directory)) {
+    llvm::errs() << "error creating '" << Directory
+                 << "' for statistics: " << EC.message() << '\n';
+    return;
+  }
+
+  SmallString<128> Model(Directory);
+  llvm::sys::path::append(Model, "stats-" + cleanName(ProgramName) + "-" +
+                                     cleanName(AuxName) + "-%%%%%%%%.json");
+  int FD;
+  SmallString<128> Path;
+  if (auto EC = llvm::sys::fs::createUniqueFile(Model, FD, Path)) {
+    llvm::errs() << "error creating a statistics file in '" << Directory
+                 << "': " << EC.message() << '\n';
+    return;
+  }
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  auto writeKey = [&](StringRef Key) {
+    OS << "  \"";
+    OS.write_escaped(Key) << "\": ";
+  };
+  OS << "{\n";
+  writeKey("program");
+  OS << '"';
+  OS.write_escaped(ProgramName) << "\",\n";
+  writeKey("job");
+  OS << '"';
+  OS.write_escaped(AuxName) << "\",\n";
+  for (auto &Timer : Timers) {
+    writeKey(Timer.first);
+    OS << llvm::format("%.6f", Timer.second) << ",\n";
+  }
+  for (auto &Counter : Counters) {
+    writeKey(Counter.first);
+    OS << Counter.second << ",\n";
+  }
+  // The LLVM statistics are those of STATISTIC counters across LLVM and
+  // Swift, such as the number of deserialized declarations.
+  writeKey("llvm");
+  llvm::PrintStatisticsJSON(OS);
+  OS << "}\n";
+}
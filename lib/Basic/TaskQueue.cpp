@@ -49,7 +49,8 @@ void DummyTaskQueue::addTask(const char *ExecPath, ArrayRef<const char *> Args,
 
 bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
                              TaskQueue::TaskFinishedCallback Finished,
-                             TaskQueue::TaskSignalledCallback Signalled) {
+                             TaskQueue::TaskSignalledCallback Signalled,
+                             TaskQueue::TaskOutputCallback Output) {
   typedef std::pair<ProcessId, std::unique_ptr<DummyTask>> PidTaskPair;
   std::queue<PidTaskPair> ExecutingTasks;
 
@@ -78,10 +79,14 @@ bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
     PidTaskPair P = std::move(ExecutingTasks.front());
     ExecutingTasks.pop();
 
+    std::string TaskOutput = "Output placeholder\n";
+    if (Output && Output(P.first, TaskOutput, P.second->Context) !=
+                      TaskFinishedResponse::ContinueExecution)
+      SubtaskFailed = true;
+
     if (Finished) {
-      std::string Output = "Output placeholder\n";
-        if (Finished(P.first, 0, Output, P.second->Context) ==
-            TaskFinishedResponse::StopExecution)
+        if (Finished(P.first, 0, TaskOutput, P.second->Context) !=
+            TaskFinishedResponse::ContinueExecution)
           SubtaskFailed = true;
     }
   }
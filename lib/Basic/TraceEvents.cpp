@@ -0,0 +1,201 @@
+//===--- TraceEvents.cpp - Chrome trace events ----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TraceEvents.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cassert>
+#include <chrono>
+
+#if LLVM_ON_UNIX
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#endif
+
+using namespace swift;
+
+TraceEventRecorder *TraceEventRecorder::Current = nullptr;
+
+static int64_t getCurrentProcessId() {
+#if LLVM_ON_UNIX
+  return getpid();
+#elif defined(_WIN32)
+  return _getpid();
+#else
+  return 0;
+#endif
+}
+
+static void writeString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  OS.write_escaped(S) << '"';
+}
+
+TraceEventRecorder::TraceEventRecorder(StringRef OutputPath,
+                                       StringRef ProcessName, bool IsFragment)
+  : OutputPath(OutputPath), IsFragment(IsFragment),
+    Pid(getCurrentProcessId()) {
+  assert(!Current && "only one trace event recorder at a time");
+  Current = this;
+  Threads[std::this_thread::get_id()].Tid = 0;
+
+  std::string Event;
+  llvm::raw_string_ostream OS(Event);
+  OS << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << Pid
+     << ", \"tid\": 0, \"args\": {\"name\": ";
+  writeString(OS, ProcessName);
+  OS << "}}";
+  Events.push_back(std::move(OS.str()));
+}
+
+TraceEventRecorder::ThreadState &TraceEventRecorder::getThreadState() {
+  auto Inserted = Threads.insert({std::this_thread::get_id(), ThreadState()});
+  if (Inserted.second)
+    Inserted.first->second.Tid = Threads.size() - 1;
+  return Inserted.first->second;
+}
+
+void TraceEventRecorder::addEvent(std::string &&Event) {
+  std::lock_guard<std::mutex> Guard(Lock);
+  Events.push_back(std::move(Event));
+}
+
+int64_t TraceEventRecorder::now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+      system_clock::now().time_since_epoch()).count();
+}
+
+void TraceEventRecorder::begin(StringRef Name, StringRef Category) {
+  int64_t Start = now();
+  std::lock_guard<std::mutex> Guard(Lock);
+  getThreadState().OpenEvents.push_back({Name, Category, Start});
+}
+
+void TraceEventRecorder::end(int64_t MinDuration) {
+  int64_t End = now();
+  OpenEvent E;
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ThreadState &State = getThreadState();
+    assert(!State.OpenEvents.empty() && "no event was started");
+    E = std::move(State.OpenEvents.back());
+    State.OpenEvents.pop_back();
+  }
+  if (End - E.Start >= MinDuration)
+    addCompleteEvent(E.Name, E.Category, E.Start, End - E.Start);
+}
+
+void TraceEventRecorder::addCompleteEvent(StringRef Name, StringRef Category,
+                                          int64_t Start, int64_t Duration,
+                                          StringRef Detail, int64_t Tid) {
+  if (Tid < 0) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Tid = getThreadState().Tid;
+  }
+
+  std::string Event;
+  llvm::raw_string_ostream OS(Event);
+  OS << "{\"name\": ";
+  writeString(OS, Name);
+  OS << ", \"cat\": ";
+  writeString(OS, Category);
+  OS << ", \"ph\": \"X\", \"ts\": " << Start << ", \"dur\": " << Duration
+     << ", \"pid\": " << Pid << ", \"tid\": " << Tid;
+  if (!Detail.empty()) {
+    OS << ", \"args\": {\"detail\": ";
+    writeString(OS, Detail);
+    OS << '}';
+  }
+  OS << '}';
+  addEvent(std::move(OS.str()));
+}
+
+void TraceEventRecorder::addInstantEvent(StringRef Name, StringRef Category,
+                                         int64_t Time) {
+  std::string Event;
+  llvm::raw_string_ostream OS(Event);
+  OS << "{\"name\": ";
+  writeString(OS, Name);
+  OS << ", \"cat\": ";
+  writeString(OS, Category);
+  OS << ", \"ph\": \"i\", \"s\": \"p\", \"ts\": " << Time
+     << ", \"pid\": " << Pid << ", \"tid\": 0}";
+  addEvent(std::move(OS.str()));
+}
+
+void TraceEventRecorder::addFragments(StringRef Directory) {
+  std::error_code EC;
+  std::vector<std::string> Fragments;
+  for (llvm::sys::fs::directory_iterator I(Directory, EC), E;
+       I != E && !EC; I.increment(EC))
+    Fragments.push_back(I->path());
+
+  for (auto &Fragment : Fragments) {
+    if (auto Buffer = llvm::MemoryBuffer::getFile(Fragment)) {
+      SmallVector<StringRef, 64> Lines;
+      (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                   /*KeepEmpty=*/false);
+      std::lock_guard<std::mutex> Guard(Lock);
+      for (StringRef Line : Lines)
+        Events.push_back(Line);
+    }
+    (void)llvm::sys::fs::remove(Fragment);
+  }
+  (void)llvm::sys::fs::remove(Directory);
+}
+
+TraceEventRecorder::~TraceEventRecorder() {
+  assert(Current == this);
+  Current = nullptr;
+
+  // Close the events of this thread which are still open, e.g. because of
+  // an early exit.
+  while (!Threads[std::this_thread::get_id()].OpenEvents.empty())
+    end();
+
+  int FD;
+  std::error_code EC;
+  SmallString<128> Path;
+  if (IsFragment) {
+    EC = llvm::sys::fs::create_directories(OutputPath);
+    if (!EC) {
+      SmallString<128> Model(OutputPath);
+      llvm::sys::path::append(Model, "trace-%%%%%%%%.part");
+      EC = llvm::sys::fs::createUniqueFile(Model, FD, Path);
+    }
+  } else {
+    Path = OutputPath;
+    EC = llvm::sys::fs::openFileForWrite(Path, FD, llvm::sys::fs::F_Text);
+  }
+  if (EC) {
+    llvm::errs() << "error writing trace events to '" << OutputPath
+                 << "': " << EC.message() << '\n';
+    return;
+  }
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  if (IsFragment) {
+    for (auto &Event : Events)
+      OS << Event << '\n';
+    return;
+  }
+
+  OS << "{\"traceEvents\": [\n";
+  for (size_t I = 0, E = Events.size(); I != E; ++I)
+    OS << Events[I] << (I + 1 == E ? "\n" : ",\n");
+  OS << "],\n\"displayTimeUnit\": \"ms\"}\n";
+}
@@ -34,6 +34,7 @@
 #include "swift/ClangImporter/ClangImporterOptions.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/Parser.h"
+#include "swift/Strings.h"
 #include "swift/Config.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Mangle.h"
@@ -68,6 +69,12 @@ using namespace importer;
 using clang::CompilerInstance;
 using clang::CompilerInvocation;
 
+/// Returns true if \p path names a precompiled bridging header rather than a
+/// header file.
+static bool isPCHFilename(StringRef path) {
+  return llvm::sys::path::extension(path).endswith(PCH_EXTENSION);
+}
+
 #pragma mark Internal data structures
 
 namespace {
@@ -473,6 +480,13 @@ getNormalInvocationArguments(std::vector<std::string> &invocationArgStrs,
     invocationArgStrs.push_back(searchPathOpts.SDKPath);
   }
 
+  // A precompiled bridging header has to be loaded before anything is parsed.
+  // Its module imports are replayed by importBridgingHeader.
+  if (isPCHFilename(importerOpts.BridgingHeader)) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.BridgingHeader);
+  }
+
   const std::string &moduleCachePath = importerOpts.ModuleCachePath;
 
   // Set the module and API notes cache paths to the same location.
@@ -484,6 +498,12 @@ getNormalInvocationArguments(std::vector<std::string> &invocationArgStrs,
     invocationArgStrs.back().append(moduleCachePath);
   }
 
+  if (importerOpts.ValidateModulesOnce) {
+    invocationArgStrs.push_back("-fmodules-validate-once-per-build-session");
+    invocationArgStrs.push_back("-fbuild-session-file=");
+    invocationArgStrs.back().append(importerOpts.BuildSessionFilePath);
+  }
+
   if (importerOpts.DetailedPreprocessingRecord) {
     invocationArgStrs.insert(invocationArgStrs.end(), {
       "-Xclang", "-detailed-preprocessing-record",
@@ -662,6 +682,7 @@ ClangImporter::create(ASTContext &ctx,
   // Install a Clang module file extension to build Swift name lookup tables.
   invocation->getFrontendOpts().ModuleFileExtensions.push_back(
       new SwiftNameLookupExtension(importer->Impl.LookupTables,
+                                   importer->Impl.BridgingHeaderPCHLookupTable,
                                    importer->Impl.SwiftContext,
                                    importer->Impl.platformAvailability,
                                    importer->Impl.InferImportAsMember));
@@ -947,6 +968,15 @@ bool ClangImporter::Implementation::importHeader(
   if (clangDiags.hasFatalErrorOccurred())
     return true;
 
+  // The lookup table of a precompiled bridging header can't be extended with
+  // the declarations of another header.
+  if (BridgingHeaderPCHLookupTable) {
+    SwiftContext.Diags.diagnose(diagLoc,
+                                diag::bridging_header_pch_additional_header,
+                                headerName);
+    return true;
+  }
+
   assert(adapter);
   ImportedHeaderOwners.push_back(adapter);
 
@@ -1059,6 +1089,9 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
     return true;
   }
 
+  if (isPCHFilename(header))
+    return importBridgingPCH(header, adapter, diagLoc);
+
   llvm::SmallString<128> importLine{"#import \""};
   importLine += header;
   importLine += "\"\n";
@@ -1072,6 +1105,96 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                            std::move(sourceBuffer));
 }
 
+bool ClangImporter::importBridgingPCH(StringRef pchPath, Module *adapter,
+                                      SourceLoc diagLoc) {
+  auto &clangDiags = Impl.getClangASTContext().getDiagnostics();
+  if (clangDiags.hasFatalErrorOccurred())
+    return true;
+
+  // Clang already loaded the precompiled header when it was set up, if it
+  // was passed as the bridging header in the importer options.
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  clang::ASTReader *reader = Impl.Instance->getModuleManager().get();
+  clang::serialization::ModuleFile *pchFile = nullptr;
+  if (reader)
+    pchFile = reader->getModuleManager().lookup(fileManager.getFile(pchPath));
+  if (!pchFile || pchFile->Kind != clang::serialization::MK_PCH) {
+    Impl.SwiftContext.Diags.diagnose(diagLoc, diag::bridging_header_error,
+                                     pchPath);
+    return true;
+  }
+
+  assert(adapter);
+  Impl.ImportedHeaderOwners.push_back(adapter);
+
+  // The precompiled header is loaded before ASTReaderCallbacks is installed.
+  // Depend on the headers it was built from rather than on the precompiled
+  // header, which the driver regenerates in every build.
+  reader->visitInputFiles(*pchFile, /*IncludeSystem=*/true, /*Complain=*/false,
+                          [&](const clang::serialization::InputFile &input,
+                              bool isSystem) {
+    if (!input.isOverridden() && input.getFile())
+      addDependency(input.getFile()->getName());
+  });
+
+  // Clang makes the modules imported by the header visible when it loads the
+  // precompiled header. Import them into Swift, like HeaderImportCallbacks
+  // does while a header is parsed.
+  auto &headerSearch = Impl.getClangPreprocessor().getHeaderSearchInfo();
+  for (auto *importedFile : pchFile->Imports) {
+    if (importedFile->Kind != clang::serialization::MK_ImplicitModule &&
+        importedFile->Kind != clang::serialization::MK_ExplicitModule)
+      continue;
+    clang::Module *imported =
+      headerSearch.lookupModule(importedFile->ModuleName,
+                                /*AllowSearch=*/false);
+    if (!imported)
+      continue;
+    Module *nativeImported = Impl.finishLoadingClangModule(*this, imported,
+                                                           /*adapter=*/true);
+    Impl.ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+  }
+
+  Impl.bumpGeneration();
+  return false;
+}
+
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  // The Swift name lookup module file extension of the invocation also writes
+  // the lookup table of the header into the precompiled header.
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
                                                      off_t &fileSize,
                                                      time_t &fileModTime) {
@@ -2392,6 +2515,7 @@ Decl *ClangImporter::importDeclCached(const clang::NamedDecl *ClangDecl) {
 
 void ClangImporter::printStatistics() const {
   Impl.Instance->getModuleManager()->PrintStats();
+  Impl.getNameImporter().printStatistics(llvm::errs());
 }
 
 void ClangImporter::verifyAllModules() {
@@ -2639,8 +2763,11 @@ void ClangImporter::getMangledName(raw_ostream &os,
 SwiftLookupTable *ClangImporter::Implementation::findLookupTable(
                     const clang::Module *clangModule) {
   // If the Clang module is null, use the bridging header lookup table.
-  if (!clangModule)
+  if (!clangModule) {
+    if (BridgingHeaderPCHLookupTable)
+      return BridgingHeaderPCHLookupTable.get();
     return &BridgingHeaderLookupTable;
+  }
 
   // Submodules share lookup tables with their parents.
   if (clangModule->isSubModule())
@@ -2656,7 +2783,11 @@ SwiftLookupTable *ClangImporter::Implementation::findLookupTable(
 bool ClangImporter::Implementation::forEachLookupTable(
        llvm::function_ref<bool(SwiftLookupTable &table)> fn) {
   // Visit the bridging header's lookup table.
-  if (fn(BridgingHeaderLookupTable)) return true;
+  if (BridgingHeaderPCHLookupTable) {
+    if (fn(*BridgingHeaderPCHLookupTable)) return true;
+  } else if (fn(BridgingHeaderLookupTable)) {
+    return true;
+  }
 
   // Collect and sort the set of module names.
   SmallVector<StringRef, 4> moduleNames;
@@ -2874,5 +3005,10 @@ void ClangImporter::Implementation::dumpSwiftLookupTables() {
   }
 
   llvm::errs() << "<<Bridging header lookup table>>\n";
-  BridgingHeaderLookupTable.dump();
+  if (BridgingHeaderPCHLookupTable) {
+    BridgingHeaderPCHLookupTable->deserializeAll();
+    BridgingHeaderPCHLookupTable->dump();
+  } else {
+    BridgingHeaderLookupTable.dump();
+  }
 }
@@ -3497,11 +3497,15 @@ namespace {
     /// it may still be necessary when the protocol's instance methods become
     /// class methods on a root class (e.g. NSObject-the-protocol's instance
     /// methods become class methods on NSObject).
+    ///
+    /// If \p name is not empty, only the members with this base name are
+    /// imported.
     void importMirroredProtocolMembers(const clang::ObjCContainerDecl *decl,
                                        DeclContext *dc,
                                        ArrayRef<ProtocolDecl *> protocols,
                                        SmallVectorImpl<Decl *> &members,
-                                       ASTContext &Ctx);
+                                       ASTContext &Ctx,
+                                       Identifier name = Identifier());
 
     /// \brief Import constructors from our superclasses (and their
     /// categories/extensions), effectively "inheriting" constructors.
@@ -5965,7 +5969,7 @@ void SwiftDeclConverter::importObjCMembers(
 void SwiftDeclConverter::importMirroredProtocolMembers(
     const clang::ObjCContainerDecl *decl, DeclContext *dc,
     ArrayRef<ProtocolDecl *> protocols, SmallVectorImpl<Decl *> &members,
-    ASTContext &Ctx) {
+    ASTContext &Ctx, Identifier name) {
   assert(dc);
   const clang::ObjCInterfaceDecl *interfaceDecl = nullptr;
   const ClangModuleUnit *declModule;
@@ -6003,6 +6007,12 @@ void SwiftDeclConverter::importMirroredProtocolMembers(
       if (member->getAttrs().isUnavailableInCurrentSwift())
         continue;
 
+      if (!name.empty()) {
+        auto value = dyn_cast<ValueDecl>(member);
+        if (!value || value->getFullName().getBaseName() != name)
+          continue;
+      }
+
       if (auto prop = dyn_cast<VarDecl>(member)) {
         auto objcProp =
             dyn_cast_or_null<clang::ObjCPropertyDecl>(prop->getClangDecl());
@@ -7287,6 +7297,129 @@ ClangImporter::Implementation::loadAllMembers(Decl *D, uint64_t extra) {
 
 }
 
+bool ClangImporter::Implementation::loadNamedMembers(
+       const IterableDeclContext *IDC, Identifier name, uint64_t extra,
+       SmallVectorImpl<ValueDecl *> &members) {
+  Decl *D = nullptr;
+  DeclContext *DC = nullptr;
+  switch (IDC->getIterableContextKind()) {
+  case IterableDeclContextKind::NominalTypeDecl: {
+    auto nominal = const_cast<NominalTypeDecl *>(cast<NominalTypeDecl>(IDC));
+    D = nominal;
+    DC = nominal;
+    break;
+  }
+  case IterableDeclContextKind::ExtensionDecl: {
+    auto ext = const_cast<ExtensionDecl *>(cast<ExtensionDecl>(IDC));
+    D = ext;
+    DC = ext;
+    break;
+  }
+  }
+
+  auto nominal = DC->getAsNominalTypeOrNominalTypeExtensionContext();
+  if (!nominal)
+    return true;
+
+  // The members are found by their effective context, which is the class
+  // for the members of categories.
+  auto effectiveClangContext = getEffectiveClangContext(nominal);
+  if (!effectiveClangContext)
+    return true;
+
+  // If this isn't an Objective-C container, we're importing globals-as-members
+  // into an extension, and the submodule is encoded in the extra data.
+  auto objcContainer =
+    dyn_cast_or_null<clang::ObjCContainerDecl>(D->getClangDecl());
+  clang::Module *submodule = nullptr;
+  if (!objcContainer)
+    submodule = reinterpret_cast<clang::Module *>(static_cast<uintptr_t>(extra));
+
+  // Inherited and mirrored initializers of classes are only imported together
+  // with all other members.
+  if (objcContainer && !isa<ProtocolDecl>(nominal) &&
+      name == SwiftContext.Id_init)
+    return true;
+
+  // Collect the Clang declarations which are imported with this base name,
+  // under either their Swift 3 or their Swift 2 name.
+  SmallVector<clang::NamedDecl *, 4> clangMembers;
+  llvm::SmallPtrSet<clang::NamedDecl *, 4> knownClangMembers;
+  (void)forEachLookupTable([&](SwiftLookupTable &table) -> bool {
+    for (auto entry : table.lookup(name.str(), effectiveClangContext)) {
+      auto decl = entry.dyn_cast<clang::NamedDecl *>();
+      if (!decl)
+        continue;
+
+      // Only consider the declarations which loadAllMembers would import
+      // into this context.
+      if (objcContainer) {
+        if (decl->getDeclContext() != objcContainer ||
+            decl != decl->getCanonicalDecl())
+          continue;
+      } else if (decl->getImportedOwningModule() != submodule) {
+        continue;
+      }
+
+      if (knownClangMembers.insert(decl).second)
+        clangMembers.push_back(decl);
+    }
+    return false;
+  });
+
+  ImportingEntityRAII Importing(*this);
+
+  llvm::SmallPtrSet<Decl *, 4> knownMembers;
+  auto addMember = [&](Decl *member) {
+    auto value = dyn_cast_or_null<ValueDecl>(member);
+    if (!value || value->getDeclContext() != DC ||
+        value->getFullName().getBaseName() != name)
+      return;
+    if (knownMembers.insert(value).second)
+      members.push_back(value);
+  };
+
+  for (auto decl : clangMembers) {
+    for (bool useSwift2Name : { false, true }) {
+      auto member = importDecl(decl, useSwift2Name);
+      if (!member)
+        continue;
+
+      // Like importObjCMembers, add the alternate declarations of methods
+      // and skip hidden methods.
+      auto objcMethod = dyn_cast<clang::ObjCMethodDecl>(decl);
+      if (!objcContainer || objcMethod)
+        addMember(getAlternateDecl(member));
+      if (objcMethod && shouldSuppressDeclImport(objcMethod))
+        continue;
+
+      addMember(member);
+    }
+  }
+
+  // Import the mirrored members of the protocols this class, category or
+  // extension conforms to, like loadAllMembers.
+  if (objcContainer && !isa<ProtocolDecl>(nominal)) {
+    // Importing the mirrored members can record the protocols of other
+    // declarations, so copy the list.
+    SmallVector<ProtocolDecl *, 4> protos(getImportedProtocols(D).begin(),
+                                          getImportedProtocols(D).end());
+    if (!protos.empty()) {
+      if (auto clangClass = dyn_cast<clang::ObjCInterfaceDecl>(objcContainer))
+        objcContainer = clangClass->getDefinition();
+
+      SwiftDeclConverter converter(*this, /*useSwift2Name=*/false);
+      SmallVector<Decl *, 4> mirrored;
+      converter.importMirroredProtocolMembers(objcContainer, DC, protos,
+                                              mirrored, SwiftContext, name);
+      for (auto member : mirrored)
+        addMember(member);
+    }
+  }
+
+  return false;
+}
+
 void ClangImporter::Implementation::loadAllConformances(
        const Decl *D, uint64_t contextData,
        SmallVectorImpl<ProtocolConformance *> &Conformances) {
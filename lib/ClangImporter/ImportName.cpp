@@ -1636,12 +1636,25 @@ Identifier importer::importMacroName(
 ImportedName NameImporter::importName(const clang::NamedDecl *decl,
                                       ImportNameOptions options) {
   CacheKeyType key(decl, options.toRaw());
-  if (importNameCache.count(key)) {
+  auto known = importNameCache.find(key);
+  if (known != importNameCache.end()) {
     ++ImportNameNumCacheHits;
-    return importNameCache[key];
+    ++numCacheHits;
+    return known->second;
   }
   ++ImportNameNumCacheMisses;
+  ++numCacheMisses;
+
+  // Importing the name can import the names of other decls, so don't keep an
+  // iterator into the cache across the call.
   auto res = importNameImpl(decl, options);
-  importNameCache[key] = res;
+  importNameCache.insert({key, res});
   return res;
 }
+
+void NameImporter::printStatistics(llvm::raw_ostream &os) const {
+  os << "*** Swift import name cache ***\n";
+  os << "  " << importNameCache.size() << " cached names\n";
+  os << "  " << numCacheHits << " cache hits\n";
+  os << "  " << numCacheMisses << " cache misses\n";
+}
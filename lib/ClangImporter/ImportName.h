@@ -176,6 +176,10 @@ class NameImporter {
   /// Cache for repeated calls
   llvm::DenseMap<CacheKeyType, ImportedName> importNameCache;
 
+  /// The number of importName calls answered from / missing in the cache.
+  unsigned numCacheHits = 0;
+  unsigned numCacheMisses = 0;
+
 public:
   NameImporter(ASTContext &ctx, const PlatformAvailability &avail,
                clang::Sema &cSema, bool inferIAM)
@@ -187,6 +191,9 @@ public:
   ImportedName importName(const clang::NamedDecl *decl,
                           ImportNameOptions options);
 
+  /// Print statistics about the import name cache to \p os.
+  void printStatistics(llvm::raw_ostream &os) const;
+
   ASTContext &getContext() { return swiftCtx; }
   const LangOptions &getLangOpts() const { return swiftCtx.LangOpts; }
 
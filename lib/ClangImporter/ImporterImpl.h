@@ -288,6 +288,11 @@ private:
   /// (through the Swift name lookup module file extension).
   LookupTableMap LookupTables;
 
+  /// The Swift lookup table for the bridging header, if it was loaded from a
+  /// precompiled bridging header. Listed early for the same reason as
+  /// \c LookupTables.
+  std::unique_ptr<SwiftLookupTable> BridgingHeaderPCHLookupTable;
+
   /// \brief A count of the number of load module operations.
   /// FIXME: Horrible, horrible hack for \c loadModule().
   unsigned ImportCounter = 0;
@@ -1080,9 +1085,22 @@ public:
     return result;
   }
 
+  /// Retrieve the imported protocols for the given declaration, without
+  /// removing them.
+  ArrayRef<ProtocolDecl *> getImportedProtocols(const Decl *decl) const {
+    auto known = ImportedProtocols.find(decl);
+    if (known == ImportedProtocols.end())
+      return { };
+    return known->second;
+  }
+
   virtual void
   loadAllMembers(Decl *D, uint64_t unused) override;
 
+  bool loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                        uint64_t contextData,
+                        SmallVectorImpl<ValueDecl *> &members) override;
+
   void
   loadAllConformances(
     const Decl *D, uint64_t contextData,
@@ -1166,15 +1184,18 @@ bool shouldSuppressDeclImport(const clang::Decl *decl);
 
 class SwiftNameLookupExtension : public clang::ModuleFileExtension {
   LookupTableMap &lookupTables;
+  std::unique_ptr<SwiftLookupTable> &pchLookupTable;
   ASTContext &swiftCtx;
   const PlatformAvailability &availability;
   const bool inferImportAsMember;
 
 public:
-  SwiftNameLookupExtension(LookupTableMap &tables, ASTContext &ctx,
-                           const PlatformAvailability &avail, bool inferIAM)
-      : lookupTables(tables), swiftCtx(ctx), availability(avail),
-        inferImportAsMember(inferIAM) {}
+  SwiftNameLookupExtension(LookupTableMap &tables,
+                           std::unique_ptr<SwiftLookupTable> &pchTable,
+                           ASTContext &ctx, const PlatformAvailability &avail,
+                           bool inferIAM)
+      : lookupTables(tables), pchLookupTable(pchTable), swiftCtx(ctx),
+        availability(avail), inferImportAsMember(inferIAM) {}
 
   clang::ModuleFileExtensionMetadata getExtensionMetadata() const override;
   llvm::hash_code hashExtension(llvm::hash_code code) const override;
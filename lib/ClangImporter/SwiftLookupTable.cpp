@@ -1549,6 +1549,18 @@ SwiftNameLookupExtension::createExtensionReader(
   assert(metadata.MajorVersion == SWIFT_LOOKUP_TABLE_VERSION_MAJOR);
   assert(metadata.MinorVersion == SWIFT_LOOKUP_TABLE_VERSION_MINOR);
 
+  // The table of a precompiled header is the one of the bridging header.
+  if (mod.Kind == clang::serialization::MK_PCH) {
+    if (pchLookupTable) return nullptr;
+
+    auto tableReader = SwiftLookupTableReader::create(
+        this, reader, mod, [this]() { pchLookupTable.reset(); }, stream);
+    if (!tableReader) return nullptr;
+
+    pchLookupTable.reset(new SwiftLookupTable(tableReader.get()));
+    return std::move(tableReader);
+  }
+
   // Check whether we already have an entry in the set of lookup tables.
   auto &entry = lookupTables[mod.ModuleName];
   if (entry) return nullptr;
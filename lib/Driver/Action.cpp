@@ -20,7 +20,12 @@ using namespace llvm::opt;
 
 JobAction::~JobAction() {
   if (getOwnsInputs()) {
-    llvm::DeleteContainerPointers(Inputs);
+    // The precompiled bridging header is an input of all compile actions and
+    // isn't owned by any of them.
+    for (Action *Input : Inputs)
+      if (!isa<GeneratePCHJobAction>(Input))
+        delete Input;
+    Inputs.clear();
   }
 }
 
@@ -36,6 +41,7 @@ const char *Action::getClassName(ActionClass AC) {
     case REPLJob: return "repl";
     case LinkJob: return "link";
     case GenerateDSYMJob: return "generate-dSYM";
+    case GeneratePCHJob: return "generate-pch";
   }
 
   llvm_unreachable("invalid class");
@@ -62,3 +68,5 @@ void REPLJobAction::anchor() {}
 void LinkJobAction::anchor() {}
 
 void GenerateDSYMJobAction::anchor() {}
+
+void GeneratePCHJobAction::anchor() {}
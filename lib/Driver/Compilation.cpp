@@ -16,7 +16,9 @@
 #include "swift/AST/DiagnosticsDriver.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Program.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
 #include "swift/Driver/Action.h"
@@ -24,6 +26,8 @@
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Driver/ToolChain.h"
+#include "swift/Option/Options.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -35,6 +39,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/YAMLParser.h"
+#include <algorithm>
 
 #include "CompilationRecord.h"
 
@@ -88,11 +93,20 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// The time in seconds each successfully finished job took to run. The
+    /// time of a batch job is split evenly between the jobs it combines.
+    llvm::SmallDenseMap<const Job *, double, 16> Durations;
   };
 }
 
 Compilation::~Compilation() = default;
 
+void Compilation::enableBatchMode(const ToolChain &TC, const OutputInfo &OI) {
+  BatchModeToolChain = &TC;
+  BatchModeOutputInfo.reset(new OutputInfo(OI));
+}
+
 Job *Compilation::addJob(std::unique_ptr<Job> J) {
   Job *result = J.get();
   Jobs.emplace_back(std::move(J));
@@ -111,17 +125,27 @@ static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
 using InputInfoMap =
   llvm::SmallMapVector<const llvm::opt::Arg *, CompileJobAction::InputInfo, 16>;
 
+/// Returns the duration recorded for \p Cmd in the previous build, or 0.
+static double getPreviousDuration(const Job *Cmd) {
+  if (auto *compileAction = dyn_cast<CompileJobAction>(&Cmd->getSource()))
+    return compileAction->getInputInfo().previousDuration;
+  return 0;
+}
+
 static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
       info.status = entry.second ?
           CompileJobAction::InputInfo::NeedsCascadingBuild :
           CompileJobAction::InputInfo::NeedsNonCascadingBuild;
+      info.previousDuration = getPreviousDuration(entry.first);
       inputs[&inputFile->getInputArg()] = info;
     }
   }
@@ -132,11 +156,19 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
       info.status = CompileJobAction::InputInfo::UpToDate;
+      // Jobs which didn't need to run keep their previous duration.
+      auto duration = endState.Durations.find(entry);
+      if (duration != endState.Durations.end())
+        info.previousDuration = duration->second;
+      else
+        info.previousDuration = getPreviousDuration(entry);
       inputs[&inputFile->getInputArg()] = info;
     }
   }
@@ -219,6 +251,19 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  bool wroteDurationsKey = false;
+  for (auto &entry : inputs) {
+    if (entry.second.previousDuration <= 0)
+      continue;
+    if (!wroteDurationsKey) {
+      out << compilation_record::getName(TopLevelKey::JobDurations) << ":\n";
+      wroteDurationsKey = true;
+    }
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": "
+        << static_cast<uint64_t>(entry.second.previousDuration * 1000 + 0.5)
+        << "\n";
+  }
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -258,6 +303,79 @@ static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
   return true;
 }
 
+/// Returns the jobs whose work \p Cmd performs: the constituents of a batch
+/// job, or \p Cmd itself.
+static ArrayRef<const Job *> getCombinedJobs(const Job *const &Cmd) {
+  if (auto *Batch = dyn_cast<BatchJob>(Cmd))
+    return Batch->getCombinedJobs();
+  return Cmd;
+}
+
+/// Returns true if \p Cmd can share a frontend invocation with other compile
+/// jobs.
+///
+/// Only outputs that the frontend can produce separately for each primary
+/// file are allowed.
+static bool isBatchable(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return false;
+  // The only input job a compile job can have is the precompiled bridging
+  // header, which all compile jobs share.
+  if (Cmd->getSource().size() != Cmd->getInputs().size() + 1)
+    return false;
+  if (!isa<InputAction>(*Cmd->getSource().begin()))
+    return false;
+
+  const CommandOutput &Output = Cmd->getOutput();
+  if (Output.getPrimaryOutputFilenames().size() != 1)
+    return false;
+
+  bool Batchable = true;
+  types::forAllTypes([&](types::ID Type) {
+    if (Output.getAdditionalOutputForType(Type).empty())
+      return;
+    switch (Type) {
+    case types::TY_SwiftModuleFile:
+    case types::TY_SwiftModuleDocFile:
+    case types::TY_Dependencies:
+    case types::TY_SwiftDeps:
+      break;
+    default:
+      Batchable = false;
+      break;
+    }
+  });
+  return Batchable;
+}
+
+/// Returns a key that is the same for two batchable jobs exactly when they
+/// produce the same kinds of outputs, and so can be combined.
+static std::string getBatchKey(const Job *Cmd) {
+  const CommandOutput &Output = Cmd->getOutput();
+  std::string Key = types::getTypeName(Output.getPrimaryOutputType());
+  types::forAllTypes([&](types::ID Type) {
+    if (Output.getAdditionalOutputForType(Type).empty())
+      return;
+    Key += ',';
+    Key += types::getTypeName(Type);
+  });
+  return Key;
+}
+
+/// The name of \p Cmd in the -trace-events-output timeline, e.g.
+/// "compile main.o".
+static std::string getTraceName(const Job *Cmd) {
+  std::string Name = Cmd->getSource().getClassName();
+  ArrayRef<std::string> Outputs = Cmd->getOutput().getPrimaryOutputFilenames();
+  if (!Outputs.empty()) {
+    Name += ' ';
+    Name += llvm::sys::path::filename(Outputs.front());
+    if (Outputs.size() > 1)
+      Name += ", ...";
+  }
+  return Name;
+}
+
 int Compilation::performJobsImpl() {
   // Create a TaskQueue for execution.
   std::unique_ptr<TaskQueue> TQ;
@@ -265,6 +383,8 @@ int Compilation::performJobsImpl() {
     TQ.reset(new DummyTaskQueue(NumberOfParallelCommands));
   else
     TQ.reset(new TaskQueue(NumberOfParallelCommands));
+  if (!FrontendServerSocket.empty())
+    TQ->setServerSocketPath(FrontendServerSocket);
 
   PerformJobsState State;
 
@@ -272,6 +392,10 @@ int Compilation::performJobsImpl() {
   DependencyGraph DepGraph;
   SmallPtrSet<const Job *, 16> DeferredCommands;
   SmallVector<const Job *, 16> InitialOutOfDateCommands;
+  /// Initially out-of-date jobs whose downstream jobs aren't marked until
+  /// they finish, because their dependencies file can tell which
+  /// declarations changed.
+  SmallPtrSet<const Job *, 16> FineGrainedOutOfDateCommands;
 
   DependencyGraph::MarkTracer ActualIncrementalTracer;
   DependencyGraph::MarkTracer *IncrementalTracer = nullptr;
@@ -292,6 +416,126 @@ int Compilation::performJobsImpl() {
     });
   };
 
+  // Jobs which are ready to run but haven't been handed to the TaskQueue yet,
+  // and the batch jobs formed out of them in batch mode.
+  SmallVector<const Job *, 16> PendingCommands;
+  std::vector<std::unique_ptr<const BatchJob>> BatchJobs;
+
+  auto addTaskForCommand = [&] (const Job *Cmd) {
+    // FIXME: Failing here should not take down the whole process.
+    bool success = writeFilelistIfNecessary(Cmd, Diags);
+    assert(success && "failed to write filelist");
+    (void)success;
+
+    assert(Cmd->getExtraEnvironment().empty() &&
+           "not implemented for compilations with multiple jobs");
+    if (auto *Trace = TraceEventRecorder::get())
+      Trace->addInstantEvent("schedule " + getTraceName(Cmd), "driver",
+                             TraceEventRecorder::now());
+    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                (void *)Cmd);
+  };
+
+  // Jobs without a duration in the compilation record are expected to take
+  // as long as the average job which has one.
+  double DefaultDuration = 1;
+  {
+    double TotalDuration = 0;
+    unsigned NumDurations = 0;
+    for (const Job *Cmd : getJobs()) {
+      if (double Duration = getPreviousDuration(Cmd)) {
+        TotalDuration += Duration;
+        ++NumDurations;
+      }
+    }
+    if (NumDurations)
+      DefaultDuration = TotalDuration / NumDurations;
+  }
+  auto getExpectedDuration = [&](const Job *Cmd) -> double {
+    if (double Duration = getPreviousDuration(Cmd))
+      return Duration;
+    return DefaultDuration;
+  };
+
+  // Order the pending jobs so that those which likely start the longest
+  // chain of work are handed to the TaskQueue first. The length of the chain
+  // is estimated as the expected duration of the job plus that of its
+  // slowest direct dependent in the dependency graph. Between jobs with the
+  // same estimate, the one with more dependents goes first.
+  //
+  // Jobs which run one after the other take the same total time in any
+  // order, so they keep the order of the inputs.
+  auto sortPendingCommandsByCriticalPath = [&] {
+    if (NumberOfParallelCommands <= 1 || PendingCommands.size() < 2)
+      return;
+
+    struct Priority {
+      double PathLength;
+      size_t NumDependents;
+    };
+    llvm::SmallDenseMap<const Job *, Priority, 16> Priorities;
+    for (const Job *Cmd : PendingCommands) {
+      SmallVector<const Job *, 16> Dependents;
+      for (const Job *Combined : getCombinedJobs(Cmd))
+        DepGraph.getDirectDependents(Dependents, Combined);
+      double SlowestDependent = 0;
+      for (const Job *Dependent : Dependents)
+        SlowestDependent = std::max(SlowestDependent,
+                                    getExpectedDuration(Dependent));
+      Priorities[Cmd] = { getExpectedDuration(Cmd) + SlowestDependent,
+                          Dependents.size() };
+    }
+
+    std::stable_sort(PendingCommands.begin(), PendingCommands.end(),
+                     [&](const Job *LHS, const Job *RHS) {
+      const Priority &L = Priorities[LHS], &R = Priorities[RHS];
+      if (L.PathLength != R.PathLength)
+        return L.PathLength > R.PathLength;
+      return L.NumDependents > R.NumDependents;
+    });
+  };
+
+  // Hand all pending jobs to the TaskQueue. In batch mode, compile jobs that
+  // can share a frontend invocation are first combined into at most one batch
+  // per parallel command slot.
+  auto flushPendingCommands = [&] {
+    if (!getBatchModeEnabled()) {
+      sortPendingCommandsByCriticalPath();
+      for (const Job *Cmd : PendingCommands)
+        addTaskForCommand(Cmd);
+      PendingCommands.clear();
+      return;
+    }
+
+    llvm::MapVector<std::string, SmallVector<const Job *, 8>> Batchable;
+    for (const Job *Cmd : PendingCommands) {
+      if (!isBatchable(Cmd)) {
+        addTaskForCommand(Cmd);
+        continue;
+      }
+      Batchable[getBatchKey(Cmd)].push_back(Cmd);
+    }
+    PendingCommands.clear();
+
+    for (auto &Entry : Batchable) {
+      ArrayRef<const Job *> Cmds = Entry.second;
+      size_t NumBatches = std::min<size_t>(
+          std::max(NumberOfParallelCommands, 1U), Cmds.size());
+      for (size_t i = 0; i != NumBatches; ++i) {
+        size_t Begin = Cmds.size() * i / NumBatches;
+        size_t End = Cmds.size() * (i + 1) / NumBatches;
+        ArrayRef<const Job *> Slice = Cmds.slice(Begin, End - Begin);
+        if (Slice.size() == 1) {
+          addTaskForCommand(Slice.front());
+          continue;
+        }
+        BatchJobs.push_back(BatchModeToolChain->constructBatchJob(
+            Slice, *this, *BatchModeOutputInfo));
+        addTaskForCommand(BatchJobs.back().get());
+      }
+    }
+  };
+
   // Set up scheduleCommandIfNecessaryAndPossible.
   // This will only schedule the given command if it has not been scheduled
   // and if all of its inputs are in FinishedCommands.
@@ -305,16 +549,8 @@ int Compilation::performJobsImpl() {
       return;
     }
 
-    // FIXME: Failing here should not take down the whole process.
-    bool success = writeFilelistIfNecessary(Cmd, Diags);
-    assert(success && "failed to write filelist");
-    (void)success;
-
-    assert(Cmd->getExtraEnvironment().empty() &&
-           "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+    PendingCommands.push_back(Cmd);
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -392,6 +628,10 @@ int Compilation::performJobsImpl() {
     // files that haven't changed, so that they'll get built in parallel if
     // possible and after the first set of files if it's not.
     for (auto *Cmd : InitialOutOfDateCommands) {
+      if (DepGraph.hasDeclHashes(Cmd)) {
+        FineGrainedOutOfDateCommands.insert(Cmd);
+        continue;
+      }
       DepGraph.markTransitive(AdditionalOutOfDateCommands, Cmd,
                               IncrementalTracer);
     }
@@ -430,6 +670,38 @@ int Compilation::performJobsImpl() {
   llvm::TimerGroup DriverTimerGroup("Driver Time Compilation");
   llvm::SmallDenseMap<const Job *, std::unique_ptr<llvm::Timer>, 16>
     DriverTimers;
+  llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16> StartTimes;
+
+  // The running jobs shown in each row of the trace, after the driver's own
+  // row 0. A job takes the first free row when it starts, so jobs which run
+  // at the same time are shown next to each other.
+  SmallVector<const Job *, 8> TraceRows;
+  llvm::SmallDenseMap<const Job *, int64_t, 16> TraceStartTimes;
+  auto traceJobBegan = [&] (const Job *Cmd) {
+    if (!TraceEventRecorder::get())
+      return;
+    TraceStartTimes[Cmd] = TraceEventRecorder::now();
+    auto Free = std::find(TraceRows.begin(), TraceRows.end(), nullptr);
+    if (Free != TraceRows.end())
+      *Free = Cmd;
+    else
+      TraceRows.push_back(Cmd);
+  };
+  auto traceJobEnded = [&] (const Job *Cmd, ProcessId Pid) {
+    auto *Trace = TraceEventRecorder::get();
+    if (!Trace)
+      return;
+    auto Row = std::find(TraceRows.begin(), TraceRows.end(), Cmd);
+    auto Start = TraceStartTimes.find(Cmd);
+    if (Row == TraceRows.end() || Start == TraceStartTimes.end())
+      return;
+    Trace->addCompleteEvent(getTraceName(Cmd), "job", Start->second,
+                            TraceEventRecorder::now() - Start->second,
+                            "pid " + std::to_string(Pid),
+                            Row - TraceRows.begin() + 1);
+    *Row = nullptr;
+    TraceStartTimes.erase(Start);
+  };
 
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
@@ -437,15 +709,19 @@ int Compilation::performJobsImpl() {
   auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    StartTimes[BeganCmd] = llvm::sys::TimeValue::now();
+    traceJobBegan(BeganCmd);
 
     if (ShowDriverTimeCompilation) {
       llvm::SmallString<128> TimerName;
       llvm::raw_svector_ostream OS(TimerName);
 
       OS << BeganCmd->getSource().getClassName();
-      for (auto A : BeganCmd->getSource().getInputs()) {
-        if (const InputAction *IA = dyn_cast<InputAction>(A)) {
-          OS << " " << IA->getInputArg().getValue();
+      for (const Job *Cmd : getCombinedJobs(BeganCmd)) {
+        for (auto A : Cmd->getSource().getInputs()) {
+          if (const InputAction *IA = dyn_cast<InputAction>(A)) {
+            OS << " " << IA->getInputArg().getValue();
+          }
         }
       }
       for (auto J : BeganCmd->getInputs()) {
@@ -471,6 +747,157 @@ int Compilation::performJobsImpl() {
       parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
   };
 
+  // In order to handle both old dependencies that have disappeared and new
+  // dependencies that have arisen, a finished job's dependency file has to be
+  // reloaded whether or not the build succeeded. Any jobs that now need to
+  // run are added to \p Dependents.
+  auto reloadDependencies = [&](const Job *FinishedCmd, int ReturnCode,
+                                SmallVectorImpl<const Job *> &Dependents) {
+    if (!getIncrementalBuildEnabled())
+      return;
+
+    const CommandOutput &Output = FinishedCmd->getOutput();
+    StringRef DependenciesFile =
+      Output.getAdditionalOutputForType(types::TY_SwiftDeps);
+
+    if (DependenciesFile.empty()) {
+      // If this job doesn't track dependencies, it must always be run.
+      // Note: In theory CheckDependencies makes sense as well (for a leaf
+      // node in the dependency graph), and maybe even NewlyAdded (for very
+      // coarse dependencies that always affect downstream nodes), but we're
+      // not using either of those right now, and this logic should probably
+      // be revisited when we are.
+      assert(FinishedCmd->getCondition() == Job::Condition::Always);
+    } else {
+      // If we have a dependency file /and/ the frontend task exited normally,
+      // we can be discerning about what downstream files to rebuild.
+      if (ReturnCode == EXIT_SUCCESS || ReturnCode == EXIT_FAILURE) {
+        bool wasCascading = DepGraph.isMarked(FinishedCmd) &&
+            !FineGrainedOutOfDateCommands.count(FinishedCmd);
+
+        switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
+        case DependencyGraphImpl::LoadResult::HadError:
+          if (ReturnCode == EXIT_SUCCESS) {
+            disableIncrementalBuild();
+            for (const Job *Cmd : DeferredCommands)
+              scheduleCommandIfNecessaryAndPossible(Cmd);
+            DeferredCommands.clear();
+            Dependents.clear();
+          } // else, let the next build handle it.
+          break;
+        case DependencyGraphImpl::LoadResult::UpToDate:
+          if (!wasCascading)
+            break;
+          SWIFT_FALLTHROUGH;
+        case DependencyGraphImpl::LoadResult::AffectsDownstream:
+          DepGraph.markTransitive(Dependents, FinishedCmd);
+          break;
+        }
+      } else {
+        // If there's an abnormal exit (a crash), assume the worst.
+        switch (FinishedCmd->getCondition()) {
+        case Job::Condition::NewlyAdded:
+          // The job won't be treated as newly added next time. Conservatively
+          // mark it as affecting other jobs, because some of them may have
+          // completed already.
+          DepGraph.markTransitive(Dependents, FinishedCmd);
+          break;
+        case Job::Condition::Always:
+          // Any incremental task that shows up here has already been marked;
+          // we didn't need to wait for it to finish to start downstream
+          // tasks, unless we were waiting to see which declarations changed.
+          assert(DepGraph.isMarked(FinishedCmd));
+          if (FineGrainedOutOfDateCommands.count(FinishedCmd))
+            DepGraph.markTransitive(Dependents, FinishedCmd);
+          break;
+        case Job::Condition::RunWithoutCascading:
+          // If this file changed, it might have been a non-cascading change
+          // and it might not. Unfortunately, the interface hash has been
+          // updated or compromised, so we don't actually know anymore; we
+          // have to conservatively assume the changes could affect other
+          // files.
+          DepGraph.markTransitive(Dependents, FinishedCmd);
+          break;
+        case Job::Condition::CheckDependencies:
+          // If the only reason we're running this is because something else
+          // changed, then we can trust the dependency graph as to whether
+          // it's a cascading or non-cascading change. That is, if whatever
+          // /caused/ the error isn't supposed to affect other files, and
+          // whatever /fixes/ the error isn't supposed to affect other files,
+          // then there's no need to recompile any other inputs. If either of
+          // those are false, we /do/ need to recompile other inputs.
+          break;
+        }
+      }
+    }
+  };
+
+  // The output of each executing task which wasn't shown yet because it
+  // doesn't end in a newline, so that diagnostics are shown in one piece.
+  llvm::SmallDenseMap<const Job *, std::string, 16> PendingOutput;
+  bool CancelOnError = CancelOnFirstError && !ContinueBuildingAfterErrors;
+  // Whether the remaining tasks were terminated because a task failed.
+  bool CancelledJobs = false;
+
+  auto showOutput = [&] (const Job *Cmd, ProcessId Pid, StringRef Output) {
+    if (!StreamJobOutput || Output.empty())
+      return;
+    if (Level == OutputLevel::Parseable)
+      parseable_output::emitOutputMessage(llvm::errs(), *Cmd, Pid, Output);
+    else
+      llvm::errs() << Output;
+  };
+
+  auto cancelOnError = [&] () -> TaskFinishedResponse {
+    CancelledJobs = true;
+    return TaskFinishedResponse::TerminateExecution;
+  };
+
+  // Set up a callback which will be called whenever an executing task
+  // produced output. This callback shows the output right away if
+  // -stream-job-output was passed, and stops the build once a task reports an
+  // error if -cancel-on-first-error was passed.
+  auto taskOutput = [&] (ProcessId Pid, StringRef Output,
+                         void *Context) -> TaskFinishedResponse {
+    const Job *Cmd = (const Job *)Context;
+    std::string &Pending = PendingOutput[Cmd];
+    Pending += Output;
+    size_t End = Pending.rfind('\n');
+    if (End == std::string::npos)
+      return TaskFinishedResponse::ContinueExecution;
+
+    StringRef Lines = StringRef(Pending).slice(0, End + 1);
+    showOutput(Cmd, Pid, Lines);
+
+    bool HadError = false;
+    if (CancelOnError) {
+      SmallVector<StringRef, 8> SplitLines;
+      Lines.split(SplitLines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      HadError = std::any_of(SplitLines.begin(), SplitLines.end(),
+                             [](StringRef Line) {
+        return Line.startswith("error: ") ||
+               Line.find(": error: ") != StringRef::npos;
+      });
+    }
+    Pending.erase(0, End + 1);
+
+    if (HadError)
+      return cancelOnError();
+    return TaskFinishedResponse::ContinueExecution;
+  };
+
+  // Shows the output of a task which finished that wasn't shown yet, and
+  // returns the output which the finished or signalled message should show.
+  auto takeFinalOutput = [&] (const Job *Cmd, ProcessId Pid,
+                              StringRef Output) -> StringRef {
+    auto Pending = PendingOutput.find(Cmd);
+    if (Pending != PendingOutput.end()) {
+      showOutput(Cmd, Pid, Pending->second);
+      PendingOutput.erase(Pending);
+    }
+    return StreamJobOutput ? StringRef() : Output;
+  };
+
   // Set up a callback which will be called immediately after a task has
   // finished execution. This callback should determine if execution should
   // continue (if execution should stop, this callback should return true), and
@@ -483,6 +910,8 @@ int Compilation::performJobsImpl() {
     if (ShowDriverTimeCompilation) {
       DriverTimers[FinishedCmd]->stopTimer();
     }
+    traceJobEnded(FinishedCmd, Pid);
+    Output = takeFinalOutput(FinishedCmd, Pid, Output);
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
@@ -495,83 +924,9 @@ int Compilation::performJobsImpl() {
         llvm::errs() << Output;
     }
 
-    // In order to handle both old dependencies that have disappeared and new
-    // dependencies that have arisen, we need to reload the dependency file.
-    // Do this whether or not the build succeeded.
     SmallVector<const Job *, 16> Dependents;
-    if (getIncrementalBuildEnabled()) {
-      const CommandOutput &Output = FinishedCmd->getOutput();
-      StringRef DependenciesFile =
-        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-
-      if (DependenciesFile.empty()) {
-        // If this job doesn't track dependencies, it must always be run.
-        // Note: In theory CheckDependencies makes sense as well (for a leaf
-        // node in the dependency graph), and maybe even NewlyAdded (for very
-        // coarse dependencies that always affect downstream nodes), but we're
-        // not using either of those right now, and this logic should probably
-        // be revisited when we are.
-        assert(FinishedCmd->getCondition() == Job::Condition::Always);
-      } else {
-        // If we have a dependency file /and/ the frontend task exited normally,
-        // we can be discerning about what downstream files to rebuild.
-        if (ReturnCode == EXIT_SUCCESS || ReturnCode == EXIT_FAILURE) {
-          bool wasCascading = DepGraph.isMarked(FinishedCmd);
-
-          switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
-          case DependencyGraphImpl::LoadResult::HadError:
-            if (ReturnCode == EXIT_SUCCESS) {
-              disableIncrementalBuild();
-              for (const Job *Cmd : DeferredCommands)
-                scheduleCommandIfNecessaryAndPossible(Cmd);
-              DeferredCommands.clear();
-              Dependents.clear();
-            } // else, let the next build handle it.
-            break;
-          case DependencyGraphImpl::LoadResult::UpToDate:
-            if (!wasCascading)
-              break;
-            SWIFT_FALLTHROUGH;
-          case DependencyGraphImpl::LoadResult::AffectsDownstream:
-            DepGraph.markTransitive(Dependents, FinishedCmd);
-            break;
-          }
-        } else {
-          // If there's an abnormal exit (a crash), assume the worst.
-          switch (FinishedCmd->getCondition()) {
-          case Job::Condition::NewlyAdded:
-            // The job won't be treated as newly added next time. Conservatively
-            // mark it as affecting other jobs, because some of them may have
-            // completed already.
-            DepGraph.markTransitive(Dependents, FinishedCmd);
-            break;
-          case Job::Condition::Always:
-            // Any incremental task that shows up here has already been marked;
-            // we didn't need to wait for it to finish to start downstream
-            // tasks.
-            assert(DepGraph.isMarked(FinishedCmd));
-            break;
-          case Job::Condition::RunWithoutCascading:
-            // If this file changed, it might have been a non-cascading change
-            // and it might not. Unfortunately, the interface hash has been
-            // updated or compromised, so we don't actually know anymore; we
-            // have to conservatively assume the changes could affect other
-            // files.
-            DepGraph.markTransitive(Dependents, FinishedCmd);
-            break;
-          case Job::Condition::CheckDependencies:
-            // If the only reason we're running this is because something else
-            // changed, then we can trust the dependency graph as to whether
-            // it's a cascading or non-cascading change. That is, if whatever
-            // /caused/ the error isn't supposed to affect other files, and
-            // whatever /fixes/ the error isn't supposed to affect other files,
-            // then there's no need to recompile any other inputs. If either of
-            // those are false, we /do/ need to recompile other inputs.
-            break;
-          }
-        }
-      }
-    }
+    for (const Job *Cmd : getCombinedJobs(FinishedCmd))
+      reloadDependencies(Cmd, ReturnCode, Dependents);
 
     if (ReturnCode != EXIT_SUCCESS) {
       // The task failed, so return true without performing any further
@@ -589,14 +944,29 @@ int Compilation::performJobsImpl() {
                        ReturnCode);
       }
 
-      return ContinueBuildingAfterErrors ?
-          TaskFinishedResponse::ContinueExecution :
-          TaskFinishedResponse::StopExecution;
+      if (ContinueBuildingAfterErrors)
+        return TaskFinishedResponse::ContinueExecution;
+      if (CancelOnError)
+        return cancelOnError();
+      return TaskFinishedResponse::StopExecution;
+    }
+
+    // Record how long the job took, to schedule it next time.
+    auto StartTime = StartTimes.find(FinishedCmd);
+    if (StartTime != StartTimes.end()) {
+      llvm::sys::TimeValue Elapsed =
+          llvm::sys::TimeValue::now() - StartTime->second;
+      ArrayRef<const Job *> Combined = getCombinedJobs(FinishedCmd);
+      for (const Job *Cmd : Combined)
+        State.Durations[Cmd] =
+            (Elapsed.seconds() + Elapsed.nanoseconds() / 1e9) /
+            Combined.size();
     }
 
     // When a task finishes, we need to reevaluate the other commands that
     // might have been blocked.
-    markFinished(FinishedCmd);
+    for (const Job *Cmd : getCombinedJobs(FinishedCmd))
+      markFinished(Cmd);
 
     for (const Job *Cmd : Dependents) {
       DeferredCommands.erase(Cmd);
@@ -604,6 +974,7 @@ int Compilation::performJobsImpl() {
       scheduleCommandIfNecessaryAndPossible(Cmd);
     }
 
+    flushPendingCommands();
     return TaskFinishedResponse::ContinueExecution;
   };
 
@@ -614,6 +985,8 @@ int Compilation::performJobsImpl() {
     if (ShowDriverTimeCompilation) {
       DriverTimers[SignalledCmd]->stopTimer();
     }
+    traceJobEnded(SignalledCmd, Pid);
+    Output = takeFinalOutput(SignalledCmd, Pid, Output);
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
@@ -626,6 +999,14 @@ int Compilation::performJobsImpl() {
         llvm::errs() << Output;
     }
 
+    if (CancelledJobs) {
+      // The task was most likely terminated because another task failed,
+      // which was already diagnosed.
+      if (Result == EXIT_SUCCESS)
+        Result = EXIT_FAILURE;
+      return TaskFinishedResponse::StopExecution;
+    }
+
     if (!ErrorMsg.empty())
       Diags.diagnose(SourceLoc(), diag::error_unable_to_execute_command,
                      ErrorMsg);
@@ -640,8 +1021,13 @@ int Compilation::performJobsImpl() {
   };
 
   do {
+    flushPendingCommands();
+
     // Ask the TaskQueue to execute.
-    TQ->execute(taskBegan, taskFinished, taskSignalled);
+    if (StreamJobOutput || CancelOnError)
+      TQ->execute(taskBegan, taskFinished, taskSignalled, taskOutput);
+    else
+      TQ->execute(taskBegan, taskFinished, taskSignalled);
 
     // Mark all remaining deferred commands as skipped.
     for (const Job *Cmd : DeferredCommands) {
@@ -656,7 +1042,8 @@ int Compilation::performJobsImpl() {
     }
 
     // ...which may allow us to go on and do later tasks.
-  } while (Result == 0 && TQ->hasRemainingTasks());
+  } while (Result == 0 &&
+           (TQ->hasRemainingTasks() || !PendingCommands.empty()));
 
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
@@ -691,6 +1078,14 @@ int Compilation::performJobsImpl() {
                            InputInfo);
   }
 
+  if (auto *Stats = UnifiedStatsReporter::get()) {
+    Stats->setCounter("Driver.NumDriverJobs", getJobs().size());
+    Stats->setCounter("Driver.NumDriverJobsRun",
+                      State.FinishedCommands.size());
+    Stats->setCounter("Driver.NumDriverJobsSkipped",
+                      getJobs().size() - State.ScheduledCommands.size());
+  }
+
   if (Result == 0)
     Result = Diags.hadAnyError();
   return Result;
@@ -762,9 +1157,28 @@ int Compilation::performJobs() {
     if (!writeAllSourcesFile(Diags, AllSourceFilesPath, getInputFiles()))
       return EXIT_FAILURE;
 
+  // The statistics of the driver are written when StatsReporter goes away,
+  // after all jobs are done.
+  std::unique_ptr<UnifiedStatsReporter> StatsReporter;
+  if (const Arg *A = getArgs().getLastArg(options::OPT_stats_output_dir)) {
+    StatsReporter.reset(new UnifiedStatsReporter(
+        "swift-driver", getArgs().getLastArgValue(options::OPT_module_name),
+        A->getValue()));
+  }
+
+  // Likewise the trace, which also gets the events the frontend jobs wrote
+  // to the ".parts" directory next to it.
+  std::unique_ptr<TraceEventRecorder> TraceRecorder;
+  const Arg *TraceArg = getArgs().getLastArg(options::OPT_trace_events_output);
+  if (TraceArg) {
+    TraceRecorder.reset(new TraceEventRecorder(
+        TraceArg->getValue(), "swift-driver", /*IsFragment=*/false));
+  }
+
   // If we don't have to do any cleanup work, just exec the subprocess.
   if (Level < OutputLevel::Parseable &&
       !ShowDriverTimeCompilation &&
+      !StatsReporter && !TraceRecorder &&
       (SaveTemps || TempFilePaths.empty()) &&
       CompilationRecordPath.empty() &&
       Jobs.size() == 1) {
@@ -777,6 +1191,9 @@ int Compilation::performJobs() {
   
   int result = performJobsImpl();
 
+  if (TraceRecorder)
+    TraceRecorder->addFragments(std::string(TraceArg->getValue()) + ".parts");
+
   if (!SaveTemps) {
     // FIXME: Do we want to be deleting temporaries even when a child process
     // crashes?
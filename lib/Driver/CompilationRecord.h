@@ -34,6 +34,9 @@ enum class TopLevelKey {
   /// The key for the list of inputs to the compilation that produced the
   /// compilation record.
   Inputs,
+  /// The key for the map from inputs to the time it took to compile them in
+  /// the build that produced the compilation record, in milliseconds.
+  JobDurations,
 };
 
 /// \returns A string representation of the given key.
@@ -43,6 +46,7 @@ inline static StringRef getName(TopLevelKey Key) {
   case TopLevelKey::Options: return "options";
   case TopLevelKey::BuildTime: return "build_time";
   case TopLevelKey::Inputs: return "inputs";
+  case TopLevelKey::JobDurations: return "job_durations";
   }
 }
 
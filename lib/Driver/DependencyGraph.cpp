@@ -48,12 +48,15 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using DeclHashCallbackTy = void(StringRef, DependencyKind, StringRef);
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<DeclHashCallbackTy> declHashCallback,
+                    llvm::function_ref<void(StringRef)> typeLayoutHashCallback) {
   namespace yaml = llvm::yaml;
 
   // FIXME: Switch to a format other than YAML.
@@ -105,6 +108,53 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
+    } else if (keyString == "type-layout-hash") {
+      auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+      if (!value)
+        return LoadResult::HadError;
+      typeLayoutHashCallback(value->getValue(scratch));
+
+    } else if (keyString == "top-level-hashes" ||
+               keyString == "nominal-hashes" ||
+               keyString == "member-hashes") {
+      DependencyKind kind = llvm::StringSwitch<DependencyKind>(keyString)
+        .Case("top-level-hashes", DependencyKind::TopLevelName)
+        .Case("nominal-hashes", DependencyKind::NominalType)
+        .Case("member-hashes", DependencyKind::NominalTypeMember);
+
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      // Each entry is the name of a "provides" entry, in the same form as in
+      // the corresponding "provides" section, followed by its hash:
+      // ["name", "hash"] or ["{MangledBaseName}", "memberName", "hash"].
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        SmallVector<yaml::ScalarNode *, 3> parts;
+        for (yaml::Node &rawPart : *entry) {
+          auto *part = dyn_cast<yaml::ScalarNode>(&rawPart);
+          if (!part)
+            return LoadResult::HadError;
+          parts.push_back(part);
+        }
+        size_t expectedParts =
+            (kind == DependencyKind::NominalTypeMember) ? 3 : 2;
+        if (parts.size() != expectedParts)
+          return LoadResult::HadError;
+
+        SmallString<64> name;
+        name += parts[0]->getValue(scratch);
+        if (kind == DependencyKind::NominalTypeMember) {
+          name.push_back('\0');
+          name += parts[1]->getValue(scratch);
+        }
+        declHashCallback(name.str(), kind, parts.back()->getValue(scratch));
+      }
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -219,10 +269,29 @@ DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
   return loadFromBuffer(node, *buffer);
 }
 
+/// Builds the key under which the hash of the "provides" entry \p name is
+/// stored for the given \p kind.
+static std::string getDeclHashKey(StringRef name, DependencyKind kind) {
+  std::string key;
+  key.reserve(name.size() + 1);
+  key.push_back(static_cast<char>(kind));
+  key += name;
+  return key;
+}
+
 LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
 
+  // Keep the hashes from the last load around so we can tell which of the
+  // provided names changed.
+  llvm::StringMap<std::string> oldDeclHashes;
+  std::swap(oldDeclHashes, DeclHashes[node]);
+  std::string oldTypeLayoutHash;
+  std::swap(oldTypeLayoutHash, TypeLayoutHashes[node]);
+  llvm::StringSet<> seenProvides;
+  bool interfaceHashChanged = false;
+
   auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
                                       bool isCascading) -> LoadResult {
     if (kind == DependencyKind::ExternalFile)
@@ -251,9 +320,10 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
   };
 
   auto providesCallback =
-      [this, node, &provides](StringRef name, DependencyKind kind,
-                              bool isCascading) -> LoadResult {
+      [&provides, &seenProvides](StringRef name, DependencyKind kind,
+                                 bool isCascading) -> LoadResult {
     assert(isCascading);
+    seenProvides.insert(getDeclHashKey(name, kind));
     auto iter = std::find_if(provides.begin(), provides.end(),
                              [name](const ProvidesEntryTy &entry) -> bool {
       return name == entry.name;
@@ -267,7 +337,8 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  auto interfaceHashCallback = [this, node](StringRef hash) -> LoadResult {
+  auto interfaceHashCallback = [this, node, &interfaceHashChanged](
+      StringRef hash) -> LoadResult {
     auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
 
     if (insertResult.second) {
@@ -279,14 +350,114 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     auto iter = insertResult.first;
     if (hash != iter->second) {
       iter->second = hash;
-      return LoadResult::AffectsDownstream;
+      // Whether this affects downstream nodes is decided once the whole file
+      // has been read, since it depends on the per-declaration hashes.
+      interfaceHashChanged = true;
     }
 
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  auto &declHashes = DeclHashes[node];
+  auto declHashCallback = [&declHashes](StringRef name, DependencyKind kind,
+                                        StringRef hash) {
+    declHashes[getDeclHashKey(name, kind)] = hash;
+  };
+
+  auto &typeLayoutHash = TypeLayoutHashes[node];
+  auto typeLayoutHashCallback = [&typeLayoutHash](StringRef hash) {
+    typeLayoutHash = hash;
+  };
+
+  LoadResult result =
+      parseDependencyFile(buffer, providesCallback, dependsCallback,
+                          interfaceHashCallback, declHashCallback,
+                          typeLayoutHashCallback);
+  ChangedProvides.erase(node);
+  if (result == LoadResult::HadError || !interfaceHashChanged)
+    return result;
+
+  // Without hashes from both this load and the last one, all we know is that
+  // something in the interface changed. The same goes for a node that
+  // cascades from one of its dependencies, since that can change inferred
+  // types without changing any tokens in this file.
+  if (oldDeclHashes.empty() || declHashes.empty() ||
+      result == LoadResult::AffectsDownstream)
+    return LoadResult::AffectsDownstream;
+
+  // A declaration's hash only covers its own tokens, not those of the types
+  // it mentions. If a type declared in this file changed, such as the
+  // underlying type of a typealias or the stored properties of a struct,
+  // declarations using it may have changed too.
+  if (oldTypeLayoutHash.empty() || typeLayoutHash.empty() ||
+      oldTypeLayoutHash != typeLayoutHash)
+    return LoadResult::AffectsDownstream;
+
+  // Otherwise, work out which provided names actually changed. A name counts
+  // as changed if it was added or removed, if its hash differs, or if it has
+  // no hash at all (such as a dynamic-lookup name). Names that are no longer
+  // provided are dropped from the node once they've been recorded.
+  std::vector<ProvidesEntryTy> changed;
+  for (auto &entry : provides) {
+    DependencyMaskTy changedKinds;
+    DependencyMaskTy remainingKinds;
+    for (auto kind : { DependencyKind::TopLevelName,
+                       DependencyKind::DynamicLookupName,
+                       DependencyKind::NominalType,
+                       DependencyKind::NominalTypeMember }) {
+      if (!entry.kindMask.contains(kind))
+        continue;
+      std::string key = getDeclHashKey(entry.name, kind);
+      if (seenProvides.count(key))
+        remainingKinds |= kind;
+
+      auto newHash = declHashes.find(key);
+      auto oldHash = oldDeclHashes.find(key);
+      if (newHash == declHashes.end() || oldHash == oldDeclHashes.end() ||
+          newHash->getValue() != oldHash->getValue()) {
+        changedKinds |= kind;
+      }
+    }
+    if (changedKinds)
+      changed.push_back({entry.name, changedKinds});
+    entry.kindMask = remainingKinds;
+  }
+  provides.erase(std::remove_if(provides.begin(), provides.end(),
+                                [](const ProvidesEntryTy &entry) {
+                                  return !entry.kindMask;
+                                }),
+                 provides.end());
+
+  if (changed.empty())
+    return result;
+  ChangedProvides[node] = std::move(changed);
+  return LoadResult::AffectsDownstream;
+}
+
+bool DependencyGraphImpl::hasDeclHashes(const void *node) const {
+  auto iter = DeclHashes.find(node);
+  return iter != DeclHashes.end() && !iter->second.empty();
+}
+
+void DependencyGraphImpl::getDirectDependents(
+    SmallVectorImpl<const void *> &dependents, const void *node) const {
+  auto allProvided = Provides.find(node);
+  if (allProvided == Provides.end())
+    return;
+
+  SmallPtrSet<const void *, 16> seen;
+  seen.insert(node);
+  for (const auto &provided : allProvided->second) {
+    auto allDependents = Dependencies.find(provided.name);
+    if (allDependents == Dependencies.end())
+      continue;
+    for (const auto &dependent : allDependents->second.first) {
+      if (!(provided.kindMask & dependent.kindMask))
+        continue;
+      if (seen.insert(dependent.node).second)
+        dependents.push_back(dependent.node);
+    }
+  }
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -301,6 +472,8 @@ void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
     if (isMarked(dependent.node))
       continue;
     assert(dependent.flags & DependencyFlags::IsCascading);
+    // An external change can affect anything the node provides.
+    ChangedProvides.erase(dependent.node);
     visited.push_back(dependent.node);
     markTransitive(visited, dependent.node);
   }
@@ -321,13 +494,10 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
-  auto addDependentsToWorklist = [&](const void *next,
+  auto addDependentsToWorklist = [&](ArrayRef<ProvidesEntryTy> allProvided,
+                                     const void *next,
                                      ArrayRef<MarkTracerImpl::Entry> reason) {
-    auto allProvided = Provides.find(next);
-    if (allProvided == Provides.end())
-      return;
-
-    for (const auto &provided : allProvided->second) {
+    for (const auto &provided : allProvided) {
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -372,9 +542,24 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
     }
   };
 
-  // Always mark through the starting node, even if it's already marked.
+  auto addAllDependentsToWorklist = [&](const void *next,
+                                        ArrayRef<MarkTracerImpl::Entry> reason) {
+    auto allProvided = Provides.find(next);
+    if (allProvided == Provides.end())
+      return;
+    addDependentsToWorklist(allProvided->second, next, reason);
+  };
+
+  // Always mark through the starting node, even if it's already marked. If
+  // the last load worked out which of its provided names changed, only those
+  // need to be followed.
   markIntransitive(node);
-  addDependentsToWorklist(node, {});
+  auto changed = ChangedProvides.find(node);
+  if (changed != ChangedProvides.end()) {
+    addDependentsToWorklist(changed->second, node, {});
+  } else {
+    addAllDependentsToWorklist(node, {});
+  }
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -386,7 +571,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addAllDependentsToWorklist(next.Node, next.Reason);
     if (!markIntransitive(next.Node))
       continue;
     record(next);
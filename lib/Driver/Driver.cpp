@@ -158,6 +158,15 @@ static void validateArgs(DiagnosticEngine &diags, const ArgList &Args) {
     diags.diagnose(SourceLoc(), diag::error_conflicting_options,
                    "-warnings-as-errors", "-suppress-warnings");
   }
+
+  // Clang needs the start time of the build session to know which modules
+  // were already validated in it.
+  if (Args.hasArg(options::OPT_validate_clang_modules_once) &&
+      !Args.hasArg(options::OPT_clang_build_session_file)) {
+    diags.diagnose(SourceLoc(), diag::error_option_requires_option,
+                   "-validate-clang-modules-once",
+                   "-clang-build-session-file");
+  }
 }
 
 static void computeArgsHash(SmallString<32> &out, const DerivedArgList &args) {
@@ -218,6 +227,7 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
   SmallString<64> scratch;
 
   llvm::StringMap<InputInfo> previousInputs;
+  llvm::StringMap<double> previousDurations;
   bool versionValid = false;
   bool optionsMatch = true;
 
@@ -322,6 +332,27 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr ==
+               compilation_record::getName(TopLevelKey::JobDurations)) {
+      auto *durationMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!durationMap)
+        return true;
+
+      // The durations only guide scheduling, so a malformed entry is
+      // ignored rather than invalidating the record.
+      for (auto i = durationMap->begin(), e = durationMap->end(); i != e;
+           ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!key || !value)
+          continue;
+
+        unsigned long long milliseconds;
+        if (value->getValue(scratch).getAsInteger(10, milliseconds))
+          continue;
+        previousDurations[key->getValue(scratch)] = milliseconds / 1000.0;
+      }
     }
   }
 
@@ -337,6 +368,8 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
     }
     ++numInputsFromPrevious;
     map[inputPair.second] = iter->getValue();
+    map[inputPair.second].previousDuration =
+        previousDurations.lookup(inputPair.second->getValue());
   }
 
   // If a file was removed, we've lost its dependency info. Rebuild everything.
@@ -526,6 +559,23 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  if (C->getArgs().hasArg(options::OPT_stream_job_output))
+    C->setStreamJobOutput();
+  if (C->getArgs().hasArg(options::OPT_cancel_on_first_error))
+    C->setCancelOnFirstError();
+
+  // Batching only makes sense when each primary file gets its own frontend
+  // job to begin with.
+  if (C->getArgs().hasFlag(options::OPT_enable_batch_mode,
+                           options::OPT_disable_batch_mode, false) &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      !OI.isMultiThreading())
+    C->enableBatchMode(*TC, OI);
+
+  if (const Arg *A =
+          C->getArgs().getLastArg(options::OPT_frontend_server_socket))
+    C->setFrontendServerSocket(A->getValue());
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -1144,6 +1194,21 @@ void Driver::buildActions(const ToolChain &TC,
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
+    // Precompile the bridging header once, so that each compile job imports
+    // the precompiled header and its Swift lookup table instead of parsing the
+    // header again.
+    JobAction *PCH = nullptr;
+    if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+        Args.hasFlag(options::OPT_enable_bridging_pch,
+                     options::OPT_disable_bridging_pch, false)) {
+      if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+        StringRef Ext = llvm::sys::path::extension(A->getValue());
+        if (TC.lookupTypeForExtension(Ext) == types::TY_ObjCHeader)
+          PCH = new GeneratePCHJobAction(
+              new InputAction(*A, types::TY_ObjCHeader));
+      }
+    }
+
     for (const InputPair &Input : Inputs) {
       types::ID InputType = Input.first;
       const Arg *InputArg = Input.second;
@@ -1166,6 +1231,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1173,6 +1240,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1205,6 +1274,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -21,17 +21,25 @@ using namespace swift;
 using namespace swift::driver;
 
 void CommandOutput::setAdditionalOutputForType(types::ID type,
-                                               StringRef OutputFilename) {
-  AdditionalOutputsMap[type] = OutputFilename;
+                                               StringRef OutputFilename,
+                                               unsigned Index) {
+  if (AdditionalOutputsMaps.size() <= Index)
+    AdditionalOutputsMaps.resize(Index + 1);
+  AdditionalOutputsMaps[Index][type] = OutputFilename;
 }
 
 const std::string &
-CommandOutput::getAdditionalOutputForType(types::ID type) const {
+CommandOutput::getAdditionalOutputForType(types::ID type,
+                                          unsigned Index) const {
+  static const std::string empty;
+  if (Index >= AdditionalOutputsMaps.size())
+    return empty;
+
+  auto &AdditionalOutputsMap = AdditionalOutputsMaps[Index];
   auto iter = AdditionalOutputsMap.find(type);
   if (iter != AdditionalOutputsMap.end())
     return iter->second;
 
-  static const std::string empty;
   return empty;
 }
 
@@ -106,3 +114,15 @@ void Job::printCommandLine(raw_ostream &os, StringRef Terminator) const {
   printArguments(os, Arguments);
   os << Terminator;
 }
+
+BatchJob::BatchJob(const JobAction &Source,
+                   std::unique_ptr<CommandOutput> Output,
+                   const char *Executable,
+                   llvm::opt::ArgStringList Arguments,
+                   EnvironmentVector ExtraEnvironment,
+                   FilelistInfo Info,
+                   ArrayRef<const Job *> Combined)
+    : Job(Kind::Batch, Source, SmallVector<const Job *, 1>(),
+          std::move(Output), Executable, std::move(Arguments),
+          std::move(ExtraEnvironment), std::move(Info)),
+      CombinedJobs(Combined.begin(), Combined.end()) {}
@@ -108,9 +108,17 @@ public:
     Cmd.printCommandLine(wrapper, "");
     wrapper.flush();
 
-    for (const Action *A : Cmd.getSource().getInputs()) {
-      if (const InputAction *IA = dyn_cast<InputAction>(A))
-        Inputs.push_back(CommandInput(IA->getInputArg().getValue()));
+    // A batch job runs the combined jobs' actions, not just the one it was
+    // created from.
+    const Job *Self = &Cmd;
+    ArrayRef<const Job *> CombinedJobs = Self;
+    if (const auto *Batch = dyn_cast<BatchJob>(&Cmd))
+      CombinedJobs = Batch->getCombinedJobs();
+    for (const Job *J : CombinedJobs) {
+      for (const Action *A : J->getSource().getInputs()) {
+        if (const InputAction *IA = dyn_cast<InputAction>(A))
+          Inputs.push_back(CommandInput(IA->getInputArg().getValue()));
+      }
     }
 
     for (const Job *J : Cmd.getInputs()) {
@@ -132,12 +140,15 @@ public:
         Outputs.push_back(OutputPair(PrimaryOutputType, OutputFileName));
       }
     }
-    types::forAllTypes([&](types::ID Ty) {
-      const std::string &Output =
-          Cmd.getOutput().getAdditionalOutputForType(Ty);
-      if (!Output.empty())
-        Outputs.push_back(OutputPair(Ty, Output));
-    });
+    const CommandOutput &CmdOutput = Cmd.getOutput();
+    for (unsigned i = 0, e = CmdOutput.getNumAdditionalOutputSets(); i != e;
+         ++i) {
+      types::forAllTypes([&](types::ID Ty) {
+        const std::string &Output = CmdOutput.getAdditionalOutputForType(Ty, i);
+        if (!Output.empty())
+          Outputs.push_back(OutputPair(Ty, Output));
+      });
+    }
   }
 
   virtual void provideMapping(swift::json::Output &out) {
@@ -185,6 +196,12 @@ public:
   }
 };
 
+class OutputMessage : public TaskOutputMessage {
+public:
+  OutputMessage(const Job &Cmd, ProcessId Pid, StringRef Output) :
+      TaskOutputMessage("output", Cmd, Pid, Output) {}
+};
+
 class FinishedMessage : public TaskOutputMessage {
   int ExitStatus;
 public:
@@ -250,6 +267,13 @@ void parseable_output::emitBeganMessage(raw_ostream &os,
   emitMessage(os, msg);
 }
 
+void parseable_output::emitOutputMessage(raw_ostream &os,
+                                         const Job &Cmd, ProcessId Pid,
+                                         StringRef Output) {
+  OutputMessage msg(Cmd, Pid, Output);
+  emitMessage(os, msg);
+}
+
 void parseable_output::emitFinishedMessage(raw_ostream &os,
                                            const Job &Cmd, ProcessId Pid,
                                            int ExitStatus, StringRef Output) {
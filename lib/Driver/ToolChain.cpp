@@ -18,6 +18,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Driver/ToolChain.h"
+#include "swift/Driver/Action.h"
 #include "swift/Driver/Compilation.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
@@ -85,6 +86,7 @@ ToolChain::constructJob(const JobAction &JA,
     CASE(ModuleWrapJob)
     CASE(LinkJob)
     CASE(GenerateDSYMJob)
+    CASE(GeneratePCHJob)
     CASE(AutolinkExtractJob)
     CASE(REPLJob)
 #undef CASE
@@ -93,27 +95,7 @@ ToolChain::constructJob(const JobAction &JA,
     }
   }();
 
-  // Special-case the Swift frontend.
-  const char *executablePath = nullptr;
-  if (StringRef(SWIFT_EXECUTABLE_NAME) == invocationInfo.ExecutableName) {
-    executablePath = getDriver().getSwiftProgramPath().c_str();
-  } else {
-    std::string relativePath =
-        findProgramRelativeToSwift(invocationInfo.ExecutableName);
-    if (!relativePath.empty()) {
-      executablePath = C.getArgs().MakeArgString(relativePath);
-    } else {
-      auto systemPath =
-          llvm::sys::findProgramByName(invocationInfo.ExecutableName);
-      if (systemPath) {
-        executablePath = C.getArgs().MakeArgString(systemPath.get());
-      } else {
-        // For debugging purposes.
-        executablePath = invocationInfo.ExecutableName;
-      }
-    }
-  }
-
+  const char *executablePath = getExecutablePath(C, invocationInfo);
   return llvm::make_unique<Job>(JA, std::move(inputs), std::move(output),
                                 executablePath,
                                 std::move(invocationInfo.Arguments),
@@ -121,6 +103,85 @@ ToolChain::constructJob(const JobAction &JA,
                                 std::move(invocationInfo.FilelistInfo));
 }
 
+/// Returns the index of the command-line argument naming the primary input of
+/// the compile job \p job.
+static unsigned getPrimaryInputArgIndex(const Job *job) {
+  return cast<InputAction>(*job->getSource().begin())->getInputArg().getIndex();
+}
+
+std::unique_ptr<BatchJob>
+ToolChain::constructBatchJob(ArrayRef<const Job *> unsortedJobs,
+                             Compilation &C, const OutputInfo &OI) const {
+  assert(unsortedJobs.size() > 1 && "a batch needs more than one job");
+  assert(OI.CompilerMode == OutputInfo::Mode::StandardCompile);
+
+  // The frontend matches outputs up with primary files in the order the
+  // primary files appear on its command line, which is the order of the
+  // driver's inputs.
+  SmallVector<const Job *, 8> jobs(unsortedJobs.begin(), unsortedJobs.end());
+  std::sort(jobs.begin(), jobs.end(), [](const Job *lhs, const Job *rhs) {
+    return getPrimaryInputArgIndex(lhs) < getPrimaryInputArgIndex(rhs);
+  });
+
+  // Gather the primary inputs of all the jobs, and their outputs in the same
+  // order.
+  const Job *firstJob = jobs.front();
+  auto output = llvm::make_unique<CommandOutput>(
+      firstJob->getOutput().getPrimaryOutputType());
+  ActionList inputActions;
+  for (unsigned i = 0, e = jobs.size(); i != e; ++i) {
+    const Job *job = jobs[i];
+    assert(isa<CompileJobAction>(job->getSource()));
+    assert(job->getInputs() == firstJob->getInputs() &&
+           job->getSource().size() == job->getInputs().size() + 1);
+
+    const CommandOutput &jobOutput = job->getOutput();
+    assert(jobOutput.getPrimaryOutputFilenames().size() == 1);
+    output->addPrimaryOutput(jobOutput.getPrimaryOutputFilename(),
+                             jobOutput.getBaseInput(0));
+    types::forAllTypes([&](types::ID type) {
+      const std::string &additional =
+          jobOutput.getAdditionalOutputForType(type);
+      if (!additional.empty())
+        output->setAdditionalOutputForType(type, additional, i);
+    });
+    inputActions.push_back(*job->getSource().begin());
+  }
+
+  // The combined jobs share the precompiled bridging header, if any.
+  JobContext context{C, firstJob->getInputs(), inputActions, *output, OI};
+  InvocationInfo invocationInfo =
+      constructInvocation(cast<CompileJobAction>(firstJob->getSource()),
+                          context);
+  const char *executablePath = getExecutablePath(C, invocationInfo);
+  return llvm::make_unique<BatchJob>(firstJob->getSource(), std::move(output),
+                                     executablePath,
+                                     std::move(invocationInfo.Arguments),
+                                     std::move(invocationInfo.ExtraEnvironment),
+                                     std::move(invocationInfo.FilelistInfo),
+                                     jobs);
+}
+
+const char *
+ToolChain::getExecutablePath(Compilation &C,
+                             const InvocationInfo &invocationInfo) const {
+  // Special-case the Swift frontend.
+  if (StringRef(SWIFT_EXECUTABLE_NAME) == invocationInfo.ExecutableName)
+    return getDriver().getSwiftProgramPath().c_str();
+
+  std::string relativePath =
+      findProgramRelativeToSwift(invocationInfo.ExecutableName);
+  if (!relativePath.empty())
+    return C.getArgs().MakeArgString(relativePath);
+
+  auto systemPath = llvm::sys::findProgramByName(invocationInfo.ExecutableName);
+  if (systemPath)
+    return C.getArgs().MakeArgString(systemPath.get());
+
+  // For debugging purposes.
+  return invocationInfo.ExecutableName;
+}
+
 std::string
 ToolChain::findProgramRelativeToSwift(StringRef executableName) const {
   auto insertionResult =
@@ -25,6 +25,7 @@
 #include "swift/Config.h"
 #include "clang/Basic/Version.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -76,6 +77,23 @@ static void addPrimaryInputsOfType(ArgStringList &Arguments,
   }
 }
 
+/// Passes \p option followed by each output of the given \p type, one for
+/// every set of additional outputs in \p output.
+///
+/// A batch of compile jobs has one set per primary input, and the frontend
+/// matches them up with the primary inputs in order.
+static void addAdditionalOutputsOfType(ArgStringList &arguments,
+                                       const CommandOutput &output,
+                                       types::ID type, const char *option) {
+  for (unsigned i = 0, e = output.getNumAdditionalOutputSets(); i != e; ++i) {
+    const std::string &path = output.getAdditionalOutputForType(type, i);
+    if (path.empty())
+      continue;
+    arguments.push_back(option);
+    arguments.push_back(path.c_str());
+  }
+}
+
 /// Handle arguments common to all invocations of the frontend (compilation,
 /// module-merging, LLDB's REPL, etc).
 static void addCommonFrontendArgs(const ToolChain &TC,
@@ -111,6 +129,11 @@ static void addCommonFrontendArgs(const ToolChain &TC,
 
   inputArgs.AddAllArgs(arguments, options::OPT_I);
   inputArgs.AddAllArgs(arguments, options::OPT_F);
+  // The search paths don't change while the driver runs the build, but they
+  // may during an interactive session.
+  if (OI.CompilerMode != OutputInfo::Mode::REPL &&
+      OI.CompilerMode != OutputInfo::Mode::Immediate)
+    arguments.push_back("-cache-search-path-contents");
 
   inputArgs.AddLastArg(arguments, options::OPT_AssertConfig);
   inputArgs.AddLastArg(arguments, options::OPT_autolink_force_load);
@@ -119,9 +142,20 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_enable_app_extension);
   inputArgs.AddLastArg(arguments, options::OPT_enable_testing);
   inputArgs.AddLastArg(arguments, options::OPT_g_Group);
-  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
   inputArgs.AddLastArg(arguments, options::OPT_import_underlying_module);
   inputArgs.AddLastArg(arguments, options::OPT_module_cache_path);
+  inputArgs.AddLastArg(arguments, options::OPT_validate_clang_modules_once);
+  inputArgs.AddLastArg(arguments, options::OPT_clang_build_session_file);
+  inputArgs.AddLastArg(arguments, options::OPT_object_cache_path);
+  inputArgs.AddLastArg(arguments, options::OPT_debug_compilation_dir);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
+  // The frontend jobs write their part of the trace next to the trace file,
+  // for the driver to merge once they're done.
+  if (const Arg *A = inputArgs.getLastArg(options::OPT_trace_events_output)) {
+    arguments.push_back("-trace-events-dir");
+    arguments.push_back(
+        inputArgs.MakeArgString(Twine(A->getValue()) + ".parts"));
+  }
   inputArgs.AddLastArg(arguments, options::OPT_module_link_name);
   inputArgs.AddLastArg(arguments, options::OPT_nostdimport);
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
@@ -130,6 +164,7 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_coverage_EQ);
@@ -145,17 +180,28 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddAllArgs(arguments, options::OPT_Xllvm);
   inputArgs.AddAllArgs(arguments, options::OPT_Xcc);
 
-  const std::string &moduleDocOutputPath =
-      output.getAdditionalOutputForType(types::TY_SwiftModuleDocFile);
-  if (!moduleDocOutputPath.empty()) {
-    arguments.push_back("-emit-module-doc-path");
-    arguments.push_back(moduleDocOutputPath.c_str());
-  }
+  addAdditionalOutputsOfType(arguments, output, types::TY_SwiftModuleDocFile,
+                             "-emit-module-doc-path");
 
   if (llvm::sys::Process::StandardErrHasColors())
     arguments.push_back("-color-diagnostics");
 }
 
+/// Passes on the bridging header, or the precompiled bridging header if one of
+/// \p inputJobs generates it.
+static void addBridgingHeaderArgs(const ArgList &inputArgs,
+                                  ArrayRef<const Job *> inputJobs,
+                                  ArgStringList &arguments) {
+  for (const Job *input : inputJobs) {
+    if (isa<GeneratePCHJobAction>(input->getSource())) {
+      arguments.push_back("-import-objc-header");
+      arguments.push_back(inputArgs.MakeArgString(
+          input->getOutput().getPrimaryOutputFilename()));
+      return;
+    }
+  }
+  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
+}
 
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const CompileJobAction &job,
@@ -216,6 +262,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -241,37 +288,43 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  for (const Job *input : context.Inputs) {
+    (void)input;
+    assert(isa<GeneratePCHJobAction>(input->getSource()) &&
+           "The Swift frontend only expects a precompiled header as input Job!");
+  }
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
-    assert(context.InputActions.size() == 1 &&
+    // Every input is a primary file. There is more than one only when several
+    // compile jobs have been combined into a batch.
+    assert((context.InputActions.size() == 1 ||
+            context.OI.CompilerMode == OutputInfo::Mode::StandardCompile) &&
            "The Swift frontend expects exactly one input (the primary file)!");
 
-    auto *IA = cast<InputAction>(context.InputActions[0]);
-    const Arg &PrimaryInputArg = IA->getInputArg();
-
     if (context.Args.hasArg(options::OPT_driver_use_filelists) ||
         context.getTopLevelInputFiles().size() > TOO_MANY_FILES) {
       Arguments.push_back("-filelist");
       Arguments.push_back(context.getAllSourcesPath());
-      Arguments.push_back("-primary-file");
-      PrimaryInputArg.render(context.Args, Arguments);
+      for (const Action *A : context.InputActions) {
+        Arguments.push_back("-primary-file");
+        cast<InputAction>(A)->getInputArg().render(context.Args, Arguments);
+      }
     } else {
-      bool FoundPrimaryInput = false;
+      llvm::SmallDenseSet<unsigned, 4> PrimaryInputIndices;
+      for (const Action *A : context.InputActions)
+        PrimaryInputIndices.insert(
+            cast<InputAction>(A)->getInputArg().getIndex());
+
       for (auto inputPair : context.getTopLevelInputFiles()) {
         if (!types::isPartOfSwiftCompilation(inputPair.first))
           continue;
 
         // See if this input should be passed with -primary-file.
-        if (!FoundPrimaryInput &&
-            PrimaryInputArg.getIndex() == inputPair.second->getIndex()) {
+        if (PrimaryInputIndices.erase(inputPair.second->getIndex()))
           Arguments.push_back("-primary-file");
-          FoundPrimaryInput = true;
-        }
         Arguments.push_back(inputPair.second->getValue());
       }
     }
@@ -300,6 +353,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Args, context.Inputs, Arguments);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -313,12 +367,8 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
 
-  const std::string &ModuleOutputPath =
-    context.Output.getAdditionalOutputForType(types::ID::TY_SwiftModuleFile);
-  if (!ModuleOutputPath.empty()) {
-    Arguments.push_back("-emit-module-path");
-    Arguments.push_back(ModuleOutputPath.c_str());
-  }
+  addAdditionalOutputsOfType(Arguments, context.Output,
+                             types::TY_SwiftModuleFile, "-emit-module-path");
 
   const std::string &ObjCHeaderOutputPath =
     context.Output.getAdditionalOutputForType(types::ID::TY_ObjCHeader);
@@ -338,19 +388,10 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     Arguments.push_back(SerializedDiagnosticsPath.c_str());
   }
 
-  const std::string &DependenciesPath =
-    context.Output.getAdditionalOutputForType(types::TY_Dependencies);
-  if (!DependenciesPath.empty()) {
-    Arguments.push_back("-emit-dependencies-path");
-    Arguments.push_back(DependenciesPath.c_str());
-  }
-
-  const std::string &ReferenceDependenciesPath =
-    context.Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-  if (!ReferenceDependenciesPath.empty()) {
-    Arguments.push_back("-emit-reference-dependencies-path");
-    Arguments.push_back(ReferenceDependenciesPath.c_str());
-  }
+  addAdditionalOutputsOfType(Arguments, context.Output,
+                             types::TY_Dependencies, "-emit-dependencies-path");
+  addAdditionalOutputsOfType(Arguments, context.Output, types::TY_SwiftDeps,
+                             "-emit-reference-dependencies-path");
 
   const std::string &FixitsPath =
     context.Output.getAdditionalOutputForType(types::TY_Remapping);
@@ -409,6 +450,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Args, {}, Arguments);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -473,6 +515,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -600,10 +643,18 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  // The merged module refers to the bridging header itself, so it never uses
+  // the precompiled header.
+  addBridgingHeaderArgs(context.Args, {}, Arguments);
 
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
 
+  // In an incremental build, clients of the module don't need to be rebuilt
+  // if its interface didn't change.
+  if (context.Args.hasArg(options::OPT_incremental))
+    Arguments.push_back("-preserve-timestamp-if-interface-unchanged");
+
   assert(context.Output.getPrimaryOutputType() == types::TY_SwiftModuleFile &&
          "The MergeModule tool only produces swiftmodule files!");
 
@@ -666,6 +717,7 @@ ToolChain::constructInvocation(const REPLJobAction &job,
   ArgStringList FrontendArgs;
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         FrontendArgs);
+  addBridgingHeaderArgs(context.Args, {}, FrontendArgs);
   context.Args.AddAllArgs(FrontendArgs, options::OPT_l, options::OPT_framework,
                           options::OPT_L);
 
@@ -710,6 +762,38 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return {"dsymutil", Arguments};
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+  Arguments.push_back("-emit-pch");
+
+  // The input is the -import-objc-header argument; pass on just the header.
+  Arguments.push_back(
+      cast<InputAction>(context.InputActions.front())->getInputArg()
+          .getValue());
+
+  // The precompiled header has to be built with the same Clang options as the
+  // frontend jobs which import it.
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+
+  Arguments.push_back("-module-name");
+  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
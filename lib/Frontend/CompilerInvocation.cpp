@@ -18,6 +18,7 @@
 #include "swift/Option/Options.h"
 #include "swift/Option/SanitizerOptions.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -98,10 +99,11 @@ static void debugFailWithCrash() {
 static bool readFileList(DiagnosticEngine &diags,
                          std::vector<std::string> &inputFiles,
                          const llvm::opt::Arg *filelistPath,
-                         const llvm::opt::Arg *primaryFileArg = nullptr,
-                         unsigned *primaryFileIndex = nullptr) {
-  assert((primaryFileArg == nullptr) || (primaryFileIndex != nullptr) &&
-         "did not provide argument for primary file index");
+                         ArrayRef<const llvm::opt::Arg *> primaryFileArgs = {},
+                         SmallVectorImpl<unsigned> *primaryFileIndices =
+                             nullptr) {
+  assert((primaryFileArgs.empty() || primaryFileIndices != nullptr) &&
+         "did not provide argument for primary file indices");
 
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
       llvm::MemoryBuffer::getFile(filelistPath->getValue());
@@ -111,24 +113,23 @@ static bool readFileList(DiagnosticEngine &diags,
     return false;
   }
 
-  bool foundPrimaryFile = false;
-  if (primaryFileIndex) *primaryFileIndex = 0;
-
+  // Remember where each file first appears, so that primary files can be
+  // found without rescanning the list for each of them.
+  llvm::StringMap<unsigned> indexForFile;
   for (StringRef line : make_range(llvm::line_iterator(*buffer.get()), {})) {
+    if (!primaryFileArgs.empty())
+      indexForFile.insert({line, inputFiles.size()});
     inputFiles.push_back(line);
-
-    if (foundPrimaryFile || primaryFileArg == nullptr)
-      continue;
-    if (line == primaryFileArg->getValue())
-      foundPrimaryFile = true;
-    else
-      ++*primaryFileIndex;
   }
 
-  if (primaryFileArg && !foundPrimaryFile) {
-    diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
-                   primaryFileArg->getValue(), filelistPath->getValue());
-    return false;
+  for (const llvm::opt::Arg *primaryFileArg : primaryFileArgs) {
+    auto found = indexForFile.find(primaryFileArg->getValue());
+    if (found == indexForFile.end()) {
+      diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
+                     primaryFileArg->getValue(), filelistPath->getValue());
+      return false;
+    }
+    primaryFileIndices->push_back(found->getValue());
   }
 
   return true;
@@ -167,11 +168,17 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.SkipNonInlinableFunctionBodies |=
+      Args.hasArg(OPT_experimental_skip_non_inlinable_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_trace_events_dir))
+    Opts.TraceEventsDir = A->getValue();
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
 
@@ -201,13 +208,22 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  // The first primary file is the PrimaryInput; any others make this a batch.
+  auto addPrimaryInput = [&](unsigned Index) {
+    if (!Opts.PrimaryInput)
+      Opts.PrimaryInput = SelectedInput(Index);
+    else
+      Opts.BatchPrimaries.push_back({Index, "", "", "", "", ""});
+  };
+
   if (const Arg *A = Args.getLastArg(OPT_filelist)) {
-    const Arg *primaryFileArg = Args.getLastArg(OPT_primary_file);
-    unsigned primaryFileIndex = 0;
+    SmallVector<const Arg *, 4> primaryFileArgs(
+        Args.filtered_begin(OPT_primary_file), Args.filtered_end());
+    SmallVector<unsigned, 4> primaryFileIndices;
     if (readFileList(Diags, Opts.InputFilenames, A,
-                     primaryFileArg, &primaryFileIndex)) {
-      if (primaryFileArg)
-        Opts.PrimaryInput = SelectedInput(primaryFileIndex);
+                     primaryFileArgs, &primaryFileIndices)) {
+      for (unsigned Index : primaryFileIndices)
+        addPrimaryInput(Index);
       assert(!Args.hasArg(OPT_INPUT) && "mixing -filelist with inputs");
     }
   } else {
@@ -217,7 +233,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       if (A->getOption().matches(OPT_INPUT)) {
         Opts.InputFilenames.push_back(A->getValue());
       } else if (A->getOption().matches(OPT_primary_file)) {
-        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+        addPrimaryInput(Opts.InputFilenames.size());
         Opts.InputFilenames.push_back(A->getValue());
       } else {
         llvm_unreachable("Unknown input-related argument!");
@@ -294,6 +310,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::REPL;
     } else if (Opt.matches(OPT_interpret)) {
       Action = FrontendOptions::Immediate;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else {
       llvm_unreachable("Unhandled mode option");
     }
@@ -397,6 +415,14 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     Opts.OutputFilenames = Args.getAllArgValues(OPT_o);
   }
 
+  // In a batch, there is one output file per primary file, in order.
+  if (!Opts.BatchPrimaries.empty() &&
+      Opts.OutputFilenames.size() == Opts.BatchPrimaries.size() + 1) {
+    for (unsigned i = 0, e = Opts.BatchPrimaries.size(); i != e; ++i)
+      Opts.BatchPrimaries[i].OutputFilename = Opts.OutputFilenames[i + 1];
+    Opts.OutputFilenames.resize(1);
+  }
+
   bool UserSpecifiedModuleName = false;
   {
     const Arg *A = Args.getLastArg(OPT_module_name);
@@ -517,6 +543,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitObject:
       Suffix = "o";
       break;
+
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
     }
 
     if (!Suffix.empty()) {
@@ -646,6 +676,36 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           SERIALIZED_MODULE_DOC_EXTENSION,
                           false);
 
+  // Likewise, a batch passes each of these options once per primary file. The
+  // first occurrence belongs to the first primary file.
+  auto distributeBatchOutputs = [&](std::string &output,
+                                    std::string FrontendOptions::BatchPrimary::*
+                                        batchOutput,
+                                    OptSpecifier optWithPath) {
+    if (Opts.BatchPrimaries.empty())
+      return;
+    std::vector<std::string> paths = Args.getAllArgValues(optWithPath);
+    if (paths.size() != Opts.BatchPrimaries.size() + 1)
+      return;
+    output = paths[0];
+    for (unsigned i = 0, e = Opts.BatchPrimaries.size(); i != e; ++i)
+      Opts.BatchPrimaries[i].*batchOutput = paths[i + 1];
+  };
+
+  using BatchPrimary = FrontendOptions::BatchPrimary;
+  distributeBatchOutputs(Opts.DependenciesFilePath,
+                         &BatchPrimary::DependenciesFilePath,
+                         OPT_emit_dependencies_path);
+  distributeBatchOutputs(Opts.ReferenceDependenciesFilePath,
+                         &BatchPrimary::ReferenceDependenciesFilePath,
+                         OPT_emit_reference_dependencies_path);
+  distributeBatchOutputs(Opts.ModuleOutputPath,
+                         &BatchPrimary::ModuleOutputPath,
+                         OPT_emit_module_path);
+  distributeBatchOutputs(Opts.ModuleDocOutputPath,
+                         &BatchPrimary::ModuleDocOutputPath,
+                         OPT_emit_module_doc_path);
+
   if (!Opts.DependenciesFilePath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
@@ -657,6 +717,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
       return true;
     case FrontendOptions::Parse:
@@ -684,6 +745,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
       return true;
     case FrontendOptions::Parse:
@@ -714,6 +776,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       if (!Opts.ModuleOutputPath.empty())
         Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_module);
       else
@@ -737,9 +800,13 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
 
   Opts.AlwaysSerializeDebuggingOptions |=
       Args.hasArg(OPT_serialize_debugging_options);
+  Opts.PreserveTimestampIfInterfaceUnchanged |=
+      Args.hasArg(OPT_preserve_timestamp_if_interface_unchanged);
   Opts.EnableSourceImport |= Args.hasArg(OPT_enable_source_import);
   Opts.ImportUnderlyingModule |= Args.hasArg(OPT_import_underlying_module);
   Opts.SILSerializeAll |= Args.hasArg(OPT_sil_serialize_all);
+  Opts.SILSerializeSmallFunctions |=
+      Args.hasArg(OPT_sil_serialize_small_functions);
 
   if (const Arg *A = Args.getLastArg(OPT_import_objc_header)) {
     Opts.ImplicitObjCHeaderPath = A->getValue();
@@ -811,6 +878,8 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.EnableASTScopeLookup |= Args.hasArg(OPT_enable_astscope_lookup);
+  Opts.NamedLazyMemberLoading |=
+      Args.hasArg(OPT_enable_named_lazy_member_loading);
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
@@ -850,6 +919,10 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     Opts.DebugForbidTypecheckPrefix = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_debug_expression_type_check_stats)) {
+    Opts.ExpressionTypeCheckStatsPath = A->getValue();
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_solver_memory_threshold)) {
     unsigned threshold;
     if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
@@ -913,9 +986,17 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
     Opts.ModuleCachePath = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_clang_build_session_file)) {
+    Opts.BuildSessionFilePath = A->getValue();
+    Opts.ValidateModulesOnce |= Args.hasArg(OPT_validate_clang_modules_once);
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_target_cpu))
     Opts.TargetCPU = A->getValue();
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header))
+    Opts.BridgingHeader = A->getValue();
+
   for (const Arg *A : make_range(Args.filtered_begin(OPT_Xcc),
                                  Args.filtered_end())) {
     Opts.ExtraArgs.push_back(A->getValue());
@@ -980,6 +1061,8 @@ static bool ParseSearchPathArgs(SearchPathOptions &Opts,
 
   Opts.SkipRuntimeLibraryImportPath |= Args.hasArg(OPT_nostdimport);
 
+  Opts.CacheSearchPathContents |= Args.hasArg(OPT_cache_search_path_contents);
+
   // Opts.RuntimeIncludePath is set by calls to
   // setRuntimeIncludePath() or setMainExecutablePath().
   // Opts.RuntimeImportPath is set by calls to
@@ -1069,6 +1152,15 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
     if (A->getOption().matches(OPT_Onone)) {
       IRGenOpts.Optimize = false;
       Opts.Optimization = SILOptions::SILOptMode::None;
+    } else if (A->getOption().matches(OPT_Odebug)) {
+      // Run a few cheap SIL optimizations, but don't optimize in LLVM.
+      IRGenOpts.Optimize = false;
+      Opts.Optimization = SILOptions::SILOptMode::Debug;
+    } else if (A->getOption().matches(OPT_Osize)) {
+      // Optimize, but prefer smaller code over faster code.
+      IRGenOpts.Optimize = true;
+      IRGenOpts.OptimizeForSize = true;
+      Opts.Optimization = SILOptions::SILOptMode::OptimizeForSize;
     } else if (A->getOption().matches(OPT_Ounchecked)) {
       // Turn on optimizations and remove all runtime checks.
       IRGenOpts.Optimize = true;
@@ -1128,8 +1220,13 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.UseProfile = A->getValue();
+  Opts.UsePrespecializations |= Args.hasArg(OPT_use_prespecializations);
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
+  Opts.EnableGuaranteedNormalArguments |=
+    Args.hasArg(OPT_enable_guaranteed_normal_arguments);
 
   if (Args.hasArg(OPT_debug_on_sil)) {
     // Derive the name of the SIL file for debugging from
@@ -1203,10 +1300,13 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
       CompilerInvocation::buildDWARFDebugFlags(Opts.DWARFDebugFlags,
                                                RenderedArgs, SDKPath,
                                                ResourceDir);
-      // TODO: Should we support -fdebug-compilation-dir?
-      llvm::SmallString<256> cwd;
-      llvm::sys::fs::current_path(cwd);
-      Opts.DebugCompilationDir = cwd.str();
+      if (const Arg *A = Args.getLastArg(OPT_debug_compilation_dir)) {
+        Opts.DebugCompilationDir = A->getValue();
+      } else {
+        llvm::SmallString<256> cwd;
+        llvm::sys::fs::current_path(cwd);
+        Opts.DebugCompilationDir = cwd.str();
+      }
     }
   }
 
@@ -1234,6 +1334,7 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.DisableLLVMOptzns |= Args.hasArg(OPT_disable_llvm_optzns);
   Opts.DisableLLVMARCOpts |= Args.hasArg(OPT_disable_llvm_arc_opts);
   Opts.DisableLLVMSLPVectorizer |= Args.hasArg(OPT_disable_llvm_slp_vectorizer);
+  Opts.FunctionSections |= Args.hasArg(OPT_function_sections);
   if (Args.hasArg(OPT_disable_llvm_verify))
     Opts.Verify = false;
 
@@ -1283,10 +1384,16 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
 
+  Opts.PrespecializeGenericMetadata =
+      Args.hasArg(OPT_prespecialize_generic_metadata);
+
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
     !Args.hasArg(OPT_disable_incremental_llvm_codegeneration);
 
+  if (const Arg *A = Args.getLastArg(OPT_object_cache_path))
+    Opts.ObjectCachePath = A->getValue();
+
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.EmbedMode = IRGenEmbedMode::EmbedBitcode;
   else if (Args.hasArg(OPT_embed_bitcode_marker))
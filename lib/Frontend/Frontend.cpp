@@ -52,6 +52,40 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+void CompilerInstance::notePossiblePrimarySourceFile(SourceFile *SF,
+                                                     unsigned BufferID) {
+  if (BufferID == PrimaryBufferID) {
+    setPrimarySourceFile(SF);
+    return;
+  }
+
+  for (unsigned i = 0, e = BatchPrimaryBufferIDs.size(); i != e; ++i) {
+    if (BatchPrimaryBufferIDs[i] != BufferID)
+      continue;
+    assert(!BatchPrimarySourceFiles[i] && "already has a source file");
+    BatchPrimarySourceFiles[i] = SF;
+    if (NameTracker) {
+      BatchNameTrackers.emplace_back(new ReferencedNameTracker());
+      SF->setReferencedNameTracker(BatchNameTrackers.back().get());
+    }
+  }
+}
+
+bool CompilerInstance::isPrimaryBuffer(unsigned BufferID) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID)
+    return true;
+  return std::find(BatchPrimaryBufferIDs.begin(), BatchPrimaryBufferIDs.end(),
+                   BufferID) != BatchPrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+    return true;
+  return std::find(BatchPrimarySourceFiles.begin(),
+                   BatchPrimarySourceFiles.end(),
+                   SF) != BatchPrimarySourceFiles.end();
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
@@ -132,6 +166,15 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
   const Optional<SelectedInput> &PrimaryInput =
     Invocation.getFrontendOptions().PrimaryInput;
+  ArrayRef<FrontendOptions::BatchPrimary> BatchPrimaries =
+    Invocation.getFrontendOptions().BatchPrimaries;
+  BatchPrimaryBufferIDs.assign(BatchPrimaries.size(), NO_SUCH_BUFFER);
+  BatchPrimarySourceFiles.assign(BatchPrimaries.size(), nullptr);
+  auto noteBatchPrimaryBuffer = [&](unsigned InputIndex, unsigned BufferID) {
+    for (unsigned j = 0, e = BatchPrimaries.size(); j != e; ++j)
+      if (BatchPrimaries[j].InputIndex == InputIndex)
+        BatchPrimaryBufferIDs[j] = BufferID;
+  };
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -169,6 +212,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (PrimaryInput && PrimaryInput->isFilename() &&
           PrimaryInput->Index == i)
         PrimaryBufferID = ExistingBufferID.getValue();
+      noteBatchPrimaryBuffer(i, ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -211,6 +255,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
     if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
       PrimaryBufferID = BufferID;
+    noteBatchPrimaryBuffer(i, BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -277,16 +322,19 @@ void CompilerInstance::performSema() {
     }
 
     const auto &silOptions = Invocation.getSILOptions();
-    if ((silOptions.Optimization <= SILOptions::SILOptMode::None &&
+    if ((silOptions.Optimization <= SILOptions::SILOptMode::Debug &&
          (options.RequestedAction == FrontendOptions::EmitObject ||
           options.RequestedAction == FrontendOptions::Immediate ||
           options.RequestedAction == FrontendOptions::EmitSIL)) ||
-        (silOptions.Optimization == SILOptions::SILOptMode::None &&
-         options.RequestedAction >= FrontendOptions::EmitSILGen)) {
+        ((silOptions.Optimization == SILOptions::SILOptMode::None ||
+          silOptions.Optimization == SILOptions::SILOptMode::Debug) &&
+         options.RequestedAction >= FrontendOptions::EmitSILGen) ||
+        silOptions.UsePrespecializations) {
       // Implicitly import the SwiftOnoneSupport module in non-optimized
       // builds. This allows for use of popular specialized functions
       // from the standard library, which makes the non-optimized builds
-      // execute much faster.
+      // execute much faster. Optimized builds can opt into using them to
+      // save code size and compile time.
       Invocation.getFrontendOptions()
                 .ImplicitImportModuleNames.push_back(SWIFT_ONONE_SUPPORT);
     }
@@ -383,7 +431,22 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
-  PersistentParserState PersistentState;
+  // Only the declarations of the files which are not primary are needed, so
+  // their function bodies are skipped by brace matching. The bodies of
+  // transparent functions are parsed after the file, as they may be inlined
+  // into the primary files.
+  SkipNonTransparentFunctions NonPrimaryDelayedCB;
+  auto getDelayedCallbacks = [&](unsigned BufferID)
+      -> DelayedParsingCallbacks * {
+    if (DelayedCB)
+      return DelayedCB.get();
+    if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBuffer(BufferID) ||
+        Kind == InputFileKind::IFK_SIL || options.actionIsImmediate())
+      return nullptr;
+    return &NonPrimaryDelayedCB;
+  };
+
+  PersistentState.reset(new PersistentParserState());
 
   // Make sure the main file is the first file in the module. This may only be
   // a source file, or it may be a SIL file, which requires pumping the parser.
@@ -401,8 +464,7 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
-      setPrimarySourceFile(MainFile);
+    notePossiblePrimarySourceFile(MainFile, MainBufferID);
   }
 
   bool hadLoadError = false;
@@ -427,26 +489,31 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
-      setPrimarySourceFile(NextInput);
+    notePossiblePrimarySourceFile(NextInput, BufferID);
 
     auto &Diags = NextInput->getASTContext().Diags;
     auto DidSuppressWarnings = Diags.getSuppressWarnings();
-    auto IsPrimary
-      = PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID;
+    auto IsPrimary = isPrimaryBuffer(BufferID);
     Diags.setSuppressWarnings(DidSuppressWarnings || !IsPrimary);
 
+    auto *FileDelayedCB = getDelayedCallbacks(BufferID);
     bool Done;
     do {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          PersistentState.get(), FileDelayedCB);
     } while (!Done);
 
+    if (FileDelayedCB == &NonPrimaryDelayedCB)
+      performDelayedParsing(NextInput, *PersistentState, nullptr);
+
     Diags.setSuppressWarnings(DidSuppressWarnings);
 
     performNameBinding(*NextInput);
+
+    if (Context->isCancellationRequested())
+      return;
   }
 
   if (Invocation.isCodeCompletion()) {
@@ -471,11 +538,17 @@ void CompilerInstance::performSema() {
   if (options.actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
+  // Only the bodies of transparent functions end up in the module, unless all
+  // or small function bodies are serialized as well.
+  if (options.SkipNonInlinableFunctionBodies &&
+      options.RequestedAction == FrontendOptions::EmitModuleOnly &&
+      !options.SILSerializeAll && !options.SILSerializeSmallFunctions) {
+    TypeCheckOptions |= TypeCheckingFlags::SkipNonInlinableFunctionBodies;
+  }
 
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
-    bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+    bool mainIsPrimary = isPrimaryBuffer(MainBufferID);
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -485,6 +558,7 @@ void CompilerInstance::performSema() {
     Diags.setSuppressWarnings(DidSuppressWarnings || !mainIsPrimary);
 
     SILParserState SILContext(TheSILModule.get());
+    auto *FileDelayedCB = getDelayedCallbacks(MainBufferID);
     unsigned CurTUElem = 0;
     bool Done;
     do {
@@ -494,20 +568,25 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          PersistentState.get(), FileDelayedCB);
       if (mainIsPrimary) {
-        performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
+        performTypeChecking(MainFile, PersistentState->getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
                             options.WarnLongFunctionBodies);
       }
       CurTUElem = MainFile.Decls.size();
-    } while (!Done);
+    } while (!Done && !Context->isCancellationRequested());
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
+
+    if (Context->isCancellationRequested())
+      return;
     
     if (mainIsPrimary && !Context->hadError() &&
         Invocation.getFrontendOptions().PlaygroundTransform)
       performPlaygroundTransform(MainFile, Invocation.getFrontendOptions().PlaygroundHighPerformance);
+    if (FileDelayedCB == &NonPrimaryDelayedCB)
+      performDelayedParsing(&MainFile, *PersistentState, nullptr);
     if (!mainIsPrimary)
       performNameBinding(MainFile);
   }
@@ -515,18 +594,21 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
-        performTypeChecking(*SF, PersistentState.getTopLevelContext(),
+      if (isPrimarySourceFile(SF))
+        performTypeChecking(*SF, PersistentState->getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
                             options.WarnLongFunctionBodies);
 
+  if (Context->isCancellationRequested())
+    return;
+
   // Even if there were no source files, we should still record known
   // protocols.
   if (auto *stdlib = Context->getStdlibModule())
     Context->recordKnownProtocols(stdlib);
 
   if (DelayedCB) {
-    performDelayedParsing(MainModule, PersistentState,
+    performDelayedParsing(MainModule, *PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
 
@@ -539,10 +621,34 @@ void CompilerInstance::performSema() {
 
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (isPrimarySourceFile(SF))
         finishTypeChecking(*SF);
 }
 
+bool CompilerInstance::getCodeCompletionDeclRange(unsigned &StartOffset,
+                                                  unsigned &EndOffset) const {
+  if (!PersistentState || !PersistentState->hasDelayedDecl())
+    return false;
+  unsigned BufferID = SourceMgr.getCodeCompletionBufferID();
+  StartOffset = SourceMgr.getLocOffsetInBuffer(
+      PersistentState->getDelayedDeclLoc(), BufferID);
+  EndOffset = SourceMgr.getLocOffsetInBuffer(
+      PersistentState->getDelayedDeclEnd(), BufferID);
+  return true;
+}
+
+void CompilerInstance::performCodeCompletionAgain(
+    llvm::MemoryBuffer *NewBuffer, unsigned Offset, int EndDelta,
+    CodeCompletionCallbacksFactory *Factory) {
+  assert(PersistentState && PersistentState->hasDelayedDecl());
+  unsigned OldBufferID = SourceMgr.getCodeCompletionBufferID();
+  unsigned NewBufferID = SourceMgr.addMemBufferCopy(NewBuffer);
+  SourceMgr.setCodeCompletionPoint(NewBufferID, Offset);
+  PersistentState->moveDelayedDecl(SourceMgr, OldBufferID, NewBufferID,
+                                   EndDelta);
+  performCodeCompletionReparsing(*PersistentState, Factory);
+}
+
 void CompilerInstance::performParseOnly() {
   const InputFileKind Kind = Invocation.getInputKind();
   Module *MainModule = getMainModule();
@@ -40,6 +40,7 @@ bool FrontendOptions::actionHasOutput() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return true;
   }
   llvm_unreachable("Unknown ActionType");
@@ -68,6 +69,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return false;
   }
   llvm_unreachable("Unknown ActionType");
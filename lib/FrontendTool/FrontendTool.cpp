@@ -24,6 +24,7 @@
 
 #include "swift/Subsystems.h"
 #include "swift/AST/ASTScope.h"
+#include "swift/AST/ASTWalker.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/IRGenOptions.h"
@@ -36,7 +37,10 @@
 #include "swift/Basic/FileSystem.h"
 #include "swift/Basic/LLVMContext.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -58,6 +62,8 @@
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
@@ -199,6 +205,113 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+/// Returns true if \p D is or contains a variable whose type is inferred from
+/// its initializer, which can change without any of its own tokens changing.
+static bool hasInferredType(const Decl *D) {
+  if (auto *VD = dyn_cast<VarDecl>(D)) {
+    auto *PBD = VD->getParentPatternBinding();
+    if (!PBD)
+      return false;
+    return std::any_of(PBD->getPatternList().begin(),
+                       PBD->getPatternList().end(),
+                       [](const PatternBindingEntry &entry) {
+      return entry.getInit() && !isa<TypedPattern>(entry.getPattern());
+    });
+  }
+
+  DeclRange members = {DeclIterator(), DeclIterator()};
+  if (auto *NTD = dyn_cast<NominalTypeDecl>(D))
+    members = NTD->getMembers();
+  else if (auto *ED = dyn_cast<ExtensionDecl>(D))
+    members = ED->getMembers();
+  return std::any_of(members.begin(), members.end(), hasInferredType);
+}
+
+namespace {
+/// Accumulates the interface hashes of the declarations behind one entry of a
+/// "provides" section.
+///
+/// An entry with a declaration whose hash isn't known, or whose type depends
+/// on inference, gets no hash at all. This makes the driver fall back to the
+/// file's interface hash for it.
+class ProvidedEntryHash {
+  std::string DeclHashes;
+  bool Unknown = false;
+
+  /// Returns true if \p D declares conformances, which private members of
+  /// the type can be witnesses for.
+  static bool declaresConformances(const Decl *D) {
+    if (auto *NTD = dyn_cast<NominalTypeDecl>(D))
+      return !NTD->getInherited().empty();
+    if (auto *ED = dyn_cast<ExtensionDecl>(D))
+      return !ED->getInherited().empty();
+    return false;
+  }
+
+public:
+  void add(const SourceFile &SF, const Decl *D) {
+    auto kind = declaresConformances(D)
+                    ? SourceFile::DeclInterfaceHashKind::AllMembers
+                    : SourceFile::DeclInterfaceHashKind::Interface;
+    StringRef hash = SF.getDeclInterfaceHash(D, kind);
+    if (hash.empty() || hasInferredType(D))
+      Unknown = true;
+    else
+      DeclHashes += hash;
+  }
+
+  /// Returns the combined hash, or an empty string if it isn't known.
+  std::string get() const {
+    if (Unknown || DeclHashes.empty())
+      return "";
+    llvm::MD5 hash;
+    hash.update(DeclHashes);
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    return str.str();
+  }
+};
+} // end anonymous namespace
+
+/// Computes a hash of the layouts of the type declarations in \p SF, such as
+/// the stored properties of its nominal types and the underlying types of its
+/// typealiases, or returns an empty string if it isn't known.
+///
+/// Declarations which merely mention one of these types don't include its
+/// tokens in their hashes, so when this changes the driver doesn't try to
+/// tell which declarations changed.
+static std::string getTypeLayoutHash(const SourceFile &SF) {
+  llvm::MD5 hash;
+  bool known = true;
+  auto addTypeDecl = [&](const Decl *D) {
+    StringRef declHash = SF.getDeclInterfaceHash(
+        D, SourceFile::DeclInterfaceHashKind::Layout);
+    if (declHash.empty())
+      known = false;
+    hash.update(declHash);
+  };
+
+  for (const Decl *D : SF.Decls) {
+    if (isa<TypeDecl>(D)) {
+      addTypeDecl(D);
+    } else if (auto *ED = dyn_cast<ExtensionDecl>(D)) {
+      for (const Decl *member : ED->getMembers())
+        if (isa<TypeDecl>(member))
+          addTypeDecl(member);
+    }
+  }
+  if (!known)
+    return "";
+
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  llvm::SmallString<32> str;
+  llvm::MD5::stringifyResult(result, str);
+  return str.str();
+}
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -231,6 +344,13 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   llvm::SmallVector<const FuncDecl *, 8> memberOperatorDecls;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
 
+  // The hashes of the declarations behind each provided name, emitted in the
+  // "*-hashes" sections so that the driver can tell which of them changed.
+  llvm::MapVector<Identifier, ProvidedEntryHash> topLevelHashes;
+  llvm::MapVector<const NominalTypeDecl *, ProvidedEntryHash> nominalHashes;
+  llvm::MapVector<std::pair<const NominalTypeDecl *, Identifier>,
+                  ProvidedEntryHash> memberHashes;
+
   out << "provides-top-level:\n";
   for (const Decl *D : SF->Decls) {
     switch (D->getKind()) {
@@ -263,6 +383,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         }
       }
       extendedNominals[NTD] |= !justMembers;
+      nominalHashes[NTD].add(*SF, ED);
       findNominalsAndOperators(extendedNominals, memberOperatorDecls,
                                ED->getMembers());
       break;
@@ -272,10 +393,12 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
       out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      topLevelHashes[cast<OperatorDecl>(D)->getName()].add(*SF, D);
       break;
 
     case DeclKind::PrecedenceGroup:
       out << "- \"" << escape(cast<PrecedenceGroupDecl>(D)->getName()) << "\"\n";
+      topLevelHashes[cast<PrecedenceGroupDecl>(D)->getName()].add(*SF, D);
       break;
 
     case DeclKind::Enum:
@@ -290,6 +413,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(NTD->getName()) << "\"\n";
+      topLevelHashes[NTD->getName()].add(*SF, NTD);
       extendedNominals[NTD] |= true;
       findNominalsAndOperators(extendedNominals, memberOperatorDecls,
                                NTD->getMembers());
@@ -307,6 +431,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(VD->getName()) << "\"\n";
+      topLevelHashes[VD->getName()].add(*SF, VD);
       break;
     }
 
@@ -329,8 +454,16 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   }
 
   // This is also part of "provides-top-level".
-  for (auto *operatorFunction : memberOperatorDecls)
+  for (auto *operatorFunction : memberOperatorDecls) {
     out << "- \"" << escape(operatorFunction->getName()) << "\"\n";
+    topLevelHashes[operatorFunction->getName()].add(*SF, operatorFunction);
+  }
+
+  // A nominal declared in this file, at the top level or nested in another
+  // type, contributes its own body to its hash along with any extensions.
+  for (auto entry : extendedNominals)
+    if (entry.first->getParentSourceFile() == SF)
+      nominalHashes[entry.first].add(*SF, entry.first);
 
   out << "provides-nominal:\n";
   for (auto entry : extendedNominals) {
@@ -361,6 +494,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
       }
       out << "- [\"" << mangledName << "\", \""
           << escape(VD->getName()) << "\"]\n";
+      memberHashes[{ED->getExtendedType()->getAnyNominal(), VD->getName()}]
+        .add(*SF, VD);
     }
   }
 
@@ -385,6 +520,45 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     SF->lookupClassMembers({}, printer);
   }
 
+  out << "top-level-hashes:\n";
+  for (auto &entry : topLevelHashes) {
+    std::string hash = entry.second.get();
+    if (hash.empty())
+      continue;
+    out << "- [\"" << escape(entry.first) << "\", \"" << hash << "\"]\n";
+  }
+
+  out << "nominal-hashes:\n";
+  for (auto entry : extendedNominals) {
+    if (!entry.second)
+      continue;
+    std::string hash = nominalHashes[entry.first].get();
+    if (hash.empty())
+      continue;
+    out << "- [\"" << mangleTypeAsContext(entry.first) << "\", \""
+        << hash << "\"]\n";
+  }
+
+  out << "member-hashes:\n";
+  for (auto entry : extendedNominals) {
+    std::string hash = nominalHashes[entry.first].get();
+    if (hash.empty())
+      continue;
+    out << "- [\"" << mangleTypeAsContext(entry.first) << "\", \"\", \""
+        << hash << "\"]\n";
+  }
+  for (auto &entry : memberHashes) {
+    std::string hash = entry.second.get();
+    if (hash.empty())
+      continue;
+    out << "- [\"" << mangleTypeAsContext(entry.first.first) << "\", \""
+        << escape(entry.first.second) << "\", \"" << hash << "\"]\n";
+  }
+
+  std::string typeLayoutHash = getTypeLayoutHash(*SF);
+  if (!typeLayoutHash.empty())
+    out << "type-layout-hash: \"" << typeLayoutHash << "\"\n";
+
   ReferencedNameTracker *tracker = SF->getReferencedNameTracker();
 
   // FIXME: Sort these?
@@ -682,6 +856,124 @@ private:
 
 } // anonymous namespace
 
+namespace {
+/// Counts the expressions and declarations of each kind in the AST.
+class ASTNodeCounter : public ASTWalker {
+public:
+  static constexpr size_t ExprSizes[] = {
+#define EXPR(Id, Parent) sizeof(Id##Expr),
+#include "swift/AST/ExprNodes.def"
+  };
+  static constexpr size_t DeclSizes[] = {
+#define DECL(Id, Parent) sizeof(Id##Decl),
+#include "swift/AST/DeclNodes.def"
+  };
+
+  unsigned NumExprs[llvm::array_lengthof(ExprSizes)] = {};
+  unsigned NumDecls[llvm::array_lengthof(DeclSizes)] = {};
+
+  std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
+    ++NumExprs[unsigned(E->getKind())];
+    return { true, E };
+  }
+
+  bool walkToDeclPre(Decl *D) override {
+    ++NumDecls[unsigned(D->getKind())];
+    return true;
+  }
+};
+} // end anonymous namespace
+
+constexpr size_t ASTNodeCounter::ExprSizes[];
+constexpr size_t ASTNodeCounter::DeclSizes[];
+
+/// Print the number of expressions and declarations of each kind in the
+/// source files of \p M, and how many bytes they take up, for -print-stats.
+///
+/// The sizes don't include trailing storage, such as the elements of a
+/// TupleExpr, and nodes which the walker doesn't visit aren't counted.
+static void printASTNodeStatistics(Module *M, raw_ostream &OS) {
+  ASTNodeCounter Counter;
+  for (auto File : M->getFiles()) {
+    if (auto SF = dyn_cast<SourceFile>(File)) {
+      for (auto D : SF->Decls)
+        D->walk(Counter);
+    }
+  }
+
+  auto printKind = [&](StringRef Name, unsigned Count, size_t Size) {
+    if (Count == 0)
+      return;
+    OS << llvm::format("%10u %12zu ", Count, Count * Size) << Name << '\n';
+  };
+
+  OS << "===-------------------------------------------------------------===\n"
+     << "                      AST node statistics\n"
+     << "===-------------------------------------------------------------===\n"
+     << "     count        bytes kind\n";
+  unsigned Index = 0;
+#define EXPR(Id, Parent) \
+  printKind(#Id "Expr", Counter.NumExprs[Index], Counter.ExprSizes[Index]); \
+  ++Index;
+#include "swift/AST/ExprNodes.def"
+  Index = 0;
+#define DECL(Id, Parent) \
+  printKind(#Id "Decl", Counter.NumDecls[Index], Counter.DeclSizes[Index]); \
+  ++Index;
+#include "swift/AST/DeclNodes.def"
+  OS << '\n';
+}
+
+/// Record the number of expressions and declarations of each kind in the
+/// source files of \p M, and the memory of the ASTContext, for
+/// -stats-output-dir.
+static void recordASTStatistics(Module *M, UnifiedStatsReporter &Stats) {
+  ASTNodeCounter Counter;
+  unsigned NumSourceFiles = 0, NumTopLevelDecls = 0;
+  for (auto File : M->getFiles()) {
+    if (auto SF = dyn_cast<SourceFile>(File)) {
+      ++NumSourceFiles;
+      NumTopLevelDecls += SF->Decls.size();
+      for (auto D : SF->Decls)
+        D->walk(Counter);
+    }
+  }
+
+  ASTContext &Ctx = M->getASTContext();
+  Stats.setCounter("AST.NumSourceFiles", NumSourceFiles);
+  Stats.setCounter("AST.NumTopLevelDecls", NumTopLevelDecls);
+  Stats.setCounter("AST.NumLoadedModules", Ctx.LoadedModules.size());
+  Stats.setCounter("Memory.ASTContextBytes", Ctx.getTotalMemory());
+
+  unsigned Index = 0;
+#define EXPR(Id, Parent) \
+  if (Counter.NumExprs[Index]) \
+    Stats.setCounter("AST.Num" #Id "Expr", Counter.NumExprs[Index]); \
+  ++Index;
+#include "swift/AST/ExprNodes.def"
+  Index = 0;
+#define DECL(Id, Parent) \
+  if (Counter.NumDecls[Index]) \
+    Stats.setCounter("AST.Num" #Id "Decl", Counter.NumDecls[Index]); \
+  ++Index;
+#include "swift/AST/DeclNodes.def"
+}
+
+/// Record the size of the optimized SIL module for -stats-output-dir.
+static void recordSILStatistics(SILModule &SM, UnifiedStatsReporter &Stats) {
+  unsigned NumInstructions = 0;
+  for (auto &F : SM)
+    for (auto &BB : F)
+      NumInstructions += std::distance(BB.begin(), BB.end());
+
+  Stats.setCounter("SIL.NumFunctions", SM.getFunctionList().size());
+  Stats.setCounter("SIL.NumInstructions", NumInstructions);
+  Stats.setCounter("SIL.NumVTables", SM.getVTableList().size());
+  Stats.setCounter("SIL.NumWitnessTables", SM.getWitnessTableList().size());
+  Stats.setCounter("SIL.NumGlobalVariables", SM.getSILGlobalList().size());
+  Stats.setCounter("Memory.SILModuleBytes", SM.getBytesAllocated());
+}
+
 // This is a separate function so that it shows up in stack traces.
 LLVM_ATTRIBUTE_NOINLINE
 static void debugFailWithAssertion() {
@@ -698,176 +990,20 @@ static void debugFailWithCrash() {
 
 /// Performs the compile requested by the user.
 /// \returns true on error
-static bool performCompile(CompilerInstance &Instance,
-                           CompilerInvocation &Invocation,
-                           ArrayRef<const char *> Args,
-                           int &ReturnValue,
-                           FrontendObserver *observer) {
-  FrontendOptions opts = Invocation.getFrontendOptions();
+/// Runs SILGen, the SIL pipeline and IRGen for one primary file (or the whole
+/// module, if \p PrimarySourceFile is null), and writes the outputs
+/// described by \p opts.
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        SourceFile *PrimarySourceFile,
+                                        IRGenOptions &IRGenOpts,
+                                        bool moduleIsPublic,
+                                        int &ReturnValue,
+                                        FrontendObserver *observer) {
   FrontendOptions::ActionType Action = opts.RequestedAction;
-
-  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
-
-  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
-  if (inputIsLLVMIr) {
-    auto &LLVMContext = getGlobalLLVMContext();
-
-    // Load in bitcode file.
-    assert(Invocation.getInputFilenames().size() == 1 &&
-           "We expect a single input for bitcode input!");
-    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
-      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
-    if (!FileBufOrErr) {
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_open_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              FileBufOrErr.getError().message());
-      return true;
-    }
-    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
-
-    llvm::SMDiagnostic Err;
-    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
-                                             MainFile->getMemBufferRef(),
-                                             Err, LLVMContext);
-    if (!Module) {
-      // TODO: Translate from the diagnostic info to the SourceManager location
-      // if available.
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_parse_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              Err.getMessage());
-      return true;
-    }
-
-    // TODO: remove once the frontend understands what action it should perform
-    IRGenOpts.OutputKind = getOutputKind(Action);
-
-    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
-  }
-
-  ReferencedNameTracker nameTracker;
-  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
-    Instance.setReferencedNameTracker(&nameTracker);
-
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpInterfaceHash)
-    Instance.performParseOnly();
-  else
-    Instance.performSema();
-
-  if (observer) {
-    observer->performedSemanticAnalysis(Instance);
-  }
-
-  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
-  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
-    debugFailWithAssertion();
-  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
-    debugFailWithCrash();
-
   ASTContext &Context = Instance.getASTContext();
 
-  if (Action == FrontendOptions::REPL) {
-    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
-            Invocation.getParseStdlib());
-    return false;
-  }
-
-  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
-
-  // We've been told to dump the AST (either after parsing or type-checking,
-  // which is already differentiated in CompilerInstance::performSema()),
-  // so dump or print the main source file and return.
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpAST ||
-      Action == FrontendOptions::PrintAST ||
-      Action == FrontendOptions::DumpScopeMaps ||
-      Action == FrontendOptions::DumpTypeRefinementContexts ||
-      Action == FrontendOptions::DumpInterfaceHash) {
-    SourceFile *SF = PrimarySourceFile;
-    if (!SF) {
-      SourceFileKind Kind = Invocation.getSourceFileKind();
-      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
-    }
-    if (Action == FrontendOptions::PrintAST)
-      SF->print(llvm::outs(), PrintOptions::printEverything());
-    else if (Action == FrontendOptions::DumpScopeMaps) {
-      ASTScope &scope = SF->getScope();
-
-      if (opts.DumpScopeMapLocations.empty()) {
-        scope.expandAll();
-      } else if (auto bufferID = SF->getBufferID()) {
-        SourceManager &sourceMgr = Instance.getSourceMgr();
-        // Probe each of the locations, and dump what we find.
-        for (auto lineColumn : opts.DumpScopeMapLocations) {
-          SourceLoc loc = sourceMgr.getLocForLineCol(*bufferID,
-                                                     lineColumn.first,
-                                                     lineColumn.second);
-          if (loc.isInvalid()) continue;
-
-          llvm::errs() << "***Scope at " << lineColumn.first << ":"
-            << lineColumn.second << "***\n";
-          auto locScope = scope.findInnermostEnclosingScope(loc);
-          locScope->print(llvm::errs(), 0, false, false);
-
-          // Dump the AST context, too.
-          if (auto dc = locScope->getDeclContext()) {
-            dc->printContext(llvm::errs());
-          }
-
-          // Grab the local bindings introduced by this scope.
-          auto localBindings = locScope->getLocalBindings();
-          if (!localBindings.empty()) {
-            llvm::errs() << "Local bindings: ";
-            interleave(localBindings.begin(), localBindings.end(),
-                       [&](ValueDecl *value) {
-                         llvm::errs() << value->getFullName();
-                       },
-                       [&]() {
-                         llvm::errs() << " ";
-                       });
-            llvm::errs() << "\n";
-          }
-        }
-
-        llvm::errs() << "***Complete scope map***\n";
-      }
-
-      // Print the resulting map.
-      scope.print(llvm::errs());
-    } else if (Action == FrontendOptions::DumpTypeRefinementContexts)
-      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
-    else if (Action == FrontendOptions::DumpInterfaceHash)
-      SF->dumpInterfaceHash(llvm::errs());
-    else
-      SF->dump();
-    return false;
-  }
-
-  // If we were asked to print Clang stats, do so.
-  if (opts.PrintClangStats && Context.getClangModuleLoader())
-    Context.getClangModuleLoader()->printStatistics();
-
-  if (!opts.DependenciesFilePath.empty())
-    (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
-                               opts);
-
-  if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
-                              *Instance.getDependencyTracker(), opts);
-
-  if (Context.hadError())
-    return true;
-
-  // FIXME: This is still a lousy approximation of whether the module file will
-  // be externally consumed.
-  bool moduleIsPublic =
-      !Instance.getMainModule()->hasEntryPoint() &&
-      opts.ImplicitObjCHeaderPath.empty() &&
-      !Context.LangOpts.EnableAppExtensionRestrictions;
-
   // We've just been told to perform a parse, so we can return now.
   if (Action == FrontendOptions::Parse) {
     if (!opts.ObjCHeaderOutputPath.empty())
@@ -951,7 +1087,7 @@ static bool performCompile(CompilerInstance &Instance,
   {
     SharedTimer timer("SIL optimization");
     if (Invocation.getSILOptions().Optimization >
-        SILOptions::SILOptMode::None) {
+        SILOptions::SILOptMode::Debug) {
       StringRef CustomPipelinePath =
         Invocation.getSILOptions().ExternalPassPipelineFilename;
       if (!CustomPipelinePath.empty()) {
@@ -973,6 +1109,9 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (auto *Stats = UnifiedStatsReporter::get())
+    recordSILStatistics(*SM, *Stats);
+
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
@@ -1014,6 +1153,8 @@ static bool performCompile(CompilerInstance &Instance,
       serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
       serializationOpts.GroupInfoPath = opts.GroupInfoPath.c_str();
       serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
+      serializationOpts.SerializeSmallFunctions =
+          opts.SILSerializeSmallFunctions;
       if (opts.SerializeBridgingHeader)
         serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
       serializationOpts.ModuleLinkName = opts.ModuleLinkName;
@@ -1027,6 +1168,8 @@ static bool performCompile(CompilerInstance &Instance,
       // the public.
       serializationOpts.SerializeOptionsForDebugging =
           !moduleIsPublic || opts.AlwaysSerializeDebuggingOptions;
+      serializationOpts.PreserveTimestampIfInterfaceUnchanged =
+          opts.PreserveTimestampIfInterfaceUnchanged;
 
       serialize(DC, serializationOpts, SM.get());
     }
@@ -1078,11 +1221,13 @@ static bool performCompile(CompilerInstance &Instance,
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = getGlobalLLVMContext();
+  // The SIL module is handed over to IRGen, which frees it before running the
+  // LLVM passes.
   if (PrimarySourceFile) {
-    performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
+    performIRGeneration(IRGenOpts, *PrimarySourceFile, std::move(SM),
                         opts.getSingleOutputFilename(), LLVMContext);
   } else {
-    performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
+    performIRGeneration(IRGenOpts, Instance.getMainModule(), std::move(SM),
                         opts.getSingleOutputFilename(), LLVMContext);
   }
 
@@ -1090,6 +1235,236 @@ static bool performCompile(CompilerInstance &Instance,
 }
 
 /// Returns true if an error occurred.
+static bool performCompile(CompilerInstance &Instance,
+                           CompilerInvocation &Invocation,
+                           ArrayRef<const char *> Args,
+                           int &ReturnValue,
+                           FrontendObserver *observer) {
+  FrontendOptions opts = Invocation.getFrontendOptions();
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+
+  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+
+  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
+  if (inputIsLLVMIr) {
+    auto &LLVMContext = getGlobalLLVMContext();
+
+    // Load in bitcode file.
+    assert(Invocation.getInputFilenames().size() == 1 &&
+           "We expect a single input for bitcode input!");
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
+      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
+    if (!FileBufOrErr) {
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_open_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              FileBufOrErr.getError().message());
+      return true;
+    }
+    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+
+    llvm::SMDiagnostic Err;
+    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
+                                             MainFile->getMemBufferRef(),
+                                             Err, LLVMContext);
+    if (!Module) {
+      // TODO: Translate from the diagnostic info to the SourceManager location
+      // if available.
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_parse_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              Err.getMessage());
+      return true;
+    }
+
+    // TODO: remove once the frontend understands what action it should perform
+    IRGenOpts.OutputKind = getOutputKind(Action);
+
+    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+  }
+
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(Invocation.getInputFilenames()[0],
+                                          opts.getSingleOutputFilename());
+  }
+
+  ReferencedNameTracker nameTracker;
+  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
+  if (shouldTrackReferences)
+    Instance.setReferencedNameTracker(&nameTracker);
+
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpInterfaceHash)
+    Instance.performParseOnly();
+  else
+    Instance.performSema();
+
+  if (observer) {
+    observer->performedSemanticAnalysis(Instance);
+  }
+
+  if (opts.PrintStats)
+    printASTNodeStatistics(Instance.getMainModule(), llvm::errs());
+  if (auto *Stats = UnifiedStatsReporter::get())
+    recordASTStatistics(Instance.getMainModule(), *Stats);
+
+  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
+  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
+    debugFailWithAssertion();
+  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
+    debugFailWithCrash();
+
+  ASTContext &Context = Instance.getASTContext();
+
+  if (Action == FrontendOptions::REPL) {
+    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
+            Invocation.getParseStdlib());
+    return false;
+  }
+
+  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
+
+  // We've been told to dump the AST (either after parsing or type-checking,
+  // which is already differentiated in CompilerInstance::performSema()),
+  // so dump or print the main source file and return.
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpAST ||
+      Action == FrontendOptions::PrintAST ||
+      Action == FrontendOptions::DumpScopeMaps ||
+      Action == FrontendOptions::DumpTypeRefinementContexts ||
+      Action == FrontendOptions::DumpInterfaceHash) {
+    SourceFile *SF = PrimarySourceFile;
+    if (!SF) {
+      SourceFileKind Kind = Invocation.getSourceFileKind();
+      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+    }
+    if (Action == FrontendOptions::PrintAST)
+      SF->print(llvm::outs(), PrintOptions::printEverything());
+    else if (Action == FrontendOptions::DumpScopeMaps) {
+      ASTScope &scope = SF->getScope();
+
+      if (opts.DumpScopeMapLocations.empty()) {
+        scope.expandAll();
+      } else if (auto bufferID = SF->getBufferID()) {
+        SourceManager &sourceMgr = Instance.getSourceMgr();
+        // Probe each of the locations, and dump what we find.
+        for (auto lineColumn : opts.DumpScopeMapLocations) {
+          SourceLoc loc = sourceMgr.getLocForLineCol(*bufferID,
+                                                     lineColumn.first,
+                                                     lineColumn.second);
+          if (loc.isInvalid()) continue;
+
+          llvm::errs() << "***Scope at " << lineColumn.first << ":"
+            << lineColumn.second << "***\n";
+          auto locScope = scope.findInnermostEnclosingScope(loc);
+          locScope->print(llvm::errs(), 0, false, false);
+
+          // Dump the AST context, too.
+          if (auto dc = locScope->getDeclContext()) {
+            dc->printContext(llvm::errs());
+          }
+
+          // Grab the local bindings introduced by this scope.
+          auto localBindings = locScope->getLocalBindings();
+          if (!localBindings.empty()) {
+            llvm::errs() << "Local bindings: ";
+            interleave(localBindings.begin(), localBindings.end(),
+                       [&](ValueDecl *value) {
+                         llvm::errs() << value->getFullName();
+                       },
+                       [&]() {
+                         llvm::errs() << " ";
+                       });
+            llvm::errs() << "\n";
+          }
+        }
+
+        llvm::errs() << "***Complete scope map***\n";
+      }
+
+      // Print the resulting map.
+      scope.print(llvm::errs());
+    } else if (Action == FrontendOptions::DumpTypeRefinementContexts)
+      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
+    else if (Action == FrontendOptions::DumpInterfaceHash)
+      SF->dumpInterfaceHash(llvm::errs());
+    else
+      SF->dump();
+    return false;
+  }
+
+  // If we were asked to print Clang stats, do so.
+  if (opts.PrintClangStats && Context.getClangModuleLoader())
+    Context.getClangModuleLoader()->printStatistics();
+
+  // Each primary file of a batch is compiled as if it were the only one, with
+  // its own outputs.
+  std::vector<FrontendOptions> PrimaryOpts(1, opts);
+  SmallVector<SourceFile *, 4> PrimaryFiles(1, PrimarySourceFile);
+  for (unsigned i = 0, e = opts.BatchPrimaries.size(); i != e; ++i) {
+    const FrontendOptions::BatchPrimary &BP = opts.BatchPrimaries[i];
+    FrontendOptions BatchOpts = opts;
+    BatchOpts.BatchPrimaries.clear();
+    BatchOpts.PrimaryInput = SelectedInput(BP.InputIndex);
+    BatchOpts.OutputFilenames.clear();
+    if (!BP.OutputFilename.empty())
+      BatchOpts.OutputFilenames.push_back(BP.OutputFilename);
+    BatchOpts.ModuleOutputPath = BP.ModuleOutputPath;
+    BatchOpts.ModuleDocOutputPath = BP.ModuleDocOutputPath;
+    BatchOpts.DependenciesFilePath = BP.DependenciesFilePath;
+    BatchOpts.ReferenceDependenciesFilePath = BP.ReferenceDependenciesFilePath;
+    // The Objective-C header covers the whole module; emit it only once.
+    BatchOpts.ObjCHeaderOutputPath.clear();
+    PrimaryOpts.push_back(std::move(BatchOpts));
+    PrimaryFiles.push_back(Instance.getBatchPrimarySourceFiles()[i]);
+  }
+
+  // Emit dependency information for every primary file, even if there were
+  // errors, so that the next incremental build knows what to rebuild.
+  for (unsigned i = 0, e = PrimaryOpts.size(); i != e; ++i) {
+    if (!PrimaryOpts[i].DependenciesFilePath.empty())
+      (void)emitMakeDependencies(Context.Diags,
+                                 *Instance.getDependencyTracker(),
+                                 PrimaryOpts[i]);
+
+    if (shouldTrackReferences &&
+        !PrimaryOpts[i].ReferenceDependenciesFilePath.empty())
+      emitReferenceDependencies(Context.Diags, PrimaryFiles[i],
+                                *Instance.getDependencyTracker(),
+                                PrimaryOpts[i]);
+  }
+
+  if (Context.hadError())
+    return true;
+
+  // FIXME: This is still a lousy approximation of whether the module file will
+  // be externally consumed.
+  bool moduleIsPublic =
+      !Instance.getMainModule()->hasEntryPoint() &&
+      opts.ImplicitObjCHeaderPath.empty() &&
+      !Context.LangOpts.EnableAppExtensionRestrictions;
+
+  if (PrimaryOpts.size() == 1)
+    return performCompileStepsPostSema(Instance, Invocation, opts,
+                                       PrimarySourceFile, IRGenOpts,
+                                       moduleIsPublic, ReturnValue, observer);
+
+  for (unsigned i = 0, e = PrimaryOpts.size(); i != e; ++i) {
+    const FrontendOptions &BatchOpts = PrimaryOpts[i];
+    IRGenOptions BatchIRGenOpts = IRGenOpts;
+    BatchIRGenOpts.MainInputFilename =
+        BatchOpts.InputFilenames[BatchOpts.PrimaryInput->Index];
+    BatchIRGenOpts.OutputFilenames = BatchOpts.OutputFilenames;
+    if (performCompileStepsPostSema(Instance, Invocation, BatchOpts,
+                                    PrimaryFiles[i], BatchIRGenOpts,
+                                    moduleIsPublic, ReturnValue, observer))
+      return true;
+  }
+  return false;
+}
+
 static bool dumpAPI(Module *Mod, StringRef OutDir) {
   using namespace llvm::sys;
 
@@ -1274,6 +1649,32 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     llvm::EnableStatistics();
   }
 
+  // The statistics of this job are written when StatsReporter goes away, at
+  // the end of the compilation.
+  std::unique_ptr<UnifiedStatsReporter> StatsReporter;
+  std::unique_ptr<TraceEventRecorder> TraceRecorder;
+  const std::string &StatsOutputDir =
+    Invocation.getFrontendOptions().StatsOutputDir;
+  const std::string &TraceEventsDir =
+    Invocation.getFrontendOptions().TraceEventsDir;
+  if (!StatsOutputDir.empty() || !TraceEventsDir.empty()) {
+    std::string AuxName = Invocation.getModuleName();
+    const auto &PrimaryInput = Invocation.getFrontendOptions().PrimaryInput;
+    if (PrimaryInput && PrimaryInput->isFilename()) {
+      AuxName += '-';
+      AuxName += llvm::sys::path::filename(
+          Invocation.getInputFilenames()[PrimaryInput->Index]);
+    }
+    if (!StatsOutputDir.empty()) {
+      StatsReporter.reset(
+          new UnifiedStatsReporter("swift-frontend", AuxName, StatsOutputDir));
+      llvm::EnableStatistics();
+    }
+    if (!TraceEventsDir.empty())
+      TraceRecorder.reset(new TraceEventRecorder(
+          TraceEventsDir, "swift-frontend " + AuxName, /*IsFragment=*/true));
+  }
+
   const DiagnosticOptions &diagOpts = Invocation.getDiagnosticOptions();
   if (diagOpts.VerifyMode != DiagnosticOptions::NoVerify) {
     enableDiagnosticVerifier(Instance.getSourceMgr());
@@ -2,8 +2,10 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
@@ -88,7 +90,7 @@ CodeCompletionCache::~CodeCompletionCache() {}
 ///
 /// This should be incremented any time we commit a change to the format of the
 /// cached results. This isn't expected to change very often.
-static constexpr uint32_t onDiskCompletionCacheVersion = 1;
+static constexpr uint32_t onDiskCompletionCacheVersion = 2;
 
 static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
   char *Mem = Allocator.Allocate<char>(Str.size());
@@ -112,6 +114,24 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
   return llvm::makeArrayRef(Buff, Arr.size());
 }
 
+/// Returns a hash of the contents of the module file \p filename, or None if
+/// it cannot be read.
+///
+/// Unlike the modification time, this survives the module being touched or
+/// copied into a fresh SDK without changing.
+static Optional<uint64_t> getModuleContentHash(StringRef filename) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      filename, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!bufferOrErr)
+    return None;
+
+  llvm::MD5 hash;
+  hash.update(bufferOrErr.get()->getBuffer());
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  return llvm::support::endian::read64le(result);
+}
+
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
 /// \see writeCacheModule.
 static bool readCachedModule(llvm::MemoryBuffer *in,
@@ -134,15 +154,28 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     if (version != onDiskCompletionCacheVersion)
       return false; // File written with different format.
 
-    auto mtime = llvm::support::endian::read64le(cursor);
-    cursor += sizeof(mtime);
+    auto read64le = [end](const char *&cursor) {
+      auto result = llvm::support::endian::read64le(cursor);
+      cursor += sizeof(result);
+      assert(cursor <= end);
+      return result;
+    };
+    auto mtime = read64le(cursor);
+    auto size = read64le(cursor);
+    auto contentHash = read64le(cursor);
 
-    // Check the module file's last modification time.
+    // Check that the module file is the one the results were computed from.
+    // A matching modification time and size is taken as proof; otherwise the
+    // results are still good if the contents are unchanged.
     if (!allowOutOfDate) {
       llvm::sys::fs::file_status status;
       if (llvm::sys::fs::status(K.ModuleFilename, status) ||
-          status.getLastModificationTime().toEpochTime() != mtime) {
+          status.getSize() != size)
         return false; // Out of date, or doesn't exist.
+      if (status.getLastModificationTime().toEpochTime() != mtime) {
+        auto currentHash = getModuleContentHash(K.ModuleFilename);
+        if (!currentHash || *currentHash != contentHash)
+          return false; // Out of date.
       }
     }
   }
@@ -158,16 +191,18 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   const char *strings = chunks + chunkSize;
   auto stringCount = read32le(strings);
   assert(strings + stringCount == end && "incorrect file size");
-  (void)stringCount; // so it is not seen as "unused" in release builds.
-  
+
   // STRINGS
+  // Copy the whole blob into the sink once; the results refer into it.
+  StringRef stringBlob =
+      copyString(*V.Sink.Allocator, StringRef(strings, stringCount));
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
       return "";
 
-    const char *p = strings + index;
-    auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    const char *p = stringBlob.data() + index;
+    auto size = llvm::support::endian::read32le(p);
+    return StringRef(p + sizeof(size), size);
   };
 
   // CHUNKS
@@ -256,7 +291,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///
 ///   HEADER
 ///     * version, which **must be bumped** if we change the format!
-///     * mtime for the module file
+///     * mtime, size and content hash for the module file
 ///
 ///   KEY
 ///     * the original CodeCompletionCache::Key, used for debugging the cache.
@@ -271,10 +306,12 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///       CodeCompletionString::Chunks.
 ///
 ///   STRINGS
-///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * A blob of unique length-prefixed strings referred to in CHUNKS or
+///       RESULTS.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
-                              CodeCompletionCache::Value &V) {
+                              CodeCompletionCache::Value &V,
+                              uint64_t moduleSize, uint64_t moduleHash) {
   using namespace llvm::support;
   endian::Writer<little> LE(out);
 
@@ -282,6 +319,8 @@ static void writeCachedModule(llvm::raw_ostream &out,
   // Metadata required for reading the completions.
   LE.write(onDiskCompletionCacheVersion);           // Version
   LE.write(V.ModuleModificationTime.toEpochTime()); // Mtime for module file
+  LE.write(moduleSize);                             // Size of module file
+  LE.write(moduleHash);                             // Hash of module file
 
   // KEY
   // We don't need the stored key to load the results, but it is useful if we
@@ -310,8 +349,11 @@ static void writeCachedModule(llvm::raw_ostream &out,
   endian::Writer<little> chunksLE(chunks);
   std::string strings_;
   llvm::raw_string_ostream strings(strings_);
+  llvm::StringMap<uint32_t> knownStrings;
 
-  auto addString = [&strings](StringRef str) {
+  // Appends \p str to STRINGS. Arrays of strings are written with this, since
+  // the reader expects their elements to be adjacent.
+  auto writeString = [&strings](StringRef str) {
     if (str.empty())
       return ~0u;
     auto size = strings.tell();
@@ -321,6 +363,16 @@ static void writeCachedModule(llvm::raw_ostream &out,
     return static_cast<uint32_t>(size);
   };
 
+  // Returns the index of \p str in STRINGS, writing it only the first time.
+  auto addString = [&](StringRef str) {
+    if (str.empty())
+      return ~0u;
+    auto inserted = knownStrings.insert({str, 0});
+    if (inserted.second)
+      inserted.first->getValue() = writeString(str);
+    return inserted.first->getValue();
+  };
+
   auto addCompletionString = [&](const CodeCompletionString *str) {
     auto size = chunks.tell();
     chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
@@ -362,9 +414,9 @@ static void writeCachedModule(llvm::raw_ostream &out,
       if (R->getAssociatedUSRs().empty()) {
         LE.write(static_cast<uint32_t>(~0u));
       } else {
-        LE.write(addString(R->getAssociatedUSRs()[0]));
+        LE.write(writeString(R->getAssociatedUSRs()[0]));
         for (unsigned i = 1; i < R->getAssociatedUSRs().size(); ++i) {
-          addString(R->getAssociatedUSRs()[i]); // ignore result
+          writeString(R->getAssociatedUSRs()[i]); // ignore result
         }
       }
       auto AllKeywords = R->getDeclKeywords();
@@ -372,11 +424,11 @@ static void writeCachedModule(llvm::raw_ostream &out,
       if (AllKeywords.empty()) {
         LE.write(static_cast<uint32_t>(~0u));
       } else {
-        LE.write(addString(AllKeywords[0].first));
-        addString(AllKeywords[0].second);
+        LE.write(writeString(AllKeywords[0].first));
+        writeString(AllKeywords[0].second);
         for (unsigned i = 1; i < AllKeywords.size(); ++i) {
-          addString(AllKeywords[i].first);
-          addString(AllKeywords[i].second);
+          writeString(AllKeywords[i].first);
+          writeString(AllKeywords[i].second);
         }
       }
     }
@@ -446,6 +498,15 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
   if (auto err = llvm::sys::fs::create_directories(cacheDirectory))
     return err;
 
+  // Record what the module file looks like, so the results can be reused for
+  // as long as its contents don't change.
+  llvm::sys::fs::file_status moduleStatus;
+  if (auto err = llvm::sys::fs::status(K.ModuleFilename, moduleStatus))
+    return err;
+  auto moduleHash = getModuleContentHash(K.ModuleFilename);
+  if (!moduleHash)
+    return std::make_error_code(std::errc::io_error);
+
   std::string name = getName(cacheDirectory, K);
 
   // Create a temporary file to write the results into.
@@ -456,7 +517,7 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 
   // Write the contents of the buffer.
   llvm::raw_fd_ostream out(tmpFD, /*shouldClose=*/true);
-  writeCachedModule(out, K, *V);
+  writeCachedModule(out, K, *V, moduleStatus.getSize(), *moduleHash);
   out.flush();
   if (out.has_error())
     return std::make_error_code(std::errc::io_error);
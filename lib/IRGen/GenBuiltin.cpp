@@ -708,8 +708,11 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     llvm::BasicBlock *notDoneBB, *doneBB;
 
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
+      // The acquire pairs with the runtime's release store of the "done"
+      // value, so that the initialized global is visible on the fast path.
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      PredValue->setAtomic(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
@@ -813,6 +813,7 @@ void IRGenerator::emitGlobalTopLevel() {
 
     CurrentIGMPtr IGM = getGenModule(&f);
     IGM->emitSILFunction(&f);
+    noteEmittedFunction(IGM.get(), &f);
   }
 
   // Emit static initializers.
@@ -879,34 +880,56 @@ void IRGenerator::emitTypeMetadataRecords() {
 /// Emit any lazy definitions (of globals or functions or whatever
 /// else) that we require.
 void IRGenerator::emitLazyDefinitions() {
-  while (!LazyTypeMetadata.empty() ||
-         !LazyFunctionDefinitions.empty() ||
-         !LazyFieldTypeAccessors.empty()) {
-
-    // Emit any lazy type metadata we require.
-    while (!LazyTypeMetadata.empty()) {
-      CanType type = LazyTypeMetadata.pop_back_val();
-      assert(isTypeMetadataEmittedLazily(type));
-      auto nom = type->getAnyNominal();
-      CurrentIGMPtr IGM = getGenModule(nom->getDeclContext());
-      emitLazyTypeMetadata(*IGM.get(), type);
-    }
-    while (!LazyFieldTypeAccessors.empty()) {
-      auto accessor = LazyFieldTypeAccessors.pop_back_val();
-      emitFieldTypeAccessor(*accessor.IGM, accessor.type, accessor.fn,
-                            accessor.fieldTypes);
-    }
+  // Statically instantiated metadata can only be emitted after the metadata
+  // pattern of its struct, and it may need more lazy definitions in turn.
+  do {
+    while (!LazyTypeMetadata.empty() ||
+           !LazyFunctionDefinitions.empty() ||
+           !LazyFieldTypeAccessors.empty()) {
+
+      // Emit any lazy type metadata we require.
+      while (!LazyTypeMetadata.empty()) {
+        CanType type = LazyTypeMetadata.pop_back_val();
+        assert(isTypeMetadataEmittedLazily(type));
+        auto nom = type->getAnyNominal();
+        CurrentIGMPtr IGM = getGenModule(nom->getDeclContext());
+        emitLazyTypeMetadata(*IGM.get(), type);
+      }
+      while (!LazyFieldTypeAccessors.empty()) {
+        auto accessor = LazyFieldTypeAccessors.pop_back_val();
+        emitFieldTypeAccessor(*accessor.IGM, accessor.type, accessor.fn,
+                              accessor.fieldTypes);
+      }
 
-    // Emit any lazy function definitions we require.
-    while (!LazyFunctionDefinitions.empty()) {
-      SILFunction *f = LazyFunctionDefinitions.pop_back_val();
-      CurrentIGMPtr IGM = getGenModule(f);
-      assert(!isPossiblyUsedExternally(f->getLinkage(),
-                                       IGM->getSILModule().isWholeModule())
-             && "function with externally-visible linkage emitted lazily?");
-      IGM->emitSILFunction(f);
+      // Emit any lazy function definitions we require.
+      while (!LazyFunctionDefinitions.empty()) {
+        SILFunction *f = LazyFunctionDefinitions.pop_back_val();
+        CurrentIGMPtr IGM = getGenModule(f);
+        assert(!isPossiblyUsedExternally(f->getLinkage(),
+                                         IGM->getSILModule().isWholeModule())
+               && "function with externally-visible linkage emitted lazily?");
+        IGM->emitSILFunction(f);
+        noteEmittedFunction(IGM.get(), f);
+      }
+    }
+  } while (emitPrespecializedTypeMetadata());
+}
+
+bool IRGenerator::emitPrespecializedTypeMetadata() {
+  bool emittedAny = false;
+  SmallVector<CanType, 4> pending;
+  std::swap(pending, PendingPrespecializedTypeMetadata);
+  for (CanType type : pending) {
+    auto structDecl = cast<StructDecl>(type->getAnyNominal());
+    CurrentIGMPtr IGM = getGenModule(structDecl->getDeclContext());
+    if (!IGM->getPrespecializedMetadataDescriptor(structDecl)) {
+      PendingPrespecializedTypeMetadata.push_back(type);
+      continue;
     }
+    emitPrespecializedStructMetadata(*IGM.get(), type);
+    emittedAny = true;
   }
+  return emittedAny;
 }
 
 /// Emit symbols for eliminated dead methods, which can still be referenced
@@ -1061,6 +1084,11 @@ SILLinkage LinkEntity::getLinkage(IRGenModule &IGM,
   switch (getKind()) {
   // Most type metadata depend on the formal linkage of their type.
   case Kind::ValueWitnessTable:
+    // The tables of generic instances are only emitted together with their
+    // statically instantiated metadata.
+    if (isa<BoundGenericType>(getType()))
+      return getNonUniqueSILLinkage(getTypeLinkage(getType()), forDefinition);
+    SWIFT_FALLTHROUGH;
   case Kind::TypeMangling:
     return getSILLinkage(getTypeLinkage(getType()), forDefinition);
 
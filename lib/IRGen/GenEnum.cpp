@@ -99,6 +99,7 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "enum-layout"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 #include "GenEnum.h"
@@ -127,6 +128,9 @@
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumSharedMultiPayloadEnumLayouts,
+          "Number of multi-payload enum layouts shared between IGMs");
+
 SpareBitVector getBitVectorFromAPInt(const APInt &bits, unsigned startBit = 0) {
   if (startBit == 0) {
     return SpareBitVector::fromAPInt(bits);
@@ -3244,18 +3248,87 @@ namespace {
       return {destructured.payload, destructured.extraTagBits, tag};
     }
 
+    /// Whether the runtime always stores the tag of the dynamic layout in a
+    /// single byte after the payload area, whatever the size of the payload.
+    bool hasSingleByteDynamicTag() const {
+      // The tag byte is found through the payload size in the metadata.
+      if (!needsPayloadSizeInMetadata())
+        return false;
+      // With an empty payload, every empty case needs its own tag value.
+      return ElementsWithPayload.size() + ElementsWithNoPayload.size() < 256;
+    }
+
+    /// Project the tag byte after the payload area of a value with dynamic
+    /// layout. The size of the payload area is stored in the metadata.
+    Address projectDynamicTagByte(IRGenFunction &IGF, Address addr,
+                                  llvm::Value *metadata, SILType T) const {
+      assert(hasSingleByteDynamicTag());
+      auto payloadSize = emitEnumPayloadSize(IGF,
+                                             T.getEnumOrBoundGenericEnum(),
+                                             metadata);
+      auto bytes = IGF.Builder.CreateBitCast(addr.getAddress(),
+                                             IGF.IGM.Int8PtrTy);
+      return Address(IGF.Builder.CreateInBoundsGEP(bytes, payloadSize),
+                     Alignment(1));
+    }
+
+    /// Load the tag byte of a value with dynamic layout, zero-extended to
+    /// an i32.
+    llvm::Value *loadDynamicTagByte(IRGenFunction &IGF, Address addr,
+                                    llvm::Value *metadata, SILType T) const {
+      auto tagAddr = projectDynamicTagByte(IGF, addr, metadata, T);
+      return IGF.Builder.CreateZExt(IGF.Builder.CreateLoad(tagAddr),
+                                    IGF.IGM.Int32Ty);
+    }
+
     /// Returns a tag index in the range [0..NumElements-1].
     llvm::Value *
     loadDynamicTag(IRGenFunction &IGF, Address addr, SILType T) const {
       addr = IGF.Builder.CreateBitCast(addr, IGF.IGM.OpaquePtrTy);
       auto metadata = IGF.emitTypeMetadataRef(T.getSwiftRValueType());
-      auto call = IGF.Builder.CreateCall(IGF.IGM.getGetEnumCaseMultiPayloadFn(),
-                                         {addr.getAddress(), metadata});
-      call->setDoesNotThrow();
-      call->addAttribute(llvm::AttributeSet::FunctionIndex,
-                         llvm::Attribute::ReadOnly);
-      
-      return call;
+
+      auto emitRuntimeCall = [&]() -> llvm::Value * {
+        auto call = IGF.Builder.CreateCall(
+                                       IGF.IGM.getGetEnumCaseMultiPayloadFn(),
+                                       {addr.getAddress(), metadata});
+        call->setDoesNotThrow();
+        call->addAttribute(llvm::AttributeSet::FunctionIndex,
+                           llvm::Attribute::ReadOnly);
+        return call;
+      };
+
+      if (!hasSingleByteDynamicTag())
+        return emitRuntimeCall();
+
+      // The tag byte is the tag index of a payload case.
+      auto tag = loadDynamicTagByte(IGF, addr, metadata, T);
+      if (ElementsWithNoPayload.empty())
+        return tag;
+
+      // The empty cases are further discriminated by the payload, which is
+      // left to the runtime.
+      unsigned numPayloadCases = ElementsWithPayload.size();
+      auto isPayloadCase = IGF.Builder.CreateICmpULT(tag,
+                    llvm::ConstantInt::get(IGF.IGM.Int32Ty, numPayloadCases));
+      auto payloadBB = IGF.Builder.GetInsertBlock();
+      auto emptyBB = IGF.createBasicBlock("empty-case");
+      auto contBB = IGF.createBasicBlock("tag-loaded");
+      IGF.Builder.CreateCondBr(isPayloadCase, contBB, emptyBB);
+
+      IGF.Builder.emitBlock(emptyBB);
+      llvm::Value *emptyTag;
+      {
+        ConditionalDominanceScope condition(IGF);
+        emptyTag = emitRuntimeCall();
+      }
+      emptyBB = IGF.Builder.GetInsertBlock();
+      IGF.Builder.CreateBr(contBB);
+
+      IGF.Builder.emitBlock(contBB);
+      auto phi = IGF.Builder.CreatePHI(IGF.IGM.Int32Ty, 2);
+      phi->addIncoming(tag, payloadBB);
+      phi->addIncoming(emptyTag, emptyBB);
+      return phi;
     }
 
     /// Returns a tag index in the range [0..ElementsWithPayload-1]
@@ -3271,6 +3344,13 @@ namespace {
         return extractPayloadTag(IGF, payload, extraTagBits);
       }
       
+      // The tag byte is the payload tag of a payload case; its value for an
+      // empty case doesn't matter.
+      if (hasSingleByteDynamicTag()) {
+        auto metadata = IGF.emitTypeMetadataRef(T.getSwiftRValueType());
+        return loadDynamicTagByte(IGF, addr, metadata, T);
+      }
+
       // Otherwise, ask the runtime to extract the dynamically-placed tag.
       return loadDynamicTag(IGF, addr, T);
     }
@@ -4204,9 +4284,8 @@ namespace {
             payloadTI.initializeWithCopy(IGF, destData, srcData, PayloadT);
 
           // Plant spare bit tag bits, if any, into the new value.
-          llvm::Value *tag = llvm::ConstantInt::get(IGF.IGM.Int32Ty, tagIndex);
           if (TIK < Fixed)
-            storeDynamicTag(IGF, dest, tag, T);
+            storeDynamicPayloadTag(IGF, dest, tagIndex, T);
           else
             storePayloadTag(IGF, dest, tagIndex, T);
 
@@ -4425,6 +4504,25 @@ namespace {
       call->setDoesNotThrow();
     }
 
+    /// Store the tag of the payload case with the given tag index into a
+    /// value with dynamic layout.
+    void storeDynamicPayloadTag(IRGenFunction &IGF, Address enumAddr,
+                                unsigned index, SILType T) const {
+      assert(TIK < Fixed && index < ElementsWithPayload.size());
+
+      // The tag of a payload case is just the tag byte.
+      if (hasSingleByteDynamicTag()) {
+        auto metadata = IGF.emitTypeMetadataRef(T.getSwiftRValueType());
+        auto tagAddr = projectDynamicTagByte(IGF, enumAddr, metadata, T);
+        IGF.Builder.CreateStore(llvm::ConstantInt::get(IGF.IGM.Int8Ty, index),
+                                tagAddr);
+        return;
+      }
+
+      auto tag = llvm::ConstantInt::get(IGF.IGM.Int32Ty, index);
+      storeDynamicTag(IGF, enumAddr, tag, T);
+    }
+
   public:
 
     void storeTag(IRGenFunction &IGF,
@@ -4435,6 +4533,9 @@ namespace {
 
       // Use the runtime to initialize dynamic cases.
       if (TIK < Fixed) {
+        if (index < ElementsWithPayload.size())
+          return storeDynamicPayloadTag(IGF, enumAddr, index, T);
+
         auto tag = llvm::ConstantInt::get(IGF.IGM.Int32Ty, index);
         return storeDynamicTag(IGF, enumAddr, tag, T);
       }
@@ -5603,6 +5704,29 @@ MultiPayloadEnumImplStrategy::completeFixedLayout(TypeConverter &TC,
   unsigned numPayloadTags = ElementsWithPayload.size();
   unsigned numEmptyElements = ElementsWithNoPayload.size();
 
+  // With multiple IRGenModules, another one may have laid out the enum
+  // already.
+  CanType enumType = Type.getSwiftRValueType();
+  if (auto *layout = TC.IGM.IRGen.getMultiPayloadEnumLayout(enumType)) {
+    ++NumSharedMultiPayloadEnumLayouts;
+    assert(PayloadTagBits.empty());
+    CommonSpareBits = layout->CommonSpareBits;
+    PayloadTagBits = layout->PayloadTagBits;
+    PayloadSize = layout->PayloadSize;
+    NumEmptyElementTags = layout->NumEmptyElementTags;
+    ExtraTagBitCount = layout->ExtraTagBitCount;
+    NumExtraTagValues = layout->NumExtraTagValues;
+
+    setTaggedEnumBody(TC.IGM, enumTy, CommonSpareBits.size(),
+                      ExtraTagBitCount);
+    applyLayoutAttributes(TC.IGM, enumType, /*fixed*/ true,
+                          layout->WorstAlignment);
+    return getFixedEnumTypeInfo(enumTy, layout->SizeWithTag,
+                                SpareBitVector(layout->SpareBits),
+                                layout->WorstAlignment, layout->POD,
+                                layout->BitwiseTakable);
+  }
+
   // See if the payload types have any spare bits in common.
   // At the end of the loop CommonSpareBits.size() will be the size (in bits)
   // of the largest payload.
@@ -5734,8 +5858,15 @@ MultiPayloadEnumImplStrategy::completeFixedLayout(TypeConverter &TC,
     assert(PayloadTagBits.count() == numTagBits);
   }
   
-  applyLayoutAttributes(TC.IGM, Type.getSwiftRValueType(), /*fixed*/ true,
-                        worstAlignment);
+  applyLayoutAttributes(TC.IGM, enumType, /*fixed*/ true, worstAlignment);
+
+  if (TC.IGM.IRGen.hasMultipleIGMs()) {
+    TC.IGM.IRGen.addMultiPayloadEnumLayout(enumType, {
+      CommonSpareBits, PayloadTagBits, spareBits, PayloadSize,
+      NumEmptyElementTags, ExtraTagBitCount, NumExtraTagValues,
+      Size(sizeWithTag), worstAlignment, isPOD, isBT
+    });
+  }
 
   return getFixedEnumTypeInfo(enumTy, Size(sizeWithTag), std::move(spareBits),
                               worstAlignment, isPOD, isBT);
@@ -269,17 +269,24 @@ static llvm::Constant *buildPrivateMetadata(IRGenModule &IGM,
     offset = Size(0);
   fields.push_back(llvm::ConstantInt::get(IGM.Int32Ty, offset.getValue()));
 
-  fields.push_back(captureDescriptor);
-
-  llvm::Constant *init =
-    llvm::ConstantStruct::get(IGM.FullBoxMetadataStructTy, fields);
-
   llvm::GlobalVariable *var =
     new llvm::GlobalVariable(IGM.Module, IGM.FullBoxMetadataStructTy,
                              /*constant*/ true,
-                             llvm::GlobalVariable::PrivateLinkage, init,
+                             llvm::GlobalVariable::PrivateLinkage,
+                             /*initializer*/ nullptr,
                              "metadata");
 
+  // The capture descriptor is referenced relative to the metadata, which
+  // keeps the metadata free of one rebase fixup per closure context.
+  if (captureDescriptor->isNullValue())
+    fields.push_back(llvm::ConstantInt::get(IGM.RelativeAddressTy, 0));
+  else
+    fields.push_back(IGM.emitDirectRelativeReference(captureDescriptor,
+                                                     var, { 4 }));
+
+  var->setInitializer(
+      llvm::ConstantStruct::get(IGM.FullBoxMetadataStructTy, fields));
+
   llvm::Constant *indices[] = {
     llvm::ConstantInt::get(IGM.Int32Ty, 0),
     llvm::ConstantInt::get(IGM.Int32Ty, 2)
@@ -387,6 +387,13 @@ static llvm::Value *emitNominalMetadataRef(IRGenFunction &IGF,
   assert(theType->isSpecialized() &&
          theType->getAnyNominal() == theDecl);
 
+  // The metadata of a concrete instantiation of a struct of this module can
+  // be emitted statically.
+  if (IGF.IGM.IRGen.Opts.PrespecializeGenericMetadata &&
+      isa<StructDecl>(theDecl) && !theType->hasArchetype() &&
+      theDecl->getModuleContext() == IGF.IGM.getSwiftModule())
+    IGF.IGM.IRGen.addPrespecializedTypeMetadata(theType);
+
   // Check to see if we've maybe got a local reference already.
   if (auto cache = IGF.tryGetLocalTypeData(theType,
                                            LocalTypeDataKind::forTypeMetadata()))
@@ -1162,6 +1169,53 @@ void irgen::emitLazyCacheAccessFunction(IRGenModule &IGM,
   IGF.Builder.CreateRet(phi);
 }
 
+llvm::Value *
+irgen::emitCallToLazyCacheAccessFunction(IRGenFunction &IGF,
+                                         llvm::Constant *accessor,
+                                         llvm::GlobalVariable *cacheVariable) {
+  auto emitCall = [&]() -> llvm::Value * {
+    llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
+    call->setCallingConv(IGF.IGM.DefaultCC);
+    call->setDoesNotAccessMemory();
+    call->setDoesNotThrow();
+    return call;
+  };
+
+  // Checking the cache inline trades code size for a call on every access
+  // after the first, which is only worth it when optimizing for speed.
+  auto &opts = IGF.IGM.IRGen.Opts;
+  if (!cacheVariable || !opts.Optimize || opts.OptimizeForSize)
+    return emitCall();
+
+  // The cache is loaded without ordering for the same reasons as in the
+  // access function; see emitLazyCacheAccessFunction.
+  Address cache(cacheVariable, IGF.IGM.getPointerAlignment());
+  auto load = IGF.Builder.CreateLoad(cache);
+  if (opts.Sanitize == SanitizerKind::Thread)
+    load->setOrdering(llvm::AtomicOrdering::Acquire);
+
+  auto null = llvm::ConstantPointerNull::get(
+                                       cast<llvm::PointerType>(load->getType()));
+  auto isNullBB = IGF.createBasicBlock("cacheIsNull");
+  auto contBB = IGF.createBasicBlock("cont");
+  IGF.Builder.CreateCondBr(IGF.Builder.CreateICmpEQ(load, null),
+                           isNullBB, contBB);
+  auto loadBB = IGF.Builder.GetInsertBlock();
+
+  IGF.Builder.emitBlock(isNullBB);
+  llvm::Value *result = emitCall();
+  if (result->getType() != load->getType())
+    result = IGF.Builder.CreateBitCast(result, load->getType());
+  IGF.Builder.CreateBr(contBB);
+  auto callBB = IGF.Builder.GetInsertBlock();
+
+  IGF.Builder.emitBlock(contBB);
+  auto phi = IGF.Builder.CreatePHI(load->getType(), 2);
+  phi->addIncoming(load, loadBB);
+  phi->addIncoming(result, callBB);
+  return phi;
+}
+
 static llvm::Value *emitGenericMetadataAccessFunction(IRGenFunction &IGF,
                                                       NominalTypeDecl *nominal,
                                                       GenericArguments &genericArgs) {
@@ -1484,15 +1538,24 @@ static llvm::Value *emitCallToTypeMetadataAccessFunction(IRGenFunction &IGF,
   
   llvm::Constant *accessor =
     getTypeMetadataAccessFunction(IGF.IGM, type, shouldDefine);
-  llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotAccessMemory();
-  call->setDoesNotThrow();
+
+  // If we defined the accessor, we know whether it has a cache variable,
+  // and can check that before making the call.  Accessors defined by other
+  // modules might not have one.
+  llvm::GlobalVariable *cacheVariable = nullptr;
+  if (shouldDefine && !isTypeMetadataAccessTrivial(IGF.IGM, type)) {
+    cacheVariable = dyn_cast<llvm::GlobalVariable>(
+        IGF.IGM.getAddrOfTypeMetadataLazyCacheVariable(type,
+                                                       NotForDefinition));
+  }
+  llvm::Value *result =
+    emitCallToLazyCacheAccessFunction(IGF, accessor, cacheVariable);
   
   // Save the metadata for future lookups.
-  IGF.setScopedLocalTypeData(type, LocalTypeDataKind::forTypeMetadata(), call);
+  IGF.setScopedLocalTypeData(type, LocalTypeDataKind::forTypeMetadata(),
+                             result);
   
-  return call;
+  return result;
 }
 
 /// Produce the type metadata pointer for the given type.
@@ -2889,7 +2952,7 @@ namespace {
 
     SmallVector<FillOp, 8> FillOps;
 
-    enum { TemplateHeaderFieldCount = 5 };
+    enum { TemplateHeaderFieldCount = 6 };
     enum { NumPrivateDataWords = swift::NumGenericMetadataPrivateDataWords };
     Size TemplateHeaderSize;
 
@@ -3029,7 +3092,7 @@ namespace {
 
     void layout() {
       TemplateHeaderSize =
-        ((NumPrivateDataWords + 1) * IGM.getPointerSize()) + Size(8);
+        ((NumPrivateDataWords + 2) * IGM.getPointerSize()) + Size(8);
 
       // Leave room for the header.
       auto header = this->reserveFields(TemplateHeaderFieldCount,
@@ -3078,6 +3141,9 @@ namespace {
       headerFields[Field++]
         = llvm::ConstantInt::get(IGM.Int16Ty, AddressPoint.getValue());
 
+      //   void * const *Prespecializations;
+      headerFields[Field++] = asImpl().getPrespecializationsInit();
+
       //   void *PrivateData[NumPrivateDataWords];
       headerFields[Field++] = getPrivateDataInit();
 
@@ -3118,6 +3184,12 @@ namespace {
     
     // Can be overridden by subclassers to emit other dependent metadata.
     void addDependentData() {}
+
+    // Can be overridden by subclassers which support statically instantiated
+    // metadata.
+    llvm::Constant *getPrespecializationsInit() {
+      return llvm::ConstantPointerNull::get(IGM.Int8PtrPtrTy);
+    }
     
   private:
     static llvm::Constant *makeArray(llvm::Type *eltTy,
@@ -4327,6 +4399,26 @@ llvm::Value *irgen::emitClassFieldOffset(IRGenFunction &IGF,
                                               IGF.IGM.SizeTy);
 }
 
+/// Given a reference to enum metadata of the given type, load the size of
+/// the payload area, which the runtime stores in the metadata of enums with
+/// dynamic multi-payload layout.
+llvm::Value *irgen::emitEnumPayloadSize(IRGenFunction &IGF,
+                                        EnumDecl *theEnum,
+                                        llvm::Value *metadata) {
+  /// A class for finding the payload size in an enum metadata object.
+  BEGIN_METADATA_SEARCHER_0(FindEnumPayloadSize, Enum)
+    void addPayloadSize() {
+      setTargetOffset();
+      super::addPayloadSize();
+    }
+  END_METADATA_SEARCHER()
+
+  int index = FindEnumPayloadSize(IGF.IGM, theEnum).getTargetIndex();
+  return emitInvariantLoadFromMetadataAtIndex(IGF, metadata, index,
+                                              IGF.IGM.SizeTy,
+                                              ".payloadSize");
+}
+
 /// Given a reference to class metadata of the given type,
 /// load the fragile instance size and alignment of the class.
 std::pair<llvm::Value *, llvm::Value *>
@@ -4910,12 +5002,25 @@ namespace {
                       StructMetadataBuilderBase<GenericStructMetadataBuilder>> {
 
     typedef GenericMetadataBuilderBase super;
+
+    llvm::Constant *Descriptor = nullptr;
                         
   public:
     GenericStructMetadataBuilder(IRGenModule &IGM, StructDecl *theStruct,
                                  llvm::GlobalVariable *relativeAddressBase)
       : super(IGM, theStruct, relativeAddressBase) {}
 
+    void addNominalTypeDescriptor() {
+      Descriptor = StructNominalTypeDescriptorBuilder(IGM, Target).emit();
+      addFarRelativeAddress(Descriptor);
+    }
+
+    llvm::Constant *getPrespecializationsInit() {
+      if (!IGM.IRGen.Opts.PrespecializeGenericMetadata)
+        return super::getPrespecializationsInit();
+      return IGM.getAddrOfPrespecializedMetadataList(Target, Descriptor);
+    }
+
     llvm::Value *emitAllocateMetadata(IRGenFunction &IGF,
                                       llvm::Value *metadataPattern,
                                       llvm::Value *arguments) {
@@ -5000,6 +5105,198 @@ void irgen::emitStructMetadata(IRGenModule &IGM, StructDecl *structDecl) {
                          std::move(tempBase));
 }
 
+namespace {
+  /// A builder for the statically instantiated metadata of a fully concrete
+  /// instance of a generic struct. The metadata is laid out as an entry of
+  /// the runtime's generic metadata cache: the key arguments, followed by the
+  /// entry header and the metadata.
+  class PrespecializedStructMetadataBuilder :
+    public StructMetadataBuilderBase<PrespecializedStructMetadataBuilder> {
+    typedef StructMetadataBuilderBase super;
+
+    CanType InstanceType;
+    SILType LoweredType;
+    ArrayRef<llvm::Constant *> Arguments;
+    llvm::Constant *Descriptor;
+    llvm::GlobalVariable *Base;
+    Size EntryOffset = Size::invalid();
+    Size AddressPoint = Size::invalid();
+
+  public:
+    PrespecializedStructMetadataBuilder(IRGenModule &IGM, CanType type,
+                                        ArrayRef<llvm::Constant *> arguments,
+                                        llvm::Constant *descriptor,
+                                        llvm::GlobalVariable *relativeAddressBase)
+      : super(IGM, cast<StructDecl>(type->getAnyNominal()),
+              relativeAddressBase),
+        InstanceType(type), LoweredType(IGM.getLoweredType(type)),
+        Arguments(arguments), Descriptor(descriptor),
+        Base(relativeAddressBase) {}
+
+    void layout() {
+      // The key arguments.
+      for (auto argument : Arguments)
+        addWord(argument);
+
+      // The cache entry header.
+      EntryOffset = getNextOffset();
+      auto value = reserveFields(1, IGM.getPointerSize());
+      addConstantWord(Arguments.size());
+
+      super::layout();
+
+      // The slot for the field type vector.
+      addWord(
+         llvm::ConstantPointerNull::get(IGM.TypeMetadataPtrTy->getPointerTo()));
+
+      llvm::Constant *addressPoint =
+        llvm::ConstantExpr::getInBoundsGetElementPtr(
+          IGM.Int8Ty, Base,
+          llvm::ConstantInt::get(IGM.Int32Ty, AddressPoint.getValue()));
+      claimReservation(value, 1)[0] =
+        llvm::ConstantExpr::getBitCast(addressPoint, IGM.TypeMetadataPtrTy);
+    }
+
+    /// The offset of the cache entry header in the emitted data.
+    Size getEntryOffset() const { return EntryOffset; }
+
+    void noteAddressPoint() { AddressPoint = getNextOffset(); }
+
+    void addValueWitnessTable() {
+      addWord(emitValueWitnessTable(IGM, InstanceType));
+    }
+
+    void addNominalTypeDescriptor() {
+      addFarRelativeAddress(Descriptor);
+    }
+
+    void addFieldOffset(VarDecl *var) {
+      llvm::Constant *offset =
+        emitPhysicalStructMemberFixedOffset(IGM, LoweredType, var);
+      assert(offset && "prespecialized metadata of non-fixed-layout struct");
+      addWord(offset);
+    }
+
+    void addGenericFields(NominalTypeDecl *typeDecl, Type type) {
+      super::addGenericFields(typeDecl, InstanceType);
+    }
+
+    void addGenericArgument(CanType type) {
+      addWord(tryEmitConstantTypeMetadataRef(IGM, type,
+                                             SymbolReferenceKind::Absolute)
+                .getDirectValue());
+    }
+
+    void flagUnfilledParent() {
+      llvm_unreachable("prespecialized metadata of nested struct");
+    }
+
+    void flagUnfilledFieldOffset() {
+      llvm_unreachable("prespecialized metadata of non-fixed-layout struct");
+    }
+  };
+}
+
+void irgen::emitPrespecializedStructMetadata(IRGenModule &IGM, CanType type) {
+  auto structDecl = cast<StructDecl>(type->getAnyNominal());
+  auto descriptor = IGM.getPrespecializedMetadataDescriptor(structDecl);
+  assert(descriptor && "metadata pattern not emitted into this module");
+
+  // The runtime instantiates the metadata of nested structs and of structs
+  // with conformance requirements.
+  GenericTypeRequirements requirements(IGM, structDecl);
+  if (requirements.hasParentType() ||
+      requirements.getNumTypeRequirements() !=
+        requirements.getStorageSizeInWords())
+    return;
+
+  // All the arguments must have constant metadata.
+  SmallVector<llvm::Constant *, 4> arguments;
+  bool allConstant = true;
+  auto subs = type->gatherAllSubstitutions(IGM.getSwiftModule(), nullptr);
+  requirements.enumerateFulfillments(IGM, subs,
+                  [&](unsigned reqtIndex, CanType argType,
+                      Optional<ProtocolConformanceRef> conf) {
+    auto argument = tryEmitConstantTypeMetadataRef(IGM, argType,
+                                                SymbolReferenceKind::Absolute);
+    if (argument)
+      arguments.push_back(argument.getDirectValue());
+    else
+      allConstant = false;
+  });
+  if (!allConstant)
+    return;
+
+  // The layout of the instance must not depend on the runtime.
+  if (!IGM.getTypeInfoForUnlowered(type).isFixedSize())
+    return;
+
+  auto tempBase = createTemporaryRelativeAddressBase(IGM);
+  PrespecializedStructMetadataBuilder builder(IGM, type, arguments, descriptor,
+                                              tempBase.get());
+  builder.layout();
+  auto init = builder.getInit();
+
+  // The field type vector slot is written at runtime.
+  auto var = new llvm::GlobalVariable(IGM.Module, init->getType(),
+                                      /*constant*/ false,
+                                      llvm::GlobalValue::PrivateLinkage, init,
+                                      llvm::Twine("prespecialized_metadata_")
+                                        + structDecl->getName().str());
+  var->setAlignment(IGM.getPointerAlignment().getValue());
+  replaceTemporaryRelativeAddressBase(IGM, std::move(tempBase), var);
+
+  auto entry = llvm::ConstantExpr::getInBoundsGetElementPtr(
+      IGM.Int8Ty, llvm::ConstantExpr::getBitCast(var, IGM.Int8PtrTy),
+      llvm::ConstantInt::get(IGM.Int32Ty,
+                             builder.getEntryOffset().getValue()));
+  IGM.addPrespecializedMetadataEntry(structDecl, entry);
+}
+
+llvm::Constant *
+IRGenModule::getAddrOfPrespecializedMetadataList(StructDecl *decl,
+                                                 llvm::Constant *descriptor) {
+  auto &list = PrespecializedMetadataLists[decl];
+  assert(!list.Placeholder && "metadata pattern emitted twice");
+
+  // The entries are only known after all the functions are emitted.
+  list.Placeholder =
+    new llvm::GlobalVariable(Module, Int8PtrTy, /*constant*/ true,
+                             llvm::GlobalValue::PrivateLinkage,
+                             llvm::ConstantPointerNull::get(Int8PtrTy),
+                             llvm::Twine("prespecialized_metadata_list_")
+                               + decl->getName().str());
+  list.Descriptor = descriptor;
+  return list.Placeholder;
+}
+
+void IRGenModule::emitPrespecializedMetadataLists() {
+  for (auto &entry : PrespecializedMetadataLists) {
+    auto &list = entry.second;
+    llvm::GlobalVariable *placeholder = list.Placeholder;
+    if (list.Entries.empty()) {
+      placeholder->replaceAllUsesWith(
+        llvm::ConstantPointerNull::get(placeholder->getType()));
+    } else {
+      SmallVector<llvm::Constant *, 4> elts(list.Entries.begin(),
+                                            list.Entries.end());
+      elts.push_back(llvm::ConstantPointerNull::get(Int8PtrTy));
+      auto init = llvm::ConstantArray::get(
+          llvm::ArrayType::get(Int8PtrTy, elts.size()), elts);
+      auto var = new llvm::GlobalVariable(Module, init->getType(),
+                                          /*constant*/ true,
+                                          llvm::GlobalValue::PrivateLinkage,
+                                          init);
+      var->setAlignment(getPointerAlignment().getValue());
+      var->takeName(placeholder);
+      placeholder->replaceAllUsesWith(
+        llvm::ConstantExpr::getBitCast(var, placeholder->getType()));
+    }
+    placeholder->eraseFromParent();
+  }
+  PrespecializedMetadataLists.clear();
+}
+
 // Enums
 
 namespace {
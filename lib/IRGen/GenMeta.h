@@ -74,6 +74,13 @@ namespace irgen {
                                    llvm::GlobalVariable *cacheVariable,
         const llvm::function_ref<llvm::Value *(IRGenFunction &IGF)> &getValue);
 
+  /// Emit a call to a lazy cache access function.  When optimizing for
+  /// speed, and the cache variable is known, the cache is checked inline
+  /// first, so that the call is only made until the value has been cached.
+  llvm::Value *emitCallToLazyCacheAccessFunction(IRGenFunction &IGF,
+                                                 llvm::Constant *accessor,
+                                          llvm::GlobalVariable *cacheVariable);
+
   /// Emit a declaration reference to a metatype object.
   void emitMetatypeRef(IRGenFunction &IGF, CanMetatypeType type,
                        Explosion &explosion);
@@ -132,6 +139,11 @@ namespace irgen {
   /// Emit the metadata associated with the given struct declaration.
   void emitStructMetadata(IRGenModule &IGM, StructDecl *theStruct);
 
+  /// Emit the metadata of a fully concrete instantiation of a generic struct
+  /// as constant data, if possible. The metadata pattern of the struct must
+  /// be emitted into \p IGM.
+  void emitPrespecializedStructMetadata(IRGenModule &IGM, CanType type);
+
   /// Emit the metadata associated with the given enum declaration.
   void emitEnumMetadata(IRGenModule &IGM, EnumDecl *theEnum);
 
@@ -180,6 +192,12 @@ namespace irgen {
                                     VarDecl *field,
                                     llvm::Value *metadata);
 
+  /// Given a reference to enum metadata of the given type, load the size of
+  /// the payload area.  The enum must have dynamic multi-payload layout.
+  llvm::Value *emitEnumPayloadSize(IRGenFunction &IGF,
+                                   EnumDecl *theEnum,
+                                   llvm::Value *metadata);
+
   /// Given a metatype value, read its instance type.
   llvm::Value *emitMetatypeInstanceType(IRGenFunction &IGF,
                                         llvm::Value *metatypeMetadata);
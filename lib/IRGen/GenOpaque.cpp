@@ -20,9 +20,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "swift/AST/IRGenOptions.h"
 
 #include "IRGenFunction.h"
 #include "IRGenModule.h"
@@ -476,19 +478,80 @@ llvm::Value *irgen::emitProjectBufferCall(IRGenFunction &IGF,
   return result;
 }
 
+/// In optimized code, branch on the value witness flags of a type and emit
+/// \p trivialCase instead of the value witness call if \p isTrivial is true
+/// at runtime. Generic code can then copy and destroy POD values without an
+/// indirect call. In unoptimized code, just emit the call.
+static void emitWithTrivialWitnessCheck(IRGenFunction &IGF,
+                            llvm::function_ref<llvm::Value *()> isTrivial,
+                            llvm::function_ref<void()> trivialCase,
+                            llvm::function_ref<void()> witnessCall) {
+  if (!IGF.IGM.IRGen.Opts.Optimize) {
+    witnessCall();
+    return;
+  }
+
+  llvm::Value *trivial = isTrivial();
+  auto trivialBB = IGF.createBasicBlock("trivial-witness");
+  auto callBB = IGF.createBasicBlock("call-witness");
+  auto contBB = IGF.createBasicBlock("cont");
+  IGF.Builder.CreateCondBr(trivial, trivialBB, callBB);
+
+  IGF.Builder.emitBlock(trivialBB);
+  {
+    ConditionalDominanceScope condition(IGF);
+    trivialCase();
+  }
+  IGF.Builder.CreateBr(contBB);
+
+  IGF.Builder.emitBlock(callBB);
+  {
+    ConditionalDominanceScope condition(IGF);
+    witnessCall();
+  }
+  IGF.Builder.CreateBr(contBB);
+
+  IGF.Builder.emitBlock(contBB);
+}
+
+/// Copy or move \p count values of type \p T as bytes.
+static void emitBitwiseCopy(IRGenFunction &IGF, SILType T,
+                            Address destObject, Address srcObject,
+                            llvm::Value *count, bool mayOverlap) {
+  llvm::Value *byteCount;
+  if (count)
+    byteCount = IGF.Builder.CreateNUWMul(emitLoadOfStride(IGF, T), count);
+  else
+    byteCount = emitLoadOfSize(IGF, T);
+  if (mayOverlap)
+    IGF.Builder.CreateMemMove(destObject.getAddress(), srcObject.getAddress(),
+                              byteCount, destObject.getAlignment().getValue());
+  else
+    IGF.Builder.CreateMemCpy(destObject.getAddress(), srcObject.getAddress(),
+                             byteCount, destObject.getAlignment().getValue());
+}
+
 /// Emit a call to do an 'initializeWithCopy' operation.
 void irgen::emitInitializeWithCopyCall(IRGenFunction &IGF,
                                        SILType T,
                                        Address destObject,
                                        Address srcObject) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                         ValueWitness::InitializeWithCopy);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, nullptr,
+                      /*mayOverlap*/ false);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+                                             ValueWitness::InitializeWithCopy);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 llvm::Value *irgen::emitInitializeBufferWithTakeCall(IRGenFunction &IGF,
@@ -528,14 +591,21 @@ void irgen::emitInitializeArrayWithCopyCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                         ValueWitness::InitializeArrayWithCopy);
-
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), count, metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, count,
+                      /*mayOverlap*/ false);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+                             ValueWitness::InitializeArrayWithCopy);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), count, metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do an 'initializeWithTake' operation.
@@ -544,13 +614,21 @@ void irgen::emitInitializeWithTakeCall(IRGenFunction &IGF,
                                        Address destObject,
                                        Address srcObject) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                            ValueWitness::InitializeWithTake);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsBitwiseTakable(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, nullptr,
+                      /*mayOverlap*/ false);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+                                             ValueWitness::InitializeWithTake);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do an 'initializeArrayWithTakeFrontToBack' operation.
@@ -560,13 +638,21 @@ void irgen::emitInitializeArrayWithTakeFrontToBackCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsBitwiseTakable(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, count,
+                      /*mayOverlap*/ true);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
                              ValueWitness::InitializeArrayWithTakeFrontToBack);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), count, metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), count, metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do an 'initializeArrayWithTakeBackToFront' operation.
@@ -576,13 +662,21 @@ void irgen::emitInitializeArrayWithTakeBackToFrontCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsBitwiseTakable(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, count,
+                      /*mayOverlap*/ true);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
                              ValueWitness::InitializeArrayWithTakeBackToFront);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), count, metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), count, metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do an 'assignWithCopy' operation.
@@ -603,13 +697,21 @@ void irgen::emitAssignWithCopyCall(IRGenFunction &IGF,
                                    Address destObject,
                                    Address srcObject) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                         ValueWitness::AssignWithCopy);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, nullptr,
+                      /*mayOverlap*/ true);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+                                             ValueWitness::AssignWithCopy);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do an 'assignWithTake' operation.
@@ -618,13 +720,21 @@ void irgen::emitAssignWithTakeCall(IRGenFunction &IGF,
                                    Address destObject,
                                    Address srcObject) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                         ValueWitness::AssignWithTake);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
-      {destObject.getAddress(), srcObject.getAddress(), metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotThrow();
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {
+      emitBitwiseCopy(IGF, T, destObject, srcObject, nullptr,
+                      /*mayOverlap*/ true);
+    },
+    [&] {
+      llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
+                                             ValueWitness::AssignWithTake);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(copyFn,
+          {destObject.getAddress(), srcObject.getAddress(), metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotThrow();
+    });
 }
 
 /// Emit a call to do a 'destroy' operation.
@@ -632,12 +742,17 @@ void irgen::emitDestroyCall(IRGenFunction &IGF,
                             SILType T,
                             Address object) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
-                                   ValueWitness::Destroy);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(fn, {object.getAddress(), metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  setHelperAttributes(call);
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {},
+    [&] {
+      llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
+                                       ValueWitness::Destroy);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(fn, {object.getAddress(), metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      setHelperAttributes(call);
+    });
 }
 
 /// Emit a call to do a 'destroyArray' operation.
@@ -646,12 +761,17 @@ void irgen::emitDestroyArrayCall(IRGenFunction &IGF,
                                  Address object,
                                  llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
-                                   ValueWitness::DestroyArray);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(fn, {object.getAddress(), count, metadata});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  setHelperAttributes(call);
+  emitWithTrivialWitnessCheck(IGF,
+    [&] { return emitLoadOfIsPOD(IGF, T); },
+    [&] {},
+    [&] {
+      llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
+                                       ValueWitness::DestroyArray);
+      llvm::CallInst *call =
+        IGF.Builder.CreateCall(fn, {object.getAddress(), count, metadata});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      setHelperAttributes(call);
+    });
 }
 
 /// Emit a call to do a 'destroyBuffer' operation.
@@ -1042,12 +1042,10 @@ public:
     // Otherwise, call a lazy-cache function.
     auto accessor =
       getWitnessTableLazyAccessFunction(IGF.IGM, Conformance, type);
-    llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
-    call->setCallingConv(IGF.IGM.DefaultCC);
-    call->setDoesNotAccessMemory();
-    call->setDoesNotThrow();
-
-    return call;
+    auto cacheVariable = dyn_cast<llvm::GlobalVariable>(
+      IGF.IGM.getAddrOfWitnessTableLazyCacheVariable(Conformance, type,
+                                                     NotForDefinition));
+    return emitCallToLazyCacheAccessFunction(IGF, accessor, cacheVariable);
   }
 
   llvm::Constant *tryGetConstantTable(IRGenModule &IGM,
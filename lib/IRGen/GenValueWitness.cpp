@@ -1359,8 +1359,11 @@ static void addValueWitnessesForAbstractType(IRGenModule &IGM,
 /// be non-dependent.
 llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
                                              CanType abstractType) {
-  // We shouldn't emit global value witness tables for generic type instances.
-  assert(!isa<BoundGenericType>(abstractType) &&
+  // We shouldn't emit global value witness tables for generic type instances,
+  // except for fully concrete instances whose metadata is emitted statically.
+  assert((!isa<BoundGenericType>(abstractType) ||
+          (!abstractType->hasArchetype() &&
+           !abstractType->hasTypeParameter())) &&
          "emitting VWT for generic instance");
 
   SmallVector<llvm::Constant*, MaxNumValueWitnesses> witnesses;
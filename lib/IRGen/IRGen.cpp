@@ -44,11 +44,13 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Target/TargetMachine.h"
@@ -120,6 +122,8 @@ swift::getIRTargetOptions(IRGenOptions &Opts, ASTContext &Ctx) {
   //   - code model
   // FIXME: We should do this entirely through Clang, for consistency.
   TargetOptions TargetOpts;
+  TargetOpts.FunctionSections = Opts.FunctionSections;
+  TargetOpts.DataSections = Opts.FunctionSections;
 
   auto *Clang = static_cast<ClangImporter *>(Ctx.getClangModuleLoader());
   clang::TargetOptions &ClangOpts = Clang->getTargetInfo().getTargetOpts();
@@ -143,7 +147,13 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   // Set up a pipeline.
   PassManagerBuilderWrapper PMBuilder(Opts);
 
-  if (Opts.Optimize && !Opts.DisableLLVMOptzns) {
+  if (Opts.Optimize && Opts.OptimizeForSize && !Opts.DisableLLVMOptzns) {
+    // Like clang's -Os: no vectorization and an inliner tuned for size.
+    PMBuilder.OptLevel = 2;
+    PMBuilder.SizeLevel = 1;
+    PMBuilder.Inliner = llvm::createFunctionInliningPass(2, 1);
+    PMBuilder.MergeFunctions = true;
+  } else if (Opts.Optimize && !Opts.DisableLLVMOptzns) {
     PMBuilder.OptLevel = 3;
     PMBuilder.Inliner = llvm::createFunctionInliningPass(200);
     PMBuilder.SLPVectorize = true;
@@ -293,6 +303,16 @@ static void getHashOfModule(MD5::MD5Result &Result, IRGenOptions &Opts,
   HashStream.final(Result);
 }
 
+std::string swift::getLLVMModuleHash(IRGenOptions &Opts, ASTContext &Ctx,
+                                     llvm::Module *Module) {
+  MD5::MD5Result Result;
+  getHashOfModule(Result, Opts, Module, /*TargetMachine=*/nullptr,
+                  Ctx.LangOpts.EffectiveLanguageVersion);
+  SmallString<32> ResultStr;
+  MD5::stringifyResult(Result, ResultStr);
+  return ResultStr.str();
+}
+
 /// Returns false if the hash of the current module \p HashData matches the
 /// hash which is stored in an existing output object file.
 static bool needsRecompile(StringRef OutputFilename, ArrayRef<uint8_t> HashData,
@@ -343,6 +363,62 @@ static bool needsRecompile(StringRef OutputFilename, ArrayRef<uint8_t> HashData,
   return true;
 }
 
+/// Returns the path of the object file generated from the LLVM IR with the
+/// hash \p HashData in the object cache directory \p CachePath.
+static std::string getCachedObjectPath(StringRef CachePath,
+                                       MD5::MD5Result &HashData) {
+  SmallString<32> HashStr;
+  MD5::stringifyResult(HashData, HashStr);
+  SmallString<128> Path(CachePath);
+  llvm::sys::path::append(Path, HashStr + ".o");
+  return Path.str();
+}
+
+/// Copies the file \p From to \p To through a temporary file, so that no
+/// other process sees a partially written file at \p To.
+/// \returns true on error, false on success
+static bool copyFileAtomically(StringRef From, StringRef To) {
+  auto Buffer = llvm::MemoryBuffer::getFile(From, /*FileSize*/ -1,
+                                            /*RequiresNullTerminator*/ false);
+  if (!Buffer)
+    return true;
+
+  int FD;
+  SmallString<128> TempFilename;
+  if (llvm::sys::fs::createUniqueFile(To + "-%%%%%%%%.tmp", FD, TempFilename))
+    return true;
+  llvm::FileRemover TempFileRemover(TempFilename);
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << (*Buffer)->getBuffer();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      return true;
+    }
+  }
+  if (llvm::sys::fs::rename(TempFilename, To))
+    return true;
+  TempFileRemover.releaseFile();
+  return false;
+}
+
+/// Returns true if the output file \p OutputFilename should be written to a
+/// temporary file first and then moved into place.
+///
+/// This is done in multi-threaded compilation, where an error or a crash in
+/// one thread would otherwise leave truncated object files behind from the
+/// others. Only regular files can be replaced this way.
+static bool shouldWriteThroughTemporary(StringRef OutputFilename,
+                                        llvm::sys::Mutex *DiagMutex) {
+  if (!DiagMutex || OutputFilename == "-")
+    return false;
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(OutputFilename, Status))
+    return true;
+  return llvm::sys::fs::is_regular_file(Status);
+}
+
 /// Run the LLVM passes. In multi-threaded compilation this will be done for
 /// multiple LLVM modules in parallel.
 static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
@@ -352,6 +428,9 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::TargetMachine *TargetMachine,
                         version::Version const& effectiveLanguageVersion,
                         StringRef OutputFilename) {
+  // The object file in the object cache to be written after codegen.
+  std::string CachedObjectPath;
+
   if (Opts.UseIncrementalLLVMCodeGen && HashGlobal) {
     // Check if we can skip the llvm part of the compilation if we have an
     // existing object file which was generated from the same llvm IR.
@@ -375,6 +454,22 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
       return false;
     }
 
+    // Check if an object file generated from the same llvm IR is in the
+    // object cache, e.g. from a build of another branch.
+    if (Opts.OutputKind == IRGenOutputKind::ObjectFile &&
+        !Opts.PrintInlineTree && !Opts.ObjectCachePath.empty() &&
+        !OutputFilename.empty() && OutputFilename != "-") {
+      CachedObjectPath = getCachedObjectPath(Opts.ObjectCachePath, Result);
+      if (!copyFileAtomically(CachedObjectPath, OutputFilename)) {
+        DEBUG(
+          if (DiagMutex) DiagMutex->lock();
+          llvm::dbgs() << OutputFilename << ": copied from object cache\n";
+          if (DiagMutex) DiagMutex->unlock();
+        );
+        return false;
+      }
+    }
+
     // Store the hash in the global variable so that it is written into the
     // object file.
     auto *HashConstant = ConstantDataArray::get(Module->getContext(), HashData);
@@ -383,12 +478,29 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
 
   llvm::SmallString<0> Buffer;
   std::unique_ptr<raw_pwrite_stream> RawOS;
+  llvm::SmallString<128> TempFilename;
+  llvm::FileRemover TempFileRemover;
   if (!OutputFilename.empty()) {
     // Try to open the output file.  Clobbering an existing file is fine.
     // Open in binary mode if we're doing binary output.
     llvm::sys::fs::OpenFlags OSFlags = llvm::sys::fs::F_None;
     std::error_code EC;
-    auto *FDOS = new raw_fd_ostream(OutputFilename, EC, OSFlags);
+    raw_fd_ostream *FDOS;
+    if (shouldWriteThroughTemporary(OutputFilename, DiagMutex)) {
+      int FD;
+      EC = llvm::sys::fs::createUniqueFile(OutputFilename + "-%%%%%%%%.tmp",
+                                           FD, TempFilename);
+      if (EC) {
+        // Fall back to writing the output directly.
+        TempFilename.clear();
+        FDOS = new raw_fd_ostream(OutputFilename, EC, OSFlags);
+      } else {
+        FDOS = new raw_fd_ostream(FD, /*shouldClose=*/true);
+        TempFileRemover.setFile(TempFilename);
+      }
+    } else {
+      FDOS = new raw_fd_ostream(OutputFilename, EC, OSFlags);
+    }
     RawOS.reset(FDOS);
     if (FDOS->has_error() || EC) {
       if (DiagMutex)
@@ -458,6 +570,30 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     SharedTimer timer("LLVM output");
     EmitPasses.run(*Module);
   }
+
+  if (!TempFilename.empty()) {
+    // Close the temporary file and move it into place.
+    RawOS.reset();
+    if (std::error_code EC = llvm::sys::fs::rename(TempFilename,
+                                                   OutputFilename)) {
+      if (DiagMutex)
+        DiagMutex->lock();
+      Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                     OutputFilename, EC.message());
+      if (DiagMutex)
+        DiagMutex->unlock();
+      return true;
+    }
+    TempFileRemover.releaseFile();
+  }
+
+  if (!CachedObjectPath.empty()) {
+    // Keep a copy of the object file in the object cache. Failing to do so
+    // only means that the next compilation doesn't find it.
+    RawOS.reset();
+    llvm::sys::fs::create_directories(Opts.ObjectCachePath);
+    copyFileAtomically(OutputFilename, CachedObjectPath);
+  }
   return false;
 }
 
@@ -571,9 +707,13 @@ static void initLLVMModule(const IRGenModule &IGM) {
 
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
+///
+/// If \p SILModToFree is not null, it owns \p SILMod, which is then freed
+/// once the LLVM IR is generated and before the LLVM passes run.
 static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
                                                          swift::Module *M,
                                                          SILModule *SILMod,
+                                        std::unique_ptr<SILModule> SILModToFree,
                                                          StringRef ModuleName,
                                                  llvm::LLVMContext &LLVMContext,
                                                        SourceFile *SF = nullptr,
@@ -665,6 +805,10 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  // The SIL module is not needed anymore. Free it before the LLVM passes,
+  // which is where the peak memory usage is reached.
+  SILModToFree.reset();
+
   embedBitcode(IGM.getModule(), Opts);
 
   if (performLLVM(Opts, IGM.Context.Diags, nullptr, IGM.ModuleHash,
@@ -701,9 +845,13 @@ static void ThreadEntryPoint(IRGenerator *irgen,
 
 /// Generates LLVM IR, runs the LLVM passes and produces the output files.
 /// All this is done in multiple threads.
+///
+/// If \p SILModToFree is not null, it owns \p SILMod, which is then freed
+/// once the LLVM IR is generated and before the LLVM passes run.
 static void performParallelIRGeneration(IRGenOptions &Opts,
                                         swift::Module *M,
                                         SILModule *SILMod,
+                                        std::unique_ptr<SILModule> SILModToFree,
                                         StringRef ModuleName, int numThreads) {
 
   IRGenerator irgen(Opts, *SILMod);
@@ -875,6 +1023,12 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  // The SIL module is not needed anymore. Free it before the LLVM passes,
+  // which is where the peak memory usage is reached.
+  SILModToFree.reset();
+
+  irgen.sortQueueBySize();
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -893,25 +1047,56 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
 }
 
 
-std::unique_ptr<llvm::Module> swift::
-performIRGeneration(IRGenOptions &Opts, swift::Module *M, SILModule *SILMod,
-                    StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+static std::unique_ptr<llvm::Module>
+performWholeModuleIRGeneration(IRGenOptions &Opts, swift::Module *M,
+                               SILModule *SILMod,
+                               std::unique_ptr<SILModule> SILModToFree,
+                               StringRef ModuleName,
+                               llvm::LLVMContext &LLVMContext) {
   int numThreads = SILMod->getOptions().NumThreads;
   if (numThreads != 0) {
-    ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads);
+    ::performParallelIRGeneration(Opts, M, SILMod, std::move(SILModToFree),
+                                  ModuleName, numThreads);
     // TODO: Parallel LLVM compilation cannot be used if a (single) module is
     // needed as return value.
     return nullptr;
   }
-  return ::performIRGeneration(Opts, M, SILMod, ModuleName, LLVMContext);
+  return ::performIRGeneration(Opts, M, SILMod, std::move(SILModToFree),
+                               ModuleName, LLVMContext);
+}
+
+std::unique_ptr<llvm::Module> swift::
+performIRGeneration(IRGenOptions &Opts, swift::Module *M, SILModule *SILMod,
+                    StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+  return performWholeModuleIRGeneration(Opts, M, SILMod, nullptr, ModuleName,
+                                        LLVMContext);
+}
+
+std::unique_ptr<llvm::Module> swift::
+performIRGeneration(IRGenOptions &Opts, swift::Module *M,
+                    std::unique_ptr<SILModule> SILMod,
+                    StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+  SILModule *SILModPtr = SILMod.get();
+  return performWholeModuleIRGeneration(Opts, M, SILModPtr, std::move(SILMod),
+                                        ModuleName, LLVMContext);
 }
 
 std::unique_ptr<llvm::Module> swift::
 performIRGeneration(IRGenOptions &Opts, SourceFile &SF, SILModule *SILMod,
                     StringRef ModuleName, llvm::LLVMContext &LLVMContext,
                     unsigned StartElem) {
-  return ::performIRGeneration(Opts, SF.getParentModule(), SILMod, ModuleName,
-                               LLVMContext, &SF, StartElem);
+  return ::performIRGeneration(Opts, SF.getParentModule(), SILMod, nullptr,
+                               ModuleName, LLVMContext, &SF, StartElem);
+}
+
+std::unique_ptr<llvm::Module> swift::
+performIRGeneration(IRGenOptions &Opts, SourceFile &SF,
+                    std::unique_ptr<SILModule> SILMod,
+                    StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+  SILModule *SILModPtr = SILMod.get();
+  return ::performIRGeneration(Opts, SF.getParentModule(), SILModPtr,
+                               std::move(SILMod), ModuleName, LLVMContext,
+                               &SF);
 }
 
 void
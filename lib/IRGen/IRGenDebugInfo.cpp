@@ -398,8 +398,12 @@ llvm::DIScope *IRGenDebugInfo::getOrCreateScope(const SILDebugScope *DS) {
   llvm::DIScope *Parent = getOrCreateScope(ParentScope);
   assert(isa<llvm::DILocalScope>(Parent) && "not a local scope");
 
-  if (Opts.DebugInfoKind <= IRGenDebugInfoKind::LineTables)
+  // Line tables don't have lexical blocks. Cache the enclosing scope, so that
+  // the chain of parents is only walked once.
+  if (Opts.DebugInfoKind <= IRGenDebugInfoKind::LineTables) {
+    ScopeCache[DS] = llvm::TrackingMDNodeRef(Parent);
     return Parent;
+  }
 
   assert(DS->Parent && "lexical block must have a parent subprogram");
   auto L = getStartLocation(DS->Loc, SM);
@@ -1035,7 +1039,9 @@ StringRef IRGenDebugInfo::getMangledName(DebugTypeInfo DbgTy) {
 
   Mangle::Mangler M(/* DWARF */ true);
   M.mangleTypeForDebugger(DbgTy.getType(), DbgTy.getDeclContext());
-  return BumpAllocatedString(M.finalize());
+  // The mangled name is also the unique identifier of the type, which is
+  // uniqued in the LLVMContext. Use its storage instead of another copy.
+  return llvm::MDString::get(IGM.getLLVMContext(), M.finalize())->getString();
 }
 
 llvm::DIDerivedType *
@@ -1811,6 +1817,8 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
     UID = llvm::MDString::get(IGM.getLLVMContext(), MangledName);
     if (llvm::Metadata *CachedTy = DIRefMap.lookup(UID)) {
       auto DITy = cast<llvm::DIType>(CachedTy);
+      // Cache it for this TypeBase*, too, so that it is not mangled again.
+      DITypeCache.insert({DbgTy.getType(), llvm::TrackingMDNodeRef(DITy)});
       return DITy;
     }
   }
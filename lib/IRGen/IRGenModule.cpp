@@ -256,7 +256,7 @@ IRGenModule::IRGenModule(IRGenerator &irgen,
     WitnessTablePtrTy,
     TypeMetadataStructTy,
     Int32Ty,
-    CaptureDescriptorPtrTy,
+    RelativeAddressTy,
   });
   FullBoxMetadataPtrTy = FullBoxMetadataStructTy->getPointerTo(DefaultAS);
 
@@ -742,6 +742,13 @@ llvm::AttributeSet IRGenModule::constructInitialAttributes() {
         "no-frame-pointer-elim-non-leaf");
   }
 
+  // Let the code generator optimize for size.
+  if (IRGen.Opts.OptimizeForSize) {
+    attrsUpdated = attrsUpdated.addAttribute(LLVMContext,
+                     llvm::AttributeSet::FunctionIndex,
+                     llvm::Attribute::OptimizeForSize);
+  }
+
   // Add target-cpu and target-features if they are non-null.
   auto *Clang = static_cast<ClangImporter *>(Context.getClangModuleLoader());
   clang::TargetOptions &ClangOpts = Clang->getTargetInfo().getTargetOpts();
@@ -1037,6 +1044,7 @@ bool IRGenModule::finalize() {
     }
     addUsedGlobal(ModuleHash);
   }
+  emitPrespecializedMetadataLists();
   emitLazyPrivateDefinitions();
 
   // Finalize clang IR-generation.
@@ -1111,10 +1119,46 @@ IRGenModule *IRGenerator::getGenModule(SILFunction *f) {
       return IGM;
     }
   }
-  // We have no source file for the function.
-  // Let's use the IGM from which the function is referenced the first time.
+  // We have no source file for the function. A function with shared linkage
+  // (such as a specialization or a thunk) can live in any LLVM module, so put
+  // it into the one with the least code so far. Much of the code in an
+  // optimized module is in such functions, so this keeps the LLVM threads
+  // evenly loaded.
+  if (hasSharedVisibility(f->getLinkage())) {
+    IRGenModule *Smallest = nullptr;
+    size_t SmallestSize = 0;
+    for (IRGenModule *IGM : Queue) {
+      size_t Size = EmittedSILInstructions.lookup(IGM);
+      if (!Smallest || Size < SmallestSize) {
+        Smallest = IGM;
+        SmallestSize = Size;
+      }
+    }
+    return Smallest;
+  }
+
+  // Otherwise let's use the IGM from which the function is referenced the
+  // first time.
   if (IRGenModule *IGM = DefaultIGMForFunction[f])
     return IGM;
 
   return getPrimaryIGM();
 }
+
+void IRGenerator::noteEmittedFunction(IRGenModule *IGM, SILFunction *f) {
+  if (!hasMultipleIGMs())
+    return;
+
+  size_t NumInstructions = 0;
+  for (SILBasicBlock &BB : *f)
+    NumInstructions += std::distance(BB.begin(), BB.end());
+  EmittedSILInstructions[IGM] += NumInstructions;
+}
+
+void IRGenerator::sortQueueBySize() {
+  std::stable_sort(Queue.begin(), Queue.end(),
+                   [&](IRGenModule *LHS, IRGenModule *RHS) {
+    return EmittedSILInstructions.lookup(LHS) >
+           EmittedSILInstructions.lookup(RHS);
+  });
+}
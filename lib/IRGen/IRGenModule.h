@@ -27,6 +27,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -159,6 +160,25 @@ public:
   bool hasFlags() const { return Info.getInt() != 0; }
 };
 
+/// The layout of a fixed-size multi-payload enum.
+///
+/// It only depends on the enum type and the layouts of its payloads, which are
+/// the same in all IRGenModules of an IRGenerator. It is computed by the first
+/// IRGenModule which lays out the enum and reused by the others.
+struct FixedMultiPayloadEnumLayout {
+  SpareBitVector CommonSpareBits;
+  SpareBitVector PayloadTagBits;
+  SpareBitVector SpareBits;
+  unsigned PayloadSize;
+  unsigned NumEmptyElementTags;
+  unsigned ExtraTagBitCount;
+  unsigned NumExtraTagValues;
+  Size SizeWithTag;
+  Alignment WorstAlignment;
+  IsPOD_t POD;
+  IsBitwiseTakable_t BitwiseTakable;
+};
+
 /// The principal singleton which manages all of IR generation.
 ///
 /// The IRGenerator delegates the emission of different top-level entities
@@ -212,9 +232,27 @@ private:
   /// appear in the translation unit.
   llvm::DenseMap<SILFunction*, unsigned> FunctionOrder;
 
+  /// The number of SIL instructions in the functions emitted into each
+  /// IRGenModule so far. Used to balance the IRGenModules' sizes in
+  /// multi-threaded compilation.
+  llvm::DenseMap<IRGenModule *, size_t> EmittedSILInstructions;
+
+  /// The fully concrete instantiations of generic structs whose metadata may
+  /// be emitted statically.
+  llvm::SmallPtrSet<CanType, 4> PrespecializedTypeMetadata;
+
+  /// The instantiations whose metadata isn't emitted yet, because the
+  /// metadata pattern of their struct isn't emitted yet.
+  llvm::SmallVector<CanType, 4> PendingPrespecializedTypeMetadata;
+
   /// The queue of IRGenModules for multi-threaded compilation.
   SmallVector<IRGenModule *, 8> Queue;
 
+  /// The layouts of fixed-size multi-payload enums, shared by all
+  /// IRGenModules. IR is generated for one IRGenModule at a time, so this
+  /// doesn't need a lock.
+  llvm::DenseMap<CanType, FixedMultiPayloadEnumLayout> MultiPayloadEnumLayouts;
+
   std::atomic<int> QueueIndex;
   
   friend class CurrentIGMPtr;  
@@ -242,10 +280,14 @@ public:
 
   /// Get an IRGenModule for a function.
   /// Returns the IRGenModule of the containing source file, or if this cannot
-  /// be determined, returns the IGM from which the function is referenced the
+  /// be determined, returns the smallest IGM for a function with shared
+  /// linkage, and otherwise the IGM from which the function is referenced the
   /// first time.
   IRGenModule *getGenModule(SILFunction *f);
 
+  /// Records that \p f has been emitted into \p IGM.
+  void noteEmittedFunction(IRGenModule *IGM, SILFunction *f);
+
   /// Returns the primary IRGenModule. This is the first added IRGenModule.
   /// It is used for everything which cannot be correlated to a specific source
   /// file. And of course, in single-threaded compilation there is only the
@@ -256,6 +298,21 @@ public:
   }
   
   bool hasMultipleIGMs() const { return GenModules.size() >= 2; }
+
+  /// Returns the layout of the multi-payload enum \p type if it was already
+  /// computed by one of the IRGenModules, or null.
+  const FixedMultiPayloadEnumLayout *
+  getMultiPayloadEnumLayout(CanType type) const {
+    auto it = MultiPayloadEnumLayouts.find(type);
+    if (it == MultiPayloadEnumLayouts.end())
+      return nullptr;
+    return &it->second;
+  }
+
+  void addMultiPayloadEnumLayout(CanType type,
+                                 FixedMultiPayloadEnumLayout &&layout) {
+    MultiPayloadEnumLayouts.insert({type, std::move(layout)});
+  }
   
   llvm::DenseMap<SourceFile *, IRGenModule *>::iterator begin() {
     return GenModules.begin();
@@ -298,6 +355,16 @@ public:
     if (LazilyEmittedTypeMetadata.insert(type).second)
       LazyTypeMetadata.push_back(type);
   }
+
+  void addPrespecializedTypeMetadata(CanType type) {
+    if (PrespecializedTypeMetadata.insert(type).second)
+      PendingPrespecializedTypeMetadata.push_back(type);
+  }
+
+  /// Emit the statically instantiated metadata of the pending instantiations
+  /// whose metadata pattern is emitted by now. Returns true if any metadata
+  /// was emitted.
+  bool emitPrespecializedTypeMetadata();
   
   void addLazyFieldTypeAccessor(NominalTypeDecl *type,
                                 ArrayRef<FieldTypeInfo> fieldTypes,
@@ -315,6 +382,11 @@ public:
     return it->second;
   }
   
+  /// Orders the queue for multi-threaded compilation so that the largest
+  /// IRGenModules are compiled first, and a big one doesn't end up running
+  /// alone after all the others have finished.
+  void sortQueueBySize();
+
   /// In multi-threaded compilation fetch the next IRGenModule from the queue.
   IRGenModule *fetchFromQueue() {
     int idx = QueueIndex++;
@@ -629,6 +701,26 @@ public:
   void addLazyFieldTypeAccessor(NominalTypeDecl *type,
                                 ArrayRef<FieldTypeInfo> fieldTypes,
                                 llvm::Function *fn);
+
+  /// Get the list of statically instantiated metadata which is referenced
+  /// from the metadata pattern of \p decl.
+  llvm::Constant *getAddrOfPrespecializedMetadataList(StructDecl *decl,
+                                                  llvm::Constant *descriptor);
+
+  /// Returns the nominal type descriptor of \p decl if its metadata pattern
+  /// is emitted into this module with a list of statically instantiated
+  /// metadata, or null.
+  llvm::Constant *getPrespecializedMetadataDescriptor(StructDecl *decl) const {
+    auto it = PrespecializedMetadataLists.find(decl);
+    if (it == PrespecializedMetadataLists.end())
+      return nullptr;
+    return it->second.Descriptor;
+  }
+
+  void addPrespecializedMetadataEntry(StructDecl *decl, llvm::Constant *entry) {
+    PrespecializedMetadataLists[decl].Entries.push_back(entry);
+  }
+
   llvm::Constant *emitProtocolConformances();
   llvm::Constant *emitTypeMetadataRecords();
 
@@ -686,6 +778,19 @@ private:
   SmallVector<NormalProtocolConformance *, 4> ProtocolConformances;
   /// List of nominal types to generate type metadata records for.
   SmallVector<CanType, 4> RuntimeResolvableTypes;
+
+  /// The statically instantiated metadata of a generic struct.
+  struct PrespecializedMetadataList {
+    /// Stands in for the list in the metadata pattern until the module is
+    /// finalized.
+    llvm::GlobalVariable *Placeholder = nullptr;
+    /// The nominal type descriptor of the struct.
+    llvm::Constant *Descriptor = nullptr;
+    /// The cache entries of the instantiations, as i8*.
+    SmallVector<llvm::Constant *, 4> Entries;
+  };
+  llvm::MapVector<StructDecl *, PrespecializedMetadataList>
+    PrespecializedMetadataLists;
   /// List of ExtensionDecls corresponding to the generated
   /// categories.
   SmallVector<ExtensionDecl*, 4> ObjCCategoryDecls;
@@ -995,6 +1100,7 @@ private:
                                         SymbolReferenceKind refKind);
 
   void emitLazyPrivateDefinitions();
+  void emitPrespecializedMetadataLists();
   void addRuntimeResolvableType(CanType type);
 
 //--- Global context emission --------------------------------------------------
@@ -1347,6 +1347,13 @@ void IRGenSILFunction::emitSILFunction() {
   if (IGM.DebugInfo)
     IGM.DebugInfo->emitFunction(*CurSILFn, CurFn);
 
+  // Pass profile data on to LLVM's inliner and block placement.
+  if (auto EntryCount = CurSILFn->getEntryCount()) {
+    CurFn->setEntryCount(*EntryCount);
+    if (CurSILFn->isColdInProfile())
+      CurFn->addFnAttr(llvm::Attribute::Cold);
+  }
+
   // Map the entry bb.
   LoweredBBs[&*CurSILFn->begin()] = LoweredBB(&*CurFn->begin(), {});
   // Create LLVM basic blocks for the other bbs.
@@ -2094,7 +2101,16 @@ void IRGenSILFunction::visitFullApplySite(FullApplySite site) {
     }
 
     // If the error value is non-null, branch to the error destination.
-    auto hasError = Builder.CreateICmpNE(errorValue, nullError);
+    llvm::Value *hasError = Builder.CreateICmpNE(errorValue, nullError);
+
+    // Throwing is the uncommon case. Hint that to LLVM the same way as a
+    // _slowPath, so that the error path is moved out of the hot code.
+    if (IGM.IRGen.Opts.Optimize) {
+      llvm::Function *expectIntrinsic = llvm::Intrinsic::getDeclaration(
+          &IGM.Module, llvm::Intrinsic::ID::expect, {IGM.Int1Ty});
+      hasError = Builder.CreateCall(expectIntrinsic,
+                                    {hasError, Builder.getInt1(false)});
+    }
     Builder.CreateCondBr(hasError, errorDest.bb, normalDest.bb);
 
     // Set up the PHI nodes on the normal edge.
@@ -4717,6 +4733,11 @@ void IRGenModule::emitSILStaticInitializers() {
 
     auto *InitValue = Global.getValueOfStaticInitializer();
 
+    // A let global is never written after its static initialization, so it
+    // can be placed in read-only memory.
+    if (Global.isLet())
+      IRGlobal->setConstant(true);
+
     // Set the IR global's initializer to the constant for this SIL
     // struct.
     if (auto *SI = dyn_cast<StructInst>(InitValue)) {
@@ -31,12 +31,15 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
 #if defined(_MSC_VER)
@@ -290,6 +293,64 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+namespace {
+/// Keeps the native code the JIT generates for a script in the directory
+/// given with -object-cache-path, so that running the same script again
+/// skips LLVM code generation. The JIT-compiled module contains the script
+/// and the modules it imports from source, so its hash changes whenever
+/// one of them does.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  IRGenOptions &Opts;
+  ASTContext &Ctx;
+  std::string CachedObjectPath;
+
+public:
+  ImmediateObjectCache(IRGenOptions &Opts, ASTContext &Ctx)
+    : Opts(Opts), Ctx(Ctx) {}
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    SmallString<128> Path(Opts.ObjectCachePath);
+    llvm::sys::path::append(Path, getLLVMModuleHash(
+        Opts, Ctx, const_cast<llvm::Module *>(M)) + ".jit.o");
+    CachedObjectPath = Path.str();
+
+    auto Buffer = llvm::MemoryBuffer::getFile(CachedObjectPath);
+    if (!Buffer)
+      return nullptr;
+    DEBUG(llvm::dbgs() << "Using cached object " << CachedObjectPath << '\n');
+    return std::move(Buffer.get());
+  }
+
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // Failing to write the object only means that the next run doesn't
+    // find it. Write it through a temporary file so that no other run
+    // reads a partially written object.
+    if (CachedObjectPath.empty() ||
+        llvm::sys::fs::create_directories(Opts.ObjectCachePath))
+      return;
+    int FD;
+    SmallString<128> TempPath;
+    if (llvm::sys::fs::createUniqueFile(CachedObjectPath + "-%%%%%%%%.tmp",
+                                        FD, TempPath))
+      return;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Obj.getBuffer();
+      OS.flush();
+      if (OS.has_error()) {
+        OS.clear_error();
+        llvm::sys::fs::remove(TempPath);
+        return;
+      }
+    }
+    if (llvm::sys::fs::rename(TempPath, CachedObjectPath))
+      llvm::sys::fs::remove(TempPath);
+  }
+};
+} // end anonymous namespace
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                           IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
   ASTContext &Context = CI.getASTContext();
@@ -362,6 +423,10 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
     return -1;
   }
 
+  ImmediateObjectCache ObjectCache(IRGenOpts, Context);
+  if (!IRGenOpts.ObjectCachePath.empty())
+    EE->setObjectCache(&ObjectCache);
+
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
 
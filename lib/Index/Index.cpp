@@ -95,6 +95,10 @@ class IndexSwiftASTWalker : public SourceEntityWalker {
   struct NameAndUSR {
     StringRef USR;
     StringRef name;
+    /// Whether the USR was already computed, so that decls without one are
+    /// not mangled again each time they are referenced.
+    bool isComputed = false;
+    bool failed = false;
   };
   typedef llvm::PointerIntPair<Decl *, 3> DeclAccessorPair;
   llvm::DenseMap<Decl *, NameAndUSR> nameAndUSRCache;
@@ -103,12 +107,15 @@ class IndexSwiftASTWalker : public SourceEntityWalker {
 
   bool getNameAndUSR(ValueDecl *D, StringRef &name, StringRef &USR) {
     auto &result = nameAndUSRCache[D];
-    if (result.USR.empty()) {
+    if (!result.isComputed) {
+      result.isComputed = true;
       SmallString<128> storage;
       {
         llvm::raw_svector_ostream OS(storage);
-        if (ide::printDeclUSR(D, OS))
+        if (ide::printDeclUSR(D, OS)) {
+          result.failed = true;
           return true;
+        }
         result.USR = stringStorage.copyString(OS.str());
       }
 
@@ -120,6 +127,9 @@ class IndexSwiftASTWalker : public SourceEntityWalker {
       }
     }
 
+    if (result.failed)
+      return true;
+
     name = result.name;
     USR = result.USR;
     return false;
@@ -52,16 +52,22 @@ class ARCEntryPointBuilder {
   // The builder which we are wrapping.
   IRBuilder B;
 
-  // The constant cache.
-  NullablePtr<Constant> Retain;
-  NullablePtr<Constant> Release;
+  // The constant cache. Entry points with a nonatomic variant are indexed by
+  // whether they are nonatomic, so that a function which uses both variants
+  // gets each of them.
+  NullablePtr<Constant> Retain[2];
+  NullablePtr<Constant> Release[2];
   NullablePtr<Constant> CheckUnowned;
-  NullablePtr<Constant> RetainN;
-  NullablePtr<Constant> ReleaseN;
-  NullablePtr<Constant> UnknownRetainN;
-  NullablePtr<Constant> UnknownReleaseN;
-  NullablePtr<Constant> BridgeRetainN;
-  NullablePtr<Constant> BridgeReleaseN;
+  NullablePtr<Constant> RetainN[2];
+  NullablePtr<Constant> ReleaseN[2];
+  NullablePtr<Constant> UnknownRetain[2];
+  NullablePtr<Constant> UnknownRelease[2];
+  NullablePtr<Constant> UnknownRetainN[2];
+  NullablePtr<Constant> UnknownReleaseN[2];
+  NullablePtr<Constant> BridgeRetain[2];
+  NullablePtr<Constant> BridgeRelease[2];
+  NullablePtr<Constant> BridgeRetainN[2];
+  NullablePtr<Constant> BridgeReleaseN[2];
 
   // The type cache.
   NullablePtr<Type> ObjectPtrTy;
@@ -86,7 +92,7 @@ class ARCEntryPointBuilder {
 
 public:
   ARCEntryPointBuilder(Function &F)
-      : B(&*F.begin()), Retain(), ObjectPtrTy(),
+      : B(&*F.begin()), ObjectPtrTy(),
         DefaultCC(SWIFT_LLVM_CC(DefaultCC)) {
     //If the target does not support the new calling convention,
     //set RegisterPreservingCC to use a default calling convention.
@@ -152,6 +158,38 @@ public:
     return CI;
   }
 
+  CallInst *createUnknownRetain(Value *V, CallInst *OrigI) {
+    // Cast just to make sure that we have the right object type.
+    V = B.CreatePointerCast(V, getObjectPtrTy());
+    CallInst *CI = CreateCall(getUnknownRetain(OrigI), V);
+    CI->setTailCall(true);
+    return CI;
+  }
+
+  CallInst *createUnknownRelease(Value *V, CallInst *OrigI) {
+    // Cast just to make sure that we have the right object type.
+    V = B.CreatePointerCast(V, getObjectPtrTy());
+    CallInst *CI = CreateCall(getUnknownRelease(OrigI), V);
+    CI->setTailCall(true);
+    return CI;
+  }
+
+  CallInst *createBridgeRetain(Value *V, CallInst *OrigI) {
+    // Cast just to make sure that we have the right object type.
+    V = B.CreatePointerCast(V, getBridgeObjectPtrTy());
+    CallInst *CI = CreateCall(getBridgeRetain(OrigI), V);
+    CI->setTailCall(true);
+    return CI;
+  }
+
+  CallInst *createBridgeRelease(Value *V, CallInst *OrigI) {
+    // Cast just to make sure that we have the right object type.
+    V = B.CreatePointerCast(V, getBridgeObjectPtrTy());
+    CallInst *CI = CreateCall(getBridgeRelease(OrigI), V);
+    CI->setTailCall(true);
+    return CI;
+  }
+
   
   CallInst *createCheckUnowned(Value *V, CallInst *OrigI) {
     // Cast just to make sure that we have the right type.
@@ -226,38 +264,40 @@ private:
 
   /// getRetain - Return a callable function for swift_retain.
   Constant *getRetain(CallInst *OrigI) {
-    if (Retain)
-      return Retain.get();
+    auto &Cache = Retain[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    Retain = getWrapperFn(
+    Cache = getWrapperFn(
         getModule(), cache,
         isNonAtomic(OrigI) ? "swift_nonatomic_retain" : "swift_retain",
         isNonAtomic(OrigI) ? SWIFT_RT_ENTRY_REF_AS_STR(swift_nonatomic_retain)
                            : SWIFT_RT_ENTRY_REF_AS_STR(swift_retain),
         RegisterPreservingCC, {VoidTy}, {ObjectPtrTy}, {NoUnwind});
 
-    return Retain.get();
+    return Cache.get();
   }
 
   /// getRelease - Return a callable function for swift_release.
   Constant *getRelease(CallInst *OrigI) {
-    if (Release)
-      return Release.get();
+    auto &Cache = Release[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    Release = getWrapperFn(
+    Cache = getWrapperFn(
         getModule(), cache,
         isNonAtomic(OrigI) ? "swift_nonatomic_release" : "swift_release",
         isNonAtomic(OrigI) ? SWIFT_RT_ENTRY_REF_AS_STR(swift_nonatomic_release)
                            : SWIFT_RT_ENTRY_REF_AS_STR(swift_release),
         RegisterPreservingCC, {VoidTy}, {ObjectPtrTy}, {NoUnwind});
 
-    return Release.get();
+    return Cache.get();
   }
 
   Constant *getCheckUnowned(CallInst *OrigI) {
@@ -280,33 +320,35 @@ private:
 
   /// getRetainN - Return a callable function for swift_retain_n.
   Constant *getRetainN(CallInst *OrigI) {
-    if (RetainN)
-      return RetainN.get();
+    auto &Cache = RetainN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    RetainN = getWrapperFn(
+    Cache = getWrapperFn(
         getModule(), cache,
         isNonAtomic(OrigI) ? "swift_nonatomic_retain_n" : "swift_retain_n",
         isNonAtomic(OrigI) ? SWIFT_RT_ENTRY_REF_AS_STR(swift_nonatomic_retain_n)
                            : SWIFT_RT_ENTRY_REF_AS_STR(swift_retain_n),
         RegisterPreservingCC, {VoidTy}, {ObjectPtrTy, Int32Ty}, {NoUnwind});
 
-    return RetainN.get();
+    return Cache.get();
   }
 
   /// Return a callable function for swift_release_n.
   Constant *getReleaseN(CallInst *OrigI) {
-    if (ReleaseN)
-      return ReleaseN.get();
+    auto &Cache = ReleaseN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    ReleaseN = getWrapperFn(
+    Cache = getWrapperFn(
         getModule(), cache,
         isNonAtomic(OrigI) ? "swift_nonatomic_release_n" : "swift_release_n",
         isNonAtomic(OrigI)
@@ -314,78 +356,149 @@ private:
             : SWIFT_RT_ENTRY_REF_AS_STR(swift_release_n),
         RegisterPreservingCC, {VoidTy}, {ObjectPtrTy, Int32Ty}, {NoUnwind});
 
-    return ReleaseN.get();
+    return Cache.get();
+  }
+
+  /// Return a callable function for swift_unknownRetain.
+  Constant *getUnknownRetain(CallInst *OrigI) {
+    auto &Cache = UnknownRetain[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
+    auto *ObjectPtrTy = getObjectPtrTy();
+    auto *VoidTy = Type::getVoidTy(getModule().getContext());
+
+    llvm::Constant *cache = nullptr;
+    Cache = getRuntimeFn(getModule(), cache,
+                         isNonAtomic(OrigI) ? "swift_nonatomic_unknownRetain"
+                                            : "swift_unknownRetain",
+                         DefaultCC, {VoidTy}, {ObjectPtrTy}, {NoUnwind});
+
+    return Cache.get();
+  }
+
+  /// Return a callable function for swift_unknownRelease.
+  Constant *getUnknownRelease(CallInst *OrigI) {
+    auto &Cache = UnknownRelease[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
+    auto *ObjectPtrTy = getObjectPtrTy();
+    auto *VoidTy = Type::getVoidTy(getModule().getContext());
+
+    llvm::Constant *cache = nullptr;
+    Cache = getRuntimeFn(getModule(), cache,
+                         isNonAtomic(OrigI) ? "swift_nonatomic_unknownRelease"
+                                            : "swift_unknownRelease",
+                         DefaultCC, {VoidTy}, {ObjectPtrTy}, {NoUnwind});
+
+    return Cache.get();
   }
 
   /// getUnknownRetainN - Return a callable function for swift_unknownRetain_n.
   Constant *getUnknownRetainN(CallInst *OrigI) {
-    if (UnknownRetainN)
-      return UnknownRetainN.get();
+    auto &Cache = UnknownRetainN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    UnknownRetainN =
+    Cache =
         getRuntimeFn(getModule(), cache,
                      isNonAtomic(OrigI) ? "swift_nonatomic_unknownRetain_n"
                                         : "swift_unknownRetain_n",
                      DefaultCC, {VoidTy}, {ObjectPtrTy, Int32Ty}, {NoUnwind});
 
-    return UnknownRetainN.get();
+    return Cache.get();
   }
 
   /// Return a callable function for swift_unknownRelease_n.
   Constant *getUnknownReleaseN(CallInst *OrigI) {
-    if (UnknownReleaseN)
-      return UnknownReleaseN.get();
+    auto &Cache = UnknownReleaseN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *ObjectPtrTy = getObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    UnknownReleaseN =
+    Cache =
         getRuntimeFn(getModule(), cache,
                      isNonAtomic(OrigI) ? "swift_nonatomic_unknownRelease_n"
                                         : "swift_unknownRelease_n",
                      DefaultCC, {VoidTy}, {ObjectPtrTy, Int32Ty}, {NoUnwind});
 
-    return UnknownReleaseN.get();
+    return Cache.get();
+  }
+
+  /// Return a callable function for swift_bridgeRetain.
+  Constant *getBridgeRetain(CallInst *OrigI) {
+    auto &Cache = BridgeRetain[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
+    auto *BridgeObjectPtrTy = getBridgeObjectPtrTy();
+
+    llvm::Constant *cache = nullptr;
+    Cache = getRuntimeFn(
+        getModule(), cache,
+        isNonAtomic(OrigI) ? "swift_nonatomic_bridgeObjectRetain"
+                           : "swift_bridgeObjectRetain",
+        DefaultCC, {BridgeObjectPtrTy}, {BridgeObjectPtrTy}, {NoUnwind});
+    return Cache.get();
+  }
+
+  /// Return a callable function for swift_bridgeRelease.
+  Constant *getBridgeRelease(CallInst *OrigI) {
+    auto &Cache = BridgeRelease[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
+    auto *BridgeObjectPtrTy = getBridgeObjectPtrTy();
+    auto *VoidTy = Type::getVoidTy(getModule().getContext());
+
+    llvm::Constant *cache = nullptr;
+    Cache = getRuntimeFn(
+        getModule(), cache,
+        isNonAtomic(OrigI) ? "swift_nonatomic_bridgeObjectRelease"
+                           : "swift_bridgeObjectRelease",
+        DefaultCC, {VoidTy}, {BridgeObjectPtrTy}, {NoUnwind});
+    return Cache.get();
   }
 
   /// Return a callable function for swift_bridgeRetain_n.
   Constant *getBridgeRetainN(CallInst *OrigI) {
-    if (BridgeRetainN)
-      return BridgeRetainN.get();
+    auto &Cache = BridgeRetainN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
     auto *BridgeObjectPtrTy = getBridgeObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    BridgeRetainN =
+    Cache =
         getRuntimeFn(getModule(), cache,
                      isNonAtomic(OrigI) ? "swift_nonatomic_bridgeObjectRetain_n"
                                         : "swift_bridgeObjectRetain_n",
                      DefaultCC, {BridgeObjectPtrTy},
                      {BridgeObjectPtrTy, Int32Ty}, {NoUnwind});
-    return BridgeRetainN.get();
+    return Cache.get();
   }
 
   /// Return a callable function for swift_bridgeRelease_n.
   Constant *getBridgeReleaseN(CallInst *OrigI) {
-    if (BridgeReleaseN)
-      return BridgeReleaseN.get();
+    auto &Cache = BridgeReleaseN[isNonAtomic(OrigI)];
+    if (Cache)
+      return Cache.get();
 
     auto *BridgeObjectPtrTy = getBridgeObjectPtrTy();
     auto *Int32Ty = Type::getInt32Ty(getModule().getContext());
     auto *VoidTy = Type::getVoidTy(getModule().getContext());
 
     llvm::Constant *cache = nullptr;
-    BridgeReleaseN = getRuntimeFn(
+    Cache = getRuntimeFn(
         getModule(), cache,
         isNonAtomic(OrigI) ? "swift_nonatomic_bridgeObjectRelease_n"
                            : "swift_bridgeObjectRelease_n",
         DefaultCC, {VoidTy}, {BridgeObjectPtrTy, Int32Ty}, {NoUnwind});
-    return BridgeReleaseN.get();
+    return Cache.get();
   }
 
   Type *getObjectPtrTy() {
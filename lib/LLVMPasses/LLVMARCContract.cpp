@@ -15,6 +15,7 @@
 #include "ARCEntryPointBuilder.h"
 #include "LLVMARCOpts.h"
 #include "swift/Basic/Fallthrough.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Verifier.h"
@@ -56,7 +57,8 @@ struct LocalState {
 /// Optimizations include:
 ///
 ///   - Merging together retain and release calls into retain_n, release_n
-///   - calls.
+///   - calls. This is done within blocks and across edges between blocks
+///     which are always executed together.
 ///
 /// Coming into this function, we assume that the code is in canonical form:
 /// none of these calls have any uses of their return values.
@@ -85,6 +87,12 @@ private:
   /// call.
   void
   performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap);
+
+  /// Merge the retains and releases in the chain of blocks starting at
+  /// \p Head, see getChainSuccessor(). Blocks in the chain are added to
+  /// \p Visited.
+  void processChain(BasicBlock &Head, SmallPtrSetImpl<BasicBlock *> &Visited,
+                    DenseMap<Value *, LocalState> &PtrToLocalStateMap);
 };
 
 } // end anonymous namespace
@@ -254,10 +262,52 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
 }
 
 
+/// Returns the block which is always executed directly after \p BB and only
+/// after \p BB, or null if there is no such block.
+///
+/// Retains and releases can be merged across the edge to this block as if
+/// both blocks were one.
+static BasicBlock *getChainSuccessor(BasicBlock &BB) {
+  BasicBlock *Succ = BB.getSingleSuccessor();
+  if (!Succ || Succ == &BB || Succ->getSinglePredecessor() != &BB)
+    return nullptr;
+  return Succ;
+}
+
+/// Returns true if \p BB is the chain successor of its predecessor.
+static bool isChainSuccessor(BasicBlock &BB) {
+  BasicBlock *Pred = BB.getSinglePredecessor();
+  return Pred && getChainSuccessor(*Pred) == &BB;
+}
+
 bool SwiftARCContractImpl::run() {
-  // intra-BB retain/release merging.
+  // Retain/release merging within chains of blocks which are always executed
+  // one after the other, i.e. where each block is the single successor of the
+  // previous one and has no other predecessor. Such chains are left behind by
+  // inlining and loop transformations.
   DenseMap<Value *, LocalState> PtrToLocalStateMap;
+  SmallPtrSet<BasicBlock *, 32> Visited;
+  for (BasicBlock &Head : F) {
+    if (isChainSuccessor(Head))
+      continue;
+    processChain(Head, Visited, PtrToLocalStateMap);
+  }
+
+  // Blocks in unreachable cycles of chain successors have no head.
   for (BasicBlock &BB : F) {
+    if (!Visited.count(&BB))
+      processChain(BB, Visited, PtrToLocalStateMap);
+  }
+
+  return Changed;
+}
+
+void SwiftARCContractImpl::
+processChain(BasicBlock &Head, SmallPtrSetImpl<BasicBlock *> &Visited,
+             DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
+  for (BasicBlock *BBPtr = &Head; BBPtr && Visited.insert(BBPtr).second;
+       BBPtr = getChainSuccessor(*BBPtr)) {
+    BasicBlock &BB = *BBPtr;
     for (auto II = BB.begin(), IE = BB.end(); II != IE; ) {
       // Preincrement iterator to avoid iteration issues in the loop.
       Instruction &Inst = *II++;
@@ -363,13 +413,11 @@ bool SwiftARCContractImpl::run() {
       // determine that a function does not touch globals.
       performRRNOptimization(PtrToLocalStateMap);
     }
-
-    // Perform the RRNOptimization.
-    performRRNOptimization(PtrToLocalStateMap);
-    PtrToLocalStateMap.clear();
   }
 
-  return Changed;
+  // Perform the RRNOptimization.
+  performRRNOptimization(PtrToLocalStateMap);
+  PtrToLocalStateMap.clear();
 }
 
 bool SwiftARCContract::runOnFunction(Function &F) {
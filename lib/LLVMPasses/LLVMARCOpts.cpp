@@ -89,23 +89,25 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       Instruction &Inst = *I++;
 
       switch (classifyInstruction(Inst)) {
-      // These instructions should not reach here based on the pass ordering.
-      // i.e. LLVMARCOpt -> LLVMContractOpt.
+      // These are usually only created by LLVMARCContract, which runs after
+      // us, but input IR which has already been contracted may contain them.
       case RT_RetainN:
       case RT_UnknownRetainN:
       case RT_BridgeRetainN:
       case RT_ReleaseN:
       case RT_UnknownReleaseN:
       case RT_BridgeReleaseN:
-        llvm_unreachable("These are only created by LLVMARCContract !");
       case RT_Unknown:
       case RT_BridgeRelease:
-      case RT_AllocObject:
       case RT_FixLifetime:
       case RT_NoMemoryAccessed:
       case RT_RetainUnowned:
       case RT_CheckUnowned:
         break;
+      case RT_AllocObject:
+        // A freshly allocated object is a native Swift object.
+        NativeRefs.insert(&Inst);
+        break;
       case RT_Retain: {
         CallInst &CI = cast<CallInst>(Inst);
         Value *ArgVal = RC->getSwiftRCIdentityRoot(CI.getArgOperand(0));
@@ -243,6 +245,57 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
   return Changed;
 }
 
+/// Replace the retain_n or release_n call \p CI of kind \p Kind by one which
+/// adds or drops one reference less. If the remaining count is one, the single
+/// variant of the entry point is used.
+///
+/// Returns false and leaves \p CI alone if its count is not a constant.
+static bool decrementRefCountN(CallInst &CI, RT_Kind Kind,
+                               ARCEntryPointBuilder &B) {
+  auto *Count = dyn_cast<ConstantInt>(CI.getArgOperand(1));
+  if (!Count || Count->getZExtValue() < 2)
+    return false;
+  uint32_t N = Count->getZExtValue() - 1;
+  Value *Obj = CI.getArgOperand(0);
+
+  B.setInsertPoint(&CI);
+  CallInst *NewCI = nullptr;
+  switch (Kind) {
+  case RT_RetainN:
+    NewCI = N == 1 ? B.createRetain(Obj, &CI) : B.createRetainN(Obj, N, &CI);
+    break;
+  case RT_ReleaseN:
+    NewCI = N == 1 ? B.createRelease(Obj, &CI) : B.createReleaseN(Obj, N, &CI);
+    break;
+  case RT_UnknownRetainN:
+    NewCI = N == 1 ? B.createUnknownRetain(Obj, &CI)
+                   : B.createUnknownRetainN(Obj, N, &CI);
+    break;
+  case RT_UnknownReleaseN:
+    NewCI = N == 1 ? B.createUnknownRelease(Obj, &CI)
+                   : B.createUnknownReleaseN(Obj, N, &CI);
+    break;
+  case RT_BridgeRetainN:
+    NewCI = N == 1 ? B.createBridgeRetain(Obj, &CI)
+                   : B.createBridgeRetainN(Obj, N, &CI);
+    break;
+  case RT_BridgeReleaseN:
+    NewCI = N == 1 ? B.createBridgeRelease(Obj, &CI)
+                   : B.createBridgeReleaseN(Obj, N, &CI);
+    break;
+  default:
+    llvm_unreachable("not a retain_n or release_n");
+  }
+
+  // Bridge retains return their argument.
+  if (!CI.use_empty()) {
+    assert(NewCI->getType() == CI.getType() && "result type changed");
+    CI.replaceAllUsesWith(NewCI);
+  }
+  CI.eraseFromParent();
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                         Release() Motion
 //===----------------------------------------------------------------------===//
@@ -250,8 +303,10 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
 /// performLocalReleaseMotion - Scan backwards from the specified release,
 /// moving it earlier in the function if possible, over instructions that do not
 /// access the released object.  If we get to a retain or allocation of the
-/// object, zap both.
+/// object, zap both. If we get to a retain_n of the object, zap the release and
+/// decrement the count of the retain_n.
 static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
+                                      ARCEntryPointBuilder &B,
                                       SwiftRCIdentity *RC) {
   // FIXME: Call classifier should identify the object for us.  Too bad C++
   // doesn't have nice Swift-style enums.
@@ -273,21 +328,16 @@ static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
       goto OutOfLoop;
     }
 
-    switch (classifyInstruction(*BBI)) {
-    // These instructions should not reach here based on the pass ordering.
-    // i.e. LLVMARCOpt -> LLVMContractOpt.
-    case RT_UnknownRetainN:
-    case RT_BridgeRetainN:
-    case RT_RetainN:
-    case RT_UnknownReleaseN:
-    case RT_BridgeReleaseN:
-    case RT_ReleaseN:
-        llvm_unreachable("These are only created by LLVMARCContract !");
+    RT_Kind Kind = classifyInstruction(*BBI);
+    switch (Kind) {
     case RT_NoMemoryAccessed:
       // Skip over random instructions that don't touch memory.  They don't need
       // protection by retain/release.
       continue;
 
+    case RT_UnknownReleaseN:
+    case RT_BridgeReleaseN:
+    case RT_ReleaseN:
     case RT_UnknownRelease:
     case RT_BridgeRelease:
     case RT_ObjCRelease:
@@ -343,6 +393,24 @@ static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
       goto OutOfLoop;
     }
 
+    case RT_UnknownRetainN:
+    case RT_BridgeRetainN:
+    case RT_RetainN: {  // swift_retain_n(obj, n)
+      // A retain_n of the same object pairs with our release like n retains,
+      // the last of which is right before the release.
+      CallInst &Retain = cast<CallInst>(*BBI);
+      Value *RetainedObject = RC->getSwiftRCIdentityRoot(
+          Retain.getArgOperand(0));
+      if (RetainedObject == ReleasedObject &&
+          decrementRefCountN(Retain, Kind, B)) {
+        Release.eraseFromParent();
+        ++NumRetainReleasePairs;
+        return true;
+      }
+      ++BBI;
+      goto OutOfLoop;
+    }
+
     case RT_AllocObject: {   // %obj = swift_alloc(...)
       CallInst &Allocation = cast<CallInst>(*BBI);
 
@@ -404,6 +472,7 @@ OutOfLoop:
 /// NOTE: this handles both objc_retain and swift_retain.
 ///
 static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
+                                     ARCEntryPointBuilder &B,
                                      SwiftRCIdentity *RC) {
   // FIXME: Call classifier should identify the object for us.  Too bad C++
   // doesn't have nice Swift-style enums.
@@ -423,16 +492,8 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
     // Classify the instruction. This switch does a "break" when the instruction
     // can be skipped and is interesting, and a "continue" when it is a retain
     // of the same pointer.
-    switch (classifyInstruction(CurInst)) {
-    // These instructions should not reach here based on the pass ordering.
-    // i.e. LLVMARCOpt -> LLVMContractOpt.
-    case RT_RetainN:
-    case RT_UnknownRetainN:
-    case RT_BridgeRetainN:
-    case RT_ReleaseN:
-    case RT_UnknownReleaseN:
-    case RT_BridgeReleaseN:
-        llvm_unreachable("These are only created by LLVMARCContract !");
+    RT_Kind Kind = classifyInstruction(CurInst);
+    switch (Kind) {
     case RT_NoMemoryAccessed:
     case RT_AllocObject:
     case RT_CheckUnowned:
@@ -443,6 +504,9 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
     case RT_FixLifetime: // This only stops release motion. Retains can move over it.
       break;
 
+    case RT_RetainN:
+    case RT_UnknownRetainN:
+    case RT_BridgeRetainN:
     case RT_Retain:
     case RT_UnknownRetain:
     case RT_BridgeRetain:
@@ -484,6 +548,27 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
       goto OutOfLoop;
     }
 
+    case RT_ReleaseN:
+    case RT_UnknownReleaseN:
+    case RT_BridgeReleaseN: {  // swift_release_n(obj, n)
+      // A release_n of the same object pairs with our retain like n releases,
+      // the first of which is right after the retain.
+      CallInst &ThisRelease = cast<CallInst>(CurInst);
+      Value *ThisReleasedObject = RC->getSwiftRCIdentityRoot(
+          ThisRelease.getArgOperand(0));
+      if (ThisReleasedObject == RetainedObject &&
+          decrementRefCountN(ThisRelease, Kind, B)) {
+        Retain.eraseFromParent();
+        if (isObjCRetain) {
+          ++NumObjCRetainReleasePairs;
+        } else {
+          ++NumRetainReleasePairs;
+        }
+        return true;
+      }
+      goto OutOfLoop;
+    }
+
     case RT_Unknown:
       // Loads cannot affect the retain.
       if (isa<LoadInst>(CurInst))
@@ -576,15 +661,6 @@ static DtorKind analyzeDestructor(Value *P) {
     for (Instruction &I : BB) {
       // Note that the destructor may not be in any particular canonical form.
       switch (classifyInstruction(I)) {
-      // These instructions should not reach here based on the pass ordering.
-      // i.e. LLVMARCOpt -> LLVMContractOpt.
-      case RT_RetainN:
-      case RT_UnknownRetainN:
-      case RT_BridgeRetainN:
-      case RT_ReleaseN:
-      case RT_UnknownReleaseN:
-      case RT_BridgeReleaseN:
-        llvm_unreachable("These are only created by LLVMARCContract !");
       case RT_NoMemoryAccessed:
       case RT_AllocObject:
       case RT_FixLifetime:
@@ -594,6 +670,8 @@ static DtorKind analyzeDestructor(Value *P) {
 
       case RT_RetainUnowned:
       case RT_BridgeRetain:          // x = swift_bridgeRetain(y)
+      case RT_BridgeRetainN:
+      case RT_RetainN:
       case RT_Retain: {      // swift_retain(obj)
 
         // Ignore retains of the "self" object, no resurrection is possible.
@@ -605,6 +683,7 @@ static DtorKind analyzeDestructor(Value *P) {
         break;
       }
 
+      case RT_ReleaseN:
       case RT_Release: {
         // If we get to a release that is provably to this object, then we can
         // ignore it.
@@ -620,8 +699,11 @@ static DtorKind analyzeDestructor(Value *P) {
       case RT_ObjCRelease:
       case RT_ObjCRetain:
       case RT_UnknownRetain:
+      case RT_UnknownRetainN:
       case RT_UnknownRelease:
+      case RT_UnknownReleaseN:
       case RT_BridgeRelease:
+      case RT_BridgeReleaseN:
         // Objective-C retain and release can have arbitrary side effects.
         break;
 
@@ -688,15 +770,6 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
 
     // Okay, this is the first time we've seen this instruction, proceed.
     switch (classifyInstruction(*I)) {
-    // These instructions should not reach here based on the pass ordering.
-    // i.e. LLVMARCOpt -> LLVMContractOpt.
-    case RT_RetainN:
-    case RT_UnknownRetainN:
-    case RT_BridgeRetainN:
-    case RT_ReleaseN:
-    case RT_UnknownReleaseN:
-    case RT_BridgeReleaseN:
-      llvm_unreachable("These are only created by LLVMARCContract !");
     case RT_AllocObject:
       // If this is a different swift_allocObject than we started with, then
       // there is some computation feeding into a size or alignment computation
@@ -715,11 +788,19 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
       break;
 
     case RT_Release:
+    case RT_ReleaseN:
     case RT_Retain:
+    case RT_RetainN:
+    case RT_UnknownRetain:
+    case RT_UnknownRetainN:
+    case RT_UnknownRelease:
+    case RT_UnknownReleaseN:
     case RT_FixLifetime:
     case RT_CheckUnowned:
       // It is perfectly fine to eliminate various retains and releases of this
-      // object: we are zapping all accesses or none.
+      // object: we are zapping all accesses or none. The object is a native
+      // Swift object, so unknown retains and releases of it are plain retains
+      // and releases.
       break;
 
     // If this is an unknown instruction, we have more interesting things to
@@ -727,10 +808,10 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
     case RT_Unknown:
     case RT_ObjCRelease:
     case RT_ObjCRetain:
-    case RT_UnknownRetain:
-    case RT_UnknownRelease:
     case RT_BridgeRetain:
+    case RT_BridgeRetainN:
     case RT_BridgeRelease:
+    case RT_BridgeReleaseN:
     case RT_RetainUnowned:
 
       // Otherwise, this really is some unhandled instruction.  Bail out.
@@ -869,8 +950,11 @@ static void performRedundantCheckUnownedRemoval(BasicBlock &BB) {
       case RT_AllocObject:
       case RT_FixLifetime:
       case RT_Retain:
+      case RT_RetainN:
       case RT_UnknownRetain:
+      case RT_UnknownRetainN:
       case RT_BridgeRetain:
+      case RT_BridgeRetainN:
       case RT_RetainUnowned:
       case RT_ObjCRetain:
         // All this cannot decrement reference counts.
@@ -926,7 +1010,7 @@ static bool performGeneralOptimizations(Function &F, ARCEntryPointBuilder &B,
       case RT_ObjCRelease:
       case RT_UnknownRelease:
       case RT_Release:
-        Changed |= performLocalReleaseMotion(cast<CallInst>(I), BB, RC);
+        Changed |= performLocalReleaseMotion(cast<CallInst>(I), BB, B, RC);
         break;
       case RT_BridgeRetain:
       case RT_Retain:
@@ -936,7 +1020,7 @@ static bool performGeneralOptimizations(Function &F, ARCEntryPointBuilder &B,
         // invalidate our iterators by parking it on the instruction before I.
         BasicBlock::iterator Safe = I.getIterator();
         Safe = Safe != BB.begin() ? std::prev(Safe) : BB.end();
-        if (performLocalRetainMotion(cast<CallInst>(I), BB, RC)) {
+        if (performLocalRetainMotion(cast<CallInst>(I), BB, B, RC)) {
           // If we zapped or moved the retain, reset the iterator on the
           // instruction *newly* after the prev instruction.
           BBI = Safe != BB.end() ? std::next(Safe) : BB.begin();
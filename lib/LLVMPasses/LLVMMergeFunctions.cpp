@@ -1106,6 +1106,12 @@ static bool isEligibleForConstantSharing(const Instruction *I) {
     case Instruction::Store:
     case Instruction::Call:
       return true;
+    case Instruction::ICmp:
+      // Specializations for different classes compare against different type
+      // metadata or class objects, e.g. in the fast path of dynamic casts.
+      // Integer constants are left alone, comparing against them is cheaper
+      // than against a parameter.
+      return I->getOperand(0)->getType()->isPointerTy();
     default:
       return false;
   }
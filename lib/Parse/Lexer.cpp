@@ -17,6 +17,7 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/AST/DiagnosticsParse.h"
 #include "swift/AST/Identifier.h"
+#include "swift/AST/IdentifierTable.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/LangOptions.h"
 #include "swift/Basic/SourceManager.h"
@@ -25,6 +26,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
+#include <cstring>
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
@@ -306,8 +308,73 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+//===----------------------------------------------------------------------===//
+// Scanning of plain ASCII text
+//===----------------------------------------------------------------------===//
+//
+// Most of the bytes in comments and string literals are plain ASCII
+// characters which the lexer only has to step over. These helpers check eight
+// bytes at a time whether any of them needs a closer look, and return the
+// start of the first group of eight bytes which does; the caller continues
+// from there one character at a time. They never read at or beyond the end
+// of the buffer, so the remainder is always left to the caller.
+
+static const uint64_t OnesInEveryByte = ~uint64_t(0) / 0xFF;
+static const uint64_t HighBitInEveryByte = OnesInEveryByte * 0x80;
+
+/// Returns non-zero if any byte of \p word is \p byte.
+static inline uint64_t hasByte(uint64_t word, uint8_t byte) {
+  uint64_t x = word ^ (OnesInEveryByte * byte);
+  return (x - OnesInEveryByte) & ~x & HighBitInEveryByte;
+}
+
+/// Returns non-zero if any byte of \p word is less than \p bound, which is
+/// at most 0x80.
+static inline uint64_t hasByteLessThan(uint64_t word, uint8_t bound) {
+  return (word - OnesInEveryByte * bound) & ~word & HighBitInEveryByte;
+}
+
+static inline uint64_t loadWord(const char *ptr) {
+  uint64_t word;
+  memcpy(&word, ptr, sizeof(word));
+  return word;
+}
+
+/// Skip the plain ASCII characters of a comment from \p ptr on, stopping
+/// before newlines, NULs and non-ASCII bytes, and also before '*' and '/' in
+/// block comments.
+static const char *skipPlainCommentText(const char *ptr, const char *end,
+                                        bool inBlockComment) {
+  while (end - ptr >= 8) {
+    uint64_t word = loadWord(ptr);
+    if ((word & HighBitInEveryByte) || hasByte(word, '\n') ||
+        hasByte(word, '\r') || hasByte(word, 0))
+      break;
+    if (inBlockComment && (hasByte(word, '*') || hasByte(word, '/')))
+      break;
+    ptr += 8;
+  }
+  return ptr;
+}
+
+/// Skip the printable ASCII characters of a string literal from \p ptr on,
+/// stopping before quotes, backslashes, control characters and non-ASCII
+/// bytes.
+static const char *skipPlainStringText(const char *ptr, const char *end) {
+  while (end - ptr >= 8) {
+    uint64_t word = loadWord(ptr);
+    if ((word & HighBitInEveryByte) || hasByteLessThan(word, 0x20) ||
+        hasByte(word, 0x7F) || hasByte(word, '"') || hasByte(word, '\'') ||
+        hasByte(word, '\\'))
+      break;
+    ptr += 8;
+  }
+  return ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipPlainCommentText(CurPtr, BufferEnd, /*inBlockComment=*/false);
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +428,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainCommentText(CurPtr, BufferEnd, /*inBlockComment=*/true);
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -568,11 +636,28 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Hash the identifier for the identifier table while scanning it.
+  unsigned Hash = 0;
+  for (const char *P = TokStart; P != CurPtr; ++P)
+    Hash = IdentifierTable::hashStep(Hash, *P);
+
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, taking the common ASCII characters
+  // without decoding them first.
+  while (true) {
+    while (clang::isIdentifierBody(*CurPtr, /*dollar*/true))
+      Hash = IdentifierTable::hashStep(Hash, *CurPtr++);
+    const char *ContinuationStart = CurPtr;
+    if ((signed char)*CurPtr >= 0 ||
+        !advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd))
+      break;
+    for (const char *P = ContinuationStart; P != CurPtr; ++P)
+      Hash = IdentifierTable::hashStep(Hash, *P);
+  }
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
-  return formToken(Kind, TokStart);
+  formToken(Kind, TokStart);
+  if (NextToken.is(tok::identifier))
+    NextToken.setIdentifierHash(Hash);
 }
 
 /// lexHash - Handle #], #! for shebangs, and the family of #identifiers.
@@ -1253,6 +1338,9 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Step over the characters which don't need any processing.
+    CurPtr = skipPlainStringText(CurPtr, BufferEnd);
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -1670,6 +1758,9 @@ Restart:
   case '\t':
   case '\f':
   case '\v':
+    // Skip runs of indentation and other horizontal whitespace at once.
+    while (*CurPtr == ' ' || *CurPtr == '\t')
+      ++CurPtr;
     goto Restart;  // Skip whitespace.
 
   case -1:
@@ -1807,6 +1807,54 @@ void Parser::delayParseFromBeginningToHere(ParserPosition BeginParserPosition,
     consumeToken();
 }
 
+namespace {
+/// Computes the interface hash of a declaration while it is being parsed, for
+/// the per-declaration dependency information in the reference dependencies
+/// file.
+///
+/// \sa SourceFile::getDeclInterfaceHash
+class DeclInterfaceHashRAII {
+  SourceFile *SF;
+  SmallVector<Decl *, 2> Decls;
+
+  static bool isPrivate(const Decl *D) {
+    if (auto *attr = D->getAttrs().getAttribute<AccessibilityAttr>())
+      return attr->getAccess() <= Accessibility::FilePrivate;
+    return false;
+  }
+
+  /// Returns true if changing \p D can change the layout of the type
+  /// containing it, whatever its access level.
+  static bool affectsLayout(const Decl *D) {
+    if (auto *VD = dyn_cast<VarDecl>(D))
+      return VD->hasStorage();
+    return isa<TypeDecl>(D) || isa<EnumCaseDecl>(D) ||
+           isa<EnumElementDecl>(D);
+  }
+
+public:
+  DeclInterfaceHashRAII(SourceFile &SF, bool isParsingInterfaceTokens)
+      : SF(isParsingInterfaceTokens && SF.getReferencedNameTracker()
+               ? &SF : nullptr) {
+    if (this->SF)
+      this->SF->beginDeclInterfaceHash();
+  }
+
+  void addDecl(Decl *D) {
+    if (SF)
+      Decls.push_back(D);
+  }
+
+  ~DeclInterfaceHashRAII() {
+    if (!SF)
+      return;
+    SF->endDeclInterfaceHash(
+        Decls, std::any_of(Decls.begin(), Decls.end(), isPrivate),
+        std::any_of(Decls.begin(), Decls.end(), affectsLayout));
+  }
+};
+} // end anonymous namespace
+
 /// \brief Parse a single syntactic declaration and return a list of decl
 /// ASTs.  This can return multiple results for var decls that bind to multiple
 /// values, structs that define a struct decl and a constructor, etc.
@@ -1842,9 +1890,12 @@ ParserStatus Parser::parseDecl(ParseDeclOptions Flags,
     return IfConfigResult;
   }
 
+  DeclInterfaceHashRAII DeclHash(SF, IsParsingInterfaceTokens);
+
   Decl* LastDecl = nullptr;
   auto InternalHandler  = [&](Decl *D) {
     LastDecl = D;
+    DeclHash.addDecl(D);
     Handler(D);
   };
 
@@ -2232,6 +2283,11 @@ void Parser::parseDeclDelayed() {
   ContextChange CC(*this, DelayedState->ParentContext);
 
   parseDecl(ParseDeclOptions(DelayedState->Flags), [](Decl *D) {});
+
+  // The declaration may be parsed again for code completion in a new version
+  // of the buffer.
+  DelayedState->Scope = getScopeInfo().saveCurrentScope();
+  State->restoreDelayedDeclState(std::move(DelayedState));
 }
 
 /// \brief Parse an 'import' declaration, doing no token skipping on error.
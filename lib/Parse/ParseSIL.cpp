@@ -687,7 +687,9 @@ static bool parseDeclSILOptional(bool *isTransparent, bool *isFragile,
                                  SmallVectorImpl<std::string> *Semantics,
                                  SmallVectorImpl<ParsedSpecAttr> *SpecAttrs,
                                  ValueDecl **ClangDecl,
-                                 EffectsKind *MRK, SILParser &SP) {
+                                 EffectsKind *MRK,
+                                 Optional<uint64_t> *EntryCount,
+                                 SILParser &SP) {
   while (SP.P.consumeIf(tok::l_square)) {
     if (isLet && SP.P.Tok.is(tok::kw_let)) {
       *isLet = true;
@@ -749,6 +751,16 @@ static bool parseDeclSILOptional(bool *isTransparent, bool *isFragile,
       SP.P.parseToken(tok::r_square, diag::expected_in_attribute_list);
       continue;
     }
+    else if (EntryCount && SP.P.Tok.getText() == "entry_count") {
+      SP.P.consumeToken(tok::identifier);
+      uint64_t Count;
+      if (SP.parseInteger(Count, diag::expected_in_attribute_list))
+        return true;
+      *EntryCount = Count;
+
+      SP.P.parseToken(tok::r_square, diag::expected_in_attribute_list);
+      continue;
+    }
     else if (ClangDecl && SP.P.Tok.getText() == "clang") {
       SP.P.consumeToken(tok::identifier);
       if (SP.parseSILDottedPathWithoutPound(*ClangDecl))
@@ -4014,10 +4026,11 @@ bool Parser::parseDeclSIL() {
   SmallVector<ParsedSpecAttr, 4> SpecAttrs;
   ValueDecl *ClangDecl = nullptr;
   EffectsKind MRK = EffectsKind::Unspecified;
+  Optional<uint64_t> EntryCount;
   if (parseSILLinkage(FnLinkage, *this) ||
       parseDeclSILOptional(&isTransparent, &isFragile, &isThunk, &isGlobalInit,
                            &inlineStrategy, nullptr, &Semantics, &SpecAttrs,
-                           &ClangDecl, &MRK, FunctionState) ||
+                           &ClangDecl, &MRK, &EntryCount, FunctionState) ||
       parseToken(tok::at_sign, diag::expected_sil_function_name) ||
       parseIdentifier(FnName, FnNameLoc, diag::expected_sil_function_name) ||
       parseToken(tok::colon, diag::expected_sil_type))
@@ -4047,6 +4060,7 @@ bool Parser::parseDeclSIL() {
     FunctionState.F->setGlobalInit(isGlobalInit);
     FunctionState.F->setInlineStrategy(inlineStrategy);
     FunctionState.F->setEffectsKind(MRK);
+    FunctionState.F->setEntryCount(EntryCount);
     if (ClangDecl)
       FunctionState.F->setClangNodeOwner(ClangDecl);
     for (auto &Attr : Semantics) {
@@ -4177,7 +4191,7 @@ bool Parser::parseSILGlobal() {
   if (parseSILLinkage(GlobalLinkage, *this) ||
       parseDeclSILOptional(nullptr, &isFragile, nullptr, nullptr,
                            nullptr, &isLet, nullptr, nullptr, nullptr,
-                           nullptr, State) ||
+                           nullptr, nullptr, State) ||
       parseToken(tok::at_sign, diag::expected_sil_value_name) ||
       parseIdentifier(GlobalName, NameLoc, diag::expected_sil_value_name) ||
       parseToken(tok::colon, diag::expected_sil_type))
@@ -4500,7 +4514,7 @@ bool Parser::parseSILWitnessTable() {
   bool isFragile = false;
   if (parseDeclSILOptional(nullptr, &isFragile, nullptr, nullptr,
                            nullptr, nullptr, nullptr, nullptr, nullptr,
-                           nullptr, WitnessState))
+                           nullptr, nullptr, WitnessState))
     return true;
 
   Scope S(this, ScopeKind::TopLevel);
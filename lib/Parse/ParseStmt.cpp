@@ -414,7 +414,8 @@ ParserStatus Parser::parseBraceItems(SmallVectorImpl<ASTNode> &Entries,
     if (!NeedParseErrorRecovery && !PreviousHadSemi && Tok.is(tok::semi)) {
       if (Result) {
         if (Result.is<Expr*>()) {
-          Result.get<Expr*>()->TrailingSemiLoc = consumeToken(tok::semi);
+          Result.get<Expr*>()->setTrailingSemiLoc(Context,
+                                                   consumeToken(tok::semi));
         } else {
           Result.get<Stmt*>()->TrailingSemiLoc = consumeToken(tok::semi);
         }
@@ -487,6 +488,11 @@ void Parser::parseTopLevelCodeDeclDelayed() {
     auto Brace = BraceStmt::create(Context, StartLoc, Result, Tok.getLoc());
     TLCD->setBody(Brace);
   }
+
+  // The code may be parsed again for code completion in a new version of the
+  // buffer.
+  DelayedState->Scope = getScopeInfo().saveCurrentScope();
+  State->restoreDelayedDeclState(std::move(DelayedState));
 }
 
 /// Recover from a 'case' or 'default' outside of a 'switch' by consuming up to
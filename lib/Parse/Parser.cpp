@@ -164,6 +164,13 @@ void swift::performDelayedParsing(
     parseDelayedDecl(PersistentState, CodeCompletionFactory);
 }
 
+void swift::performCodeCompletionReparsing(
+    PersistentParserState &PersistentState,
+    CodeCompletionCallbacksFactory *CodeCompletionFactory) {
+  SharedTimer timer("Parsing");
+  parseDelayedDecl(PersistentState, CodeCompletionFactory);
+}
+
 /// \brief Tokenizes a string literal, taking into account string interpolation.
 static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
                                 const SourceManager &SM,
@@ -584,7 +591,7 @@ bool Parser::parseSpecificIdentifier(StringRef expected, SourceLoc &loc,
 bool Parser::parseAnyIdentifier(Identifier &Result, SourceLoc &Loc,
                                 const Diagnostic &D) {
   if (Tok.is(tok::identifier) || Tok.isAnyOperator()) {
-    Result = Context.getIdentifier(Tok.getText());
+    Result = getIdentifierForToken(Tok);
     Loc = Tok.getLoc();
     consumeToken();
     return false;
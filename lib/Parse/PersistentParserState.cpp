@@ -16,6 +16,7 @@
 
 #include "swift/AST/Decl.h"
 #include "swift/AST/Expr.h"
+#include "swift/Basic/SourceManager.h"
 #include "swift/Parse/PersistentParserState.h"
 
 using namespace swift;
@@ -79,6 +80,22 @@ void PersistentParserState::delayDecl(DelayedDeclKind Kind,
       ScopeInfo.saveCurrentScope()));
 }
 
+void PersistentParserState::moveDelayedDecl(SourceManager &SM,
+                                            unsigned OldBufferID,
+                                            unsigned NewBufferID,
+                                            int EndDelta) {
+  auto moveLoc = [&](SourceLoc Loc, int Delta) {
+    if (Loc.isInvalid())
+      return Loc;
+    unsigned Offset = SM.getLocOffsetInBuffer(Loc, OldBufferID);
+    return SM.getLocForOffset(NewBufferID, Offset + Delta);
+  };
+  auto &State = *CodeCompletionDelayedDeclState;
+  State.BodyPos.Loc = moveLoc(State.BodyPos.Loc, 0);
+  State.BodyPos.PrevLoc = moveLoc(State.BodyPos.PrevLoc, 0);
+  State.BodyEnd = moveLoc(State.BodyEnd, EndDelta);
+}
+
 void PersistentParserState::delayTopLevel(TopLevelCodeDecl *TLCD,
                                           SourceRange BodyRange,
                                           SourceLoc PreviousLoc) {
@@ -2196,34 +2196,42 @@ public:
   void writeImports(raw_ostream &out) {
     out << "#if defined(__has_feature) && __has_feature(modules)\n";
 
-    // Track printed names to handle overlay modules.
-    llvm::SmallPtrSet<Identifier, 8> seenImports;
+    // The imports are collected in the order the declarations using them are
+    // printed. Sort them by name, so that the header doesn't change, and its
+    // clients aren't rebuilt, when unrelated declarations move around.
+    // Sorting also drops the duplicate names of overlay modules.
+    SmallVector<std::string, 8> importNames;
     bool includeUnderlying = false;
     for (auto import : imports) {
       if (auto *swiftModule = import.dyn_cast<Module *>()) {
-        auto Name = swiftModule->getName();
         if (isUnderlyingModule(swiftModule)) {
           includeUnderlying = true;
           continue;
         }
-        if (seenImports.insert(Name).second)
-          out << "@import " << Name.str() << ";\n";
+        importNames.push_back(swiftModule->getName().str());
       } else {
         const auto *clangModule = import.get<const clang::Module *>();
-        out << "@import ";
         // FIXME: This should be an API on clang::Module.
         SmallVector<StringRef, 4> submoduleNames;
         do {
           submoduleNames.push_back(clangModule->Name);
           clangModule = clangModule->Parent;
         } while (clangModule);
+        std::string name;
+        llvm::raw_string_ostream nameOut(name);
         interleave(submoduleNames.rbegin(), submoduleNames.rend(),
-                   [&out](StringRef next) { out << next; },
-                   [&out] { out << "."; });
-        out << ";\n";
+                   [&nameOut](StringRef next) { nameOut << next; },
+                   [&nameOut] { nameOut << "."; });
+        importNames.push_back(nameOut.str());
       }
     }
 
+    std::sort(importNames.begin(), importNames.end());
+    importNames.erase(std::unique(importNames.begin(), importNames.end()),
+                      importNames.end());
+    for (auto &name : importNames)
+      out << "@import " << name << ";\n";
+
     out << "#endif\n\n";
 
     if (includeUnderlying) {
@@ -52,6 +52,42 @@ bool DominanceInfo::properlyDominates(SILInstruction *a, SILInstruction *b) {
   return false;
 }
 
+void DominanceInfo::insertEdge(SILBasicBlock *From, SILBasicBlock *To) {
+  // An edge from an unreachable block does not make anything reachable.
+  auto *FromNode = getNode(From);
+  if (!FromNode)
+    return;
+
+  // If the immediate dominator of To also dominates From, all new paths to To
+  // still pass through all dominators of To. And all paths from To to other
+  // blocks already existed, so no other dominator changes either.
+  if (auto *ToNode = getNode(To)) {
+    if (auto *IDom = ToNode->getIDom())
+      if (dominates(IDom, FromNode))
+        return;
+  }
+  recalculate(*From->getParent());
+}
+
+void DominanceInfo::deleteEdge(SILBasicBlock *From, SILBasicBlock *To) {
+  auto *FromNode = getNode(From);
+  if (!FromNode)
+    return;
+
+  // There is another edge between the two blocks, e.g. a cond_br with both
+  // successors being the same block.
+  for (auto *Pred : To->getPreds())
+    if (Pred == From)
+      return;
+
+  // A path over a back edge visits To before From, so removing the edge does
+  // not remove any path on which a block is not dominated.
+  if (auto *ToNode = getNode(To))
+    if (dominates(ToNode, FromNode))
+      return;
+  recalculate(*From->getParent());
+}
+
 void DominanceInfo::verify() const {
   // Recompute.
   auto *F = getRoot()->getParent();
@@ -16,6 +16,7 @@
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "swift/SIL/FormalLinkage.h"
 #include <functional>
@@ -24,6 +25,16 @@ using namespace swift;
 using namespace Lowering;
 
 STATISTIC(NumFuncLinked, "Number of SIL functions linked");
+STATISTIC(NumFuncSkippedBySize,
+          "Number of large SIL functions not linked in link-all mode");
+
+/// In link-all mode, the bodies of callees with more instructions are only
+/// linked if something requires them, because they will not be inlined
+/// anyway.
+static llvm::cl::opt<unsigned> LinkAllBodySizeLimit(
+    "sil-link-all-body-size-limit", llvm::cl::init(500),
+    llvm::cl::desc("The maximum number of instructions of a function which "
+                   "is linked only because of -sil-link-all"));
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -59,6 +70,9 @@ bool SILLinkerVisitor::processFunction(SILFunction *F) {
 
   // If F is a declaration, first deserialize it.
   if (F->isExternalDeclaration()) {
+    if (isLinkAll() && !shouldLinkCallee(F))
+      return false;
+
     auto *NewFn = Loader->lookupSILFunction(F);
 
     if (!NewFn || NewFn->isExternalDeclaration())
@@ -194,6 +208,37 @@ bool SILLinkerVisitor::linkInVTable(ClassDecl *D) {
   return Result;
 }
 
+/// Returns true if the body of \p Callee, which is referenced by a function
+/// which is linked, should be linked as well.
+bool SILLinkerVisitor::shouldLinkCallee(SILFunction *Callee) {
+  // The bodies of transparent and shared functions are needed, no matter how
+  // large they are.
+  if (Callee->isTransparent() || hasSharedVisibility(Callee->getLinkage()))
+    return true;
+
+  if (!isLinkAll())
+    return false;
+
+  // The body of a large function is only useful for inlining or
+  // specialization. Look at the size of the serialized body before
+  // deserializing it. The body is still linked if the function is generic,
+  // has semantics which the optimizer knows about or must always be inlined.
+  if (!Callee->isExternalDeclaration() ||
+      Callee->getLoweredFunctionType()->isPolymorphic() ||
+      Callee->getInlineStrategy() == AlwaysInline ||
+      !Callee->getSemanticsAttrs().empty())
+    return true;
+
+  auto Size = Loader->getSILFunctionBodySize(Callee->getName());
+  if (!Size || *Size <= LinkAllBodySizeLimit)
+    return true;
+
+  DEBUG(llvm::dbgs() << "Not linking large function " << Callee->getName()
+                     << " (" << *Size << " instructions)\n");
+  ++NumFuncSkippedBySize;
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 //                                  Visitors
 //===----------------------------------------------------------------------===//
@@ -205,9 +250,9 @@ bool SILLinkerVisitor::visitApplyInst(ApplyInst *AI) {
     return false;
 
   // If the linking mode is not link all, AI is not transparent, and the
-  // callee is not shared, we don't want to perform any linking.
-  if (!isLinkAll() && !Callee->isTransparent() &&
-      !hasSharedVisibility(Callee->getLinkage()))
+  // callee is not shared, or the callee is too large to be worth linking, we
+  // don't want to perform any linking.
+  if (!shouldLinkCallee(Callee))
     return false;
 
   // Otherwise we want to try and link in the callee... Add it to the callee
@@ -220,8 +265,7 @@ bool SILLinkerVisitor::visitPartialApplyInst(PartialApplyInst *PAI) {
   SILFunction *Callee = PAI->getReferencedFunction();
   if (!Callee)
     return false;
-  if (!isLinkAll() && !Callee->isTransparent() &&
-      !hasSharedVisibility(Callee->getLinkage()))
+  if (!shouldLinkCallee(Callee))
     return false;
 
   addFunctionToWorklist(Callee);
@@ -233,8 +277,7 @@ bool SILLinkerVisitor::visitFunctionRefInst(FunctionRefInst *FRI) {
   // behind as dead code. This shouldn't happen, but if it does don't get into
   // an inconsistent state.
   SILFunction *Callee = FRI->getReferencedFunction();
-  if (!isLinkAll() && !Callee->isTransparent() &&
-      !hasSharedVisibility(Callee->getLinkage()))
+  if (!shouldLinkCallee(Callee))
     return false;
 
   addFunctionToWorklist(FRI->getReferencedFunction());
@@ -101,6 +101,9 @@ private:
 
   bool linkInVTable(ClassDecl *D);
 
+  /// Returns true if the body of the callee \p Callee should be linked.
+  bool shouldLinkCallee(SILFunction *Callee);
+
   // Main loop of the visitor. Called by one of the other *visit* methods.
   bool process();
 };
@@ -143,6 +143,13 @@ setArgumentBoxToStack(unsigned ArgNo) {
   Args[ArgNo].first = ArgumentModifierIntBase(ArgumentModifier::BoxToStack);
 }
 
+void
+FunctionSignatureSpecializationMangler::
+setArgumentExistentialToGeneric(unsigned ArgNo) {
+  Args[ArgNo].first =
+      ArgumentModifierIntBase(ArgumentModifier::ExistentialToGeneric);
+}
+
 void
 FunctionSignatureSpecializationMangler::
 setReturnValueOwnedToUnowned() {
@@ -269,6 +276,12 @@ void FunctionSignatureSpecializationMangler::mangleArgument(
     return;
   }
 
+  if (ArgMod ==
+      ArgumentModifierIntBase(ArgumentModifier::ExistentialToGeneric)) {
+    M.append("e");
+    return;
+  }
+
   bool hasSomeMod = false;
   if (ArgMod & ArgumentModifierIntBase(ArgumentModifier::Dead)) {
     M.append("d");
@@ -54,6 +54,15 @@ SILBasicBlock::~SILBasicBlock() {
     erase(Inst);
   }
 
+  // Arguments which are still used by instructions in other blocks are
+  // leaked.
+  for (auto *Arg : BBArgList) {
+    if (!Arg->use_empty())
+      continue;
+    Arg->~SILArgument();
+    M.deallocateArgument(Arg);
+  }
+
   // iplist's destructor is going to destroy the InstList.
   InstList.clearAndLeakNodesUnsafely();
 }
@@ -114,12 +123,12 @@ SILArgument *SILBasicBlock::replaceBBArg(unsigned i, SILType Ty,
 
   // Notify the delete handlers that this argument is being deleted.
   M.notifyDeleteHandlers(BBArgList[i]);
+  SILArgument *OldArg = BBArgList[i];
+  OldArg->~SILArgument();
+  M.deallocateArgument(OldArg);
 
   auto *NewArg = new (M) SILArgument(Ty, D);
   NewArg->setParent(this);
-
-  // TODO: When we switch to malloc/free allocation we'll be leaking memory
-  // here.
   BBArgList[i] = NewArg;
 
   return NewArg;
@@ -138,8 +147,11 @@ void SILBasicBlock::eraseBBArg(int Index) {
   assert(getBBArg(Index)->use_empty() &&
          "Erasing block argument that has uses!");
   // Notify the delete handlers that this BB argument is going away.
-  getModule().notifyDeleteHandlers(getBBArg(Index));
+  SILArgument *Arg = getBBArg(Index);
+  getModule().notifyDeleteHandlers(Arg);
   BBArgList.erase(BBArgList.begin() + Index);
+  Arg->~SILArgument();
+  getModule().deallocateArgument(Arg);
 }
 
 /// \brief Splits a basic block into two at the specified instruction.
@@ -168,6 +180,12 @@ void SILBasicBlock::moveAfter(SILBasicBlock *After) {
   BlkList.splice(InsertPt, BlkList, this);
 }
 
+void llvm::ilist_traits<swift::SILBasicBlock>::deleteNode(SILBasicBlock *BB) {
+  SILModule &M = BB->getModule();
+  BB->~SILBasicBlock();
+  M.deallocateBlock(BB);
+}
+
 void
 llvm::ilist_traits<swift::SILBasicBlock>::
 transferNodesFromList(llvm::ilist_traits<SILBasicBlock> &SrcTraits,
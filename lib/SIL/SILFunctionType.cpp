@@ -887,18 +887,26 @@ struct DeallocatorConventions : Conventions {
 namespace {
   /// The default Swift conventions.
   struct DefaultConventions : Conventions {
+    /// Whether normal (non-self) parameters are passed at +0 with a
+    /// guarantee from the caller instead of at +1.
+    bool GuaranteedNormalArguments;
 
-    DefaultConventions()
-      : Conventions(ConventionsKind::Default) {}
+    explicit DefaultConventions(bool guaranteedNormalArguments = false)
+      : Conventions(ConventionsKind::Default),
+        GuaranteedNormalArguments(guaranteedNormalArguments) {}
 
     ParameterConvention getIndirectParameter(unsigned index,
                               const AbstractionPattern &type) const override {
-      return ParameterConvention::Indirect_In;
+      return GuaranteedNormalArguments
+        ? ParameterConvention::Indirect_In_Guaranteed
+        : ParameterConvention::Indirect_In;
     }
 
     ParameterConvention getDirectParameter(unsigned index,
                               const AbstractionPattern &type) const override {
-      return ParameterConvention::Direct_Owned;
+      return GuaranteedNormalArguments
+        ? ParameterConvention::Direct_Guaranteed
+        : ParameterConvention::Direct_Owned;
     }
 
     ParameterConvention getCallee() const override {
@@ -925,8 +933,11 @@ namespace {
   };
   
   /// The default conventions for Swift initializing constructors.
+  ///
+  /// Initializers usually store their arguments, so they always take them at
+  /// +1.
   struct DefaultInitializerConventions : DefaultConventions {
-    using DefaultConventions::DefaultConventions;
+    DefaultInitializerConventions() : DefaultConventions(false) {}
   
     /// Initializers must take 'self' at +1, since they will return it back
     /// at +1, and may chain onto Objective-C initializers that replace the
@@ -980,6 +991,29 @@ namespace {
   };
 }
 
+/// Returns true if the normal parameters of \p constant are passed
+/// @guaranteed.
+///
+/// Like initializers, enum element constructors and setters store their
+/// arguments, so they keep taking them at +1.
+static bool hasGuaranteedNormalArguments(SILModule &M,
+                                         Optional<SILDeclRef> constant,
+                                         SILDeclRef::Kind kind) {
+  if (!M.getOptions().EnableGuaranteedNormalArguments)
+    return false;
+  // Enum elements and initializers store their arguments, so they keep
+  // taking them at +1.
+  if (kind == SILDeclRef::Kind::EnumElement ||
+      kind == SILDeclRef::Kind::Allocator ||
+      kind == SILDeclRef::Kind::Initializer)
+    return false;
+  if (constant && constant->hasDecl())
+    if (auto *FD = dyn_cast<FuncDecl>(constant->getDecl()))
+      if (FD->isSetter())
+        return false;
+  return true;
+}
+
 static CanSILFunctionType getNativeSILFunctionType(SILModule &M,
                                          AbstractionPattern origType,
                                          CanAnyFunctionType substInterfaceType,
@@ -1015,9 +1049,10 @@ static CanSILFunctionType getNativeSILFunctionType(SILModule &M,
     case SILDeclRef::Kind::IVarInitializer:
     case SILDeclRef::Kind::IVarDestroyer:
     case SILDeclRef::Kind::EnumElement:
-      return getSILFunctionType(M, origType, substInterfaceType,
-                                extInfo, DefaultConventions(),
-                                None, constant);
+      return getSILFunctionType(M, origType, substInterfaceType, extInfo,
+                 DefaultConventions(hasGuaranteedNormalArguments(M, constant,
+                                                                 kind)),
+                 None, constant);
     case SILDeclRef::Kind::Deallocator:
       return getSILFunctionType(M, origType, substInterfaceType,
                                 extInfo, DeallocatorConventions(), None,
@@ -69,6 +69,7 @@ SILBasicBlock *llvm::ilist_traits<SILInstruction>::getContainingBlock() {
 void llvm::ilist_traits<SILInstruction>::addNodeToList(SILInstruction *I) {
   assert(I->ParentBB == 0 && "Already in a list!");
   I->ParentBB = getContainingBlock();
+  I->markModified();
 }
 
 void llvm::ilist_traits<SILInstruction>::removeNodeFromList(SILInstruction *I) {
@@ -87,8 +88,10 @@ transferNodesFromList(llvm::ilist_traits<SILInstruction> &L2,
   if (ThisParent == L2.getContainingBlock()) return;
 
   // Update the parent fields in the instructions.
-  for (; first != last; ++first)
+  for (; first != last; ++first) {
     first->ParentBB = ThisParent;
+    first->markModified();
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -107,6 +110,14 @@ const SILFunction *SILInstruction::getFunction() const {
   return getParent()->getParent();
 }
 
+void SILInstruction::markModified() {
+  if (!ParentBB)
+    return;
+  SILFunction *F = ParentBB->getParent();
+  if (F && F->tracksModifications())
+    ModificationEpoch = F->getModificationEpoch();
+}
+
 SILModule &SILInstruction::getModule() const {
   return getFunction()->getModule();
 }
@@ -757,6 +768,14 @@ MutableArrayRef<Operand> SILInstruction::getTypeDependentOperands() {
   return TypeDependentOperandsMutableAccessor().visit(this);
 }
 
+void Operand::markUseChanged() {
+  // Both the user and the instruction which defines the used value changed.
+  if (Owner)
+    Owner->markModified();
+  if (auto *Def = dyn_cast<SILInstruction>(TheValue))
+    Def->markModified();
+}
+
 /// getOperandNumber - Return which operand this is in the operand list of the
 /// using instruction.
 unsigned Operand::getOperandNumber() const {
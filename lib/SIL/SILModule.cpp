@@ -15,6 +15,7 @@
 #include "swift/AST/GenericEnvironment.h"
 #include "swift/AST/Substitution.h"
 #include "swift/SIL/FormalLinkage.h"
+#include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/SIL/SILModule.h"
 #include "Linker.h"
@@ -100,6 +101,7 @@ SILModule::~SILModule() {
 }
 
 void *SILModule::allocate(unsigned Size, unsigned Align) const {
+  BytesAllocated += Size;
   if (getASTContext().LangOpts.UseMalloc)
     return AlignedAlloc(Size, Align);
 
@@ -107,6 +109,7 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
 }
 
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
+  BytesAllocated += Size;
   return AlignedAlloc(Size, Align);
 }
 
@@ -114,6 +117,42 @@ void SILModule::deallocateInst(SILInstruction *I) {
   AlignedFree(I);
 }
 
+/// Pops a recycled piece of memory from \p FreeList or allocates a new one.
+static void *allocateRecycled(const SILModule &M, std::vector<void *> &FreeList,
+                              unsigned Size, unsigned Align) {
+  if (FreeList.empty())
+    return M.allocate(Size, Align);
+  void *Mem = FreeList.back();
+  FreeList.pop_back();
+  return Mem;
+}
+
+void *SILModule::allocateBlock(unsigned Size, unsigned Align) const {
+  assert(Size == sizeof(SILBasicBlock) && "blocks are not tail allocated");
+  return allocateRecycled(*this, FreeBlocks, Size, Align);
+}
+
+void SILModule::deallocateBlock(SILBasicBlock *BB) {
+  if (getASTContext().LangOpts.UseMalloc) {
+    AlignedFree(BB);
+    return;
+  }
+  FreeBlocks.push_back(BB);
+}
+
+void *SILModule::allocateArgument(unsigned Size, unsigned Align) const {
+  assert(Size == sizeof(SILArgument) && "arguments are not tail allocated");
+  return allocateRecycled(*this, FreeArguments, Size, Align);
+}
+
+void SILModule::deallocateArgument(SILArgument *Arg) {
+  if (getASTContext().LangOpts.UseMalloc) {
+    AlignedFree(Arg);
+    return;
+  }
+  FreeArguments.push_back(Arg);
+}
+
 SILWitnessTable *
 SILModule::createWitnessTableDeclaration(ProtocolConformance *C,
                                          SILLinkage linkage) {
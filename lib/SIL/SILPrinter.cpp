@@ -1764,11 +1764,14 @@ static void printLinkage(llvm::raw_ostream &OS, SILLinkage linkage,
 void SILFunction::print(SILPrintContext &PrintCtx) const {
   auto &SM = getModule().getASTContext().SourceMgr;
   llvm::raw_ostream &OS = PrintCtx.OS();
-  for (auto &BB : *this)
-    for (auto &I : BB) {
-      SILPrinter P(PrintCtx);
-      P.printDebugScope(I.getDebugScope(), SM);
-    }
+  {
+    // Use a single printer for the scopes of all instructions; setting up a
+    // printer for each of them dominates printing large functions.
+    SILPrinter P(PrintCtx);
+    for (auto &BB : *this)
+      for (auto &I : BB)
+        P.printDebugScope(I.getDebugScope(), SM);
+  }
   OS << "\n";
 
   OS << "// " << demangleSymbol(getName()) << '\n';
@@ -1803,6 +1806,9 @@ void SILFunction::print(SILPrintContext &PrintCtx) const {
   if (getEffectsKind() == EffectsKind::ReadWrite)
     OS << "[readwrite] ";
 
+  if (auto Count = getEntryCount())
+    OS << "[entry_count " << *Count << "] ";
+
   for (auto &Attr : getSemanticsAttrs())
     OS << "[_semantics \"" << Attr << "\"] ";
 
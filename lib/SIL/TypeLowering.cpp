@@ -30,11 +30,21 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/TypeLowering.h"
 #include "clang/AST/Type.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 using namespace Lowering;
 
+STATISTIC(NumIndependentLoweringHits,
+          "Number of cached lowerings of independent types");
+STATISTIC(NumDependentLoweringHits,
+          "Number of cached lowerings of dependent types");
+STATISTIC(NumIndependentLoweringMisses,
+          "Number of lowerings of independent types");
+STATISTIC(NumDependentLoweringMisses,
+          "Number of lowerings of dependent types");
+
 namespace {
   /// A CRTP type visitor for deciding whether the metatype for a type
   /// is a singleton type, i.e. whether there can only ever be one
@@ -1196,6 +1206,14 @@ TypeConverter::~TypeConverter() {
     if (srcType == mappedType || isa<InOutType>(srcType))
       ti.second->~TypeLowering();
   }
+  for (auto &ti : DependentTypes) {
+    // Destroy only the unique entries.
+    CanType srcType = ti.first.second.OrigType;
+    if (!srcType) continue;
+    CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
+    if (srcType == mappedType || isa<LValueType>(srcType))
+      ti.second->~TypeLowering();
+  }
 }
 
 void *TypeLowering::operator new(size_t size, TypeConverter &tc,
@@ -1208,22 +1226,36 @@ void *TypeLowering::operator new(size_t size, TypeConverter &tc,
 const TypeLowering *TypeConverter::find(TypeKey k) {
   if (!k.isCacheable()) return nullptr;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
-  auto ck = k.getCachingKey();
-  auto found = Types.find(ck);
-  if (found == Types.end())
-    return nullptr;
+  const TypeLowering *result;
+  if (k.isDependent()) {
+    auto found = DependentTypes.find({CurGenericContext, k.getCachingKey()});
+    if (found == DependentTypes.end()) {
+      ++NumDependentLoweringMisses;
+      return nullptr;
+    }
+    ++NumDependentLoweringHits;
+    result = found->second;
+  } else {
+    auto found = IndependentTypes.find(k.getCachingKey());
+    if (found == IndependentTypes.end()) {
+      ++NumIndependentLoweringMisses;
+      return nullptr;
+    }
+    ++NumIndependentLoweringHits;
+    result = found->second;
+  }
 
-  assert(found->second && "type recursion not caught in Sema");
-  return found->second;
+  assert(result && "type recursion not caught in Sema");
+  return result;
 }
 
 void TypeConverter::insert(TypeKey k, const TypeLowering *tl) {
   if (!k.isCacheable()) return;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
-
-  Types[k.getCachingKey()] = tl;
+  if (k.isDependent())
+    DependentTypes[{CurGenericContext, k.getCachingKey()}] = tl;
+  else
+    IndependentTypes[k.getCachingKey()] = tl;
 }
 
 #ifndef NDEBUG
@@ -1923,7 +1955,6 @@ void TypeConverter::pushGenericContext(CanGenericSignature sig) {
     return;
   
   // GenericFunctionTypes shouldn't nest.
-  assert(DependentTypes.empty() && "already in generic context?!");
   assert(!CurGenericContext && "already in generic context!");
 
   CurGenericContext = sig;
@@ -1935,21 +1966,9 @@ void TypeConverter::popGenericContext(CanGenericSignature sig) {
     return;
 
   assert(CurGenericContext == sig && "unpaired push/pop");
-  
-  // Erase our cached TypeLowering objects and associated mappings for dependent
-  // types.
-  // Resetting the DependentBPA will deallocate but not run the destructor of
-  // the dependent TypeLowerings.
-  for (auto &ti : DependentTypes) {
-    // Destroy only the unique entries.
-    CanType srcType = ti.first.OrigType;
-    if (!srcType) continue;
-    CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
-    if (srcType == mappedType || isa<LValueType>(srcType))
-      ti.second->~TypeLowering();
-  }
-  DependentTypes.clear();
-  DependentBPA.Reset();
+
+  // The cached lowerings of dependent types are kept for the next context
+  // with the same generic signature.
   CurGenericContext = nullptr;
 }
 
@@ -27,6 +27,7 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "RValue.h"
 using namespace swift;
@@ -39,6 +40,16 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const SILOptions &Opts = M.getOptions();
+  if (!Opts.UseProfile.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(Opts.UseProfile);
+    if (auto E = ReaderOrErr.takeError()) {
+      diagnose(SourceLoc(), diag::profile_read_error, Opts.UseProfile,
+               llvm::toString(std::move(E)));
+    } else {
+      PGOReader = std::move(ReaderOrErr.get());
+    }
+  }
 }
 
 SILGenModule::~SILGenModule() {
@@ -746,6 +757,11 @@ void SILGenModule::emitConstructor(ConstructorDecl *decl) {
   // Emit any default argument getter functions.
   emitAbstractFuncDecl(decl);
 
+  // The body was not type-checked because it isn't needed; references to the
+  // constructor become external declarations.
+  if (decl->getBodyKind() == AbstractFunctionDecl::BodyKind::Skipped)
+    return;
+
   // We never emit constructors in protocols.
   if (isa<ProtocolDecl>(decl->getDeclContext()))
     return;
@@ -1461,6 +1477,14 @@ SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
         M->getSILLoader()->getAllForModule(mod->getName(), file);
     }
   } else {
+    // FIXME: The files, and most function bodies within them, could be
+    // emitted independently, but not on several threads yet. Emitting a body
+    // creates and uniques types and substitutions in the ASTContext, fills the
+    // type lowering caches of the TypeConverter, allocates from the SILModule
+    // and inserts into its function list and symbol table, and forces delayed
+    // functions and conformances through the maps of this SILGenModule. None of
+    // these are locked, and the order of the function list has to stay
+    // deterministic. Under WMO, IRGen and LLVM already use -num-threads.
     for (auto file : mod->getFiles()) {
       auto nextSF = dyn_cast<SourceFile>(file);
       if (!nextSF || nextSF->ASTStage != SourceFile::TypeChecked)
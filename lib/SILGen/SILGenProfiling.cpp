@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -83,10 +84,11 @@ ProfilerRAII::ProfilerRAII(SILGenModule &SGM, Decl *D)
   assert(isa<AbstractFunctionDecl>(D) ||
          isa<TopLevelCodeDecl>(D) && "Cannot create profiler for this decl");
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  if ((!Opts.GenerateProfile && !SGM.PGOReader) || isUnmappedDecl(D))
     return;
   SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+      llvm::make_unique<SILGenProfiling>(SGM, Opts.GenerateProfile,
+                                         Opts.EmitProfileCoverageMapping);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -720,6 +722,21 @@ void SILGenProfiling::assignRegionCounters(Decl *Root) {
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
 
+  PGOFuncName = llvm::getPGOFuncName(
+      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
+      CurrentFileName);
+
+  if (SGM.PGOReader) {
+    // A profile without data for this function, or with data from a
+    // different version of it, is ignored.
+    std::vector<uint64_t> Counts;
+    if (auto E = SGM.PGOReader->getFunctionCounts(PGOFuncName, FunctionHash,
+                                                  Counts))
+      llvm::consumeError(std::move(E));
+    else if (Counts.size() == NumRegionCounters)
+      RegionCounts = std::move(Counts);
+  }
+
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SM);
     walkForProfiling(Root, Coverage);
@@ -748,13 +765,18 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   assert(CounterIt != RegionCounterMap.end() &&
          "cannot increment non-existent counter");
 
+  if (!RegionCounts.empty()) {
+    SILFunction &F = Builder.getFunction();
+    if (!F.getEntryCount() && Builder.getInsertionBB() == &F.front())
+      F.setEntryCount(RegionCounts[CounterIt->second]);
+  }
+
+  if (!EmitCounters)
+    return;
+
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
-  std::string PGOFuncName = llvm::getPGOFuncName(
-      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
-      CurrentFileName);
-
   SILLocation Loc = getLocation(Node);
   SILValue Args[] = {
       // The intrinsic must refer to the function profiling name var, which is
@@ -33,26 +33,37 @@ struct ProfilerRAII;
 class SILGenProfiling {
 private:
   SILGenModule &SGM;
+  bool EmitCounters;
   bool EmitCoverageMapping;
 
   // The current function's name and counter data.
   std::string CurrentFuncName;
+  std::string PGOFuncName;
   StringRef CurrentFileName;
   FormalLinkage CurrentFuncLinkage;
   unsigned NumRegionCounters;
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The execution count of each counter from the -profile-use file, or empty
+  /// if the profile has no data for the current function.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
-  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
-      : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
-        NumRegionCounters(0), FunctionHash(0) {}
+  SILGenProfiling(SILGenModule &SGM, bool EmitCounters,
+                  bool EmitCoverageMapping)
+      : SGM(SGM), EmitCounters(EmitCounters),
+        EmitCoverageMapping(EmitCoverageMapping), NumRegionCounters(0),
+        FunctionHash(0) {}
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
   /// Emit SIL to increment the counter for \c Node.
+  ///
+  /// If a profile is used and this is the first counter in the function's
+  /// entry block, its execution count becomes the function's entry count.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
 private:
@@ -17,10 +17,42 @@
 #include "swift/SILOptimizer/Analysis/LoopRegionAnalysis.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+STATISTIC(NumRegionStateLimitHits,
+          "Number of times a region tracked too many ref counted values");
+
+/// The maximum number of ref counted values which are tracked in each
+/// direction for a region. Every interesting instruction updates all tracked
+/// states and every merge looks up all of them, so without a limit large
+/// generated functions are quadratic in the number of values. Values beyond
+/// the limit are not optimized.
+static llvm::cl::opt<unsigned> MaxTrackedValuesPerRegion(
+    "arc-region-max-tracked-values", llvm::cl::init(256),
+    llvm::cl::desc("The maximum number of ref counted values which the loop "
+                   "ARC dataflow tracks per region"));
+
+/// Stop tracking the values in \p States which were added after the first
+/// MaxTrackedValuesPerRegion ones, and remove the blotted entries from
+/// \p States.
+template <typename MapTy> static void limitTrackedValues(MapTy &States) {
+  if (States.size() > MaxTrackedValuesPerRegion) {
+    ++NumRegionStateLimitHits;
+    unsigned NumTracked = 0;
+    for (auto &State : States) {
+      if (!State.hasValue())
+        continue;
+      if (++NumTracked > MaxTrackedValuesPerRegion)
+        States.blot(State->first);
+    }
+  }
+  States.compact();
+}
+
 //===----------------------------------------------------------------------===//
 //                               ARCRegionState
 //===----------------------------------------------------------------------===//
@@ -90,6 +122,11 @@ void ARCRegionState::mergeSuccBottomUp(ARCRegionState &SuccRegionState) {
       PtrToBottomUpState.blot(RefCountedValue);
     }
   }
+
+  // The intersection blots many values in large functions. Don't let them
+  // slow down the iteration over the state in this region and in the
+  // regions which are initialized with it.
+  PtrToBottomUpState.compact();
 }
 
 //===---
@@ -149,6 +186,9 @@ void ARCRegionState::mergePredTopDown(ARCRegionState &PredRegionState) {
       continue;
     }
   }
+
+  // See mergeSuccBottomUp.
+  PtrToTopDownState.compact();
 }
 
 //===---
@@ -305,6 +345,7 @@ bool ARCRegionState::processBlockBottomUp(
   // conservatively correct in all cases.
   processBlockBottomUpPredTerminators(R, AA, LRFI, SetFactory);
 
+  limitTrackedValues(PtrToBottomUpState);
   return NestingDetected;
 }
 
@@ -455,6 +496,7 @@ bool ARCRegionState::processBlockTopDown(
     }
   }
 
+  limitTrackedValues(PtrToTopDownState);
   return NestingDetected;
 }
 
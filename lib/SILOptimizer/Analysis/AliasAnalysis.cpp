@@ -24,12 +24,19 @@
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/InstructionUtils.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumAliasQueries, "Number of alias queries");
+STATISTIC(NumAliasCacheHits, "Number of alias queries answered by the cache");
+STATISTIC(NumAccessPathCacheHits,
+          "Number of access paths found in the cache");
+STATISTIC(NumDisjointFieldProjections,
+          "Number of no-alias results from disjoint field projections");
 
 // The AliasAnalysis Cache must not grow beyond this size.
 // We limit the size of the AA cache to 2**14 because we want to limit the
@@ -253,8 +260,8 @@ AliasResult AliasAnalysis::aliasAddressProjection(SILValue V1, SILValue V2,
     return AliasResult::NoAlias;
 
   // Let's do alias checking based on projections.
-  auto V1Path = ProjectionPath::getProjectionPath(O1, V1);
-  auto V2Path = ProjectionPath::getProjectionPath(O2, V2);
+  auto V1Path = getProjectionPathCached(V1);
+  auto V2Path = getProjectionPathCached(V2);
 
   // getUnderlyingPath and findAddressProjectionPathBetweenValues disagree on
   // what the base pointer of the two values are. Be conservative and return
@@ -512,6 +519,59 @@ static bool typedAccessTBAAMayAlias(SILType LTy, SILType RTy, SILModule &Mod) {
   return true;
 }
 
+/// Returns the operand of a struct or tuple element address projection, or
+/// null if \p V is not such a projection.
+static SILValue getFieldProjectionOperand(SILValue V) {
+  if (auto *SEAI = dyn_cast<StructElementAddrInst>(V))
+    return SEAI->getOperand();
+  if (auto *TEAI = dyn_cast<TupleElementAddrInst>(V))
+    return TEAI->getOperand();
+  return SILValue();
+}
+
+/// Returns true if \p V is derived from a TBAA safe address root by struct
+/// and tuple element projections only.
+static bool isFieldOfTBAASafeRoot(SILValue V) {
+  while (SILValue Op = getFieldProjectionOperand(V))
+    V = Op;
+  return isAddressRootTBAASafe(V);
+}
+
+/// Returns true if \p V1 and \p V2 project different fields of values of the
+/// same aggregate type, maybe followed by the same field projections.
+///
+/// A value type cannot contain itself, so two values of the same type in
+/// typed memory are either the same or don't overlap at all. Either way
+/// their different fields are disjoint, even if nothing is known about the
+/// objects which contain the two values.
+static bool areDisjointFieldProjections(SILValue V1, SILValue V2) {
+#ifndef NDEBUG
+  if (!shouldRunTypedAccessTBAA())
+    return false;
+#endif
+
+  while (true) {
+    SILValue Op1 = getFieldProjectionOperand(V1);
+    SILValue Op2 = getFieldProjectionOperand(V2);
+    if (!Op1 || !Op2 || Op1->getType() != Op2->getType() ||
+        Op1->getType().hasArchetype())
+      return false;
+
+    bool SameField;
+    if (auto *SEAI = dyn_cast<StructElementAddrInst>(V1))
+      SameField =
+          SEAI->getField() == cast<StructElementAddrInst>(V2)->getField();
+    else
+      SameField = cast<TupleElementAddrInst>(V1)->getFieldNo() ==
+                  cast<TupleElementAddrInst>(V2)->getFieldNo();
+    if (!SameField)
+      return isFieldOfTBAASafeRoot(Op1) && isFieldOfTBAASafeRoot(Op2);
+
+    V1 = Op1;
+    V2 = Op2;
+  }
+}
+
 bool AliasAnalysis::typesMayAlias(SILType T1, SILType T2) {
   // Both types need to be valid.
   if (!T2 || !T1)
@@ -529,6 +589,38 @@ bool AliasAnalysis::typesMayAlias(SILType T1, SILType T2) {
   return MA;
 }
 
+//===----------------------------------------------------------------------===//
+//                             Access Path Cache
+//===----------------------------------------------------------------------===//
+
+SILValue AliasAnalysis::getUnderlyingObjectCached(SILValue V) {
+  auto It = AccessPathCache.find(V);
+  if (It != AccessPathCache.end()) {
+    ++NumAccessPathCacheHits;
+    return It->second.Object;
+  }
+
+  if (AccessPathCache.size() > AliasAnalysisMaxCacheSize) {
+    AccessPathCache.clear();
+    AccessPathObjects.clear();
+  }
+
+  SILValue Object = getUnderlyingObject(V);
+  AccessPathCache[V].Object = Object;
+  AccessPathObjects.insert(Object);
+  return Object;
+}
+
+Optional<ProjectionPath> AliasAnalysis::getProjectionPathCached(SILValue V) {
+  SILValue Object = getUnderlyingObjectCached(V);
+  AccessPath &Entry = AccessPathCache[V];
+  if (!Entry.HasPath) {
+    Entry.Path = ProjectionPath::getProjectionPath(Object, V);
+    Entry.HasPath = true;
+  }
+  return Entry.Path;
+}
+
 //===----------------------------------------------------------------------===//
 //                                Entry Points
 //===----------------------------------------------------------------------===//
@@ -539,9 +631,12 @@ AliasResult AliasAnalysis::alias(SILValue V1, SILValue V2,
                                  SILType TBAAType1, SILType TBAAType2) {
   AliasKeyTy Key = toAliasKey(V1, V2, TBAAType1, TBAAType2);
 
+  ++NumAliasQueries;
+
   // Check if we've already computed this result.
   auto It = AliasCache.find(Key);
   if (It != AliasCache.end()) {
+    ++NumAliasCacheHits;
     return It->second;
   }
 
@@ -583,6 +678,12 @@ AliasResult AliasAnalysis::aliasInner(SILValue V1, SILValue V2,
   if (!typesMayAlias(TBAAType1, TBAAType2))
     return AliasResult::NoAlias;
 
+  // Different fields of values of the same type never overlap.
+  if (areDisjointFieldProjections(V1, V2)) {
+    ++NumDisjointFieldProjections;
+    return AliasResult::NoAlias;
+  }
+
 #ifndef NDEBUG
   if (!shouldRunBasicAA())
     return AliasResult::MayAlias;
@@ -596,8 +697,8 @@ AliasResult AliasAnalysis::aliasInner(SILValue V1, SILValue V2,
 
   // Ok, we need to actually compute an Alias Analysis result for V1, V2. Begin
   // by finding the "base" of V1, V2 by stripping off all casts and GEPs.
-  SILValue O1 = getUnderlyingObject(V1);
-  SILValue O2 = getUnderlyingObject(V2);
+  SILValue O1 = getUnderlyingObjectCached(V1);
+  SILValue O2 = getUnderlyingObjectCached(V2);
   DEBUG(llvm::dbgs() << "        Underlying V1:" << *O1);
   DEBUG(llvm::dbgs() << "        Underlying V2:" << *O2);
 
@@ -27,6 +27,8 @@
 
 using namespace swift;
 
+std::atomic<unsigned> SILAnalysis::NumParallelPassManagers;
+
 void SILAnalysis::verifyFunction(SILFunction *F) {
   // Only functions with bodies can be analyzed by the analysis.
   assert(F->isDefinition() && "Can't analyze external functions");
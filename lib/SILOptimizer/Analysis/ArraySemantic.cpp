@@ -461,6 +461,18 @@ ApplyInst *swift::ArraySemanticsCall::hoistOrCopy(SILInstruction *InsertBefore,
     return Call;
   }
 
+  case ArrayCallKind::kGetElementAddress: {
+    // The index argument is left as it is. If it does not dominate the insert
+    // point, the caller has to replace it.
+    auto HoistedSelf =
+        hoistOrCopySelf(SemanticsCall, InsertBefore, DT, LeaveOriginal);
+
+    auto *Call =
+        hoistOrCopyCall(SemanticsCall, InsertBefore, LeaveOriginal, DT);
+    Call->setSelfArgument(HoistedSelf);
+    return Call;
+  }
+
   case ArrayCallKind::kMakeMutable: {
     assert(!LeaveOriginal && "Copying not yet implemented");
     // Hoist the call.
@@ -32,6 +32,14 @@ public:
 
   virtual bool walkToDeclPre(Decl *D) {
     auto *NTD = dyn_cast<NominalTypeDecl>(D);
+    // Types declared in other modules may conform to protocols of this
+    // module via extensions.
+    if (auto *ED = dyn_cast<ExtensionDecl>(D)) {
+      if (Type ExtendedTy = ED->getExtendedType())
+        NTD = ExtendedTy->getAnyNominal();
+      if (NTD && NTD->getModuleContext() == ED->getModuleContext())
+        return true;
+    }
     if (!NTD)
       return true;
     auto Protocols = NTD->getAllProtocols();
@@ -39,7 +47,8 @@ public:
     if (!Protocols.empty()) {
       for (auto &Protocol : Protocols) {
         auto &K = ProtocolImplementationsCache[Protocol];
-        K.push_back(NTD);
+        if (std::find(K.begin(), K.end(), NTD) == K.end())
+          K.push_back(NTD);
       }
     }
     return true;
@@ -1309,6 +1309,20 @@ void EscapeAnalysis::analyzeInstruction(SILInstruction *I,
       if (Fn->getName() == "swift_bufferAllocate")
         // The call is a buffer allocation, e.g. for Array.
         return;
+
+      // A readnone function, e.g. a function of another module for which
+      // the effects are serialized, cannot store its arguments anywhere. But
+      // its result may still point to what the arguments point to.
+      if (Fn->getEffectsKind() == EffectsKind::ReadNone &&
+          isa<ApplyInst>(I) && !FAS.hasIndirectResults()) {
+        if (CGNode *ResultNode = ConGraph->getNode(I, this)) {
+          for (SILValue Arg : FAS.getArguments()) {
+            if (CGNode *ArgNode = ConGraph->getNode(Arg, this))
+              ConGraph->defer(ResultNode, ArgNode);
+          }
+        }
+        return;
+      }
     }
   }
 
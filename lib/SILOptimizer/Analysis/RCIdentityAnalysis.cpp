@@ -397,6 +397,47 @@ SILValue RCIdentityFunctionInfo::stripRCIdentityPreservingArgs(SILValue V,
   return FirstIV;
 }
 
+//===----------------------------------------------------------------------===//
+//                   RC Identity Aggregate Field Analysis
+//===----------------------------------------------------------------------===//
+
+/// If V is a struct_extract or tuple_extract of an aggregate whose RC identity
+/// root is a struct or tuple instruction of the same type, return the operand
+/// of that instruction which is extracted. Otherwise return SILValue().
+///
+/// This handles aggregates with more than one non-trivial field, which
+/// stripRCIdentityPreservingInsts can't look through, e.g.:
+///
+///   %2 = struct $S (%0 : $C, %1 : $C)
+///   br bb1(%2 : $S)
+/// bb1(%3 : $S):
+///   %4 = struct_extract %3 : $S, #S.f2  // RC identical to %1
+SILValue
+RCIdentityFunctionInfo::stripExtractOfAggregate(SILValue V,
+                                                unsigned RecursionDepth) {
+  if (auto *SEI = dyn_cast<StructExtractInst>(V)) {
+    SILValue Aggregate = SEI->getOperand();
+    SILValue Root = getRCIdentityRootInner(Aggregate, RecursionDepth + 1);
+    if (!Root || Root->getType() != Aggregate->getType())
+      return SILValue();
+    if (auto *SI = dyn_cast<StructInst>(Root))
+      return SI->getFieldValue(SEI->getField());
+    return SILValue();
+  }
+
+  if (auto *TEI = dyn_cast<TupleExtractInst>(V)) {
+    SILValue Aggregate = TEI->getOperand();
+    SILValue Root = getRCIdentityRootInner(Aggregate, RecursionDepth + 1);
+    if (!Root || Root->getType() != Aggregate->getType())
+      return SILValue();
+    if (auto *TI = dyn_cast<TupleInst>(Root))
+      return TI->getElement(TEI->getFieldNo());
+    return SILValue();
+  }
+
+  return SILValue();
+}
+
 llvm::cl::opt<bool> StripOffArgs(
     "enable-rc-identity-arg-strip", llvm::cl::init(true),
     llvm::cl::desc("Should RC identity try to strip off arguments"));
@@ -414,6 +455,13 @@ SILValue RCIdentityFunctionInfo::stripRCIdentityPreservingOps(SILValue V,
       continue;
     }
 
+    // Then look through extracts of fields of aggregates which are formed by
+    // a struct or tuple instruction somewhere up the chain.
+    if (SILValue NewV = stripExtractOfAggregate(V, RecursionDepth)) {
+      V = NewV;
+      continue;
+    }
+
     if (!StripOffArgs)
       break;
 
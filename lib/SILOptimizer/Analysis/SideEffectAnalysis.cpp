@@ -481,6 +481,7 @@ void SideEffectAnalysis::recompute(FunctionInfo *Initial) {
 }
 
 void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite FAS) {
+  ParallelPassLockGuard<std::recursive_mutex> Guard(Lock);
   assert(ApplyEffects.ParamEffects.size() == 0 &&
          "Not using a new ApplyEffects?");
   ApplyEffects.ParamEffects.resize(FAS.getNumArguments());
@@ -517,12 +518,14 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
 }
 
 void SideEffectAnalysis::invalidate(InvalidationKind K) {
+  ParallelPassLockGuard<std::recursive_mutex> Guard(Lock);
   Function2Info.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
 }
 
 void SideEffectAnalysis::invalidate(SILFunction *F, InvalidationKind K) {
+  ParallelPassLockGuard<std::recursive_mutex> Guard(Lock);
   if (FunctionInfo *FInfo = Function2Info.lookup(F)) {
     DEBUG(llvm::dbgs() << "  invalidate " << FInfo->F->getName() << '\n');
     invalidateIncludingAllCallers(FInfo);
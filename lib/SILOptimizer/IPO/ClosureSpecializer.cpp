@@ -52,6 +52,13 @@
 /// 3. Handling addresses. We currently do not handle address types. We can in
 ///    the future by introducing alloc_stacks.
 ///
+/// 4. Closures which are only passed on. A callee which does not invoke the
+///    closure itself but passes it to another function which does is
+///    specialized as well. The specialized callee then contains a copy of the
+///    closure which is passed on, and is specialized in turn when the pass
+///    visits it. This propagates a closure through several levels of calls
+///    down to the function which invokes it.
+///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "closure-specialization"
@@ -94,6 +101,38 @@ static bool isSupportedClosureKind(const SILInstruction *I) {
   return isa<ThinToThickFunctionInst>(I) || isa<PartialApplyInst>(I);
 }
 
+/// The maximum number of calls through which a closure argument is passed on
+/// before it is invoked, for the callee to be specialized.
+static const unsigned ClosureForwardingDepthLimit = 4;
+
+/// Returns true if the closure argument \p Arg of a function is invoked in the
+/// function or passed on to a function which invokes it, up to \p Depth
+/// levels of calls down.
+static bool isClosureArgumentInvoked(SILArgument *Arg, unsigned Depth) {
+  for (Operand *Op : Arg->getUses()) {
+    auto UserAI = FullApplySite::isa(Op->getUser());
+    if (!UserAI)
+      continue;
+    if (UserAI.getCallee() == SILValue(Arg))
+      return true;
+
+    // The closure is passed on to another function. Only follow calls which
+    // we can specialize.
+    if (Depth == 0 || UserAI.hasSubstitutions())
+      continue;
+    SILFunction *Callee = UserAI.getReferencedFunction();
+    if (!Callee || Callee->isExternalDeclaration() ||
+        Callee == Arg->getFunction())
+      continue;
+    for (unsigned i = 0, e = UserAI.getNumArguments(); i != e; ++i) {
+      if (UserAI.getArgument(i) == SILValue(Arg) &&
+          isClosureArgumentInvoked(Callee->getArgument(i), Depth - 1))
+        return true;
+    }
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 //                       Closure Spec Cloner Interface
 //===----------------------------------------------------------------------===//
@@ -757,20 +796,16 @@ void ClosureSpecializer::gatherCallSites(
         if (!ClosureIndex.hasValue())
           continue;
 
-        // Make sure that the Closure is invoked in the Apply's callee. We only
-        // want to perform closure specialization if we know that we will be
-        // able to change a partial_apply into an apply.
+        // Make sure that the Closure is invoked in the Apply's callee, or in a
+        // function the callee passes it on to. We only want to perform closure
+        // specialization if we know that we will be able to change a
+        // partial_apply into an apply.
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
-        SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        SILArgument *Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
+        if (!isClosureArgumentInvoked(Arg, ClosureForwardingDepthLimit))
           continue;
-        }
 
         auto NumIndirectResults =
           AI.getSubstCalleeType()->getNumIndirectResults();
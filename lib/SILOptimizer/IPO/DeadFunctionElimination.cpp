@@ -38,10 +38,21 @@ protected:
 
     MethodInfo() : isAnchor(false) {}
 
-    /// All functions which implement the method. Together with the class for
-    /// which the function implements the method. In case of a witness method,
-    /// the class pointer is null.
-    SmallVector<std::pair<SILFunction *, ClassDecl *>, 8> implementingFunctions;
+    /// A function which implements the method.
+    struct Implementation {
+      SILFunction *F;
+
+      /// The class for which the function implements a vtable method. Null
+      /// for witness methods.
+      ClassDecl *Cl;
+
+      /// The conformance whose witness table contains the function. Null for
+      /// vtable methods and default witnesses.
+      NormalProtocolConformance *Conformance;
+    };
+
+    /// All functions which implement the method.
+    SmallVector<Implementation, 8> implementingFunctions;
 
     /// True, if the whole method is alive, e.g. because it's class is visible
     /// from outside. This implies that all implementing functions are alive.
@@ -96,11 +107,13 @@ protected:
 
   /// Adds a function which implements a vtable or witness method. If it's a
   /// vtable method, \p C is the class for which the function implements the
-  /// method. For witness methods \C is null.
-  void addImplementingFunction(MethodInfo *mi, SILFunction *F, ClassDecl *C) {
+  /// method. For witness methods \C is null, and \p Conformance is the
+  /// conformance of the witness table, if any.
+  void addImplementingFunction(MethodInfo *mi, SILFunction *F, ClassDecl *C,
+                         NormalProtocolConformance *Conformance = nullptr) {
     if (mi->isAnchor)
       ensureAlive(F);
-    mi->implementingFunctions.push_back(std::make_pair(F, C));
+    mi->implementingFunctions.push_back({F, C, Conformance});
   }
 
   /// Returns true if a function is marked as alive.
@@ -158,15 +171,34 @@ protected:
   /// class method, \p MethodCl is the type of the class_method instruction's
   /// operand.
   void ensureAlive(MethodInfo *mi, FuncDecl *FD, ClassDecl *MethodCl) {
-    for (auto &Pair : mi->implementingFunctions) {
-      SILFunction *FImpl = Pair.first;
+    for (auto &Impl : mi->implementingFunctions) {
+      SILFunction *FImpl = Impl.F;
       if (!isAlive(FImpl) &&
-          canHaveSameImplementation(FD, MethodCl, Pair.second)) {
+          canHaveSameImplementation(FD, MethodCl, Impl.Cl)) {
         makeAlive(FImpl);
       }
     }
   }
 
+  /// Marks the implementing functions of the witness method \p mi as alive,
+  /// which may be called through \p WMI. If the conformance used by \p WMI
+  /// is concrete, only the witness of that conformance (or a default
+  /// witness) can be called; otherwise any of them can.
+  void ensureAlive(MethodInfo *mi, WitnessMethodInst *WMI) {
+    ProtocolConformanceRef Conformance = WMI->getConformance();
+    if (!Conformance.isConcrete()) {
+      ensureAlive(mi, nullptr, nullptr);
+      return;
+    }
+    auto *Root = Conformance.getConcrete()->getRootNormalConformance();
+    for (auto &Impl : mi->implementingFunctions) {
+      if (!isAlive(Impl.F) &&
+          (!Impl.Conformance || Impl.Conformance == Root)) {
+        makeAlive(Impl.F);
+      }
+    }
+  }
+
   /// Gets the base implementation of a method.
   /// We always use the most overridden function to describe a method.
   AbstractFunctionDecl *getBase(AbstractFunctionDecl *FD) {
@@ -184,6 +216,10 @@ protected:
           auto *funcDecl = getBase(
               cast<AbstractFunctionDecl>(MI->getMember().getDecl()));
           MethodInfo *mi = getMethodInfo(funcDecl);
+          if (auto *WMI = dyn_cast<WitnessMethodInst>(MI)) {
+            ensureAlive(mi, WMI);
+            continue;
+          }
           ClassDecl *MethodCl = nullptr;
           if (MI->getNumOperands() == 1)
             MethodCl = MI->getOperand(0)->getType().getClassOrBoundGenericClass();
@@ -339,7 +375,7 @@ class DeadFunctionElimination : FunctionLivenessComputation {
           continue;
 
         MethodInfo *mi = getMethodInfo(fd);
-        addImplementingFunction(mi, F, nullptr);
+        addImplementingFunction(mi, F, nullptr, WT.getConformance());
         if (tableIsAlive || !F->isDefinition())
           ensureAlive(mi, nullptr, nullptr);
       }
@@ -0,0 +1,116 @@
+//===--- ExportFunctionEffects.cpp - Summarize effects of public functions ===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Stores the result of side-effect analysis for public functions as their
+// effects attribute, so that the summary is serialized in the module together
+// with the function declaration.
+//
+// Clients of the module only see a declaration of a non-fragile function and
+// would otherwise have to assume the worst effects for each call to it. With
+// the attribute, SideEffectAnalysis and EscapeAnalysis in the client can treat
+// such a call like a call to a function with the same @effects attribute.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "export-function-effects"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/AST/Module.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumReadNone, "Number of functions exported as readnone");
+STATISTIC(NumReadOnly, "Number of functions exported as readonly");
+
+using namespace swift;
+
+/// Returns the most precise effects kind which is a conservative
+/// approximation of \p FE. The returned kind must not promise more than what
+/// SideEffectAnalysis::getDefinedEffects derives from it.
+static EffectsKind
+getSummarizedEffects(const SideEffectAnalysis::FunctionEffects &FE,
+                     SILFunction *F) {
+  // The effects attributes cannot express any of these.
+  if (FE.mayAllocObjects() || FE.mayTrap() || FE.mayReadRC())
+    return EffectsKind::Unspecified;
+
+  bool Reads = false;
+  auto addEffects = [&](const SideEffectAnalysis::Effects &E) {
+    if (E.mayWrite() || E.mayRetain() || E.mayRelease())
+      return false;
+    Reads |= E.mayRead();
+    return true;
+  };
+  if (!addEffects(FE.getGlobalEffects()))
+    return EffectsKind::Unspecified;
+  for (const auto &PE : FE.getParameterEffects()) {
+    if (!addEffects(PE))
+      return EffectsKind::Unspecified;
+  }
+
+  if (!Reads)
+    return EffectsKind::ReadNone;
+
+  // A readonly attribute is ignored for functions with owned parameters.
+  if (F->hasOwnedParameters())
+    return EffectsKind::Unspecified;
+  return EffectsKind::ReadOnly;
+}
+
+namespace {
+
+class ExportFunctionEffects : public SILModuleTransform {
+
+  void run() override {
+    SILModule *M = getModule();
+
+    // A resilient module may change the implementation of a public function
+    // without recompiling its clients.
+    if (M->getSwiftModule()->getResilienceStrategy() ==
+          ResilienceStrategy::Resilient)
+      return;
+
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+
+    for (SILFunction &F : *M) {
+      if (!F.isDefinition() || F.hasEffectsKind() ||
+          F.getLinkage() != SILLinkage::Public)
+        continue;
+
+      EffectsKind Kind = getSummarizedEffects(SEA->getEffects(&F), &F);
+      if (Kind == EffectsKind::Unspecified)
+        continue;
+
+      DEBUG(llvm::dbgs() << "  export " << (Kind == EffectsKind::ReadNone ?
+                                             "readnone" : "readonly")
+                         << " effects for " << F.getName() << '\n');
+      F.setEffectsKind(Kind);
+      if (Kind == EffectsKind::ReadNone)
+        ++NumReadNone;
+      else
+        ++NumReadOnly;
+    }
+    // The new attributes don't change the effects which are already computed
+    // by SideEffectAnalysis, so no analysis needs to be invalidated.
+  }
+
+  StringRef getName() override { return "Export Function Effects"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createExportFunctionEffects() {
+  return new ExportFunctionEffects();
+}
@@ -0,0 +1,392 @@
+//===--- Outliner.cpp - Outline repeated reference counting sequences -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Replaces sequences of reference counting instructions which appear many
+// times in the module by calls to a shared function. Inlining and
+// specialization copy the retains and releases of aggregates into many
+// functions, e.g.
+//
+//   %1 = struct_extract %0 : $S, #S.a
+//   strong_release %1 : $A
+//   %2 = struct_extract %0 : $S, #S.b
+//   release_value %2 : $Optional<B>
+//   %3 = struct_extract %0 : $S, #S.c
+//   strong_release %3 : $C
+//
+// Each sequence becomes a call of a function which takes the values used by
+// the sequence as arguments:
+//
+//   %f = function_ref @outlined_ref_counting_0 : $@convention(thin) (S) -> ()
+//   %r = apply %f(%0) : $@convention(thin) (S) -> ()
+//
+// Only whole runs of such instructions in a block are outlined, and only if
+// no value produced by the run is used outside of it. A run is outlined if
+// the instructions saved in all of its copies outweigh the calls which
+// replace them plus the body of the outlined function.
+//
+// The outlined calls hide the reference counting operations from the ARC
+// optimizer, so this pass is meant to run late in pipelines which optimize
+// for size.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-outliner"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/Basic/Range.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILDebugScope.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+
+using namespace swift;
+
+STATISTIC(NumOutlinedFunctions, "Number of outlined functions created");
+STATISTIC(NumOutlinedSequences, "Number of sequences replaced by a call");
+
+static llvm::cl::opt<unsigned> OutlinerMinBenefit(
+    "sil-outliner-min-benefit", llvm::cl::init(1),
+    llvm::cl::desc("The minimum number of instructions which must be saved "
+                   "by outlining a sequence"));
+
+/// The prefix of the names of outlined functions.
+static const char OutlinedFunctionPrefix[] = "outlined_ref_counting_";
+
+/// The number of instructions of a call to an outlined function: the
+/// function_ref and the apply.
+static const unsigned CallCost = 2;
+
+/// The number of instructions an outlined function needs in addition to the
+/// outlined sequence: the return and its empty tuple.
+static const unsigned OutlinedFunctionCost = 2;
+
+/// Returns true if \p I may be part of an outlined sequence.
+static bool canOutline(SILInstruction *I) {
+  switch (I->getKind()) {
+  case ValueKind::StrongRetainInst:
+  case ValueKind::StrongReleaseInst:
+  case ValueKind::RetainValueInst:
+  case ValueKind::ReleaseValueInst:
+  case ValueKind::StructExtractInst:
+  case ValueKind::TupleExtractInst:
+    break;
+  default:
+    return false;
+  }
+  // The outlined function is not generic.
+  if (I->hasValue() && I->getType().hasArchetype())
+    return false;
+  for (auto &Op : I->getAllOperands()) {
+    SILType Ty = Op.get()->getType();
+    if (!Ty.isObject() || Ty.hasArchetype())
+      return false;
+  }
+  return true;
+}
+
+namespace {
+
+/// A run of outlinable instructions in a block.
+struct Sequence {
+  SmallVector<SILInstruction *, 8> Insts;
+
+  /// The values which are defined outside of the sequence and used by it, in
+  /// the order of their first use. They become the arguments of the outlined
+  /// function.
+  SmallVector<SILValue, 4> Arguments;
+};
+
+/// All sequences of the module which are equivalent.
+struct SequenceGroup {
+  SmallVector<Sequence, 4> Sequences;
+};
+
+/// The key of a sequence, which is equal for two sequences if they do the
+/// same operations on values of the same types.
+using SequenceKey = std::vector<uintptr_t>;
+
+class Outliner {
+  SILModule &M;
+
+  /// The groups of equivalent sequences in the order in which they are found.
+  std::vector<SequenceGroup> Groups;
+  std::map<SequenceKey, unsigned> GroupIndices;
+
+  unsigned NextFunctionNumber = 0;
+
+public:
+  Outliner(SILModule &M) : M(M) {}
+
+  void collectSequences(SILFunction &F);
+
+  /// Outline all groups of sequences which are profitable. The functions
+  /// which were changed and the outlined functions are added to
+  /// \p ChangedFunctions and \p NewFunctions.
+  void outline(SmallVectorImpl<SILFunction *> &ChangedFunctions,
+               SmallVectorImpl<SILFunction *> &NewFunctions);
+
+private:
+  void addSequence(ArrayRef<SILInstruction *> Insts);
+  void splitAndAddRun(ArrayRef<SILInstruction *> Run);
+  SILFunction *createOutlinedFunction(const Sequence &Seq);
+  void replaceByCall(const Sequence &Seq, SILFunction *Outlined);
+};
+
+} // end anonymous namespace
+
+void Outliner::collectSequences(SILFunction &F) {
+  for (auto &BB : F) {
+    SmallVector<SILInstruction *, 16> Run;
+    for (auto &I : BB) {
+      if (canOutline(&I)) {
+        Run.push_back(&I);
+        continue;
+      }
+      splitAndAddRun(Run);
+      Run.clear();
+    }
+  }
+}
+
+/// Adds the parts of \p Run whose values are only used inside of the part.
+///
+/// An instruction whose value is used outside of the run cannot be outlined
+/// and splits the run into the instructions before and after it.
+void Outliner::splitAndAddRun(ArrayRef<SILInstruction *> Run) {
+  if (Run.size() < 2)
+    return;
+
+  llvm::SmallPtrSet<SILInstruction *, 16> InRun(Run.begin(), Run.end());
+  for (unsigned Idx = 0, E = Run.size(); Idx != E; ++Idx) {
+    SILInstruction *I = Run[Idx];
+    for (auto *Use : I->getUses()) {
+      if (InRun.count(Use->getUser()))
+        continue;
+      splitAndAddRun(Run.slice(0, Idx));
+      splitAndAddRun(Run.slice(Idx + 1));
+      return;
+    }
+  }
+  addSequence(Run);
+}
+
+void Outliner::addSequence(ArrayRef<SILInstruction *> Insts) {
+  Sequence Seq;
+  SequenceKey Key;
+  llvm::DenseMap<ValueBase *, unsigned> InstIndices;
+  llvm::DenseMap<ValueBase *, unsigned> ArgIndices;
+
+  for (SILInstruction *I : Insts) {
+    Key.push_back(uintptr_t(I->getKind()));
+    if (auto *RCI = dyn_cast<RefCountingInst>(I))
+      Key.push_back(RCI->isAtomic());
+    else if (auto *SEI = dyn_cast<StructExtractInst>(I))
+      Key.push_back(uintptr_t(SEI->getField()));
+    else if (auto *TEI = dyn_cast<TupleExtractInst>(I))
+      Key.push_back(TEI->getFieldNo());
+
+    for (auto &Op : I->getAllOperands()) {
+      ValueBase *V = Op.get();
+      auto InstIt = InstIndices.find(V);
+      if (InstIt != InstIndices.end()) {
+        Key.push_back(0);
+        Key.push_back(InstIt->second);
+        continue;
+      }
+      auto Inserted = ArgIndices.insert({V, Seq.Arguments.size()});
+      if (Inserted.second)
+        Seq.Arguments.push_back(Op.get());
+      Key.push_back(1);
+      Key.push_back(Inserted.first->second);
+      Key.push_back(uintptr_t(V->getType().getOpaqueValue()));
+    }
+    InstIndices[I] = Seq.Insts.size();
+    Seq.Insts.push_back(I);
+  }
+
+  auto Inserted = GroupIndices.insert({std::move(Key), Groups.size()});
+  if (Inserted.second)
+    Groups.emplace_back();
+  Groups[Inserted.first->second].Sequences.push_back(std::move(Seq));
+}
+
+SILFunction *Outliner::createOutlinedFunction(const Sequence &Seq) {
+  ASTContext &Ctx = M.getASTContext();
+  SmallVector<SILParameterInfo, 4> Params;
+  for (SILValue Arg : Seq.Arguments) {
+    Params.push_back(SILParameterInfo(Arg->getType().getSwiftRValueType(),
+                                      ParameterConvention::Direct_Unowned));
+  }
+  SILResultInfo Results[] = {
+    SILResultInfo(TupleType::getEmpty(Ctx), ResultConvention::Unowned)
+  };
+  SILFunctionType::ExtInfo EInfo;
+  EInfo = EInfo.withRepresentation(SILFunctionType::Representation::Thin);
+  auto FnTy = SILFunctionType::get(nullptr, EInfo,
+                                   ParameterConvention::Direct_Unowned, Params,
+                                   Results, None, Ctx);
+
+  llvm::SmallString<64> Name;
+  do {
+    Name.clear();
+    llvm::raw_svector_ostream(Name) << OutlinedFunctionPrefix
+                                    << NextFunctionNumber++;
+  } while (M.lookUpFunction(Name));
+
+  auto Loc = RegularLocation::getAutoGeneratedLocation();
+  auto *Fn = M.createFunction(SILLinkage::Private, Name, FnTy, nullptr, Loc,
+                              IsBare, IsNotTransparent, IsNotFragile,
+                              IsNotThunk, SILFunction::NotRelevant, NoInline);
+  Fn->setDebugScope(new (M) SILDebugScope(Loc, Fn));
+
+  SILBasicBlock *Entry = Fn->createBasicBlock();
+  llvm::DenseMap<ValueBase *, SILValue> ValueMap;
+  for (SILValue Arg : Seq.Arguments)
+    ValueMap[Arg] = new (M) SILArgument(Entry, Arg->getType());
+
+  SILBuilder B(Entry);
+  for (SILInstruction *I : Seq.Insts) {
+    auto getOp = [&](unsigned Idx) { return ValueMap[I->getOperand(Idx)]; };
+    SILValue NewV;
+    switch (I->getKind()) {
+    case ValueKind::StrongRetainInst:
+      B.createStrongRetain(Loc, getOp(0),
+                           cast<RefCountingInst>(I)->getAtomicity());
+      break;
+    case ValueKind::StrongReleaseInst:
+      B.createStrongRelease(Loc, getOp(0),
+                            cast<RefCountingInst>(I)->getAtomicity());
+      break;
+    case ValueKind::RetainValueInst:
+      B.createRetainValue(Loc, getOp(0),
+                          cast<RefCountingInst>(I)->getAtomicity());
+      break;
+    case ValueKind::ReleaseValueInst:
+      B.createReleaseValue(Loc, getOp(0),
+                           cast<RefCountingInst>(I)->getAtomicity());
+      break;
+    case ValueKind::StructExtractInst:
+      NewV = B.createStructExtract(Loc, getOp(0),
+                                   cast<StructExtractInst>(I)->getField(),
+                                   I->getType());
+      break;
+    case ValueKind::TupleExtractInst:
+      NewV = B.createTupleExtract(Loc, getOp(0),
+                                  cast<TupleExtractInst>(I)->getFieldNo(),
+                                  I->getType());
+      break;
+    default:
+      llvm_unreachable("instruction cannot be outlined");
+    }
+    if (NewV)
+      ValueMap[I] = NewV;
+  }
+  B.createReturn(Loc, B.createTuple(Loc, ArrayRef<SILValue>()));
+
+  ++NumOutlinedFunctions;
+  return Fn;
+}
+
+void Outliner::replaceByCall(const Sequence &Seq, SILFunction *Outlined) {
+  SILInstruction *First = Seq.Insts.front();
+  SILBuilderWithScope B(First);
+  auto *FRI = B.createFunctionRef(First->getLoc(), Outlined);
+  B.createApply(First->getLoc(), FRI, Seq.Arguments, /*isNonThrowing*/ false);
+
+  // Values of the sequence are only used by later instructions of it.
+  for (SILInstruction *I : reversed(Seq.Insts))
+    I->eraseFromParent();
+  ++NumOutlinedSequences;
+}
+
+void Outliner::outline(SmallVectorImpl<SILFunction *> &ChangedFunctions,
+                       SmallVectorImpl<SILFunction *> &NewFunctions) {
+  llvm::SmallPtrSet<SILFunction *, 16> Changed;
+  for (SequenceGroup &Group : Groups) {
+    const Sequence &Representative = Group.Sequences.front();
+    unsigned Count = Group.Sequences.size();
+    unsigned Length = Representative.Insts.size();
+    unsigned NumArgs = Representative.Arguments.size();
+
+    // Each copy of the sequence is replaced by a call which passes the
+    // arguments, and the outlined function contains one more copy.
+    unsigned Before = Count * Length;
+    unsigned After = Count * (CallCost + NumArgs) + Length +
+                     OutlinedFunctionCost;
+    if (Before < After + OutlinerMinBenefit)
+      continue;
+
+    DEBUG(llvm::dbgs() << "  Outlining " << Count << " sequences of "
+                       << Length << " instructions, starting with "
+                       << *Representative.Insts.front());
+
+    SILFunction *Outlined = createOutlinedFunction(Representative);
+    NewFunctions.push_back(Outlined);
+    for (const Sequence &Seq : Group.Sequences) {
+      SILFunction *F = Seq.Insts.front()->getFunction();
+      replaceByCall(Seq, Outlined);
+      if (Changed.insert(F).second)
+        ChangedFunctions.push_back(F);
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+//                              Top Level Driver
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class SILOutliner : public SILModuleTransform {
+  void run() override {
+    SILModule *M = getModule();
+    Outliner O(*M);
+
+    for (SILFunction &F : *M) {
+      // Calls from fragile or transparent functions may be inlined into other
+      // modules, which cannot reference the private outlined function.
+      if (!F.isDefinition() || !F.shouldOptimize() || F.isFragile() ||
+          F.isTransparent())
+        continue;
+      // Don't outline the body of an outlined function into another one.
+      if (F.getName().startswith(OutlinedFunctionPrefix))
+        continue;
+      O.collectSequences(F);
+    }
+
+    SmallVector<SILFunction *, 16> ChangedFunctions;
+    SmallVector<SILFunction *, 16> NewFunctions;
+    O.outline(ChangedFunctions, NewFunctions);
+
+    for (SILFunction *F : NewFunctions)
+      PM->notifyAnalysisOfFunction(F);
+    for (SILFunction *F : ChangedFunctions)
+      invalidateAnalysis(F,
+                         SILAnalysis::InvalidationKind::CallsAndInstructions);
+  }
+
+  StringRef getName() override { return "SIL Outliner"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createOutliner() {
+  return new SILOutliner();
+}
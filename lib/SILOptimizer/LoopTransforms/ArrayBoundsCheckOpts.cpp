@@ -707,21 +707,24 @@ static SILValue getSub(SILLocation Loc, SILValue Val, unsigned SubVal,
   return B.createTupleExtract(Loc, AI, 0);
 }
 
-/// A canonical induction variable incremented by one from Start to End-1.
+/// A canonical induction variable incremented by a constant positive stride
+/// from Start to End-Stride.
 struct InductionInfo {
   SILArgument *HeaderVal;
   BuiltinInst *Inc;
   SILValue Start;
   SILValue End;
+  unsigned Stride;
   BuiltinValueKind Cmp;
   bool IsOverflowCheckInserted;
 
   InductionInfo()
-      : Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
+      : Stride(1), Cmp(BuiltinValueKind::None),
+        IsOverflowCheckInserted(false) {}
 
   InductionInfo(SILArgument *HV, BuiltinInst *I, SILValue S, SILValue E,
-                BuiltinValueKind C, bool IsOverflowChecked = false)
-      : HeaderVal(HV), Inc(I), Start(S), End(E), Cmp(C),
+                unsigned St, BuiltinValueKind C, bool IsOverflowChecked = false)
+      : HeaderVal(HV), Inc(I), Start(S), End(E), Stride(St), Cmp(C),
         IsOverflowCheckInserted(IsOverflowChecked) {}
 
   bool isValid() { return Start && End; }
@@ -734,7 +737,7 @@ struct InductionInfo {
   }
 
   SILValue getLastValue(SILLocation &Loc, SILBuilder &B) {
-    return getSub(Loc, End, 1, B);
+    return getSub(Loc, End, Stride, B);
   }
 
   /// If necessary insert an overflow for this induction variable.
@@ -751,6 +754,22 @@ struct InductionInfo {
     auto *CmpSGE = Builder.createBuiltinBinaryFunction(
         Loc, "cmp_sge", Start->getType(), ResultTy, {Start, End});
     Builder.createCondFail(Loc, CmpSGE);
+
+    // With a stride other than one the induction variable only reaches End if
+    // End - Start is a multiple of the stride. Otherwise it would step over
+    // End and run until the increment overflows.
+    if (Stride != 1) {
+      SILType Ty = Start->getType();
+      auto *Diff = Builder.createBuiltinBinaryFunction(Loc, "sub", Ty, Ty,
+                                                       {End, Start});
+      auto *StrideVal = Builder.createIntegerLiteral(Loc, Ty, Stride);
+      auto *Rem = Builder.createBuiltinBinaryFunction(Loc, "urem", Ty, Ty,
+                                                      {Diff, StrideVal});
+      auto *Zero = Builder.createIntegerLiteral(Loc, Ty, 0);
+      auto *CmpNE = Builder.createBuiltinBinaryFunction(Loc, "cmp_ne", Ty,
+                                                        ResultTy, {Rem, Zero});
+      Builder.createCondFail(Loc, CmpNE);
+    }
     IsOverflowCheckInserted = true;
 
     // We can now remove the cond fail on the increment the above comparison
@@ -765,7 +784,7 @@ struct InductionInfo {
 /// Analyse canonical induction variables in a loop to find their start and end
 /// values.
 /// At the moment we only handle very simple induction variables that increment
-/// by one and use equality comparison.
+/// by a constant positive stride and use equality comparison.
 class InductionAnalysis {
   using InductionInfoMap = llvm::DenseMap<SILArgument *, InductionInfo *>;
 
@@ -823,8 +842,10 @@ private:
   /// Analyse one potential induction variable starting at Arg.
   InductionInfo *analyseIndVar(SILArgument *HeaderVal, BuiltinInst *Inc,
                                IntegerLiteralInst *IncVal) {
-    if (IncVal->getValue() != 1)
+    const APInt &IncValue = IncVal->getValue();
+    if (!IncValue.isStrictlyPositive() || IncValue.getActiveBits() > 31)
       return nullptr;
+    unsigned Stride = IncValue.getZExtValue();
 
     // Find the start value.
     auto *PreheaderTerm = dyn_cast<BranchInst>(Preheader->getTerminator());
@@ -869,12 +890,17 @@ private:
     // code in the preheader's predecessor ensures that we won't overflow.
     bool IsRangeChecked = false;
     if (!isOverflowChecked(Inc)) {
+      // The range check does not ensure that End - Start is a multiple of the
+      // stride.
+      if (Stride != 1)
+        return nullptr;
       IsRangeChecked = isRangeChecked(Start, End, Preheader, DT);
       if (!IsRangeChecked)
         return nullptr;
     }
     return new (Allocator.Allocate()) InductionInfo(
-        HeaderVal, Inc, Start, End, BuiltinValueKind::ICMP_EQ, IsRangeChecked);
+        HeaderVal, Inc, Start, End, Stride, BuiltinValueKind::ICMP_EQ,
+        IsRangeChecked);
   }
 };
 
@@ -914,8 +940,13 @@ public:
     if (!AsArg)
       return nullptr;
 
-    if (auto *Ind = IndVars[AsArg])
+    if (auto *Ind = IndVars[AsArg]) {
+      // Only the check inserted by checkOverflow guarantees that an induction
+      // variable with a stride other than one does not step over its end.
+      if (Ind->Stride != 1 && !Ind->IsOverflowCheckInserted)
+        return nullptr;
       return AccessFunction(Ind);
+    }
 
     return nullptr;
   }
@@ -1111,10 +1142,10 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
     return false;
   }
 
-  // Only handle innermost loops for now.
-  if (!Loop->getSubLoops().empty())
-    return false;
-
+  // Loops are processed bottom-up in the loop tree. Checks which were hoisted
+  // into the preheader of a sub-loop are now part of this loop and can be
+  // hoisted again, e.g. the check of the row index of a two-dimensional
+  // array access a[i][j].
   DEBUG(llvm::dbgs() << "Attempting to remove redundant checks in " << *Loop);
   DEBUG(Header->getParent()->dump());
 
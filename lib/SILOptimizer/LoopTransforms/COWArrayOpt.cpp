@@ -31,6 +31,7 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -409,6 +410,7 @@ protected:
   bool isArrayValueReleasedBeforeMutate(
       SILValue V, llvm::SmallSet<SILInstruction *, 16> &Releases);
   bool hoistInLoopWithOnlyNonArrayValueMutatingOperations();
+  bool hoistElementBaseAddress(SILValue ArrayAddr);
 };
 } // namespace
 
@@ -1320,6 +1322,10 @@ bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
   for (auto &Call: CallsToHoist)
     Call->hoist();
 
+  // None of the arrays is reallocated in the loop anymore.
+  for (auto &Call: CallsToHoist)
+    hoistElementBaseAddress(ArraySemanticsCall(Call->MakeMutable).getSelf());
+
   DEBUG(llvm::dbgs() << "    Hoisting make_mutable in " << Function->getName()
                      << "\n");
   return ReturnWithCleanup(true);
@@ -1505,6 +1511,124 @@ bool COWArrayOpt::hoistMakeMutable(ArraySemanticsCall MakeMutable) {
   return true;
 }
 
+/// Returns the first stored property of the struct type \p Ty, e.g. the
+/// builtin value of an Int or the raw pointer of an UnsafeMutablePointer.
+static VarDecl *getSingleStoredProperty(SILType Ty) {
+  auto *SD = Ty.getStructOrBoundGenericStruct();
+  if (!SD)
+    return nullptr;
+  auto Props = SD->getStoredProperties();
+  if (Props.begin() == Props.end() || std::next(Props.begin()) != Props.end())
+    return nullptr;
+  return *Props.begin();
+}
+
+/// Returns true if \p Ty is a struct which wraps a single builtin integer,
+/// like Int.
+static bool isIntegerStruct(SILType Ty, SILModule &M) {
+  auto *Prop = getSingleStoredProperty(Ty);
+  return Prop && Ty.getFieldType(Prop, M).is<BuiltinIntegerType>();
+}
+
+/// Returns true if the element of the array, whose element pointer is of
+/// type \p PtrTy, can be addressed with an index_addr from the base address.
+static bool hasIndexableElementType(SILType PtrTy, SILModule &M) {
+  auto *BGT = PtrTy.getSwiftRValueType()->getAs<BoundGenericStructType>();
+  if (!BGT || BGT->getGenericArgs().size() != 1 ||
+      !getSingleStoredProperty(PtrTy))
+    return false;
+  CanType EltTy = BGT->getGenericArgs()[0]->getCanonicalType();
+  // Function types are stored with a different abstraction in memory.
+  if (isa<AnyFunctionType>(EltTy))
+    return false;
+  return M.Types.getLoweredType(EltTy).isTrivial(M);
+}
+
+/// Creates the address of element \p Index relative to the element pointer
+/// \p Base, which is the address of element 0.
+static SILValue createIndexedElementPointer(SILBuilder &B, SILLocation Loc,
+                                            SILValue Base, SILValue Index) {
+  SILModule &M = B.getModule();
+  SILType PtrTy = Base->getType();
+  auto *BGT = PtrTy.getSwiftRValueType()->castTo<BoundGenericStructType>();
+  CanType EltTy = BGT->getGenericArgs()[0]->getCanonicalType();
+  SILType EltAddrTy = M.Types.getLoweredType(EltTy).getAddressType();
+
+  SILValue Raw =
+    B.createStructExtract(Loc, Base, getSingleStoredProperty(PtrTy));
+  SILValue EltAddr = B.createPointerToAddress(Loc, Raw, EltAddrTy,
+                                              /*isStrict*/ true);
+
+  // Convert the Int index to a Builtin.Word.
+  SILValue IdxVal =
+    B.createStructExtract(Loc, Index, getSingleStoredProperty(Index->getType()));
+  SILType WordTy = SILType::getBuiltinWordType(B.getASTContext());
+  if (IdxVal->getType() != WordTy) {
+    auto IntTy = IdxVal->getType().castTo<BuiltinIntegerType>();
+    std::string Name = "truncOrBitCast_Int" +
+      llvm::utostr(IntTy->getWidth().getFixedWidth()) + "_Word";
+    IdxVal = B.createBuiltin(Loc, B.getASTContext().getIdentifier(Name),
+                             WordTy, {}, {IdxVal});
+  }
+
+  SILValue Elt = B.createIndexAddr(Loc, EltAddr, IdxVal);
+  SILValue NewRaw = B.createAddressToPointer(Loc, Elt, Raw->getType());
+  return B.createStruct(Loc, PtrTy, {NewRaw});
+}
+
+/// Replace the get_element_address calls on the array at \p ArrayAddr in the
+/// loop by an index_addr from the address of the first element, which is
+/// computed once in the preheader.
+///
+/// This is only valid after make_mutable was hoisted for the array, i.e. if
+/// the array buffer cannot be reallocated in the loop. It exposes a loop
+/// invariant base pointer and plain address arithmetic to alias analysis and
+/// to the loop vectorizer, instead of an opaque call in each iteration.
+bool COWArrayOpt::hoistElementBaseAddress(SILValue ArrayAddr) {
+  SILModule &M = Function->getModule();
+  SmallVector<ArraySemanticsCall, 8> Calls;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      ArraySemanticsCall Call(&Inst, "array.get_element_address");
+      if (!Call || !Call.hasGuaranteedSelf())
+        continue;
+      auto *LI = dyn_cast<LoadInst>(Call.getSelf());
+      if (!LI || LI->getOperand() != ArrayAddr)
+        continue;
+      ApplyInst *AI = Call;
+      if (!isIntegerStruct(Call.getIndex()->getType(), M) ||
+          !hasIndexableElementType(AI->getType(), M))
+        return false;
+      Calls.push_back(Call);
+    }
+  }
+  if (Calls.empty() ||
+      !Calls[0].canHoist(Preheader->getTerminator(), DomTree))
+    return false;
+
+  // Compute the address of element 0 in the preheader.
+  ApplyInst *BaseCall = Calls[0].copyTo(Preheader->getTerminator(), DomTree);
+  SILLocation Loc = BaseCall->getLoc();
+  SILValue Index = Calls[0].getIndex();
+  SILBuilderWithScope B(BaseCall);
+  SILType IdxValTy = Index->getType().getFieldType(
+      getSingleStoredProperty(Index->getType()), M);
+  auto *Zero = B.createStruct(Loc, Index->getType(),
+                              {B.createIntegerLiteral(Loc, IdxValTy, 0)});
+  BaseCall->setArgument(0, Zero);
+
+  for (ArraySemanticsCall &Call : Calls) {
+    ApplyInst *AI = Call;
+    DEBUG(llvm::dbgs() << "    Indexing from the base address: " << *AI);
+    SILBuilderWithScope Builder(AI);
+    SILValue Addr = createIndexedElementPointer(Builder, AI->getLoc(),
+                                                BaseCall, Call.getIndex());
+    AI->replaceAllUsesWith(Addr);
+    Call.removeCall();
+  }
+  return true;
+}
+
 bool COWArrayOpt::run() {
   DEBUG(llvm::dbgs() << "  Array Opts in Loop " << *Loop);
 
@@ -1553,6 +1677,14 @@ bool COWArrayOpt::run() {
       HasChanged = true;
     }
   }
+
+  // The buffers of arrays with a hoisted make_mutable are not reallocated in
+  // the loop, so their element addresses can be computed from a loop
+  // invariant base address.
+  for (auto &Entry : ArrayMakeMutableMap) {
+    if (Entry.second)
+      HasChanged |= hoistElementBaseAddress(Entry.first);
+  }
   return HasChanged;
 }
 
@@ -1932,177 +2064,6 @@ private:
 };
 } // End anonymous namespace.
 
-namespace {
-/// Clone a single exit multiple exit region starting at basic block and ending
-/// in a set of basic blocks. Updates the dominator tree with the cloned blocks.
-/// However, the client needs to update the dominator of the exit blocks.
-class RegionCloner : public SILCloner<RegionCloner> {
-  DominanceInfo &DomTree;
-  SILBasicBlock *StartBB;
-  SmallPtrSet<SILBasicBlock *, 16> OutsideBBs;
-
-  friend class SILVisitor<RegionCloner>;
-  friend class SILCloner<RegionCloner>;
-
-public:
-  RegionCloner(SILBasicBlock *EntryBB,
-               SmallVectorImpl<SILBasicBlock *> &ExitBlocks, DominanceInfo &DT)
-      : SILCloner<RegionCloner>(*EntryBB->getParent()), DomTree(DT),
-        StartBB(EntryBB), OutsideBBs(ExitBlocks.begin(), ExitBlocks.end()) {}
-
-  SILBasicBlock *cloneRegion() {
-    assert (DomTree.getNode(StartBB) != nullptr && "Can't cloned dead code");
-
-    auto CurFun = StartBB->getParent();
-    auto &Mod = CurFun->getModule();
-
-    // We don't want to visit blocks outside of the region. visitSILBasicBlocks
-    // checks BBMap before it clones a block. So we mark exiting blocks as
-    // visited by putting them in the BBMap.
-    for (auto *BB : OutsideBBs)
-      BBMap[BB] = BB;
-
-    // We need to split any edge from a non cond_br basic block leading to a
-    // exit block. After cloning this edge will become critical if it came from
-    // inside the cloned region. The SSAUpdater can't handle critical non
-    // cond_br edges.
-    for (auto *BB : OutsideBBs) {
-      SmallVector<SILBasicBlock*, 8> Preds(BB->getPreds());
-      for (auto *Pred : Preds)
-        if (!isa<CondBranchInst>(Pred->getTerminator()) &&
-            !isa<BranchInst>(Pred->getTerminator()))
-          splitEdgesFromTo(Pred, BB, &DomTree, nullptr);
-    }
-
-    // Create the cloned start basic block.
-    auto *ClonedStartBB = new (Mod) SILBasicBlock(CurFun);
-    BBMap[StartBB] = ClonedStartBB;
-
-    // Clone the arguments.
-    for (auto &Arg : StartBB->getBBArgs()) {
-      SILValue MappedArg =
-          new (Mod) SILArgument(ClonedStartBB, getOpType(Arg->getType()));
-      ValueMap.insert(std::make_pair(Arg, MappedArg));
-    }
-
-    // Clone the instructions in this basic block and recursively clone
-    // successor blocks.
-    getBuilder().setInsertionPoint(ClonedStartBB);
-    visitSILBasicBlock(StartBB);
-
-    // Fix-up terminators.
-    for (auto BBPair : BBMap)
-      if (BBPair.first != BBPair.second) {
-        getBuilder().setInsertionPoint(BBPair.second);
-        visit(BBPair.first->getTerminator());
-      }
-
-    // Add dominator tree nodes for the new basic blocks.
-    fixDomTreeNodes(DomTree.getNode(StartBB));
-
-    // Update SSA form for values used outside of the copied region.
-    updateSSAForm();
-    return ClonedStartBB;
-  }
-
-  llvm::MapVector<SILBasicBlock *, SILBasicBlock *> &getBBMap() { return BBMap; }
-
-protected:
-  /// Clone the dominator tree from the original region to the cloned region.
-  void fixDomTreeNodes(DominanceInfoNode *OrigNode) {
-    auto *BB = OrigNode->getBlock();
-    auto MapIt = BBMap.find(BB);
-    // Outside the cloned region.
-    if (MapIt == BBMap.end())
-      return;
-
-    auto *ClonedBB = MapIt->second;
-    // Exit blocks (BBMap[BB] == BB) end the recursion.
-    if (ClonedBB == BB)
-      return;
-
-    auto *OrigDom = OrigNode->getIDom();
-    assert(OrigDom);
-
-    if (BB == StartBB) {
-      // The cloned start node shares the same dominator as the original node.
-      auto *ClonedNode = DomTree.addNewBlock(ClonedBB, OrigDom->getBlock());
-      (void) ClonedNode;
-      assert(ClonedNode);
-    } else {
-      // Otherwise, map the dominator structure using the mapped block.
-      auto *OrigDomBB = OrigDom->getBlock();
-      assert(BBMap.count(OrigDomBB) && "Must have visited dominating block");
-      auto *MappedDomBB = BBMap[OrigDomBB];
-      assert(MappedDomBB);
-      DomTree.addNewBlock(ClonedBB, MappedDomBB);
-    }
-
-    for (auto *Child : *OrigNode)
-      fixDomTreeNodes(Child);
-  }
-
-  SILValue remapValue(SILValue V) {
-    if (auto *BB = V->getParentBB()) {
-      if (!DomTree.dominates(StartBB, BB)) {
-        // Must be a value that dominates the start basic block.
-        assert(DomTree.dominates(BB, StartBB) &&
-               "Must dominated the start of the cloned region");
-        return V;
-      }
-    }
-    return SILCloner<RegionCloner>::remapValue(V);
-  }
-
-  void postProcess(SILInstruction *Orig, SILInstruction *Cloned) {
-    SILCloner<RegionCloner>::postProcess(Orig, Cloned);
-  }
-
-  /// Update SSA form for values that are used outside the region.
-  void updateSSAForValue(SILBasicBlock *OrigBB, SILValue V,
-                         SILSSAUpdater &SSAUp) {
-    // Collect outside uses.
-    SmallVector<UseWrapper, 16> UseList;
-    for (auto Use : V->getUses())
-      if (OutsideBBs.count(Use->getUser()->getParent()) ||
-          !BBMap.count(Use->getUser()->getParent())) {
-        UseList.push_back(UseWrapper(Use));
-      }
-    if (UseList.empty())
-      return;
-
-    // Update SSA form.
-    SSAUp.Initialize(V->getType());
-    SSAUp.AddAvailableValue(OrigBB, V);
-    SILValue NewVal = remapValue(V);
-    SSAUp.AddAvailableValue(BBMap[OrigBB], NewVal);
-    for (auto U : UseList) {
-      Operand *Use = U;
-      SSAUp.RewriteUse(*Use);
-    }
-  }
-
-  void updateSSAForm() {
-    SILSSAUpdater SSAUp;
-    for (auto Entry : BBMap) {
-      // Ignore exit blocks.
-      if (Entry.first == Entry.second)
-        continue;
-      auto *OrigBB = Entry.first;
-
-      // Update outside used phi values.
-      for (auto *Arg : OrigBB->getBBArgs())
-        updateSSAForValue(OrigBB, Arg, SSAUp);
-
-      // Update outside used instruction values.
-      for (auto &Inst : *OrigBB) {
-        updateSSAForValue(OrigBB, &Inst, SSAUp);
-      }
-    }
-  }
-};
-} // End anonymous namespace.
-
 namespace {
 /// This class transforms a hoistable loop nest into a speculatively specialized
 /// loop based on array.props calls.
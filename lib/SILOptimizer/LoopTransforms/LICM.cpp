@@ -568,11 +568,8 @@ public:
     }
 
     if (Changed) {
-      LA->lockInvalidation();
-      DA->lockInvalidation();
-      PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      LA->unlockInvalidation();
-      DA->unlockInvalidation();
+      PM->invalidateAnalysis(
+          F, SILAnalysis::InvalidationKind::FunctionBodyPreservingDominance);
     }
   }
 };
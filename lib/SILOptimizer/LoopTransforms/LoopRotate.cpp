@@ -445,11 +445,8 @@ class LoopRotation : public SILFunctionTransform {
 
     if (Changed) {
       // We preserve loop info and the dominator tree.
-      DA->lockInvalidation();
-      LA->lockInvalidation();
-      PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
-      LA->unlockInvalidation();
+      PM->invalidateAnalysis(
+          F, SILAnalysis::InvalidationKind::FunctionBodyPreservingDominance);
     }
   }
 };
@@ -0,0 +1,247 @@
+//===--- LoopUnswitch.cpp - Unswitch loops on invariant conditions --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Version a loop on a loop invariant branch condition:
+//
+//   preheader:                       check:
+//     br header                        cond_br %c, preheader1, preheader2
+//   header:                 =>       preheader1:
+//     ...                              br header1   // all cond_br %c -> true
+//     cond_br %c, bb1, bb2           preheader2:
+//     ...                              br header2   // all cond_br %c -> false
+//
+// Each version of the loop has one conditional branch less per iteration and
+// the remaining blocks of each version can be optimized independently. As the
+// whole loop is duplicated, the size of loops and the number of versioned
+// loops per function are limited.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-loop-unswitch"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/CFG.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
+#include "swift/SILOptimizer/Utils/SILInliner.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumLoopsUnswitched, "Number of loops unswitched");
+
+static llvm::cl::opt<bool> ShouldUnswitch("sil-loop-unswitch",
+                                          llvm::cl::init(true));
+
+/// The maximum number of non-free instructions in a loop which is unswitched.
+static const unsigned SILLoopUnswitchThreshold = 100;
+
+/// The maximum number of loops which are unswitched in a single function.
+/// Each unswitching duplicates a loop, so this bounds the code size growth
+/// for loops with many invariant conditions.
+static const unsigned SILLoopUnswitchMaxPerFunction = 8;
+
+/// Returns a loop invariant conditional branch in \p L on which the loop can
+/// be unswitched, or null.
+static CondBranchInst *findUnswitchableBranch(SILLoop *L) {
+  if (!L->getLoopPreheader())
+    return nullptr;
+
+  CondBranchInst *Candidate = nullptr;
+  unsigned Cost = 0;
+  for (auto *BB : L->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!L->canDuplicate(&Inst))
+        return nullptr;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+      if (Cost > SILLoopUnswitchThreshold)
+        return nullptr;
+    }
+    if (Candidate)
+      continue;
+
+    auto *CBI = dyn_cast<CondBranchInst>(BB->getTerminator());
+    if (!CBI || CBI->getTrueBB() == CBI->getFalseBB())
+      continue;
+    SILValue Cond = CBI->getCondition();
+    // Constant conditions are folded by SimplifyCFG.
+    if (isa<IntegerLiteralInst>(Cond) || isa<SILUndef>(Cond))
+      continue;
+    // The condition must be defined outside of the loop.
+    if (L->contains(Cond->getParentBB()))
+      continue;
+    Candidate = CBI;
+  }
+  return Candidate;
+}
+
+/// Replace all conditional branches on \p Cond in \p Blocks by a branch to the
+/// successor which is taken if \p Cond is \p Value.
+static void foldBranchesOnCondition(ArrayRef<SILBasicBlock *> Blocks,
+                                    SILValue Cond, bool Value) {
+  for (auto *BB : Blocks) {
+    auto *CBI = dyn_cast<CondBranchInst>(BB->getTerminator());
+    if (!CBI || CBI->getCondition() != Cond)
+      continue;
+    SILBuilderWithScope B(CBI);
+    if (Value)
+      B.createBranch(CBI->getLoc(), CBI->getTrueBB(), CBI->getTrueArgs());
+    else
+      B.createBranch(CBI->getLoc(), CBI->getFalseBB(), CBI->getFalseArgs());
+    CBI->eraseFromParent();
+  }
+}
+
+/// Remove the blocks of one version of the loop which are only reachable via
+/// a folded branch edge.
+static void removeUnreachableBlocks(SILFunction &F) {
+  llvm::SmallPtrSet<SILBasicBlock *, 32> Reachable;
+  SmallVector<SILBasicBlock *, 32> Worklist;
+  Worklist.push_back(&*F.begin());
+  Reachable.insert(&*F.begin());
+  while (!Worklist.empty()) {
+    auto *BB = Worklist.pop_back_val();
+    for (auto &Succ : BB->getSuccessors())
+      if (Reachable.insert(Succ).second)
+        Worklist.push_back(Succ);
+  }
+
+  SmallVector<SILBasicBlock *, 8> DeadBlocks;
+  for (auto &BB : F)
+    if (!Reachable.count(&BB))
+      DeadBlocks.push_back(&BB);
+
+  // Dead blocks may use values of other dead blocks, so first clear all of
+  // them before erasing any.
+  for (auto *BB : DeadBlocks)
+    clearBlockBody(BB);
+  for (auto *BB : DeadBlocks)
+    BB->eraseFromParent();
+}
+
+/// Unswitch the loop \p L on the condition of \p CBI.
+static void unswitchLoop(SILLoop *L, CondBranchInst *CBI, DominanceInfo *DT) {
+  SILValue Cond = CBI->getCondition();
+  SILBasicBlock *Preheader = L->getLoopPreheader();
+  DEBUG(llvm::dbgs() << "  Unswitching loop on " << Cond << *L);
+
+  // Split off an empty block which will contain the check on the condition,
+  // followed by an empty preheader for the original loop, which is the start
+  // of the cloned region. The original preheader is not duplicated.
+  SILBuilder B(Preheader);
+  auto *CheckBlock =
+      splitBasicBlockAndBranch(B, Preheader->getTerminator(), DT, nullptr);
+  SILBasicBlock *NewPreheader =
+      splitBasicBlockAndBranch(B, &*CheckBlock->begin(), DT, nullptr);
+
+  SmallVector<SILBasicBlock *, 16> ExitBlocks;
+  L->getExitBlocks(ExitBlocks);
+
+  SmallVector<SILBasicBlock *, 16> ExitBlocksDominatedByPreheader;
+  for (auto *ExitBlock : ExitBlocks)
+    if (DT->dominates(CheckBlock, ExitBlock))
+      ExitBlocksDominatedByPreheader.push_back(ExitBlock);
+
+  // The loop info is not updated by the cloner, so collect the blocks of the
+  // original loop before cloning.
+  SmallVector<SILBasicBlock *, 16> OrigBlocks(L->getBlocks().begin(),
+                                              L->getBlocks().end());
+
+  RegionCloner Cloner(NewPreheader, ExitBlocks, *DT);
+  auto *ClonedPreheader = Cloner.cloneRegion();
+
+  SmallVector<SILBasicBlock *, 16> ClonedBlocks;
+  for (auto *BB : OrigBlocks)
+    ClonedBlocks.push_back(Cloner.getBBMap()[BB]);
+
+  // Branch to the original loop if the condition is true and to the cloned
+  // loop otherwise.
+  auto *CheckBr = CheckBlock->getTerminator();
+  B.setInsertionPoint(CheckBr);
+  B.createCondBranch(CheckBr->getLoc(), Cond, NewPreheader, ClonedPreheader);
+  CheckBr->eraseFromParent();
+
+  for (auto *BB : ExitBlocksDominatedByPreheader)
+    DT->changeImmediateDominator(DT->getNode(BB), DT->getNode(CheckBlock));
+
+  foldBranchesOnCondition(OrigBlocks, Cond, true);
+  foldBranchesOnCondition(ClonedBlocks, Cond, false);
+  ++NumLoopsUnswitched;
+}
+
+//===----------------------------------------------------------------------===//
+//                              Top Level Driver
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class LoopUnswitch : public SILFunctionTransform {
+
+  StringRef getName() override { return "SIL Loop Unswitching"; }
+
+  /// Unswitch the first unswitchable loop found in a bottom-up walk of the
+  /// loop tree. Returns true if a loop was unswitched.
+  bool unswitchOneLoop(SILLoopInfo *LI, DominanceInfo *DT) {
+    SmallVector<SILLoop *, 16> Worklist(LI->begin(), LI->end());
+    SmallVector<SILLoop *, 16> PostOrder;
+    while (!Worklist.empty()) {
+      auto *L = Worklist.pop_back_val();
+      PostOrder.push_back(L);
+      Worklist.append(L->begin(), L->end());
+    }
+    std::reverse(PostOrder.begin(), PostOrder.end());
+
+    for (auto *L : PostOrder) {
+      if (auto *CBI = findUnswitchableBranch(L)) {
+        unswitchLoop(L, CBI, DT);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run() override {
+    if (!ShouldUnswitch)
+      return;
+
+    SILFunction *F = getFunction();
+    auto *DA = PM->getAnalysis<DominanceAnalysis>();
+    auto *LA = PM->getAnalysis<SILLoopAnalysis>();
+
+    for (unsigned Count = 0; Count < SILLoopUnswitchMaxPerFunction; ++Count) {
+      if (!unswitchOneLoop(LA->get(F), DA->get(F)))
+        break;
+
+      // Unswitching leaves the folded-away blocks of both versions
+      // unreachable. Clean them up and recompute the loop info for the next
+      // iteration.
+      removeUnreachableBlocks(*F);
+      splitAllCriticalEdges(*F, true /* only cond_br terminators*/, nullptr,
+                            nullptr);
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+    }
+  }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createLoopUnswitch() {
+  return new LoopUnswitch();
+}
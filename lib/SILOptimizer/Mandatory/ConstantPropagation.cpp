@@ -16,6 +16,7 @@
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/ConstantEvaluation.h"
 #include "swift/SILOptimizer/Utils/ConstantFolding.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "llvm/ADT/Statistic.h"
@@ -25,6 +26,12 @@
 using namespace swift;
 
 STATISTIC(NumInstFolded, "Number of constant folded instructions");
+STATISTIC(NumCallsEvaluated, "Number of calls evaluated at compile time");
+
+static llvm::cl::opt<unsigned> ConstantEvaluationStepLimit(
+    "sil-constant-evaluation-step-limit", llvm::cl::init(1000),
+    llvm::cl::desc("The maximum number of instructions evaluated to fold a "
+                   "call with constant arguments"));
 
 template<typename...T, typename...U>
 static InFlightDiagnostic
@@ -801,9 +808,35 @@ constantFoldStringConcatenation(ApplyInst *AI,
   return true;
 }
 
+/// Replace a call with constant arguments by its result, if it can be
+/// evaluated at compile time.
+static bool
+constantEvaluateCall(ApplyInst *AI,
+                     llvm::SetVector<SILInstruction *> &WorkList) {
+  SILValue Result = constantEvaluateApply(AI, ConstantEvaluationStepLimit);
+  if (!Result)
+    return false;
+
+  ++NumCallsEvaluated;
+  AI->replaceAllUsesWith(Result);
+
+  // Schedule users of the result for constant folding.
+  if (auto *Inst = dyn_cast<SILInstruction>(Result))
+    WorkList.insert(Inst);
+
+  // The call only evaluated instructions without side effects, so it can be
+  // deleted along with its arguments.
+  recursivelyDeleteTriviallyDeadInstructions(AI, /*force*/ true,
+                                             [&](SILInstruction *DeadI) {
+                                               WorkList.remove(DeadI);
+                                             });
+  return true;
+}
+
 /// Initialize the worklist to all of the constant instructions.
 static void initializeWorklist(SILFunction &F,
                                bool InstantiateAssertConfiguration,
+                               bool EvaluateCalls,
                                llvm::SetVector<SILInstruction *> &WorkList) {
   for (auto &BB : F) {
     for (auto &I : BB) {
@@ -827,6 +860,13 @@ static void initializeWorklist(SILFunction &F,
         continue;
       }
 
+      if (EvaluateCalls)
+        if (auto *AI = dyn_cast<ApplyInst>(&I))
+          if (isConstantEvaluationCandidate(AI)) {
+            WorkList.insert(&I);
+            continue;
+          }
+
       if (!isApplyOfStringConcat(I)) {
         continue;
       }
@@ -851,6 +891,10 @@ processFunction(SILFunction &F, bool EnableDiagnostics,
   bool InstantiateAssertConfiguration =
       (AssertConfiguration != SILOptions::DisableReplacement);
 
+  // Should we evaluate calls with constant arguments at compile time. This
+  // is an optimization only, which the diagnostic pass doesn't do.
+  bool EvaluateCalls = !EnableDiagnostics;
+
   // The list of instructions whose evaluation resulted in error or warning.
   // This is used to avoid duplicate error reporting in case we reach the same
   // instruction from different entry points in the WorkList.
@@ -858,7 +902,8 @@ processFunction(SILFunction &F, bool EnableDiagnostics,
 
   // The worklist of the constants that could be folded into their users.
   llvm::SetVector<SILInstruction *> WorkList;
-  initializeWorklist(F, InstantiateAssertConfiguration, WorkList);
+  initializeWorklist(F, InstantiateAssertConfiguration, EvaluateCalls,
+                     WorkList);
 
   llvm::SetVector<SILInstruction *> FoldedUsers;
   CastOptimizer CastOpt(
@@ -919,10 +964,14 @@ processFunction(SILFunction &F, bool EnableDiagnostics,
       }
 
     if (auto *AI = dyn_cast<ApplyInst>(I)) {
-      // Apply may only come from a string.concat invocation.
+      // Apply may only come from a string.concat invocation or a call with
+      // constant arguments.
       if (constantFoldStringConcatenation(AI, WorkList)) {
         // Invalidate all analysis that's related to the call graph.
         InvalidateInstructions = true;
+      } else if (EvaluateCalls && constantEvaluateCall(AI, WorkList)) {
+        InvalidateInstructions = true;
+        InvalidateCalls = true;
       }
 
       continue;
@@ -980,6 +1029,13 @@ processFunction(SILFunction &F, bool EnableDiagnostics,
         continue;
       }
 
+      // A call may now have only constant arguments.
+      if (auto *AI = dyn_cast<ApplyInst>(User)) {
+        if (EvaluateCalls && isConstantEvaluationCandidate(AI))
+          WorkList.insert(AI);
+        continue;
+      }
+
       // Always consider cond_fail instructions as potential for DCE.  If the
       // expression feeding them is false, they are dead.  We can't handle this
       // as part of the constant folding logic, because there is no value
@@ -202,77 +202,96 @@ static Optional<DIKind> mergeKinds(Optional<DIKind> OK1, Optional<DIKind> OK2) {
 namespace {
   /// AvailabilitySet - This class stores an array of lattice values for tuple
   /// elements being analyzed for liveness computations.  Each element is
-  /// represented with two bits in a bitvector, allowing this to represent the
-  /// lattice values corresponding to "Unknown" (bottom), "Live" or "Not Live",
-  /// which are the middle elements of the lattice, and "Partial" which is the
-  /// top element.
+  /// represented with two bits, allowing this to represent the lattice values
+  /// corresponding to "Unknown" (bottom), "Live" or "Not Live", which are the
+  /// middle elements of the lattice, and "Partial" which is the top element.
+  ///
+  /// The two bits of the elements are kept in two separate bitvectors, so
+  /// that operations on all elements, like the lattice merge, can work on
+  /// whole words instead of element by element.  This matters for memory
+  /// objects with hundreds of elements, like the self of an initializer of a
+  /// struct with many stored properties.
   class AvailabilitySet {
     // We store two bits per element, encoded in the following form:
-    //   T,T -> Nothing/Unknown
-    //   F,F -> No
-    //   F,T -> Yes
-    //   T,F -> Partial
-    llvm::SmallBitVector Data;
+    //   F,F -> Nothing/Unknown
+    //   F,T -> No
+    //   T,F -> Yes
+    //   T,T -> Partial
+    // With this encoding the lattice merge of two elements is a bitwise or.
+    llvm::SmallBitVector MaybeYes;
+    llvm::SmallBitVector MaybeNo;
+
+    /// Elements whose value is known, i.e. not Unknown.
+    llvm::SmallBitVector getKnown() const {
+      return MaybeYes | MaybeNo;
+    }
+
   public:
-    AvailabilitySet(unsigned NumElts) {
-      Data.resize(NumElts*2, true);
+    AvailabilitySet(unsigned NumElts)
+      : MaybeYes(NumElts), MaybeNo(NumElts) {
     }
 
-    bool empty() const { return Data.empty(); }
-    unsigned size() const { return Data.size()/2; }
+    bool empty() const { return MaybeYes.empty(); }
+    unsigned size() const { return MaybeYes.size(); }
 
     DIKind get(unsigned Elt) const {
       return getConditional(Elt).getValue();
     }
 
     Optional<DIKind> getConditional(unsigned Elt) const {
-      bool V1 = Data[Elt*2], V2 = Data[Elt*2+1];
-      if (V1 == V2)
-        return V1 ? Optional<DIKind>(None) : DIKind::No;
-      return V2 ? DIKind::Yes : DIKind::Partial;
+      bool Y = MaybeYes[Elt], N = MaybeNo[Elt];
+      if (Y == N)
+        return Y ? DIKind::Partial : Optional<DIKind>(None);
+      return Y ? DIKind::Yes : DIKind::No;
     }
 
     void set(unsigned Elt, DIKind K) {
-      switch (K) {
-      case DIKind::No:      Data[Elt*2] = false; Data[Elt*2+1] = false; break;
-      case DIKind::Yes:     Data[Elt*2] = false, Data[Elt*2+1] = true; break;
-      case DIKind::Partial: Data[Elt*2] = true,  Data[Elt*2+1] = false; break;
-      }
+      MaybeYes[Elt] = K != DIKind::No;
+      MaybeNo[Elt] = K != DIKind::Yes;
     }
     
     void set(unsigned Elt, Optional<DIKind> K) {
       if (!K.hasValue())
-        Data[Elt*2] = true, Data[Elt*2+1] = true;
+        MaybeYes[Elt] = false, MaybeNo[Elt] = false;
       else
         set(Elt, K.getValue());
     }
 
+    /// Set the elements [FirstElt, FirstElt+NumElts) to the specified value.
+    void set(unsigned FirstElt, unsigned NumElts, DIKind K) {
+      unsigned EndElt = FirstElt + NumElts;
+      if (K == DIKind::No)
+        MaybeYes.reset(FirstElt, EndElt);
+      else
+        MaybeYes.set(FirstElt, EndElt);
+      if (K == DIKind::Yes)
+        MaybeNo.reset(FirstElt, EndElt);
+      else
+        MaybeNo.set(FirstElt, EndElt);
+    }
+
     /// containsUnknownElements - Return true if there are any elements that are
     /// unknown.
     bool containsUnknownElements() const {
-      // Check that we didn't get any unknown values.
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        if (!getConditional(i).hasValue())
-          return true;
-      return false;
+      return !getKnown().all();
     }
 
     bool isAll(DIKind K) const {
-      for (unsigned i = 0, e = size(); i != e; ++i) {
-        auto Elt = getConditional(i);
-        if (!Elt.hasValue() || Elt.getValue() != K)
-          return false;
+      switch (K) {
+      case DIKind::No:      return MaybeNo.all() && MaybeYes.none();
+      case DIKind::Yes:     return MaybeYes.all() && MaybeNo.none();
+      case DIKind::Partial: return (MaybeYes & MaybeNo).all();
       }
-      return true;
+      llvm_unreachable("bad DIKind");
     }
     
     bool hasAny(DIKind K) const {
-      for (unsigned i = 0, e = size(); i != e; ++i) {
-        auto Elt = getConditional(i);
-        if (Elt.hasValue() && Elt.getValue() == K)
-          return true;
+      switch (K) {
+      case DIKind::No:      return (MaybeNo & ~MaybeYes).any();
+      case DIKind::Yes:     return (MaybeYes & ~MaybeNo).any();
+      case DIKind::Partial: return MaybeYes.anyCommon(MaybeNo);
       }
-      return false;
+      llvm_unreachable("bad DIKind");
     }
     
     bool isAllYes() const { return isAll(DIKind::Yes); }
@@ -281,16 +300,37 @@ namespace {
     /// changeUnsetElementsTo - If any elements of this availability set are not
     /// known yet, switch them to the specified value.
     void changeUnsetElementsTo(DIKind K) {
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        if (!getConditional(i).hasValue())
-          set(i, K);
+      auto Unknown = ~getKnown();
+      if (K != DIKind::No)
+        MaybeYes |= Unknown;
+      if (K != DIKind::Yes)
+        MaybeNo |= Unknown;
     }
     
     void mergeIn(const AvailabilitySet &RHS) {
       // Logically, this is an elementwise "this = merge(this, RHS)" operation,
       // using the lattice merge operation for each element.
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        set(i, mergeKinds(getConditional(i), RHS.getConditional(i)));
+      MaybeYes |= RHS.MaybeYes;
+      MaybeNo |= RHS.MaybeNo;
+    }
+
+    /// Elementwise, set this to \p Local where it is known, and otherwise to
+    /// the merge of this and \p Pred.  This is the transfer function of the
+    /// dataflow analysis for the live out state of a block.
+    ///
+    /// \return True if this changed.
+    bool transferFrom(const AvailabilitySet &Pred,
+                      const AvailabilitySet &Local) {
+      auto NotLocal = ~Local.getKnown();
+      auto NewYes = (MaybeYes | Pred.MaybeYes) & NotLocal;
+      NewYes |= Local.MaybeYes;
+      auto NewNo = (MaybeNo | Pred.MaybeNo) & NotLocal;
+      NewNo |= Local.MaybeNo;
+      if (NewYes == MaybeYes && NewNo == MaybeNo)
+        return false;
+      MaybeYes = std::move(NewYes);
+      MaybeNo = std::move(NewNo);
+      return true;
     }
 
     void dump(llvm::raw_ostream &OS) const {
@@ -394,17 +434,8 @@ namespace {
     /// Merge the state from a predecessor block into the OutAvailability.
     /// Returns true if the live out set changed.
     bool mergeFromPred(const LiveOutBlockState &Pred) {
-      bool changed = false;
-      for (unsigned i = 0, e = OutAvailability.size(); i != e; ++i) {
-        Optional<DIKind> result;
-        if (transferAvailability(Pred.OutAvailability.getConditional(i),
-                                 OutAvailability.getConditional(i),
-                                 LocalAvailability.getConditional(i),
-                                 result)) {
-          changed = true;
-          OutAvailability.set(i, result);
-        }
-      }
+      bool changed = OutAvailability.transferFrom(Pred.OutAvailability,
+                                                  LocalAvailability);
 
       Optional<DIKind> result;
       if (transferAvailability(Pred.OutSelfConsumed,
@@ -424,10 +455,8 @@ namespace {
       // ignore.
       if (LocalAvailability.empty()) return;
       
-      for (unsigned i = 0; i != Use.NumElements; ++i) {
-        LocalAvailability.set(Use.FirstElement+i, DIKind::Yes);
-        OutAvailability.set(Use.FirstElement+i, DIKind::Yes);
-      }
+      LocalAvailability.set(Use.FirstElement, Use.NumElements, DIKind::Yes);
+      OutAvailability.set(Use.FirstElement, Use.NumElements, DIKind::Yes);
     }
 
     /// Mark the block as a failure path, indicating the self value has been
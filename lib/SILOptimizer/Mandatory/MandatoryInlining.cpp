@@ -30,6 +30,9 @@ typedef llvm::ImmutableSet<SILFunction*> ImmutableFunctionSet;
 STATISTIC(NumMandatoryInlines,
           "Number of function application sites inlined by the mandatory "
           "inlining pass");
+STATISTIC(NumTransparentDeadInsts,
+          "Number of dead instructions removed from transparent functions "
+          "before inlining them");
 
 template<typename...T, typename...U>
 static void diagnose(ASTContext &Context, SourceLoc loc, Diag<T...> diag,
@@ -301,6 +304,26 @@ getCalleeFunction(FullApplySite AI, bool &IsThick,
   return CalleeFunction;
 }
 
+/// \brief Remove the instructions of \p F which are trivially dead, e.g.
+/// the parts of inlined bodies whose results the function doesn't use.
+static void removeTriviallyDeadInstructions(SILFunction &F) {
+  auto Callback = [](SILInstruction *) { ++NumTransparentDeadInsts; };
+  for (auto &BB : F) {
+    // Walk the block backwards, so that instructions which only feed dead
+    // instructions are found dead as well. Instructions are only deleted
+    // before the position of the iterator, which keeps it valid.
+    auto II = BB.end();
+    while (II != BB.begin()) {
+      SILInstruction *Inst = &*--II;
+      if (!isInstructionTriviallyDead(Inst))
+        continue;
+      ++II;
+      recursivelyDeleteTriviallyDeadInstructions(Inst, /*Force=*/true,
+                                                 Callback);
+    }
+  }
+}
+
 /// \brief Inlines all mandatory inlined functions into the body of a function,
 /// first recursively inlining all mandatory apply instructions in those
 /// functions into their bodies if necessary.
@@ -343,6 +366,7 @@ runOnFunctionRecursively(SILFunction *F, FullApplySite AI,
 
   SmallVector<SILValue, 16> CaptureArgs;
   SmallVector<SILValue, 32> FullArgs;
+  bool InlinedAny = false;
 
   for (auto FI = F->begin(), FE = F->end(); FI != FE; ++FI) {
     for (auto I = FI->begin(), E = FI->end(); I != E; ++I) {
@@ -472,9 +496,16 @@ runOnFunctionRecursively(SILFunction *F, FullApplySite AI,
       assert(FI == SILFunction::iterator(I->getParent()) &&
              "Mismatch between the instruction and basic block");
       ++NumMandatoryInlines;
+      InlinedAny = true;
     }
   }
 
+  // A transparent function is cloned into each of its callers. Remove what
+  // became dead by inlining into it once here, rather than cloning it and
+  // leaving it to later passes to clean up in every caller.
+  if (InlinedAny && F->isTransparent())
+    removeTriviallyDeadInstructions(*F);
+
   // Keep track of full inlined functions so we don't waste time recursively
   // reprocessing them.
   FullyInlinedSet.insert(F);
@@ -14,6 +14,8 @@
 
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/JSONSerialization.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
@@ -22,12 +24,20 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
 
 using namespace swift;
 
@@ -91,10 +101,30 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<bool> SILVerifyInvalidatedOnly(
+    "sil-verify-invalidated-only", llvm::cl::init(false),
+    llvm::cl::desc("After module passes, only verify the functions which the "
+                   "pass has invalidated instead of the whole module"));
+
+llvm::cl::opt<unsigned> SILVerifySampleRate(
+    "sil-verify-sample-rate", llvm::cl::init(1),
+    llvm::cl::desc("Only verify after every n-th pass run"));
+
 llvm::cl::opt<bool> SILDisableSkippingPasses(
     "sil-disable-skipping-passes", llvm::cl::init(false),
     llvm::cl::desc("Do not skip passes even if nothing was changed"));
 
+llvm::cl::opt<std::string> SILPassStatsFile(
+    "sil-pass-stats-json", llvm::cl::init(""),
+    llvm::cl::desc("Write the wall time, instruction count change and "
+                   "allocation of each SIL pass on each function to <file> "
+                   "as JSON"));
+
+llvm::cl::opt<unsigned> SILFunctionPassThreads(
+    "sil-function-pass-threads", llvm::cl::init(0),
+    llvm::cl::desc("Run function passes on up to <N> functions at the same "
+                   "time if all passes in a group support it"));
+
 static llvm::ManagedStatic<std::vector<unsigned>> DebugPassNumbers;
 
 namespace {
@@ -227,6 +257,220 @@ public:
   }
 };
 
+namespace {
+
+/// The accumulated statistics of a pass on a function, or on the whole
+/// module for module passes, within one optimization stage.
+struct PassStatistics {
+  std::string Stage;
+  std::string Pass;
+  std::string Function;
+  uint64_t Runs = 0;
+  uint64_t WallNanoseconds = 0;
+  int64_t InstructionDelta = 0;
+  uint64_t AllocatedBytes = 0;
+  uint64_t PeakAllocatedBytes = 0;
+};
+
+/// The statistics of all pass managers for -sil-pass-stats-json.
+struct PassStatisticsTable {
+  std::vector<PassStatistics> Entries;
+  llvm::StringMap<unsigned> EntryIndex;
+
+  PassStatistics &get(StringRef Stage, StringRef Pass, StringRef Function) {
+    std::string Key = (Stage + Twine('\0') + Pass + Twine('\0') +
+                       Function).str();
+    auto Inserted = EntryIndex.insert({Key, Entries.size()});
+    if (Inserted.second) {
+      Entries.emplace_back();
+      Entries.back().Stage = Stage.str();
+      Entries.back().Pass = Pass.str();
+      Entries.back().Function = Function.str();
+    }
+    return Entries[Inserted.first->second];
+  }
+};
+
+} // end anonymous namespace
+
+static llvm::ManagedStatic<PassStatisticsTable> AllPassStatistics;
+
+namespace swift {
+namespace json {
+
+template <>
+struct ObjectTraits<PassStatistics> {
+  static void mapping(Output &out, PassStatistics &stats) {
+    out.mapRequired("stage", stats.Stage);
+    out.mapRequired("pass", stats.Pass);
+    out.mapRequired("function", stats.Function);
+    out.mapRequired("runs", stats.Runs);
+    out.mapRequired("wall_ns", stats.WallNanoseconds);
+    out.mapRequired("instruction_delta", stats.InstructionDelta);
+    out.mapRequired("allocated_bytes", stats.AllocatedBytes);
+    out.mapRequired("peak_allocated_bytes", stats.PeakAllocatedBytes);
+  }
+};
+
+template <>
+struct ArrayTraits<std::vector<PassStatistics>> {
+  static size_t size(Output &out, std::vector<PassStatistics> &seq) {
+    return seq.size();
+  }
+  static PassStatistics &element(Output &out,
+                                 std::vector<PassStatistics> &seq,
+                                 size_t index) {
+    return seq[index];
+  }
+};
+
+} // end namespace json
+} // end namespace swift
+
+static unsigned countInstructions(SILFunction &F) {
+  unsigned Count = 0;
+  for (auto &BB : F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+static unsigned countInstructions(SILModule &M) {
+  unsigned Count = 0;
+  for (auto &F : M)
+    Count += countInstructions(F);
+  return Count;
+}
+
+namespace {
+
+/// Records one run of a pass in the -sil-pass-stats-json table. The
+/// function is null for module passes.
+class PassStatisticsScope {
+  SILModule *Mod = nullptr;
+  SILFunction *F;
+  StringRef Stage;
+  SILTransform *T;
+  std::chrono::steady_clock::time_point StartTime;
+  unsigned InstructionsBefore = 0;
+  size_t BytesBefore = 0;
+
+  unsigned countInstructions() const {
+    return F ? ::countInstructions(*F) : ::countInstructions(*Mod);
+  }
+
+public:
+  PassStatisticsScope(SILModule *M, SILFunction *F, StringRef Stage,
+                      SILTransform *T)
+      : F(F), Stage(Stage), T(T) {
+    if (SILPassStatsFile.empty())
+      return;
+    Mod = M;
+    InstructionsBefore = countInstructions();
+    BytesBefore = Mod->getBytesAllocated();
+    StartTime = std::chrono::steady_clock::now();
+  }
+
+  ~PassStatisticsScope() {
+    if (!Mod)
+      return;
+    auto Elapsed = std::chrono::steady_clock::now() - StartTime;
+    uint64_t Bytes = Mod->getBytesAllocated() - BytesBefore;
+
+    PassStatistics &Stats = AllPassStatistics->get(
+        Stage, T->getName(), F ? F->getName() : StringRef());
+    ++Stats.Runs;
+    Stats.WallNanoseconds +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Elapsed).count();
+    Stats.InstructionDelta +=
+        int64_t(countInstructions()) - int64_t(InstructionsBefore);
+    Stats.AllocatedBytes += Bytes;
+    Stats.PeakAllocatedBytes = std::max(Stats.PeakAllocatedBytes, Bytes);
+  }
+};
+
+/// Records one run of a pass as an event of the -trace-events-dir trace.
+/// Function passes which take less than 100 microseconds are left out, as
+/// there are far too many of them to be shown in a timeline.
+class PassTraceScope {
+  TraceEventRecorder *Trace;
+  SILFunction *F;
+  SILTransform *T;
+  int64_t StartTime = 0;
+
+public:
+  PassTraceScope(SILFunction *F, SILTransform *T)
+      : Trace(TraceEventRecorder::get()), F(F), T(T) {
+    if (Trace)
+      StartTime = TraceEventRecorder::now();
+  }
+
+  ~PassTraceScope() {
+    if (!Trace)
+      return;
+    int64_t Duration = TraceEventRecorder::now() - StartTime;
+    if (F && Duration < 100)
+      return;
+    Trace->addCompleteEvent(T->getName(),
+                            F ? "sil-function-pass" : "sil-module-pass",
+                            StartTime, Duration,
+                            F ? F->getName() : StringRef());
+  }
+};
+
+} // end anonymous namespace
+
+/// Write everything recorded so far to the -sil-pass-stats-json file. This
+/// is done whenever a pass manager goes away, so the file always holds the
+/// statistics of all pass managers of the compilation.
+static void writePassStatistics() {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(SILPassStatsFile, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "error opening '" << SILPassStatsFile
+                 << "' for pass statistics: " << EC.message() << '\n';
+    return;
+  }
+  json::Output Out(OS);
+  Out << AllPassStatistics->Entries;
+  OS << '\n';
+}
+
+// The maximum number of times the pass pipeline can be restarted for a
+// function. This is used to ensure we are not going into an infinite loop in
+// cases where (for example) we have recursive type-based specialization
+// happening.
+static const unsigned MaxNumRestarts = 20;
+
+namespace {
+
+/// The state of a thread running function passes for
+/// runFunctionPassesInParallel. It replaces the pass manager's
+/// CurrentPassHasInvalidated and RestartPipeline flags on that thread.
+struct ParallelWorker {
+  bool CurrentPassHasInvalidated = false;
+  bool RestartPipeline = false;
+};
+
+} // end anonymous namespace
+
+/// The worker that runs on this thread, or null if passes are not running in
+/// parallel.
+static LLVM_THREAD_LOCAL ParallelWorker *CurrentWorker = nullptr;
+
+static SILFunctionTransform *createFunctionTransform(PassKind Kind) {
+  SILTransform *T = nullptr;
+  switch (Kind) {
+#define PASS(ID, NAME, DESCRIPTION)                                            \
+  case PassKind::ID:                                                           \
+    T = swift::create##ID();                                                   \
+    break;
+#include "swift/SILOptimizer/PassManager/Passes.def"
+  case PassKind::invalidPassKind:
+    llvm_unreachable("invalid pass kind");
+  }
+  T->setPassKind(Kind);
+  return cast<SILFunctionTransform>(T);
+}
 
 SILPassManager::SILPassManager(SILModule *M, llvm::StringRef Stage) :
   Mod(M), StageName(Stage) {
@@ -319,7 +563,11 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
   Mod->registerDeleteNotificationHandler(SFT);
   if (breakBeforeRunning(F->getName(), SFT->getName()))
     LLVM_BUILTIN_DEBUGTRAP;
-  SFT->run();
+  {
+    PassStatisticsScope Stats(Mod, F, StageName, SFT);
+    PassTraceScope Trace(F, SFT);
+    SFT->run();
+  }
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->removeDeleteNotificationHandler(SFT);
 
@@ -342,7 +590,7 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
   if (!CurrentPassHasInvalidated)
     completedPasses.set((size_t)SFT->getPassKind());
 
-  if (getOptions().VerifyAll &&
+  if (getOptions().VerifyAll && shouldVerifyAfterPass() &&
       (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
     F->verify();
     verifyAnalyses(F);
@@ -358,6 +606,12 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
 
   BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
   BottomUpFunctionOrder BottomUpOrder(*Mod, BCA);
+
+  if (canRunFunctionPassesInParallel(FuncTransforms)) {
+    runFunctionPassesInParallel(FuncTransforms, BottomUpOrder);
+    return;
+  }
+
   auto BottomUpFunctions = BottomUpOrder.getFunctions();
 
   assert(FunctionWorklist.empty() && "Expected empty function worklist!");
@@ -375,12 +629,6 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
 
   DerivationLevels.clear();
 
-  // The maximum number of times the pass pipeline can be restarted for a
-  // function. This is used to ensure we are not going into an infinite loop in
-  // cases where (for example) we have recursive type-based specialization
-  // happening.
-  const unsigned MaxNumRestarts = 20;
-
   if (SILPrintPassName)
     llvm::dbgs() << "Start function passes at stage: " << StageName << "\n";
 
@@ -414,6 +662,187 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
   }
 }
 
+bool SILPassManager::canRunFunctionPassesInParallel(PassList FuncTransforms) {
+  if (SILFunctionPassThreads < 2)
+    return false;
+
+  // The debugging options rely on passes running one at a time, in a
+  // deterministic order.
+  if (SILPrintAll || SILPrintPassName || SILPrintPassTime ||
+      SILNumOptPassesToRun != UINT_MAX || !SILBreakOnFun.empty() ||
+      !SILBreakOnPass.empty() || !SILPrintBefore.empty() ||
+      !SILPrintAfter.empty() || !SILPrintAround.empty() ||
+      !DebugPassNumbers->empty() || getOptions().VerifyAll ||
+      !SILPassStatsFile.empty())
+    return false;
+
+  for (SILFunctionTransform *SFT : FuncTransforms)
+    if (!SFT->isParallelSafe())
+      return false;
+
+  return true;
+}
+
+void SILPassManager::runPassOnFunctionInParallel(SILFunctionTransform *SFT,
+                                                 SILFunction *F) {
+  ParallelWorker *Worker = CurrentWorker;
+  assert(Worker && "Expected to run on a worker thread!");
+
+  SFT->injectPassManager(this);
+  SFT->injectFunction(F);
+
+  unsigned PassNumber;
+  {
+    std::lock_guard<std::mutex> Guard(ParallelLock);
+    PassNumber = NumPassesRun++;
+
+    // If nothing changed since the last run of this pass, we can skip this
+    // pass.
+    if (CompletedPassesMap[F].test((size_t)SFT->getPassKind()) &&
+        !SILDisableSkippingPasses)
+      return;
+  }
+
+  if (isDisabled(SFT))
+    return;
+
+  PrettyStackTraceSILFunctionTransform X(SFT, PassNumber);
+  Worker->CurrentPassHasInvalidated = false;
+  {
+    PassTraceScope Trace(F, SFT);
+    SFT->run();
+  }
+
+  // Remember if this pass didn't change anything.
+  if (!Worker->CurrentPassHasInvalidated) {
+    std::lock_guard<std::mutex> Guard(ParallelLock);
+    CompletedPassesMap[F].set((size_t)SFT->getPassKind());
+  }
+}
+
+void SILPassManager::runFunctionPassesInParallel(
+    PassList FuncTransforms, BottomUpFunctionOrder &BottomUpOrder) {
+  BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
+  auto SCCs = BottomUpOrder.getSCCs();
+
+  llvm::DenseMap<SILFunction *, unsigned> SCCIndex;
+  for (unsigned Idx = 0, E = SCCs.size(); Idx != E; ++Idx)
+    for (SILFunction *F : SCCs[Idx])
+      SCCIndex[F] = Idx;
+
+  // Assign each SCC a level one higher than the highest level of the SCCs
+  // it calls, using the same call edges as BottomUpFunctionOrder. SCCs on
+  // the same level never call each other, directly or indirectly, so they
+  // can be processed at the same time while every function still sees its
+  // callees fully optimized. The bottom-up order visits callees first, so
+  // their levels are already known.
+  std::vector<unsigned> Levels(SCCs.size());
+  unsigned NumLevels = 0;
+  for (unsigned Idx = 0, E = SCCs.size(); Idx != E; ++Idx) {
+    unsigned Level = 0;
+    for (SILFunction *F : SCCs[Idx]) {
+      for (auto &BB : *F) {
+        for (auto &I : BB) {
+          auto FAS = FullApplySite::isa(&I);
+          if (!FAS && !isa<StrongReleaseInst>(&I) &&
+              !isa<ReleaseValueInst>(&I))
+            continue;
+
+          auto Callees = FAS ? BCA->getCalleeList(FAS) : BCA->getCalleeList(&I);
+          for (SILFunction *Callee : Callees) {
+            auto It = SCCIndex.find(Callee);
+            if (It != SCCIndex.end() && It->second != Idx)
+              Level = std::max(Level, Levels[It->second] + 1);
+          }
+        }
+      }
+    }
+    Levels[Idx] = Level;
+    NumLevels = std::max(NumLevels, Level + 1);
+  }
+
+  // Sort the SCCs by level. LevelStart[L] is the number of SCCs on the
+  // levels below L.
+  std::vector<unsigned> LevelStart(NumLevels + 1);
+  for (unsigned Level : Levels)
+    ++LevelStart[Level + 1];
+  for (unsigned L = 0; L != NumLevels; ++L)
+    LevelStart[L + 1] += LevelStart[L];
+
+  std::vector<unsigned> Tasks(SCCs.size());
+  {
+    std::vector<unsigned> Next(LevelStart.begin(), LevelStart.end() - 1);
+    for (unsigned Idx = 0, E = SCCs.size(); Idx != E; ++Idx)
+      Tasks[Next[Levels[Idx]]++] = Idx;
+  }
+
+  // Tasks are handed out in order, so a thread waiting for the levels below
+  // its task only waits for tasks which are already running.
+  std::atomic<unsigned> NextTask(0);
+  unsigned NumTasksDone = 0;
+  std::condition_variable TaskDone;
+
+  auto Work = [&] {
+    ParallelWorker Worker;
+    CurrentWorker = &Worker;
+
+    // A transform keeps the function it runs on, so every thread needs its
+    // own instances.
+    SmallVector<SILFunctionTransform *, 16> Transforms;
+    for (SILFunctionTransform *SFT : FuncTransforms)
+      Transforms.push_back(createFunctionTransform(SFT->getPassKind()));
+
+    for (unsigned TaskIdx = NextTask++; TaskIdx < Tasks.size();
+         TaskIdx = NextTask++) {
+      unsigned Idx = Tasks[TaskIdx];
+      {
+        std::unique_lock<std::mutex> Guard(ParallelLock);
+        TaskDone.wait(Guard, [&] {
+          return NumTasksDone >= LevelStart[Levels[Idx]];
+        });
+      }
+
+      for (SILFunction *F : SCCs[Idx]) {
+        if (!F->isDefinition() || !F->shouldOptimize())
+          continue;
+
+        unsigned PipelineIdx = 0;
+        unsigned NumRestarts = 0;
+        while (PipelineIdx < Transforms.size()) {
+          Worker.RestartPipeline = false;
+          runPassOnFunctionInParallel(Transforms[PipelineIdx], F);
+          if (Worker.RestartPipeline && NumRestarts < MaxNumRestarts) {
+            ++NumRestarts;
+            PipelineIdx = 0;
+          } else {
+            ++PipelineIdx;
+          }
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> Guard(ParallelLock);
+        ++NumTasksDone;
+      }
+      TaskDone.notify_all();
+    }
+
+    for (SILFunctionTransform *SFT : Transforms)
+      delete SFT;
+    CurrentWorker = nullptr;
+  };
+
+  unsigned NumThreads = std::min<size_t>(SILFunctionPassThreads, SCCs.size());
+  std::vector<std::thread> Threads;
+  SILAnalysis::beginRunningInParallel();
+  for (unsigned i = 1; i < NumThreads; ++i)
+    Threads.push_back(std::thread(Work));
+  Work();
+  for (auto &Thread : Threads)
+    Thread.join();
+  SILAnalysis::endRunningInParallel();
+}
+
 void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   if (isDisabled(SMT))
     return;
@@ -427,6 +856,8 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   SMT->injectModule(Mod);
 
   CurrentPassHasInvalidated = false;
+  CurrentPassHasInvalidatedModule = false;
+  InvalidatedFunctions.clear();
 
   if (SILPrintPassName)
     llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
@@ -442,7 +873,11 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    PassStatisticsScope Stats(Mod, nullptr, StageName, SMT);
+    PassTraceScope Trace(nullptr, SMT);
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
@@ -461,11 +896,28 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
-  if (Options.VerifyAll &&
-      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
-    Mod->verify();
-    verifyAnalyses();
+  if (Options.VerifyAll && shouldVerifyAfterPass()) {
+    if (SILVerifyInvalidatedOnly && !CurrentPassHasInvalidatedModule &&
+        !SILVerifyWithoutInvalidation) {
+      // Only re-verify the functions which the pass reported as changed.
+      // Look them up in the module instead of using the recorded pointers,
+      // which may refer to functions deleted by the pass.
+      for (SILFunction &F : *Mod) {
+        if (InvalidatedFunctions.count(&F)) {
+          F.verify();
+          verifyAnalyses(&F);
+        }
+      }
+    } else if (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation) {
+      Mod->verify();
+      verifyAnalyses();
+    }
   }
+  InvalidatedFunctions.clear();
+}
+
+bool SILPassManager::shouldVerifyAfterPass() const {
+  return SILVerifySampleRate <= 1 || NumPassesRun % SILVerifySampleRate == 0;
 }
 
 void SILPassManager::runOneIteration() {
@@ -552,12 +1004,16 @@ SILPassManager::~SILPassManager() {
            "Deleting a locked analysis. Did we forget to unlock ?");
     delete A;
   }
+
+  if (!SILPassStatsFile.empty())
+    writePassStatistics();
 }
 
 void SILPassManager::addFunctionToWorklist(SILFunction *F,
                                            SILFunction *DerivedFrom) {
   assert(F && F->isDefinition() && F->shouldOptimize() &&
          "Expected optimizable function definition!");
+  assert(!CurrentWorker && "Parallel passes must not create functions!");
 
   const int MaxDeriveLevels = 10;
 
@@ -584,9 +1040,53 @@ void SILPassManager::addFunctionToWorklist(SILFunction *F,
 void SILPassManager::restartWithCurrentFunction(SILTransform *T) {
   assert(isa<SILFunctionTransform>(T) &&
          "Can only restart the pipeline from function passes");
+  if (ParallelWorker *Worker = CurrentWorker) {
+    Worker->RestartPipeline = true;
+    return;
+  }
   RestartPipeline = true;
 }
 
+void SILPassManager::invalidateAnalysis(SILFunction *F,
+                                        SILAnalysis::InvalidationKind K) {
+  // Passes running in parallel must not invalidate analyses at the same
+  // time, because not every analysis is thread-safe.
+  ParallelWorker *Worker = CurrentWorker;
+  std::unique_lock<std::mutex> Guard(ParallelLock, std::defer_lock);
+  if (Worker)
+    Guard.lock();
+
+  // Invalidate the analysis (unless they are locked)
+  for (auto AP : Analysis)
+    if (!AP->isLocked())
+      AP->invalidate(F, K);
+
+  if (Worker)
+    Worker->CurrentPassHasInvalidated = true;
+  else
+    CurrentPassHasInvalidated = true;
+  InvalidatedFunctions.insert(F);
+  // Any change let all passes run again.
+  CompletedPassesMap[F].reset();
+}
+
+void SILPassManager::invalidateAnalysisForDeadFunction(
+    SILFunction *F, SILAnalysis::InvalidationKind K) {
+  assert(!CurrentWorker && "Parallel passes must not delete functions!");
+
+  // Invalidate the analysis (unless they are locked)
+  for (auto AP : Analysis)
+    if (!AP->isLocked())
+      AP->invalidateForDeadFunction(F, K);
+
+  CurrentPassHasInvalidated = true;
+  // Any change let all passes run again.
+  CompletedPassesMap[F].reset();
+  // A new function may be allocated at the same address.
+  LastRunEpochs.erase(F);
+  InvalidatedFunctions.erase(F);
+}
+
 /// \brief Reset the state of the pass manager and remove all transformation
 /// owned by the pass manager. Analysis passes will be kept.
 void SILPassManager::resetAndRemoveTransformations() {
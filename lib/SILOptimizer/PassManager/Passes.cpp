@@ -153,11 +153,19 @@ void AddHighLevelLoopOptPasses(SILPassManager &PM) {
   PM.addSILCombine();
   PM.addSimplifyCFG();
   PM.addHighLevelLICM();
+  // Loop unswitching and unrolling duplicate code, which is not worth it at
+  // -Osize.
+  bool OptimizeForSize = PM.getModule()->getOptions().Optimization ==
+                         SILOptions::SILOptMode::OptimizeForSize;
+  // Version loops on the invariant conditions which LICM couldn't hoist.
+  if (!OptimizeForSize)
+    PM.addLoopUnswitch();
   // Start of loop unrolling passes.
   PM.addArrayCountPropagation();
   // To simplify induction variable.
   PM.addSILCombine();
-  PM.addLoopUnroll();
+  if (!OptimizeForSize)
+    PM.addLoopUnroll();
   PM.addSimplifyCFG();
   PM.addPerformanceConstantPropagation();
   PM.addSimplifyCFG();
@@ -197,6 +205,9 @@ void AddSSAPasses(SILPassManager &PM, OptimizationLevelKind OpLevel) {
   // makes a change we'll end up restarting the function passes on the
   // current function (after optimizing any new callees).
   PM.addDevirtualizer();
+  // Turn existential arguments with known concrete types into generic
+  // arguments, so that the generic specializer can specialize the callee.
+  PM.addExistentialSpecializer();
   PM.addGenericSpecializer();
 
   switch (OpLevel) {
@@ -393,6 +404,22 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // after FSO.
   PM.addLateReleaseHoisting();
 
+  // Reference counting of objects which don't escape doesn't need to be
+  // atomic. This must run after all passes which create new retains and
+  // releases.
+  PM.addNonAtomicRC();
+
+  // At -Osize, share repeated reference counting sequences between functions.
+  // This must run after the ARC optimizations, which can't see into the
+  // outlined functions.
+  if (Module.getOptions().Optimization ==
+        SILOptions::SILOptMode::OptimizeForSize)
+    PM.addOutliner();
+
+  // Summarize the effects of public functions for clients of the module. This
+  // must run after the last pass which changes function bodies.
+  PM.addExportFunctionEffects();
+
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
@@ -426,6 +453,20 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   PM.run();
   PM.resetAndRemoveTransformations();
 
+  // At -Odebug, run a few passes which are cheap and keep all debug values.
+  // They remove the most obvious overhead of unoptimized code: variables in
+  // memory, retain/release pairs from SILGen and heap allocated objects
+  // which don't escape.
+  if (Module.getOptions().Optimization == SILOptions::SILOptMode::Debug) {
+    PM.setStageName("Odebug");
+    PM.addMem2Reg();
+    PM.addSILCombine();
+    PM.addGuaranteedARCOpts();
+    PM.addStackPromotion();
+    PM.runOneIteration();
+    PM.resetAndRemoveTransformations();
+  }
+
   // Don't keep external functions from stdlib and other modules.
   // We don't want that our unoptimized version will be linked instead
   // of the optimized version from the stdlib.
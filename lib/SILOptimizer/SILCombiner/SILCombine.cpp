@@ -25,12 +25,14 @@
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Analysis/SimplifyInstruction.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
@@ -39,18 +41,38 @@ STATISTIC(NumSimplified, "Number of instructions simplified");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
 
+static llvm::cl::opt<bool> SILCombineChangedOnly(
+    "sil-combine-changed-only", llvm::cl::init(false),
+    llvm::cl::desc("Only visit the instructions which changed since the "
+                   "last run of SILCombine on a function. Peepholes which "
+                   "depend on non-local facts may fire less often"));
+
 //===----------------------------------------------------------------------===//
 //                              Utility Methods
 //===----------------------------------------------------------------------===//
 
+/// Returns true if \p I or one of the instructions defining its operands
+/// changed after \p ChangedAfterEpoch.
+static bool hasChangedSince(SILInstruction *I, unsigned ChangedAfterEpoch) {
+  if (I->getModificationEpoch() > ChangedAfterEpoch)
+    return true;
+  for (auto &Op : I->getAllOperands())
+    if (auto *Def = dyn_cast<SILInstruction>(Op.get()))
+      if (Def->getModificationEpoch() > ChangedAfterEpoch)
+        return true;
+  return false;
+}
+
 /// addReachableCodeToWorklist - Walk the function in depth-first order, adding
-/// all reachable code to the worklist.
+/// all reachable code which changed after \p ChangedAfterEpoch to the
+/// worklist.
 ///
 /// This has a couple of tricks to make the code faster and more powerful.  In
 /// particular, we DCE instructions as we go, to avoid adding them to the
 /// worklist (this significantly speeds up SILCombine on code where many
 /// instructions are dead or constant).
-void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
+void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB,
+                                             unsigned ChangedAfterEpoch) {
   llvm::SmallVector<SILBasicBlock *, 256> Worklist;
   llvm::SmallVector<SILInstruction *, 128> InstrsForSILCombineWorklist;
   llvm::SmallPtrSet<SILBasicBlock *, 32> Visited;
@@ -84,6 +106,12 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
         continue;
       }
 
+      // Peepholes only look at an instruction, its operands and its uses.
+      // If none of them changed since the last run, there is nothing new
+      // to combine.
+      if (ChangedAfterEpoch && !hasChangedSince(Inst, ChangedAfterEpoch))
+        continue;
+
       InstrsForSILCombineWorklist.push_back(Inst);
     }
 
@@ -112,14 +140,15 @@ void SILCombineWorklist::add(SILInstruction *I) {
   Worklist.push_back(I);
 }
 
-bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
+bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration,
+                                 unsigned ChangedAfterEpoch) {
   MadeChange = false;
 
   DEBUG(llvm::dbgs() << "\n\nSILCOMBINE ITERATION #" << Iteration << " on "
                      << F.getName() << "\n");
 
   // Add reachable instructions to our worklist.
-  addReachableCodeToWorklist(&*F.begin());
+  addReachableCodeToWorklist(&*F.begin(), ChangedAfterEpoch);
 
   // Process until we run out of items in our worklist.
   while (!Worklist.isEmpty()) {
@@ -236,12 +265,19 @@ void SILCombineWorklist::addInitialGroup(ArrayRef<SILInstruction *> List) {
     }
 }
 
-bool SILCombiner::runOnFunction(SILFunction &F) {
+bool SILCombiner::runOnFunction(SILFunction &F, bool ChangedOnly,
+                                unsigned ChangedAfterEpoch) {
   clear();
 
   bool Changed = false;
-  // Perform iterations until we do not make any changes.
-  while (doOneIteration(F, Iteration)) {
+  // Perform iterations until we do not make any changes. If we only visit
+  // changed instructions, each iteration only needs to start with the
+  // instructions which the previous one changed.
+  while (true) {
+    unsigned IterationEpoch = ChangedOnly ? F.endModificationEpoch() : 0;
+    if (!doOneIteration(F, Iteration, ChangedAfterEpoch))
+      break;
+    ChangedAfterEpoch = IterationEpoch;
     Changed = true;
     Iteration++;
   }
@@ -324,14 +360,24 @@ class SILCombine : public SILFunctionTransform {
   /// The entry point to the transformation.
   void run() override {
     auto *AA = PM->getAnalysis<AliasAnalysis>();
+    auto *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
 
     // Create a SILBuilder with a tracking list for newly added
     // instructions, which we will periodically move to our worklist.
     SILBuilder B(*getFunction(), &TrackingList);
-    SILCombiner Combiner(B, AA, getOptions().RemoveRuntimeAsserts);
-    bool Changed = Combiner.runOnFunction(*getFunction());
+    SILCombiner Combiner(B, AA, CHA, getOptions().RemoveRuntimeAsserts);
+    SILFunction *F = getFunction();
+    unsigned LastRunEpoch = 0;
+    if (SILCombineChangedOnly) {
+      F->startTrackingModifications();
+      LastRunEpoch = PM->getLastRunEpoch(getPassKind(), F);
+    }
+    bool Changed =
+        Combiner.runOnFunction(*F, SILCombineChangedOnly, LastRunEpoch);
     assert(TrackingList.empty() &&
            "TrackingList should be fully processed by SILCombiner");
+    if (SILCombineChangedOnly)
+      PM->setLastRunEpoch(getPassKind(), F, F->endModificationEpoch());
 
     if (Changed) {
       // Invalidate everything.
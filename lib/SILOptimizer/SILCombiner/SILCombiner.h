@@ -32,6 +32,7 @@
 namespace swift {
 
 class AliasAnalysis;
+class ClassHierarchyAnalysis;
 
 /// This is the worklist management logic for SILCombine.
 class SILCombineWorklist {
@@ -107,6 +108,9 @@ class SILCombiner :
 
   AliasAnalysis *AA;
 
+  /// Used to find the conforming types of a protocol.
+  ClassHierarchyAnalysis *CHA;
+
   /// Worklist containing all of the instructions primed for simplification.
   SILCombineWorklist Worklist;
 
@@ -126,8 +130,9 @@ class SILCombiner :
   CastOptimizer CastOpt;
 
 public:
-  SILCombiner(SILBuilder &B, AliasAnalysis *AA, bool removeCondFails)
-      : AA(AA), Worklist(), MadeChange(false), RemoveCondFails(removeCondFails),
+  SILCombiner(SILBuilder &B, AliasAnalysis *AA, ClassHierarchyAnalysis *CHA,
+              bool removeCondFails)
+      : AA(AA), CHA(CHA), Worklist(), MadeChange(false), RemoveCondFails(removeCondFails),
         Iteration(0), Builder(B),
         CastOpt(/* ReplaceInstUsesAction */
                 [&](SILInstruction *I, ValueBase * V) {
@@ -136,7 +141,16 @@ public:
                 /* EraseAction */
                 [&](SILInstruction *I) { eraseInstFromFunction(*I); }) {}
 
-  bool runOnFunction(SILFunction &F);
+  /// Combine the instructions of \p F until nothing changes anymore.
+  ///
+  /// If \p ChangedOnly is true, the function's modifications are tracked and
+  /// each iteration after the first only visits what the previous one
+  /// changed. If \p ChangedAfterEpoch is also not zero, the function was
+  /// already combined when its modification epoch was \p ChangedAfterEpoch,
+  /// and the first iteration only visits the instructions which changed since
+  /// and their users.
+  bool runOnFunction(SILFunction &F, bool ChangedOnly = false,
+                     unsigned ChangedAfterEpoch = 0);
 
   void clear() {
     Iteration = 0;
@@ -260,16 +274,24 @@ private:
       ProtocolDecl *Protocol,
       llvm::function_ref<void(CanType, ProtocolConformanceRef)> Propagate);
 
+  SILInstruction *
+  propagateSoleConformingType(FullApplySite AI, SILValue Self,
+      ProtocolDecl *Protocol,
+      llvm::function_ref<void(CanType, ProtocolConformanceRef)> Propagate);
+
   SILInstruction *propagateConcreteTypeOfInitExistential(FullApplySite AI,
                                                          WitnessMethodInst *WMI);
   SILInstruction *propagateConcreteTypeOfInitExistential(FullApplySite AI);
 
-  /// Perform one SILCombine iteration.
-  bool doOneIteration(SILFunction &F, unsigned Iteration);
+  /// Perform one SILCombine iteration, starting with the instructions which
+  /// changed after \p ChangedAfterEpoch.
+  bool doOneIteration(SILFunction &F, unsigned Iteration,
+                      unsigned ChangedAfterEpoch);
 
-  /// Add reachable code to the worklist. Meant to be used when starting to
-  /// process a new function.
-  void addReachableCodeToWorklist(SILBasicBlock *BB);
+  /// Add reachable code which changed after \p ChangedAfterEpoch to the
+  /// worklist. Meant to be used when starting to process a new function.
+  void addReachableCodeToWorklist(SILBasicBlock *BB,
+                                  unsigned ChangedAfterEpoch);
 
   typedef SmallVector<SILInstruction*, 4> UserListTy;
 
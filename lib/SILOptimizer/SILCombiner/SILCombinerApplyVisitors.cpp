@@ -20,6 +20,7 @@
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/CFG.h"
+#include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -806,7 +807,7 @@ SILCombiner::propagateConcreteTypeOfInitExistential(FullApplySite AI,
   SILInstruction *InitExistential =
     findInitExistential(AI, Self, OpenedArchetype, OpenedArchetypeDef);
   if (!InitExistential)
-    return nullptr;
+    return propagateSoleConformingType(AI, Self, Protocol, Propagate);
 
   // Try to derive the concrete type of self and a related conformance from
   // the found init_existential.
@@ -849,6 +850,79 @@ SILCombiner::propagateConcreteTypeOfInitExistential(FullApplySite AI,
   return NewAI;
 }
 
+/// Returns the only type which conforms to \p Protocol.
+///
+/// In whole-module mode, a protocol which is not public cannot be conformed to
+/// outside of the module. So if the module contains a single conforming type,
+/// every existential of the protocol must contain a value of this type.
+static NominalTypeDecl *getSoleConformingType(ProtocolDecl *Protocol,
+                                              SILModule &M,
+                                              ClassHierarchyAnalysis *CHA) {
+  if (!CHA || !M.isWholeModule() || Protocol->isObjC())
+    return nullptr;
+
+  // This also takes care of internal protocols with testing enabled.
+  if (Protocol->getEffectiveAccess() >= Accessibility::Public)
+    return nullptr;
+
+  auto &Impls = CHA->getProtocolImplementations(Protocol);
+  if (Impls.size() != 1)
+    return nullptr;
+
+  // We cannot derive the generic arguments of a generic conforming type.
+  NominalTypeDecl *NTD = Impls[0];
+  if (NTD->isGenericContext())
+    return nullptr;
+  return NTD;
+}
+
+/// Propagate the type of the only conformer of a non-public protocol into
+/// witness_method conformances and into apply instructions. This is used if
+/// the concrete type of an opened existential cannot be derived from an
+/// init_existential.
+SILInstruction *
+SILCombiner::propagateSoleConformingType(FullApplySite AI, SILValue Self,
+    ProtocolDecl *Protocol,
+    llvm::function_ref<void(CanType , ProtocolConformanceRef)> Propagate) {
+  if (!Protocol)
+    return nullptr;
+
+  SILModule &M = AI.getModule();
+  NominalTypeDecl *NTD = getSoleConformingType(Protocol, M, CHA);
+  if (!NTD)
+    return nullptr;
+
+  // Only existentials which are opened right here are handled. Class
+  // existentials can only contain classes.
+  if (!isa<OpenExistentialAddrInst>(Self) &&
+      !(isa<OpenExistentialRefInst>(Self) && isa<ClassDecl>(NTD)))
+    return nullptr;
+
+  CanType OpenedArchetype = Self->getType().getSwiftRValueType();
+  CanType ConcreteType = NTD->getDeclaredType()->getCanonicalType();
+  auto Conformance =
+      M.getSwiftModule()->lookupConformance(ConcreteType, Protocol, nullptr);
+  if (!Conformance)
+    return nullptr;
+
+  // Reinterpret the opened existential as a value of the concrete type.
+  Builder.setCurrentDebugScope(AI.getDebugScope());
+  SILValue NewSelf;
+  if (isa<OpenExistentialAddrInst>(Self))
+    NewSelf = Builder.createUncheckedAddrCast(
+        AI.getLoc(), Self, SILType::getPrimitiveAddressType(ConcreteType));
+  else
+    NewSelf = Builder.createUncheckedRefCast(
+        AI.getLoc(), Self, SILType::getPrimitiveObjectType(ConcreteType));
+
+  // Propagate the concrete type into the callee-operand if required.
+  Propagate(ConcreteType, *Conformance);
+
+  return createApplyWithConcreteType(AI, NewSelf, Self, ConcreteType,
+                                     SILValue(), *Conformance,
+                                     OpenedArchetype);
+}
+
 SILInstruction *
 SILCombiner::propagateConcreteTypeOfInitExistential(FullApplySite AI,
                                                     WitnessMethodInst *WMI) {
@@ -1120,6 +1194,14 @@ SILInstruction *SILCombiner::visitApplyInst(ApplyInst *AI) {
         return nullptr;
       }
     }
+    if (SF->hasSemanticsAttr("convertToObjectiveC")) {
+      UserListTy Users;
+      // A bridged object which is only retained and released is dead.
+      if (recursivelyCollectARCUsers(Users, AI)) {
+        eraseApply(AI, Users);
+        return nullptr;
+      }
+    }
   }
 
 
@@ -306,14 +306,17 @@ SILInstruction *SILCombiner::visitAllocStackInst(AllocStackInst *AS) {
     return nullptr;
 
   InitExistentialAddrInst *IEI = Analyzer.IEI;
-  OpenExistentialAddrInst *OEI = Analyzer.OEI;
 
   // If the only users of the alloc_stack are alloc, destroy and
   // init_existential_addr then we can promote the allocation of the init
-  // existential.
+  // existential. An open_existential_addr which is only destroyed doesn't
+  // get in the way either; this is what remains of a local existential
+  // once its method calls have been devirtualized. Promoting the allocation
+  // avoids boxing values which don't fit into the existential's inline
+  // buffer.
   // Be careful with open archetypes, because they cannot be moved before
   // their definitions.
-  if (IEI && !OEI &&
+  if (IEI &&
       !IEI->getLoweredConcreteType()
            .getSwiftRValueType()
            ->isOpenedExistential()) {
@@ -332,6 +335,28 @@ SILInstruction *SILCombiner::visitAllocStackInst(AllocStackInst *AS) {
         continue;
       }
 
+      // The analyzer made sure that the opened value is only destroyed.
+      if (auto *OpenedAddr = dyn_cast<OpenExistentialAddrInst>(Op->getUser())) {
+        for (auto OI = OpenedAddr->use_begin(), OE = OpenedAddr->use_end();
+             OI != OE;) {
+          auto *User = (*OI)->getUser();
+          ++OI;
+          if (auto *DA = dyn_cast<DestroyAddrInst>(User)) {
+            Builder.setInsertionPoint(DA);
+            Builder.createDestroyAddr(DA->getLoc(), ConcAlloc);
+          }
+          eraseInstFromFunction(*User);
+        }
+        eraseInstFromFunction(*OpenedAddr);
+        continue;
+      }
+
+      // The concrete allocation has no existential container to take apart.
+      if (isa<DeinitExistentialAddrInst>(Op->getUser())) {
+        eraseInstFromFunction(*Op->getUser());
+        continue;
+      }
+
       if (!isa<DeallocStackInst>(Op->getUser()))
         continue;
 
@@ -43,7 +43,13 @@ static SILInstruction* findUnexpectedBoxUse(SILValue Box,
                                             bool examinePartialApply,
                                             bool inAppliedFunction,
                                             llvm::SmallVectorImpl<Operand*> &);
-static bool partialApplyArgumentEscapes(Operand *O);
+static bool partialApplyArgumentEscapes(Operand *O, unsigned ExamineDepth);
+
+/// The number of nested function bodies which are examined to see if a
+/// closure passed to them escapes. Closures are often passed down through
+/// a few layers of helper functions (e.g. from a generic algorithm to its
+/// implementation) before they are called.
+static const unsigned MaxExamineDepth = 4;
 
 // Propagate liveness backwards from an initial set of blocks in our
 // LiveIn set.
@@ -178,7 +184,11 @@ static bool useCaptured(Operand *UI) {
   return true;
 }
 
-static bool partialApplyEscapes(SILValue V, bool examineApply) {
+/// Returns true if the closure \p V may escape.
+///
+/// If \p V is passed to a function, up to \p ExamineDepth levels of function
+/// bodies are examined to see if it escapes from there.
+static bool partialApplyEscapes(SILValue V, unsigned ExamineDepth) {
   for (auto UI : V->getUses()) {
     auto *User = UI->getUser();
 
@@ -199,7 +209,8 @@ static bool partialApplyEscapes(SILValue V, bool examineApply) {
 
       // Optionally drill down into an apply to see if the operand is
       // captured in or returned from the apply.
-      if (examineApply && !partialApplyArgumentEscapes(UI))
+      if (ExamineDepth > 0 &&
+          !partialApplyArgumentEscapes(UI, ExamineDepth - 1))
         continue;
     }
 
@@ -212,7 +223,7 @@ static bool partialApplyEscapes(SILValue V, bool examineApply) {
         ->getParameters();
       params = params.slice(params.size() - args.size(), args.size());
       if (params[UI->getOperandNumber()-1].isIndirect()) {
-        if (partialApplyEscapes(partialApply, /*examineApply = */ true))
+        if (partialApplyEscapes(partialApply, ExamineDepth))
           return true;
         continue;
       }
@@ -288,17 +299,16 @@ static SILFunction *getFunctionBody(SILInstruction *Call) {
 }
 
 /// Could this operand to an apply escape that function by being
-/// stored or returned?
-static bool partialApplyArgumentEscapes(Operand *O) {
+/// stored or returned? Calls in the function body are examined up to
+/// \p ExamineDepth levels deep.
+static bool partialApplyArgumentEscapes(Operand *O, unsigned ExamineDepth) {
   SILFunction *F = getFunctionBody(O->getUser());
   // If we cannot examine the function body, assume the worst.
   if (!F)
     return true;
 
-  // Check the uses of the operand, but do not recurse down into other
-  // apply instructions.
   auto Param = SILValue(getParameterForOperand(F, O));
-  return partialApplyEscapes(Param, /* examineApply = */ false);
+  return partialApplyEscapes(Param, ExamineDepth);
 }
 
 /// checkPartialApplyBody - Check the body of a partial apply to see
@@ -356,7 +366,7 @@ static SILInstruction* findUnexpectedBoxUse(SILValue Box,
     // itself cannot escape, then everything is fine.
     if (auto *PAI = dyn_cast<PartialApplyInst>(User))
       if (examinePartialApply && checkPartialApplyBody(UI) &&
-          !partialApplyEscapes(PAI, /* examineApply = */ true)) {
+          !partialApplyEscapes(PAI, MaxExamineDepth)) {
         LocalPromotedOperands.push_back(UI);
         continue;
       }
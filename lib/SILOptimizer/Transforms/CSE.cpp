@@ -13,6 +13,21 @@
 // This pass performs a simple dominator tree walk that eliminates trivially
 // redundant instructions.
 //
+// Before the walk, instructions which are computed on all paths out of a
+// block are hoisted into the block, so that the walk also eliminates their
+// copies after the paths join:
+//
+//   bb0:                                 bb0:
+//     cond_br %c, bb1, bb2                 %1 = struct_extract %0, #S.x
+//   bb1:                                   cond_br %c, bb1, bb2
+//     %1 = struct_extract %0, #S.x   =>  bb1:
+//     ...                                  ...
+//   bb2:                                 bb2:
+//     %2 = struct_extract %0, #S.x         ...
+//     ...                                bb3:
+//   bb3:                                   // uses %1
+//     %3 = struct_extract %0, #S.x
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-cse"
@@ -42,6 +57,7 @@ STATISTIC(NumOpenExtRemoved,
 
 STATISTIC(NumSimplify, "Number of instructions simplified or DCE'd");
 STATISTIC(NumCSE,      "Number of instructions CSE'd");
+STATISTIC(NumHoisted,  "Number of instructions hoisted out of all successors");
 
 using namespace swift;
 
@@ -449,6 +465,10 @@ public:
       : SEA(SEA), RunsOnHighLevelSil(RunsOnHighLevelSil) {}
 
   bool processFunction(SILFunction &F, DominanceInfo *DT);
+
+  /// Hoist the instructions which are computed in all successors of a block
+  /// into the block.
+  bool hoistCommonInstructions(SILFunction &F, DominanceInfo *DT);
   
   bool canHandle(SILInstruction *Inst);
 
@@ -509,6 +529,8 @@ private:
   };
 
   bool processNode(DominanceInfoNode *Node);
+  bool canHoist(SILInstruction *Inst, SILBasicBlock *To, DominanceInfo *DT);
+  bool hoistCommonInstructions(SILBasicBlock *BB, DominanceInfo *DT);
   bool processOpenExistentialRef(SILInstruction *Inst, ValueBase *V,
                                  SILBasicBlock::iterator &I);
 };
@@ -623,10 +645,11 @@ static void updateBasicBlockArgTypes(SILBasicBlock *BB,
     // Then replace all uses by an undef.
     Arg->replaceAllUsesWith(SILUndef::get(Arg->getType(), BB->getModule()));
     // Replace the type of the BB argument.
-    BB->replaceBBArg(Arg->getIndex(), NewArgType, Arg->getDecl());
+    auto *NewArg =
+        BB->replaceBBArg(Arg->getIndex(), NewArgType, Arg->getDecl());
     // Restore all uses to refer to the BB argument with updated type.
     for (auto ArgUse : OriginalArgUses) {
-      ArgUse->set(Arg);
+      ArgUse->set(NewArg);
     }
   }
 }
@@ -735,6 +758,16 @@ bool CSE::processOpenExistentialRef(SILInstruction *Inst, ValueBase *V,
   return true;
 }
 
+/// Returns true if \p AI is a call of a _bridgeToObjectiveC method, which
+/// doesn't consume the bridged value.
+static bool isBridgeToObjectiveCCall(ApplyInst *AI) {
+  if (!AI->hasSemantics("convertToObjectiveC") || AI->getNumArguments() != 1 ||
+      AI->hasIndirectResults())
+    return false;
+  return AI->getOrigCalleeType()->getParameters()[0].getConvention() ==
+         ParameterConvention::Direct_Guaranteed;
+}
+
 bool CSE::processNode(DominanceInfoNode *Node) {
   SILBasicBlock *BB = Node->getBlock();
   bool Changed = false;
@@ -782,6 +815,13 @@ bool CSE::processNode(DominanceInfoNode *Node) {
     // instruction has an available value.  If so, use it.
     if (ValueBase *V = AvailableValues->lookup(Inst)) {
       DEBUG(llvm::dbgs() << "SILCSE CSE: " << *Inst << "  to: " << *V << '\n');
+      // The result of a bridging call is owned. Retain the available one
+      // right after it is created, so that it lives as long as the uses of
+      // the replaced call.
+      if (auto *AI = dyn_cast<ApplyInst>(Inst))
+        if (isBridgeToObjectiveCCall(AI))
+          SILBuilderWithScope(std::next(cast<ApplyInst>(V)->getIterator()))
+            .createRetainValue(AI->getLoc(), V, Atomicity::Atomic);
       // Instructions producing a new opened archetype need a special handling,
       // because replacing these instructions may require a replacement
       // of the opened archetype type operands in some of the uses.
@@ -804,12 +844,118 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   return Changed;
 }
 
+/// The maximum number of instructions at the start of each successor which
+/// are compared by hoistCommonInstructions.
+static const unsigned HoistScanLimit = 32;
+
+/// Returns true if \p Inst, which is in a successor of \p To, can be moved
+/// to the end of \p To.
+bool CSE::canHoist(SILInstruction *Inst, SILBasicBlock *To,
+                   DominanceInfo *DT) {
+  // Instructions without operands, like literals, are cheap to
+  // rematerialize anywhere, and aggregates are better formed close to their
+  // uses. This is about projections, casts and metadata.
+  if (Inst->getNumOperands() == 0 || isa<StructInst>(Inst) ||
+      isa<TupleInst>(Inst) || isa<EnumInst>(Inst))
+    return false;
+
+  // Only move instructions which have no side effects at all, so that they
+  // can freely move across the other instructions of their block.
+  if (!canHandle(Inst) || Inst->mayHaveSideEffects() ||
+      Inst->mayReadOrWriteMemory() || isa<ApplyInst>(Inst) ||
+      isa<CondFailInst>(Inst) || isa<OpenExistentialRefInst>(Inst) ||
+      !Inst->getTypeDependentOperands().empty())
+    return false;
+
+  for (auto &Op : Inst->getAllOperands()) {
+    SILBasicBlock *DefBB = Op.get()->getParentBB();
+    if (!DefBB || !DT->dominates(DefBB, To))
+      return false;
+  }
+  return true;
+}
+
+bool CSE::hoistCommonInstructions(SILBasicBlock *BB, DominanceInfo *DT) {
+  auto Succs = BB->getSuccessors();
+  if (Succs.size() < 2)
+    return false;
+  for (auto &Succ : Succs)
+    if (Succ.getBB() == BB || !Succ.getBB()->getSinglePredecessor())
+      return false;
+
+  // The candidates from the first successor, and for each the number of
+  // other successors which compute it too.
+  llvm::DenseMap<SimpleValue, std::pair<SILInstruction *, unsigned>>
+    Candidates;
+  SmallVector<SILInstruction *, 8> CandidatesInOrder;
+  unsigned NumScanned = 0;
+  for (auto &Inst : *Succs[0].getBB()) {
+    if (++NumScanned > HoistScanLimit)
+      break;
+    if (canHoist(&Inst, BB, DT) &&
+        Candidates.insert({&Inst, {&Inst, 0}}).second)
+      CandidatesInOrder.push_back(&Inst);
+  }
+  if (Candidates.empty())
+    return false;
+
+  // The copies of the candidates in the other successors.
+  llvm::DenseMap<SILInstruction *, SmallVector<SILInstruction *, 2>> Copies;
+  for (unsigned i = 1, e = Succs.size(); i != e; ++i) {
+    NumScanned = 0;
+    for (auto &Inst : *Succs[i].getBB()) {
+      if (++NumScanned > HoistScanLimit)
+        break;
+      if (!canHoist(&Inst, BB, DT))
+        continue;
+      auto Found = Candidates.find(&Inst);
+      if (Found == Candidates.end() || Found->second.second != i - 1)
+        continue;
+      ++Found->second.second;
+      Copies[Found->second.first].push_back(&Inst);
+    }
+  }
+
+  // Hoist in the order of the first successor, so that the result is
+  // deterministic.
+  bool Changed = false;
+  for (SILInstruction *Inst : CandidatesInOrder) {
+    if (Candidates[Inst].second != Succs.size() - 1)
+      continue;
+    DEBUG(llvm::dbgs() << "SILCSE HOIST: " << *Inst << '\n');
+    Inst->moveBefore(BB->getTerminator());
+    for (SILInstruction *Copy : Copies[Inst]) {
+      Copy->replaceAllUsesWith(Inst);
+      Copy->eraseFromParent();
+    }
+    ++NumHoisted;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool CSE::hoistCommonInstructions(SILFunction &F, DominanceInfo *DT) {
+  bool Changed = false;
+  for (auto &BB : F) {
+    // Hoisting an instruction can make the instructions which use it
+    // hoistable, so repeat until nothing changes.
+    while (hoistCommonInstructions(&BB, DT))
+      Changed = true;
+  }
+  return Changed;
+}
+
 bool CSE::canHandle(SILInstruction *Inst) {
   if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
     if (!AI->mayReadOrWriteMemory())
       return true;
     
     if (RunsOnHighLevelSil) {
+      // Bridging the same value to Objective-C twice gives equivalent
+      // objects, so the first one can be reused.
+      if (isBridgeToObjectiveCCall(AI))
+        return true;
+
       ArraySemanticsCall SemCall(AI);
       switch (SemCall.getKind()) {
         case ArrayCallKind::kGetCount:
@@ -1134,6 +1280,12 @@ class SILCSE : public SILFunctionTransform {
     CSE C(RunsOnHighLevelSil, SEA);
     bool Changed = false;
 
+    // Hoist the instructions which are computed on all paths out of a block,
+    // so that the dominator tree walk finds their copies after the paths
+    // join. This doesn't change the CFG, so the dominator tree stays valid.
+    Changed |= C.hoistCommonInstructions(*getFunction(),
+                                         DA->get(getFunction()));
+
     // Perform the traditional CSE.
     Changed |= C.processFunction(*getFunction(), DA->get(getFunction()));
 
@@ -350,9 +350,16 @@ class DeadObjectAnalysis {
   // Are any uses behind a PointerToAddressInst?
   bool SeenPtrToAddr;
 
+  // The element count of an array object, if it is known.
+  SILValue ArrayCount;
+
+  // Read-only array semantics calls on the object, which are removed with it.
+  llvm::SmallVector<ApplyInst *, 4> ArrayReads;
+
 public:
-  explicit DeadObjectAnalysis(SILValue V):
-    NewAddrValue(V), AddressProjectionTrie(nullptr), SeenPtrToAddr(false) {}
+  explicit DeadObjectAnalysis(SILValue V, SILValue ArrayCount = SILValue()):
+    NewAddrValue(V), AddressProjectionTrie(nullptr), SeenPtrToAddr(false),
+    ArrayCount(ArrayCount) {}
 
   ~DeadObjectAnalysis() {
     delete AddressProjectionTrie;
@@ -364,6 +371,8 @@ public:
     return ArrayRef<SILInstruction*>(AllUsers.begin(), AllUsers.end());
   }
 
+  ArrayRef<ApplyInst *> getArrayReads() const { return ArrayReads; }
+
   template<typename Visitor>
   void visitStoreLocations(Visitor visitor) {
     visitStoreLocations(visitor, AddressProjectionTrie);
@@ -371,6 +380,7 @@ public:
 
 private:
   void addStore(StoreInst *Store, IndexTrieNode *AddressNode);
+  bool isRemovableArrayRead(Operand *Op);
   bool recursivelyCollectInteriorUses(ValueBase *DefInst,
                                       IndexTrieNode *AddressNode,
                                       bool IsInteriorAddress);
@@ -409,6 +419,28 @@ addStore(StoreInst *Store, IndexTrieNode *AddressNode) {
   StoredLocations[AddressNode].push_back(Store);
 }
 
+// Returns true if Op is the self operand of an array semantics call which
+// only reads the array, and whose result is either unused or is the count of
+// the array, which can be replaced by the known count.
+bool DeadObjectAnalysis::isRemovableArrayRead(Operand *Op) {
+  ArraySemanticsCall Call(Op->getUser());
+  if (!Call || !Call.hasSelf() || &Call.getSelfOperand() != Op)
+    return false;
+
+  ApplyInst *AI = Call;
+  switch (Call.getKind()) {
+  case ArrayCallKind::kGetCount:
+    if (ArrayCount && ArrayCount->getType() == AI->getType())
+      return true;
+    return onlyHaveDebugUses(AI);
+  case ArrayCallKind::kGetCapacity:
+  case ArrayCallKind::kArrayPropsIsNativeTypeChecked:
+    return onlyHaveDebugUses(AI);
+  default:
+    return false;
+  }
+}
+
 // Collect instructions that either initialize or release any values at the
 // object defined by defInst.
 //
@@ -490,6 +522,12 @@ recursivelyCollectInteriorUses(ValueBase *DefInst,
       }
       continue;
     }
+    // Reads of the array's count or properties, which die with the array.
+    if (!IsInteriorAddress && isRemovableArrayRead(Op)) {
+      ArrayReads.push_back(cast<ApplyInst>(User));
+      AllUsers.insert(User);
+      continue;
+    }
     // Otherwise bail.
     DEBUG(llvm::dbgs() << "        Found an escaping use: " << *User);
     return false;
@@ -564,6 +602,23 @@ static void insertReleases(ArrayRef<StoreInst*> Stores,
   }
 }
 
+// Replace the results of the read-only array semantics calls on a dead array.
+// Only calls of array.count can have non-debug uses at this point, which are
+// replaced by the count the array was allocated with.
+static void forwardArrayReads(ArrayRef<ApplyInst *> ArrayReads,
+                              SILValue ArrayCount) {
+  for (auto *Read : ArrayReads) {
+    deleteAllDebugUses(Read);
+    if (Read->use_empty())
+      continue;
+    assert(ArraySemanticsCall(Read).getKind() == ArrayCallKind::kGetCount &&
+           "Only uses of count can be forwarded");
+    DEBUG(llvm::dbgs() << "    Forwarding the array count to the users of "
+                       << *Read);
+    Read->replaceAllUsesWith(ArrayCount);
+  }
+}
+
 // Attempt to remove the array allocated at NewAddrValue and release its
 // refcounted elements.
 //
@@ -595,8 +650,11 @@ static bool removeAndReleaseArray(SILValue NewArrayValue, bool &CFGChanged) {
   assert(!ArrayDef->getType().isTrivial(ArrayDef->getModule()) &&
          "Array initialization should produce the proper tuple type.");
 
-  // Analyze the array object uses.
-  DeadObjectAnalysis DeadArray(ArrayDef);
+  // Analyze the array object uses. Calls to the array's count are forwarded
+  // the count of the allocation, like in ArrayCountPropagation.
+  SILValue ArrayCount =
+    ArraySemanticsCall(NewArrayValue).getInitializationCount();
+  DeadObjectAnalysis DeadArray(ArrayDef, ArrayCount);
   if (!DeadArray.analyze())
     return false;
 
@@ -609,6 +667,7 @@ static bool removeAndReleaseArray(SILValue NewArrayValue, bool &CFGChanged) {
 
   // Remove references to empty arrays.
   if (!StorageAddress) {
+    forwardArrayReads(DeadArray.getArrayReads(), ArrayCount);
     removeInstructions(DeadArray.getAllUsers());
     return true;
   }
@@ -641,6 +700,7 @@ static bool removeAndReleaseArray(SILValue NewArrayValue, bool &CFGChanged) {
     });
 
   // Delete all uses of the dead array and its storage address.
+  forwardArrayReads(DeadArray.getArrayReads(), ArrayCount);
   removeInstructions(DeadArray.getAllUsers());
   removeInstructions(DeadStorage.getAllUsers());
 
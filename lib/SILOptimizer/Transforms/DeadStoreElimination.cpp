@@ -159,7 +159,8 @@ namespace {
 /// # of BBs x(times) # of locations.
 ///
 /// we could run DSE on functions with 256 basic blocks and 256 locations,
-/// which is a large function.  
+/// which is a large function. Larger functions are only optimized within each
+/// basic block, which is linear in the size of the function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
 /// we could run optimistic DSE on functions with less than 64 basic blocks
@@ -262,9 +263,6 @@ public:
   void startTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
   void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
   bool isTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
-
-  /// Set the store bit for stack slot deallocated in this basic block. 
-  void initStoreSetAtEndOfBlock(DSEContext &Ctx);
 };
 
 } // end anonymous namespace
@@ -300,7 +298,8 @@ class DSEContext {
 enum class ProcessKind {
   ProcessOptimistic = 0,
   ProcessPessimistic = 1,
-  ProcessNone = 2,
+  ProcessBlockLocal = 2,
+  ProcessNone = 3,
 }; 
 
 private:
@@ -443,9 +442,15 @@ public:
   /// one iteration data flow on the function.
   ProcessKind getProcessFunctionKind(unsigned StoreCount);
 
+  /// Set the store bit for stack slots at the end of the basic blocks in
+  /// which they are deallocated.
+  void initStoreSetAtEndOfBlocks();
+
   /// Compute the kill set for the basic block. return true if the store set
-  /// changes.
-  void processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic);
+  /// changes. If \p BlockLocal is true, stores are not tracked across basic
+  /// blocks.
+  void processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic,
+                               bool BlockLocal);
 
   /// Compute the genset and killset for the current basic block.
   void processBasicBlockForGenKillSet(SILBasicBlock *BB);
@@ -536,9 +541,10 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
+  // Data flow may take too long to run. Only look for stores which are dead
+  // within their basic block.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
-    return ProcessKind::ProcessNone;
+    return ProcessKind::ProcessBlockLocal;
 
   // This function's data flow would converge in 1 iteration.
   if (RunOneIteration)
@@ -610,7 +616,8 @@ bool DSEContext::processBasicBlockWithGenKillSet(SILBasicBlock *BB) {
   return S->updateBBWriteSetIn(S->BBWriteSetMid);
 }
 
-void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
+void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic,
+                                         bool BlockLocal) {
   // If we know this is not a one iteration function which means its
   // its BBWriteSetIn and BBWriteSetOut have been computed and converged, 
   // and this basic block does not even have StoreInsts, there is no point
@@ -621,10 +628,16 @@ void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
 
   // Intersect in the successor WriteSetIns. A store is dead if it is not read
   // from any path to the end of the program. Thus an intersection.
-  mergeSuccessorLiveIns(BB);
+  //
+  // Without data flow, only the stack locations deallocated in this block are
+  // known to be dead at the end of it.
+  BlockState *S = getBlockState(BB);
+  if (BlockLocal)
+    S->BBWriteSetOut |= S->BBDeallocateLocation;
+  else
+    mergeSuccessorLiveIns(BB);
 
   // Initialize the BBWriteSetMid to BBWriteSetOut to get started.
-  BlockState *S = getBlockState(BB);
   S->BBWriteSetMid = S->BBWriteSetOut;
 
   // Process instructions in post-order fashion.
@@ -641,18 +654,16 @@ void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
   S->BBWriteSetIn = S->BBWriteSetMid;
 }
 
-void BlockState::initStoreSetAtEndOfBlock(DSEContext &Ctx) {
-  std::vector<LSLocation> &LocationVault = Ctx.getLocationVault();
+void DSEContext::initStoreSetAtEndOfBlocks() {
   // We set the store bit at the end of the basic block in which a stack
-  // allocated location is deallocated.
+  // allocated location is deallocated. Walk the locations once instead of once
+  // per basic block, which would be quadratic for large functions.
   for (unsigned i = 0; i < LocationVault.size(); ++i) {
     // Turn on the store bit at the block which the stack slot is deallocated.
     if (auto *ASI = dyn_cast<AllocStackInst>(LocationVault[i].getBase())) {
       for (auto X : findDeallocStackInst(ASI)) {
-        SILBasicBlock *DSIBB = X->getParent();
-        if (DSIBB != BB)
-          continue;
-        startTrackingLocation(BBDeallocateLocation, i);
+        BlockState *S = getBlockState(X->getParent());
+        S->startTrackingLocation(S->BBDeallocateLocation, i);
       }
     }
   }
@@ -1143,6 +1154,9 @@ bool DSEContext::run() {
   // Do we run a pessimistic data flow ?
   bool Optimistic = Kind == ProcessKind::ProcessOptimistic ? true : false;
 
+  // Or no data flow at all ?
+  bool BlockLocal = Kind == ProcessKind::ProcessBlockLocal;
+
   // For all basic blocks in the function, initialize a BB state.
   //
   // Initialize the BBToLocState mapping.
@@ -1150,8 +1164,8 @@ bool DSEContext::run() {
   for (auto &B : *F) {
     auto *State = new (BPA.Allocate()) BlockState(&B, LocationNum, Optimistic);
     BBToLocState[&B] = State;
-    State->initStoreSetAtEndOfBlock(*this);
   }
+  initStoreSetAtEndOfBlocks();
 
   // We perform dead store elimination in the following phases.
   //
@@ -1168,7 +1182,8 @@ bool DSEContext::run() {
   //
   // Phase 1 - 3 are only performed when we know the data flow will not
   // converge in a single iteration. Otherwise, we only run phase 4 and 5
-  // on the function.
+  // on the function. For very large functions phase 4 does not propagate
+  // stores across basic blocks.
 
   // We need to run the iterative data flow on the function.
   if (Optimistic) {
@@ -1180,7 +1195,7 @@ bool DSEContext::run() {
   // Is this a one iteration function.
   auto *PO = PM->getAnalysis<PostOrderAnalysis>()->get(F);
   for (SILBasicBlock *B : PO->getPostOrder()) {
-    processBasicBlockForDSE(B, Optimistic);
+    processBasicBlockForDSE(B, Optimistic, BlockLocal);
   }
 
   // Finally, delete the dead stores and create the live stores.
@@ -0,0 +1,477 @@
+//===--- ExistentialSpecializer.cpp - Specialize existential parameters ---===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Converts calls to functions which take protocol-typed (existential)
+// parameters into calls to a generic version of the callee, if the concrete
+// type of the existential argument is known at the call site.
+//
+// For example, for
+//
+//   func foo(_ p: P) { p.bar() }
+//   foo(S())
+//
+// a function
+//
+//   func foo_gen<T : P>(_ t: T) { let p: P = t; p.bar() }
+//
+// is created and the call is rewritten to foo_gen<S>(S()). The generic
+// specializer then specializes foo_gen for S, which in turn lets SILCombine
+// and the devirtualizer replace the witness_method calls on the existential
+// in the body with direct calls.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-existential-specializer"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/AST/ArchetypeBuilder.h"
+#include "swift/AST/GenericEnvironment.h"
+#include "swift/Basic/Demangle.h"
+#include "swift/SIL/Mangle.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/FunctionSignatureOptUtils.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumExistentialArgsSpecialized,
+          "Number of existential arguments converted to generic arguments");
+
+namespace {
+
+/// An existential argument of a call, which is initialized with a value of a
+/// known concrete type.
+struct ExistentialArg {
+  /// The argument index.
+  unsigned Index;
+
+  /// The alloc_stack of the existential which is passed to the callee.
+  AllocStackInst *Existential;
+
+  /// The init_existential_addr which initializes the existential.
+  InitExistentialAddrInst *Init;
+
+  /// The convention of the callee's parameter.
+  ParameterConvention Convention;
+};
+
+} // end anonymous namespace
+
+/// Returns true if a parameter of type \p Ty with convention \p Conv can be
+/// converted into a parameter of generic type.
+static bool isSpecializableExistentialParam(SILModule &M, SILType Ty,
+                                            ParameterConvention Conv) {
+  if (Conv != ParameterConvention::Indirect_In &&
+      Conv != ParameterConvention::Indirect_In_Guaranteed)
+    return false;
+
+  // Only handle opaque existentials of a single protocol. Class existentials
+  // are passed directly, and error existentials are boxed.
+  SmallVector<ProtocolDecl *, 2> Protocols;
+  if (!Ty.getSwiftRValueType()->isExistentialType(Protocols) ||
+      Protocols.size() != 1 || Protocols[0]->isObjC())
+    return false;
+  return Ty.getPreferredExistentialRepresentation(M) ==
+           ExistentialRepresentation::Opaque;
+}
+
+/// Returns true if the callee actually opens the existential argument \p Arg,
+/// e.g. to call a method on it. Otherwise there is no benefit in knowing the
+/// concrete type.
+static bool isOpenedInCallee(SILArgument *Arg) {
+  for (Operand *Use : Arg->getUses()) {
+    if (isa<OpenExistentialAddrInst>(Use->getUser()))
+      return true;
+  }
+  return false;
+}
+
+/// Returns the init_existential_addr which initializes the existential
+/// \p ASI, which is passed to \p AI as an argument.
+///
+/// The existential must not be written or read by anything else but the
+/// initialization and the call itself.
+static InitExistentialAddrInst *getConcreteInit(AllocStackInst *ASI,
+                                                ApplyInst *AI,
+                                                ParameterConvention Conv) {
+  InitExistentialAddrInst *Init = nullptr;
+  for (Operand *Use : ASI->getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (User == AI || isa<DeallocStackInst>(User) ||
+        isa<DebugValueAddrInst>(User))
+      continue;
+    // The caller still owns a guaranteed argument after the call.
+    if (isa<DestroyAddrInst>(User) &&
+        Conv == ParameterConvention::Indirect_In_Guaranteed)
+      continue;
+    if (auto *IE = dyn_cast<InitExistentialAddrInst>(User)) {
+      if (Init)
+        return nullptr;
+      Init = IE;
+      continue;
+    }
+    return nullptr;
+  }
+  if (!Init || Init->getParent() != AI->getParent())
+    return nullptr;
+
+  // We cannot derive generic arguments from an opened archetype.
+  if (Init->getFormalConcreteType()->hasArchetype())
+    return nullptr;
+
+  // The initialization must be done before the call.
+  for (auto It = SILBasicBlock::iterator(Init), End = AI->getParent()->end();
+       It != End; ++It) {
+    if (&*It == AI)
+      return Init;
+  }
+  return nullptr;
+}
+
+static std::string getSpecializedName(SILFunction *Callee,
+                                      ArrayRef<ExistentialArg> Args,
+                                      IsFragile_t Fragile) {
+  Mangle::Mangler M;
+  auto P = SpecializationPass::ExistentialSpecializer;
+  FunctionSignatureSpecializationMangler Mangler(P, M, Fragile, Callee);
+  for (const ExistentialArg &Arg : Args)
+    Mangler.setArgumentExistentialToGeneric(Arg.Index);
+  Mangler.mangle();
+  return M.finalize();
+}
+
+namespace {
+
+/// Clones the body of the original function into the generic function and
+/// re-creates the existential arguments from the generic arguments at the
+/// function entry.
+class ExistentialSpecializerCloner
+  : public SILClonerWithScopes<ExistentialSpecializerCloner> {
+  using SuperTy = SILClonerWithScopes<ExistentialSpecializerCloner>;
+  friend class SILVisitor<ExistentialSpecializerCloner>;
+  friend class SILCloner<ExistentialSpecializerCloner>;
+
+  SILFunction *OrigF;
+
+  /// The existentials which replace the original existential arguments.
+  SmallVector<AllocStackInst *, 4> LocalExistentials;
+
+  /// Local existentials which must be destroyed at the function exits,
+  /// because the argument is guaranteed.
+  SmallVector<AllocStackInst *, 4> GuaranteedExistentials;
+
+public:
+  ExistentialSpecializerCloner(SILFunction *OrigF, SILFunction *NewF)
+    : SuperTy(*NewF), OrigF(OrigF) {}
+
+  void cloneBlocks(ArrayRef<ExistentialArg> Args);
+
+private:
+  void createEntryArguments(SILBasicBlock *ClonedEntryBB,
+                            ArrayRef<ExistentialArg> Args);
+};
+
+} // end anonymous namespace
+
+void ExistentialSpecializerCloner::createEntryArguments(
+    SILBasicBlock *ClonedEntryBB, ArrayRef<ExistentialArg> Args) {
+  SILFunction &NewF = getBuilder().getFunction();
+  SILModule &M = NewF.getModule();
+  ArrayRef<SILParameterInfo> NewParams =
+      NewF.getLoweredFunctionType()->getParameters();
+  SILLocation Loc = NewF.getLocation();
+  unsigned NumIndirectResults =
+      NewF.getLoweredFunctionType()->getNumIndirectResults();
+
+  SILBasicBlock *OrigEntryBB = &*OrigF->begin();
+  for (SILArgument *Arg : OrigEntryBB->getBBArgs()) {
+    unsigned Idx = Arg->getIndex();
+    auto ExArg = std::find_if(Args.begin(), Args.end(),
+                              [&](const ExistentialArg &EA) {
+                                return EA.Index == Idx;
+                              });
+    if (ExArg == Args.end()) {
+      SILValue MappedValue = new (M) SILArgument(
+          ClonedEntryBB, remapType(Arg->getType()), Arg->getDecl());
+      ValueMap.insert(std::make_pair(Arg, MappedValue));
+      continue;
+    }
+
+    // The new argument is the address of a value of the generic type T.
+    CanType GenericTy = NewParams[Idx - NumIndirectResults].getType();
+    CanType ArchetypeTy = NewF.mapTypeIntoContext(GenericTy)
+                              ->getCanonicalType();
+    SILType ArgTy = SILType::getPrimitiveAddressType(ArchetypeTy);
+    SILArgument *NewArg =
+        new (M) SILArgument(ClonedEntryBB, ArgTy, Arg->getDecl());
+
+    // Wrap it into an existential, which replaces the original argument.
+    SILType ExistentialTy = Arg->getType().getObjectType();
+    SmallVector<ProtocolDecl *, 1> Protocols;
+    ExistentialTy.getSwiftRValueType()->isExistentialType(Protocols);
+    auto Conformances = M.getASTContext()
+                            .AllocateUninitialized<ProtocolConformanceRef>(1);
+    Conformances[0] = ProtocolConformanceRef(Protocols[0]);
+
+    auto *ASI = getBuilder().createAllocStack(Loc, ExistentialTy);
+    auto *IE = getBuilder().createInitExistentialAddr(Loc, ASI, ArchetypeTy,
+                                                      ArgTy.getObjectType(),
+                                                      Conformances);
+    bool IsGuaranteed =
+        ExArg->Convention == ParameterConvention::Indirect_In_Guaranteed;
+    getBuilder().createCopyAddr(Loc, NewArg, IE,
+                                IsGuaranteed ? IsNotTake : IsTake,
+                                IsInitialization);
+    LocalExistentials.push_back(ASI);
+    if (IsGuaranteed)
+      GuaranteedExistentials.push_back(ASI);
+    ValueMap.insert(std::make_pair(Arg, SILValue(ASI)));
+  }
+}
+
+void ExistentialSpecializerCloner::cloneBlocks(ArrayRef<ExistentialArg> Args) {
+  SILFunction &NewF = getBuilder().getFunction();
+  SILModule &M = NewF.getModule();
+
+  SILBasicBlock *OrigEntryBB = &*OrigF->begin();
+  SILBasicBlock *ClonedEntryBB = new (M) SILBasicBlock(&NewF);
+  BBMap.insert(std::make_pair(OrigEntryBB, ClonedEntryBB));
+  getBuilder().setInsertionPoint(ClonedEntryBB);
+  createEntryArguments(ClonedEntryBB, Args);
+
+  // Recursively visit original BBs in depth-first preorder, starting with the
+  // entry block, cloning all instructions other than terminators.
+  visitSILBasicBlock(OrigEntryBB);
+
+  // Now iterate over the BBs and fix up the terminators.
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    getBuilder().setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+
+  // Clean up the local existentials at the function exits.
+  SILLocation Loc = NewF.getLocation();
+  for (SILBasicBlock &BB : NewF) {
+    TermInst *Term = BB.getTerminator();
+    if (!isa<ReturnInst>(Term) && !isa<ThrowInst>(Term))
+      continue;
+    getBuilder().setInsertionPoint(Term);
+    for (AllocStackInst *ASI : GuaranteedExistentials)
+      getBuilder().createDestroyAddr(Loc, ASI);
+    for (AllocStackInst *ASI : reverse(LocalExistentials))
+      getBuilder().createDeallocStack(Loc, ASI);
+  }
+}
+
+/// Create the generic version of \p Callee, where the parameters \p Args are
+/// replaced by parameters of generic type.
+static SILFunction *createGenericFunction(SILFunction *Callee,
+                                          ArrayRef<ExistentialArg> Args,
+                                          StringRef Name,
+                                          IsFragile_t Fragile) {
+  SILModule &M = Callee->getModule();
+  ASTContext &Ctx = M.getASTContext();
+  CanSILFunctionType FTy = Callee->getLoweredFunctionType();
+
+  // Add a generic parameter for each existential argument, which conforms to
+  // the existential's protocol.
+  ArchetypeBuilder Builder(*M.getSwiftModule(), Ctx.Diags);
+  RequirementSource Source(RequirementSource::Explicit, SourceLoc());
+  SmallVector<GenericTypeParamType *, 4> GenericParams;
+  SmallVector<SILParameterInfo, 8> Params(FTy->getParameters().begin(),
+                                          FTy->getParameters().end());
+  unsigned NumIndirectResults = FTy->getNumIndirectResults();
+  bool ModifiesSelf = false;
+  for (const ExistentialArg &Arg : Args) {
+    auto *ParamTy = GenericTypeParamType::get(0, GenericParams.size(), Ctx);
+    GenericParams.push_back(ParamTy);
+    Builder.addGenericParameter(ParamTy);
+
+    SILParameterInfo &Param = Params[Arg.Index - NumIndirectResults];
+    SmallVector<ProtocolDecl *, 1> Protocols;
+    Param.getType()->isExistentialType(Protocols);
+    Builder.addRequirement(Requirement(RequirementKind::Conformance, ParamTy,
+                                       Protocols[0]->getDeclaredType()),
+                           Source);
+    Param = SILParameterInfo(ParamTy->getCanonicalType(),
+                             Param.getConvention());
+    if (Arg.Index + 1 == Callee->begin()->getNumBBArg() &&
+        FTy->hasSelfParam())
+      ModifiesSelf = true;
+  }
+  Builder.finalize(SourceLoc());
+  GenericSignature *Sig = Builder.getGenericSignature(GenericParams);
+  GenericEnvironment *Env = Builder.getGenericEnvironment(GenericParams);
+
+  // Don't use a method representation if we modified self.
+  auto ExtInfo = FTy->getExtInfo();
+  if (ModifiesSelf)
+    ExtInfo = ExtInfo.withRepresentation(SILFunctionTypeRepresentation::Thin);
+
+  auto NewFTy = SILFunctionType::get(Sig, ExtInfo, FTy->getCalleeConvention(),
+                                     Params, FTy->getAllResults(),
+                                     FTy->getOptionalErrorResult(), Ctx);
+
+  SILFunction *NewF = M.createFunction(
+      getSpecializedLinkage(Callee, Callee->getLinkage()), Name, NewFTy, Env,
+      Callee->getLocation(), Callee->isBare(), Callee->isTransparent(),
+      Fragile, IsNotThunk, Callee->getClassVisibility(),
+      Callee->getInlineStrategy(), Callee->getEffectsKind(),
+      /*InsertBefore*/ Callee, Callee->getDebugScope(),
+      Callee->getDeclContext());
+  NewF->setDeclCtx(Callee->getDeclContext());
+  for (auto &Attr : Callee->getSemanticsAttrs())
+    NewF->addSemanticsAttr(Attr);
+
+  DEBUG(llvm::dbgs() << "  create generic function " << Name << " : "
+                     << NewFTy << "\n");
+
+  ExistentialSpecializerCloner Cloner(Callee, NewF);
+  Cloner.cloneBlocks(Args);
+  return NewF;
+}
+
+/// Replace \p AI with a call of \p NewF, passing the concrete values instead
+/// of the existentials.
+static void rewriteApply(ApplyInst *AI, SILFunction *NewF,
+                         ArrayRef<ExistentialArg> Args) {
+  SILModule &M = AI->getModule();
+  SmallVector<SILValue, 8> NewArgs(AI->getArguments().begin(),
+                                   AI->getArguments().end());
+  SmallVector<Substitution, 4> Subs;
+  for (const ExistentialArg &Arg : Args) {
+    NewArgs[Arg.Index] = Arg.Init;
+    Subs.push_back(Substitution(Arg.Init->getFormalConcreteType(),
+                                Arg.Init->getConformances()));
+  }
+
+  SILBuilderWithScope Builder(AI);
+  SILLocation Loc = AI->getLoc();
+  auto *FRI = Builder.createFunctionRef(Loc, NewF);
+  CanSILFunctionType SubstTy = NewF->getLoweredFunctionType()
+      ->substGenericArgs(M, M.getSwiftModule(), Subs);
+  auto *NewAI = Builder.createApply(Loc, FRI,
+                                    SILType::getPrimitiveObjectType(SubstTy),
+                                    AI->getType(), Subs, NewArgs,
+                                    AI->isNonThrowing());
+
+  // The callee consumes the value, but not the existential container.
+  for (const ExistentialArg &Arg : Args) {
+    if (Arg.Convention == ParameterConvention::Indirect_In)
+      Builder.createDeinitExistentialAddr(Loc, Arg.Existential);
+  }
+
+  DEBUG(llvm::dbgs() << "  rewrite call " << *AI << "    to " << *NewAI);
+  AI->replaceAllUsesWith(NewAI);
+  recursivelyDeleteTriviallyDeadInstructions(AI, true);
+  NumExistentialArgsSpecialized += Args.size();
+}
+
+namespace {
+
+class ExistentialSpecializer : public SILFunctionTransform {
+
+  /// Returns the generic version of the callee of \p AI, creating it if
+  /// necessary, or null if the call cannot be specialized.
+  SILFunction *getGenericCallee(ApplyInst *AI,
+                                SmallVectorImpl<ExistentialArg> &Args);
+
+  /// The entry point to the transformation.
+  void run() override {
+    SILFunction *F = getFunction();
+    DEBUG(llvm::dbgs() << "***** ExistentialSpecializer on function: "
+                       << F->getName() << " *****\n");
+
+    if (F->isColdInProfile())
+      return;
+
+    bool Changed = false;
+    for (SILBasicBlock &BB : *F) {
+      for (auto It = BB.begin(), End = BB.end(); It != End;) {
+        auto *AI = dyn_cast<ApplyInst>(&*It);
+        ++It;
+        if (!AI)
+          continue;
+
+        SmallVector<ExistentialArg, 4> Args;
+        SILFunction *NewF = getGenericCallee(AI, Args);
+        if (!NewF)
+          continue;
+        rewriteApply(AI, NewF, Args);
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+  }
+
+  StringRef getName() override { return "Existential Specializer"; }
+};
+
+} // end anonymous namespace
+
+SILFunction *
+ExistentialSpecializer::getGenericCallee(ApplyInst *AI,
+                                         SmallVectorImpl<ExistentialArg> &Args) {
+  SILFunction *Callee = AI->getReferencedFunction();
+  if (!Callee || !Callee->shouldOptimize() || !canSpecializeFunction(Callee))
+    return nullptr;
+
+  // A fragile caller can only reference fragile functions.
+  SILFunction *Caller = AI->getFunction();
+  if (Caller->isFragile() && !Callee->isFragile())
+    return nullptr;
+
+  SILModule &M = Callee->getModule();
+  CanSILFunctionType FTy = Callee->getLoweredFunctionType();
+  unsigned NumIndirectResults = FTy->getNumIndirectResults();
+  ArrayRef<SILArgument *> CalleeArgs = Callee->begin()->getBBArgs();
+  for (unsigned Idx = NumIndirectResults, End = AI->getNumArguments();
+       Idx != End; ++Idx) {
+    SILParameterInfo Param = FTy->getParameters()[Idx - NumIndirectResults];
+    SILType ArgTy = CalleeArgs[Idx]->getType();
+    if (!isSpecializableExistentialParam(M, ArgTy, Param.getConvention()) ||
+        !isOpenedInCallee(CalleeArgs[Idx]))
+      continue;
+
+    auto *ASI = dyn_cast<AllocStackInst>(AI->getArgument(Idx));
+    if (!ASI)
+      continue;
+    InitExistentialAddrInst *Init =
+        getConcreteInit(ASI, AI, Param.getConvention());
+    if (!Init)
+      continue;
+    Args.push_back({Idx, ASI, Init, Param.getConvention()});
+  }
+  if (Args.empty())
+    return nullptr;
+
+  IsFragile_t Fragile = IsNotFragile;
+  if (Caller->isFragile() && Callee->isFragile())
+    Fragile = IsFragile;
+
+  std::string Name = getSpecializedName(Callee, Args, Fragile);
+  if (SILFunction *NewF = M.lookUpFunction(Name))
+    return NewF;
+
+  SILFunction *NewF = createGenericFunction(Callee, Args, Name, Fragile);
+  notifyPassManagerOfFunction(NewF, Callee);
+  return NewF;
+}
+
+SILTransform *swift::createExistentialSpecializer() {
+  return new ExistentialSpecializer();
+}
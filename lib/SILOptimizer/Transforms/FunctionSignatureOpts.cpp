@@ -32,6 +32,7 @@
 #define DEBUG_TYPE "sil-function-signature-opt"
 #include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/CallerAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Analysis/EpilogueARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -44,6 +45,7 @@
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILCloner.h"
 #include "swift/SIL/SILValue.h"
+#include "swift/SIL/SILVTable.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
@@ -54,6 +56,8 @@ STATISTIC(NumDeadArgsEliminated, "Total dead args eliminated");
 STATISTIC(NumOwnedConvertedToGuaranteed, "Total owned args -> guaranteed args");
 STATISTIC(NumOwnedConvertedToNotOwnedResult, "Total owned result -> not owned result");
 STATISTIC(NumSROAArguments, "Total SROA arguments optimized");
+STATISTIC(NumVTableMethodsOptimized,
+          "Total vtable methods optimized without direct callers");
 
 using SILParameterInfoList = llvm::SmallVector<SILParameterInfo, 8>;
 using ArgumentIndexMap = llvm::SmallDenseMap<int, int>;
@@ -96,6 +100,62 @@ static std::string getUniqueName(std::string Name, SILModule &M) {
   return getUniqueName(Name + "_unique_suffix", M);
 }
 
+/// Returns true if all subclasses of \p C are known in this module.
+static bool hasCompleteClassHierarchy(ClassDecl *C, SILModule &M) {
+  const DeclContext *DC = M.getAssociatedContext();
+  if (!DC || !C->isChildContextOf(DC) || !C->hasAccessibility())
+    return false;
+
+  switch (C->getEffectiveAccess()) {
+  case Accessibility::Open:
+    return false;
+  case Accessibility::Public:
+  case Accessibility::Internal:
+    return M.isWholeModule();
+  case Accessibility::FilePrivate:
+  case Accessibility::Private:
+    return true;
+  }
+}
+
+/// Returns true if \p F implements a vtable method which no subclass
+/// overrides.
+///
+/// Calls of such a method can be devirtualized to direct calls of \p F as
+/// soon as the class of the receiver is known to be a subclass of the class
+/// which implements it. This may only happen in functions which are
+/// optimized after \p F, e.g. when inlining reveals the class. The vtable
+/// keeps calling the thunk, which has the original signature.
+static bool isNonOverriddenVTableMethod(SILFunction *F,
+                                        ClassHierarchyAnalysis *CHA) {
+  SILModule &M = F->getModule();
+  bool FoundEntry = false;
+  for (auto &VTable : M.getVTableList()) {
+    ClassDecl *C = VTable.getClass();
+    for (auto &Entry : VTable.getEntries()) {
+      if (Entry.second != F)
+        continue;
+      if (!hasCompleteClassHierarchy(C, M))
+        return false;
+      FoundEntry = true;
+
+      if (!CHA->hasKnownDirectSubclasses(C))
+        continue;
+      ClassHierarchyAnalysis::ClassList Subs;
+      Subs.append(CHA->getDirectSubClasses(C).begin(),
+                  CHA->getDirectSubClasses(C).end());
+      Subs.append(CHA->getIndirectSubClasses(C).begin(),
+                  CHA->getIndirectSubClasses(C).end());
+      for (ClassDecl *Sub : Subs) {
+        SILVTable *SubVTable = M.lookUpVTable(Sub);
+        if (!SubVTable || SubVTable->getImplementation(M, Entry.first) != F)
+          return false;
+      }
+    }
+  }
+  return FoundEntry;
+}
+
 //===----------------------------------------------------------------------===//
 //                     Function Signature Transformation 
 //===----------------------------------------------------------------------===//
@@ -924,14 +984,25 @@ public:
     FunctionSignatureTransform FST(F, RCIA, EA, FM, AIM,
                                    ArgumentDescList, ResultDescList);
 
+    // Class methods which are only called through the vtable so far may still
+    // get direct callers by devirtualization.
+    bool MayGetCallers = false;
+    if (!OptForPartialApply && !FuncInfo.hasCaller() &&
+        F->getRepresentation() == SILFunctionTypeRepresentation::Method) {
+      auto *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
+      MayGetCallers = isNonOverriddenVTableMethod(F, CHA);
+    }
+
     bool Changed = false;
     if (OptForPartialApply) {
       Changed = FST.removeDeadArgs(FuncInfo.getMinPartialAppliedArgs());
     } else {
-      Changed = FST.run(FuncInfo.hasCaller());
+      Changed = FST.run(FuncInfo.hasCaller() || MayGetCallers);
     }
     if (Changed) {
       ++ NumFunctionSignaturesOptimized;
+      if (MayGetCallers)
+        ++NumVTableMethodsOptimized;
       // The old function must be a thunk now.
       assert(F->isThunk() && "Old function should have been turned into a thunk");
 
@@ -38,6 +38,11 @@ class GenericSpecializer : public SILFunctionTransform {
     DEBUG(llvm::dbgs() << "***** GenericSpecializer on function:" << F.getName()
                        << " *****\n");
 
+    // Specializing calls which the profile shows are never executed would
+    // only increase the code size.
+    if (F.isColdInProfile())
+      return;
+
     if (specializeAppliesInFunction(F))
       invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
   }
@@ -108,6 +113,8 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
       // (as opposed to returning a previous specialization), we need to notify
       // the pass manager so that the new functions get optimized.
       for (SILFunction *NewF : reverse(NewFunctions)) {
+        // The specialization is called at most as often as the original.
+        NewF->setEntryCount(Callee->getEntryCount());
         notifyPassManagerOfFunction(NewF, Callee);
       }
     }
@@ -0,0 +1,127 @@
+//===--- GuaranteedARCOpts.cpp - Remove local retain/release pairs --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Removes a retain and a later release of the same value in one block if the
+// pair is not needed to keep the value alive. SILGen emits such pairs around
+// uses of values it holds at +0, e.g. of guaranteed arguments:
+//
+//   bb0(%0 : $C):    // @guaranteed
+//     strong_retain %0 : $C
+//     %2 = apply %1(%0) : $@convention(thin) (@guaranteed C) -> ()
+//     strong_release %0 : $C
+//
+// A pair is removed if
+//
+// * the value is a @guaranteed argument of the function, which the caller
+//   keeps alive for the whole call, and no instruction between the two
+//   checks its reference count, or
+// * no instruction between the two can release anything or read a reference
+//   count, so nothing can free the object in between.
+//
+// The pass only does a linear scan of each block without any alias or side
+// effect analysis, so it is cheap enough to run in debug builds. It doesn't
+// touch debug_value instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "guaranteed-arc-opts"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILInstruction.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumPairsRemoved, "Number of retain/release pairs removed");
+
+using namespace swift;
+
+/// Returns true if \p V is kept alive by the caller for the whole function.
+static bool isGuaranteedFunctionArg(SILValue V) {
+  auto *Arg = dyn_cast<SILArgument>(V);
+  return Arg && Arg->isFunctionArg() &&
+         Arg->hasConvention(SILArgumentConvention::Direct_Guaranteed);
+}
+
+/// Remove the retain/release pairs in \p BB. Returns true if anything was
+/// removed.
+static bool removeLocalRetainReleasePairs(SILBasicBlock &BB) {
+  bool Changed = false;
+
+  // The retains which can still be paired with a release, by their operand.
+  llvm::SmallDenseMap<SILValue, SILInstruction *, 8> OpenRetains;
+
+  for (auto It = BB.begin(), End = BB.end(); It != End;) {
+    SILInstruction *I = &*It;
+    ++It;
+
+    if (isRetainInstruction(I)) {
+      OpenRetains[I->getOperand(0)] = I;
+      continue;
+    }
+
+    if (isReleaseInstruction(I)) {
+      auto Found = OpenRetains.find(I->getOperand(0));
+      if (Found != OpenRetains.end()) {
+        DEBUG(llvm::dbgs() << "  remove pair:" << *Found->second << *I);
+        Found->second->eraseFromParent();
+        I->eraseFromParent();
+        OpenRetains.erase(Found);
+        ++NumPairsRemoved;
+        Changed = true;
+        continue;
+      }
+    }
+
+    if (!I->mayReleaseOrReadRefCount())
+      continue;
+
+    // The release of another value may free the last other reference to one
+    // of the retained values, unless the caller holds that reference.
+    bool ChecksRefCount = mayCheckRefCount(I);
+    for (auto Retain = OpenRetains.begin(), E = OpenRetains.end();
+         Retain != E;) {
+      auto Current = Retain++;
+      if (ChecksRefCount || !isGuaranteedFunctionArg(Current->first))
+        OpenRetains.erase(Current);
+    }
+  }
+  return Changed;
+}
+
+//===----------------------------------------------------------------------===//
+//                              Top Level Driver
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class GuaranteedARCOpts : public SILFunctionTransform {
+
+  void run() override {
+    bool Changed = false;
+    for (auto &BB : *getFunction())
+      Changed |= removeLocalRetainReleasePairs(BB);
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "Guaranteed ARC Opts"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createGuaranteedARCOpts() {
+  return new GuaranteedARCOpts();
+}
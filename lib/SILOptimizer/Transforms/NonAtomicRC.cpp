@@ -0,0 +1,104 @@
+//===--- NonAtomicRC.cpp - Use non-atomic RC for thread-local objects -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Marks strong_retain and strong_release instructions as non-atomic if the
+// object they operate on does not escape the function.
+//
+// An object which never escapes its function cannot be reached by any other
+// thread: starting a thread or handing a value to one always goes through a
+// call or a store which lets the value escape. So all reference counting
+// operations on such an object are executed by the thread which allocated it
+// and don't need atomic read-modify-write instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nonatomic-rc"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SIL/SILInstruction.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumNonAtomicRC, "Number of reference counting instructions made "
+                          "non-atomic");
+
+using namespace swift;
+
+/// Returns true if the reference counted operand of \p RCI refers to an
+/// object which does not escape the function of \p ConGraph.
+static bool isThreadLocal(RefCountingInst *RCI,
+                          EscapeAnalysis::ConnectionGraph *ConGraph,
+                          EscapeAnalysis *EA) {
+  // Values which are not tracked by escape analysis (e.g. because they are
+  // not pointers) are treated as escaping.
+  auto *Node = ConGraph->getNodeOrNull(RCI->getOperand(0), EA);
+  if (!Node)
+    return false;
+
+  // Function arguments and values loaded from memory are at least escaping
+  // via the arguments, so this is only true for objects which are allocated
+  // in the function.
+  return !Node->escapes();
+}
+
+//===----------------------------------------------------------------------===//
+//                              Top Level Driver
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class NonAtomicRC : public SILFunctionTransform {
+
+public:
+  NonAtomicRC() {}
+
+private:
+  /// The entry point to the transformation.
+  void run() override {
+    DEBUG(llvm::dbgs() << "** NonAtomicRC **\n");
+
+    auto *EA = PM->getAnalysis<EscapeAnalysis>();
+
+    SILFunction *F = getFunction();
+    auto *ConGraph = EA->getConnectionGraph(F);
+    if (!ConGraph)
+      return;
+
+    bool Changed = false;
+    for (SILBasicBlock &BB : *F) {
+      for (SILInstruction &I : BB) {
+        if (!isa<StrongRetainInst>(&I) && !isa<StrongReleaseInst>(&I))
+          continue;
+        auto *RCI = cast<RefCountingInst>(&I);
+        if (RCI->isNonAtomic() || !isThreadLocal(RCI, ConGraph, EA))
+          continue;
+
+        DEBUG(llvm::dbgs() << "  make non-atomic: " << *RCI);
+        RCI->setNonAtomic();
+        ++NumNonAtomicRC;
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "NonAtomicRC"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createNonAtomicRC() {
+  return new NonAtomicRC();
+}
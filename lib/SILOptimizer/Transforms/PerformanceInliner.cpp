@@ -1018,6 +1018,10 @@ class SILPerformanceInliner {
     /// increasing the code size.
     TrivialFunctionThreshold = 18,
 
+    /// At -Osize, the benefit of inlining a function which is not trivial is
+    /// divided by this value.
+    OptimizeForSizeBenefitDivisor = 4,
+
     /// Configuration for the caller block limit.
     BlockLimitDenominator = 10000,
 
@@ -1178,6 +1182,11 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   if (Callee->getInlineStrategy() == AlwaysInline)
     return true;
 
+  // If the profile shows that the call is never executed, treat it like a
+  // call in a cold block: inlining it would only increase the code size.
+  if (AI.getFunction()->isColdInProfile() || Callee->isColdInProfile())
+    return isProfitableInColdBlock(AI, Callee);
+
   SILLoopInfo *LI = LA->get(Callee);
   ShortestPathAnalysis *SPA = getSPA(Callee, LI);
   assert(SPA->isValid());
@@ -1270,6 +1279,12 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     return true;
   }
 
+  // At -Osize, inlining a function which is not trivial must remove much more
+  // than the overhead of the call, because it increases the code size.
+  if (Opts.Optimization == SILOptions::SILOptMode::OptimizeForSize &&
+      CalleeCost > TrivialFunctionThreshold)
+    Benefit /= OptimizeForSizeBenefitDivisor;
+
   // We reduce the benefit if the caller is too large. For this we use a
   // cubic function on the number of caller blocks. This starts to prevent
   // inlining at about 800 - 1000 caller blocks.
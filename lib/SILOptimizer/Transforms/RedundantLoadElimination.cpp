@@ -175,7 +175,8 @@ namespace {
 /// # of BBs x(times) # of locations.
 ///
 /// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
+/// which is a large function. Larger functions are only optimized within each
+/// basic block, which is linear in the size of the function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
 
 /// we could run optimistic RLE on functions with less than 64 basic blocks
@@ -418,7 +419,8 @@ class RLEContext {
   enum class ProcessKind {
     ProcessMultipleIterations = 0,
     ProcessOneIteration = 1,
-    ProcessNone = 2,
+    ProcessBlockLocal = 2,
+    ProcessNone = 3,
   }; 
 private:
   /// Function currently processing.
@@ -509,6 +511,10 @@ public:
   /// Process basic blocks to perform the redundant load elimination.
   void processBasicBlocksForRLE(bool Optimistic);
 
+  /// Process basic blocks to perform the redundant load elimination, only
+  /// forwarding values within each basic block.
+  void processBasicBlocksForBlockLocalRLE();
+
   /// Returns the alias analysis we will use during all computations.
   AliasAnalysis *getAA() const { return AA; }
 
@@ -1105,9 +1111,10 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
+  // Data flow may take too long to run. Only forward values within each
+  // basic block.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
-    return ProcessKind::ProcessNone;
+    return ProcessKind::ProcessBlockLocal;
 
   // This function's data flow would converge in 1 iteration.
   if (RunOneIteration)
@@ -1416,6 +1423,16 @@ void RLEContext::processBasicBlocksForRLE(bool Optimistic) {
   }
 }
 
+void RLEContext::processBasicBlocksForBlockLocalRLE() {
+  for (SILBasicBlock *BB : PO->getReversePostOrder()) {
+    // Nothing is merged in from the predecessors, i.e. no location has an
+    // available value at the beginning of the basic block. So all forwarded
+    // values are concrete values of the current basic block.
+    BlockState &Forwarder = getBlockState(BB);
+    Forwarder.processBasicBlockWithKind(*this, RLEKind::PerformRLE);
+  }
+}
+
 void RLEContext::runIterativeRLE() {
   // Generate the genset and killset for every basic block.
   processBasicBlocksForGenKillSet();
@@ -1483,7 +1500,10 @@ bool RLEContext::run() {
 
   // We have the available value bit computed and the local forwarding value.
   // Set up the load forwarding.
-  processBasicBlocksForRLE(Optimistic);
+  if (Kind == ProcessKind::ProcessBlockLocal)
+    processBasicBlocksForBlockLocalRLE();
+  else
+    processBasicBlocksForRLE(Optimistic);
 
   // Finally, perform the redundant load replacements.
   llvm::DenseSet<SILInstruction *> InstsToDelete;
@@ -310,6 +310,45 @@ static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
   return true;
 }
 
+/// Orders \p Subs by the profiled entry counts of their implementations of
+/// the method called by \p CMI, most frequently executed first, and removes
+/// the subclasses whose implementation the profile shows never ran.
+///
+/// The entry count of an implementation includes calls from all call sites,
+/// but it is still a good estimate of which targets are hot. Without profile
+/// data the order is not changed.
+///
+/// Returns the number of removed subclasses.
+static int orderSubclassesByProfile(SILModule &M, ClassMethodInst *CMI,
+                                    SmallVectorImpl<ClassDecl *> &Subs) {
+  auto getEntryCount = [&](ClassDecl *S) -> Optional<uint64_t> {
+    if (SILFunction *F = M.lookUpFunctionInVTable(S, CMI->getMember()))
+      return F->getEntryCount();
+    return None;
+  };
+
+  if (std::none_of(Subs.begin(), Subs.end(), [&](ClassDecl *S) {
+        return getEntryCount(S).hasValue();
+      }))
+    return 0;
+
+  // Subclasses which are never used are handled by the default case.
+  auto RemovedIt = std::remove_if(Subs.begin(), Subs.end(),
+                                  [&](ClassDecl *S) {
+                                    auto Count = getEntryCount(S);
+                                    return Count && *Count == 0;
+                                  });
+  int NumRemoved = Subs.end() - RemovedIt;
+  Subs.erase(RemovedIt, Subs.end());
+
+  std::stable_sort(Subs.begin(), Subs.end(),
+                   [&](ClassDecl *A, ClassDecl *B) {
+                     return getEntryCount(A).getValueOr(0) >
+                            getEntryCount(B).getValueOr(0);
+                   });
+  return NumRemoved;
+}
+
 /// \brief Try to speculate the call target for the call \p AI. This function
 /// returns true if a change was made.
 static bool tryToSpeculateTarget(FullApplySite AI,
@@ -397,6 +436,11 @@ static bool tryToSpeculateTarget(FullApplySite AI,
 
   // Number of subclasses which cannot be handled by checked_cast_br checks.
   int NotHandledSubsNum = 0;
+
+  // Test the hottest targets first, so that they are the ones which are kept
+  // if there are too many subclasses.
+  NotHandledSubsNum += orderSubclassesByProfile(M, CMI, Subs);
+
   if (Subs.size() > MaxNumSpeculativeTargets) {
     DEBUG(llvm::dbgs() << "Class " << CD->getName() << " has too many ("
                        << Subs.size() << ") subclasses. Performing speculative "
@@ -461,8 +505,8 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   // in the future, if we start using PGO for ordering of checked_cast_br
   // checks.
 
-  // TODO: The ordering of checks may benefit from using a PGO, because
-  // the most probable alternatives could be checked first.
+  // If there is profile data, the most probable alternatives are checked
+  // first, see orderSubclassesByProfile().
 
   for (auto S : Subs) {
     DEBUG(llvm::dbgs() << "Inserting a speculative call for class "
@@ -536,6 +580,11 @@ namespace {
     virtual ~SpeculativeDevirtualization() {}
 
     void run() override {
+      // Speculative calls only increase the code size of functions which the
+      // profile shows are never executed.
+      if (getFunction()->isColdInProfile())
+        return;
+
       ClassHierarchyAnalysis *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
 
       bool Changed = false;
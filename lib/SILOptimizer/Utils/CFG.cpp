@@ -167,8 +167,8 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
     return DefaultBB;
 }
 
-void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void changeBranchTargetImpl(TermInst *T, unsigned EdgeIdx,
+                                   SILBasicBlock *NewDest, bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getTermKind()) {
@@ -299,6 +299,19 @@ void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
+                               SILBasicBlock *NewDest, bool PreserveArgs,
+                               DominanceInfo *DT) {
+  SILBasicBlock *From = T->getParent();
+  SILBasicBlock *OldDest = T->getSuccessors()[EdgeIdx];
+  changeBranchTargetImpl(T, EdgeIdx, NewDest, PreserveArgs);
+
+  if (DT) {
+    DT->insertEdge(From, NewDest);
+    DT->deleteEdge(From, OldDest);
+  }
+}
+
 
 template <class SwitchEnumTy, class SwitchEnumCaseTy>
 SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
@@ -321,8 +334,9 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
 /// \param OldDest The successor block that will be replaced.
 /// \param NewDest The new target block.
 /// \param PreserveArgs If set, preserve arguments on the replaced edge.
-void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void replaceBranchTargetImpl(TermInst *T, SILBasicBlock *OldDest,
+                                    SILBasicBlock *NewDest,
+                                    bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getTermKind()) {
@@ -440,6 +454,18 @@ void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
+                                SILBasicBlock *NewDest, bool PreserveArgs,
+                                DominanceInfo *DT) {
+  SILBasicBlock *From = T->getParent();
+  replaceBranchTargetImpl(T, OldDest, NewDest, PreserveArgs);
+
+  if (DT) {
+    DT->insertEdge(From, NewDest);
+    DT->deleteEdge(From, OldDest);
+  }
+}
+
 /// \brief Check if the edge from the terminator is critical.
 bool swift::isCriticalEdge(TermInst *T, unsigned EdgeIdx) {
   assert(T->getSuccessors().size() > EdgeIdx && "Not enough successors");
@@ -587,7 +613,7 @@ SILBasicBlock *swift::splitEdge(TermInst *T, unsigned EdgeIdx,
   SILBuilder(EdgeBB).createBranch(T->getLoc(), DestBB, Args);
 
   // Strip the arguments and rewire the branch in the source block.
-  changeBranchTarget(T, EdgeIdx, EdgeBB, /*PreserveArgs=*/false);
+  changeBranchTargetImpl(T, EdgeIdx, EdgeBB, /*PreserveArgs=*/false);
 
   if (!DT && !LI)
     return EdgeBB;
@@ -0,0 +1,572 @@
+//===--- ConstantEvaluation.cpp - Evaluate calls at compile time ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "constant-evaluation"
+#include "swift/SILOptimizer/Utils/ConstantEvaluation.h"
+#include "swift/AST/Builtins.h"
+#include "swift/Basic/Fallthrough.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Utils/ConstantFolding.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Debug.h"
+#include <vector>
+
+using namespace swift;
+
+/// The maximum nesting of calls the evaluator follows.
+static const unsigned MaxCallDepth = 16;
+
+namespace {
+
+/// The value of a SIL value computed by the evaluator.
+struct ConstValue {
+  enum class Kind { Integer, Aggregate, Function, Metatype };
+
+  Kind TheKind;
+
+  /// The value of an integer.
+  APInt IntValue;
+
+  /// The elements of a struct or tuple.
+  std::vector<ConstValue> Elements;
+
+  /// The function of a function_ref.
+  SILFunction *Function = nullptr;
+
+  ConstValue() : TheKind(Kind::Metatype) {}
+
+  static ConstValue getInteger(APInt Value) {
+    ConstValue Result;
+    Result.TheKind = Kind::Integer;
+    Result.IntValue = std::move(Value);
+    return Result;
+  }
+
+  static ConstValue getAggregate(std::vector<ConstValue> Elements) {
+    ConstValue Result;
+    Result.TheKind = Kind::Aggregate;
+    Result.Elements = std::move(Elements);
+    return Result;
+  }
+
+  static ConstValue getFunction(SILFunction *F) {
+    ConstValue Result;
+    Result.TheKind = Kind::Function;
+    Result.Function = F;
+    return Result;
+  }
+
+  static ConstValue getMetatype() { return ConstValue(); }
+
+  bool isInteger() const { return TheKind == Kind::Integer; }
+  bool isAggregate() const { return TheKind == Kind::Aggregate; }
+};
+
+} // end anonymous namespace
+
+static bool isThinMetatype(SILType Ty) {
+  auto MetaTy = Ty.getAs<MetatypeType>();
+  return MetaTy && MetaTy->hasRepresentation() &&
+         MetaTy->getRepresentation() == MetatypeRepresentation::Thin;
+}
+
+/// Returns true if the body of \p F may be interpreted. Functions which are
+/// not to be inlined or optimized are treated as opaque, as callers rely on
+/// them not being looked through.
+static bool isEvaluableFunction(SILFunction *F) {
+  return !F->isExternalDeclaration() &&
+         F->getInlineStrategy() != NoInline &&
+         !F->hasSemanticsAttr("optimize.sil.never");
+}
+
+/// Returns true if the function type can be called by the evaluator: all of
+/// its arguments and results are passed directly.
+static bool isEvaluableFunctionType(CanSILFunctionType FnTy) {
+  if (FnTy->isPolymorphic() || FnTy->hasIndirectResults() ||
+      FnTy->hasErrorResult())
+    return false;
+  for (auto &Param : FnTy->getParameters())
+    if (Param.isIndirect())
+      return false;
+  return true;
+}
+
+/// Computes the value of an argument of the evaluated call in the caller.
+static bool getConstantArgument(SILValue V, ConstValue &Result) {
+  if (auto *ILI = dyn_cast<IntegerLiteralInst>(V)) {
+    Result = ConstValue::getInteger(ILI->getValue());
+    return true;
+  }
+
+  if (auto *MI = dyn_cast<MetatypeInst>(V)) {
+    if (!isThinMetatype(MI->getType()))
+      return false;
+    Result = ConstValue::getMetatype();
+    return true;
+  }
+
+  if (isa<StructInst>(V) || isa<TupleInst>(V)) {
+    auto *I = cast<SILInstruction>(V);
+    std::vector<ConstValue> Elements(I->getNumOperands());
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+      if (!getConstantArgument(I->getOperand(i), Elements[i]))
+        return false;
+    Result = ConstValue::getAggregate(std::move(Elements));
+    return true;
+  }
+
+  return false;
+}
+
+namespace {
+
+/// Interprets the bodies of functions with constant arguments.
+class ConstantEvaluator {
+  using ValueMap = llvm::DenseMap<ValueBase *, ConstValue>;
+
+  /// The number of instructions which may still be evaluated.
+  unsigned StepsLeft;
+
+  /// The number of calls being evaluated.
+  unsigned Depth = 0;
+
+public:
+  ConstantEvaluator(unsigned StepLimit) : StepsLeft(StepLimit) {}
+
+  /// Evaluates a call of \p F with the arguments \p Args.
+  bool evaluateCall(SILFunction *F, ArrayRef<ConstValue> Args,
+                    ConstValue &Result);
+
+private:
+  bool evaluateBody(SILFunction *F, ArrayRef<ConstValue> Args,
+                    ConstValue &Result);
+  bool evaluateInstruction(SILInstruction *I, ValueMap &Values);
+  bool evaluateBuiltin(BuiltinInst *BI, ArrayRef<ConstValue> Args,
+                       ConstValue &Result);
+  bool bindArguments(SILBasicBlock *BB, OperandValueArrayRef Args,
+                     ValueMap &Values);
+};
+
+} // end anonymous namespace
+
+static const ConstValue *lookup(llvm::DenseMap<ValueBase *, ConstValue> &Values,
+                                SILValue V) {
+  auto It = Values.find(V);
+  if (It == Values.end())
+    return nullptr;
+  return &It->second;
+}
+
+bool ConstantEvaluator::evaluateCall(SILFunction *F, ArrayRef<ConstValue> Args,
+                                     ConstValue &Result) {
+  if (!isEvaluableFunction(F) || Depth >= MaxCallDepth ||
+      !isEvaluableFunctionType(F->getLoweredFunctionType()))
+    return false;
+
+  ++Depth;
+  bool Success = evaluateBody(F, Args, Result);
+  --Depth;
+  return Success;
+}
+
+bool ConstantEvaluator::evaluateBody(SILFunction *F, ArrayRef<ConstValue> Args,
+                                     ConstValue &Result) {
+  ValueMap Values;
+  SILBasicBlock *BB = &*F->begin();
+  auto EntryArgs = BB->getBBArgs();
+  if (EntryArgs.size() != Args.size())
+    return false;
+  for (unsigned i = 0, e = Args.size(); i != e; ++i)
+    Values[EntryArgs[i]] = Args[i];
+
+  while (true) {
+    for (auto &I : *BB) {
+      if (StepsLeft == 0) {
+        DEBUG(llvm::dbgs() << "  step limit reached in " << F->getName()
+                           << "\n");
+        return false;
+      }
+      --StepsLeft;
+
+      if (isa<TermInst>(&I))
+        break;
+      if (!evaluateInstruction(&I, Values)) {
+        DEBUG(llvm::dbgs() << "  cannot evaluate " << I);
+        return false;
+      }
+    }
+
+    auto *TI = BB->getTerminator();
+    if (auto *RI = dyn_cast<ReturnInst>(TI)) {
+      auto *V = lookup(Values, RI->getOperand());
+      if (!V)
+        return false;
+      Result = *V;
+      return true;
+    }
+
+    if (auto *BI = dyn_cast<BranchInst>(TI)) {
+      BB = BI->getDestBB();
+      if (!bindArguments(BB, BI->getArgs(), Values))
+        return false;
+      continue;
+    }
+
+    if (auto *CBI = dyn_cast<CondBranchInst>(TI)) {
+      auto *Cond = lookup(Values, CBI->getCondition());
+      if (!Cond || !Cond->isInteger())
+        return false;
+      bool Taken = Cond->IntValue.getBoolValue();
+      BB = Taken ? CBI->getTrueBB() : CBI->getFalseBB();
+      if (!bindArguments(BB, Taken ? CBI->getTrueArgs() : CBI->getFalseArgs(),
+                         Values))
+        return false;
+      continue;
+    }
+
+    DEBUG(llvm::dbgs() << "  cannot evaluate " << *TI);
+    return false;
+  }
+}
+
+bool ConstantEvaluator::bindArguments(SILBasicBlock *BB,
+                                      OperandValueArrayRef Args,
+                                      ValueMap &Values) {
+  // Read all of the incoming values before binding any of them, because
+  // the branch of a loop may pass the block's own arguments.
+  SmallVector<ConstValue, 4> Incoming;
+  for (SILValue Arg : Args) {
+    auto *V = lookup(Values, Arg);
+    if (!V)
+      return false;
+    Incoming.push_back(*V);
+  }
+
+  auto BBArgs = BB->getBBArgs();
+  if (BBArgs.size() != Incoming.size())
+    return false;
+  for (unsigned i = 0, e = BBArgs.size(); i != e; ++i)
+    Values[BBArgs[i]] = std::move(Incoming[i]);
+  return true;
+}
+
+bool ConstantEvaluator::evaluateInstruction(SILInstruction *I,
+                                            ValueMap &Values) {
+  if (isa<DebugValueInst>(I))
+    return true;
+
+  if (auto *ILI = dyn_cast<IntegerLiteralInst>(I)) {
+    Values[ILI] = ConstValue::getInteger(ILI->getValue());
+    return true;
+  }
+
+  if (auto *FRI = dyn_cast<FunctionRefInst>(I)) {
+    Values[FRI] = ConstValue::getFunction(FRI->getReferencedFunction());
+    return true;
+  }
+
+  if (auto *MI = dyn_cast<MetatypeInst>(I)) {
+    if (!isThinMetatype(MI->getType()))
+      return false;
+    Values[MI] = ConstValue::getMetatype();
+    return true;
+  }
+
+  // Collect the values of the operands. Each of the remaining instructions
+  // only has value operands.
+  SmallVector<ConstValue, 4> Operands;
+  for (auto &Op : I->getAllOperands()) {
+    auto *V = lookup(Values, Op.get());
+    if (!V)
+      return false;
+    Operands.push_back(*V);
+  }
+
+  if (isa<StructInst>(I) || isa<TupleInst>(I)) {
+    Values[I] = ConstValue::getAggregate(
+        std::vector<ConstValue>(Operands.begin(), Operands.end()));
+    return true;
+  }
+
+  if (isa<StructExtractInst>(I) || isa<TupleExtractInst>(I)) {
+    unsigned FieldNo = isa<StructExtractInst>(I)
+                           ? cast<StructExtractInst>(I)->getFieldNo()
+                           : cast<TupleExtractInst>(I)->getFieldNo();
+    auto &Aggregate = Operands[0];
+    if (!Aggregate.isAggregate() || FieldNo >= Aggregate.Elements.size())
+      return false;
+    Values[I] = Aggregate.Elements[FieldNo];
+    return true;
+  }
+
+  if (isa<CondFailInst>(I)) {
+    // A failing check traps at runtime, which must stay.
+    return Operands[0].isInteger() && !Operands[0].IntValue.getBoolValue();
+  }
+
+  if (auto *BI = dyn_cast<BuiltinInst>(I)) {
+    ConstValue Result;
+    if (!evaluateBuiltin(BI, Operands, Result))
+      return false;
+    Values[BI] = std::move(Result);
+    return true;
+  }
+
+  if (auto *AI = dyn_cast<ApplyInst>(I)) {
+    auto &Callee = Operands[0];
+    if (Callee.TheKind != ConstValue::Kind::Function || AI->hasSubstitutions())
+      return false;
+    ConstValue Result;
+    if (!evaluateCall(Callee.Function, makeArrayRef(Operands).slice(1),
+                      Result))
+      return false;
+    Values[AI] = std::move(Result);
+    return true;
+  }
+
+  return false;
+}
+
+bool ConstantEvaluator::evaluateBuiltin(BuiltinInst *BI,
+                                        ArrayRef<ConstValue> Args,
+                                        ConstValue &Result) {
+  for (auto &Arg : Args)
+    if (!Arg.isInteger())
+      return false;
+
+  auto getOverflowResult = [&](APInt Value, bool Overflow) {
+    std::vector<ConstValue> Elements;
+    Elements.push_back(ConstValue::getInteger(std::move(Value)));
+    Elements.push_back(ConstValue::getInteger(APInt(1, Overflow)));
+    return ConstValue::getAggregate(std::move(Elements));
+  };
+
+  const IntrinsicInfo &Intrinsic = BI->getIntrinsicInfo();
+  if (Intrinsic.ID != llvm::Intrinsic::not_intrinsic) {
+    switch (Intrinsic.ID) {
+    default:
+      return false;
+
+    case llvm::Intrinsic::expect:
+      Result = Args[0];
+      return true;
+
+    case llvm::Intrinsic::sadd_with_overflow:
+    case llvm::Intrinsic::uadd_with_overflow:
+    case llvm::Intrinsic::ssub_with_overflow:
+    case llvm::Intrinsic::usub_with_overflow:
+    case llvm::Intrinsic::smul_with_overflow:
+    case llvm::Intrinsic::umul_with_overflow: {
+      bool Overflow;
+      APInt Value = constantFoldBinaryWithOverflow(
+          Args[0].IntValue, Args[1].IntValue, Overflow, Intrinsic.ID);
+      Result = getOverflowResult(std::move(Value), Overflow);
+      return true;
+    }
+    }
+  }
+
+  const BuiltinInfo &Builtin = BI->getBuiltinInfo();
+  switch (Builtin.ID) {
+  default:
+    return false;
+
+#define BUILTIN(id, name, Attrs)
+#define BUILTIN_BINARY_OPERATION_WITH_OVERFLOW(id, name, _, attrs, overload) \
+  case BuiltinValueKind::id:
+#include "swift/AST/Builtins.def"
+  {
+    bool Overflow;
+    APInt Value = constantFoldBinaryWithOverflow(
+        Args[0].IntValue, Args[1].IntValue, Overflow,
+        getLLVMIntrinsicIDForBuiltinWithOverflow(Builtin.ID));
+    Result = getOverflowResult(std::move(Value), Overflow);
+    return true;
+  }
+
+  case BuiltinValueKind::Add:
+    Result = ConstValue::getInteger(Args[0].IntValue + Args[1].IntValue);
+    return true;
+  case BuiltinValueKind::Sub:
+    Result = ConstValue::getInteger(Args[0].IntValue - Args[1].IntValue);
+    return true;
+  case BuiltinValueKind::Mul:
+    Result = ConstValue::getInteger(Args[0].IntValue * Args[1].IntValue);
+    return true;
+
+  case BuiltinValueKind::AShr:
+  case BuiltinValueKind::LShr:
+  case BuiltinValueKind::Shl:
+    // Shifting by the bit width or more is undefined.
+    if (Args[1].IntValue.uge(Args[1].IntValue.getBitWidth()))
+      return false;
+    SWIFT_FALLTHROUGH;
+  case BuiltinValueKind::And:
+  case BuiltinValueKind::Or:
+  case BuiltinValueKind::Xor:
+    Result = ConstValue::getInteger(
+        constantFoldBitOperation(Args[0].IntValue, Args[1].IntValue,
+                                 Builtin.ID));
+    return true;
+
+  case BuiltinValueKind::SDiv:
+  case BuiltinValueKind::SRem:
+  case BuiltinValueKind::UDiv:
+  case BuiltinValueKind::URem: {
+    // Division by zero and overflowing divisions trap at runtime.
+    if (Args[1].IntValue == 0)
+      return false;
+    bool Overflow;
+    APInt Value = constantFoldDiv(Args[0].IntValue, Args[1].IntValue,
+                                  Overflow, Builtin.ID);
+    if (Overflow)
+      return false;
+    Result = ConstValue::getInteger(std::move(Value));
+    return true;
+  }
+
+  case BuiltinValueKind::ICMP_EQ:
+  case BuiltinValueKind::ICMP_NE:
+  case BuiltinValueKind::ICMP_SLE:
+  case BuiltinValueKind::ICMP_SLT:
+  case BuiltinValueKind::ICMP_SGE:
+  case BuiltinValueKind::ICMP_SGT:
+  case BuiltinValueKind::ICMP_ULE:
+  case BuiltinValueKind::ICMP_ULT:
+  case BuiltinValueKind::ICMP_UGE:
+  case BuiltinValueKind::ICMP_UGT:
+    Result = ConstValue::getInteger(
+        constantFoldComparison(Args[0].IntValue, Args[1].IntValue,
+                               Builtin.ID));
+    return true;
+
+  case BuiltinValueKind::Trunc:
+  case BuiltinValueKind::ZExt:
+  case BuiltinValueKind::SExt:
+  case BuiltinValueKind::TruncOrBitCast:
+  case BuiltinValueKind::ZExtOrBitCast:
+  case BuiltinValueKind::SExtOrBitCast:
+    if (Builtin.Types.size() != 2 ||
+        !Builtin.Types[0]->is<BuiltinIntegerType>() ||
+        !Builtin.Types[1]->is<BuiltinIntegerType>())
+      return false;
+    Result = ConstValue::getInteger(constantFoldCast(Args[0].IntValue,
+                                                     Builtin));
+    return true;
+  }
+}
+
+/// Returns true if \p V can be built as a value of type \p Ty from literals.
+static bool canMaterialize(SILType Ty, const ConstValue &V, SILModule &M) {
+  if (auto IntTy = Ty.getAs<BuiltinIntegerType>())
+    return V.isInteger() &&
+           IntTy->getGreatestWidth() == V.IntValue.getBitWidth();
+
+  if (isThinMetatype(Ty))
+    return V.TheKind == ConstValue::Kind::Metatype;
+
+  if (!V.isAggregate())
+    return false;
+
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    if (!SD->hasFixedLayout())
+      return false;
+    unsigned Index = 0;
+    for (VarDecl *Field : SD->getStoredProperties()) {
+      if (Index >= V.Elements.size() ||
+          !canMaterialize(Ty.getFieldType(Field, M), V.Elements[Index], M))
+        return false;
+      ++Index;
+    }
+    return Index == V.Elements.size();
+  }
+
+  if (auto TupleTy = Ty.getAs<TupleType>()) {
+    if (TupleTy->getNumElements() != V.Elements.size())
+      return false;
+    for (unsigned i = 0, e = V.Elements.size(); i != e; ++i)
+      if (!canMaterialize(Ty.getTupleElementType(i), V.Elements[i], M))
+        return false;
+    return true;
+  }
+
+  return false;
+}
+
+/// Builds \p V as a value of type \p Ty. canMaterialize must have returned
+/// true for them.
+static SILValue materialize(SILBuilder &B, SILLocation Loc, SILType Ty,
+                            const ConstValue &V) {
+  if (Ty.is<BuiltinIntegerType>())
+    return B.createIntegerLiteral(Loc, Ty, V.IntValue);
+
+  if (isThinMetatype(Ty))
+    return B.createMetatype(Loc, Ty);
+
+  SmallVector<SILValue, 4> Elements;
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    unsigned Index = 0;
+    for (VarDecl *Field : SD->getStoredProperties())
+      Elements.push_back(materialize(B, Loc,
+                                     Ty.getFieldType(Field, B.getModule()),
+                                     V.Elements[Index++]));
+    return B.createStruct(Loc, Ty, Elements);
+  }
+
+  for (unsigned i = 0, e = V.Elements.size(); i != e; ++i)
+    Elements.push_back(materialize(B, Loc, Ty.getTupleElementType(i),
+                                   V.Elements[i]));
+  return B.createTuple(Loc, Ty, Elements);
+}
+
+bool swift::isConstantEvaluationCandidate(ApplyInst *AI) {
+  SILFunction *Callee = AI->getReferencedFunction();
+  if (!Callee || !isEvaluableFunction(Callee) || AI->hasSubstitutions() ||
+      !isEvaluableFunctionType(AI->getSubstCalleeType()))
+    return false;
+
+  // There is nothing to fold in a call which returns nothing.
+  if (auto TTy = AI->getType().getAs<TupleType>())
+    if (TTy->getNumElements() == 0)
+      return false;
+
+  ConstValue Arg;
+  for (SILValue V : AI->getArguments())
+    if (!getConstantArgument(V, Arg))
+      return false;
+  return true;
+}
+
+SILValue swift::constantEvaluateApply(ApplyInst *AI, unsigned StepLimit) {
+  if (!isConstantEvaluationCandidate(AI))
+    return SILValue();
+
+  SmallVector<ConstValue, 4> Args;
+  for (SILValue V : AI->getArguments()) {
+    Args.push_back(ConstValue());
+    getConstantArgument(V, Args.back());
+  }
+
+  SILFunction *Callee = AI->getReferencedFunction();
+  DEBUG(llvm::dbgs() << "Evaluating call of " << Callee->getName() << "\n");
+
+  ConstantEvaluator Evaluator(StepLimit);
+  ConstValue Result;
+  if (!Evaluator.evaluateCall(Callee, Args, Result) ||
+      !canMaterialize(AI->getType(), Result, AI->getModule()))
+    return SILValue();
+
+  SILBuilderWithScope B(AI);
+  return materialize(B, AI->getLoc(), AI->getType(), Result);
+}
@@ -215,10 +215,30 @@ SILFunction *GenericFuncSpecializer::lookupSpecialization() {
 // Forward decl for prespecialization support.
 static bool linkSpecialization(SILModule &M, SILFunction *F);
 
+/// At -Osize, generic functions with more instructions than this are not
+/// specialized, because each specialization is a copy of the function.
+static const unsigned OptimizeForSizeSpecializationLimit = 100;
+
+/// Returns true if \p F has more than \p Limit instructions.
+static bool hasMoreInstructionsThan(SILFunction *F, unsigned Limit) {
+  unsigned Count = 0;
+  for (auto &BB : *F) {
+    Count += std::distance(BB.begin(), BB.end());
+    if (Count > Limit)
+      return true;
+  }
+  return false;
+}
+
 // Create a new specialized function if possible, and cache it.
 SILFunction *GenericFuncSpecializer::tryCreateSpecialization() {
-  // Do not create any new specializations at Onone.
-  if (M.getOptions().Optimization <= SILOptions::SILOptMode::None)
+  // Do not create any new specializations at Onone and Odebug.
+  if (M.getOptions().Optimization <= SILOptions::SILOptMode::Debug)
+    return nullptr;
+
+  if (M.getOptions().Optimization == SILOptions::SILOptMode::OptimizeForSize &&
+      hasMoreInstructionsThan(GenericFunc,
+                              OptimizeForSizeSpecializationLimit))
     return nullptr;
 
   DEBUG(
@@ -239,6 +259,30 @@ SILFunction *GenericFuncSpecializer::tryCreateSpecialization() {
 // Apply substitution
 // =============================================================================
 
+/// Returns the pre-specialization of \p GenericFunc for \p Subs from the
+/// SwiftOnoneSupport library, if it exists and has the expected type.
+static SILFunction *lookupPrespecialization(SILFunction *GenericFunc,
+                                            ArrayRef<Substitution> Subs,
+                                            const ReabstractionInfo &ReInfo) {
+  // The library specializes the fragile functions of the stdlib from its own
+  // fragile code, so the pre-specialization has the fragile name, even if it
+  // is called from a non-fragile function.
+  std::string PrespecializedName;
+  {
+    Mangle::Mangler Mangler;
+    GenericSpecializationMangler GenericMangler(Mangler, GenericFunc, Subs,
+                                                GenericFunc->isFragile());
+    GenericMangler.mangle();
+    PrespecializedName = Mangler.finalize();
+  }
+  SILFunction *PrespecializedF =
+    lookupPrespecializedSymbol(GenericFunc->getModule(), PrespecializedName);
+  if (!PrespecializedF ||
+      PrespecializedF->getLoweredFunctionType() != ReInfo.getSpecializedType())
+    return nullptr;
+  return PrespecializedF;
+}
+
 /// Fix the case where a void function returns the result of an apply, which is
 /// also a call of a void-returning function.
 /// We always want a void function returning a tuple _instruction_.
@@ -507,6 +551,13 @@ void swift::trySpecializeApplyOfGeneric(
     // Even if the pre-specialization exists already, try to preserve it
     // if it is whitelisted.
     linkSpecialization(M, SpecializedF);
+  } else if (M.getOptions().UsePrespecializations && !Fragile &&
+             (SpecializedF = lookupPrespecialization(
+                                 RefF, Apply.getSubstitutions(), ReInfo))) {
+    // Call the pre-specialization of the library instead of creating a new
+    // specialization in this module.
+    DEBUG(llvm::dbgs() << "    Using pre-specialization "
+                       << SpecializedF->getName() << '\n');
   } else {
     SpecializedF = FuncSpecializer.tryCreateSpecialization();
     if (!SpecializedF)
@@ -522,7 +573,8 @@ void swift::trySpecializeApplyOfGeneric(
   // FIXME: Replace pre-specialization's "keep as public" hack with something
   // more principled
   assert((Fragile == SpecializedF->isFragile() ||
-          SpecializedF->isKeepAsPublic()) &&
+          SpecializedF->isKeepAsPublic() ||
+          SpecializedF->isExternalDeclaration()) &&
          "Previously specialized function does not match expected "
          "resilience level.");
 
@@ -652,6 +704,14 @@ bool swift::isWhitelistedSpecialization(StringRef SpecName) {
       "RandomAccessCollection",
       "RangeReplaceableCollection",
       "_allocateUninitializedArray",
+      "Dictionary",
+      "DictionaryIterator",
+      "_NativeDictionaryStorage",
+      "_VariantDictionaryStorage",
+      "Set",
+      "SetIterator",
+      "_NativeSetStorage",
+      "_VariantSetStorage",
       "UTF8",
       "UTF16",
       "String",
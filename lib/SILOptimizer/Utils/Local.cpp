@@ -72,10 +72,10 @@ swift::createDecrementBefore(SILValue Ptr, SILInstruction *InsertPt) {
 /// This routine only examines the state of the instruction at hand.
 bool
 swift::isInstructionTriviallyDead(SILInstruction *I) {
-  // At Onone, consider all uses, including the debug_info.
-  // This way, debug_info is preserved at Onone.
+  // At Onone and Odebug, consider all uses, including the debug_info.
+  // This way, debug_info is preserved in debuggable builds.
   if (!I->use_empty() &&
-      I->getModule().getOptions().Optimization <= SILOptions::SILOptMode::None)
+      I->getModule().getOptions().Optimization <= SILOptions::SILOptMode::Debug)
     return false;
 
   if (!onlyHaveDebugUses(I) || isa<TermInst>(I))
@@ -2179,6 +2179,22 @@ optimizeCheckedCastAddrBranchInst(CheckedCastAddrBranchInst *Inst) {
   return nullptr;
 }
 
+/// Returns true if a value of class type \p SourceTy is cast to a final,
+/// non-generic Swift class \p TargetTy, which is a subclass of \p SourceTy.
+///
+/// Classes with Objective-C ancestry are excluded, as the Objective-C runtime
+/// may create subclasses of any class dynamically, e.g. for key-value
+/// observing.
+static bool isCastToFinalNativeClass(SILType SourceTy, SILType TargetTy) {
+  if (!SourceTy.getClassOrBoundGenericClass())
+    return false;
+  auto *CD = TargetTy.getClassOrBoundGenericClass();
+  if (!CD || !CD->isFinal() || CD->isGenericContext() || CD->hasClangNode() ||
+      CD->checkObjCAncestry() != ObjCClassKind::NonObjC)
+    return false;
+  return SourceTy.isBindableToSuperclassOf(TargetTy);
+}
+
 SILInstruction *
 CastOptimizer::optimizeCheckedCastBranchInst(CheckedCastBranchInst *Inst) {
   if (Inst->isExact())
@@ -2332,6 +2348,29 @@ CastOptimizer::optimizeCheckedCastBranchInst(CheckedCastBranchInst *Inst) {
     }
   }
 
+  // A cast of a class instance to a final class succeeds only if the dynamic
+  // type of the instance is exactly the target class. An exact cast only
+  // compares the isa pointer with the class metadata, which avoids the
+  // runtime call and lets jump threading reason about chains of casts of the
+  // same value to different classes.
+  //
+  // checked_cast_br %0 : $Base to $Final, ...
+  // ->
+  // checked_cast_br [exact] %0 : $Base to $Final, ...
+  if (isCastToFinalNativeClass(Op->getType(), LoweredTargetType)) {
+    auto Feasibility = classifyDynamicCast(
+        Inst->getModule().getSwiftModule(), Op->getType().getSwiftRValueType(),
+        LoweredTargetType.getSwiftRValueType());
+    if (Feasibility == DynamicCastFeasibility::MaySucceed) {
+      SILBuilderWithScope B(Inst);
+      auto *NewI = B.createCheckedCastBranch(Loc, /* isExact */ true, Op,
+                                             LoweredTargetType, SuccessBB,
+                                             FailureBB);
+      EraseInstAction(Inst);
+      return NewI;
+    }
+  }
+
   return nullptr;
 }
 
@@ -1726,15 +1726,29 @@ namespace {
                                              /*options=*/0);
 
       // Introduce conversions from each element to the element type of the
-      // array.
+      // array. Literal elements of the same kind always have a common type
+      // in some solution, so merge the equivalence classes of their type
+      // variables and only convert the first of them, rather than solving
+      // for each element of a large homogeneous literal separately.
+      llvm::SmallDenseMap<unsigned, TypeVariableType *, 4> literalTypeVars;
       unsigned index = 0;
       for (auto element : expr->getElements()) {
+        unsigned elementIndex = index++;
+        auto tyvar = element->getType()->getAs<TypeVariableType>();
+        if (tyvar && isMergeableValueKind(element)) {
+          auto &first = literalTypeVars[unsigned(element->getKind())];
+          if (!first)
+            first = tyvar;
+          else if (mergeRepresentativeEquivalenceClasses(CS, first, tyvar))
+            continue;
+        }
+
         CS.addConstraint(ConstraintKind::Conversion,
                          element->getType(),
                          arrayElementTy,
                          CS.getConstraintLocator(
                            expr,
-                           LocatorPathElt::getTupleElement(index++)));
+                           LocatorPathElt::getTupleElement(elementIndex)));
       }
 
       // The array element type defaults to 'Any'.
@@ -1807,52 +1821,41 @@ namespace {
       llvm::DenseSet<Expr *> mergedElements;
 
       // If no contextual type is present, Merge equivalence classes of key 
-      // and value types as necessary.
+      // and value types as necessary. Each key and value literal is merged
+      // with the first one of the same kind, which keeps this linear in the
+      // number of elements.
       if (!CS.getContextualType(expr)) {
-        for (auto element1 : expr->getElements()) {
-          for (auto element2 : expr->getElements()) {
-            if (element1 == element2)
-              continue;
-
-            auto tty1 = element1->getType()->getAs<TupleType>();
-            auto tty2 = element2->getType()->getAs<TupleType>();
-
-            if (tty1 && tty2) {
-              auto mergedKey = false;
-              auto mergedValue = false;
-
-              auto keyTyvar1 = tty1->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-              auto keyTyvar2 = tty2->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-
-              auto keyExpr1 = cast<TupleExpr>(element1)->getElements()[0];
-              auto keyExpr2 = cast<TupleExpr>(element2)->getElements()[0];
-
-              if (keyExpr1->getKind() == keyExpr2->getKind() &&
-                  isMergeableValueKind(keyExpr1)) {
-                mergedKey = mergeRepresentativeEquivalenceClasses(CS,
-                            keyTyvar1, keyTyvar2);
-              }
-
-              auto valueTyvar1 = tty1->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-              auto valueTyvar2 = tty2->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-
-              auto elemExpr1 = cast<TupleExpr>(element1)->getElements()[1];
-              auto elemExpr2 = cast<TupleExpr>(element2)->getElements()[1];
-
-              if (elemExpr1->getKind() == elemExpr2->getKind() &&
-                isMergeableValueKind(elemExpr1)) {
-                mergedValue = mergeRepresentativeEquivalenceClasses(CS, 
-                                valueTyvar1, valueTyvar2);
-              }
+        llvm::SmallDenseMap<unsigned, TypeVariableType *, 4> keyTypeVars;
+        llvm::SmallDenseMap<unsigned, TypeVariableType *, 4> valueTypeVars;
+        auto mergeWithFirstOfKind =
+          [&](llvm::SmallDenseMap<unsigned, TypeVariableType *, 4> &firsts,
+              Expr *literal, Type type) -> bool {
+            auto tyvar = type->getAs<TypeVariableType>();
+            if (!tyvar || !isMergeableValueKind(literal))
+              return false;
 
-              if (mergedKey && mergedValue)
-                mergedElements.insert(element2);
+            auto &first = firsts[unsigned(literal->getKind())];
+            if (!first) {
+              first = tyvar;
+              return false;
             }
-          }
+            return mergeRepresentativeEquivalenceClasses(CS, first, tyvar);
+          };
+
+        for (auto element : expr->getElements()) {
+          auto tty = element->getType()->getAs<TupleType>();
+          if (!tty)
+            continue;
+
+          auto tupleExpr = cast<TupleExpr>(element);
+          auto mergedKey = mergeWithFirstOfKind(keyTypeVars,
+                                                tupleExpr->getElements()[0],
+                                                tty->getElementTypes()[0]);
+          auto mergedValue = mergeWithFirstOfKind(valueTypeVars,
+                                                  tupleExpr->getElements()[1],
+                                                  tty->getElementTypes()[1]);
+          if (mergedKey && mergedValue)
+            mergedElements.insert(element);
         }
       }      
 
@@ -135,6 +135,7 @@ Solution ConstraintSystem::finalize(
   }
 
   // For each of the type variables, get its fixed type.
+  solution.typeBindings.reserve(TypeVariables.size());
   for (auto tv : TypeVariables) {
     solution.typeBindings[tv] = reconstituteSugar(simplifyType(tv));
   }
@@ -207,12 +208,18 @@ Solution ConstraintSystem::finalize(
 }
 
 void ConstraintSystem::applySolution(const Solution &solution) {
+  llvm::SmallPtrSet<TypeVariableType *, 4>
+    knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
+  applySolution(solution, knownTypeVariables);
+}
+
+void ConstraintSystem::applySolution(
+       const Solution &solution,
+       llvm::SmallPtrSetImpl<TypeVariableType *> &knownTypeVariables) {
   // Update the score.
   CurrentScore += solution.getFixedScore();
 
   // Assign fixed types to the type variables solved by this solution.
-  llvm::SmallPtrSet<TypeVariableType *, 4> 
-    knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
   for (auto binding : solution.typeBindings) {
     // If we haven't seen this type variable before, record it now.
     if (knownTypeVariables.insert(binding.first).second)
@@ -420,6 +427,10 @@ ConstraintSystem::SolverState::~SolverState() {
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
 
+  // And to the totals for this constraint system.
+  #define CS_STATISTIC(Name, Description) CS.TotalSolverStats.Name += Name;
+  #include "ConstraintSolverStats.def"
+
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
   // FIXME: This is not at all thread-safe.
@@ -2022,8 +2033,10 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     // Create a new solver scope in which we apply all of the partial
     // solutions.
     SolverScope scope(*this);
+    llvm::SmallPtrSet<TypeVariableType *, 16>
+      knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
     for (unsigned i = 0; i != numComponents; ++i)
-      applySolution(partialSolutions[i][indices[i]]);
+      applySolution(partialSolutions[i][indices[i]], knownTypeVariables);
 
     // This solution might be worse than the best solution found so far. If so,
     // skip it.
@@ -2124,6 +2137,33 @@ static bool shortCircuitDisjunctionAt(Constraint *constraint,
   return false;
 }
 
+/// Whether a term that solved a disjunction somewhere else in the search is
+/// worth trying first when the disjunction comes up again, because finding a
+/// solution with it lets shortCircuitDisjunctionAt skip the other terms.
+static bool shouldTryDisjunctionTermFirst(Constraint *term,
+                                          ArrayRef<Constraint *> terms) {
+  // Don't let an unfavored term jump ahead of a favored one.
+  if (!term->isFavored() &&
+      std::any_of(terms.begin(), terms.end(),
+                  [](Constraint *other) { return other->isFavored(); }))
+    return false;
+
+  if (term->isFavored())
+    return true;
+  if (term->getFix())
+    return false;
+
+  // A non-generic operator dominates the generic ones.
+  if (term->getKind() == ConstraintKind::BindOverload &&
+      term->getOverloadChoice().getKind() == OverloadChoiceKind::Decl) {
+    auto decl = term->getOverloadChoice().getDecl();
+    return decl->getName().isOperator() &&
+           !decl->getInterfaceType()->is<GenericFunctionType>();
+  }
+
+  return false;
+}
+
 bool ConstraintSystem::solveSimplified(
        SmallVectorImpl<Solution> &solutions,
        FreeTypeVariableBinding allowFreeTypeVariables) {
@@ -2209,19 +2249,26 @@ bool ConstraintSystem::solveSimplified(
     return true;
   }
 
-  // Pick the smallest disjunction.
+  // Pick the smallest disjunction. Among disjunctions of the same size,
+  // prefer one that has already been solved along another path, since its
+  // remembered term is likely to let us skip the rest.
   // FIXME: This heuristic isn't great, but it helped somewhat for
   // overload sets.
+  auto &lastSuccessfulTerm = solverState->LastSuccessfulDisjunctionTerm;
   auto disjunction = disjunctions[0];
   auto bestSize = disjunction->getNestedConstraints().size();
-  if (bestSize > 2) {
+  bool bestIsKnown = lastSuccessfulTerm.count(disjunction);
+  if (bestSize > 2 || !bestIsKnown) {
     for (auto contender : llvm::makeArrayRef(disjunctions).slice(1)) {
       unsigned newSize = contender->getNestedConstraints().size();
-      if (newSize < bestSize) {
+      bool newIsKnown = lastSuccessfulTerm.count(contender);
+      if (newSize < bestSize ||
+          (newSize == bestSize && newIsKnown && !bestIsKnown)) {
         bestSize = newSize;
+        bestIsKnown = newIsKnown;
         disjunction = contender;
 
-        if (bestSize == 2)
+        if (bestSize == 2 && bestIsKnown)
           break;
       }
     }
@@ -2231,18 +2278,34 @@ bool ConstraintSystem::solveSimplified(
   auto afterDisjunction = InactiveConstraints.erase(disjunction);
   CG.removeConstraint(disjunction);
 
-  // Try each of the constraints within the disjunction.
+  // Try each of the constraints within the disjunction, starting with the
+  // one that solved it last time if that one can prune the others.
   Constraint *firstSolvedConstraint = nullptr;
   ++solverState->NumDisjunctions;
   auto constraints = disjunction->getNestedConstraints();
-  for (auto index : indices(constraints)) {
+  SmallVector<unsigned, 8> order;
+  for (auto index : indices(constraints))
+    order.push_back(index);
+  auto known = lastSuccessfulTerm.find(disjunction);
+  if (known != lastSuccessfulTerm.end() && known->second != 0 &&
+      shouldTryDisjunctionTermFirst(constraints[known->second],
+                                    constraints)) {
+    std::rotate(order.begin(), order.begin() + known->second,
+                order.begin() + known->second + 1);
+    ++solverState->NumDisjunctionTermsReordered;
+  }
+
+  for (auto position : indices(order)) {
+    auto index = order[position];
     auto constraint = constraints[index];
 
     // We already have a solution; check whether we should
     // short-circuit the disjunction.
     if (firstSolvedConstraint &&
-        shortCircuitDisjunctionAt(constraint, firstSolvedConstraint))
+        shortCircuitDisjunctionAt(constraint, firstSolvedConstraint)) {
+      solverState->NumDisjunctionTermsSkipped += order.size() - position;
       break;
+    }
     
     // If the expression was deemed "too complex", stop now and salvage.
     if (getExpressionTooComplex())
@@ -2296,6 +2359,8 @@ bool ConstraintSystem::solveSimplified(
     solverState->generatedConstraints.push_back(constraint);
 
     if (!solveRec(solutions, allowFreeTypeVariables)) {
+      if (!firstSolvedConstraint)
+        lastSuccessfulTerm[disjunction] = index;
       firstSolvedConstraint = constraint;
 
       // If we see a tuple-to-tuple conversion that succeeded, we're done.
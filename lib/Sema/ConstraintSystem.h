@@ -1091,6 +1091,12 @@ private:
     /// Refers to the innermost partial solution scope.
     SolverScope *PartialSolutionScope = nullptr;
 
+    /// For each disjunction that has been solved along some path, the index
+    /// of the term that most recently led to a solution. When the same
+    /// disjunction comes up again in another branch of the search, that term
+    /// is tried first so that the terms it dominates can be skipped.
+    llvm::DenseMap<Constraint *, unsigned> LastSuccessfulDisjunctionTerm;
+
     // Statistics
     #define CS_STATISTIC(Name, Description) unsigned Name = 0;
     #include "ConstraintSolverStats.def"
@@ -1104,6 +1110,13 @@ public:
   /// we're exploring. 
   SolverState *solverState = nullptr;
 
+  /// The solver statistics, summed over every time this system was solved.
+  struct SolverStatistics {
+    #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+    #include "ConstraintSolverStats.def"
+  };
+  SolverStatistics TotalSolverStats;
+
   struct ArgumentLabelState {
     ArrayRef<Identifier> Labels;
     bool HasTrailingClosure;
@@ -1227,6 +1240,15 @@ private:
   /// constraint system for further exploration.
   void applySolution(const Solution &solution);
 
+  /// \brief Apply the given solution to the current constraint system,
+  /// given the set of type variables already known to it.
+  ///
+  /// This allows several partial solutions to be applied in a row without
+  /// collecting the known type variables for each of them.
+  void applySolution(const Solution &solution,
+                     llvm::SmallPtrSetImpl<TypeVariableType *>
+                       &knownTypeVariables);
+
   /// Emit the fixes computed as part of the solution, returning true if we were
   /// able to emit an error message, or false if none of the fixits worked out.
   bool applySolutionFixes(Expr *E, const Solution &solution);
@@ -93,11 +93,18 @@ void IterativeTypeChecker::processResolveInheritedClauseEntry(
   TypeLoc *inherited;
   std::tie(options, dc, inherited) = decomposeInheritedClauseEntry(payload);
 
-  // FIXME: Declaration validation is overkill. Sink it down into type
-  // resolution when it is actually needed.
-  if (auto nominal = dyn_cast<NominalTypeDecl>(dc))
-    TC.validateDecl(nominal);
-  else if (auto ext = dyn_cast<ExtensionDecl>(dc)) {
+  // Resolving the entry only needs the generic signature of its context.
+  // A nominal type outside of any generic context has none, so don't
+  // validate it; that would also resolve the rest of its inheritance clause
+  // and its attributes, and pull in whatever those refer to, e.g. when
+  // another file only asks for a class's superclass. Anything the
+  // resolution does need is validated on demand through ResolveTypeDecl.
+  // FIXME: Declaration validation is overkill for generic types too. Sink
+  // it down into type resolution when it is actually needed.
+  if (auto nominal = dyn_cast<NominalTypeDecl>(dc)) {
+    if (nominal->isGenericContext())
+      TC.validateDecl(nominal);
+  } else if (auto ext = dyn_cast<ExtensionDecl>(dc)) {
     TC.validateExtension(ext);
   }
 
@@ -26,6 +26,7 @@
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/JSONSerialization.h"
 #include "swift/Parse/Lexer.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
@@ -35,8 +36,11 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <chrono>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1493,6 +1497,115 @@ namespace {
   };
 }
 
+#pragma mark Expression statistics
+
+namespace {
+  /// The statistics of one call to typeCheckExpression, for
+  /// -debug-expression-type-check-stats.
+  struct ExpressionTypeCheckStats {
+    std::string File;
+    unsigned StartLine = 0, StartColumn = 0;
+    unsigned EndLine = 0, EndColumn = 0;
+    uint64_t WallNanoseconds = 0;
+    ConstraintSystem::SolverStatistics Solver;
+  };
+
+  /// Records the statistics of a type-checked expression when it goes out of
+  /// scope, however type-checking ended.
+  class ExpressionTypeCheckStatsScope {
+    TypeChecker &TC;
+    ConstraintSystem &CS;
+    SourceRange Range;
+    std::chrono::steady_clock::time_point StartTime;
+
+  public:
+    ExpressionTypeCheckStatsScope(TypeChecker &tc, ConstraintSystem &cs,
+                                  Expr *expr)
+        : TC(tc), CS(cs) {
+      if (TC.getLangOpts().ExpressionTypeCheckStatsPath.empty())
+        return;
+      Range = expr->getSourceRange();
+      StartTime = std::chrono::steady_clock::now();
+    }
+
+    ~ExpressionTypeCheckStatsScope();
+  };
+} // end anonymous namespace
+
+/// Every expression type-checked in this process, in order.
+static llvm::ManagedStatic<std::vector<ExpressionTypeCheckStats>>
+AllExpressionTypeCheckStats;
+
+ExpressionTypeCheckStatsScope::~ExpressionTypeCheckStatsScope() {
+  if (TC.getLangOpts().ExpressionTypeCheckStatsPath.empty())
+    return;
+
+  auto elapsed = std::chrono::steady_clock::now() - StartTime;
+  ExpressionTypeCheckStats stats;
+  stats.WallNanoseconds =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  stats.Solver = CS.TotalSolverStats;
+
+  // Implicit expressions may not have a location.
+  if (Range.isValid()) {
+    auto &SM = TC.Context.SourceMgr;
+    stats.File = SM.getBufferIdentifierForLoc(Range.Start);
+    std::tie(stats.StartLine, stats.StartColumn) =
+      SM.getLineAndColumn(Range.Start);
+    std::tie(stats.EndLine, stats.EndColumn) = SM.getLineAndColumn(Range.End);
+  }
+
+  AllExpressionTypeCheckStats->push_back(std::move(stats));
+}
+
+namespace swift {
+namespace json {
+
+template <>
+struct ObjectTraits<ExpressionTypeCheckStats> {
+  static void mapping(Output &out, ExpressionTypeCheckStats &stats) {
+    out.mapRequired("file", stats.File);
+    out.mapRequired("start_line", stats.StartLine);
+    out.mapRequired("start_column", stats.StartColumn);
+    out.mapRequired("end_line", stats.EndLine);
+    out.mapRequired("end_column", stats.EndColumn);
+    out.mapRequired("wall_ns", stats.WallNanoseconds);
+    #define CS_STATISTIC(Name, Description) \
+      out.mapRequired(#Name, stats.Solver.Name);
+    #include "ConstraintSolverStats.def"
+  }
+};
+
+template <>
+struct ArrayTraits<std::vector<ExpressionTypeCheckStats>> {
+  static size_t size(Output &out, std::vector<ExpressionTypeCheckStats> &seq) {
+    return seq.size();
+  }
+  static ExpressionTypeCheckStats &
+  element(Output &out, std::vector<ExpressionTypeCheckStats> &seq,
+          size_t index) {
+    return seq[index];
+  }
+};
+
+} // end namespace json
+} // end namespace swift
+
+/// Rewrites the whole file each time, so that it always holds every
+/// expression type-checked so far, whichever type checker checked it.
+void TypeChecker::writeExpressionTypeCheckStats() {
+  auto &path = getLangOpts().ExpressionTypeCheckStatsPath;
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    diagnose(SourceLoc(), diag::error_opening_output, path, EC.message());
+    return;
+  }
+  json::Output out(OS);
+  out << *AllExpressionTypeCheckStats;
+  OS << '\n';
+}
+
 #pragma mark High-level entry points
 bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       TypeLoc convertType,
@@ -1508,6 +1621,7 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
     csOptions |= ConstraintSystemFlags::PreferForceUnwrapToOptional;
   ConstraintSystem cs(*this, dc, csOptions);
   cs.baseCS = baseCS;
+  ExpressionTypeCheckStatsScope statsScope(*this, cs, expr);
   CleanupIllFormedExpressionRAII cleanup(Context, expr);
   ExprCleanser cleanup2(expr);
 
@@ -48,6 +48,12 @@ namespace {
     // The conforming context, either a nominal type or extension.
     DeclContext *DC;
 
+    /// The value witnesses found for each requirement, which associated
+    /// type inference and witness resolution both look up. Lookups which
+    /// found nothing aren't recorded, because implicit members may still
+    /// be synthesized.
+    llvm::DenseMap<ValueDecl *, SmallVector<ValueDecl *, 4>> ValueWitnesses;
+
     WitnessChecker(TypeChecker &tc, ProtocolDecl *proto,
                    Type adoptee, DeclContext *dc)
       : TC(tc), Proto(proto), Adoptee(adoptee), DC(dc) { }
@@ -1095,7 +1101,11 @@ static bool isBetterMatch(TypeChecker &tc, DeclContext *dc,
 SmallVector<ValueDecl *, 4> 
 WitnessChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
   assert(!isa<AssociatedTypeDecl>(req) && "Not for lookup for type witnesses*");
-  
+
+  auto known = ValueWitnesses.find(req);
+  if (known != ValueWitnesses.end())
+    return known->second;
+
   SmallVector<ValueDecl *, 4> witnesses;
   if (req->getName().isOperator()) {
     // Operator lookup is always global.
@@ -1130,6 +1140,8 @@ WitnessChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
     }
   }
 
+  if (!witnesses.empty() && !(ignoringNames && *ignoringNames))
+    ValueWitnesses[req] = witnesses;
   return witnesses;
 }
 
@@ -2623,11 +2635,35 @@ ResolveWitnessResult ConformanceChecker::resolveTypeWitnessViaLookup(
   return ResolveWitnessResult::ExplicitFailed;
 }
 
+/// Whether the witness can be ruled out by the basic checks at the start of
+/// matchWitness, without computing its type.
+static bool isObviouslyNotAWitness(ValueDecl *req, ValueDecl *witness) {
+  if (req->getKind() != witness->getKind())
+    return true;
+
+  if (auto funcReq = dyn_cast<FuncDecl>(req)) {
+    auto funcWitness = cast<FuncDecl>(witness);
+    return funcReq->isStatic() != funcWitness->isStatic() &&
+           !(funcReq->isOperator() &&
+             !funcWitness->getDeclContext()->isTypeContext());
+  }
+
+  if (auto varReq = dyn_cast<VarDecl>(req))
+    return varReq->isStatic() != cast<VarDecl>(witness)->isStatic();
+
+  return false;
+}
+
 InferredAssociatedTypesByWitnesses
 ConformanceChecker::inferTypeWitnessesViaValueWitnesses(ValueDecl *req) {
   InferredAssociatedTypesByWitnesses result;
 
   for (auto witness : lookupValueWitnesses(req, /*ignoringNames=*/nullptr)) {
+    // Skip candidates that can't match before substituting into their
+    // types; none of them would contribute any inferred types.
+    if (isObviouslyNotAWitness(req, witness))
+      continue;
+
     // Try to resolve the type witness via this value witness.
     auto witnessResult = inferTypeWitnessesViaValueWitness(req, witness);
 
@@ -1243,10 +1243,44 @@ bool TypeChecker::typeCheckAbstractFunctionBodyUntil(AbstractFunctionDecl *AFD,
   return typeCheckDestructorBodyUntil(DD, EndTypeCheckLoc);
 }
 
+/// Returns true if the body of \p AFD does not need to be type-checked when
+/// only the module is emitted, because it is not serialized.
+static bool canSkipFunctionBody(AbstractFunctionDecl *AFD) {
+  // Destructor bodies are always emitted by SILGen.
+  if (isa<DestructorDecl>(AFD))
+    return false;
+
+  // Synthesized bodies are cheap, and local functions are only reached from
+  // bodies which are type-checked.
+  if (AFD->isImplicit() || AFD->getDeclContext()->isLocalContext())
+    return false;
+
+  if (AFD->getBodyKind() != AbstractFunctionDecl::BodyKind::Parsed)
+    return false;
+
+  // The bodies of transparent and inlinable functions are serialized.
+  if (AFD->isTransparent() ||
+      AFD->getResilienceExpansion() == ResilienceExpansion::Minimal)
+    return false;
+
+  return true;
+}
+
 bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (!AFD->getBody())
     return false;
 
+  if (SkipNonInlinableFunctionBodies && canSkipFunctionBody(AFD)) {
+    // Default arguments are emitted into the callers, so they are still
+    // checked.
+    unsigned nextArgIndex = 0;
+    for (auto paramList : AFD->getParameterLists())
+      checkDefaultArguments(*this, paramList, nextArgIndex, AFD);
+
+    AFD->setBodySkipped(AFD->getBodySourceRange());
+    return false;
+  }
+
   Optional<FunctionBodyTimer> timer;
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(AFD, DebugTimeFunctionBodies, WarnLongFunctionBodies);
@@ -54,6 +54,9 @@ TypeChecker::TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags)
 }
 
 TypeChecker::~TypeChecker() {
+  if (!getLangOpts().ExpressionTypeCheckStatsPath.empty())
+    writeExpressionTypeCheckStats();
+
   auto clangImporter =
     static_cast<ClangImporter *>(Context.getClangModuleLoader());
   clangImporter->clearTypeResolver();
@@ -401,6 +404,15 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     // Type check the body of each of the function in turn.  Note that outside
     // functions must be visited before nested functions for type-checking to
     // work correctly.
+    //
+    // FIXME: Most bodies are independent of each other, but this loop can't
+    // be spread across threads yet. Checking a body validates declarations
+    // lazily, which mutates the AST, and appends to definedFunctions and
+    // ExternalDefinitions. It also allocates from the ASTContext's
+    // unsynchronized arenas and goes through the lazy resolver, the
+    // conformance tables and the type uniquing tables, none of which are
+    // locked. The way to use more cores today is to split a module across
+    // frontend jobs, e.g. with the driver's batch mode.
     for (unsigned n = TC.definedFunctions.size(); currentFunctionIdx != n;
          ++currentFunctionIdx) {
       auto *AFD = TC.definedFunctions[currentFunctionIdx];
@@ -410,6 +422,9 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
       // but that gets tricky with synthesized function bodies.
       if (AFD->isBodyTypeChecked()) continue;
 
+      if (TC.Context.isCancellationRequested())
+        return;
+
       PrettyStackTraceDecl StackEntry("type-checking", AFD);
       TC.typeCheckAbstractFunctionBody(AFD);
 
@@ -563,6 +578,9 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
 
+    if (Options.contains(TypeCheckingFlags::SkipNonInlinableFunctionBodies))
+      TC.enableSkipNonInlinableFunctionBodies();
+
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
     
@@ -607,6 +625,9 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
       TC.typeCheckDecl(D, /*isFirstPass*/true);
     }
 
+    if (Ctx.isCancellationRequested())
+      return;
+
     // At this point, we can perform general name lookup into any type.
 
     // We don't know the types of all the global declarations in the first
@@ -637,6 +658,10 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     typeCheckFunctionsAndExternalDecls(TC);
   }
 
+  // A cancelled AST is thrown away, and wouldn't pass verification.
+  if (Ctx.isCancellationRequested())
+    return;
+
   // Checking that benefits from having the whole module available.
   if (!(Options & TypeCheckingFlags::DelayWholeModuleChecking)) {
     performWholeModuleTypeChecking(SF);
@@ -650,6 +650,10 @@ private:
   /// when executing scripts.
   bool InImmediateMode = false;
 
+  /// If true, the bodies of functions which are not serialized into the
+  /// module are skipped instead of being type-checked.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// A helper to construct and typecheck call to super.init().
   ///
   /// \returns NULL if the constructed expression does not typecheck.
@@ -667,6 +671,15 @@ public:
     DebugTimeFunctionBodies = true;
   }
 
+  /// Skip the bodies of functions which are not serialized into the module.
+  void enableSkipNonInlinableFunctionBodies() {
+    SkipNonInlinableFunctionBodies = true;
+  }
+
+  /// Write the statistics of every expression type-checked so far in this
+  /// process to the file named by -debug-expression-type-check-stats.
+  void writeExpressionTypeCheckStats();
+
   /// If \p timeInMS is non-zero, warn when a function body takes longer than
   /// this many milliseconds to type-check.
   ///
@@ -380,13 +380,13 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   DeclID clangNodeOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, numInstructions;
   ArrayRef<uint64_t> SemanticsIDs;
   // TODO: read fragile
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangNodeOwnerID,
-                                SemanticsIDs);
+                                numSpecAttrs, numInstructions, funcTyID,
+                                clangNodeOwnerID, SemanticsIDs);
 
   if (funcTyID == 0) {
     DEBUG(llvm::dbgs() << "SILFunction typeID is 0.\n");
@@ -440,6 +440,11 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
     // Don't override the transparency or linkage of a function with
     // an existing declaration.
 
+    // But pick up the effects which were computed for the function in its
+    // defining module.
+    if (!fn->hasEffectsKind())
+      fn->setEffectsKind((EffectsKind)effect);
+
   // Otherwise, create a new function.
   } else {
     fn = SILMod.createFunction(
@@ -1935,12 +1940,12 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   DeclID clangOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, numInstructions;
   ArrayRef<uint64_t> SemanticsIDs;
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangOwnerID,
-                                SemanticsIDs);
+                                numSpecAttrs, numInstructions, funcTyID,
+                                clangOwnerID, SemanticsIDs);
   auto linkage = fromStableSILLinkage(rawLinkage);
   if (!linkage) {
     DEBUG(llvm::dbgs() << "invalid linkage code " << rawLinkage
@@ -1956,6 +1961,57 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   return true;
 }
 
+/// Returns the number of instructions in the serialized body of the function
+/// with the given name, without deserializing the function.
+Optional<unsigned> SILDeserializer::getSILFunctionBodySize(StringRef Name) {
+  if (!FuncTable)
+    return None;
+  auto iter = FuncTable->find(Name);
+  if (iter == FuncTable->end())
+    return None;
+
+  auto FID = *iter;
+  auto &cacheEntry = Funcs[FID-1];
+  if (cacheEntry.isFullyDeserialized()) {
+    unsigned Size = 0;
+    for (auto &BB : *cacheEntry.get())
+      Size += std::distance(BB.begin(), BB.end());
+    return Size;
+  }
+
+  BCOffsetRAII restoreOffset(SILCursor);
+  SILCursor.JumpToBit(cacheEntry.getOffset());
+
+  auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+  if (entry.Kind == llvm::BitstreamEntry::Error) {
+    DEBUG(llvm::dbgs() << "Cursor advance error in getSILFunctionBodySize.\n");
+    MF->error();
+    return None;
+  }
+
+  SmallVector<uint64_t, 64> scratch;
+  StringRef blobData;
+  unsigned kind = SILCursor.readRecord(entry.ID, scratch, &blobData);
+  assert(kind == SIL_FUNCTION && "expect a sil function");
+  (void)kind;
+
+  DeclID clangOwnerID;
+  TypeID funcTyID;
+  unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
+    inlineStrategy, effect, numSpecAttrs, numInstructions;
+  ArrayRef<uint64_t> SemanticsIDs;
+  SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
+                                isThunk, isGlobal, inlineStrategy, effect,
+                                numSpecAttrs, numInstructions, funcTyID,
+                                clangOwnerID, SemanticsIDs);
+
+  // A function without a body in this module may have one in another module.
+  auto linkage = fromStableSILLinkage(rawLinkage);
+  if (!linkage || isAvailableExternally(linkage.getValue()))
+    return None;
+  return numInstructions;
+}
+
 
 SILFunction *SILDeserializer::lookupSILFunction(StringRef name,
                                                 bool declarationOnly) {
@@ -114,6 +114,9 @@ static bool readOptionsBlock(llvm::BitstreamCursor &cursor,
       options_block::ResilienceStrategyLayout::readRecord(scratch, Strategy);
       extendedInfo.setResilienceStrategy(ResilienceStrategy(Strategy));
       break;
+    case options_block::INTERFACE_HASH:
+      extendedInfo.setInterfaceHash(blobData);
+      break;
     default:
       // Unknown options record, possibly for use by a future version of the
       // module format.
@@ -460,6 +463,20 @@ ModuleFile::readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                              base + sizeof(uint32_t), base));
 }
 
+/// Fills \p values from a blob of little-endian bit offsets, as written by
+/// Serializer::writeOffsets.
+template <typename T>
+static void readOffsets(std::vector<T> &values, StringRef blobData) {
+  assert(blobData.size() % sizeof(uint32_t) == 0 && "malformed offsets");
+  size_t count = blobData.size() / sizeof(uint32_t);
+  auto *data = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  values.clear();
+  values.reserve(count);
+  for (size_t i = 0; i != count; ++i)
+    values.emplace_back(endian::readNext<uint32_t, little, unaligned>(data));
+}
+
 bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(INDEX_BLOCK_ID);
 
@@ -488,20 +505,16 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
 
       switch (kind) {
       case index_block::DECL_OFFSETS:
-        assert(blobData.empty());
-        Decls.assign(scratch.begin(), scratch.end());
+        readOffsets(Decls, blobData);
         break;
       case index_block::DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        DeclContexts.assign(scratch.begin(), scratch.end());
+        readOffsets(DeclContexts, blobData);
         break;
       case index_block::TYPE_OFFSETS:
-        assert(blobData.empty());
-        Types.assign(scratch.begin(), scratch.end());
+        readOffsets(Types, blobData);
         break;
       case index_block::IDENTIFIER_OFFSETS:
-        assert(blobData.empty());
-        Identifiers.assign(scratch.begin(), scratch.end());
+        readOffsets(Identifiers, blobData);
         break;
       case index_block::TOP_LEVEL_DECLS:
         TopLevelDecls = readDeclTable(scratch, blobData);
@@ -524,6 +537,29 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
       case index_block::OBJC_METHODS:
         ObjCMethods = readObjCMethodTable(scratch, blobData);
         break;
+      case index_block::DECL_NAME_FILTER: {
+        unsigned tableKind, numHashes;
+        index_block::DeclNameFilterLayout::readRecord(scratch, tableKind,
+                                                      numHashes);
+        switch (tableKind) {
+        case index_block::TOP_LEVEL_DECLS:
+          TopLevelDeclsFilter.set(blobData, numHashes);
+          break;
+        case index_block::OPERATORS:
+          OperatorDeclsFilter.set(blobData, numHashes);
+          break;
+        case index_block::EXTENSIONS:
+          ExtensionDeclsFilter.set(blobData, numHashes);
+          break;
+        case index_block::OPERATOR_METHODS:
+          OperatorMethodDeclsFilter.set(blobData, numHashes);
+          break;
+        default:
+          // Filters of other tables aren't used.
+          break;
+        }
+        break;
+      }
       case index_block::ENTRY_POINT:
         assert(blobData.empty());
         setEntryPointClassID(scratch.front());
@@ -532,12 +568,10 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         LocalTypeDecls = readLocalDeclTable(scratch, blobData);
         break;
       case index_block::LOCAL_DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        LocalDeclContexts.assign(scratch.begin(), scratch.end());
+        readOffsets(LocalDeclContexts, blobData);
         break;
       case index_block::NORMAL_CONFORMANCE_OFFSETS:
-        assert(blobData.empty());
-        NormalConformances.assign(scratch.begin(), scratch.end());
+        readOffsets(NormalConformances, blobData);
         break;
 
       default:
@@ -1139,11 +1173,23 @@ Status ModuleFile::associateWithFileContext(FileUnit *file,
 
 ModuleFile::~ModuleFile() = default;
 
+bool ModuleFile::DeclNameFilter::mayContain(Identifier name) const {
+  if (Bits.empty())
+    return true;
+  bool result = true;
+  index_block::forEachDeclNameFilterBit(name.str(), NumHashes,
+                                        Bits.size() * 8, [&](uint64_t bit) {
+    if (!(Bits[bit / 8] & (1 << (bit % 8))))
+      result = false;
+  });
+  return result;
+}
+
 void ModuleFile::lookupValue(DeclName name,
                              SmallVectorImpl<ValueDecl*> &results) {
   PrettyModuleFileDeserialization stackEntry(*this);
 
-  if (TopLevelDecls) {
+  if (TopLevelDecls && TopLevelDeclsFilter.mayContain(name.getBaseName())) {
     // Find top-level declarations with the given name.
     // FIXME: As a bit of a hack, do lookup by the simple name, then filter
     // compound decls, to avoid having to completely redo how modules are
@@ -1166,7 +1212,8 @@ void ModuleFile::lookupValue(DeclName name,
   }
 
   // If the name is an operator name, also look for operator methods.
-  if (name.isOperator() && OperatorMethodDecls) {
+  if (name.isOperator() && OperatorMethodDecls &&
+      OperatorMethodDeclsFilter.mayContain(name.getBaseName())) {
     auto iter = OperatorMethodDecls->find(name.getBaseName());
     if (iter != OperatorMethodDecls->end()) {
       for (auto item : *iter) {
@@ -1193,7 +1240,7 @@ TypeDecl *ModuleFile::lookupLocalType(StringRef MangledName) {
 OperatorDecl *ModuleFile::lookupOperator(Identifier name, DeclKind fixity) {
   PrettyModuleFileDeserialization stackEntry(*this);
 
-  if (!OperatorDecls)
+  if (!OperatorDecls || !OperatorDeclsFilter.mayContain(name))
     return nullptr;
 
   auto iter = OperatorDecls->find(name);
@@ -1317,6 +1364,8 @@ void ModuleFile::lookupVisibleDecls(Module::AccessPathTy accessPath,
     return;
 
   if (!accessPath.empty()) {
+    if (!TopLevelDeclsFilter.mayContain(accessPath.front().first))
+      return;
     auto iter = TopLevelDecls->find(accessPath.front().first);
     if (iter == TopLevelDecls->end())
       return;
@@ -1336,7 +1385,7 @@ void ModuleFile::lookupVisibleDecls(Module::AccessPathTy accessPath,
 
 void ModuleFile::loadExtensions(NominalTypeDecl *nominal) {
   PrettyModuleFileDeserialization stackEntry(*this);
-  if (!ExtensionDecls)
+  if (!ExtensionDecls || !ExtensionDeclsFilter.mayContain(nominal->getName()))
     return;
 
   auto iter = ExtensionDecls->find(nominal->getName());
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "serialization"
 #include "Serialization.h"
 #include "SILFormat.h"
 #include "swift/AST/AST.h"
@@ -31,6 +32,7 @@
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/Serialization/Validation.h"
 
 #include "clang/Basic/Module.h"
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -38,16 +40,20 @@
 #include "clang/Frontend/CompilerInstance.h"
 
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/RecordLayout.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
 
@@ -59,6 +65,9 @@ using namespace llvm::support;
 using swift::version::Version;
 using llvm::BCBlockRAII;
 
+STATISTIC(NumUnchangedInterfaces,
+          "Number of modules written with an unchanged interface");
+
 /// Used for static_assert.
 static constexpr bool declIDFitsIn32Bits() {
   using Int32Info = std::numeric_limits<uint32_t>;
@@ -475,6 +484,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
   BLOCK_RECORD(index_block, PRECEDENCE_GROUPS);
+  BLOCK_RECORD(index_block, DECL_NAME_FILTER);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -568,7 +578,8 @@ void Serializer::writeDocBlockInfoBlock() {
 #undef BLOCK_RECORD
 }
 
-void Serializer::writeHeader(const SerializationOptions &options) {
+void Serializer::writeHeader(const SerializationOptions &options,
+                             StringRef interfaceHash) {
   {
     BCBlockRAII restoreBlock(Out, CONTROL_BLOCK_ID, 3);
     control_block::ModuleNameLayout ModuleName(Out);
@@ -605,6 +616,11 @@ void Serializer::writeHeader(const SerializationOptions &options) {
         Strategy.emit(ScratchRecord, unsigned(M->getResilienceStrategy()));
       }
 
+      if (!interfaceHash.empty()) {
+        options_block::InterfaceHashLayout InterfaceHash(Out);
+        InterfaceHash.emit(ScratchRecord, interfaceHash);
+      }
+
       if (options.SerializeOptionsForDebugging) {
         options_block::SDKPathLayout SDKPath(Out);
         options_block::XCCLayout XCC(Out);
@@ -3359,7 +3375,18 @@ void Serializer::writeAllIdentifiers() {
 
 void Serializer::writeOffsets(const index_block::OffsetsLayout &Offsets,
                               const std::vector<BitOffset> &values) {
-  Offsets.emit(ScratchRecord, getOffsetRecordCode(values), values);
+  // Fixed-width offsets in a blob can be read straight out of the module
+  // file's buffer, without going through the bitstream reader one at a time.
+  SmallVector<char, 256> blob;
+  blob.reserve(values.size() * sizeof(uint32_t));
+  {
+    llvm::raw_svector_ostream blobStream(blob);
+    endian::Writer<little> writer(blobStream);
+    for (BitOffset offset : values)
+      writer.write<uint32_t>(offset);
+  }
+  Offsets.emit(ScratchRecord, getOffsetRecordCode(values),
+               StringRef(blob.data(), blob.size()));
 }
 
 /// Writes an in-memory decl table to an on-disk representation, using the
@@ -3387,6 +3414,32 @@ static void writeDeclTable(const index_block::DeclListLayout &DeclList,
   DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
+/// Writes a Bloom filter of the names in a decl table, so that lookups of
+/// names which aren't in the table can mostly skip probing it.
+static void
+writeDeclNameFilter(const index_block::DeclNameFilterLayout &DeclNameFilter,
+                    index_block::RecordKind kind,
+                    const Serializer::DeclTable &table) {
+  if (table.empty())
+    return;
+
+  // Ten bits and five hashes per name give about one percent of false
+  // positives.
+  const unsigned numHashes = 5;
+  uint64_t numBits = llvm::alignTo(std::max<uint64_t>(table.size() * 10, 64),
+                                   8);
+  std::string bits(numBits / 8, '\0');
+  for (auto &entry : table) {
+    index_block::forEachDeclNameFilterBit(entry.first.str(), numHashes,
+                                          numBits, [&](uint64_t bit) {
+      bits[bit / 8] |= 1 << (bit % 8);
+    });
+  }
+
+  SmallVector<uint64_t, 8> scratch;
+  DeclNameFilter.emit(scratch, kind, numHashes, bits);
+}
+
 static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
                                 index_block::RecordKind kind,
                                 LocalTypeHashTableGenerator &generator) {
@@ -4016,6 +4069,15 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
     writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
     writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
+
+    index_block::DeclNameFilterLayout DeclNameFilter(Out);
+    writeDeclNameFilter(DeclNameFilter, index_block::TOP_LEVEL_DECLS,
+                        topLevelDecls);
+    writeDeclNameFilter(DeclNameFilter, index_block::OPERATORS, operatorDecls);
+    writeDeclNameFilter(DeclNameFilter, index_block::EXTENSIONS,
+                        extensionDecls);
+    writeDeclNameFilter(DeclNameFilter, index_block::OPERATOR_METHODS,
+                        operatorMethodDecls);
     if (hasLocalTypes)
       writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
                           localTypeGenerator);
@@ -4037,7 +4099,11 @@ void Serializer::writeToStream(raw_ostream &os) {
 
 template <size_t N>
 Serializer::Serializer(const unsigned char (&signature)[N],
-                       ModuleOrSourceFile DC) {
+                       ModuleOrSourceFile DC, size_t sizeHint) {
+  // Growing a large buffer temporarily needs the memory of both the old and
+  // the new allocation, and copies everything written so far.
+  Buffer.reserve(sizeHint);
+
   for (unsigned char byte : signature)
     Out.Emit(byte, 8);
 
@@ -4048,17 +4114,19 @@ Serializer::Serializer(const unsigned char (&signature)[N],
 
 void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
                                const SILModule *SILMod,
-                               const SerializationOptions &options) {
-  Serializer S{MODULE_SIGNATURE, DC};
+                               const SerializationOptions &options,
+                               size_t sizeHint, StringRef interfaceHash) {
+  Serializer S{MODULE_SIGNATURE, DC, sizeHint};
 
   // FIXME: This is only really needed for debugging. We don't actually use it.
   S.writeBlockInfoBlock();
 
   {
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
-    S.writeHeader(options);
+    S.writeHeader(options, interfaceHash);
     S.writeInputBlock(options);
-    S.writeSIL(SILMod, options.SerializeAllSIL);
+    S.writeSIL(SILMod, options.SerializeAllSIL,
+               options.SerializeSmallFunctions);
     S.writeAST(DC);
   }
 
@@ -4066,8 +4134,9 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
 }
 
 void Serializer::writeDocToStream(raw_ostream &os, ModuleOrSourceFile DC,
-                                  StringRef GroupInfoPath, ASTContext &Ctx) {
-  Serializer S{MODULE_DOC_SIGNATURE, DC};
+                                  StringRef GroupInfoPath, ASTContext &Ctx,
+                                  size_t sizeHint) {
+  Serializer S{MODULE_DOC_SIGNATURE, DC, sizeHint};
   // FIXME: This is only really needed for debugging. We don't actually use it.
   S.writeDocBlockInfoBlock();
 
@@ -4132,6 +4201,136 @@ withOutputFile(ASTContext &ctx, StringRef outputPath,
   return false;
 }
 
+/// Returns the size of the existing file at \p path, which is a good estimate
+/// of the size of a new version of it, or 0 if there is no such file.
+static size_t getExistingOutputSize(StringRef path) {
+  uint64_t size;
+  if (llvm::sys::fs::file_size(path, size))
+    return 0;
+  // Leave some room for growth, so that a slightly larger output doesn't
+  // reallocate the whole buffer at the very end.
+  return size + size / 16;
+}
+
+namespace {
+/// An output stream which calculates the MD5 hash of the streamed data.
+class MD5Stream : public raw_ostream {
+  uint64_t Pos = 0;
+  llvm::MD5 Hash;
+
+  void write_impl(const char *Ptr, size_t Size) override {
+    Hash.update(ArrayRef<uint8_t>((const uint8_t *)Ptr, Size));
+    Pos += Size;
+  }
+
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  void final(llvm::MD5::MD5Result &Result) {
+    flush();
+    Hash.final(Result);
+  }
+};
+} // end anonymous namespace
+
+/// Prints the members of the types in \p D which determine the layout of the
+/// types in clients, even if the members themselves are not visible to
+/// clients: the stored properties, the enum cases and the vtable entries.
+static void printLayoutForClients(const Decl *D, raw_ostream &os) {
+  const IterableDeclContext *IDC;
+  if (auto *nominal = dyn_cast<NominalTypeDecl>(D))
+    IDC = nominal;
+  else if (auto *ext = dyn_cast<ExtensionDecl>(D))
+    IDC = ext;
+  else
+    return;
+
+  auto printMember = [&](StringRef kind, const ValueDecl *VD) {
+    os << kind << ' ' << VD->getFullName() << " : ";
+    if (VD->hasInterfaceType())
+      os << VD->getInterfaceType();
+    os << '\n';
+  };
+
+  bool isClass = isa<ClassDecl>(D);
+  for (const Decl *member : IDC->getMembers()) {
+    if (auto *var = dyn_cast<VarDecl>(member)) {
+      if (var->hasStorage() && !var->isStatic())
+        printMember("stored", var);
+    } else if (auto *elt = dyn_cast<EnumElementDecl>(member)) {
+      printMember("case", elt);
+    } else if (isClass && (isa<AbstractFunctionDecl>(member) ||
+                           isa<AbstractStorageDecl>(member))) {
+      printMember("member", cast<ValueDecl>(member));
+    }
+    printLayoutForClients(member, os);
+  }
+}
+
+/// Computes a hash of everything in the module \p M which its clients can
+/// depend on.
+///
+/// Changes to the implementation of the module which are not visible to
+/// clients, like the bodies of non-fragile functions and non-public
+/// declarations, don't change the hash. Internal declarations are included
+/// in a module which is compiled for testing.
+static void computeInterfaceHash(Module *M, const SILModule *SILMod,
+                                 const SerializationOptions &options,
+                                 SmallString<32> &result) {
+  SharedTimer timer("Serialization (interface hash)");
+  MD5Stream hashStream;
+
+  hashStream << version::getSwiftFullVersion(
+                    M->getASTContext().LangOpts.EffectiveLanguageVersion)
+             << '/' << VERSION_MAJOR << '.' << VERSION_MINOR << '\n';
+  hashStream << options.ModuleLinkName << '\n' << options.ImportedHeader
+             << '\n' << options.AutolinkForceLoad << '\n'
+             << unsigned(M->getResilienceStrategy()) << '\n';
+
+  PrintOptions printOpts = M->isTestingEnabled() ?
+      PrintOptions::printTestableInterface() : PrintOptions::printInterface();
+  // Documentation is serialized separately, and implicit, unavailable or
+  // underscored declarations are still visible to the clients' compiler.
+  printOpts.PrintDocumentationComments = false;
+  printOpts.PrintRegularClangComments = false;
+  printOpts.SkipUnavailable = false;
+  printOpts.SkipImplicit = false;
+  printOpts.SkipPrivateStdlibDecls = false;
+  printOpts.SkipUnderscoredStdlibProtocols = false;
+  printOpts.SkipDeinit = false;
+  printOpts.FunctionDefinitions = false;
+
+  SmallVector<Decl *, 32> topLevelDecls;
+  M->getTopLevelDecls(topLevelDecls);
+  for (const Decl *D : topLevelDecls) {
+    D->print(hashStream, printOpts);
+    hashStream << '\n';
+    // A non-resilient module exposes the layout of all of its types.
+    if (M->getResilienceStrategy() != ResilienceStrategy::Resilient)
+      printLayoutForClients(D, hashStream);
+  }
+
+  printSILForClients(SILMod, options.SerializeAllSIL,
+                     options.SerializeSmallFunctions, hashStream);
+
+  llvm::MD5::MD5Result hash;
+  hashStream.final(hash);
+  llvm::MD5::stringifyResult(hash, result);
+}
+
+/// Returns the interface hash which is recorded in the module file at
+/// \p path, or an empty string if there is none.
+static std::string getExistingInterfaceHash(StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return "";
+  ExtendedValidationInfo extendedInfo;
+  auto info = validateSerializedAST(buffer.get()->getBuffer(), &extendedInfo);
+  if (info.status != Status::Valid)
+    return "";
+  return extendedInfo.getInterfaceHash().str();
+}
+
 void swift::serialize(ModuleOrSourceFile DC,
                       const SerializationOptions &options,
                       const SILModule *M) {
@@ -4144,20 +4343,51 @@ void swift::serialize(ModuleOrSourceFile DC,
     return;
   }
 
+  // Only a complete module has an interface. The partial modules of single
+  // files are always rewritten.
+  SmallString<32> interfaceHash;
+  std::string oldInterfaceHash;
+  llvm::sys::fs::file_status oldStatus;
+  if (options.PreserveTimestampIfInterfaceUnchanged && DC.is<Module *>()) {
+    computeInterfaceHash(DC.get<Module *>(), M, options, interfaceHash);
+    if (!llvm::sys::fs::status(options.OutputPath, oldStatus))
+      oldInterfaceHash = getExistingInterfaceHash(options.OutputPath);
+  }
+
+  size_t moduleSizeHint = getExistingOutputSize(options.OutputPath);
   bool hadError = withOutputFile(getContext(DC), options.OutputPath,
                                  [&](raw_ostream &out) {
     SharedTimer timer("Serialization (swiftmodule)");
-    Serializer::writeToStream(out, DC, M, options);
+    Serializer::writeToStream(out, DC, M, options, moduleSizeHint,
+                              interfaceHash);
   });
   if (hadError)
     return;
 
+  // The new module is still written, because it also contains what only the
+  // debugger sees. But if clients can't observe any difference, the file
+  // keeps its old modification time, so that dependency checks of the
+  // clients don't consider them out of date.
+  if (!interfaceHash.empty() && interfaceHash.str() == oldInterfaceHash) {
+    DEBUG(llvm::dbgs() << options.OutputPath << ": interface unchanged ("
+                       << interfaceHash << ")\n");
+    ++NumUnchangedInterfaces;
+    int fd;
+    if (!llvm::sys::fs::openFileForWrite(options.OutputPath, fd,
+                                         llvm::sys::fs::F_Append)) {
+      (void)llvm::sys::fs::setLastModificationAndAccessTime(
+          fd, oldStatus.getLastModificationTime());
+      llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+  }
+
   if (options.DocOutputPath && options.DocOutputPath[0] != '\0') {
+    size_t docSizeHint = getExistingOutputSize(options.DocOutputPath);
     (void)withOutputFile(getContext(DC), options.DocOutputPath,
                          [&](raw_ostream &out) {
       SharedTimer timer("Serialization (swiftdoc)");
       Serializer::writeDocToStream(out, DC, options.GroupInfoPath,
-                                   getContext(DC));
+                                   getContext(DC), docSizeHint);
     });
   }
 }
@@ -227,7 +227,11 @@ private:
 
   /// Writes the Swift module file header and name, plus metadata determining
   /// if the module can be loaded.
-  void writeHeader(const SerializationOptions &options = {});
+  ///
+  /// \param interfaceHash The hash of the module's interface, which is
+  /// recorded if not empty.
+  void writeHeader(const SerializationOptions &options = {},
+                   StringRef interfaceHash = StringRef());
 
   /// Writes the Swift doc module file header and name.
   void writeDocHeader();
@@ -331,25 +335,37 @@ private:
                     const std::vector<BitOffset> &values);
 
   /// Serializes all transparent SIL functions in the SILModule.
-  void writeSIL(const SILModule *M, bool serializeAllSIL);
+  void writeSIL(const SILModule *M, bool serializeAllSIL,
+                bool serializeSmallFunctions);
 
   /// Top-level entry point for serializing a module.
   void writeAST(ModuleOrSourceFile DC);
 
   void writeToStream(raw_ostream &os);
 
+  /// \param sizeHint The expected size of the output in bytes, which is
+  /// reserved up front so that the buffer doesn't have to grow repeatedly.
   template <size_t N>
-  Serializer(const unsigned char (&signature)[N], ModuleOrSourceFile DC);
+  Serializer(const unsigned char (&signature)[N], ModuleOrSourceFile DC,
+             size_t sizeHint);
 
 public:
   /// Serialize a module to the given stream.
+  ///
+  /// \param sizeHint The expected size of the module in bytes, e.g. the size
+  /// of the previous version of the module, or 0 if unknown.
+  /// \param interfaceHash The hash of the module's interface, which is
+  /// recorded in the module if not empty.
   static void writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
                             const SILModule *M,
-                            const SerializationOptions &options);
+                            const SerializationOptions &options,
+                            size_t sizeHint = 0,
+                            StringRef interfaceHash = StringRef());
 
   /// Serialize module documentation to the given stream.
   static void writeDocToStream(raw_ostream &os, ModuleOrSourceFile DC,
-                               StringRef GroupInfoPath, ASTContext &Ctx);
+                               StringRef GroupInfoPath, ASTContext &Ctx,
+                               size_t sizeHint = 0);
 
   /// Records the use of the given Type.
   ///
@@ -421,6 +437,15 @@ public:
                          const std::array<unsigned, 256> &abbrCodes);
 
 };
+
+/// Prints everything in \p SILMod which is serialized for clients of the
+/// module with the given options: the serialized function bodies, the effects
+/// of public functions and the serialized tables and globals.
+///
+/// This is used to compute the interface hash of the module.
+void printSILForClients(const SILModule *SILMod, bool serializeAllSIL,
+                        bool serializeSmallFunctions, raw_ostream &os);
+
 } // end namespace serialization
 } // end namespace swift
 #endif
@@ -181,6 +181,13 @@ namespace {
 
     bool ShouldSerializeAll;
 
+    /// Also serialize the bodies of small public functions, so that client
+    /// modules can inline and specialize them.
+    bool ShouldSerializeSmallFunctions;
+
+    /// Caches the result of isSmallFunctionForClients.
+    llvm::DenseMap<const SILFunction *, bool> SmallFunctions;
+
     void addMandatorySILFunction(const SILFunction *F,
                                  bool emitDeclarationsForOnoneSupport);
     void addReferencedSILFunction(const SILFunction *F,
@@ -221,10 +228,17 @@ namespace {
     /// deserialization if the function body for F should be deserialized.
     bool shouldEmitFunctionBody(const SILFunction *F);
 
+    /// Returns true if F is small enough and only refers to declarations
+    /// which are visible to clients, so that its body can be serialized
+    /// for cross-module optimization.
+    bool isSmallFunctionForClients(const SILFunction *F);
+
   public:
     SILSerializer(Serializer &S, ASTContext &Ctx,
-                  llvm::BitstreamWriter &Out, bool serializeAll)
-      : S(S), Ctx(Ctx), Out(Out), ShouldSerializeAll(serializeAll) {}
+                  llvm::BitstreamWriter &Out, bool serializeAll,
+                  bool serializeSmallFunctions)
+      : S(S), Ctx(Ctx), Out(Out), ShouldSerializeAll(serializeAll),
+        ShouldSerializeSmallFunctions(serializeSmallFunctions) {}
 
     void writeSILModule(const SILModule *SILMod);
   };
@@ -353,12 +367,22 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     clangNodeOwnerID = S.addDeclRef(F.getClangNodeOwner());
 
   unsigned numSpecAttrs = NoBody ? 0 : F.getSpecializeAttrs().size();
+
+  // The size of the body lets clients decide if they want to deserialize it
+  // before they actually do.
+  unsigned numInstructions = 0;
+  if (!NoBody) {
+    for (const SILBasicBlock &BB : F)
+      numInstructions += std::distance(BB.begin(), BB.end());
+  }
+
   SILFunctionLayout::emitRecord(
       Out, ScratchRecord, abbrCode, toStableSILLinkage(Linkage),
       (unsigned)F.isTransparent(), (unsigned)F.isFragile(),
       (unsigned)F.isThunk(), (unsigned)F.isGlobalInit(),
       (unsigned)F.getInlineStrategy(), (unsigned)F.getEffectsKind(),
-      (unsigned)numSpecAttrs, FnID, clangNodeOwnerID, SemanticsIDs);
+      (unsigned)numSpecAttrs, numInstructions, FnID, clangNodeOwnerID,
+      SemanticsIDs);
 
   if (NoBody)
     return;
@@ -1832,9 +1856,177 @@ bool SILSerializer::shouldEmitFunctionBody(const SILFunction *F) {
   if (F->isFragile())
     return true;
 
+  if (ShouldSerializeSmallFunctions && isSmallFunctionForClients(F))
+    return true;
+
   return false;
 }
 
+/// The maximum number of instructions of a non-generic function which is
+/// serialized with -sil-serialize-small-functions. Generic functions, which
+/// benefit a lot more from being specialized in the client, may be twice as
+/// large.
+static const unsigned SmallFunctionSizeLimit = 32;
+
+/// Returns true if \p ty only refers to nominal types which are public.
+static bool isVisibleToClients(Type ty) {
+  return !ty.findIf([](Type t) -> bool {
+    auto *NTD = t->getAnyNominal();
+    return NTD && NTD->getEffectiveAccess() != Accessibility::Public;
+  });
+}
+
+static bool isVisibleToClients(const ValueDecl *D) {
+  return D->getEffectiveAccess() == Accessibility::Public;
+}
+
+/// Returns true if the protocols of all of \p conformances are public.
+static bool
+isVisibleToClients(ArrayRef<ProtocolConformanceRef> conformances) {
+  for (auto conformance : conformances) {
+    if (!isVisibleToClients(conformance.getRequirement()))
+      return false;
+  }
+  return true;
+}
+
+/// Returns true if the replacement types of \p subs, and the protocols they
+/// conform to, are public.
+static bool isVisibleToClients(ArrayRef<Substitution> subs) {
+  for (const Substitution &sub : subs) {
+    if (!isVisibleToClients(sub.getReplacement()) ||
+        !isVisibleToClients(sub.getConformances()))
+      return false;
+  }
+  return true;
+}
+
+/// Returns true if a reference to \p F from a client module can be resolved.
+static bool isVisibleToClients(const SILFunction *F) {
+  if (F->isFragile())
+    return true;
+  return hasPublicVisibility(F->getLinkage()) &&
+         !hasSharedVisibility(F->getLinkage());
+}
+
+/// Returns true if \p F is small enough and only refers to declarations which
+/// are visible to clients. This is the uncached implementation of
+/// SILSerializer::isSmallFunctionForClients.
+static bool isSmallFunctionBodyForClients(const SILFunction *F) {
+  if (F->getLinkage() != SILLinkage::Public || F->isExternalDeclaration())
+    return false;
+
+  // Clients of a resilient module must not depend on the implementation of
+  // its functions.
+  if (F->getModule().getSwiftModule()->getResilienceStrategy() ==
+        ResilienceStrategy::Resilient)
+    return false;
+
+  auto FnTy = F->getLoweredFunctionType();
+  unsigned Limit = SmallFunctionSizeLimit;
+  if (FnTy->isPolymorphic())
+    Limit *= 2;
+
+  unsigned Size = 0;
+  for (auto &BB : *F) {
+    for (SILValue Arg : BB.getBBArgs()) {
+      if (!isVisibleToClients(Arg->getType().getSwiftRValueType()))
+        return false;
+    }
+    for (auto &I : BB) {
+      if (++Size > Limit)
+        return false;
+
+      // Both the values and the declarations an instruction refers to
+      // must be accessible from the client.
+      if (I.hasValue() &&
+          !isVisibleToClients(I.getType().getSwiftRValueType()))
+        return false;
+      for (const Operand &Op : I.getAllOperands()) {
+        if (!isVisibleToClients(Op.get()->getType().getSwiftRValueType()))
+          return false;
+      }
+
+      // So must the types and conformances an instruction is parameterized
+      // with, which don't necessarily appear in any value's type.
+      if (ApplySite AS = ApplySite::isa(&I)) {
+        if (!isVisibleToClients(AS.getSubstitutions()))
+          return false;
+      } else if (auto *BI = dyn_cast<BuiltinInst>(&I)) {
+        if (!isVisibleToClients(BI->getSubstitutions()))
+          return false;
+      } else if (auto *IBSHI = dyn_cast<InitBlockStorageHeaderInst>(&I)) {
+        if (!isVisibleToClients(IBSHI->getSubstitutions()))
+          return false;
+      } else if (auto *WMI = dyn_cast<WitnessMethodInst>(&I)) {
+        if (!isVisibleToClients(WMI->getLookupType()))
+          return false;
+      } else if (auto *IEAI = dyn_cast<InitExistentialAddrInst>(&I)) {
+        if (!isVisibleToClients(IEAI->getFormalConcreteType()) ||
+            !isVisibleToClients(IEAI->getConformances()))
+          return false;
+      } else if (auto *IERI = dyn_cast<InitExistentialRefInst>(&I)) {
+        if (!isVisibleToClients(IERI->getFormalConcreteType()) ||
+            !isVisibleToClients(IERI->getConformances()))
+          return false;
+      } else if (auto *IEMI = dyn_cast<InitExistentialMetatypeInst>(&I)) {
+        if (!isVisibleToClients(IEMI->getConformances()))
+          return false;
+      } else if (auto *AEBI = dyn_cast<AllocExistentialBoxInst>(&I)) {
+        if (!isVisibleToClients(AEBI->getFormalConcreteType()) ||
+            !isVisibleToClients(AEBI->getConformances()))
+          return false;
+      } else if (auto *UCCAI = dyn_cast<UnconditionalCheckedCastAddrInst>(&I)) {
+        if (!isVisibleToClients(UCCAI->getSourceType()) ||
+            !isVisibleToClients(UCCAI->getTargetType()))
+          return false;
+      } else if (auto *CCABI = dyn_cast<CheckedCastAddrBranchInst>(&I)) {
+        if (!isVisibleToClients(CCABI->getSourceType()) ||
+            !isVisibleToClients(CCABI->getTargetType()))
+          return false;
+      } else if (auto *URCAI = dyn_cast<UncheckedRefCastAddrInst>(&I)) {
+        if (!isVisibleToClients(URCAI->getSourceType()) ||
+            !isVisibleToClients(URCAI->getTargetType()))
+          return false;
+      } else if (auto *ARI = dyn_cast<AllocRefInstBase>(&I)) {
+        for (SILType TailType : ARI->getTailAllocatedTypes()) {
+          if (!isVisibleToClients(TailType.getSwiftRValueType()))
+            return false;
+        }
+      }
+
+      if (auto *FRI = dyn_cast<FunctionRefInst>(&I)) {
+        if (!isVisibleToClients(FRI->getReferencedFunction()))
+          return false;
+      } else if (auto *GAI = dyn_cast<GlobalAddrInst>(&I)) {
+        if (!hasPublicVisibility(GAI->getReferencedGlobal()->getLinkage()))
+          return false;
+      } else if (auto *AGI = dyn_cast<AllocGlobalInst>(&I)) {
+        if (!hasPublicVisibility(AGI->getReferencedGlobal()->getLinkage()))
+          return false;
+      } else if (auto *MI = dyn_cast<MethodInst>(&I)) {
+        if (!isVisibleToClients(MI->getMember().getDecl()))
+          return false;
+      } else if (auto *REAI = dyn_cast<RefElementAddrInst>(&I)) {
+        // The field offset of a non-public field is not exported.
+        if (!isVisibleToClients(REAI->getField()))
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SILSerializer::isSmallFunctionForClients(const SILFunction *F) {
+  auto iter = SmallFunctions.find(F);
+  if (iter != SmallFunctions.end())
+    return iter->second;
+
+  bool Result = isSmallFunctionBodyForClients(F);
+  SmallFunctions[F] = Result;
+  return Result;
+}
+
 void SILSerializer::writeSILBlock(const SILModule *SILMod) {
   BCBlockRAII subBlock(Out, SIL_BLOCK_ID, 6);
 
@@ -1936,6 +2128,17 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
     processSILFunctionWorklist();
   }
 
+  // Public functions with an effects attribute are emitted as declarations
+  // even if they are not referenced, so that clients can use the effects
+  // of a call to such a function.
+  if (!emitDeclarationsForOnoneSupport) {
+    for (const SILFunction &F : *SILMod) {
+      if (F.hasEffectsKind() && F.isDefinition() &&
+          F.getLinkage() == SILLinkage::Public && !FuncsToEmit.count(&F))
+        FuncsToEmit[&F] = true;
+    }
+  }
+
   // Now write function declarations for every function we've
   // emitted a reference to without emitting a function body for.
   for (const SILFunction &F : *SILMod) {
@@ -1956,10 +2159,62 @@ void SILSerializer::writeSILModule(const SILModule *SILMod) {
   writeIndexTables();
 }
 
-void Serializer::writeSIL(const SILModule *SILMod, bool serializeAllSIL) {
+void Serializer::writeSIL(const SILModule *SILMod, bool serializeAllSIL,
+                          bool serializeSmallFunctions) {
   if (!SILMod)
     return;
 
-  SILSerializer SILSer(*this, M->getASTContext(), Out, serializeAllSIL);
+  SILSerializer SILSer(*this, M->getASTContext(), Out, serializeAllSIL,
+                       serializeSmallFunctions);
   SILSer.writeSILModule(SILMod);
 }
+
+void serialization::printSILForClients(const SILModule *SILMod,
+                                       bool serializeAllSIL,
+                                       bool serializeSmallFunctions,
+                                       raw_ostream &os) {
+  if (!SILMod)
+    return;
+
+  // This mirrors what SILSerializer::writeSILBlock writes, except for
+  // anything which only the module itself can refer to.
+  const DeclContext *assocDC = SILMod->getAssociatedContext();
+  for (const SILGlobalVariable &g : SILMod->getSILGlobals()) {
+    if (serializeAllSIL || g.isFragile() || hasPublicVisibility(g.getLinkage()))
+      g.print(os);
+  }
+
+  if (serializeAllSIL) {
+    for (const SILVTable &vt : SILMod->getVTables()) {
+      if (vt.getClass()->isChildContextOf(assocDC))
+        vt.print(os);
+    }
+  }
+
+  for (const SILWitnessTable &wt : SILMod->getWitnessTables()) {
+    if ((serializeAllSIL || wt.isFragile()) &&
+        wt.getConformance()->getDeclContext()->isChildContextOf(assocDC))
+      wt.print(os);
+  }
+
+  for (const SILDefaultWitnessTable &wt : SILMod->getDefaultWitnessTables()) {
+    if (!wt.isDeclaration() &&
+        wt.getProtocol()->getDeclContext()->isChildContextOf(assocDC))
+      wt.print(os);
+  }
+
+  for (const SILFunction &F : *SILMod) {
+    if (F.isExternalDeclaration())
+      continue;
+    if (serializeAllSIL || F.isFragile() ||
+        (serializeSmallFunctions && isSmallFunctionBodyForClients(&F))) {
+      F.print(os);
+      continue;
+    }
+    // Only the effects of other public functions are visible to clients.
+    if (F.hasEffectsKind() && F.getLinkage() == SILLinkage::Public) {
+      os << F.getName() << " effects " << unsigned(F.getEffectsKind()) << " : "
+         << F.getLoweredType() << '\n';
+    }
+  }
+}
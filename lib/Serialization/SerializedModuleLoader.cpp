@@ -19,6 +19,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
@@ -46,8 +47,14 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   // module documentation file.
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
+  // The bitstream reader doesn't need a null terminator. Not asking for one
+  // lets the file always be mapped rather than copied when its size happens
+  // to be a multiple of the page size, so pages are shared between processes
+  // and only the parts that get deserialized are ever read in.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +63,9 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -67,11 +76,36 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   return std::error_code();
 }
 
-static bool
-findModule(ASTContext &ctx, AccessPathElem moduleID,
-           std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
-           std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
-           bool &isFramework) {
+bool SerializedModuleLoader::searchPathMayContain(StringRef dirName,
+                                                  StringRef name) {
+  if (!Ctx.SearchPathOpts.CacheSearchPathContents)
+    return true;
+
+  auto found = SearchPathContents.find(dirName);
+  if (found == SearchPathContents.end()) {
+    // Read the whole directory once, which is much cheaper than a failed
+    // open() for each import, in particular on network file systems.
+    std::unique_ptr<llvm::StringSet<>> contents(new llvm::StringSet<>());
+    std::error_code err;
+    for (llvm::sys::fs::directory_iterator i(dirName, err), e;
+         i != e && !err; i.increment(err))
+      contents->insert(llvm::sys::path::filename(i->path()));
+    // A search path which doesn't exist contains nothing, but if it couldn't
+    // be read for another reason, fall back to looking for each module.
+    if (err && err != std::errc::no_such_file_or_directory)
+      contents.reset();
+    found = SearchPathContents.insert({dirName, std::move(contents)}).first;
+  }
+
+  return !found->second || found->second->count(name);
+}
+
+bool SerializedModuleLoader::findModule(
+    AccessPathElem moduleID,
+    std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
+    std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
+    bool &isFramework) {
+  ASTContext &ctx = Ctx;
   llvm::SmallString<64> moduleFilename(moduleID.first.str());
   moduleFilename += '.';
   moduleFilename += SERIALIZED_MODULE_EXTENSION;
@@ -98,6 +132,8 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
 
   isFramework = false;
   for (auto path : ctx.SearchPathOpts.ImportSearchPaths) {
+    if (!searchPathMayContain(path, moduleFilename))
+      continue;
     auto err = openModuleFiles(path,
                                moduleFilename.str(), moduleDocFilename.str(),
                                moduleBuffer, moduleDocBuffer,
@@ -120,6 +156,8 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
     isFramework = true;
 
     for (auto path : ctx.SearchPathOpts.FrameworkSearchPaths) {
+      if (!searchPathMayContain(path, moduleFramework))
+        continue;
       currPath = path;
       llvm::sys::path::append(currPath, moduleFramework.str(),
                               "Modules", moduleFilename.str());
@@ -138,6 +176,9 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
 
   // Search the runtime import path.
   isFramework = false;
+  if (!searchPathMayContain(ctx.SearchPathOpts.RuntimeLibraryImportPath,
+                            moduleFilename))
+    return false;
   return !openModuleFiles(ctx.SearchPathOpts.RuntimeLibraryImportPath,
                           moduleFilename.str(), moduleDocFilename.str(),
                           moduleBuffer, moduleDocBuffer, scratch);
@@ -378,7 +419,7 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
 
   // Otherwise look on disk.
   if (!moduleInputBuffer) {
-    if (!findModule(Ctx, moduleID, moduleInputBuffer, moduleDocInputBuffer,
+    if (!findModule(moduleID, moduleInputBuffer, moduleDocInputBuffer,
                     isFramework)) {
       return nullptr;
     }
@@ -115,6 +115,14 @@ bool SerializedSILLoader::hasSILFunction(StringRef Name, SILLinkage Linkage) {
   return retVal;
 }
 
+Optional<unsigned>
+SerializedSILLoader::getSILFunctionBodySize(StringRef Name) {
+  for (auto &Des : LoadedSILSections) {
+    if (auto Size = Des->getSILFunctionBodySize(Name))
+      return Size;
+  }
+  return None;
+}
 
 SILVTable *SerializedSILLoader::lookupVTable(Identifier Name) {
   for (auto &Des : LoadedSILSections) {
@@ -96,6 +96,34 @@ lookupSuperclass(const TypeRef *TR) {
   return Superclass->subst(*this, TR->getSubstMap());
 }
 
+void TypeRefBuilder::indexReflectionInfos() {
+  for (; NumIndexedReflectionInfos < ReflectionInfos.size();
+       ++NumIndexedReflectionInfos) {
+    auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    for (auto &FD : Info.fieldmd) {
+      if (FD.hasMangledTypeName())
+        FieldTypeInfoIndex.insert({FD.getMangledTypeName(), &FD});
+    }
+
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (BuiltinTypeDescriptor.hasMangledTypeName())
+        BuiltinTypeInfoIndex.insert({BuiltinTypeDescriptor.getMangledTypeName(),
+                                     &BuiltinTypeDescriptor});
+    }
+
+    for (auto &CD : Info.capture) {
+      auto RemoteAddr = ((uintptr_t) &CD -
+                         Info.LocalStartAddress +
+                         Info.RemoteStartAddress);
+      CaptureDescriptorIndex.insert({RemoteAddr, &CD});
+    }
+  }
+}
+
 const FieldDescriptor *
 TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   std::string MangledName;
@@ -108,19 +136,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = FieldTypeInfoIndex.find(MangledName);
+  if (Found == FieldTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 std::vector<FieldTypeInfo>
@@ -168,36 +188,20 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = BuiltinTypeInfoIndex.find(MangledName);
+  if (Found == BuiltinTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 const CaptureDescriptor *
 TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
-  for (auto Info : ReflectionInfos) {
-    for (auto &CD : Info.capture) {
-      auto OtherAddr = ((uintptr_t) &CD -
-                        Info.LocalStartAddress +
-                        Info.RemoteStartAddress);
-      if (OtherAddr == RemoteAddress)
-        return &CD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = CaptureDescriptorIndex.find(RemoteAddress);
+  if (Found == CaptureDescriptorIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 /// Get the unsubstituted capture types for a closure context.
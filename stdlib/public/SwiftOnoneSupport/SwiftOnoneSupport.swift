@@ -157,6 +157,46 @@ struct _Prespecialize {
     }
     return count
   }
+
+  // Create specializations for dictionaries and sets of the most popular
+  // key and element types.
+  static internal func _specializeHashedCollections() {
+    func _createDictionaryUser<Key : Hashable, Value>(
+      _ sampleKey: Key, _ sampleValue: Value
+    ) {
+      var d = [Key: Value](minimumCapacity: 1)
+      d[sampleKey] = sampleValue
+      let _ = d[sampleKey]
+      let _ = d.updateValue(sampleValue, forKey: sampleKey)
+      let _ = d.count
+      for (k, v) in d {
+        print(k)
+        print(v)
+      }
+      let _ = d.removeValue(forKey: sampleKey)
+      d.removeAll()
+    }
+
+    func _createSetUser<Element : Hashable>(_ sampleValue: Element) {
+      var s = Set<Element>(minimumCapacity: 1)
+      s.insert(sampleValue)
+      let _ = s.contains(sampleValue)
+      let _ = s.count
+      for e in s {
+        print(e)
+      }
+      let _ = s.remove(sampleValue)
+      s.removeAll()
+    }
+
+    _createDictionaryUser(1 as Int, 1 as Int)
+    _createDictionaryUser("a" as String, 1 as Int)
+    _createDictionaryUser("a" as String, "a" as String)
+    _createDictionaryUser("a" as String, 1 as Any)
+
+    _createSetUser(1 as Int)
+    _createSetUser("a" as String)
+  }
 }
 
 // Mark with optimize.sil.never to make sure its not get
@@ -165,4 +205,5 @@ struct _Prespecialize {
 internal func _swift_forcePrespecializations() {
   _Prespecialize._specializeArrays()
   _Prespecialize._specializeRanges()
+  _Prespecialize._specializeHashedCollections()
 }
@@ -266,6 +266,31 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
   return convertChild(TI, Index);
 }
 
+void
+swift_reflection_typeRefsForInstances(SwiftReflectionContextRef ContextRef,
+                                      const uintptr_t *Objects,
+                                      size_t Count,
+                                      swift_typeref_t *OutTypeRefs) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  for (size_t i = 0; i < Count; ++i) {
+    auto MetadataAddress = Context->readMetadataFromInstance(Objects[i]);
+    const TypeRef *TR = nullptr;
+    if (MetadataAddress.first)
+      TR = Context->readTypeFromMetadata(MetadataAddress.second);
+    OutTypeRefs[i] = reinterpret_cast<swift_typeref_t>(TR);
+  }
+}
+
+void
+swift_reflection_infosForInstances(SwiftReflectionContextRef ContextRef,
+                                   const uintptr_t *Objects,
+                                   size_t Count,
+                                   swift_typeinfo_t *OutInfos) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  for (size_t i = 0; i < Count; ++i)
+    OutInfos[i] = convertTypeInfo(Context->getInstanceTypeInfo(Objects[i]));
+}
+
 int swift_reflection_projectExistential(SwiftReflectionContextRef ContextRef,
                                         swift_addr_t ExistentialAddress,
                                         swift_typeref_t ExistentialTypeRef,
@@ -56,6 +56,12 @@ int _swift_stdlib_putc_stderr(int C);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// Return the length of the longest prefix of the \p length bytes at
+/// \p bytes that is ASCII, checking many bytes at a time.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_size_t _swift_stdlib_asciiPrefixLength(const unsigned char *bytes,
+                                               __swift_size_t length);
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
@@ -186,6 +186,19 @@ func _decodeCString<Encoding : UnicodeCodec>(
   repairingInvalidCodeUnits isRepairing: Bool = true)
 -> (result: String, repairsMade: Bool)? {
 
+  // Most C strings are UTF-8 that is entirely ASCII. Those can be copied
+  // straight into narrow storage without decoding them twice.
+  if encoding == UTF8.self {
+    let bytes = UnsafeRawPointer(cString).assumingMemoryBound(to: UInt8.self)
+    if Int(_swift_stdlib_asciiPrefixLength(bytes, numericCast(length)))
+      == length {
+      let stringBuffer = _StringBuffer(
+        capacity: length, initialSize: length, elementWidth: 1)
+      stringBuffer.start.copyBytes(from: bytes, count: length)
+      return (result: String(_storage: stringBuffer), repairsMade: false)
+    }
+  }
+
   let buffer = UnsafeBufferPointer<Encoding.CodeUnit>(
     start: cString, count: length)
 
@@ -147,6 +147,22 @@ func _mixInt(_ value: Int) -> Int {
 #endif
 }
 
+/// Returns a hash value that combines `firstValue` and `secondValue`.
+///
+/// This is meant for the `hashValue` of types with several stored
+/// properties. Unlike combining the hash values with `^` or a multiply and
+/// xor, the result depends on the order of the values, equal values don't
+/// cancel out, and every bit of the inputs affects the whole result.
+@_transparent
+public // SPI
+func _combineHashValues(_ firstValue: Int, _ secondValue: Int) -> Int {
+  let seed: UInt64 = _HashingDetail.getExecutionSeed()
+  let low = UInt64(UInt(bitPattern: firstValue))
+  let high = UInt64(UInt(bitPattern: secondValue))
+  return Int(truncatingBitPattern:
+    _HashingDetail.hash16Bytes(seed &+ low, high))
+}
+
 /// Given a hash value, returns an integer value in the range of
 /// 0..<`upperBound` that corresponds to a hash value.
 ///
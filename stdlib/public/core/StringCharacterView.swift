@@ -252,6 +252,18 @@ extension String.CharacterView : BidirectionalCollection {
     }
     
     let startIndexUTF16 = start._position
+
+    // Fast path: there is a boundary between any two ASCII scalars other than
+    // CR LF, so mostly-ASCII text rarely needs the property trie.
+    if startIndexUTF16 + 1 < end._position {
+      let cu0 = _core[startIndexUTF16]
+      let cu1 = _core[startIndexUTF16 + 1]
+      if cu0 < 0x80 && cu1 < 0x80 &&
+        !(cu0 == _ascii16("\r") && cu1 == _ascii16("\n")) {
+        return 1
+      }
+    }
+
     let graphemeClusterBreakProperty =
       _UnicodeGraphemeClusterBreakPropertyTrie()
     let segmenter = _UnicodeExtendedGraphemeClusterSegmenter()
@@ -294,6 +306,17 @@ extension String.CharacterView : BidirectionalCollection {
     }
     
     let endIndexUTF16 = end._position
+
+    // Fast path: see _measureExtendedGraphemeClusterForward.
+    if endIndexUTF16 >= 2 {
+      let cu0 = _core[endIndexUTF16 - 2]
+      let cu1 = _core[endIndexUTF16 - 1]
+      if cu0 < 0x80 && cu1 < 0x80 &&
+        !(cu0 == _ascii16("\r") && cu1 == _ascii16("\n")) {
+        return 1
+      }
+    }
+
     let graphemeClusterBreakProperty =
       _UnicodeGraphemeClusterBreakPropertyTrie()
     let segmenter = _UnicodeExtendedGraphemeClusterSegmenter()
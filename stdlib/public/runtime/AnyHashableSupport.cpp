@@ -41,10 +41,15 @@ struct HashableConformanceEntry {
   /// don't have to deal with cache invalidation.
   const Metadata *baseTypeThatConformsToHashable;
 
+  /// The `Hashable` witness table of `derivedType`.  Always non-NULL.
+  const HashableWitnessTable *hashableConformance;
+
   HashableConformanceEntry(HashableConformanceKey key,
-                           const Metadata *baseTypeThatConformsToHashable)
+                           const Metadata *baseTypeThatConformsToHashable,
+                           const HashableWitnessTable *hashableConformance)
       : derivedType(key.derivedType),
-        baseTypeThatConformsToHashable(baseTypeThatConformsToHashable) {}
+        baseTypeThatConformsToHashable(baseTypeThatConformsToHashable),
+        hashableConformance(hashableConformance) {}
 
   int compareWithKey(const HashableConformanceKey &key) const {
     if (key.derivedType != derivedType) {
@@ -56,7 +61,8 @@ struct HashableConformanceEntry {
 
   static size_t
   getExtraAllocationSize(HashableConformanceKey key,
-                         const Metadata *baseTypeThatConformsToHashable) {
+                         const Metadata *baseTypeThatConformsToHashable,
+                         const HashableWitnessTable *hashableConformance) {
     return 0;
   }
 
@@ -71,16 +77,19 @@ struct HashableConformanceEntry {
 static ConcurrentMap<HashableConformanceEntry, /*Destructor*/ false>
 HashableConformances;
 
-template<bool KnownToConformToHashable>
-LLVM_ATTRIBUTE_ALWAYS_INLINE
-static const Metadata *findHashableBaseTypeImpl(const Metadata *type) {
+/// Find the cache entry of a type, creating it if the type conforms to
+/// `Hashable`.  Lookups of types which are already in the cache don't take
+/// any locks.
+static const HashableConformanceEntry *
+findHashableConformanceEntry(const Metadata *type) {
   // Check the cache first.
   if (HashableConformanceEntry *entry =
           HashableConformances.find(HashableConformanceKey{type})) {
-    return entry->baseTypeThatConformsToHashable;
+    return entry;
   }
-  if (!KnownToConformToHashable &&
-      !swift_conformsToProtocol(type, &HashableProtocolDescriptor)) {
+  auto hashableConformance = reinterpret_cast<const HashableWitnessTable *>(
+      swift_conformsToProtocol(type, &HashableProtocolDescriptor));
+  if (!hashableConformance) {
     // Don't cache the negative response because we don't invalidate
     // this cache when a new conformance is loaded dynamically.
     return nullptr;
@@ -97,9 +106,9 @@ static const Metadata *findHashableBaseTypeImpl(const Metadata *type) {
       break;
     baseTypeThatConformsToHashable = superclass;
   }
-  HashableConformances.getOrInsert(HashableConformanceKey{type},
-                                   baseTypeThatConformsToHashable);
-  return baseTypeThatConformsToHashable;
+  return HashableConformances.getOrInsert(HashableConformanceKey{type},
+                                          baseTypeThatConformsToHashable,
+                                          hashableConformance).first;
 }
 
 /// Find the base type that introduces the `Hashable` conformance.
@@ -109,17 +118,27 @@ static const Metadata *findHashableBaseTypeImpl(const Metadata *type) {
 /// - Precondition: `type` conforms to `Hashable` (not checked).
 const Metadata *swift::hashable_support::findHashableBaseTypeOfHashableType(
     const Metadata *type) {
-  auto result =
-    findHashableBaseTypeImpl</*KnownToConformToHashable=*/ true>(type);
-  assert(result && "Known-hashable types should have a `Hashable` conformance.");
-  return result;
+  auto entry = findHashableConformanceEntry(type);
+  assert(entry && "Known-hashable types should have a `Hashable` conformance.");
+  return entry->baseTypeThatConformsToHashable;
 }
 
 /// Find the base type that introduces the `Hashable` conformance.
 /// If `type` does not conform to `Hashable`, `nullptr` is returned.
 const Metadata *swift::hashable_support::findHashableBaseType(
     const Metadata *type) {
-  return findHashableBaseTypeImpl</*KnownToConformToHashable=*/ false>(type);
+  if (auto entry = findHashableConformanceEntry(type))
+    return entry->baseTypeThatConformsToHashable;
+  return nullptr;
+}
+
+/// Find the `Hashable` witness table of `type`.
+/// If `type` does not conform to `Hashable`, `nullptr` is returned.
+const HashableWitnessTable *swift::hashable_support::findHashableConformance(
+    const Metadata *type) {
+  if (auto entry = findHashableConformanceEntry(type))
+    return entry->hashableConformance;
+  return nullptr;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -152,8 +171,8 @@ extern "C" void _swift_stdlib_makeAnyHashableUpcastingToHashableBaseType(
       std::tie(unboxedType, unboxedValue) =
           getValueFromSwiftValue(srcSwiftValue);
 
-      if (auto unboxedHashableWT =
-              swift_conformsToProtocol(type, &HashableProtocolDescriptor)) {
+      if (auto unboxedHashableWT = reinterpret_cast<const WitnessTable *>(
+              findHashableConformance(unboxedType))) {
         ValueBuffer unboxedCopyBuf;
         auto unboxedValueCopy = unboxedType->vw_initializeBufferWithCopy(
             &unboxedCopyBuf, const_cast<OpaqueValue *>(unboxedValue));
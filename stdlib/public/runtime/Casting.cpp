@@ -18,6 +18,7 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
@@ -2608,28 +2609,12 @@ static bool _dynamicCastTupleToTuple(OpaqueValue *destination,
 /****************************** Main Entrypoint *******************************/
 /******************************************************************************/
 
-/// Perform a dynamic cast to an arbitrary type.
-SWIFT_RT_ENTRY_VISIBILITY
-bool swift::swift_dynamicCast(OpaqueValue *dest,
-                              OpaqueValue *src,
-                              const Metadata *srcType,
-                              const Metadata *targetType,
-                              DynamicCastFlags flags)
-    SWIFT_CC(RegisterPreservingCC_IMPL) {
-  auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
-                                                   targetType, flags);
-  srcType = unwrapResult.payloadType;
-  if (!srcType)
-    return unwrapResult.success;
-
-#if SWIFT_OBJC_INTEROP
-  // A class or AnyObject reference may point at a boxed _SwiftValue.
-  if (tryDynamicCastBoxedSwiftValue(dest, src, srcType,
-                                    targetType, flags)) {
-    return true;
-  }
-#endif
-
+/// Walk the full cast decision tree for a source type that is not optional.
+static bool _dynamicCastSlow(OpaqueValue *dest,
+                             OpaqueValue *src,
+                             const Metadata *srcType,
+                             const Metadata *targetType,
+                             DynamicCastFlags flags) {
   switch (targetType->getKind()) {
   // Handle wrapping an Optional target.
   case MetadataKind::Optional: {
@@ -2852,6 +2837,318 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
   _failCorruptType(srcType);
 }
 
+namespace {
+  /// The conversion that a cast between two types always goes through,
+  /// independent of the value being cast.
+  enum class DynamicCastStrategy : uint8_t {
+    /// Nothing is known about the pair; walk the full decision tree.
+    Slow,
+    /// The types are identical.
+    Succeed,
+    /// The cast can never succeed.
+    Fail,
+    /// Cast to the payload of an optional target and wrap the result.
+    ToOptionalPayload,
+    /// Cast from a class instance to a class.
+    ClassToClass,
+    /// Cast from an existential to a class.
+    ExistentialToClass,
+    /// Open the source existential and cast its contents.
+    FromExistential,
+    ToExistential,
+    ToMetatype,
+    ToExistentialMetatype,
+    ToFunction,
+    ToAnyHashable,
+    FromAnyHashable,
+    StructToStruct,
+    TupleToTuple,
+#if SWIFT_OBJC_INTEROP
+    /// Bridge a value to Objective-C, then cast the resulting object.
+    ValueToClassViaObjCBridgeable,
+    /// Cast an object to the Objective-C type of a bridged value type, then
+    /// bridge it back.
+    ClassToValueViaObjCBridgeable,
+#endif
+  };
+
+  struct DynamicCastCacheKey {
+    const Metadata *SourceType;
+    const Metadata *TargetType;
+  };
+
+  struct DynamicCastCacheEntry {
+    const Metadata *SourceType;
+    const Metadata *TargetType;
+
+    DynamicCastStrategy Strategy;
+
+#if SWIFT_OBJC_INTEROP
+    /// The _ObjectiveCBridgeable conformance used by the bridging strategies.
+    const _ObjectiveCBridgeableWitnessTable *BridgeWitness;
+#endif
+
+    DynamicCastCacheEntry(DynamicCastCacheKey key,
+                          DynamicCastStrategy strategy,
+                          const void *bridgeWitness)
+      : SourceType(key.SourceType), TargetType(key.TargetType),
+        Strategy(strategy)
+#if SWIFT_OBJC_INTEROP
+        , BridgeWitness(
+            static_cast<const _ObjectiveCBridgeableWitnessTable *>(
+              bridgeWitness))
+#endif
+    {}
+
+    int compareWithKey(const DynamicCastCacheKey &key) const {
+      if (int result = comparePointers(key.SourceType, SourceType))
+        return result;
+      return comparePointers(key.TargetType, TargetType);
+    }
+
+    static size_t getExtraAllocationSize(DynamicCastCacheKey key,
+                                         DynamicCastStrategy strategy,
+                                         const void *bridgeWitness) {
+      return 0;
+    }
+
+    size_t getExtraAllocationSize() const {
+      return 0;
+    }
+  };
+} // end unnamed namespace
+
+/// Strategies for pairs of types that have been cast before.
+static ConcurrentMap<DynamicCastCacheEntry, /*Destructor*/ false>
+DynamicCastCache;
+
+/// Pick the strategy _dynamicCastSlow would follow for a source type that is
+/// not optional. This must only return something other than Slow when the
+/// choice can't change later in the process: since conformances can be added
+/// when an image is loaded, any decision that rests on a type *not*
+/// conforming to _ObjectiveCBridgeable is left to the slow path.
+static DynamicCastStrategy
+classifyDynamicCast(const Metadata *srcType, const Metadata *targetType,
+                    const void *&bridgeWitness) {
+  bridgeWitness = nullptr;
+
+  auto srcKind = srcType->getKind();
+  auto srcIsClass = Metadata::isAnyKindOfClass(srcKind);
+  auto srcIsExistential = srcKind == MetadataKind::Existential;
+
+  switch (targetType->getKind()) {
+  case MetadataKind::Optional:
+    if (srcIsExistential) {
+#if SWIFT_OBJC_INTEROP
+      if (cast<ExistentialTypeMetadata>(srcType)->Flags.getSpecialProtocol()
+            == SpecialProtocol::AnyObject) {
+        if ((bridgeWitness = findBridgeWitness(targetType)))
+          return DynamicCastStrategy::ClassToValueViaObjCBridgeable;
+        return DynamicCastStrategy::Slow;
+      }
+#endif
+      return DynamicCastStrategy::FromExistential;
+    }
+    return DynamicCastStrategy::ToOptionalPayload;
+
+  case MetadataKind::Class:
+  case MetadataKind::ObjCClassWrapper:
+#if SWIFT_OBJC_INTEROP
+    // Bridging to NSError depends on whether the value is already an NSError.
+    if (targetType == getNSErrorMetadata())
+      return DynamicCastStrategy::Slow;
+#endif
+    SWIFT_FALLTHROUGH;
+
+  case MetadataKind::ForeignClass:
+    if (srcIsClass)
+      return DynamicCastStrategy::ClassToClass;
+    if (srcIsExistential)
+      return DynamicCastStrategy::ExistentialToClass;
+    if (isAnyHashableType(srcType))
+      return DynamicCastStrategy::FromAnyHashable;
+    if (srcKind == MetadataKind::Struct ||
+        srcKind == MetadataKind::Enum ||
+        srcKind == MetadataKind::Optional) {
+#if SWIFT_OBJC_INTEROP
+      if ((bridgeWitness = findBridgeWitness(srcType)))
+        return DynamicCastStrategy::ValueToClassViaObjCBridgeable;
+      return DynamicCastStrategy::Slow;
+#endif
+    }
+    return DynamicCastStrategy::Fail;
+
+  case MetadataKind::Existential:
+    return DynamicCastStrategy::ToExistential;
+  case MetadataKind::Metatype:
+    return DynamicCastStrategy::ToMetatype;
+  case MetadataKind::ExistentialMetatype:
+    return DynamicCastStrategy::ToExistentialMetatype;
+  case MetadataKind::Function:
+    return DynamicCastStrategy::ToFunction;
+
+  case MetadataKind::Struct:
+  case MetadataKind::Enum:
+    if (srcIsClass) {
+      if (isAnyHashableType(targetType))
+        return DynamicCastStrategy::ToAnyHashable;
+#if SWIFT_OBJC_INTEROP
+      if ((bridgeWitness = findBridgeWitness(targetType)))
+        return DynamicCastStrategy::ClassToValueViaObjCBridgeable;
+      // NSError bridging depends on the object.
+      return DynamicCastStrategy::Slow;
+#endif
+    } else if (srcKind == MetadataKind::Struct) {
+      if (targetType->getKind() == MetadataKind::Struct)
+        return DynamicCastStrategy::StructToStruct;
+    } else if (srcKind == MetadataKind::Enum ||
+               srcKind == MetadataKind::Optional) {
+      if (isAnyHashableType(targetType))
+        return DynamicCastStrategy::ToAnyHashable;
+    }
+    SWIFT_FALLTHROUGH;
+
+  case MetadataKind::HeapLocalVariable:
+  case MetadataKind::HeapGenericLocalVariable:
+  case MetadataKind::ErrorObject:
+  case MetadataKind::Opaque:
+  case MetadataKind::Tuple:
+    if (srcType == targetType)
+      return DynamicCastStrategy::Succeed;
+    if (srcIsExistential)
+      return DynamicCastStrategy::FromExistential;
+    if (srcKind == MetadataKind::Tuple &&
+        targetType->getKind() == MetadataKind::Tuple)
+      return DynamicCastStrategy::TupleToTuple;
+    return DynamicCastStrategy::Fail;
+  }
+  return DynamicCastStrategy::Slow;
+}
+
+/// Perform a dynamic cast to an arbitrary type.
+SWIFT_RT_ENTRY_VISIBILITY
+bool swift::swift_dynamicCast(OpaqueValue *dest,
+                              OpaqueValue *src,
+                              const Metadata *srcType,
+                              const Metadata *targetType,
+                              DynamicCastFlags flags)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
+                                                   targetType, flags);
+  srcType = unwrapResult.payloadType;
+  if (!srcType)
+    return unwrapResult.success;
+
+#if SWIFT_OBJC_INTEROP
+  // A class or AnyObject reference may point at a boxed _SwiftValue.
+  if (tryDynamicCastBoxedSwiftValue(dest, src, srcType,
+                                    targetType, flags)) {
+    return true;
+  }
+#endif
+
+  // Look up how this pair of types was cast last time. The flags don't
+  // affect which conversion is chosen, only how the values are consumed, so
+  // they aren't part of the key.
+  DynamicCastCacheKey key{srcType, targetType};
+  auto entry = DynamicCastCache.find(key);
+  if (!entry) {
+    const void *bridgeWitness;
+    auto strategy = classifyDynamicCast(srcType, targetType, bridgeWitness);
+    entry = DynamicCastCache.getOrInsert(key, strategy, bridgeWitness).first;
+  }
+
+  switch (entry->Strategy) {
+  case DynamicCastStrategy::Slow:
+    return _dynamicCastSlow(dest, src, srcType, targetType, flags);
+
+  case DynamicCastStrategy::Succeed:
+    return _succeed(dest, src, srcType, flags);
+
+  case DynamicCastStrategy::Fail:
+    return _fail(src, srcType, targetType, flags);
+
+  case DynamicCastStrategy::ToOptionalPayload: {
+    const Metadata *payloadType =
+      cast<EnumMetadata>(targetType)->getGenericArgs()[0];
+    if (swift_dynamicCast(dest, src, srcType, payloadType, flags)) {
+      swift_storeEnumTagSinglePayload(dest, payloadType, -1 /*case*/,
+                                      1 /*emptyCases*/);
+      return true;
+    }
+    return false;
+  }
+
+  case DynamicCastStrategy::ClassToClass: {
+    void *object = *reinterpret_cast<void * const *>(src);
+    return _dynamicCastUnknownClassIndirect(dest, object, targetType, flags);
+  }
+
+  case DynamicCastStrategy::ExistentialToClass:
+    return _dynamicCastToUnknownClassFromExistential(dest, src,
+                                     cast<ExistentialTypeMetadata>(srcType),
+                                                     targetType, flags);
+
+  case DynamicCastStrategy::FromExistential:
+    return _dynamicCastFromExistential(dest, src,
+                                       cast<ExistentialTypeMetadata>(srcType),
+                                       targetType, flags);
+
+  case DynamicCastStrategy::ToExistential:
+    return _dynamicCastToExistential(dest, src, srcType,
+                                     cast<ExistentialTypeMetadata>(targetType),
+                                     flags);
+
+  case DynamicCastStrategy::ToMetatype:
+    return _dynamicCastToMetatype(dest, src, srcType,
+                                  cast<MetatypeMetadata>(targetType),
+                                  flags);
+
+  case DynamicCastStrategy::ToExistentialMetatype:
+    return _dynamicCastToExistentialMetatype(dest, src, srcType,
+                                 cast<ExistentialMetatypeMetadata>(targetType),
+                                             flags);
+
+  case DynamicCastStrategy::ToFunction:
+    return _dynamicCastToFunction(dest, src, srcType,
+                                  cast<FunctionTypeMetadata>(targetType),
+                                  flags);
+
+  case DynamicCastStrategy::ToAnyHashable:
+    return _dynamicCastToAnyHashable(dest, src, srcType, targetType, flags);
+
+  case DynamicCastStrategy::FromAnyHashable:
+    return _dynamicCastFromAnyHashable(dest, src, srcType, targetType, flags);
+
+  case DynamicCastStrategy::StructToStruct:
+    return _dynamicCastStructToStruct(dest, src,
+                                      cast<StructMetadata>(srcType),
+                                      cast<StructMetadata>(targetType),
+                                      flags);
+
+  case DynamicCastStrategy::TupleToTuple:
+    return _dynamicCastTupleToTuple(dest, src,
+                                    cast<TupleTypeMetadata>(srcType),
+                                    cast<TupleTypeMetadata>(targetType),
+                                    flags);
+
+#if SWIFT_OBJC_INTEROP
+  case DynamicCastStrategy::ValueToClassViaObjCBridgeable:
+    return _dynamicCastValueToClassViaObjCBridgeable(dest, src, srcType,
+                                                     targetType,
+                                                     entry->BridgeWitness,
+                                                     flags);
+
+  case DynamicCastStrategy::ClassToValueViaObjCBridgeable:
+    return _dynamicCastClassToValueViaObjCBridgeable(dest, src, srcType,
+                                                     targetType,
+                                                     entry->BridgeWitness,
+                                                     flags);
+#endif
+  }
+  _failCorruptType(srcType);
+}
+
 static inline bool swift_isClassOrObjCExistentialTypeImpl(const Metadata *T) {
   auto kind = T->getKind();
   // Classes.
@@ -11,27 +11,29 @@
 static Demangle::NodePointer
 _buildDemanglingForNominalType(Demangle::Node::Kind boundGenericKind,
                                const Metadata *type,
-                               const NominalTypeDescriptor *description) {
+                               const NominalTypeDescriptor *description,
+                               Demangle::NodeFactory &Factory) {
   using namespace Demangle;
   
   // Demangle the base name.
   auto node = demangleTypeAsNode(description->Name,
-                                     strlen(description->Name));
+                                 strlen(description->Name), Factory);
   // If generic, demangle the type parameters.
   if (description->GenericParams.NumPrimaryParams > 0) {
-    auto typeParams = NodeFactory::create(Node::Kind::TypeList);
+    auto typeParams = Factory.createNode(Node::Kind::TypeList);
     auto typeBytes = reinterpret_cast<const char *>(type);
     auto genericParam = reinterpret_cast<const Metadata * const *>(
                  typeBytes + sizeof(void*) * description->GenericParams.Offset);
     for (unsigned i = 0, e = description->GenericParams.NumPrimaryParams;
          i < e; ++i, ++genericParam) {
-      auto demangling = _swift_buildDemanglingForMetadata(*genericParam);
+      auto demangling = _swift_buildDemanglingForMetadata(*genericParam,
+                                                          Factory);
       if (demangling == nullptr)
         return nullptr;
       typeParams->addChild(demangling);
     }
 
-    auto genericNode = NodeFactory::create(boundGenericKind);
+    auto genericNode = Factory.createNode(boundGenericKind);
     genericNode->addChild(node);
     genericNode->addChild(typeParams);
     return genericNode;
@@ -40,25 +42,30 @@ _buildDemanglingForNominalType(Demangle::Node::Kind boundGenericKind,
 }
 
 // Build a demangled type tree for a type.
-Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *type) {
+Demangle::NodePointer
+swift::_swift_buildDemanglingForMetadata(const Metadata *type,
+                                         Demangle::NodeFactory &Factory) {
   using namespace Demangle;
 
   switch (type->getKind()) {
   case MetadataKind::Class: {
     auto classType = static_cast<const ClassMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericClass,
-                                          type, classType->getDescription());
+                                          type, classType->getDescription(),
+                                          Factory);
   }
   case MetadataKind::Enum:
   case MetadataKind::Optional: {
     auto structType = static_cast<const EnumMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericEnum,
-                                          type, structType->Description);
+                                          type, structType->Description,
+                                          Factory);
   }
   case MetadataKind::Struct: {
     auto structType = static_cast<const StructMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericStructure,
-                                          type, structType->Description);
+                                          type, structType->Description,
+                                          Factory);
   }
   case MetadataKind::ObjCClassWrapper: {
 #if SWIFT_OBJC_INTEROP
@@ -66,12 +73,12 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     const char *className = class_getName((Class)objcWrapper->Class);
     
     // ObjC classes mangle as being in the magic "__ObjC" module.
-    auto module = NodeFactory::create(Node::Kind::Module, "__ObjC");
+    auto module = Factory.createNode(Node::Kind::Module, "__ObjC");
     
-    auto node = NodeFactory::create(Node::Kind::Class);
+    auto node = Factory.createNode(Node::Kind::Class);
     node->addChild(module);
-    node->addChild(NodeFactory::create(Node::Kind::Identifier,
-                                       llvm::StringRef(className)));
+    node->addChild(Factory.createNode(Node::Kind::Identifier,
+                                      llvm::StringRef(className)));
     
     return node;
 #else
@@ -82,12 +89,12 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
   case MetadataKind::ForeignClass: {
     auto foreign = static_cast<const ForeignClassMetadata *>(type);
     return Demangle::demangleTypeAsNode(foreign->getName(),
-                                        strlen(foreign->getName()));
+                                        strlen(foreign->getName()), Factory);
   }
   case MetadataKind::Existential: {
     auto exis = static_cast<const ExistentialTypeMetadata *>(type);
-    NodePointer proto_list = NodeFactory::create(Node::Kind::ProtocolList);
-    NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+    NodePointer proto_list = Factory.createNode(Node::Kind::ProtocolList);
+    NodePointer type_list = Factory.createNode(Node::Kind::TypeList);
 
     proto_list->addChild(type_list);
     
@@ -107,17 +114,18 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     for (auto *protocol : protocols) {
       // The protocol name is mangled as a type symbol, with the _Tt prefix.
       auto protocolNode = demangleSymbolAsNode(protocol->Name,
-                                               strlen(protocol->Name));
+                                               strlen(protocol->Name),
+                                               Factory);
       
       // ObjC protocol names aren't mangled.
       if (!protocolNode) {
-        auto module = NodeFactory::create(Node::Kind::Module,
-                                          MANGLING_MODULE_OBJC);
-        auto node = NodeFactory::create(Node::Kind::Protocol);
+        auto module = Factory.createNode(Node::Kind::Module,
+                                         MANGLING_MODULE_OBJC);
+        auto node = Factory.createNode(Node::Kind::Protocol);
         node->addChild(module);
-        node->addChild(NodeFactory::create(Node::Kind::Identifier,
-                                           llvm::StringRef(protocol->Name)));
-        auto typeNode = NodeFactory::create(Node::Kind::Type);
+        node->addChild(Factory.createNode(Node::Kind::Identifier,
+                                          llvm::StringRef(protocol->Name)));
+        auto typeNode = Factory.createNode(Node::Kind::Type);
         typeNode->addChild(node);
         type_list->addChild(typeNode);
         continue;
@@ -140,8 +148,9 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
   }
   case MetadataKind::ExistentialMetatype: {
     auto metatype = static_cast<const ExistentialMetatypeMetadata *>(type);
-    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType);
-    auto node = NodeFactory::create(Node::Kind::ExistentialMetatype);
+    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType,
+                                                      Factory);
+    auto node = Factory.createNode(Node::Kind::ExistentialMetatype);
     node->addChild(instance);
     return node;
   }
@@ -167,9 +176,10 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     std::vector<NodePointer> inputs;
     for (unsigned i = 0, e = func->getNumArguments(); i < e; ++i) {
       auto arg = func->getArguments()[i];
-      auto input = _swift_buildDemanglingForMetadata(arg.getPointer());
+      auto input = _swift_buildDemanglingForMetadata(arg.getPointer(),
+                                                     Factory);
       if (arg.getFlag()) {
-        NodePointer inout = NodeFactory::create(Node::Kind::InOut);
+        NodePointer inout = Factory.createNode(Node::Kind::InOut);
         inout->addChild(input);
         input = inout;
       }
@@ -178,7 +188,7 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
 
     NodePointer totalInput;
     if (inputs.size() > 1) {
-      auto tuple = NodeFactory::create(Node::Kind::NonVariadicTuple);
+      auto tuple = Factory.createNode(Node::Kind::NonVariadicTuple);
       for (auto &input : inputs)
         tuple->addChild(input);
       totalInput = tuple;
@@ -186,33 +196,35 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
       totalInput = inputs.front();
     }
     
-    NodePointer args = NodeFactory::create(Node::Kind::ArgumentTuple);
+    NodePointer args = Factory.createNode(Node::Kind::ArgumentTuple);
     args->addChild(totalInput);
     
-    NodePointer resultTy = _swift_buildDemanglingForMetadata(func->ResultType);
-    NodePointer result = NodeFactory::create(Node::Kind::ReturnType);
+    NodePointer resultTy =
+      _swift_buildDemanglingForMetadata(func->ResultType, Factory);
+    NodePointer result = Factory.createNode(Node::Kind::ReturnType);
     result->addChild(resultTy);
     
-    auto funcNode = NodeFactory::create(kind);
+    auto funcNode = Factory.createNode(kind);
     if (func->throws())
-      funcNode->addChild(NodeFactory::create(Node::Kind::ThrowsAnnotation));
+      funcNode->addChild(Factory.createNode(Node::Kind::ThrowsAnnotation));
     funcNode->addChild(args);
     funcNode->addChild(result);
     return funcNode;
   }
   case MetadataKind::Metatype: {
     auto metatype = static_cast<const MetatypeMetadata *>(type);
-    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType);
-    auto node = NodeFactory::create(Node::Kind::Metatype);
+    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType,
+                                                      Factory);
+    auto node = Factory.createNode(Node::Kind::Metatype);
     node->addChild(instance);
     return node;
   }
   case MetadataKind::Tuple: {
     auto tuple = static_cast<const TupleTypeMetadata *>(type);
     const char *labels = tuple->Labels;
-    auto tupleNode = NodeFactory::create(Node::Kind::NonVariadicTuple);
+    auto tupleNode = Factory.createNode(Node::Kind::NonVariadicTuple);
     for (unsigned i = 0, e = tuple->NumElements; i < e; ++i) {
-      auto elt = NodeFactory::create(Node::Kind::TupleElement);
+      auto elt = Factory.createNode(Node::Kind::TupleElement);
 
       // Add a label child if applicable:
       if (labels) {
@@ -221,8 +233,8 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
           // If there is one, and the label isn't empty, add a label child.
           if (labels != space) {
             auto eltName =
-              NodeFactory::create(Node::Kind::TupleElementName,
-                                  std::string(labels, space));
+              Factory.createNode(Node::Kind::TupleElementName,
+                                 std::string(labels, space));
             elt->addChild(std::move(eltName));
           }
 
@@ -233,7 +245,7 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
 
       // Add the element type child.
       auto eltType =
-        _swift_buildDemanglingForMetadata(tuple->getElement(i).Type);
+        _swift_buildDemanglingForMetadata(tuple->getElement(i).Type, Factory);
       elt->addChild(std::move(eltType));
 
       // Add the completed element to the tuple.
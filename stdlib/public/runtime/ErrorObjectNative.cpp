@@ -24,10 +24,87 @@
 #include <stdio.h>
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
+#include "Leaks.h"
 #include "Private.h"
 
+#if !defined(_WIN32)
+#define SWIFT_HAS_ERROR_BOX_CACHE 1
+#include "ThreadLocalCache.h"
+#else
+#define SWIFT_HAS_ERROR_BOX_CACHE 0
+#endif
+
 using namespace swift;
 
+#if SWIFT_HAS_ERROR_BOX_CACHE
+
+// Code which uses errors for control flow throws and catches them at a high
+// rate, and usually with small payloads.  The boxes of such errors all get
+// the same size and alignment, and a freed box is kept in a per-thread
+// cache for the next error thrown on that thread, instead of going back to
+// the allocator.
+
+namespace {
+
+enum : size_t {
+  /// Boxes up to this size, including the SwiftError header, are all
+  /// allocated with this size and kept in the cache.
+  CachedErrorBoxSize = 64,
+  CachedErrorBoxAlignMask = 15,
+
+  /// The number of freed boxes a thread keeps.
+  ErrorBoxCacheCapacity = 4,
+};
+
+/// The boxes kept by a thread.  They are freed when the thread exits.
+struct ErrorBoxCache {
+  HeapObject *Boxes[ErrorBoxCacheCapacity];
+  unsigned Count;
+};
+
+} // end anonymous namespace
+
+static void freeErrorBoxCache(ErrorBoxCache *cache) {
+  while (cache->Count)
+    swift_slowDealloc(cache->Boxes[--cache->Count], CachedErrorBoxSize,
+                      CachedErrorBoxAlignMask);
+}
+
+using ThreadErrorBoxCache = ThreadLocalCache<ErrorBoxCache, freeErrorBoxCache>;
+
+/// Is this the size and alignment of the boxes in the cache?
+static bool isCachedErrorBoxSize(std::pair<size_t, size_t> sizeAndAlign) {
+  return sizeAndAlign.first == CachedErrorBoxSize &&
+         sizeAndAlign.second == CachedErrorBoxAlignMask;
+}
+
+/// Take a box out of the calling thread's cache, or return null.
+static HeapObject *takeCachedErrorBox() {
+  ErrorBoxCache *cache = ThreadErrorBoxCache::get();
+  if (!cache || !cache->Count)
+    return nullptr;
+  return cache->Boxes[--cache->Count];
+}
+
+/// Try to keep a box whose value has been destroyed in the calling thread's
+/// cache.
+static bool cacheErrorBox(HeapObject *obj) {
+  // Boxes which weak or unowned references still point to must go back
+  // through swift_deallocObject.
+  if (obj->weakRefCount.hasSideTable() || obj->weakRefCount.getCount() != 1)
+    return false;
+
+  ErrorBoxCache *cache = ThreadErrorBoxCache::get();
+  if (!cache || cache->Count == ErrorBoxCacheCapacity)
+    return false;
+
+  SWIFT_LEAKS_STOP_TRACKING_OBJECT(obj);
+  cache->Boxes[cache->Count++] = obj;
+  return true;
+}
+
+#endif // SWIFT_HAS_ERROR_BOX_CACHE
+
 /// Determine the size and alignment of an Error box containing the given
 /// type.
 static std::pair<size_t, size_t>
@@ -41,6 +118,12 @@ _getErrorAllocatedSizeAndAlignmentMask(const Metadata *type) {
   size += vw->getSize();
   
   size_t alignMask = (alignof(SwiftError) - 1) | valueAlignMask;
+
+#if SWIFT_HAS_ERROR_BOX_CACHE
+  // Small boxes are interchangeable so that they can be cached.
+  if (size <= CachedErrorBoxSize && alignMask <= CachedErrorBoxAlignMask)
+    return {CachedErrorBoxSize, CachedErrorBoxAlignMask};
+#endif
   
   return {size, alignMask};
 }
@@ -55,6 +138,10 @@ static void _destroyErrorObject(HeapObject *obj) {
   
   // Deallocate the buffer.
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+#if SWIFT_HAS_ERROR_BOX_CACHE
+  if (isCachedErrorBoxSize(sizeAndAlign) && cacheErrorBox(obj))
+    return;
+#endif
   swift_deallocObject(obj, sizeAndAlign.first, sizeAndAlign.second);
 }
 
@@ -72,9 +159,22 @@ swift::swift_allocError(const swift::Metadata *type,
                         OpaqueValue *initialValue,
                         bool isTake) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
-  
-  auto allocated = swift_allocObject(&ErrorMetadata,
-                                     sizeAndAlign.first, sizeAndAlign.second);
+
+  HeapObject *allocated = nullptr;
+#if SWIFT_HAS_ERROR_BOX_CACHE
+  if (isCachedErrorBoxSize(sizeAndAlign)) {
+    if ((allocated = takeCachedErrorBox())) {
+      // Start over as a new object, like swift_allocObject does.
+      allocated->metadata = &ErrorMetadata;
+      allocated->refCount.init();
+      allocated->weakRefCount.init();
+      SWIFT_LEAKS_START_TRACKING_OBJECT(allocated);
+    }
+  }
+#endif
+  if (!allocated)
+    allocated = swift_allocObject(&ErrorMetadata,
+                                  sizeAndAlign.first, sizeAndAlign.second);
   
   auto error = reinterpret_cast<SwiftError*>(allocated);
   
@@ -96,6 +196,10 @@ swift::swift_allocError(const swift::Metadata *type,
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+#if SWIFT_HAS_ERROR_BOX_CACHE
+  if (isCachedErrorBoxSize(sizeAndAlign) && cacheErrorBox(error))
+    return;
+#endif
   swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
 }
 
@@ -24,10 +24,15 @@ namespace swift {
 namespace metadataimpl {
 
 /// A common base class for opaque-existential and class-existential boxes.
+///
+/// The array operations are done in bulk if the implementation's isPOD or
+/// isBitwiseTakable says that the containers can be copied or taken as bytes.
 template<typename Impl>
 struct LLVM_LIBRARY_VISIBILITY ExistentialBoxBase {
   template <class Container, class... A>
   static void destroyArray(Container *array, size_t n, A... args) {
+    if (Impl::isPOD)
+      return;
     size_t stride = Container::getContainerStride(args...);
     char *bytes = (char*)array;
     while (n--) {
@@ -42,6 +47,10 @@ struct LLVM_LIBRARY_VISIBILITY ExistentialBoxBase {
                                             size_t n,
                                             A... args) {
     size_t stride = Container::getContainerStride(args...);
+    if (Impl::isPOD) {
+      std::memcpy(dest, src, n * stride);
+      return dest;
+    }
     char *destBytes = (char*)dest, *srcBytes = (char*)src;
     while (n--) {
       Impl::initializeWithCopy((Container*)destBytes,
@@ -57,6 +66,10 @@ struct LLVM_LIBRARY_VISIBILITY ExistentialBoxBase {
                                                        size_t n,
                                                        A... args) {
     size_t stride = Container::getContainerStride(args...);
+    if (Impl::isBitwiseTakable) {
+      std::memmove(dest, src, n * stride);
+      return dest;
+    }
     char *destBytes = (char*)dest, *srcBytes = (char*)src;
     while (n--) {
       Impl::initializeWithTake((Container*)destBytes,
@@ -72,6 +85,10 @@ struct LLVM_LIBRARY_VISIBILITY ExistentialBoxBase {
                                                        size_t n,
                                                        A... args) {
     size_t stride = Container::getContainerStride(args...);
+    if (Impl::isBitwiseTakable) {
+      std::memmove(dest, src, n * stride);
+      return dest;
+    }
     char *destBytes = (char*)dest + n * stride, *srcBytes = (char*)src + n * stride;
     while (n--) {
       destBytes -= stride; srcBytes -= stride;
@@ -86,6 +103,24 @@ struct LLVM_LIBRARY_VISIBILITY ExistentialBoxBase {
 /// implementations.
 struct LLVM_LIBRARY_VISIBILITY OpaqueExistentialBoxBase
     : ExistentialBoxBase<OpaqueExistentialBoxBase> {
+  static constexpr bool isPOD = false;
+  static constexpr bool isBitwiseTakable = false;
+
+  /// Whether a buffer holding a value of destType can hold a value of
+  /// srcType in the same allocation.  Values which are not stored inline
+  /// are allocated with swift_slowAlloc by their size and alignment, so a
+  /// value of another type with the same size and alignment fits.
+  static bool canReuseAllocatedBuffer(const Metadata *srcType,
+                                      const Metadata *destType) {
+    auto srcWitnesses = srcType->getValueWitnesses();
+    auto destWitnesses = destType->getValueWitnesses();
+    return !srcWitnesses->isValueInline() &&
+           !destWitnesses->isValueInline() &&
+           srcWitnesses->size == destWitnesses->size &&
+           srcWitnesses->getAlignmentMask() ==
+             destWitnesses->getAlignmentMask();
+  }
+
   template <class Container, class... A>
   static void destroy(Container *value, A... args) {
     value->getType()->vw_destroyBuffer(value->getBuffer(args...));
@@ -120,6 +155,16 @@ struct LLVM_LIBRARY_VISIBILITY OpaqueExistentialBoxBase
       OpaqueValue *destValue = srcType->vw_projectBuffer(dest->getBuffer(args...));
       srcType->vw_assignWithCopy(destValue, srcValue);
       return dest;
+    } else if (canReuseAllocatedBuffer(srcType, destType)) {
+      // Copy into the existing allocation instead of freeing it and
+      // allocating a new one of the same size.
+      OpaqueValue *srcValue = srcType->vw_projectBuffer(src->getBuffer(args...));
+      OpaqueValue *destValue =
+        destType->vw_projectBuffer(dest->getBuffer(args...));
+      destType->vw_destroy(destValue);
+      src->copyTypeInto(dest, args...);
+      srcType->vw_initializeWithCopy(destValue, srcValue);
+      return dest;
     } else {
       destType->vw_destroyBuffer(dest->getBuffer(args...));
       return initializeWithCopy(dest, src, args...);
@@ -235,6 +280,9 @@ struct LLVM_LIBRARY_VISIBILITY NonFixedOpaqueExistentialBox
 /// implementations.
 struct LLVM_LIBRARY_VISIBILITY ClassExistentialBoxBase
     : ExistentialBoxBase<ClassExistentialBoxBase> {
+  static constexpr bool isPOD = false;
+  static constexpr bool isBitwiseTakable = true;
+
   static constexpr unsigned numExtraInhabitants =
     swift_getHeapObjectExtraInhabitantCount();
 
@@ -367,6 +415,9 @@ struct LLVM_LIBRARY_VISIBILITY NonFixedClassExistentialBox
 /// implementations.
 struct LLVM_LIBRARY_VISIBILITY ExistentialMetatypeBoxBase
     : ExistentialBoxBase<ExistentialMetatypeBoxBase> {
+  static constexpr bool isPOD = true;
+  static constexpr bool isBitwiseTakable = true;
+
   static constexpr unsigned numExtraInhabitants =
     swift_getHeapObjectExtraInhabitantCount();
 
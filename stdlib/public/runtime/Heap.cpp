@@ -16,15 +16,336 @@
 
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
+#include "swift/Runtime/InstrumentsSupport.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
 #include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(__CYGWIN__) && defined(__LP64__)
+#define SWIFT_HAS_MAGAZINE_ALLOCATOR 1
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Once.h"
+#include "ThreadLocalCache.h"
+#include <atomic>
+#include <sys/mman.h>
+#else
+#define SWIFT_HAS_MAGAZINE_ALLOCATOR 0
+#endif
 
 using namespace swift;
 
+#if SWIFT_HAS_MAGAZINE_ALLOCATOR
+
+// The magazine allocator serves small, modestly-aligned allocations from
+// per-thread free lists, one per size class.  Threads exchange whole
+// magazines (batches of free blocks) with a global depot, so the depot lock
+// is only taken once every MagazineSize allocations or deallocations.
+//
+// All blocks live in a single reserved address range, which lets
+// swift_slowDealloc recognize them no matter what size the caller passes,
+// and fall back to free() for everything else.
+//
+// The allocator is off unless the runtime was built with
+// SWIFT_RUNTIME_ENABLE_MAGAZINE_ALLOCATOR, or the SWIFT_MAGAZINE_ALLOCATOR
+// environment variable is set to 1.  Setting it to 0 turns it off.
+
+namespace {
+
+enum : size_t {
+  /// Blocks are handed out in multiples of this size, which is also the
+  /// alignment every block is guaranteed to have.
+  SizeClassGranule = 16,
+  NumSizeClasses = 16,
+  MaxMagazineBlockSize = SizeClassGranule * NumSizeClasses,
+
+  /// The number of blocks exchanged with the depot at a time.
+  MagazineSize = 64,
+
+  /// Every chunk holds blocks of a single size class.
+  ChunkSize = 64 * 1024,
+  RegionSize = size_t(4) * 1024 * 1024 * 1024,
+  NumChunks = RegionSize / ChunkSize,
+};
+
+struct FreeBlock {
+  FreeBlock *Next;
+
+  /// In the first block of a full magazine held by the depot, the next
+  /// magazine.
+  FreeBlock *NextMagazine;
+};
+
+/// The per-thread free lists.  Their blocks are returned to the depot when
+/// the thread exits.
+struct ThreadCache {
+  FreeBlock *Free[NumSizeClasses];
+  uint32_t Count[NumSizeClasses];
+  uint64_t Allocations;
+  uint64_t Deallocations;
+};
+
+/// The shared pool of blocks for one size class.
+struct Depot {
+  StaticMutex Lock;
+
+  /// Full magazines, chained through FreeBlock::NextMagazine.
+  FreeBlock *Magazines = nullptr;
+
+  /// Blocks returned individually, for example by an exiting thread.
+  FreeBlock *Loose = nullptr;
+  uint32_t LooseCount = 0;
+
+  /// The unused tail of the chunk this class is currently carving.
+  char *ChunkCursor = nullptr;
+  char *ChunkEnd = nullptr;
+};
+
+} // end anonymous namespace
+
+static Depot Depots[NumSizeClasses];
+
+/// The reserved region, or null if the allocator is disabled.
+static char *RegionBase;
+static std::atomic<size_t> NextChunk;
+
+/// The size class of each chunk in the region, plus one.
+static uint8_t ChunkClasses[NumChunks];
+
+enum class MagazineState : uint8_t { Uninitialized, Disabled, Enabled };
+static std::atomic<MagazineState> State;
+static swift_once_t MagazineOnce;
+
+static std::atomic<uint64_t> StatMappedBytes;
+static std::atomic<uint64_t> StatAllocations;
+static std::atomic<uint64_t> StatDeallocations;
+static std::atomic<uint64_t> StatRefills;
+static std::atomic<uint64_t> StatFlushes;
+
+static void flushThreadCache(ThreadCache *cache);
+
+/// The calling thread's cache.  This is null once the cache has been
+/// flushed at thread exit, which happens when another thread-exit
+/// destructor uses the allocator after ours has run.
+using MagazineThreadCache = ThreadLocalCache<ThreadCache, flushThreadCache>;
+
+static void initializeMagazineAllocator(void *) {
+#if SWIFT_RUNTIME_ENABLE_MAGAZINE_ALLOCATOR
+  bool enabled = true;
+#else
+  bool enabled = false;
+#endif
+  if (const char *env = getenv("SWIFT_MAGAZINE_ALLOCATOR"))
+    enabled = strcmp(env, "0") != 0;
+
+  if (enabled) {
+    // Reserve the whole region up front; chunks are made accessible as
+    // they're needed.
+    void *region = mmap(nullptr, RegionSize, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (region == MAP_FAILED) {
+      enabled = false;
+    } else {
+      RegionBase = static_cast<char *>(region);
+    }
+  }
+
+  State.store(enabled ? MagazineState::Enabled : MagazineState::Disabled,
+              std::memory_order_release);
+}
+
+static bool isMagazineAllocatorEnabled() {
+  auto state = State.load(std::memory_order_acquire);
+  if (LLVM_LIKELY(state == MagazineState::Enabled))
+    return true;
+  if (state == MagazineState::Disabled)
+    return false;
+  swift_once(&MagazineOnce, initializeMagazineAllocator);
+  return State.load(std::memory_order_acquire) == MagazineState::Enabled;
+}
+
+/// Is \p ptr a block handed out by the magazine allocator?
+static bool isMagazineBlock(void *ptr) {
+  return RegionBase &&
+         size_t(static_cast<char *>(ptr) - RegionBase) < size_t(RegionSize);
+}
+
+static void publishThreadStatistics(ThreadCache &cache) {
+  StatAllocations.fetch_add(cache.Allocations, std::memory_order_relaxed);
+  StatDeallocations.fetch_add(cache.Deallocations, std::memory_order_relaxed);
+  cache.Allocations = 0;
+  cache.Deallocations = 0;
+}
+
+/// Make a new chunk accessible for the given size class.  Must be called
+/// with the depot lock held.
+static bool addChunk(Depot &depot, unsigned sizeClass) {
+  size_t index = NextChunk.fetch_add(1, std::memory_order_relaxed);
+  if (index >= NumChunks)
+    return false;
+
+  char *chunk = RegionBase + index * ChunkSize;
+  if (mprotect(chunk, ChunkSize, PROT_READ | PROT_WRITE) != 0)
+    return false;
+
+  ChunkClasses[index] = sizeClass + 1;
+  depot.ChunkCursor = chunk;
+  depot.ChunkEnd = chunk + ChunkSize;
+  StatMappedBytes.fetch_add(ChunkSize, std::memory_order_relaxed);
+  return true;
+}
+
+/// Add a single block to the depot's loose blocks, promoting them to a full
+/// magazine once there are enough.  Must be called with the depot lock held.
+static void addLooseBlock(Depot &depot, FreeBlock *block) {
+  block->Next = depot.Loose;
+  depot.Loose = block;
+  if (++depot.LooseCount == MagazineSize) {
+    depot.Loose->NextMagazine = depot.Magazines;
+    depot.Magazines = depot.Loose;
+    depot.Loose = nullptr;
+    depot.LooseCount = 0;
+  }
+}
+
+/// Refill an empty thread-local free list from the depot.
+static FreeBlock *refillThreadCache(ThreadCache &cache, unsigned sizeClass) {
+  publishThreadStatistics(cache);
+  StatRefills.fetch_add(1, std::memory_order_relaxed);
+
+  Depot &depot = Depots[sizeClass];
+  size_t blockSize = (sizeClass + 1) * SizeClassGranule;
+  FreeBlock *list = nullptr;
+  uint32_t count = 0;
+
+  depot.Lock.withLock([&] {
+    if (FreeBlock *magazine = depot.Magazines) {
+      depot.Magazines = magazine->NextMagazine;
+      list = magazine;
+      count = MagazineSize;
+      return;
+    }
+
+    if (FreeBlock *loose = depot.Loose) {
+      list = loose;
+      count = depot.LooseCount;
+      depot.Loose = nullptr;
+      depot.LooseCount = 0;
+      return;
+    }
+
+    // Carve a fresh magazine out of the current chunk.
+    while (count < MagazineSize) {
+      if (size_t(depot.ChunkEnd - depot.ChunkCursor) < blockSize &&
+          !addChunk(depot, sizeClass))
+        break;
+      auto block = reinterpret_cast<FreeBlock *>(depot.ChunkCursor);
+      depot.ChunkCursor += blockSize;
+      block->Next = list;
+      list = block;
+      ++count;
+    }
+  });
+
+  cache.Free[sizeClass] = list;
+  cache.Count[sizeClass] = count;
+  return list;
+}
+
+/// Hand a full magazine from an overflowing thread-local free list back to
+/// the depot.
+static void flushMagazine(ThreadCache &cache, unsigned sizeClass) {
+  FreeBlock *magazine = cache.Free[sizeClass];
+  FreeBlock *last = magazine;
+  for (unsigned i = 1; i < MagazineSize; ++i)
+    last = last->Next;
+  cache.Free[sizeClass] = last->Next;
+  cache.Count[sizeClass] -= MagazineSize;
+  last->Next = nullptr;
+
+  publishThreadStatistics(cache);
+  StatFlushes.fetch_add(1, std::memory_order_relaxed);
+
+  Depot &depot = Depots[sizeClass];
+  depot.Lock.withLock([&] {
+    magazine->NextMagazine = depot.Magazines;
+    depot.Magazines = magazine;
+  });
+}
+
+/// Return all of an exiting thread's blocks to the depots.
+static void flushThreadCache(ThreadCache *exitingCache) {
+  auto &cache = *exitingCache;
+  for (unsigned sizeClass = 0; sizeClass != NumSizeClasses; ++sizeClass) {
+    while (cache.Count[sizeClass] >= MagazineSize)
+      flushMagazine(cache, sizeClass);
+
+    Depot &depot = Depots[sizeClass];
+    depot.Lock.withLock([&] {
+      while (FreeBlock *block = cache.Free[sizeClass]) {
+        cache.Free[sizeClass] = block->Next;
+        addLooseBlock(depot, block);
+      }
+    });
+    cache.Count[sizeClass] = 0;
+  }
+  publishThreadStatistics(cache);
+}
+
+static void *allocateFromMagazine(size_t size) {
+  ThreadCache *cachePtr = MagazineThreadCache::get();
+  if (LLVM_UNLIKELY(!cachePtr))
+    return nullptr;
+
+  unsigned sizeClass = size ? (size - 1) / SizeClassGranule : 0;
+  ThreadCache &cache = *cachePtr;
+  FreeBlock *block = cache.Free[sizeClass];
+  if (LLVM_UNLIKELY(!block)) {
+    block = refillThreadCache(cache, sizeClass);
+    if (!block)
+      return nullptr;
+  }
+  cache.Free[sizeClass] = block->Next;
+  --cache.Count[sizeClass];
+  ++cache.Allocations;
+  return block;
+}
+
+static void deallocateToMagazine(void *ptr) {
+  size_t chunkIndex = size_t(static_cast<char *>(ptr) - RegionBase) / ChunkSize;
+  unsigned sizeClass = ChunkClasses[chunkIndex] - 1;
+  auto block = static_cast<FreeBlock *>(ptr);
+
+  ThreadCache *cachePtr = MagazineThreadCache::get();
+  if (LLVM_UNLIKELY(!cachePtr)) {
+    // The thread's cache is gone; give the block straight back to the depot.
+    Depot &depot = Depots[sizeClass];
+    depot.Lock.withLock([&] { addLooseBlock(depot, block); });
+    StatDeallocations.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ThreadCache &cache = *cachePtr;
+  block->Next = cache.Free[sizeClass];
+  cache.Free[sizeClass] = block;
+  ++cache.Deallocations;
+  if (LLVM_UNLIKELY(++cache.Count[sizeClass] >= 2 * MagazineSize))
+    flushMagazine(cache, sizeClass);
+}
+
+#endif // SWIFT_HAS_MAGAZINE_ALLOCATOR
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_HAS_MAGAZINE_ALLOCATOR
+  if (size <= MaxMagazineBlockSize && alignMask < SizeClassGranule &&
+      isMagazineAllocatorEnabled()) {
+    if (void *p = allocateFromMagazine(size))
+      return p;
+  }
+#endif
+
   // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
   void *p = malloc(size);
   if (!p) swift::crash("Could not allocate memory.");
@@ -34,5 +355,48 @@ void *swift::swift_slowAlloc(size_t size, size_t alignMask)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_HAS_MAGAZINE_ALLOCATOR
+  // Don't trust the size; recognize our blocks by address instead.
+  if (isMagazineBlock(ptr)) {
+    deallocateToMagazine(ptr);
+    return;
+  }
+#endif
+
   free(ptr);
 }
+
+size_t swift::_swift_getMagazineBlockSize(const void *ptr) {
+#if SWIFT_HAS_MAGAZINE_ALLOCATOR
+  if (!isMagazineBlock(const_cast<void *>(ptr)))
+    return 0;
+  size_t chunkIndex =
+    size_t(static_cast<const char *>(ptr) - RegionBase) / ChunkSize;
+  return ChunkClasses[chunkIndex] * SizeClassGranule;
+#else
+  return 0;
+#endif
+}
+
+SWIFT_RUNTIME_EXPORT
+extern "C"
+bool swift::_swift_getMagazineAllocatorStatistics(
+    SwiftMagazineAllocatorStatistics *stats) {
+#if SWIFT_HAS_MAGAZINE_ALLOCATOR
+  if (!isMagazineAllocatorEnabled())
+    return false;
+
+  // Include the calling thread's not-yet-published counts.
+  if (ThreadCache *cache = MagazineThreadCache::get())
+    publishThreadStatistics(*cache);
+
+  stats->MappedBytes = StatMappedBytes.load(std::memory_order_relaxed);
+  stats->Allocations = StatAllocations.load(std::memory_order_relaxed);
+  stats->Deallocations = StatDeallocations.load(std::memory_order_relaxed);
+  stats->DepotRefills = StatRefills.load(std::memory_order_relaxed);
+  stats->DepotFlushes = StatFlushes.load(std::memory_order_relaxed);
+  return true;
+#else
+  return false;
+#endif
+}
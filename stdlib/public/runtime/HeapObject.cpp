@@ -18,12 +18,15 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -152,7 +155,7 @@ public:
 
 } // end anonymous namespace
 
-static SimpleGlobalCache<BoxCacheEntry> Boxes;
+static SimpleGlobalCache<BoxCacheEntry> Boxes("Boxes");
 
 SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
 BoxPair::Return
@@ -601,6 +604,8 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+static void clearWeakSideTableEntry(HeapObject *object);
+
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_deallocObject(HeapObject *object,
                                 size_t allocatedSize,
@@ -617,6 +622,11 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // Weak references to the object don't keep its memory alive. Make them
+  // load nil from now on.
+  if (object->weakRefCount.hasSideTable())
+    clearWeakSideTableEntry(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -693,142 +703,197 @@ void swift::swift_deallocObject(HeapObject *object,
 
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
+namespace {
+
+/// The out-of-line storage for the weak references to a native object.
+///
+/// Native weak references point to the side table entry of their object
+/// instead of the object itself. They only keep the entry alive, so the memory
+/// of the object is freed when it is deallocated, rather than when the last
+/// weak reference to it goes away.
+///
+/// The entry is created when the first weak reference to the object is
+/// formed. The object owns a reference to its entry until it is deallocated,
+/// at which point the entry forgets the object.
+///
+/// Loading, copying and destroying a weak reference only use atomic
+/// operations on the entry.
+struct WeakSideTableEntry {
+  /// The object, or null once it has been deallocated.
+  std::atomic<HeapObject *> Object;
+
+  /// The number of weak references to the entry, plus one for the object
+  /// while it is alive.
+  std::atomic<size_t> RefCount;
+
+  /// The number of weak loads which are currently retaining Object. The
+  /// object's memory isn't freed until this drops to zero.
+  std::atomic<size_t> Readers;
+
+  WeakSideTableEntry(HeapObject *object)
+    : Object(object), RefCount(1), Readers(0) {}
+};
+
+/// The side table entries of the objects which are still alive, split into
+/// shards by object address so that threads forming weak references to
+/// different objects rarely contend.
+struct WeakSideTable {
+  enum : unsigned { NumShards = 64 };
+
+  struct Shard {
+    Mutex Lock;
+    llvm::DenseMap<HeapObject *, WeakSideTableEntry *> Entries;
+  } Shards[NumShards];
 
-enum: short {
-  WR_SPINLIMIT = 64,
+  Shard &getShard(HeapObject *object) {
+    auto bits = reinterpret_cast<uintptr_t>(object);
+    return Shards[(bits >> 4) % NumShards];
+  }
 };
 
+} // end anonymous namespace
+
+static Lazy<WeakSideTable> WeakSideTables;
+
+/// Returns a new reference to \p entry, which is already referenced.
+static void retainWeakSideTableEntry(WeakSideTableEntry *entry) {
+  entry->RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Drops a reference to \p entry, freeing it if that was the last one.
+static void releaseWeakSideTableEntry(WeakSideTableEntry *entry) {
+  if (entry->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete entry;
+}
+
+/// Returns a new reference to the side table entry of \p object, creating
+/// the entry if the object doesn't have one yet.
+static WeakSideTableEntry *retainWeakSideTableEntry(HeapObject *object) {
+  auto &shard = WeakSideTables.get().getShard(object);
+  WeakSideTableEntry *entry;
+  shard.Lock.withLock([&] {
+    auto &slot = shard.Entries[object];
+    if (!slot) {
+      slot = new WeakSideTableEntry(object);
+      object->weakRefCount.setHasSideTable();
+    }
+    entry = slot;
+  });
+
+  // The caller keeps the object alive, and the object keeps its entry alive.
+  retainWeakSideTableEntry(entry);
+  return entry;
+}
+
+/// Detaches the side table entry of \p object, which is being deallocated, so
+/// that weak references to it load nil.
+static void clearWeakSideTableEntry(HeapObject *object) {
+  auto &shard = WeakSideTables.get().getShard(object);
+  WeakSideTableEntry *entry = nullptr;
+  shard.Lock.withLock([&] {
+    auto found = shard.Entries.find(object);
+    if (found == shard.Entries.end())
+      return;
+    entry = found->second;
+    shard.Entries.erase(found);
+  });
+  if (!entry)
+    return;
+
+  // Once Object is null, no new load can see the object. Wait for the loads
+  // which already saw it to finish their (failing) retain before the memory
+  // is freed. This pairs with the increment in swift_weakLoadStrong.
+  entry->Object.store(nullptr, std::memory_order_seq_cst);
+  while (entry->Readers.load(std::memory_order_seq_cst) != 0)
+    std::this_thread::yield();
+
+  releaseWeakSideTableEntry(entry);
+}
+
+static WeakSideTableEntry *getWeakSideTableEntry(WeakReference *ref) {
+  return (WeakSideTableEntry *)(ref->Value & ~WR_NATIVE);
+}
+
 bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  auto entry = value ? retainWeakSideTableEntry(value) : nullptr;
+  ref->Value = (uintptr_t)entry | WR_NATIVE;
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto oldEntry = getWeakSideTableEntry(ref);
+  // Reassigning the same object doesn't need to look up its entry.
+  if (oldEntry && newValue &&
+      oldEntry->Object.load(std::memory_order_relaxed) == newValue)
+    return;
+
+  auto newEntry = newValue ? retainWeakSideTableEntry(newValue) : nullptr;
+  ref->Value = (uintptr_t)newEntry | WR_NATIVE;
+  if (oldEntry)
+    releaseWeakSideTableEntry(oldEntry);
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
+  auto entry = getWeakSideTableEntry(ref);
+  if (!entry)
     return nullptr;
-  }
-
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
 
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    return nullptr;
-  }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
+  // Registering as a reader keeps the object's memory from being freed while
+  // we retain it. A deallocating object fails to be retained.
+  entry->Readers.fetch_add(1, std::memory_order_seq_cst);
+  auto object = entry->Object.load(std::memory_order_seq_cst);
+  auto result = object ? swift_tryRetain(object) : nullptr;
+  entry->Readers.fetch_sub(1, std::memory_order_release);
   return result;
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
-  ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  auto result = swift_weakLoadStrong(ref);
+  swift_weakDestroy(ref);
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  auto entry = getWeakSideTableEntry(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (entry)
+    releaseWeakSideTableEntry(entry);
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
+  auto entry = getWeakSideTableEntry(src);
+  if (!entry) {
     dest->Value = (uintptr_t)nullptr;
     return;
   }
-
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  retainWeakSideTableEntry(entry);
+  dest->Value = (uintptr_t)entry | WR_NATIVE;
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  auto entry = getWeakSideTableEntry(src);
+  dest->Value = entry ? (uintptr_t)entry | WR_NATIVE : (uintptr_t)nullptr;
   src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  swift_weakDestroy(dest);
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  swift_weakDestroy(dest);
   swift_weakTakeInit(dest, src);
 }
 
@@ -24,8 +24,10 @@
 #include "swift/Runtime/Mutex.h"
 #include "swift/Strings.h"
 #include "MetadataCache.h"
+#include "ThreadLocalCache.h"
 #include <algorithm>
 #include <condition_variable>
+#include <cstddef>
 #include <new>
 #include <cctype>
 #if defined(_MSC_VER)
@@ -80,7 +82,7 @@ namespace {
   struct GenericCacheEntry
       : CacheEntry<GenericCacheEntry, GenericCacheEntryHeader> {
 
-    static const char *getName() { return "GenericCache"; }
+    static constexpr const char *getName() { return "GenericCache"; }
 
     GenericCacheEntry(unsigned numArguments) {
       NumArguments = numArguments;
@@ -106,6 +108,28 @@ namespace {
 using GenericMetadataCache = MetadataCache<GenericCacheEntry>;
 using LazyGenericMetadataCache = Lazy<GenericMetadataCache>;
 
+/// Create the metadata cache of a generic metadata structure in its private
+/// data, and add the instantiations which the compiler emitted statically.
+static void initializeGenericMetadataCache(void *cacheAddr) {
+  auto cache = ::new (cacheAddr) GenericMetadataCache();
+  auto pattern = reinterpret_cast<GenericMetadata *>(
+      reinterpret_cast<char *>(cacheAddr) -
+      offsetof(GenericMetadata, PrivateData));
+
+  auto prespecializations = pattern->Prespecializations;
+  if (!prespecializations)
+    return;
+
+  size_t numGenericArgs = pattern->NumKeyArguments;
+  for (; *prespecializations; ++prespecializations) {
+    auto entry = reinterpret_cast<GenericCacheEntry *>(*prespecializations);
+    assert(entry->getNumArguments() == numGenericArgs &&
+           "prespecialized metadata with wrong number of arguments");
+    cache->findOrAdd(entry->getArgumentsBuffer(), numGenericArgs,
+                     [&]() -> GenericCacheEntry * { return entry; });
+  }
+}
+
 /// Fetch the metadata cache for a generic metadata structure.
 static GenericMetadataCache &getCache(GenericMetadata *metadata) {
   // Keep this assert even if you change the representation above.
@@ -115,7 +139,7 @@ static GenericMetadataCache &getCache(GenericMetadata *metadata) {
 
   auto lazyCache =
     reinterpret_cast<LazyGenericMetadataCache*>(metadata->PrivateData);
-  return lazyCache->get();
+  return lazyCache->get(initializeGenericMetadataCache);
 }
 
 /// Fetch the metadata cache for a generic metadata structure,
@@ -224,6 +248,32 @@ swift::swift_allocateGenericValueMetadata(GenericMetadata *pattern,
   return metadata;
 }
 
+namespace {
+  /// A small, direct-mapped, per-thread cache of recent generic metadata
+  /// lookups. A hit avoids searching the shared cache, whose last-search
+  /// slot is written on every lookup and so bounces between threads that
+  /// instantiate different types.
+  struct GenericMetadataFrontCache {
+    static constexpr unsigned NumEntries = 16;
+
+    struct Entry {
+      GenericMetadata *Pattern;
+      size_t Hash;
+      const GenericCacheEntry *Value;
+    };
+    Entry Entries[NumEntries];
+
+    Entry &getSlot(GenericMetadata *pattern, size_t hash) {
+      auto index = (hash ^ (reinterpret_cast<uintptr_t>(pattern) >> 4))
+                     % NumEntries;
+      return Entries[index];
+    }
+  };
+}
+
+using GenericMetadataThreadCache =
+  ThreadLocalCache<GenericMetadataFrontCache>;
+
 /// The primary entrypoint.
 SWIFT_RT_ENTRY_VISIBILITY
 const Metadata *
@@ -233,6 +283,16 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
 
+  auto key = KeyDataRef::forArguments(genericArgs, numGenericArgs);
+  auto hash = key.hash();
+  GenericMetadataFrontCache::Entry *slot = nullptr;
+  if (auto frontCache = GenericMetadataThreadCache::get()) {
+    slot = &frontCache->getSlot(pattern, hash);
+    if (slot->Pattern == pattern && slot->Hash == hash &&
+        KeyDataRef::forEntry(slot->Value, numGenericArgs) == key)
+      return slot->Value->Value;
+  }
+
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
@@ -242,6 +302,14 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
       return entry;
     });
 
+  // findOrAdd only returns once the entry is complete, so it's safe for
+  // later lookups on this thread to use it without synchronization.
+  if (slot) {
+    slot->Pattern = pattern;
+    slot->Hash = hash;
+    slot->Value = entry;
+  }
+
   return entry->Value;
 }
 
@@ -280,7 +348,8 @@ namespace {
 }
 
 /// The uniquing structure for ObjC class-wrapper metadata.
-static SimpleGlobalCache<ObjCClassCacheEntry> ObjCClassWrappers;
+static SimpleGlobalCache<ObjCClassCacheEntry>
+    ObjCClassWrappers("ObjCClassWrappers");
 
 #endif
 
@@ -369,7 +438,7 @@ public:
 } // end anonymous namespace
 
 /// The uniquing structure for function type metadata.
-static SimpleGlobalCache<FunctionCacheEntry> FunctionTypes;
+static SimpleGlobalCache<FunctionCacheEntry> FunctionTypes("FunctionTypes");
 
 const FunctionTypeMetadata *
 swift::swift_getFunctionTypeMetadata1(FunctionTypeFlags flags,
@@ -534,7 +603,7 @@ public:
 }
 
 /// The uniquing structure for tuple type metadata.
-static SimpleGlobalCache<TupleCacheEntry> TupleTypes;
+static SimpleGlobalCache<TupleCacheEntry> TupleTypes("TupleTypes");
 
 /// Given a metatype pointer, produce the value-witness table for it.
 /// This is equivalent to metatype->ValueWitnesses but more efficient.
@@ -1447,14 +1516,13 @@ static inline ClassROData *getROData(ClassMetadata *theClass) {
 
 static void _swift_initGenericClassObjCName(ClassMetadata *theClass) {
   // Use the remangler to generate a mangled name from the type metadata.
-  auto demangling = _swift_buildDemanglingForMetadata(theClass);
+  Demangle::NodeFactory Factory;
+  auto demangling = _swift_buildDemanglingForMetadata(theClass, Factory);
 
   // Remangle that into a new type mangling string.
-  auto typeNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::TypeMangling);
+  auto typeNode = Factory.createNode(Demangle::Node::Kind::TypeMangling);
   typeNode->addChild(demangling);
-  auto globalNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::Global);
+  auto globalNode = Factory.createNode(Demangle::Node::Kind::Global);
   globalNode->addChild(typeNode);
   
   auto string = Demangle::mangleNode(globalNode);
@@ -1814,7 +1882,7 @@ namespace {
 }
 
 /// The uniquing structure for metatype type metadata.
-static SimpleGlobalCache<MetatypeCacheEntry> MetatypeTypes;
+static SimpleGlobalCache<MetatypeCacheEntry> MetatypeTypes("MetatypeTypes");
 
 /// \brief Fetch a uniqued metadata for a metatype type.
 SWIFT_RUNTIME_EXPORT
@@ -1883,10 +1951,11 @@ public:
 
 /// The uniquing structure for existential metatype value witness tables.
 static SimpleGlobalCache<ExistentialMetatypeValueWitnessTableCacheEntry>
-ExistentialMetatypeValueWitnessTables;
+ExistentialMetatypeValueWitnessTables("ExistentialMetatypeValueWitnessTables");
 
 /// The uniquing structure for existential metatype type metadata.
-static SimpleGlobalCache<ExistentialMetatypeCacheEntry> ExistentialMetatypes;
+static SimpleGlobalCache<ExistentialMetatypeCacheEntry>
+    ExistentialMetatypes("ExistentialMetatypes");
 
 static const ExtraInhabitantsValueWitnessTable
 ExistentialMetatypeValueWitnesses_1 =
@@ -2064,7 +2133,8 @@ public:
 } // end anonymous namespace
 
 /// The uniquing structure for existential type metadata.
-static SimpleGlobalCache<ExistentialCacheEntry> ExistentialTypes;
+static SimpleGlobalCache<ExistentialCacheEntry>
+    ExistentialTypes("ExistentialTypes");
 
 static const ValueWitnessTable OpaqueExistentialValueWitnesses_0 =
   ValueWitnessTableForBox<OpaqueExistentialBox<0>>::table;
@@ -2073,7 +2143,7 @@ static const ValueWitnessTable OpaqueExistentialValueWitnesses_1 =
 
 /// The uniquing structure for opaque existential value witness tables.
 static SimpleGlobalCache<OpaqueExistentialValueWitnessTableCacheEntry>
-OpaqueExistentialValueWitnessTables;
+OpaqueExistentialValueWitnessTables("OpaqueExistentialValueWitnessTables");
 
 /// Instantiate a value witness table for an opaque existential container with
 /// the given number of witness table pointers.
@@ -2119,7 +2189,7 @@ static const ExtraInhabitantsValueWitnessTable ClassExistentialValueWitnesses_2
 
 /// The uniquing structure for class existential value witness tables.
 static SimpleGlobalCache<ClassExistentialValueWitnessTableCacheEntry>
-ClassExistentialValueWitnessTables;
+ClassExistentialValueWitnessTables("ClassExistentialValueWitnessTables");
 
 /// Instantiate a value witness table for a class-constrained existential
 /// container with the given number of witness table pointers.
@@ -2643,7 +2713,7 @@ void _swift_debug_verifyTypeLayoutAttribute(Metadata *type,
 namespace {
   class WitnessTableCacheEntry : public CacheEntry<WitnessTableCacheEntry> {
   public:
-    static const char *getName() { return "WitnessTableCache"; }
+    static constexpr const char *getName() { return "WitnessTableCache"; }
 
     WitnessTableCacheEntry(size_t numArguments) {
       assert(numArguments == getNumArguments());
@@ -2665,11 +2735,18 @@ namespace {
 using GenericWitnessTableCache = MetadataCache<WitnessTableCacheEntry>;
 using LazyGenericWitnessTableCache = Lazy<GenericWitnessTableCache>;
 
+/// The last word of the private data remembers the entry of the most recent
+/// lookup, so that repeated requests for the same conforming type don't have
+/// to search the cache.  The cache itself lives in the words before it.
+using LastWitnessTableEntry = std::atomic<const WitnessTableCacheEntry *>;
+static constexpr size_t WitnessTableCachePrivateDataWords =
+  NumGenericMetadataPrivateDataWords - 1;
+
 /// Fetch the cache for a generic witness-table structure.
 static GenericWitnessTableCache &getCache(GenericWitnessTable *gen) {
   // Keep this assert even if you change the representation above.
   static_assert(sizeof(LazyGenericWitnessTableCache) <=
-                sizeof(GenericWitnessTable::PrivateData),
+                WitnessTableCachePrivateDataWords * sizeof(void *),
                 "metadata cache is larger than the allowed space");
 
   auto lazyCache =
@@ -2677,6 +2754,15 @@ static GenericWitnessTableCache &getCache(GenericWitnessTable *gen) {
   return lazyCache->get();
 }
 
+/// Fetch the most recently used entry of a generic witness-table structure.
+/// The compiler zero-fills the private data, so this starts out null.
+static LastWitnessTableEntry &getLastEntry(GenericWitnessTable *gen) {
+  static_assert(sizeof(LastWitnessTableEntry) == sizeof(void *),
+                "last entry must fit in one word of private data");
+  return *reinterpret_cast<LastWitnessTableEntry *>(
+      &gen->PrivateData[WitnessTableCachePrivateDataWords]);
+}
+
 /// If there's no initializer, no private storage, and all requirements
 /// are present, we don't have to instantiate anything; just return the
 /// witness table template.
@@ -2770,6 +2856,15 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
     return genericTable->Pattern;
   }
 
+  // Fast path: generic code tends to ask for the same conformance over and
+  // over again, e.g. in the loops over a collection of collections.  The
+  // entry's key is stored right before it, so compare with that.
+  auto &lastEntry = getLastEntry(genericTable);
+  if (auto entry = lastEntry.load(std::memory_order_acquire)) {
+    if (entry->getArgumentsBuffer()[0] == type)
+      return entry->get(genericTable);
+  }
+
   // If type is not nullptr, the witness table depends on the substituted
   // conforming type, so use that are the key.
   constexpr const size_t numGenericArgs = 1;
@@ -2793,6 +2888,8 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
       return entry;
     });
 
+  // findOrAdd only returns entries which are fully initialized.
+  lastEntry.store(entry, std::memory_order_release);
   return entry->get(genericTable);
 }
 
@@ -17,6 +17,7 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "RuntimeStatistics.h"
 #include <condition_variable>
 #include <thread>
 
@@ -30,12 +31,50 @@ namespace swift {
 // metadata caches.  It might make sense in the future to take
 // advantage of the fact that we know that most allocations here
 // won't ever be deallocated.
-using MetadataAllocator = llvm::MallocAllocator;
+class MetadataAllocator : public llvm::AllocatorBase<MetadataAllocator> {
+public:
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t size,
+                                                size_t alignment) {
+    if (areRuntimeStatisticsEnabled())
+      recordMetadataAllocation(size);
+    return malloc(size);
+  }
+
+  // Pull in the templated overload.
+  using llvm::AllocatorBase<MetadataAllocator>::Allocate;
+
+  void Deallocate(const void *ptr, size_t size) {
+    free(const_cast<void *>(ptr));
+  }
 
-/// A typedef for simple global caches.
+  // Pull in the templated overload.
+  using llvm::AllocatorBase<MetadataAllocator>::Deallocate;
+
+  void PrintStats() const {}
+};
+
+/// A simple global cache, which counts its hits and insertions if the
+/// runtime statistics are enabled.
 template <class EntryTy>
-using SimpleGlobalCache =
-  ConcurrentMap<EntryTy, /*destructor*/ false, MetadataAllocator>;
+class SimpleGlobalCache {
+  ConcurrentMap<EntryTy, /*destructor*/ false, MetadataAllocator> Map;
+  CacheStatistics Stats;
+
+public:
+  constexpr SimpleGlobalCache(const char *name) : Stats(name) {}
+
+  template <class KeyTy, class... ArgTys>
+  std::pair<EntryTy*, bool> getOrInsert(KeyTy key, ArgTys &&... args) {
+    auto result = Map.getOrInsert(key, std::forward<ArgTys>(args)...);
+    if (result.second) {
+      Stats.recordMiss();
+      Stats.recordInsertion();
+    } else {
+      Stats.recordHit();
+    }
+    return result;
+  }
+};
 
 // A wrapper around a pointer to a metadata cache entry that provides
 // DenseMap semantics that compare values in the key vector for the metadata
@@ -253,14 +292,29 @@ template <class ValueTy> class MetadataCache {
   /// The concurrent map.
   ConcurrentMap<Entry, /*Destructor*/ false, MetadataAllocator> Map;
 
+  /// The statistics of all the caches with this entry type. They are kept
+  /// out of line because a cache has to fit in the private data of a generic
+  /// metadata pattern or witness table.
+  static CacheStatistics Stats;
+
   struct ConcurrencyControl {
     Mutex Lock;
     ConditionVariable Queue;
   };
-  std::unique_ptr<ConcurrencyControl> Concurrency;
+
+  /// The number of locks that threads waiting for an entry are spread
+  /// across. Threads instantiating unrelated entries of the same cache
+  /// only contend when their keys hash to the same shard.
+  static constexpr size_t NumConcurrencyShards = 8;
+  std::unique_ptr<ConcurrencyControl[]> Concurrency;
+
+  ConcurrencyControl *getConcurrency(size_t hash) {
+    return &Concurrency[hash % NumConcurrencyShards];
+  }
 
 public:
-  MetadataCache() : Concurrency(new ConcurrencyControl()) {}
+  MetadataCache()
+    : Concurrency(new ConcurrencyControl[NumConcurrencyShards]) {}
   ~MetadataCache() = default;
 
   /// Caches are not copyable.
@@ -303,13 +357,15 @@ public:
       // If the entry is already initialized, great.
       auto value = entry->getValue();
       if (value) {
+        Stats.recordHit();
         return value;
       }
 
       // Otherwise, we have to grab the lock and wait for the value to
       // appear there.  Note that we have to check again immediately
       // after acquiring the lock to prevent a race.
-      auto concurrency = Concurrency.get();
+      LockWaitTimer timer;
+      auto concurrency = getConcurrency(key.Hash);
       concurrency->Lock.withLockOrWait(concurrency->Queue, [&, this] {
         if ((value = entry->getValue())) {
           return true; // found a value, done waiting
@@ -327,12 +383,16 @@ public:
 
         return false; // don't have a value, continue waiting
       });
+      timer.record(Stats);
+      Stats.recordHit();
 
       return value;
     }
 
     // Otherwise, we created the entry and are responsible for
     // creating the metadata.
+    Stats.recordMiss();
+    Stats.recordInsertion();
     auto value = builder();
 
 #if SWIFT_DEBUG_RUNTIME
@@ -341,7 +401,7 @@ public:
 #endif
 
     // Acquire the lock, set the value, and notify any waiters.
-    auto concurrency = Concurrency.get();
+    auto concurrency = getConcurrency(key.Hash);
     concurrency->Lock.withLockThenNotifyAll(
         concurrency->Queue, [&entry, &value] { entry->setValue(value); });
 
@@ -349,6 +409,9 @@ public:
   }
 };
 
+template <class ValueTy>
+CacheStatistics MetadataCache<ValueTy>::Stats(ValueTy::getName());
+
 } // namespace swift
 
 #endif // SWIFT_RUNTIME_METADATACACHE_H
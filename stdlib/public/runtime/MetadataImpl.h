@@ -132,21 +132,21 @@ struct NativeBox {
   }
   
   static T *initializeArrayWithTakeFrontToBack(T *dest, T *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
     
     T *r = dest;
     while (n--) {
-      new (dest) T(*src);
+      initializeWithTake(dest, src);
       dest = next(dest); src = next(src);
     }
     return r;
   }
   
   static T *initializeArrayWithTakeBackToFront(T *dest, T *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
@@ -155,7 +155,7 @@ struct NativeBox {
     dest = next(dest, n); src = next(src, n);
     while (n--) {
       dest = prev(dest); src = prev(src);
-      new (dest) T(*src);
+      initializeWithTake(dest, src);
     }
     return r;
   }
@@ -694,7 +694,7 @@ struct AggregateBox {
     return r;
   }
   static char *initializeArrayWithTakeFrontToBack(char *dest, char *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
@@ -707,7 +707,7 @@ struct AggregateBox {
     return r;
   }
   static char *initializeArrayWithTakeBackToFront(char *dest, char *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
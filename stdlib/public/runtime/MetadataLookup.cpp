@@ -105,7 +105,12 @@ static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
 struct TypeMetadataState {
   ConcurrentMap<TypeMetadataCacheEntry> Cache;
   std::vector<TypeMetadataSection> SectionsToScan;
-  Mutex SectionsToScanLock;
+  /// Read with SectionsToScanLock held for reading, and updated with it held
+  /// for writing.
+  TypeByMangledNameIndex TypesByName;
+  /// Lookups by name, which only read the sections and their index, are far
+  /// more frequent than loads of new images, which add sections.
+  ReadWriteLock SectionsToScanLock;
 
   TypeMetadataState() {
     SectionsToScan.reserve(16);
@@ -126,7 +131,7 @@ static void
 _registerTypeMetadataRecords(TypeMetadataState &T,
                              const TypeMetadataRecord *begin,
                              const TypeMetadataRecord *end) {
-  ScopedLock guard(T.SectionsToScanLock);
+  ScopedWriteLock guard(T.SectionsToScanLock);
   T.SectionsToScan.push_back(TypeMetadataSection{begin, end});
 }
 
@@ -228,26 +233,27 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
 
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
+  TypeByMangledNameIndex::Entry entry;
+  bool indexed = false, found = false;
+  T.SectionsToScanLock.withReadLock([&] {
+    indexed = T.TypesByName.isIndexed(T.SectionsToScan);
+    if (indexed)
+      found = T.TypesByName.find(typeName, entry);
+  });
 
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
+  // Images were loaded since the last lookup; index their sections first.
+  if (!indexed) {
+    T.SectionsToScanLock.withWriteLock([&] {
+      T.TypesByName.index(T.SectionsToScan);
+      found = T.TypesByName.find(typeName, entry);
+    });
   }
 
-  return nullptr;
+  if (!found)
+    return nullptr;
+  return TypeByMangledNameIndex::getMetadata(typeName, entry);
 }
 
 static const Metadata *
@@ -261,9 +267,7 @@ _typeByMangledName(const llvm::StringRef typeName) {
     return Value->getMetadata();
 
   // Check type metadata records
-  T.SectionsToScanLock.withLock([&] {
-    foundMetadata = _searchTypeMetadataRecords(T, typeName);
-  });
+  foundMetadata = _searchTypeMetadataRecords(T, typeName);
 
   // Check protocol conformances table. Note that this has no support for
   // resolving generic types yet.
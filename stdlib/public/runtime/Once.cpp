@@ -17,6 +17,7 @@
 #include "Private.h"
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
 #include <type_traits>
 
 using namespace swift;
@@ -35,6 +36,13 @@ static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
 static_assert(sizeof(swift_once_t) <= sizeof(void*),
               "swift_once_t must be no larger than the platform word");
 
+#if defined(SWIFT_ONCE_DONE)
+// Threads which find an initializer running wait on these until it is done.
+// Initializers rarely race, so all tokens share them.
+static StaticMutex OnceMutex;
+static StaticConditionVariable OnceDone;
+#endif
+
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
@@ -43,14 +51,32 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
   dispatch_once_f(predicate, nullptr, fn);
 #elif defined(__CYGWIN__)
   _swift_once_f(predicate, nullptr, fn);
+#elif defined(SWIFT_ONCE_DONE)
+  // The compiler emits this check inline, but the runtime's own callers
+  // don't.
+  if (__atomic_load_n(predicate, __ATOMIC_ACQUIRE) == SWIFT_ONCE_DONE)
+    return;
+
+  swift_once_t expected = 0;
+  if (__atomic_compare_exchange_n(predicate, &expected, SWIFT_ONCE_RUNNING,
+                                  /*weak*/ false, __ATOMIC_ACQUIRE,
+                                  __ATOMIC_ACQUIRE)) {
+    fn(nullptr);
+    // Publish the "done" value under the lock, so that a waiter can't miss
+    // the notification between checking the token and waiting.
+    OnceMutex.withLockThenNotifyAll(OnceDone, [&] {
+      __atomic_store_n(predicate, SWIFT_ONCE_DONE, __ATOMIC_RELEASE);
+    });
+    return;
+  }
+
+  OnceMutex.withLockOrWait(OnceDone, [&] {
+    return __atomic_load_n(predicate, __ATOMIC_ACQUIRE) == SWIFT_ONCE_DONE;
+  });
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // The MSVC port also relies on this, because the std::call_once on MSVC
-  // follows the compatible init process.
+  // FIXME: The MSVC port relies on the coincidence that std::call_once on MSVC
+  // follows a compatible init process (the token is a word which starts out
+  // as zero). It should use the implementation above.
   // For more information, see rdar://problem/18499385
   std::call_once(*predicate, [fn]() { fn(nullptr); });
 #endif
@@ -20,6 +20,8 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Compiler.h"
 
 // Opaque ISAs need to use object_getClass which is in runtime.h
@@ -156,8 +158,93 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  /// An index by mangled name of the types which the records of a list of
+  /// sections refer to. Sections are added to the index when a lookup first
+  /// needs them, so every record is visited once instead of by every lookup
+  /// which misses the caches. A lookup finds the same type as a scan of the
+  /// records in section order with _matchMetadataByMangledTypeName would.
+  ///
+  /// The index is not thread-safe. Lookups of an up-to-date index only read
+  /// it, so they may run concurrently with each other, but not with index().
+  class TypeByMangledNameIndex {
+  public:
+    /// The record for a type: either its metadata, or the descriptor whose
+    /// access function produces it.
+    struct Entry {
+      const Metadata *Type;
+      const NominalTypeDescriptor *Description;
+    };
+
+  private:
+    llvm::DenseMap<llvm::StringRef, Entry> Types;
+    size_t NumIndexedSections = 0;
+
+    template <typename Record>
+    void addRecord(const Record &record) {
+      if (auto metadata = record.getCanonicalTypeMetadata()) {
+        if (auto ntd = metadata->getNominalTypeDescriptor().get())
+          Types.insert({ntd->Name.get(), Entry{metadata, nullptr}});
+        return;
+      }
+
+      // Only a non-generic type's descriptor can produce metadata.
+      auto ntd = record.getNominalTypeDescriptor();
+      if (!ntd || ntd->GenericParams.isGeneric() || !ntd->getAccessFunction())
+        return;
+      // If several records name the type, the first one wins.
+      Types.insert({ntd->Name.get(), Entry{nullptr, ntd}});
+    }
+
+  public:
+    /// Returns true if all of \p sections are in the index.
+    template <typename SectionList>
+    bool isIndexed(const SectionList &sections) const {
+      return NumIndexedSections == sections.size();
+    }
+
+    /// Adds the sections which were appended to \p sections since the last
+    /// call to the index.
+    template <typename SectionList>
+    void index(const SectionList &sections) {
+      for (; NumIndexedSections < sections.size(); ++NumIndexedSections)
+        for (const auto &record : sections[NumIndexedSections])
+          addRecord(record);
+    }
+
+    /// Finds the record for \p typeName in the indexed sections.
+    bool find(llvm::StringRef typeName, Entry &result) const {
+      auto found = Types.find(typeName);
+      if (found == Types.end())
+        return false;
+      result = found->second;
+      return true;
+    }
+
+    /// Returns the metadata of a type found in the index. May call the
+    /// type's access function, so it doesn't need to be serialized.
+    static const Metadata *getMetadata(llvm::StringRef typeName,
+                                       const Entry &entry) {
+      return _matchMetadataByMangledTypeName(typeName, entry.Type,
+                                             entry.Description);
+    }
+
+    template <typename SectionList>
+    const Metadata *lookup(const SectionList &sections,
+                           llvm::StringRef typeName) {
+      index(sections);
+      Entry entry;
+      if (!find(typeName, entry))
+        return nullptr;
+      return getMetadata(typeName, entry);
+    }
+  };
+
 #if SWIFT_OBJC_INTEROP
-  Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
+  /// Build a demangling tree for the given type metadata.  The nodes are
+  /// allocated in \p Factory and must not outlive it.
+  Demangle::NodePointer
+  _swift_buildDemanglingForMetadata(const Metadata *type,
+                                    Demangle::NodeFactory &Factory);
 #endif
 
   /// A helper function which avoids performing a store if the destination
@@ -20,6 +20,9 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
 #include "Private.h"
+#include "RuntimeStatistics.h"
+#include <algorithm>
+#include <vector>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -229,6 +232,50 @@ namespace {
       return FailureGeneration.load(std::memory_order_relaxed);
     }
   };
+
+  /// All of the conformance records for a single protocol, indexed when
+  /// their image is loaded so that a cache miss only has to look at the
+  /// records that could possibly answer it.
+  struct ProtocolConformanceRecords {
+  private:
+    const ProtocolDescriptor *Proto;
+
+    /// The index of the section that records for this protocol were most
+    /// recently added from, plus one.  A negative cache entry whose failure
+    /// generation is at least this large is still valid, no matter how many
+    /// unrelated images have been loaded since.
+    std::atomic<unsigned> Generation;
+
+  public:
+    /// The records, in registration order, paired with the index of the
+    /// section they came from.  Only accessed with SectionsToScanLock held.
+    std::vector<std::pair<unsigned, const ProtocolConformanceRecord *>>
+      Records;
+
+    ProtocolConformanceRecords(const ProtocolDescriptor *proto)
+      : Proto(proto), Generation(0) {}
+
+    int compareWithKey(const ProtocolDescriptor *proto) const {
+      if (proto != Proto)
+        return (uintptr_t(proto) < uintptr_t(Proto) ? -1 : 1);
+      return 0;
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+
+    void addRecord(unsigned sectionIdx,
+                   const ProtocolConformanceRecord *record) {
+      Records.push_back({sectionIdx, record});
+      Generation.store(sectionIdx + 1, std::memory_order_release);
+    }
+
+    unsigned getGeneration() const {
+      return Generation.load(std::memory_order_acquire);
+    }
+  };
 }
 
 // Conformance Cache.
@@ -247,8 +294,13 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
 
 struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
+  ConcurrentMap<ProtocolConformanceRecords> RecordsByProtocol;
   std::vector<ConformanceSection> SectionsToScan;
+  /// The conforming types by name.  Only accessed with SectionsToScanLock
+  /// held.
+  TypeByMangledNameIndex TypesByName;
   Mutex SectionsToScanLock;
+  CacheStatistics CacheStats{"ConformanceCache"};
   
   ConformanceState() {
     SectionsToScan.reserve(16);
@@ -269,6 +321,8 @@ struct ConformanceState {
     // If the entry was already present, we may need to update it.
     if (!result.second) {
       result.first->makeSuccessful(witness);
+    } else {
+      CacheStats.recordInsertion();
     }
   }
 
@@ -281,6 +335,8 @@ struct ConformanceState {
     // If the entry was already present, we may need to update it.
     if (!result.second) {
       result.first->updateFailureGeneration(failureGeneration);
+    } else {
+      CacheStats.recordInsertion();
     }
   }
 
@@ -288,6 +344,23 @@ struct ConformanceState {
                                     const ProtocolDescriptor *proto) {
     return Cache.find(ConformanceCacheKey(type, proto));
   }
+
+  /// Add the records of a newly-loaded section to the per-protocol index.
+  /// Must be called with SectionsToScanLock held.
+  void indexSection(unsigned sectionIdx, const ConformanceSection &section) {
+    for (const auto &record : section) {
+      auto entry = RecordsByProtocol.getOrInsert(record.getProtocol());
+      entry.first->addRecord(sectionIdx, &record);
+    }
+  }
+
+  /// Is a negative result recorded at \p failureGeneration still valid for
+  /// \p proto?  This can be answered without taking any lock.
+  bool isFailureCurrent(unsigned failureGeneration,
+                        const ProtocolDescriptor *proto) {
+    auto records = RecordsByProtocol.find(proto);
+    return !records || failureGeneration >= records->getGeneration();
+  }
 };
 
 static Lazy<ConformanceState> Conformances;
@@ -297,7 +370,9 @@ _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *begin,
                               const ProtocolConformanceRecord *end) {
   ScopedLock guard(C.SectionsToScanLock);
+  unsigned sectionIdx = C.SectionsToScan.size();
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.indexSection(sectionIdx, C.SectionsToScan.back());
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -489,8 +564,9 @@ recur_inside_cache_lock:
       if (type == origType)
         foundEntry = Value;
 
-      // If we got a cached negative response, check the generation number.
-      if (Value->getFailureGeneration() == C.SectionsToScan.size()) {
+      // If we got a cached negative response, check that no conformances to
+      // this protocol have been loaded since.
+      if (C.isFailureCurrent(Value->getFailureGeneration(), protocol)) {
         // We found an entry with a negative value.
         return std::make_pair(nullptr, true);
       }
@@ -568,10 +644,13 @@ swift::swift_conformsToProtocol(const Metadata *type,
   auto origType = type;
   unsigned numSections = 0;
   ConformanceCacheEntry *foundEntry;
+  bool missed = false;
 
 recur:
   // See if we have a cached conformance. The ConcurrentMap data structure
-  // allows us to insert and search the map concurrently without locking.
+  // allows us to insert and search the map concurrently without locking,
+  // and negative entries are validated against the per-protocol record
+  // generation, so a warm cache never takes the lock.
   // We do lock the slow path because the SectionsToScan data structure is not
   // concurrent.
   auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
@@ -580,12 +659,25 @@ recur:
   // it may mean that all of the superclasses do not have this conformance,
   // but the actual type may still have this conformance.
   if (FoundConformance.second) {
-    if (FoundConformance.first || foundEntry)
+    if (FoundConformance.first || foundEntry) {
+      if (!missed)
+        C.CacheStats.recordHit();
       return FoundConformance.first;
+    }
+  }
+
+  if (!missed) {
+    C.CacheStats.recordMiss();
+    missed = true;
   }
 
   // If we didn't have an up-to-date cache entry, scan the conformance records.
-  C.SectionsToScanLock.lock();
+  // Only time the lock if some other thread holds it.
+  if (!C.SectionsToScanLock.try_lock()) {
+    LockWaitTimer timer;
+    C.SectionsToScanLock.lock();
+    timer.record(C.CacheStats);
+  }
   unsigned failedGeneration = ConformanceCacheGeneration;
 
   // If we have no new information to pull in (and nobody else pulled in
@@ -610,22 +702,24 @@ recur:
   // Update the last known number of sections to scan.
   numSections = C.SectionsToScan.size();
 
-  // Scan only sections that were not scanned yet.
+  // Scan only the records for this protocol from sections that were not
+  // scanned yet.
   unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
+  if (auto records = C.RecordsByProtocol.find(protocol)) {
+    auto begin = std::lower_bound(
+      records->Records.begin(), records->Records.end(), sectionIdx,
+      [](const std::pair<unsigned, const ProtocolConformanceRecord *> &entry,
+         unsigned idx) {
+        return entry.first < idx;
+      });
+
+    for (auto it = begin, end = records->Records.end(); it != end; ++it) {
+      const auto &record = *it->second;
+      auto P = record.getProtocol();
+      assert(P == protocol && "record indexed under the wrong protocol");
 
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, metadata, /*isMetadata=*/true))
           continue;
 
@@ -644,11 +738,6 @@ recur:
                    == TypeMetadataRecordKind::UniqueNominalTypeDescriptor) {
 
         auto R = record.getNominalTypeDescriptor();
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
 
         if (!isRelatedType(type, R, /*isMetadata=*/false))
           continue;
@@ -682,27 +771,6 @@ recur:
 const Metadata *
 swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
   auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
-
   ScopedLock guard(C.SectionsToScanLock);
-
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        break;
-    }
-    if (foundMetadata != nullptr)
-      break;
-  }
-
-  return foundMetadata;
+  return C.TypesByName.lookup(C.SectionsToScan, typeName);
 }
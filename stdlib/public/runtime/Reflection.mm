@@ -12,6 +12,7 @@
 
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Runtime/Reflection.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
@@ -417,6 +418,64 @@ static const char *getFieldName(const char *fieldNames, size_t i) {
   return fieldName;
 }
 
+namespace {
+/// The field names of a struct or class, indexed by field number, so that a
+/// mirror visiting all of the fields of a type doesn't rescan the list of
+/// names for each of them.
+struct FieldNamesEntry {
+  /// The lookup key, the doubly-null-terminated list of names from the
+  /// nominal type descriptor.
+  const char *FieldNames;
+  size_t NumFields;
+
+  FieldNamesEntry(const char *fieldNames, size_t numFields)
+      : FieldNames(fieldNames), NumFields(numFields) {
+    const char **names = getNames();
+    const char *fieldName = fieldNames;
+    for (size_t i = 0; i < numFields; ++i) {
+      names[i] = fieldName;
+      fieldName += strlen(fieldName) + 1;
+    }
+  }
+
+  const char **getNames() {
+    return reinterpret_cast<const char **>(this + 1);
+  }
+
+  const char *getName(size_t i) const {
+    assert(i < NumFields);
+    return reinterpret_cast<const char * const *>(this + 1)[i];
+  }
+
+  int compareWithKey(const char *fieldNames) const {
+    if (fieldNames != FieldNames)
+      return (uintptr_t(fieldNames) < uintptr_t(FieldNames) ? -1 : 1);
+    return 0;
+  }
+
+  static size_t getExtraAllocationSize(const char *fieldNames,
+                                       size_t numFields) {
+    return numFields * sizeof(const char *);
+  }
+
+  size_t getExtraAllocationSize() const {
+    return NumFields * sizeof(const char *);
+  }
+};
+} // end unnamed namespace
+
+static ConcurrentMap<FieldNamesEntry, /*Destructor*/ false> FieldNamesCache;
+
+/// Get the name of field \p i of a struct or class. Lookups of types whose
+/// names were already indexed don't take any locks.
+static const char *getCachedFieldName(const char *fieldNames,
+                                      size_t numFields, size_t i) {
+  auto entry = FieldNamesCache.find(fieldNames);
+  if (!entry)
+    entry = FieldNamesCache.getOrInsert(fieldNames, numFields).first;
+  return entry->getName(i);
+}
+
 
 static bool loadSpecialReferenceStorage(HeapObject *owner,
                                         OpaqueValue *fieldData,
@@ -503,7 +562,7 @@ void swift_StructMirror_subscript(String *outString,
                                   const Metadata *type) {
   auto Struct = static_cast<const StructMetadata *>(type);
   
-  if (i < 0 || (size_t)i > Struct->Description->Struct.NumFields)
+  if (i < 0 || (size_t)i >= Struct->Description->Struct.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
   // Load the type and offset from their respective vectors.
@@ -513,7 +572,9 @@ void swift_StructMirror_subscript(String *outString,
   auto bytes = reinterpret_cast<char*>(value);
   auto fieldData = reinterpret_cast<OpaqueValue *>(bytes + fieldOffset);
 
-  new (outString) String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  new (outString) String(
+    getCachedFieldName(Struct->Description->Struct.FieldNames,
+                       Struct->Description->Struct.NumFields, i));
 
   // 'owner' is consumed by this call.
   assert(!fieldType.isIndirect() && "indirect struct fields not implemented");
@@ -718,7 +779,7 @@ void swift_ClassMirror_subscript(String *outString,
     --i;
   }
   
-  if (i < 0 || (size_t)i > Clas->getDescription()->Class.NumFields)
+  if (i < 0 || (size_t)i >= Clas->getDescription()->Class.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
   // Load the type and offset from their respective vectors.
@@ -745,8 +806,9 @@ void swift_ClassMirror_subscript(String *outString,
   auto bytes = *reinterpret_cast<char * const *>(value);
   auto fieldData = reinterpret_cast<OpaqueValue *>(bytes + fieldOffset);
 
-  new (outString) String(getFieldName(Clas->getDescription()->Class.FieldNames,
-                                      i));
+  new (outString) String(
+    getCachedFieldName(Clas->getDescription()->Class.FieldNames,
+                       Clas->getDescription()->Class.NumFields, i));
 
  if (loadSpecialReferenceStorage(owner, fieldData, fieldType, outMirror))
    return;
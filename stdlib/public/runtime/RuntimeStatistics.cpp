@@ -0,0 +1,101 @@
+//===--- RuntimeStatistics.cpp - Runtime cache statistics -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "RuntimeStatistics.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/InstrumentsSupport.h"
+#include "swift/Runtime/Once.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace swift;
+
+std::atomic<RuntimeStatisticsState> swift::RuntimeStatisticsStateValue;
+static swift_once_t RuntimeStatisticsOnce;
+
+/// The caches which have recorded something, most recently used first.
+static std::atomic<CacheStatistics *> AllCaches;
+
+static std::atomic<uint64_t> MetadataAllocations;
+static std::atomic<uint64_t> MetadataAllocatedBytes;
+
+static void printRuntimeStatisticsAtExit() {
+  CacheStatistics::printAll();
+}
+
+static void readRuntimeStatisticsEnvironment(void *) {
+  bool enabled = false;
+  if (const char *env = getenv("SWIFT_DEBUG_RUNTIME_STATISTICS"))
+    enabled = strcmp(env, "0") != 0;
+
+  if (enabled)
+    atexit(printRuntimeStatisticsAtExit);
+
+  RuntimeStatisticsStateValue.store(enabled ? RuntimeStatisticsState::Enabled
+                                            : RuntimeStatisticsState::Disabled,
+                                    std::memory_order_release);
+}
+
+bool swift::initializeRuntimeStatistics() {
+  swift_once(&RuntimeStatisticsOnce, readRuntimeStatisticsEnvironment);
+  return RuntimeStatisticsStateValue.load(std::memory_order_acquire)
+           == RuntimeStatisticsState::Enabled;
+}
+
+void swift::recordMetadataAllocation(size_t size) {
+  MetadataAllocations.fetch_add(1, std::memory_order_relaxed);
+  MetadataAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void CacheStatistics::registerCache() {
+  if (Registered.exchange(true, std::memory_order_acq_rel))
+    return;
+  auto head = AllCaches.load(std::memory_order_acquire);
+  do {
+    Next = head;
+  } while (!AllCaches.compare_exchange_weak(head, this,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire));
+}
+
+void CacheStatistics::printAll() {
+  auto load = [](const std::atomic<uint64_t> &counter) {
+    return counter.load(std::memory_order_relaxed);
+  };
+
+  fprintf(stderr, "*** Swift runtime statistics ***\n");
+  fprintf(stderr, "%-36s %12s %12s %12s %12s %12s\n", "cache", "hits",
+          "misses", "insertions", "lock waits", "wait (us)");
+  for (auto cache = AllCaches.load(std::memory_order_acquire); cache;
+       cache = cache->Next) {
+    fprintf(stderr,
+            "%-36s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+            " %12" PRIu64 "\n",
+            cache->Name, load(cache->Hits), load(cache->Misses),
+            load(cache->Insertions), load(cache->LockWaits),
+            load(cache->LockWaitNanoseconds) / 1000);
+  }
+  fprintf(stderr, "metadata allocator: %" PRIu64 " bytes in %" PRIu64
+          " allocations\n", load(MetadataAllocatedBytes),
+          load(MetadataAllocations));
+}
+
+SWIFT_RUNTIME_EXPORT
+extern "C"
+bool swift::_swift_printRuntimeStatistics() {
+  if (!areRuntimeStatisticsEnabled())
+    return false;
+  CacheStatistics::printAll();
+  return true;
+}
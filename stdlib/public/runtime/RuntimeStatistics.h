@@ -0,0 +1,136 @@
+//===--- RuntimeStatistics.h - Runtime cache statistics ---------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters of the hits, misses and lock waits of the runtime's caches and of
+// the memory allocated for metadata. They are only maintained if the
+// SWIFT_DEBUG_RUNTIME_STATISTICS environment variable is set, in which case
+// they are printed to stderr when the process exits.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_RUNTIMESTATISTICS_H
+#define SWIFT_RUNTIME_RUNTIMESTATISTICS_H
+
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace swift {
+
+enum class RuntimeStatisticsState : uint8_t { Unknown, Enabled, Disabled };
+
+extern std::atomic<RuntimeStatisticsState> RuntimeStatisticsStateValue;
+
+/// Read SWIFT_DEBUG_RUNTIME_STATISTICS; returns whether it is set.
+bool initializeRuntimeStatistics();
+
+/// Are the runtime statistics being collected?
+inline bool areRuntimeStatisticsEnabled() {
+  auto state = RuntimeStatisticsStateValue.load(std::memory_order_relaxed);
+  if (LLVM_LIKELY(state == RuntimeStatisticsState::Disabled))
+    return false;
+  if (state == RuntimeStatisticsState::Enabled)
+    return true;
+  return initializeRuntimeStatistics();
+}
+
+/// Record an allocation of \p size bytes by the MetadataAllocator.
+void recordMetadataAllocation(size_t size);
+
+/// The counters of one runtime cache.
+///
+/// A CacheStatistics has a constexpr constructor, so that it can be a member
+/// of a cache which is a global. It adds itself to the list of caches which
+/// are printed the first time something is recorded in it.
+class CacheStatistics {
+  const char *Name;
+  CacheStatistics *Next = nullptr;
+  std::atomic<bool> Registered{false};
+
+  std::atomic<uint64_t> Hits{0};
+  std::atomic<uint64_t> Misses{0};
+  std::atomic<uint64_t> Insertions{0};
+  std::atomic<uint64_t> LockWaits{0};
+  std::atomic<uint64_t> LockWaitNanoseconds{0};
+
+  void registerCache();
+
+  void add(std::atomic<uint64_t> &counter, uint64_t value) {
+    if (LLVM_UNLIKELY(!Registered.load(std::memory_order_acquire)))
+      registerCache();
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+public:
+  constexpr CacheStatistics(const char *name) : Name(name) {}
+
+  CacheStatistics(const CacheStatistics &) = delete;
+  CacheStatistics &operator=(const CacheStatistics &) = delete;
+
+  /// A lookup found an entry.
+  void recordHit() {
+    if (areRuntimeStatisticsEnabled())
+      add(Hits, 1);
+  }
+
+  /// A lookup didn't find an entry.
+  void recordMiss() {
+    if (areRuntimeStatisticsEnabled())
+      add(Misses, 1);
+  }
+
+  /// An entry was added.
+  void recordInsertion() {
+    if (areRuntimeStatisticsEnabled())
+      add(Insertions, 1);
+  }
+
+  /// A lookup waited \p nanoseconds for a lock or for another thread to
+  /// finish initializing an entry.
+  void recordLockWait(uint64_t nanoseconds) {
+    if (areRuntimeStatisticsEnabled()) {
+      add(LockWaits, 1);
+      LockWaitNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+  }
+
+  /// Print the counters of all caches which have recorded something, and
+  /// of the MetadataAllocator, to stderr.
+  static void printAll();
+};
+
+/// Measures how long a lock is waited for, if the runtime statistics are
+/// being collected.
+class LockWaitTimer {
+  std::chrono::steady_clock::time_point Start;
+  bool Enabled;
+
+public:
+  LockWaitTimer() : Enabled(areRuntimeStatisticsEnabled()) {
+    if (Enabled)
+      Start = std::chrono::steady_clock::now();
+  }
+
+  /// Record the time since the timer was created in \p stats.
+  void record(CacheStatistics &stats) {
+    if (!Enabled)
+      return;
+    auto elapsed = std::chrono::steady_clock::now() - Start;
+    stats.recordLockWait(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+};
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_RUNTIMESTATISTICS_H
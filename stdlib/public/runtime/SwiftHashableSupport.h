@@ -58,6 +58,11 @@ const Metadata *findHashableBaseTypeOfHashableType(
 /// If `type` does not conform to `Hashable`, `nullptr` is returned.
 const Metadata *findHashableBaseType(const Metadata *type);
 
+/// Find the `Hashable` witness table of `type`.  The result is cached
+/// together with the base type, so repeated lookups don't take locks.
+/// If `type` does not conform to `Hashable`, `nullptr` is returned.
+const HashableWitnessTable *findHashableConformance(const Metadata *type);
+
 } // namespace hashable_support
 } // namespace swift
 
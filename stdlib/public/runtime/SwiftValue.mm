@@ -96,7 +96,7 @@ const Metadata *SwiftValueHeader::getHashableBaseType() const {
       expectedType, hashableBaseType ? hashableBaseType
                                      : reinterpret_cast<const Metadata *>(1),
       std::memory_order_acq_rel);
-  return type;
+  return hashableBaseType;
 }
 
 const hashable_support::HashableWitnessTable *
@@ -109,9 +109,7 @@ SwiftValueHeader::getHashableConformance() const {
   }
 
   const HashableWitnessTable *expectedWT = nullptr;
-  const HashableWitnessTable *wt =
-      reinterpret_cast<const HashableWitnessTable *>(
-          swift_conformsToProtocol(type, &HashableProtocolDescriptor));
+  const HashableWitnessTable *wt = findHashableConformance(type);
   hashableConformance.compare_exchange_strong(
       expectedWT, wt ? wt : reinterpret_cast<const HashableWitnessTable *>(1),
       std::memory_order_acq_rel);
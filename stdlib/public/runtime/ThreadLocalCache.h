@@ -0,0 +1,118 @@
+//===--- ThreadLocalCache.h - Lazily-created per-thread caches --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The runtime can't use C++ thread_local, which isn't supported on all of the
+// deployment targets it runs on.  Per-thread caches are instead allocated on
+// first use and reached through a pthread key.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_THREADLOCALCACHE_H
+#define SWIFT_RUNTIME_THREADLOCALCACHE_H
+
+#include "swift/Runtime/Once.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+namespace swift {
+
+template <class T>
+void destroyNothing(T *) {}
+
+/// A lazily-created instance of \p T for each thread.
+///
+/// T must be plain data; each thread's instance starts out zero-filled.
+/// When the thread exits, \p Destroy is called on the instance
+/// before it is freed.  From then on get() returns null on that thread, as
+/// it does if the instance can't be created at all, so callers must always
+/// be prepared to do without the cache.
+///
+/// Everything here is zero-initialized, so declaring a cache never requires
+/// a static initializer.
+template <class T, void (*Destroy)(T *) = destroyNothing<T>>
+class ThreadLocalCache {
+#if !defined(_WIN32)
+  static swift_once_t KeyOnce;
+  static pthread_key_t Key;
+  static std::atomic<bool> KeyCreated;
+
+  /// Left in the key once the thread's instance has been destroyed.
+  static void *getTombstone() { return reinterpret_cast<void *>(uintptr_t(1)); }
+
+  static void createKey(void *) {
+    if (pthread_key_create(&Key, destroy) == 0)
+      KeyCreated.store(true, std::memory_order_release);
+  }
+
+  static void destroy(void *value) {
+    if (value != getTombstone()) {
+      auto *cache = static_cast<T *>(value);
+      Destroy(cache);
+      free(cache);
+    }
+
+    // Other keys' destructors may still use the runtime on this thread.
+    // Keep the tombstone in place so that they don't create an instance
+    // which would never be destroyed; pthread bounds the number of
+    // destructor rounds, so this doesn't keep the thread alive.
+    pthread_setspecific(Key, getTombstone());
+  }
+#endif
+
+public:
+  /// Get the calling thread's instance, creating it if necessary.
+  static T *get() {
+#if defined(_WIN32)
+    return nullptr;
+#else
+    if (LLVM_UNLIKELY(!KeyCreated.load(std::memory_order_acquire))) {
+      swift_once(&KeyOnce, createKey);
+      if (!KeyCreated.load(std::memory_order_acquire))
+        return nullptr;
+    }
+
+    void *value = pthread_getspecific(Key);
+    if (LLVM_LIKELY(value && value != getTombstone()))
+      return static_cast<T *>(value);
+    if (value)
+      return nullptr;
+
+    value = calloc(1, sizeof(T));
+    if (value && pthread_setspecific(Key, value) != 0) {
+      free(value);
+      return nullptr;
+    }
+    return static_cast<T *>(value);
+#endif
+  }
+};
+
+#if !defined(_WIN32)
+template <class T, void (*Destroy)(T *)>
+swift_once_t ThreadLocalCache<T, Destroy>::KeyOnce;
+
+template <class T, void (*Destroy)(T *)>
+pthread_key_t ThreadLocalCache<T, Destroy>::Key;
+
+template <class T, void (*Destroy)(T *)>
+std::atomic<bool> ThreadLocalCache<T, Destroy>::KeyCreated;
+#endif
+
+} // end namespace swift
+
+#endif
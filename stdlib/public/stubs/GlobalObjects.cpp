@@ -28,6 +28,19 @@ SWIFT_RUNTIME_STDLIB_INTERFACE
 extern "C" ClassMetadata _TMCs18_EmptyArrayStorage;
 }
 
+// FIXME: This is the only statically allocated array buffer. Array literals
+// with constant elements could be emitted the same way instead of being
+// allocated with swift_allocObject on each evaluation, but that needs:
+// - a refcount which swift_retain and swift_release leave alone, so that the
+//   object can live in read-only memory and never reaches zero; StrongRefCount
+//   has no such state yet;
+// - the isa pointer of _ContiguousArrayStorage<Element>, whose generic
+//   metadata is only instantiated at runtime, so the header can't be a
+//   constant and must be filled in once;
+// - a SIL instruction which references such an object, so that the optimizer
+//   can replace the allocation and initialization of a constant literal.
+// Copy-on-write would keep working without changes, because
+// isUniquelyReferenced never holds for an object with such a refcount.
 swift::_SwiftEmptyArrayStorage swift::_swiftEmptyArrayStorage = {
   // HeapObject header;
   {
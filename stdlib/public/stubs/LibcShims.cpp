@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Heap.h"
 #include "../SwiftShims/LibcShims.h"
 #include "llvm/Support/DataTypes.h"
 
@@ -86,11 +87,15 @@ int swift::_swift_stdlib_close(int fd) {
 #if defined(__APPLE__)
 #include <malloc/malloc.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_getMagazineBlockSize(ptr))
+    return size;
   return malloc_size(ptr);
 }
 #elif defined(__GNU_LIBRARY__) || defined(__CYGWIN__) || defined(__ANDROID__)
 #include <malloc.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_getMagazineBlockSize(ptr))
+    return size;
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #elif defined(_MSC_VER)
@@ -101,6 +106,8 @@ size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
 #elif defined(__FreeBSD__)
 #include <malloc_np.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_getMagazineBlockSize(ptr))
+    return size;
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #else
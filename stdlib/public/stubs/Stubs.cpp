@@ -31,11 +31,17 @@
 #include <unistd.h>
 #endif
 #include <climits>
+#include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 #if defined(__CYGWIN__) || defined(_MSC_VER)
 #include <sstream>
 #include <cmath>
@@ -71,19 +77,56 @@ static long double swift_strtold_l(const char *nptr,
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
 
+/// The decimal digits of 0 through 99.
+static const char DigitPairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static uint64_t uint64ToDecimalStringImpl(char *Buffer, uint64_t Value,
+                                          bool Negative) {
+  // Produce two digits per division, back to front.
+  char Digits[20];
+  char *End = Digits + sizeof(Digits);
+  char *D = End;
+  while (Value >= 100) {
+    unsigned Pair = unsigned(Value % 100);
+    Value /= 100;
+    D -= 2;
+    memcpy(D, &DigitPairs[Pair * 2], 2);
+  }
+  if (Value >= 10) {
+    D -= 2;
+    memcpy(D, &DigitPairs[Value * 2], 2);
+  } else {
+    *--D = '0' + char(Value);
+  }
+
+  char *P = Buffer;
+  if (Negative)
+    *P++ = '-';
+  memcpy(P, D, End - D);
+  return size_t(P - Buffer) + size_t(End - D);
+}
+
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
                                    bool Negative) {
+  if (Radix == 10)
+    return uint64ToDecimalStringImpl(Buffer, Value, Negative);
+
   char *P = Buffer;
   uint64_t Y = Value;
 
   if (Y == 0) {
     *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
-    }
   } else {
     unsigned Radix32 = Radix;
     while (Y) {
@@ -181,6 +224,96 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+/// Powers of ten that are exactly representable in a uint64_t.
+static const uint64_t PowersOf10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+  1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+  1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+/// Formats \p Value the way "%.*g" does with \p Precision, without calling
+/// printf, in the cases where the result is known up front:
+///
+/// - \p Value is an integer with at most \p Precision digits, so %g prints
+///   it exactly.
+/// - \p AllowFraction is set and some decimal with at most \p Precision
+///   significant digits converts to exactly \p Value. \p Precision must be at
+///   most digits10 for this, which guarantees that %g prints that decimal.
+///
+/// Returns the length of the result, or -1 if printf is needed.
+template <typename T>
+static int swift_formatShortDecimal(char *Buffer, T Value, int Precision,
+                                    bool AllowFraction) {
+  unsigned MaxDigits = std::min(Precision, 19);
+  T Limit = T(PowersOf10[MaxDigits]);
+  T Abs = std::fabs(Value);
+  // This also rejects infinities and NaNs.
+  if (!(Abs < Limit))
+    return -1;
+
+  uint64_t Digits;
+  unsigned Scale = 0;
+  if (Abs == std::trunc(Abs)) {
+    Digits = uint64_t(Abs);
+  } else {
+    if (!AllowFraction)
+      return -1;
+
+    // Find the fewest decimal places that reproduce the value. Scaling by an
+    // exact power of ten and dividing back are both correctly rounded, so the
+    // comparison is exact.
+    T Scaled = Abs;
+    T Divisor = 1;
+    for (;;) {
+      ++Scale;
+      // %g uses exponent notation below 1e-4.
+      if (Scale > unsigned(Precision) + 3)
+        return -1;
+      Scaled *= 10;
+      Divisor *= 10;
+      if (!(Scaled < Limit))
+        return -1;
+      T Rounded = std::nearbyint(Scaled);
+      if (Rounded / Divisor == Abs) {
+        Digits = uint64_t(Rounded);
+        break;
+      }
+    }
+    while (Scale != 0 && Digits % 10 == 0) {
+      Digits /= 10;
+      --Scale;
+    }
+    if (Scale > 4 && Digits < PowersOf10[Scale - 4])
+      return -1;
+  }
+
+  char Scratch[20];
+  unsigned NumDigits = 0;
+  do {
+    Scratch[NumDigits++] = '0' + char(Digits % 10);
+    Digits /= 10;
+  } while (Digits);
+
+  char *P = Buffer;
+  if (std::signbit(Value))
+    *P++ = '-';
+  if (NumDigits <= Scale) {
+    *P++ = '0';
+    *P++ = '.';
+    for (unsigned i = NumDigits; i < Scale; ++i)
+      *P++ = '0';
+  }
+  while (NumDigits) {
+    *P++ = Scratch[--NumDigits];
+    if (NumDigits == Scale && Scale != 0)
+      *P++ = '.';
+  }
+  *P = '\0';
+  return int(P - Buffer);
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -193,34 +326,40 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
     Precision = std::numeric_limits<T>::max_digits10;
   }
 
+  // Most printed values are integers or short decimals; those don't need the
+  // locale-aware printf machinery.
+  int i = swift_formatShortDecimal(Buffer, Value, Precision,
+                                   /*AllowFraction=*/!Debug);
+  if (i < 0) {
 #if defined(__CYGWIN__) || defined(_MSC_VER)
-  // Cygwin does not support uselocale(), but we can use the locale feature 
-  // in stringstream object.
-  std::ostringstream ValueStream;
-  ValueStream.width(0);
-  ValueStream.precision(Precision);
-  ValueStream.imbue(std::locale::classic());
-  ValueStream << Value;
-  std::string ValueString(ValueStream.str());
-  size_t i = ValueString.length();
-
-  if (i < BufferLength) {
-    std::copy(ValueString.begin(), ValueString.end(), Buffer);
-    Buffer[i] = '\0';
-  } else {
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
-  }
+    // Cygwin does not support uselocale(), but we can use the locale feature 
+    // in stringstream object.
+    std::ostringstream ValueStream;
+    ValueStream.width(0);
+    ValueStream.precision(Precision);
+    ValueStream.imbue(std::locale::classic());
+    ValueStream << Value;
+    std::string ValueString(ValueStream.str());
+    i = ValueString.length();
+
+    if (size_t(i) < BufferLength) {
+      std::copy(ValueString.begin(), ValueString.end(), Buffer);
+      Buffer[i] = '\0';
+    } else {
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
+    }
 #else
-  // Pass a null locale to use the C locale.
-  int i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
-                           Precision, Value);
-
-  if (i < 0)
-    swift::crash(
-        "swift_floatingPointToString: unexpected return value from sprintf");
-  if (size_t(i) >= BufferLength)
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
+    // Pass a null locale to use the C locale.
+    i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
+                         Precision, Value);
+
+    if (i < 0)
+      swift::crash(
+          "swift_floatingPointToString: unexpected return value from sprintf");
+    if (size_t(i) >= BufferLength)
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
 #endif
+  }
 
   // Add ".0" to a float that (a) is not in scientific notation, (b) does not
   // already have a fractional part, (c) is not infinite, and (d) is not a NaN
@@ -540,3 +679,30 @@ size_t swift::_swift_stdlib_getHardwareConcurrency() {
   return sysconf(_SC_NPROCESSORS_ONLN);
 #endif
 }
+
+size_t swift::_swift_stdlib_asciiPrefixLength(const unsigned char *Bytes,
+                                              size_t Length) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= Length; i += 16) {
+    __m128i Chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bytes + i));
+    if (_mm_movemask_epi8(Chunk) != 0)
+      break;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 16 <= Length; i += 16) {
+    if (vmaxvq_u8(vld1q_u8(Bytes + i)) & 0x80)
+      break;
+  }
+#endif
+  for (; i + sizeof(uint64_t) <= Length; i += sizeof(uint64_t)) {
+    uint64_t Word;
+    memcpy(&Word, Bytes + i, sizeof(Word));
+    if (Word & 0x8080808080808080ULL)
+      break;
+  }
+  while (i < Length && Bytes[i] < 0x80)
+    ++i;
+  return i;
+}
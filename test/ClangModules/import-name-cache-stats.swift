@@ -0,0 +1,13 @@
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -print-clang-stats %s 2>&1 | %FileCheck %s
+
+// CHECK: *** Swift import name cache ***
+// CHECK-NEXT: {{[1-9][0-9]*}} cached names
+// CHECK-NEXT: {{[1-9][0-9]*}} cache hits
+// CHECK-NEXT: {{[1-9][0-9]*}} cache misses
+
+import ctypes
+
+func useTypes(_ c: Color, _ p: Point) -> Color {
+  _ = p.x
+  return c
+}
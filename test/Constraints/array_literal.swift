@@ -158,3 +158,19 @@ func joinWithNil(s: String) {
   let a4 = [nil, "hello"]
   let _: Int = a4 // expected-error{{value of type '[String?]'}}
 }
+
+/// Literal elements of the same kind share a type, but still join with the
+/// other elements.
+func homogeneousLiterals() {
+  let a1 = [1, 2, 3, 4, 5, 6, 7, 8]
+  let _: Int = a1 // expected-error{{value of type '[Int]'}}
+
+  let a2 = [1, 2, 3.5, 4, 5.5]
+  let _: Int = a2 // expected-error{{value of type '[Double]'}}
+
+  let a3 = ["a", "b", nil, "c"]
+  let _: Int = a3 // expected-error{{value of type '[String?]'}}
+
+  let _: DoubleList = [1, 2, 3, 4]
+  let _: [Any] = [1, 2, "a", "b", 3.5]
+}
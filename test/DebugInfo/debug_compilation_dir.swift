@@ -0,0 +1,6 @@
+// RUN: %target-swift-frontend %s -emit-ir -g -debug-compilation-dir /build -o - | %FileCheck %s
+
+// CHECK-DAG: ![[FILE_CWD:[0-9]+]] = !DIFile(filename: "{{.*}}DebugInfo/debug_compilation_dir.swift", directory: "/build")
+// CHECK-DAG: !DICompileUnit(language: DW_LANG_Swift, file: ![[FILE_CWD]]
+
+public func f() {}
@@ -0,0 +1,30 @@
+// main | other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -v 2>&1 | %FileCheck -check-prefix=CHECK-BUILT %s
+// RUN: %FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-BUILT-DAG: Handled main.swift
+// CHECK-BUILT-DAG: Handled other.swift
+
+// CHECK-RECORD: inputs:
+// CHECK-RECORD: job_durations:
+// CHECK-RECORD-DAG: "./main.swift": {{[0-9]+$}}
+// CHECK-RECORD-DAG: "./other.swift": {{[0-9]+$}}
+
+// A job which doesn't run keeps the duration of the previous build.
+// RUN: touch -t 201401240006 %t/other.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -v 2>&1 | %FileCheck -check-prefix=CHECK-OTHER %s
+// RUN: %FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-OTHER-NOT: Handled main.swift
+// CHECK-OTHER: Handled other.swift
+// CHECK-OTHER-NOT: Handled main.swift
+
+// Malformed durations are ignored.
+// RUN: sed -e 's|"\./main\.swift": [0-9]*$|"./main.swift": bogus|' %t/main~buildrecord.swiftdeps > %t/record.tmp && mv %t/record.tmp %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -v 2>&1 | %FileCheck -check-prefix=CHECK-NONE %s
+
+// CHECK-NONE-NOT: Handled
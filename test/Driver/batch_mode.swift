@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'public func a() {}' > %t/a.swift
+// RUN: echo 'public func b() { a() }' > %t/b.swift
+
+// RUN: %swiftc_driver_plain -driver-skip-execution -v -c %t/a.swift %t/b.swift %s -module-name main -enable-batch-mode -j2 2>&1 | %FileCheck %s
+// CHECK: -frontend -c -primary-file {{[^ ]*}}a.swift {{[^ ]*}}b.swift {{[^ ]*}}batch_mode.swift
+// CHECK-NOT: -primary-file {{[^ ]*}}a.swift -primary-file
+// CHECK: -frontend -c {{[^ ]*}}a.swift -primary-file {{[^ ]*}}b.swift -primary-file {{[^ ]*}}batch_mode.swift {{.*}}-o {{[^ ]*}}b{{[^ ]*}}.o -o {{[^ ]*}}batch_mode{{[^ ]*}}.o
+
+// RUN: %swiftc_driver_plain -driver-skip-execution -v -c %t/a.swift %t/b.swift %s -module-name main -enable-batch-mode -disable-batch-mode -j2 2>&1 | %FileCheck -check-prefix=NO-BATCH %s
+// RUN: %swiftc_driver_plain -driver-skip-execution -v -c %t/a.swift %t/b.swift %s -module-name main -enable-batch-mode -force-single-frontend-invocation 2>&1 | %FileCheck -check-prefix=NO-BATCH %s
+// NO-BATCH-NOT: -primary-file {{[^ ]*}}.swift {{.*}}-primary-file
+
+// RUN: %target-swift-frontend -c -primary-file %t/a.swift -primary-file %t/b.swift %s -module-name main -o %t/a.o -o %t/b.o -emit-reference-dependencies-path %t/a.swiftdeps -emit-reference-dependencies-path %t/b.swiftdeps
+// RUN: ls %t/a.o %t/b.o %t/a.swiftdeps %t/b.swiftdeps
+// RUN: %FileCheck -check-prefix=A-DEPS %s < %t/a.swiftdeps
+// RUN: %FileCheck -check-prefix=B-DEPS %s < %t/b.swiftdeps
+// A-DEPS: provides-top-level:
+// A-DEPS-NEXT: - "a"
+// B-DEPS: provides-top-level:
+// B-DEPS-NEXT: - "b"
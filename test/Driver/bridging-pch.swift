@@ -0,0 +1,23 @@
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header fake.h %s 2>&1 | %FileCheck %s -check-prefix=NOPCHACT
+// NOPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// NOPCHACT: 1: compile, {0}, object
+// NOPCHACT: 2: link, {1}, image
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header fake.h -enable-bridging-pch %s 2>&1 | %FileCheck %s -check-prefix=PCHACT
+// PCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// PCHACT: 1: input, "fake.h", objc-header
+// PCHACT: 2: generate-pch, {1}, pch
+// PCHACT: 3: compile, {0, 2}, object
+// PCHACT: 4: link, {3}, image
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header fake.h -enable-bridging-pch -disable-bridging-pch %s 2>&1 | %FileCheck %s -check-prefix=NOPCHACT
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header fake.h -enable-bridging-pch -whole-module-optimization %s 2>&1 | %FileCheck %s -check-prefix=WMOACT
+// WMOACT-NOT: generate-pch
+// WMOACT: compile, {0}, object
+
+// RUN: %swiftc_driver -driver-print-jobs -import-objc-header fake.h -enable-bridging-pch -c -emit-module %s %S/Inputs/main.swift 2>&1 | %FileCheck %s -check-prefix=PCHJOB
+// PCHJOB: bin/swift{{c?}} -frontend -emit-pch fake.h {{.*}} -o [[PCH:.*fake.*\.pch]]
+// PCHJOB: bin/swift{{c?}} -frontend -c -primary-file {{.*}}bridging-pch.swift {{.*}} -import-objc-header [[PCH]]
+// PCHJOB: bin/swift{{c?}} -frontend -c {{.*}} -primary-file {{.*}}main.swift {{.*}} -import-objc-header [[PCH]]
+// PCHJOB: bin/swift{{c?}} -frontend -emit-module {{.*}} -import-objc-header fake.h
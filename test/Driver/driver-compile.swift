@@ -56,6 +56,9 @@
 // RUN: %FileCheck %s < %t.embed-inc.txt
 // RUN: %FileCheck -check-prefix NO-REFERENCE-DEPENDENCIES %s < %t.embed-inc.txt
 
+// RUN: %swiftc_driver -driver-print-jobs -c -target x86_64-apple-macosx10.9 %s -object-cache-path /tmp/objects -debug-compilation-dir /build 2>&1 > %t.cache.txt
+// RUN: %FileCheck -check-prefix OBJECT-CACHE %s < %t.cache.txt
+
 // REQUIRES: X86
 
 
@@ -101,6 +104,10 @@
 // OBJ: -c{{ }}
 // OBJ: -o {{[^-]}}
 
+// OBJECT-CACHE: bin/swift
+// OBJECT-CACHE-DAG: -object-cache-path /tmp/objects
+// OBJECT-CACHE-DAG: -debug-compilation-dir /build
+
 // DUPLICATE-NAME: error: filename "driver-compile.swift" used twice: '{{.*}}test/Driver/driver-compile.swift' and '{{.*}}driver-compile.swift'
 // DUPLICATE-NAME: note: filenames are used to distinguish private declarations with the same name
 
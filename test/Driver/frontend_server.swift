@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// Jobs fall back to separate frontend processes if no server is listening.
+// RUN: %swiftc_driver -frontend-server-socket %t/no-server.sock -c %s -module-name main -o %t/main.o
+// RUN: ls %t/main.o
+
+// Two jobs run by the server at the same time both finish.
+// RUN: %swift_driver_plain -frontend-server %t/server.sock > %t/server.log 2>&1 & echo $! > %t/server.pid
+// RUN: for i in $(seq 50); do test -S %t/server.sock && break; sleep 0.1; done
+// RUN: cd %t && %swiftc_driver -frontend-server-socket %t/server.sock -j2 -c %s %S/Inputs/lib.swift -module-name main 2>&1 | %FileCheck -allow-empty -check-prefix=CONCURRENT %s
+// RUN: kill $(cat %t/server.pid)
+// RUN: ls %t/frontend_server.o %t/lib.o
+// CONCURRENT-NOT: error
+
+// RUN: not %swift_driver_plain -frontend-server 2>&1 | %FileCheck -check-prefix=USAGE %s
+// USAGE: usage: swift -frontend-server <socket path>
+
+public func f() {}
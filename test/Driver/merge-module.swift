@@ -78,6 +78,15 @@
 // FILELISTS-NOT: .swiftmodule
 // FILELISTS: -o {{[^ ]+}}
 
+// RUN: %swiftc_driver -driver-print-jobs -emit-module -incremental %s -module-name main 2>&1 | %FileCheck -check-prefix INCREMENTAL %s
+// RUN: %swiftc_driver -driver-print-jobs -emit-module %s -module-name main 2>&1 | %FileCheck -check-prefix NONINCREMENTAL %s
+
+// INCREMENTAL: bin/swift{{c?}} -frontend
+// INCREMENTAL-NOT: -preserve-timestamp-if-interface-unchanged
+// INCREMENTAL: bin/swift{{c?}} -frontend -emit-module {{.*}} -preserve-timestamp-if-interface-unchanged {{.*}}-o main.swiftmodule
+
+// NONINCREMENTAL-NOT: -preserve-timestamp-if-interface-unchanged
+
 
 // RUN: %swiftc_driver -driver-print-jobs -emit-module %S/Inputs/main.swift %S/Inputs/lib.swift -module-name merge -o /tmp/modules > %t.complex.txt
 // RUN: %FileCheck %s < %t.complex.txt
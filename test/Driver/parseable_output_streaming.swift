@@ -0,0 +1,25 @@
+// RUN: %swiftc_driver_plain -emit-executable %s -o %t.out -parseable-output -stream-job-output -driver-skip-execution 2>&1 | %FileCheck %s
+
+// XFAIL: freebsd, linux
+
+// CHECK: "kind": "began",
+// CHECK-NEXT: "name": "compile",
+// CHECK: "pid": 1
+// CHECK-NEXT: }
+
+// CHECK-NEXT: {{[1-9][0-9]*}}
+// CHECK-NEXT: {
+// CHECK-NEXT:   "kind": "output",
+// CHECK-NEXT:   "name": "compile",
+// CHECK-NEXT:   "pid": 1,
+// CHECK-NEXT:   "output": "Output placeholder\n"
+// CHECK-NEXT: }
+
+// The output was already reported, so it isn't repeated when the job is done.
+// CHECK-NEXT: {{[1-9][0-9]*}}
+// CHECK-NEXT: {
+// CHECK-NEXT:   "kind": "finished",
+// CHECK-NEXT:   "name": "compile",
+// CHECK-NEXT:   "pid": 1,
+// CHECK-NEXT:   "exit-status": 0
+// CHECK-NEXT: }
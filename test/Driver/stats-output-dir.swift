@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swiftc_driver -c -module-name main -stats-output-dir %t/stats -o %t/main.o %s
+// RUN: %utils/process-stats-dir.py %t/stats | %FileCheck %s
+
+// RUN: %swiftc_driver -driver-print-jobs -c -module-name main -stats-output-dir %t/stats %s 2>&1 | %FileCheck %s -check-prefix=FORWARD
+// FORWARD: bin/swift{{c?}} -frontend -c {{.*}} -stats-output-dir {{.*}}stats
+
+// CHECK-DAG: "AST.NumTopLevelDecls": 1
+// CHECK-DAG: "Driver.NumDriverJobs": 1
+// CHECK-DAG: "Jobs.swift-driver": 1
+// CHECK-DAG: "Jobs.swift-frontend": 1
+// CHECK-DAG: "SIL.NumFunctions": {{[1-9]}}
+// CHECK-DAG: "time.swift-frontend.wall"
+// CHECK-DAG: "time.swift.Parsing.wall"
+// CHECK-DAG: "time.swift.SILGen.wall"
+
+func f() {}
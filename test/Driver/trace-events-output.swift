@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swiftc_driver -c -module-name main -trace-events-output %t/trace.json -o %t/main.o %s %S/../Inputs/empty.swift
+// RUN: %FileCheck %s < %t/trace.json
+// RUN: not ls %t/trace.json.parts
+
+// RUN: %swiftc_driver -driver-print-jobs -c -module-name main -trace-events-output %t/trace.json %s 2>&1 | %FileCheck %s -check-prefix=FORWARD
+// FORWARD: bin/swift{{c?}} -frontend -c {{.*}} -trace-events-dir {{.*}}trace.json.parts
+// FORWARD-NOT: -trace-events-output
+
+// CHECK: {"traceEvents": [
+// CHECK-DAG: "args": {"name": "swift-driver"}
+// CHECK-DAG: "args": {"name": "swift-frontend main-trace-events-output.swift"}
+// CHECK-DAG: "args": {"name": "swift-frontend main-empty.swift"}
+// CHECK-DAG: {"name": "schedule compile {{.*}}", "cat": "driver", "ph": "i"
+// CHECK-DAG: {"name": "compile {{.*}}", "cat": "job", "ph": "X"{{.*}}"args": {"detail": "pid
+// CHECK-DAG: {"name": "Parsing", "cat": "phase", "ph": "X"
+// CHECK-DAG: {"name": "Type checking / Semantic analysis", "cat": "phase"
+// CHECK-DAG: {"name": "SILGen", "cat": "phase"
+// CHECK-DAG: {"name": "IRGen", "cat": "phase"
+// CHECK-DAG: "cat": "sil-module-pass"
+// CHECK: "displayTimeUnit": "ms"}
+
+func f() {}
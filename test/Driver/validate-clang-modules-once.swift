@@ -0,0 +1,7 @@
+// RUN: %swiftc_driver -driver-print-jobs -c -module-name main -validate-clang-modules-once -clang-build-session-file %t.session %s 2>&1 | %FileCheck %s
+// CHECK: bin/swift{{c?}} -frontend -c {{.*}} -validate-clang-modules-once -clang-build-session-file {{.*}}.session
+
+// RUN: not %swiftc_driver -driver-print-jobs -c -module-name main -validate-clang-modules-once %s 2>&1 | %FileCheck -check-prefix=NO-SESSION %s
+// NO-SESSION: error: option '-validate-clang-modules-once' requires '-clang-build-session-file'
+
+func f() {}
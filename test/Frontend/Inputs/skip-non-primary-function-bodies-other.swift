@@ -0,0 +1,13 @@
+struct Counter {
+  var value: Int {
+    get { return 1 + }
+    set { value = ) }
+  }
+
+  func increment() -> Counter { return Counter(value: )) }
+}
+
+func makeCounter() -> Counter { return Counter(]) }
+
+@_transparent
+func transparentValue() -> Int { return 1 + }
@@ -0,0 +1,18 @@
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-function-bodies-other.swift 2>&1 | %FileCheck %s
+// RUN: not %target-swift-frontend -parse %s -primary-file %S/Inputs/skip-non-primary-function-bodies-other.swift 2>&1 | %FileCheck -check-prefix=CHECK-PRIMARY %s
+
+// The bodies of the functions in files which are not primary are skipped,
+// except for the bodies of transparent functions.
+
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:3:
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:4:
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:7:
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:10:
+// CHECK: skip-non-primary-function-bodies-other.swift:13:{{[0-9]+}}: error: expected expression after operator
+
+// CHECK-PRIMARY: skip-non-primary-function-bodies-other.swift:3:{{[0-9]+}}: error:
+// CHECK-PRIMARY: skip-non-primary-function-bodies-other.swift:10:{{[0-9]+}}: error:
+
+func useCounter() -> Int {
+  return makeCounter().increment().value + transparentValue()
+}
@@ -0,0 +1,16 @@
+// RUN: %swift -target x86_64-unknown-linux-gnu %s -parse-stdlib -disable-objc-interop -module-name main -function-sections -S -o - | %FileCheck %s
+// RUN: %swift -target x86_64-unknown-linux-gnu %s -parse-stdlib -disable-objc-interop -module-name main -S -o - | %FileCheck %s --check-prefix=NOSECTIONS
+
+// REQUIRES: CODEGENERATOR=X86
+
+// Check that -function-sections puts every function into its own section, so
+// that -Wl,--gc-sections can drop the unused ones.
+
+// CHECK: .section .text._TF4main5firstFT_T_,"ax",@progbits
+// CHECK: .section .text._TF4main6secondFT_T_,"ax",@progbits
+
+// NOSECTIONS-NOT: .section .text._TF4main
+
+public func first() {}
+
+public func second() {}
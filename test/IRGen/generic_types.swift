@@ -16,6 +16,7 @@ import Swift
 // CHECK-objc-SAME:   i32 344,
 // CHECK-SAME:   i16 1,
 // CHECK-SAME:   i16 16,
+// CHECK-SAME:   i8** null,
 // CHECK-SAME:   [{{[0-9]+}} x i8*] zeroinitializer,
 // CHECK-SAME:   void ([[A]]*)* @_TFC13generic_types1AD,
 // CHECK-SAME:   i8** @_TWVBo,
@@ -42,6 +43,7 @@ import Swift
 // CHECK-objc-SAME:   i32 336,
 // CHECK-SAME:   i16 1,
 // CHECK-SAME:   i16 16,
+// CHECK-SAME:   i8** null,
 // CHECK-SAME:   [{{[0-9]+}} x i8*] zeroinitializer,
 // CHECK-SAME:   void ([[B]]*)* @_TFC13generic_types1BD,
 // CHECK-SAME:   i8** @_TWVBo,
@@ -0,0 +1,25 @@
+// RUN: %target-swift-frontend -primary-file %s -O -disable-llvm-optzns -emit-ir | %FileCheck %s --check-prefix=CHECK-OPT
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | %FileCheck %s --check-prefix=CHECK-ONONE
+
+// REQUIRES: CPU=x86_64
+
+// With optimization, the cache variable of a concrete metadata accessor is
+// checked inline and the accessor is only called while it is still null.
+
+// CHECK-OPT-LABEL: define hidden %swift.type* @_TF25metadata_lazy_cache_inline9arrayTypeFT_PMP_()
+// CHECK-OPT:         [[CACHE:%.*]] = load %swift.type*, %swift.type** @_TMLGSaSi_
+// CHECK-OPT:         [[ISNULL:%.*]] = icmp eq %swift.type* [[CACHE]], null
+// CHECK-OPT:         br i1 [[ISNULL]], label %cacheIsNull, label %cont
+// CHECK-OPT:       cacheIsNull:
+// CHECK-OPT:         [[CALL:%.*]] = call %swift.type* @_TMaGSaSi_()
+// CHECK-OPT:       cont:
+// CHECK-OPT:         phi %swift.type* [ [[CACHE]], %{{.*}} ], [ [[CALL]], %cacheIsNull ]
+
+// CHECK-ONONE-LABEL: define hidden %swift.type* @_TF25metadata_lazy_cache_inline9arrayTypeFT_PMP_()
+// CHECK-ONONE-NOT:     load %swift.type*, %swift.type** @_TMLGSaSi_
+// CHECK-ONONE:         call %swift.type* @_TMaGSaSi_()
+// CHECK-ONONE:         ret
+@inline(never)
+func arrayType() -> Any.Type {
+  return [Int].self
+}
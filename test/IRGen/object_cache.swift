@@ -0,0 +1,35 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: echo "initial" >%t/log
+// RUN: %target-swift-frontend -O -wmo %s %S/Inputs/simple.swift -module-name=test -c -o %t/test.o -object-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: initial
+// CHECK: test.o: MD5=[[TEST_MD5:[0-9a-f]+]]
+// CHECK-NOT: copied from object cache
+
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+// CACHE: {{[0-9a-f]+}}.o
+
+// RUN: echo "file changed" >>%t/log
+// RUN: %target-swift-frontend -O -wmo %s %S/Inputs/simple2.swift -module-name=test -c -o %t/test.o -object-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: file changed
+// CHECK: test.o: MD5=[[TEST2_MD5:[0-9a-f]+]]
+// CHECK: test.o: prev MD5=[[TEST_MD5]] recompiling
+// CHECK-NOT: copied from object cache
+
+// RUN: echo "file changed back" >>%t/log
+// RUN: %target-swift-frontend -O -wmo %s %S/Inputs/simple.swift -module-name=test -c -o %t/test.o -object-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: file changed back
+// CHECK: test.o: MD5=[[TEST_MD5]]
+// CHECK: test.o: prev MD5=[[TEST2_MD5]] recompiling
+// CHECK: test.o: copied from object cache
+
+// RUN: %FileCheck %s < %t/log
+
+// REQUIRES: asserts
+
+public func test_func1() {
+  print("Hello")
+}
@@ -0,0 +1,9 @@
+// RUN: %target-swift-frontend -Osize -emit-ir -parse-as-library %s | %FileCheck %s
+// RUN: %target-swift-frontend -O -emit-ir -parse-as-library %s | %FileCheck %s -check-prefix=SPEED
+
+// CHECK: define{{.*}} @_TF5osize3addFTSiSi_Si({{.*}}) [[ATTRS:#[0-9]+]]
+// CHECK: attributes [[ATTRS]] = {{{.*}}optsize
+// SPEED-NOT: optsize
+public func add(_ x: Int, _ y: Int) -> Int {
+  return x &+ y
+}
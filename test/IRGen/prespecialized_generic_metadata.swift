@@ -0,0 +1,38 @@
+// RUN: %target-swift-frontend -prespecialize-generic-metadata -primary-file %s -emit-ir | %FileCheck %s
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | %FileCheck %s -check-prefix=DEFAULT
+
+// REQUIRES: CPU=x86_64
+
+// CHECK: @_TMPV31prespecialized_generic_metadata3Box = hidden global <{{[{].*\* [}]}}> <{
+// CHECK-SAME: i16 1, i16 8, i8** {{.*}}@prespecialized_metadata_list_Box
+
+// -- key argument, cache entry header, value witness table of the instance
+// CHECK: @prespecialized_metadata_Box = private global <{ {{.*}} }> <{
+// CHECK-SAME: %swift.type* @_TMSi,
+// CHECK-SAME: i64 1,
+// CHECK-SAME: @_TWVGV31prespecialized_generic_metadata3BoxSi_
+// -- field offset vector; generic parameter vector; field type vector slot
+// CHECK-SAME: i64 0, %swift.type* @_TMSi, %swift.type** null
+// CHECK-SAME: }>, align 8
+
+// -- The metadata of instantiations with archetypes is instantiated at
+//    runtime.
+// CHECK-NOT: @prespecialized_metadata_Box{{.*}} = private global
+
+// CHECK: @prespecialized_metadata_list_Box = private constant [2 x i8*] [i8* getelementptr inbounds {{.*}}@prespecialized_metadata_Box{{.*}}, i32 8), i8* null]
+
+// DEFAULT: @_TMPV31prespecialized_generic_metadata3Box = hidden global <{{[{].*\* [}]}}> <{
+// DEFAULT-SAME: i16 1, i16 8, i8** null,
+// DEFAULT-NOT: @prespecialized_metadata_
+
+struct Box<T> {
+  var value: T
+}
+
+func makeIntBox() -> Any {
+  return Box(value: 0)
+}
+
+func makeBox<T>(_ value: T) -> Any {
+  return Box(value: value)
+}
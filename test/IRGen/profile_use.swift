@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -module-name profile_use -profile-generate -Xfrontend -disable-incremental-llvm-codegen -o %t/main
+// RUN: env LLVM_PROFILE_FILE=%t/default.profraw %target-run %t/main
+// RUN: %llvm-profdata merge %t/default.profraw -o %t/default.profdata
+// RUN: %target-swift-frontend %s -module-name profile_use -emit-ir -profile-use=%t/default.profdata | %FileCheck %s
+// RUN: not %target-swift-frontend %s -module-name profile_use -emit-ir -profile-use=%t/missing.profdata 2>&1 | %FileCheck -check-prefix=MISSING %s
+// RUN: rm -rf %t
+
+// REQUIRES: profile_runtime
+// REQUIRES: executable_test
+// REQUIRES: OS=macosx
+
+// MISSING: error: error reading profile data '{{.*}}missing.profdata'
+
+// CHECK: define {{.*}}@_TF11profile_use3hotFT_T_() {{.*}}!prof ![[HOT:[0-9]+]]
+func hot() {
+}
+
+// CHECK: define {{.*}}@_TF11profile_use4coldFT_T_() [[COLD_ATTRS:#[0-9]+]] {{.*}}!prof ![[COLD:[0-9]+]]
+func cold() {
+}
+
+for _ in 0..<10 {
+  hot()
+}
+if CommandLine.arguments.count > 1000 {
+  cold()
+}
+
+// CHECK: attributes [[COLD_ATTRS]] = {{.*}}cold
+// CHECK-DAG: ![[HOT]] = !{!"function_entry_count", i64 10}
+// CHECK-DAG: ![[COLD]] = !{!"function_entry_count", i64 0}
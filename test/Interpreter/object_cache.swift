@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %swift -interpret %s -object-cache-path %t/cache -Xllvm -debug-only=swift-immediate 2>%t/first.log | %FileCheck %s
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+// RUN: %FileCheck -check-prefix=FIRST %s < %t/first.log
+
+// Running the unchanged script again loads the cached object.
+// RUN: %swift -interpret %s -object-cache-path %t/cache -Xllvm -debug-only=swift-immediate 2>%t/second.log | %FileCheck %s
+// RUN: %FileCheck -check-prefix=SECOND %s < %t/second.log
+
+// REQUIRES: swift_interpreter
+// REQUIRES: asserts
+
+// CHECK: Hello from the JIT
+
+// CACHE: {{[0-9a-f]+}}.jit.o
+
+// FIRST-NOT: Using cached object
+
+// SECOND: Using cached object {{.*}}.jit.o
+
+print("Hello from the JIT")
@@ -0,0 +1,61 @@
+// RUN: %target-run-simple-swift
+// RUN: %target-build-swift -O %s -o %t/a.out.optimized
+// RUN: %target-run %t/a.out.optimized
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+// The runtime remembers how it cast each pair of types. Casting the same pair
+// again with values whose outcome differs must still look at the value.
+
+let repeatedCastTests = TestSuite("Repeated casts")
+
+class Base {}
+class Derived : Base {}
+class Other : Base {}
+
+protocol P {}
+struct S : P { var x: Int }
+struct T { var x: Int }
+
+func asInt(_ x: Any) -> Int? { return x as? Int }
+func asDerived(_ x: Base) -> Derived? { return x as? Derived }
+func asP(_ x: Any) -> P? { return x as? P }
+func asOptionalInt(_ x: Int) -> Int?? { return x as? Int? }
+func asIntArray(_ x: Any) -> [Int]? { return x as? [Int] }
+
+repeatedCastTests.test("Existential source") {
+  let values: [Any] = [1, "two", 3, 4.0, 5]
+  for _ in 0..<3 {
+    expectEqual([1, 3, 5], values.flatMap(asInt))
+  }
+}
+
+repeatedCastTests.test("Class hierarchy") {
+  let objects: [Base] = [Derived(), Other(), Base(), Derived()]
+  for _ in 0..<3 {
+    expectEqual(2, objects.flatMap(asDerived).count)
+  }
+}
+
+repeatedCastTests.test("Protocol conformance") {
+  let values: [Any] = [S(x: 1), T(x: 2), S(x: 3)]
+  for _ in 0..<3 {
+    expectEqual(2, values.flatMap(asP).count)
+  }
+}
+
+repeatedCastTests.test("Optional target") {
+  for i in 0..<3 {
+    expectEqual(i, asOptionalInt(i)!!)
+  }
+}
+
+repeatedCastTests.test("Collections") {
+  let values: [Any] = [[1, 2], ["a"], [3] as [Any], [Int]()]
+  for _ in 0..<3 {
+    expectEqual([2, 1, 0], values.flatMap(asIntArray).map { $0.count })
+  }
+}
+
+runAllTests()
@@ -18,6 +18,11 @@ declare void @swift_retain(%swift.refcounted* ) nounwind
 declare %swift.bridge* @swift_bridgeObjectRetain(%swift.bridge*)
 declare void @swift_bridgeObjectRelease(%swift.bridge*)
 declare void @swift_retainUnowned(%swift.refcounted*)
+declare void @swift_retain_n(%swift.refcounted*, i32)
+declare void @swift_release_n(%swift.refcounted*, i32)
+declare void @swift_unknownRetain_n(%swift.refcounted*, i32)
+declare void @swift_nonatomic_retain(%swift.refcounted*)
+declare void @swift_nonatomic_unknownRetain(%swift.refcounted*)
 
 declare void @user(%swift.refcounted *) nounwind
 declare void @user_objc(%objc_object*) nounwind
@@ -369,6 +374,77 @@ bb1:
   ret void
 }
 
+; CHECK-LABEL: @retain_n_release_pair(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: tail call void @{{.*}}swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: call void @user
+; CHECK-NEXT: ret void
+define void @retain_n_release_pair(%swift.refcounted* %A) {
+entry:
+  tail call void @swift_retain_n(%swift.refcounted* %A, i32 2)
+  tail call void @swift_release(%swift.refcounted* %A)
+  call void @user(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: @retain_release_n_pair(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: call void @user
+; CHECK-NEXT: tail call void @{{.*}}swift_release_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: ret void
+define void @retain_release_n_pair(%swift.refcounted* %A) {
+entry:
+  call void @user(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_release_n(%swift.refcounted* %A, i32 3)
+  ret void
+}
+
+; CHECK-LABEL: @unknown_retain_n_release_pair(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: tail call void @swift_unknownRetain_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: call void @user
+; CHECK-NEXT: ret void
+define void @unknown_retain_n_release_pair(%swift.refcounted* %A) {
+entry:
+  tail call void @swift_unknownRetain_n(%swift.refcounted* %A, i32 3)
+  tail call void @swift_unknownRelease(%swift.refcounted* %A)
+  call void @user(%swift.refcounted* %A)
+  ret void
+}
+
+; A retain of a new object is a native retain.
+; CHECK-LABEL: @unknown_retain_of_allocation(
+; CHECK: swift_allocObject
+; CHECK-NEXT: tail call void @{{.*}}swift_retain(
+; CHECK-NOT: swift_unknownRetain
+; CHECK: ret
+define %swift.refcounted* @unknown_retain_of_allocation(%swift.heapmetadata* %M) {
+entry:
+  %A = call %swift.refcounted* @swift_allocObject(%swift.heapmetadata* %M, i64 24, i64 8)
+  tail call void @swift_unknownRetain(%swift.refcounted* %A)
+  call void @unknown_func()
+  ret %swift.refcounted* %A
+}
+
+; The atomic and nonatomic entry points are created separately.
+; CHECK-LABEL: @mixed_atomicity_unknown_retain_promotion(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: tail call void @swift_nonatomic_retain(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @{{.*}}swift_nonatomic_retain(%swift.refcounted* %A)
+; CHECK-NEXT: call void @unknown_func()
+; CHECK-NEXT: tail call void @swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @{{.*}}swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @mixed_atomicity_unknown_retain_promotion(%swift.refcounted* %A) {
+entry:
+  tail call void @swift_nonatomic_retain(%swift.refcounted* %A)
+  tail call void @swift_nonatomic_unknownRetain(%swift.refcounted* %A)
+  call void @unknown_func()
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_unknownRetain(%swift.refcounted* %A)
+  ret void
+}
 
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
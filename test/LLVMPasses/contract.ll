@@ -572,6 +572,75 @@ bb3:
   ret %swift.bridge* %A
 }
 
+; CHECK-LABEL: define{{( protected)?}} %swift.refcounted* @swift_contractRetainReleaseNAcrossBlocks(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %A, i32 3)
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb2
+; CHECK: bb2:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br i1 undef, label %bb3, label %bb4
+; CHECK: bb3:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb5
+; CHECK: bb4:
+; CHECK-NEXT: tail call void @rt_swift_release(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb5
+; CHECK: bb5:
+; CHECK-NEXT: tail call void @rt_swift_release(%swift.refcounted* %A)
+; CHECK-NEXT: ret %swift.refcounted* %A
+define %swift.refcounted* @swift_contractRetainReleaseNAcrossBlocks(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb1
+
+bb1:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb2
+
+bb2:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @noread_user(%swift.refcounted* %A)
+  br i1 undef, label %bb3, label %bb4
+
+bb3:
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb5
+
+bb4:
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  br label %bb5
+
+bb5:
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  ret %swift.refcounted* %A
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractReleaseNAcrossBlocks(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @rt_swift_release_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: ret void
+define void @swift_contractReleaseNAcrossBlocks(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb1
+
+bb1:
+  call void @noread_user(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  ret void
+}
+
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
 
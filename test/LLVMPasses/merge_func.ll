@@ -120,6 +120,61 @@ define void @sret_func2(i32* sret %p, i32 %x, i32 %y) {
 ; CHECK: ret
 
 
+; Merge pointer comparisons with differing constants, but not integer ones.
+
+; CHECK-LABEL: define i1 @is_g1(i32* %p, i32 %x, i32 %y)
+; CHECK: %1 = tail call i1 @is_g1_merged(i32* %p, i32 %x, i32 %y, i32* @g1)
+; CHECK: ret i1 %1
+define i1 @is_g1(i32* %p, i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %sum3 = add i32 %sum2, %y
+  call void @callee1(i32 %sum3)
+  %c = icmp eq i32* %p, @g1
+  ret i1 %c
+}
+
+; CHECK-LABEL: define i1 @is_g2(i32* %p, i32 %x, i32 %y)
+; CHECK: %1 = tail call i1 @is_g1_merged(i32* %p, i32 %x, i32 %y, i32* @g2)
+; CHECK: ret i1 %1
+define i1 @is_g2(i32* %p, i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %sum3 = add i32 %sum2, %y
+  call void @callee1(i32 %sum3)
+  %c = icmp eq i32* %p, @g2
+  ret i1 %c
+}
+
+; CHECK-LABEL: define internal i1 @is_g1_merged(i32*, i32, i32, i32*)
+; CHECK: %c = icmp eq i32* %0, %3
+; CHECK: ret i1 %c
+
+; CHECK-LABEL: define i1 @less_than_10(i32 %x, i32 %y)
+; CHECK: %c = icmp slt i32 %sum3, 10
+; CHECK: ret i1 %c
+define i1 @less_than_10(i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %sum3 = add i32 %sum2, %y
+  call void @callee1(i32 %sum3)
+  %c = icmp slt i32 %sum3, 10
+  ret i1 %c
+}
+
+; CHECK-LABEL: define i1 @less_than_20(i32 %x, i32 %y)
+; CHECK: %c = icmp slt i32 %sum3, 20
+; CHECK: ret i1 %c
+define i1 @less_than_20(i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %sum3 = add i32 %sum2, %y
+  call void @callee1(i32 %sum3)
+  %c = icmp slt i32 %sum3, 20
+  ret i1 %c
+}
+
+
 ; Don't merge all functions, because we would generate too many parameters.
 ; Instead merge those functions which match best.
 
@@ -0,0 +1,13 @@
+// RUN: rm -f %t.json
+// RUN: %target-swift-frontend -parse %s -debug-expression-type-check-stats %t.json
+// RUN: %FileCheck %s < %t.json
+
+// CHECK: "file": "{{.*}}expression_type_check_stats.swift",
+// CHECK-NEXT: "start_line": [[@LINE+7]],
+// CHECK-NEXT: "start_column": 9,
+// CHECK-NEXT: "end_line": [[@LINE+5]],
+// CHECK-NEXT: "end_column": 23,
+// CHECK-NEXT: "wall_ns": {{[0-9]+}},
+// CHECK-NEXT: "NumTypeVariablesBound": {{[0-9]+}},
+// CHECK: "NumStatesExplored": {{[0-9]+}},
+let x = 1 + 2.0 * 3 - 4
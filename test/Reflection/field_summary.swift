@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %S/Inputs/TypeLowering.swift -parse-as-library -emit-module -emit-library -module-name TypeLowering -o %t/libTypesToReflect.%target-dylib-extension
+// RUN: %target-swift-reflection-dump -binary-filename %t/libTypesToReflect.%target-dylib-extension -binary-filename %platform-module-dir/libswiftCore.%target-dylib-extension -dump-field-summary | %FileCheck %s
+
+// CHECK: [
+// CHECK-DAG: {"binary": "{{.*}}libTypesToReflect.{{.*}}", "type": "TypeLowering.BasicStruct", "kind": "struct", "fields": 6, "size": 16}
+// CHECK-DAG: {"binary": "{{.*}}libTypesToReflect.{{.*}}", "type": "TypeLowering.Box", "kind": "struct", "fields": 1}
+// CHECK-DAG: {"binary": "{{.*}}libTypesToReflect.{{.*}}", "type": "TypeLowering.Derived", "kind": "class", "fields": 0}
+// CHECK-DAG: {"binary": "{{.*}}libswiftCore.{{.*}}", "type": "Swift.Int", "kind": "struct", "fields": 1, "size": {{4|8}}}
+// CHECK: ]
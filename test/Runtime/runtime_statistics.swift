@@ -0,0 +1,36 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_DEBUG_RUNTIME_STATISTICS=1 %target-run %t/a.out 2>&1 | %FileCheck %s
+// RUN: %target-run %t/a.out 2>&1 | %FileCheck %s -check-prefix=DISABLED
+
+// REQUIRES: executable_test
+
+protocol P {}
+struct S : P {}
+struct G<T> {}
+
+@inline(never)
+func instantiate<T>(_: T.Type) -> Any.Type {
+  return G<T>.self
+}
+
+@inline(never)
+func isP(_ value: Any) -> Bool {
+  return value is P
+}
+
+for _ in 0..<10 {
+  _ = instantiate(Int.self)
+  _ = isP(S())
+}
+print("done")
+
+// CHECK: done
+// CHECK: *** Swift runtime statistics ***
+// CHECK-DAG: {{^}}GenericCache {{[1-9][0-9]*}} {{[1-9][0-9]*}}
+// CHECK-DAG: {{^}}ConformanceCache {{[1-9][0-9]*}} {{[1-9][0-9]*}}
+// CHECK: metadata allocator: {{[1-9][0-9]*}} bytes in {{[1-9][0-9]*}} allocations
+
+// DISABLED: done
+// DISABLED-NOT: Swift runtime statistics
@@ -0,0 +1,75 @@
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -enable-guaranteed-normal-arguments %s | %FileCheck %s
+
+class C {}
+
+protocol P {}
+
+func use(_ c: C) {}
+
+// CHECK-LABEL: sil hidden @{{.*}}6useTwo{{.*}} : $@convention(thin) (@guaranteed C, @guaranteed C) -> ()
+// CHECK:       bb0([[X:%.*]] : $C, [[Y:%.*]] : $C):
+// CHECK-NOT:     strong_retain
+// CHECK:         apply {{%.*}}([[X]])
+// CHECK-NOT:     strong_retain
+// CHECK:         apply {{%.*}}([[Y]])
+// CHECK-NOT:     strong_release
+// CHECK:         return
+func useTwo(_ x: C, _ y: C) {
+  use(x)
+  use(y)
+}
+
+// CHECK-LABEL: sil hidden @{{.*}}10useGeneric{{.*}} : $@convention(thin) <T where T : P> (@in_guaranteed T) -> ()
+// CHECK-NOT:     destroy_addr
+// CHECK:         return
+func useGeneric<T : P>(_ x: T) {}
+
+// Returning a guaranteed argument has to copy it.
+// CHECK-LABEL: sil hidden @{{.*}}11passThrough{{.*}} : $@convention(thin) (@guaranteed C) -> @owned C
+// CHECK:       bb0([[X:%.*]] : $C):
+// CHECK:         strong_retain [[X]]
+// CHECK:         return [[X]]
+func passThrough(_ x: C) -> C {
+  return x
+}
+
+struct S {
+  var c: C
+
+  // Initializers and setters store their arguments, so they keep taking them
+  // at +1.
+  // CHECK-LABEL: sil hidden @{{.*}}1SC{{.*}} : $@convention(method) (@owned C, @thin S.Type) -> @owned S
+  init(c: C) {
+    self.c = c
+  }
+
+  // CHECK-LABEL: sil hidden @{{.*}}1S8computed{{.*}}s : $@convention(method) (@owned C, @inout S) -> ()
+  var computed: C {
+    get { return c }
+    set { c = newValue }
+  }
+
+  // CHECK-LABEL: sil hidden @{{.*}}1S6method{{.*}} : $@convention(method) (@guaranteed C, @guaranteed S) -> ()
+  func method(_ x: C) {
+    use(x)
+  }
+}
+
+class D {
+  var c: C
+
+  // CHECK-LABEL: sil hidden @{{.*}}1DC{{.*}} : $@convention(method) (@owned C, @thick D.Type) -> @owned D
+  // CHECK-LABEL: sil hidden @{{.*}}1Dc{{.*}} : $@convention(method) (@owned C, @owned D) -> @owned D
+  init(c: C) {
+    self.c = c
+  }
+}
+
+enum E {
+  // CHECK-LABEL: sil shared [transparent] @{{.*}}1E4Case{{.*}} : $@convention(method) (@owned C, @thin E.Type) -> @owned E
+  case Case(C)
+}
+
+func makeE(_ c: C) -> E {
+  return .Case(c)
+}
@@ -0,0 +1,26 @@
+// RUN: %target-swift-frontend -emit-sil -Odebug -parse-as-library %s | %FileCheck %s
+
+// Local variables live in registers, but keep their debug info.
+// CHECK-LABEL: sil hidden @_TF6odebug3sumFSiSi
+// CHECK-NOT: alloc_stack
+// CHECK: debug_value {{.*}} var, name "total"
+// CHECK: return
+func sum(_ n: Int) -> Int {
+  var total = 0
+  total = total &+ n
+  return total
+}
+
+class C {
+  func method() {}
+
+  // No retain/release pairs around calls on the guaranteed self.
+  // CHECK-LABEL: sil hidden @_TFC6odebug1C10callMethodfT_T_
+  // CHECK-NOT: strong_retain
+  // CHECK-NOT: strong_release
+  // CHECK: return
+  func callMethod() {
+    method()
+    method()
+  }
+}
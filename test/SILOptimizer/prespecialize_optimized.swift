@@ -0,0 +1,19 @@
+// RUN: %target-swift-frontend  %s -O -use-prespecializations -emit-sil | %FileCheck %s
+
+// REQUIRES: optimized_stdlib
+
+// FIXME: https://bugs.swift.org/browse/SR-2808
+// XFAIL: resilient_stdlib
+
+// Check that optimized builds call the pre-specializations of the
+// SwiftOnoneSupport library instead of creating their own specializations.
+// This test requires the standard library to be compiled with pre-specializations!
+
+// CHECK-LABEL: sil [noinline] @_TF23prespecialize_optimized9makeArrayFSiGSaSi_
+// Look for generic specialization <Swift.Int> of Swift.Array.init (repeating : A, count : Swift.Int) -> Swift.Array<A>
+// CHECK: function_ref @_TTSgq5Si___TFSaCfT9repeatingx5countSi_GSax_
+// CHECK: return
+@inline(never)
+public func makeArray(_ count: Int) -> [Int] {
+  return [Int](repeating: 0, count: count)
+}
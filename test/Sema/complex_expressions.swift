@@ -97,3 +97,9 @@ let v4 = [1 + 2 + 3, 4] as [UInt32] + [2 * 3] as [UInt32]
 let v5 = ([1 + 2 + 3, 4] as [UInt32]) + ([2 * 3] as [UInt32])
 let v6 = [1 + 2 + 3, 4] as Set<UInt32>
 let v7: [UInt32] = [55 * 8, 0]
+
+// Mixed literals and overloaded operators revisit the same operator
+// disjunctions in many branches of the search.
+func mixedLiteralsAndOperators(a: Double, b: Double, c: Double) -> Double {
+  return a + b * 2.0 - c / 3 + a * 4 - b / 5.0 + c * 6 - a / 7
+}
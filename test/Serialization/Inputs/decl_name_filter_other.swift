@@ -0,0 +1,13 @@
+public func filteredFunc() {}
+
+public struct FilteredType {
+  public init() {}
+}
+
+infix operator <*>
+
+public func <*>(lhs: Int, rhs: Int) -> Int { return lhs * rhs }
+
+extension Int {
+  public var filteredProp: Int { return self }
+}
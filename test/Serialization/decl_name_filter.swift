@@ -0,0 +1,29 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/decl_name_filter_other.swift
+// RUN: llvm-bcanalyzer -dump %t/decl_name_filter_other.swiftmodule | %FileCheck -check-prefix=BCANALYZER %s
+// RUN: %target-swift-frontend -I %t -parse %s -verify
+
+// The top-level decl, operator, extension and operator method tables each
+// get a filter.
+// BCANALYZER-NOT: UnknownCode
+// BCANALYZER: <DECL_NAME_FILTER
+// BCANALYZER: <DECL_NAME_FILTER
+// BCANALYZER: <DECL_NAME_FILTER
+// BCANALYZER: <DECL_NAME_FILTER
+// BCANALYZER-NOT: <DECL_NAME_FILTER
+
+import decl_name_filter_other
+
+// Names in the module are still found after reading the filters back.
+filteredFunc()
+decl_name_filter_other.filteredFunc()
+let _: FilteredType = FilteredType()
+let _: Int = 2 <*> 3
+let _: Int = 1.filteredProp
+
+// Names which aren't are ruled out.
+missingFunc() // expected-error {{use of unresolved identifier 'missingFunc'}}
+decl_name_filter_other.missingFunc() // expected-error {{module 'decl_name_filter_other' has no member named 'missingFunc'}}
+let _: MissingType // expected-error {{use of undeclared type 'MissingType'}}
+let _: Int = 1.missingProp // expected-error {{value of type 'Int' has no member 'missingProp'}}
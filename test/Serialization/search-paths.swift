@@ -5,6 +5,7 @@
 
 // RUN: %target-swift-frontend -emit-module -o %t -I %t/secret -F %t/Frameworks -parse-as-library %S/Inputs/has_xref.swift
 // RUN: %target-swift-frontend %s -parse -I %t -verify -show-diagnostics-after-fatal
+// RUN: %target-swift-frontend %s -parse -I %t -verify -show-diagnostics-after-fatal -cache-search-path-contents
 
 // Try again, treating has_xref as a main file to force serialization to occur.
 // RUN: %target-swift-frontend -emit-module -o %t -I %t/secret -F %t/Frameworks %S/Inputs/has_xref.swift
@@ -0,0 +1,51 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -experimental-skip-non-inlinable-function-bodies -parse-as-library -module-name Skipped -o %t/Skipped.swiftmodule %s
+// RUN: %target-swift-frontend -emit-sil -I %t -D CLIENT %s | %FileCheck -check-prefix=CLIENT %s
+// RUN: not %target-swift-frontend -emit-module -parse-as-library -module-name Skipped -o %t/Checked.swiftmodule %s 2>&1 | %FileCheck -check-prefix=CHECKED %s
+// RUN: not %target-swift-frontend -emit-module -experimental-skip-non-inlinable-function-bodies -parse-as-library -module-name Skipped -o %t/Transparent.swiftmodule -D TRANSPARENT_ERROR %s 2>&1 | %FileCheck -check-prefix=TRANSPARENT %s
+
+#if CLIENT
+
+import Skipped
+
+// The body of the transparent function is still serialized and inlined.
+// CLIENT-LABEL: sil @main
+// CLIENT-NOT: function_ref @_TF7Skipped6answerFT_Si
+// CLIENT: function_ref @_TF7Skipped7computeFT_Si
+_ = answer() + compute()
+
+#else
+
+// The bodies of these functions are not type-checked.
+// CHECKED: error: cannot convert value of type 'String' to specified type 'Int'
+public func compute() -> Int {
+  let value: Int = "not a number"
+  return value
+}
+
+public struct Point {
+  public var x: Int
+
+  // CHECKED: error: cannot convert value of type 'String' to specified type 'Int'
+  public init(x: Int) {
+    let unused: Int = ""
+    self.x = x
+  }
+
+  public var doubled: Int {
+    return x * "2"
+  }
+}
+
+@_transparent
+public func answer() -> Int {
+#if TRANSPARENT_ERROR
+  // TRANSPARENT: error: cannot convert value of type 'String' to specified type 'Int'
+  let value: Int = "42"
+#else
+  let value: Int = 42
+#endif
+  return value
+}
+
+#endif
@@ -0,0 +1,48 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s
+// RUN: touch -t 201401240005 %t/unchanged.swiftmodule
+// RUN: %S/../Inputs/getmtime.py %t/unchanged.swiftmodule > %t/orig-mtime.txt
+
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s
+// RUN: diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s -DPRIVATE_EXTRA
+// RUN: diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s -DBODY_CHANGE
+// RUN: diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s -DPUBLIC_EXTRA
+// RUN: not diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+
+// The layout of a struct changes with its private stored properties.
+// RUN: touch -t 201401240005 %t/unchanged.swiftmodule
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule -preserve-timestamp-if-interface-unchanged %s -DPUBLIC_EXTRA -DPRIVATE_STORED
+// RUN: not diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+
+// Without the option, the module is always replaced.
+// RUN: touch -t 201401240005 %t/unchanged.swiftmodule
+// RUN: %target-swift-frontend -emit-module -module-name unchanged -o %t/unchanged.swiftmodule %s -DPUBLIC_EXTRA -DPRIVATE_STORED
+// RUN: not diff %t/orig-mtime.txt <(%S/../Inputs/getmtime.py %t/unchanged.swiftmodule)
+
+public struct S {
+  public var x: Int
+#if PRIVATE_STORED
+  private var y: Int = 0
+#endif
+}
+
+public func publicFunc() -> Int {
+#if BODY_CHANGE
+  return 1
+#else
+  return 0
+#endif
+}
+
+#if PRIVATE_EXTRA
+private func privateFunc() {}
+#endif
+
+#if PUBLIC_EXTRA
+public func publicExtra() {}
+#endif
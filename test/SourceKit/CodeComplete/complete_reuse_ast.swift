@@ -0,0 +1,35 @@
+struct Foo {
+  func advancedFeatures(x: Int) {}
+  var bigPower: Int = 0
+}
+func foo() {
+  let x = Foo()
+
+  x.
+}
+func bar() {
+  let y = Foo()
+  y.
+}
+
+// The second completion in the same declaration reuses the AST of the first
+// one, and must produce the same results.
+
+// RUN: %sourcekitd-test -req=complete -pos=8:5 %s -- %s > %t.single
+// RUN: %sourcekitd-test -req=complete -pos=8:5 %s -- %s \
+// RUN:   == -req=complete -pos=8:5 %s -- %s > %t.reused
+// RUN: %FileCheck %s < %t.reused
+// CHECK:   key.name: "advancedFeatures(x:)"
+// CHECK:   key.name: "advancedFeatures(x:)"
+
+// RUN: cat %t.single %t.single > %t.check
+// RUN: diff -u %t.reused %t.check
+
+// A completion in another declaration does a full build.
+
+// RUN: %sourcekitd-test -req=complete -pos=8:5 %s -- %s \
+// RUN:   == -req=complete -pos=12:5 %s -- %s | %FileCheck %s -check-prefix=OTHER
+// OTHER:   key.name: "advancedFeatures(x:)"
+// OTHER:   key.name: "bigPower"
+// OTHER:   key.name: "advancedFeatures(x:)"
+// OTHER:   key.name: "bigPower"
@@ -0,0 +1,51 @@
+// RUN: %sourcekitd-test -req=index %s -- %s | %FileCheck %s
+
+// Every reference to a declaration after the first uses the name and USR
+// cached for it, including the ones for which no USR could be computed.
+
+struct S {
+  func method() {}
+}
+
+func global() {}
+
+let broken: Undeclared = 0
+
+func test(s: S) {
+  global()
+  s.method()
+  _ = broken
+  global()
+  s.method()
+  _ = broken
+  global()
+}
+
+// CHECK:      key.kind: source.lang.swift.ref.function.free,
+// CHECK-NEXT: key.name: "global()",
+// CHECK-NEXT: key.usr: "[[GLOBAL_USR:[^"]+]]",
+// CHECK-NEXT: key.line: 15,
+
+// CHECK:      key.kind: source.lang.swift.ref.function.method.instance,
+// CHECK-NEXT: key.name: "method()",
+// CHECK-NEXT: key.usr: "[[METHOD_USR:[^"]+]]",
+// CHECK-NEXT: key.line: 16,
+// CHECK-NEXT: key.column: 5,
+// CHECK-NEXT: key.receiver_usr: "[[S_USR:[^"]+]]"
+
+// CHECK:      key.kind: source.lang.swift.ref.function.free,
+// CHECK-NEXT: key.name: "global()",
+// CHECK-NEXT: key.usr: "[[GLOBAL_USR]]",
+// CHECK-NEXT: key.line: 18,
+
+// CHECK:      key.kind: source.lang.swift.ref.function.method.instance,
+// CHECK-NEXT: key.name: "method()",
+// CHECK-NEXT: key.usr: "[[METHOD_USR]]",
+// CHECK-NEXT: key.line: 19,
+// CHECK-NEXT: key.column: 5,
+// CHECK-NEXT: key.receiver_usr: "[[S_USR]]"
+
+// CHECK:      key.kind: source.lang.swift.ref.function.free,
+// CHECK-NEXT: key.name: "global()",
+// CHECK-NEXT: key.usr: "[[GLOBAL_USR]]",
+// CHECK-NEXT: key.line: 21,
@@ -10,6 +10,12 @@ func f(s : inout [Int]) {
 // RUN: %sourcekitd-test -req=interface-gen -module swift_mod -- -I %t.mod > %t.response
 // RUN: diff -u %s.response %t.response
 
+// A closed interface is kept, and reopening it must show the same text.
+// RUN: %sourcekitd-test -req=interface-gen-open -module swift_mod -- -I %t.mod \
+// RUN: 	== -req=close \
+// RUN: 	== -req=interface-gen -module swift_mod -- -I %t.mod > %t.reopened.response
+// RUN: diff -u %s.response %t.reopened.response
+
 // RUN: %sourcekitd-test -req=module-groups -module swift_mod -- -I %t.mod | %FileCheck -check-prefix=GROUP-EMPTY %s
 // GROUP-EMPTY: <GROUPS>
 // GROUP-EMPTY-NEXT: <\GROUPS>
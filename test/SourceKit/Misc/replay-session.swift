@@ -0,0 +1,20 @@
+// RUN: %sourcekitd-test -replay %S/Inputs/version.session -replay-repeat 2 -replay-concurrency 2 | %FileCheck %s
+
+// CHECK: Replayed 6 requests in {{.*}} s (repeat 2, concurrency 2)
+// CHECK-NEXT: request {{ *}}count errors cancelled p50(ms)
+// CHECK-NEXT: source.request.protocol_version {{ *}}6 0 0
+
+// RUN: rm -f %t.session
+// RUN: %sourcekitd-test -req=version -record-session %t.session
+// RUN: %sourcekitd-test -req=version -record-session %t.session
+// RUN: %FileCheck %s -check-prefix=RECORD < %t.session
+// RUN: %sourcekitd-test -replay %t.session -replay-no-delay | %FileCheck %s -check-prefix=REPLAY
+
+// RECORD: @ 0
+// RECORD-NEXT: {
+// RECORD-NEXT: key.request: source.request.protocol_version
+// RECORD: @ 0
+// RECORD-NEXT: {
+
+// REPLAY: Replayed 2 requests
+// REPLAY: source.request.protocol_version {{ *}}2 0 0
@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend %s -g -module-name lazy -emit-sib -o %t/lazy.sib
+
+// A mangled name is looked up directly, so only that function is
+// deserialized. A demangled name has to be matched against every function.
+
+// RUN: %target-sil-extract -module-name lazy -func="_TF4lazy3fooFT_Si" -stats %t/lazy.sib -o /dev/null 2>&1 | %FileCheck %s -check-prefix=MANGLED
+// RUN: %target-sil-extract -module-name lazy -func="lazy.foo" -stats %t/lazy.sib -o /dev/null 2>&1 | %FileCheck %s -check-prefix=DEMANGLED
+
+// Both ways extract the same function, with its debug scopes.
+
+// RUN: %target-sil-extract -module-name lazy -func="_TF4lazy3fooFT_Si" %t/lazy.sib | %FileCheck %s -check-prefix=EXTRACT-FOO
+// RUN: %target-sil-extract -module-name lazy -func="lazy.foo" %t/lazy.sib | %FileCheck %s -check-prefix=EXTRACT-FOO
+
+// REQUIRES: asserts
+
+// MANGLED: {{^ *}}1 deserialize - Number of deserialized SIL functions
+// DEMANGLED: {{^ *}}{{[2-9]|[1-9][0-9]+}} deserialize - Number of deserialized SIL functions
+
+// EXTRACT-FOO-NOT: sil hidden @_TF4lazy3barFT_T_
+// EXTRACT-FOO-NOT: sil hidden @_TF4lazy3bazFT_T_
+// EXTRACT-FOO: sil_scope {{[0-9]+}} { {{.*}} parent @_TF4lazy3fooFT_Si
+// EXTRACT-FOO-LABEL: sil hidden @_TF4lazy3fooFT_Si : $@convention(thin) () -> Int {
+// EXTRACT-FOO: return {{.*}}, scope {{[0-9]+}}
+// EXTRACT-FOO: } // end sil function '_TF4lazy3fooFT_Si'
+
+func foo() -> Int {
+  return 42
+}
+
+func bar() {
+  print("bar")
+}
+
+func baz() {
+  bar()
+}
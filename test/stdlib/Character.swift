@@ -237,6 +237,16 @@ CharacterTests.test(
     { x in { String(Character(x)) < String(Character($0)) } } as PredicateFn)
 }
 
+CharacterTests.test("Segmentation/ASCII") {
+  // ASCII text is segmented without the property table, except where a
+  // non-ASCII scalar or CR LF is involved.
+  let s = "ab\r\nc\u{301}d\n\re"
+  let expected = ["a", "b", "\r\n", "c\u{301}", "d", "\n", "\r", "e"]
+  expectEqualSequence(expected, s.characters.map { String($0) })
+  expectEqualSequence(
+    expected.reversed(), s.characters.reversed().map { String($0) })
+}
+
 CharacterTests.test("String.append(_: Character)") {
   for test in testCharacters {
     let character = Character(test)
@@ -163,6 +163,12 @@ PrintTests.test("Printable") {
   expectPrinted("1.25e-15", asFloat64(0.00000000000000125))
   expectPrinted("1.25e-16", asFloat64(0.000000000000000125))
   expectPrinted("1.25e-17", asFloat64(0.0000000000000000125))
+  expectPrinted("0.0001", asFloat64(0.0001))
+  expectPrinted("-12.5", asFloat64(-12.5))
+  expectPrinted("-0.0", asFloat64(-0.0))
+  expectPrinted("999999999999999.0", asFloat64(999999999999999.0))
+  expectPrinted("1e+15", asFloat64(1000000000000000.0))
+  expectPrinted("0.3", asFloat64(0.1 + 0.2))
 
 #if arch(i386) || arch(x86_64)
   expectPrinted("1.00000000000000001", asFloat80(1.00000000000000001))
@@ -500,6 +500,21 @@ CStringTests.test("String(cString:)") {
   }
 }
 
+CStringTests.test("String(cString:)/long") {
+  // Put a non-ASCII character at each position of a string long enough to be
+  // checked several bytes at a time.
+  let ascii = Array(repeating: UInt8(ascii: "a"), count: 40)
+  for position in 0...ascii.count {
+    var bytes = ascii
+    bytes.insert(contentsOf: [0xd0, 0xb0], at: position)
+    bytes.append(0)
+    let expected = String(repeating: "a", count: position) + "а" +
+      String(repeating: "a", count: ascii.count - position)
+    expectEqual(expected, String(cString: bytes))
+  }
+  expectEqual(String(repeating: "a", count: 40), String(cString: ascii + [0]))
+}
+
 CStringTests.test("String.decodeCString") {
   do {
     let s = getNullUTF8()
@@ -32,6 +32,8 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The character mask of the pattern; see \c getCharacterMask.
+  uint64_t patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -39,6 +41,21 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Returns a mask with a bit set for each character in \p str, ignoring
+  /// case.
+  ///
+  /// Some characters share a bit, so the mask can only prove that a
+  /// candidate does not match. Clients that match many patterns against the
+  /// same candidate can compute it once and call \c mayMatchCandidate before
+  /// matching.
+  static uint64_t getCharacterMask(StringRef str);
+
+  /// Whether a candidate with the character mask \p candidateMask could match
+  /// the pattern.
+  bool mayMatchCandidate(uint64_t candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
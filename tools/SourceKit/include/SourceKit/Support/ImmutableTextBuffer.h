@@ -21,6 +21,8 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
@@ -73,9 +75,18 @@ class ImmutableTextBuffer : public ImmutableTextUpdate {
   std::unique_ptr<llvm::SourceMgr> SrcMgr;
   unsigned BufId;
 
+  /// The update that owns the memory of the buffer, if the buffer is a view
+  /// into the text of an earlier update rather than a copy of it.
+  ImmutableTextUpdateRef Storage;
+
+  /// The byte offset of the start of each line, computed on first use.
+  mutable std::vector<unsigned> LineOffsets;
+  mutable std::once_flag LineOffsetsFlag;
+
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
-                               uint64_t Stamp);
+                               uint64_t Stamp,
+                               ImmutableTextUpdateRef Storage = nullptr);
   ImmutableTextBuffer(StringRef Filename, StringRef Text, uint64_t Stamp);
 
   StringRef getText() const;
@@ -106,6 +117,8 @@ public:
   unsigned getLength() const { return Length; }
   StringRef getText() const;
 
+  const llvm::MemoryBuffer *getInternalBuffer() const { return Buf.get(); }
+
   static bool classof(const ImmutableTextUpdate *ITD) {
     return ITD->getKind() == Kind::Replace;
   }
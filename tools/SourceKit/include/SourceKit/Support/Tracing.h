@@ -15,7 +15,9 @@
 
 #include "SourceKit/Support/UIdent.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
 
+#include <chrono>
 #include <vector>
 
 namespace SourceKit {
@@ -50,6 +52,9 @@ enum class OperationKind : uint64_t {
 
   CodeCompletionInit,
 };
+
+// The name of an operation kind, e.g. "PerformSema"
+llvm::StringRef getOperationKindName(OperationKind OpKind);
   
 typedef std::vector<std::pair<std::string, std::string>> StringPairs;
 
@@ -73,6 +78,16 @@ public:
   
   // Operation previously started with startXXX has finished
   virtual void operationFinished(uint64_t OpId) = 0;
+
+  // A phase of a running operation, e.g. "sema" of PerformSema, took
+  // Nanoseconds
+  virtual void operationPhase(uint64_t OpId, llvm::StringRef Phase,
+                              uint64_t Nanoseconds) {}
+
+  // A measurement of a running operation, e.g. whether it could use a cached
+  // AST or how many modules it loaded
+  virtual void operationMetric(uint64_t OpId, llvm::StringRef Name,
+                               uint64_t Value) {}
 };
 
 // Is tracing enabled
@@ -92,12 +107,20 @@ uint64_t startOperation(OperationKind OpKind,
 // Operation previously started with startXXX has finished
 void operationFinished(uint64_t OpId);
 
+// Report a phase of an operation previously started with startXXX
+void operationPhase(uint64_t OpId, llvm::StringRef Phase,
+                    uint64_t Nanoseconds);
+
+// Report a measurement of an operation previously started with startXXX
+void operationMetric(uint64_t OpId, llvm::StringRef Name, uint64_t Value);
+
 // Register trace consumer.
 void registerConsumer(TraceConsumer *Consumer);
 
 // Class that utilizes the RAII idiom for the operations being traced
 class TracedOperation final {
   llvm::Optional<uint64_t> OpId;
+  std::chrono::steady_clock::time_point PhaseStart;
 
 public:
   TracedOperation() {}
@@ -115,6 +138,24 @@ public:
              const StringPairs &OpArgs = StringPairs()) {
     finish();
     OpId = startOperation(OpKind, Inv, OpArgs);
+    PhaseStart = std::chrono::steady_clock::now();
+  }
+
+  // Report the time since the operation started, or since the previous
+  // phase ended, as the phase Name
+  void phase(llvm::StringRef Name) {
+    if (!OpId.hasValue())
+      return;
+    auto Now = std::chrono::steady_clock::now();
+    operationPhase(OpId.getValue(), Name,
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Now - PhaseStart).count());
+    PhaseStart = Now;
+  }
+
+  void metric(llvm::StringRef Name, uint64_t Value) {
+    if (OpId.hasValue())
+      operationMetric(OpId.getValue(), Name, Value);
   }
 
   void finish() {
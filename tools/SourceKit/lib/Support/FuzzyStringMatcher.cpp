@@ -21,8 +21,25 @@ using clang::toLowercase;
 using clang::isUppercase;
 using clang::isLowercase;
 
+static unsigned getCharacterMaskBit(char c) {
+  c = toLowercase(c);
+  if (c >= 'a' && c <= 'z')
+    return c - 'a';
+  if (c >= '0' && c <= '9')
+    return 26 + (c - '0');
+  return 36 + static_cast<unsigned char>(c) % 28;
+}
+
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  uint64_t mask = 0;
+  for (char c : str)
+    mask |= uint64_t(1) << getCharacterMaskBit(c);
+  return mask;
+}
+
 FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
-    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)) {
+    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)),
+      patternMask(getCharacterMask(pattern_)) {
   lowercasePattern.reserve(pattern.size());
   unsigned upperCharCount = 0;
   for (char c : pattern) {
@@ -11,19 +11,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/ImmutableTextBuffer.h"
-#include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
-using clang::RewriteRope;
 
 void ImmutableTextUpdate::anchor() {}
 
 ImmutableTextBuffer::ImmutableTextBuffer(
-    std::unique_ptr<llvm::MemoryBuffer> MemBuf, uint64_t Stamp)
-  : ImmutableTextUpdate(Kind::Buffer, Stamp) {
+    std::unique_ptr<llvm::MemoryBuffer> MemBuf, uint64_t Stamp,
+    ImmutableTextUpdateRef Storage)
+  : ImmutableTextUpdate(Kind::Buffer, Stamp), Storage(std::move(Storage)) {
     SrcMgr.reset(new SourceMgr);
     BufId = SrcMgr->AddNewSourceBuffer(std::move(MemBuf), SMLoc());
   }
@@ -51,12 +52,21 @@ const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  StringRef Text = getText();
+  if (ByteOffset > Text.size())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  std::call_once(LineOffsetsFlag, [&] {
+    LineOffsets.push_back(0);
+    for (size_t I = 0, E = Text.size(); I != E; ++I)
+      if (Text[I] == '\n')
+        LineOffsets.push_back(I + 1);
+  });
+
+  auto LineStart = std::upper_bound(LineOffsets.begin(), LineOffsets.end(),
+                                    ByteOffset) - 1;
+  return std::make_pair(unsigned(LineStart - LineOffsets.begin()) + 1,
+                        ByteOffset - *LineStart + 1);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -168,25 +178,88 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
   return new ImmutableTextSnapshot(this, Root, CurrUpd);
 }
 
-static std::unique_ptr<llvm::MemoryBuffer>
-getMemBufferFromRope(StringRef Filename, const RewriteRope &Rope) {
-  size_t Length = 0;
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    Length += I.piece().size();
+namespace {
+/// The text of a snapshot, as slices of the text of the buffer it starts
+/// from and of the replacements applied since. Applying an update only
+/// rearranges the slices, so the text is copied once, when it is flattened
+/// into a buffer for the compiler.
+class SnapshotPieces {
+  struct Piece {
+    StringRef Text;
+    /// The update whose buffer \c Text points into.
+    ImmutableTextUpdate *Owner;
+  };
+  SmallVector<Piece, 8> Pieces;
+
+  static const MemoryBuffer *getOwnerBuffer(ImmutableTextUpdate *Owner) {
+    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Owner))
+      return Buf->getInternalBuffer();
+    return cast<ReplaceImmutableTextUpdate>(Owner)->getInternalBuffer();
   }
 
-  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Length, Filename);
-  char *Ptr = (char*)MemBuf->getBufferStart();
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    StringRef Text = I.piece();
-    memcpy(Ptr, Text.data(), Text.size());
-    Ptr += Text.size();
+  void appendRange(SmallVectorImpl<Piece> &Result, size_t Begin,
+                   size_t End) const {
+    size_t PieceBegin = 0;
+    for (const Piece &P : Pieces) {
+      size_t PieceEnd = PieceBegin + P.Text.size();
+      if (PieceEnd > Begin && PieceBegin < End) {
+        size_t From = std::max(Begin, PieceBegin) - PieceBegin;
+        size_t To = std::min(End, PieceEnd) - PieceBegin;
+        Result.push_back({ P.Text.slice(From, To), P.Owner });
+      }
+      PieceBegin = PieceEnd;
+    }
   }
 
-  return MemBuf;
-}
+public:
+  explicit SnapshotPieces(ImmutableTextBuffer *Start) {
+    if (!Start->getText().empty())
+      Pieces.push_back({ Start->getText(), Start });
+  }
+
+  size_t size() const {
+    size_t Size = 0;
+    for (const Piece &P : Pieces)
+      Size += P.Text.size();
+    return Size;
+  }
+
+  void replace(ReplaceImmutableTextUpdate *Upd) {
+    size_t Offset = Upd->getByteOffset();
+    size_t End = Offset + Upd->getLength();
+    assert(End <= size() && "replacement out of range");
+
+    SmallVector<Piece, 8> Result;
+    appendRange(Result, 0, Offset);
+    if (!Upd->getText().empty())
+      Result.push_back({ Upd->getText(), Upd });
+    appendRange(Result, End, size());
+    Pieces = std::move(Result);
+  }
+
+  /// Returns a buffer with the text of the snapshot. If the text is the tail
+  /// of a single update's buffer, the result refers to that memory instead
+  /// of copying it, and \p Storage is set to the update that owns it.
+  std::unique_ptr<MemoryBuffer>
+  getMemBuffer(StringRef Filename, ImmutableTextUpdateRef &Storage) const {
+    if (Pieces.size() == 1) {
+      const Piece &P = Pieces.front();
+      if (P.Text.end() == getOwnerBuffer(P.Owner)->getBufferEnd()) {
+        Storage = P.Owner;
+        return MemoryBuffer::getMemBuffer(P.Text, Filename);
+      }
+    }
+
+    auto MemBuf = MemoryBuffer::getNewUninitMemBuffer(size(), Filename);
+    char *Ptr = const_cast<char *>(MemBuf->getBufferStart());
+    for (const Piece &P : Pieces) {
+      memcpy(Ptr, P.Text.data(), P.Text.size());
+      Ptr += P.Text.size();
+    }
+    return MemBuf;
+  }
+};
+} // end anonymous namespace
 
 ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     const ImmutableTextSnapshot &Snap) {
@@ -206,27 +279,20 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
       StartBuf = Buf;
   }
-  StringRef StartText = StartBuf->getText();
-
-  RewriteRope Rope;
-  auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
-    if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
-      StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
-    }
-  };
 
-  Rope.assign(StartText.begin(), StartText.end());
+  SnapshotPieces Pieces(StartBuf.get());
   Upd = StartBuf;
   while (Upd != Snap.DiffEnd) {
     Upd = Upd->Next;
-    applyUpdate(Upd);
+    if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd))
+      Pieces.replace(ReplaceUpd);
   }
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
+  ImmutableTextUpdateRef Storage;
+  auto MemBuf = Pieces.getMemBuffer(getFilename(), Storage);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
-                                                          Snap.getStamp());
+                                                          Snap.getStamp(),
+                                                          std::move(Storage));
 
   {
     llvm::sys::ScopedLock L(EditMtx);
@@ -14,6 +14,7 @@
 
 #include "swift/Frontend/Frontend.h"
 
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/YAMLTraits.h"
 
@@ -43,6 +44,29 @@ static std::atomic<TraceConsumerListNode *> consumers(nullptr);
 // Trace commands
 //===----------------------------------------------------------------------===//
 
+StringRef trace::getOperationKindName(trace::OperationKind OpKind) {
+  switch (OpKind) {
+  case OperationKind::SimpleParse: return "SimpleParse";
+  case OperationKind::PerformSema: return "PerformSema";
+  case OperationKind::AnnotAndDiag: return "AnnotAndDiag";
+  case OperationKind::ReadSyntaxInfo: return "ReadSyntaxInfo";
+  case OperationKind::ReadDiagnostics: return "ReadDiagnostics";
+  case OperationKind::ReadSemanticInfo: return "ReadSemanticInfo";
+  case OperationKind::IndexModule: return "IndexModule";
+  case OperationKind::IndexSource: return "IndexSource";
+  case OperationKind::CursorInfoForIFaceGen: return "CursorInfoForIFaceGen";
+  case OperationKind::CursorInfoForSource: return "CursorInfoForSource";
+  case OperationKind::ExpandPlaceholder: return "ExpandPlaceholder";
+  case OperationKind::FormatText: return "FormatText";
+  case OperationKind::RelatedIdents: return "RelatedIdents";
+  case OperationKind::CodeCompletion: return "CodeCompletion";
+  case OperationKind::OpenInterface: return "OpenInterface";
+  case OperationKind::OpenHeaderInterface: return "OpenHeaderInterface";
+  case OperationKind::CodeCompletionInit: return "CodeCompletionInit";
+  }
+  llvm_unreachable("unhandled operation kind");
+}
+
 // Is tracing enabled
 bool trace::enabled() {
   return tracing_enabled;
@@ -82,6 +106,27 @@ void trace::operationFinished(uint64_t OpId) {
   }
 }
 
+void trace::operationPhase(uint64_t OpId, StringRef Phase,
+                           uint64_t Nanoseconds) {
+  if (trace::enabled()) {
+    auto Node = consumers.load(std::memory_order_acquire);
+    while (Node) {
+      Node->Consumer->operationPhase(OpId, Phase, Nanoseconds);
+      Node = Node->Next;
+    }
+  }
+}
+
+void trace::operationMetric(uint64_t OpId, StringRef Name, uint64_t Value) {
+  if (trace::enabled()) {
+    auto Node = consumers.load(std::memory_order_acquire);
+    while (Node) {
+      Node->Consumer->operationMetric(OpId, Name, Value);
+      Node = Node->Next;
+    }
+  }
+}
+
 // Register trace consumer
 void trace::registerConsumer(trace::TraceConsumer *Consumer) {
   TraceConsumerListNode *Node = new TraceConsumerListNode {Consumer, nullptr};
@@ -30,6 +30,8 @@
 #include "swift/Sema/IDETypeChecking.h"
 
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -61,6 +63,13 @@ public:
 
 void SwiftASTConsumer::failed(StringRef Error) { }
 
+void SwiftASTConsumer::traceASTInfo(trace::TracedOperation &TracedOp) const {
+  auto Wait = std::chrono::steady_clock::now() - EnqueueTime;
+  TracedOp.metric("ast.cached", UsedExistingAST);
+  TracedOp.metric("ast.wait_us",
+      std::chrono::duration_cast<std::chrono::microseconds>(Wait).count());
+}
+
 //===----------------------------------------------------------------------===//
 // SwiftInvocation
 //===----------------------------------------------------------------------===//
@@ -217,8 +226,18 @@ namespace SourceKit {
 
 namespace {
 
+/// Identifies the contents of an input file: a hash of its text, so that an
+/// AST is only rebuilt when some input actually changed, not merely when a
+/// file was touched or a new, identical snapshot of it was taken.
 typedef uint64_t BufferStamp;
 
+/// The stamp for a file that couldn't be read.
+static const BufferStamp BadBufferStamp = BufferStamp(-1);
+
+static BufferStamp getContentStamp(StringRef Text) {
+  return llvm::hash_value(Text);
+}
+
 struct FileContent {
   ImmutableTextSnapshotRef Snapshot;
   std::unique_ptr<llvm::MemoryBuffer> Buffer;
@@ -240,6 +259,15 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
   llvm::sys::Mutex Mtx;
 
+  /// Held while building the AST, which happens on either of the AST build
+  /// queues.
+  llvm::sys::Mutex BuildMtx;
+
+  /// The cancellation flag and input stamps of the AST build in progress, if
+  /// any. Protected by Mtx.
+  std::shared_ptr<std::atomic<bool>> BuildCancellation;
+  SmallVector<BufferStamp, 8> BuildStamps;
+
 public:
   explicit ASTProducer(SwiftInvocationRef InvokRef)
     : InvokRef(std::move(InvokRef)) {}
@@ -252,10 +280,17 @@ public:
 
   void getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                       bool IsBackground,
                 std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
   bool shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                      ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
+  /// Cancel the AST build in progress if the inputs changed since it started,
+  /// so that the build which is about to be queued for the new inputs doesn't
+  /// have to wait for it.
+  void cancelStaleBuild(SwiftASTManager::Implementation &MgrImpl,
+                        ArrayRef<ImmutableTextSnapshotRef> Snapshots);
+
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
 
@@ -267,12 +302,22 @@ public:
   }
 
 private:
+  void dispatchBackgroundBuild(SwiftASTManager::Implementation &MgrImpl,
+                               ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
+
+  void getInputStamps(SwiftASTManager::Implementation &MgrImpl,
+                      ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                      SmallVectorImpl<BufferStamp> &InputStamps);
+
   ASTUnitRef getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                             ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                            std::shared_ptr<std::atomic<bool>> Cancellation,
                             std::string &Error);
 
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                           std::shared_ptr<std::atomic<bool>> Cancellation,
                            std::string &Error);
 };
 
@@ -316,10 +361,51 @@ struct SwiftASTManager::Implementation {
 
   WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Serial,
                            "sourcekit.swift.ASTBuilding" };
+  /// Builds the ASTs for background consumers. It is suspended while there
+  /// are interactive AST builds in the queue above.
+  WorkQueue BackgroundASTBuildQueue{ WorkQueue::Dequeuing::Serial,
+                                     "sourcekit.swift.ASTBuilding.background",
+                                     WorkQueue::Priority::Background };
+
+  /// The number of interactive AST builds that are queued or in progress, and
+  /// the background AST build in progress, if any. Protected by SchedulingMtx.
+  unsigned InteractiveBuilds = 0;
+  ASTProducer *BackgroundBuildProducer = nullptr;
+  std::shared_ptr<std::atomic<bool>> BackgroundBuildCancellation;
+  bool BackgroundBuildPreempted = false;
+  llvm::sys::Mutex SchedulingMtx;
+
+  void beginInteractiveBuild(ASTProducer *Producer);
+  void endInteractiveBuild();
+  /// 
+eturns false if the build has to wait for the interactive builds.
+  bool beginBackgroundBuild(ASTProducer *Producer,
+                            std::shared_ptr<std::atomic<bool>> Cancellation);
+  /// 
+eturns true if the build was cancelled for an interactive build.
+  bool endBackgroundBuild();
+
+  /// The content stamps of files read from disk, keyed by path. A file is
+  /// only re-read to recompute its stamp when its size or modification time
+  /// changes.
+  struct DiskFileStamp {
+    uint64_t ModificationTime;
+    uint64_t Size;
+    BufferStamp Stamp;
+  };
+  llvm::StringMap<DiskFileStamp> DiskFileStamps;
+
+  /// The content stamps of editor snapshots, keyed by path, for the most
+  /// recent snapshot of each file that was asked about.
+  llvm::StringMap<std::pair<uint64_t, BufferStamp>> SnapshotStamps;
+  llvm::sys::Mutex StampsMtx;
 
   ASTProducerRef getASTProducer(SwiftInvocationRef InvokRef);
   FileContent getFileContent(StringRef FilePath, std::string &Error);
+  FileContent getFileContentFromSnap(ImmutableTextSnapshotRef Snap,
+                                     StringRef FilePath);
   BufferStamp getBufferStamp(StringRef FilePath);
+  BufferStamp getSnapshotStamp(ImmutableTextSnapshotRef Snap);
   std::unique_ptr<llvm::MemoryBuffer> getMemoryBuffer(StringRef Filename,
                                                       std::string &Error);
 };
@@ -474,21 +560,30 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
                                       const void *OncePerASTToken,
                                  ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   ASTProducerRef Producer = Impl.getASTProducer(InvokRef);
+  ASTConsumer->EnqueueTime = std::chrono::steady_clock::now();
+  bool IsBackground = ASTConsumer->isBackground();
 
+  // Generations start at 1, so 0 never matches an AST.
+  uint64_t ExistingGeneration = 0;
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
     if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
+      ASTConsumer->UsedExistingAST = true;
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
       return;
     }
+    ExistingGeneration = Unit->getGeneration();
   }
 
   Producer->enqueueConsumer(std::move(ASTConsumer), OncePerASTToken);
 
-  Producer->getASTUnitAsync(Impl, Snapshots,
-    [Producer](ASTUnitRef Unit, StringRef Error) {
+  Producer->getASTUnitAsync(Impl, Snapshots, IsBackground,
+    [Producer, ExistingGeneration](ASTUnitRef Unit, StringRef Error) {
       auto Consumers = Producer->popQueuedConsumers();
 
       for (auto &Consumer : Consumers) {
+        // The AST isn't rebuilt if none of its inputs changed.
+        Consumer->UsedExistingAST =
+            Unit && Unit->getGeneration() == ExistingGeneration;
         if (Unit)
           Unit->Impl.consumeAsync(std::move(Consumer), Unit);
         else
@@ -512,11 +607,12 @@ SwiftASTManager::Implementation::getASTProducer(SwiftInvocationRef InvokRef) {
   return Producer;
 }
 
-static FileContent getFileContentFromSnap(ImmutableTextSnapshotRef Snap,
-                                          StringRef FilePath) {
+FileContent SwiftASTManager::Implementation::getFileContentFromSnap(
+    ImmutableTextSnapshotRef Snap, StringRef FilePath) {
   auto Buf = llvm::MemoryBuffer::getMemBufferCopy(
       Snap->getBuffer()->getText(), FilePath);
-  return FileContent(Snap, std::move(Buf), Snap->getStamp());
+  auto Stamp = getSnapshotStamp(Snap);
+  return FileContent(std::move(Snap), std::move(Buf), Stamp);
 }
 
 FileContent
@@ -526,24 +622,76 @@ SwiftASTManager::Implementation::getFileContent(StringRef UnresolvedPath,
   if (auto EditorDoc = EditorDocs.findByPath(FilePath))
     return getFileContentFromSnap(EditorDoc->getLatestSnapshot(), FilePath);
 
-  // FIXME: Is there a way to get timestamp and buffer for a file atomically ?
-  auto Stamp = getBufferStamp(FilePath);
+  // Stamp the buffer we actually read, so the stamp can't describe a
+  // different version of the file than the one the AST is built from.
   auto Buffer = getMemoryBuffer(FilePath, Error);
+  if (!Buffer)
+    return FileContent(nullptr, nullptr, BadBufferStamp);
+  auto Stamp = getContentStamp(Buffer->getBuffer());
+
+  llvm::sys::fs::file_status Status;
+  if (!llvm::sys::fs::status(FilePath, Status)) {
+    llvm::sys::ScopedLock L(StampsMtx);
+    DiskFileStamps[FilePath] = {
+      Status.getLastModificationTime().toEpochTime(), Status.getSize(), Stamp
+    };
+  }
   return FileContent(nullptr, std::move(Buffer), Stamp);
 }
 
 BufferStamp SwiftASTManager::Implementation::getBufferStamp(StringRef FilePath){
   if (auto EditorDoc = EditorDocs.findByPath(FilePath))
-    return EditorDoc->getLatestSnapshot()->getStamp();
+    return getSnapshotStamp(EditorDoc->getLatestSnapshot());
 
   llvm::sys::fs::file_status Status;
   if (std::error_code Ret = llvm::sys::fs::status(FilePath, Status)) {
     // Failure to read the file.
     LOG_WARN_FUNC("failed to stat file: " << FilePath
                   << " (" << Ret.message() << ')');
-    return -1;
+    return BadBufferStamp;
+  }
+  uint64_t ModificationTime = Status.getLastModificationTime().toEpochTime();
+  uint64_t Size = Status.getSize();
+
+  {
+    llvm::sys::ScopedLock L(StampsMtx);
+    auto Known = DiskFileStamps.find(FilePath);
+    if (Known != DiskFileStamps.end() &&
+        Known->second.ModificationTime == ModificationTime &&
+        Known->second.Size == Size)
+      return Known->second.Stamp;
+  }
+
+  // The file changed on disk, or we haven't seen it yet; hash its contents.
+  std::string Error;
+  auto Buffer = getMemoryBuffer(FilePath, Error);
+  if (!Buffer) {
+    LOG_WARN_FUNC("failed to read file: " << Error);
+    return BadBufferStamp;
   }
-  return Status.getLastModificationTime().toEpochTime();
+  auto Stamp = getContentStamp(Buffer->getBuffer());
+
+  llvm::sys::ScopedLock L(StampsMtx);
+  DiskFileStamps[FilePath] = { ModificationTime, Size, Stamp };
+  return Stamp;
+}
+
+BufferStamp SwiftASTManager::Implementation::getSnapshotStamp(
+    ImmutableTextSnapshotRef Snap) {
+  StringRef Filename = Snap->getFilename();
+  uint64_t SnapStamp = Snap->getStamp();
+  {
+    llvm::sys::ScopedLock L(StampsMtx);
+    auto Known = SnapshotStamps.find(Filename);
+    if (Known != SnapshotStamps.end() && Known->second.first == SnapStamp)
+      return Known->second.second;
+  }
+
+  auto Stamp = getContentStamp(Snap->getBuffer()->getText());
+
+  llvm::sys::ScopedLock L(StampsMtx);
+  SnapshotStamps[Filename] = { SnapStamp, Stamp };
+  return Stamp;
 }
 
 std::unique_ptr<llvm::MemoryBuffer>
@@ -562,22 +710,131 @@ SwiftASTManager::Implementation::getMemoryBuffer(StringRef Filename,
 
 void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                                   ArrayRef<ImmutableTextSnapshotRef> Snaps,
+                                  bool IsBackground,
                std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver) {
 
   ASTProducerRef ThisProducer = this;
   SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
   Snapshots.append(Snaps.begin(), Snaps.end());
 
+  cancelStaleBuild(MgrImpl, Snapshots);
+
+  if (IsBackground) {
+    dispatchBackgroundBuild(MgrImpl, Snapshots, std::move(Receiver));
+    return;
+  }
+
+  MgrImpl.beginInteractiveBuild(this);
   MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
     std::string Error;
-    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
+    auto Cancellation = std::make_shared<std::atomic<bool>>(false);
+    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots,
+                                                   Cancellation, Error);
+    MgrImpl.endInteractiveBuild();
+    // The build which cancelled this one was queued after it, and hands its
+    // AST to the consumers which are still waiting.
+    if (*Cancellation)
+      return;
     Receiver(Unit, Error);
   }, /*isStackDeep=*/true);
 }
 
+void ASTProducer::dispatchBackgroundBuild(
+    SwiftASTManager::Implementation &MgrImpl,
+    ArrayRef<ImmutableTextSnapshotRef> Snaps,
+    std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver) {
+  ASTProducerRef ThisProducer = this;
+  SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+  Snapshots.append(Snaps.begin(), Snaps.end());
+
+  MgrImpl.BackgroundASTBuildQueue.dispatch(
+      [ThisProducer, &MgrImpl, Snapshots, Receiver] {
+    auto Cancellation = std::make_shared<std::atomic<bool>>(false);
+    if (!MgrImpl.beginBackgroundBuild(ThisProducer.get(), Cancellation)) {
+      ThisProducer->dispatchBackgroundBuild(MgrImpl, Snapshots, Receiver);
+      return;
+    }
+    std::string Error;
+    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots,
+                                                   Cancellation, Error);
+    bool Preempted = MgrImpl.endBackgroundBuild();
+    if (*Cancellation) {
+      // Start over once the interactive builds are done; the queue is
+      // suspended until then.
+      if (Preempted)
+        ThisProducer->dispatchBackgroundBuild(MgrImpl, Snapshots, Receiver);
+      return;
+    }
+    Receiver(Unit, Error);
+  }, /*isStackDeep=*/true);
+}
+
+void SwiftASTManager::Implementation::beginInteractiveBuild(
+    ASTProducer *Producer) {
+  llvm::sys::ScopedLock L(SchedulingMtx);
+  if (InteractiveBuilds++ == 0)
+    BackgroundASTBuildQueue.suspend();
+
+  // An interactive build of the same file gets the AST of the background
+  // build, so only preempt the builds of other files.
+  if (BackgroundBuildCancellation && BackgroundBuildProducer != Producer &&
+      !BackgroundBuildPreempted) {
+    LOG_INFO_FUNC(High, "preempting background AST build");
+    BackgroundBuildPreempted = true;
+    BackgroundBuildCancellation->store(true);
+  }
+}
+
+void SwiftASTManager::Implementation::endInteractiveBuild() {
+  llvm::sys::ScopedLock L(SchedulingMtx);
+  assert(InteractiveBuilds > 0);
+  if (--InteractiveBuilds == 0)
+    BackgroundASTBuildQueue.resume();
+}
+
+bool SwiftASTManager::Implementation::beginBackgroundBuild(
+    ASTProducer *Producer, std::shared_ptr<std::atomic<bool>> Cancellation) {
+  llvm::sys::ScopedLock L(SchedulingMtx);
+  // The build may have been dequeued right before the queue got suspended.
+  if (InteractiveBuilds > 0)
+    return false;
+  BackgroundBuildProducer = Producer;
+  BackgroundBuildCancellation = std::move(Cancellation);
+  BackgroundBuildPreempted = false;
+  return true;
+}
+
+bool SwiftASTManager::Implementation::endBackgroundBuild() {
+  llvm::sys::ScopedLock L(SchedulingMtx);
+  BackgroundBuildProducer = nullptr;
+  BackgroundBuildCancellation.reset();
+  return BackgroundBuildPreempted;
+}
+
+void ASTProducer::cancelStaleBuild(SwiftASTManager::Implementation &MgrImpl,
+                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    if (!BuildCancellation)
+      return;
+  }
+
+  SmallVector<BufferStamp, 8> InputStamps;
+  getInputStamps(MgrImpl, Snapshots, InputStamps);
+
+  llvm::sys::ScopedLock L(Mtx);
+  if (BuildCancellation && BuildStamps != InputStamps) {
+    LOG_INFO_FUNC(High, "cancelling stale AST build: "
+                  << InvokRef->Impl.Opts.PrimaryFile);
+    BuildCancellation->store(true);
+  }
+}
+
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                               std::shared_ptr<std::atomic<bool>> Cancellation,
                                    std::string &Error) {
+  llvm::sys::ScopedLock BuildLock(BuildMtx);
   if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
@@ -592,10 +849,17 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
     }
 
-    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    auto NewAST = createASTUnit(MgrImpl, Snapshots, Cancellation, Error);
     {
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
+      BuildCancellation.reset();
+      if (*Cancellation) {
+        // Keep the previous AST for consumers that accept a stale one, but
+        // make sure the next request rebuilds it.
+        Stamps.clear();
+        return nullptr;
+      }
       AST = NewAST;
     }
 
@@ -636,19 +900,17 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   return Consumers;
 }
 
-bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
-                                ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+void ASTProducer::getInputStamps(SwiftASTManager::Implementation &MgrImpl,
+                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                                 SmallVectorImpl<BufferStamp> &InputStamps) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
-
-  // Check if the inputs changed.
-  SmallVector<BufferStamp, 8> InputStamps;
   InputStamps.reserve(Invok.Opts.Invok.getInputFilenames().size());
   for (auto &File : Invok.Opts.Invok.getInputFilenames()) {
     bool FoundSnapshot = false;
     for (auto &Snap : Snapshots) {
       if (Snap->getFilename() == File) {
         FoundSnapshot = true;
-        InputStamps.push_back(Snap->getStamp());
+        InputStamps.push_back(MgrImpl.getSnapshotStamp(Snap));
         break;
       }
     }
@@ -656,6 +918,13 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
       InputStamps.push_back(MgrImpl.getBufferStamp(File));
   }
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
+}
+
+bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
+                                ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  // Check if the inputs changed.
+  SmallVector<BufferStamp, 8> InputStamps;
+  getInputStamps(MgrImpl, Snapshots, InputStamps);
   if (Stamps != InputStamps)
     return true;
 
@@ -720,6 +989,7 @@ static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                               std::shared_ptr<std::atomic<bool>> Cancellation,
                                       std::string &Error) {
   Stamps.clear();
   DependencyStamps.clear();
@@ -732,7 +1002,7 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
     for (auto &Snap : Snapshots) {
       if (Snap->getFilename() == File) {
         FoundSnapshot = true;
-        Contents.push_back(getFileContentFromSnap(Snap, File));
+        Contents.push_back(MgrImpl.getFileContentFromSnap(Snap, File));
         break;
       }
     }
@@ -752,6 +1022,12 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   for (auto &Content : Contents)
     Stamps.push_back(Content.Stamp);
 
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    BuildCancellation = Cancellation;
+    BuildStamps = Stamps;
+  }
+
   trace::SwiftInvocation TraceInfo;
 
   if (trace::enabled()) {
@@ -779,8 +1055,17 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CompilerInvocation Invocation;
   Opts.applyTo(Invocation);
 
-  for (auto &Content : Contents)
+  uint64_t InputBytes = 0;
+  for (auto &Content : Contents) {
     Invocation.addInputBuffer(Content.Buffer.get());
+    InputBytes += Content.Buffer->getBufferSize();
+  }
+
+  trace::TracedOperation TracedOp;
+  if (trace::enabled()) {
+    TracedOp.start(trace::OperationKind::PerformSema, TraceInfo);
+    TracedOp.metric("input.bytes", InputBytes);
+  }
 
   if (CompIns.setup(Invocation)) {
     // FIXME: Report the diagnostic.
@@ -788,16 +1073,22 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
     Error = "compilation setup failed";
     return nullptr;
   }
-
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
-    TracedOp.start(trace::OperationKind::PerformSema, TraceInfo);
-  }
+  TracedOp.phase("setup");
+  CompIns.getASTContext().CancellationFlag = Cancellation;
 
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
   CompIns.performSema();
+  // Parsing, module loading and type checking all happen in performSema, so
+  // the number of loaded modules tells how much of it was module loading.
+  TracedOp.phase("sema");
+  TracedOp.metric("modules.loaded",
+                  CompIns.getASTContext().LoadedModules.size());
+  if (*Cancellation) {
+    Error = "AST build cancelled";
+    return nullptr;
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -808,6 +1099,7 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
     DependencyStamps.push_back(std::make_pair(Filename,
                                               MgrImpl.getBufferStamp(Filename)));
   }
+  TracedOp.phase("dependencies");
 
   // Since we only typecheck the primary file (plus referenced constructs
   // from other files), any error is likely to break SIL generation.
@@ -832,6 +1124,7 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
       SILOptions SILOpts;
       std::unique_ptr<SILModule> SILMod = performSILGeneration(*SF, SILOpts);
       runSILDiagnosticPasses(*SILMod);
+      TracedOp.phase("sil-diagnostics");
     }
   }
 
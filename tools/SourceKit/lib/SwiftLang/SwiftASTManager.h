@@ -17,6 +17,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include <chrono>
 #include <functional>
 #include <string>
 
@@ -43,6 +44,10 @@ namespace SourceKit {
   typedef RefPtr<SwiftInvocation> SwiftInvocationRef;
   class EditorDiagConsumer;
 
+namespace trace {
+  class TracedOperation;
+}
+
 class ASTUnit : public SourceKit::ThreadSafeRefCountedBase<ASTUnit> {
 public:
   struct Implementation;
@@ -65,9 +70,25 @@ public:
 typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
 
 class SwiftASTConsumer {
+  friend class SwiftASTManager;
+
+  /// When the consumer was handed to the AST manager, and whether it got an
+  /// AST which was already built; for tracing.
+  std::chrono::steady_clock::time_point EnqueueTime;
+  bool UsedExistingAST = false;
+
 public:
   virtual ~SwiftASTConsumer() { }
+
+  /// Report how long the consumer waited for its AST and whether the AST was
+  /// already built, as metrics of \p TracedOp.
+  void traceASTInfo(trace::TracedOperation &TracedOp) const;
+
   virtual void cancelled() {}
+  /// Whether nobody is waiting on the consumer interactively. The AST for a
+  /// background consumer is built at low priority, and only when no AST for
+  /// an interactive consumer is waiting to be built.
+  virtual bool isBackground() const { return false; }
   /// If there is an existing AST, this is called before trying to update it.
   /// Consumers may choose to still accept it even though it may have stale parts.
   ///
@@ -97,6 +118,10 @@ public:
   /// \param OncePerASTToken if non-null, a previous query with the same value
   /// token, that is enqueued waiting to be executed on the same AST, will be
   /// cancelled.
+  ///
+  /// If the AST needs to be built for an interactive consumer, a background
+  /// AST build of a different file in progress is cancelled and restarted
+  /// once the interactive builds are done.
   void processASTAsync(SwiftInvocationRef Invok,
                        SwiftASTConsumerRef ASTConsumer,
                        const void *OncePerASTToken,
@@ -21,6 +21,7 @@
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/CodeCompletionCache.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace SourceKit;
@@ -82,6 +83,7 @@ struct SwiftCodeCompletionConsumer
       MutableArrayRef<CodeCompletionResult *>, SwiftCompletionInfo &)>;
   HandlerFunc handleResultsImpl;
   SwiftCompletionInfo swiftContext;
+  bool hasResults = false;
 
   SwiftCodeCompletionConsumer(HandlerFunc handleResultsImpl)
       : handleResultsImpl(handleResultsImpl) {}
@@ -97,12 +99,100 @@ struct SwiftCodeCompletionConsumer
 
   void handleResults(MutableArrayRef<CodeCompletionResult *> Results) override {
     assert(swiftContext.swiftASTContext);
+    hasResults = true;
     CodeCompletionContext::sortCompletionResults(Results);
     handleResultsImpl(Results, swiftContext);
   }
 };
 } // anonymous namespace
 
+/// The number of completions which reuse the AST of a completion instance
+/// before it is built from scratch again. Each one adds a buffer and the AST
+/// of a declaration to it.
+static const unsigned MaxCompletionInstanceReuseCount = 100;
+
+SwiftCompletionInstance::SwiftCompletionInstance() {}
+SwiftCompletionInstance::~SwiftCompletionInstance() {}
+
+static void
+getInputStamps(const CompilerInvocation &Invocation, StringRef PrimaryFile,
+               std::vector<std::pair<uint64_t, uint64_t>> &Stamps) {
+  for (auto &File : Invocation.getInputFilenames()) {
+    if (File == PrimaryFile)
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(File, Status)) {
+      Stamps.push_back({ 0, 0 });
+      continue;
+    }
+    Stamps.push_back({ Status.getLastModificationTime().toEpochTime(),
+                       Status.getSize() });
+  }
+}
+
+/// Complete with the compiler instance of the last completion, if the
+/// completion point is in the same declaration and nothing else changed, so
+/// that only this declaration is parsed and type-checked again.
+///
+/// \returns false if the instance can't be reused, or nothing was completed,
+/// e.g. because the edit moved the completion point out of the declaration.
+static bool reuseCompletionInstance(SwiftCompletionInstance &Inst,
+                                    llvm::MemoryBuffer *InputFile,
+                                    llvm::MemoryBuffer *NewBuffer,
+                                    unsigned CodeCompletionOffset,
+                                    ArrayRef<const char *> Args,
+                                    SwiftCodeCompletionConsumer &SwiftConsumer,
+                                    ide::CodeCompletionCache &Cache) {
+  if (Inst.ReuseCount >= MaxCompletionInstanceReuseCount ||
+      Inst.FileName != InputFile->getBufferIdentifier() ||
+      Inst.Args.size() != Args.size() ||
+      !std::equal(Args.begin(), Args.end(), Inst.Args.begin()))
+    return false;
+
+  CompilerInstance &CI = *Inst.CI;
+  unsigned OldCompletionOffset = CI.getSourceMgr().getCodeCompletionOffset();
+  unsigned Start, End;
+  if (!CI.getCodeCompletionDeclRange(Start, End) || End <= OldCompletionOffset)
+    return false;
+
+  // The last token of the declaration is after the code completion point, so
+  // it is one byte earlier in the text than in the completion buffer.
+  StringRef OldText = Inst.Text;
+  StringRef NewText = InputFile->getBuffer();
+  int Delta = int(NewText.size()) - int(OldText.size());
+  unsigned OldEnd = End - 1;
+  if (int(OldEnd) + Delta < int(Start))
+    return false;
+  unsigned NewEnd = OldEnd + Delta;
+  if (CodeCompletionOffset <= Start || CodeCompletionOffset > NewEnd)
+    return false;
+  if (NewText.substr(0, Start) != OldText.substr(0, Start) ||
+      NewText.substr(NewEnd) != OldText.substr(OldEnd))
+    return false;
+
+  std::vector<std::pair<uint64_t, uint64_t>> InputStamps;
+  getInputStamps(*Inst.Invocation, Inst.FileName, InputStamps);
+  if (InputStamps != Inst.InputStamps)
+    return false;
+
+  ide::CodeCompletionContext CompletionContext(Cache);
+  std::unique_ptr<CodeCompletionCallbacksFactory> CompletionCallbacksFactory(
+      ide::makeCodeCompletionCallbacksFactory(CompletionContext,
+                                              SwiftConsumer));
+
+  CloseClangModuleFiles scopedCloseFiles(
+      *CI.getASTContext().getClangModuleLoader());
+  SwiftConsumer.setContext(&CI.getASTContext(), Inst.Invocation.get(),
+                           &CompletionContext);
+  CI.performCodeCompletionAgain(NewBuffer, CodeCompletionOffset, Delta,
+                                CompletionCallbacksFactory.get());
+  SwiftConsumer.clearContext();
+
+  Inst.Text = NewText;
+  ++Inst.ReuseCount;
+  return SwiftConsumer.hasResults;
+}
+
 static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                                   llvm::MemoryBuffer *UnresolvedInputFile,
                                   unsigned Offset,
@@ -132,22 +222,6 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
       UnresolvedInputFile->getBuffer(),
       Lang.resolvePathSymlinks(UnresolvedInputFile->getBufferIdentifier()));
 
-  CompilerInstance CI;
-  // Display diagnostics to stderr.
-  PrintingDiagnosticConsumer PrintDiags;
-  CI.addDiagnosticConsumer(&PrintDiags);
-
-  CompilerInvocation Invocation;
-  bool Failed = Lang.getASTManager().initCompilerInvocation(
-      Invocation, Args, CI.getDiags(), InputFile->getBufferIdentifier(), Error);
-  if (Failed) {
-    return false;
-  }
-  if (Invocation.getInputFilenames().empty()) {
-    Error = "no input filenames specified";
-    return false;
-  }
-
   auto origBuffSize = InputFile->getBufferSize();
   unsigned CodeCompletionOffset = Offset;
   if (CodeCompletionOffset > origBuffSize) {
@@ -163,9 +237,21 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
   *NewPos = '\0';
   std::copy(Position, InputFile->getBufferEnd(), NewPos+1);
 
-  Invocation.setCodeCompletionPoint(NewBuffer.get(), CodeCompletionOffset);
-
   auto swiftCache = Lang.getCodeCompletionCache(); // Pin the cache.
+
+  // While the user types in the same function, only the function needs to be
+  // parsed and type-checked again.
+  if (auto Reusable = Lang.takeCompletionInstance()) {
+    if (reuseCompletionInstance(*Reusable, InputFile.get(), NewBuffer.get(),
+                                CodeCompletionOffset, Args, SwiftConsumer,
+                                swiftCache->getCache())) {
+      TracedOp.phase("complete");
+      TracedOp.metric("ast.reused", 1);
+      Lang.setCompletionInstance(std::move(Reusable));
+      return true;
+    }
+  }
+
   ide::CodeCompletionContext CompletionContext(swiftCache->getCache());
 
   // Create a factory for code completion callbacks that will feed the
@@ -174,6 +260,26 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
       ide::makeCodeCompletionCallbacksFactory(CompletionContext,
                                               SwiftConsumer));
 
+  auto Inst = llvm::make_unique<SwiftCompletionInstance>();
+  Inst->Invocation.reset(new CompilerInvocation());
+  Inst->PrintDiags.reset(new PrintingDiagnosticConsumer());
+  Inst->CI.reset(new CompilerInstance());
+  CompilerInstance &CI = *Inst->CI;
+  CompilerInvocation &Invocation = *Inst->Invocation;
+  // Display diagnostics to stderr.
+  CI.addDiagnosticConsumer(Inst->PrintDiags.get());
+
+  bool Failed = Lang.getASTManager().initCompilerInvocation(
+      Invocation, Args, CI.getDiags(), InputFile->getBufferIdentifier(), Error);
+  if (Failed) {
+    return false;
+  }
+  if (Invocation.getInputFilenames().empty()) {
+    Error = "no input filenames specified";
+    return false;
+  }
+
+  Invocation.setCodeCompletionPoint(NewBuffer.get(), CodeCompletionOffset);
   Invocation.setCodeCompletionFactory(CompletionCallbacksFactory.get());
 
   // FIXME: We need to be passing the buffers from the open documents.
@@ -184,6 +290,7 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
     return true;
   }
 
+  TracedOp.phase("setup");
   TracedOp.finish();
 
   if (trace::enabled()) {
@@ -211,6 +318,22 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                            &CompletionContext);
   CI.performSema();
   SwiftConsumer.clearContext();
+
+  // Completion runs during type checking, after the imports were loaded.
+  TracedOp.phase("complete");
+  TracedOp.metric("modules.loaded", CI.getASTContext().LoadedModules.size());
+
+  unsigned Start, End;
+  if (SwiftConsumer.hasResults && CI.getCodeCompletionDeclRange(Start, End)) {
+    // The factory doesn't outlive this call; later completions pass their
+    // own to performCodeCompletionAgain.
+    Invocation.setCodeCompletionFactory(nullptr);
+    Inst->Args.assign(Args.begin(), Args.end());
+    Inst->FileName = InputFile->getBufferIdentifier();
+    Inst->Text = InputFile->getBuffer();
+    getInputStamps(Invocation, Inst->FileName, Inst->InputStamps);
+    Lang.setCompletionInstance(std::move(Inst));
+  }
   return true;
 }
 
@@ -1239,15 +1239,25 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+    // Note that the length can span multiple lines.
+    unsigned Length = Node.Range.getByteLength();
+
+    // Most tokens of a large file are nowhere near the edit. Skip the ones
+    // that end before the affected range, which starts at the beginning of a
+    // line, or start after it once we've synced up, without computing their
+    // line and column.
+    if (EditedLineRange.isValid() &&
+        (Offset + Length <= AffectedRange.first ||
+         Offset > AffectedRange.first + AffectedRange.second))
+      return true;
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
-    // Note that the length can span multiple lines.
-    unsigned Length = Node.Range.getByteLength();
 
     SwiftSyntaxToken Token(StartLineAndColumn.second, Length,
                            Node.Kind);
@@ -1682,9 +1692,12 @@ ImmutableTextSnapshotRef SwiftEditorDocument::replaceText(
 
   ImmutableTextBufferRef ImmBuf = Snapshot->getBuffer();
 
-  // The affected range starts from the previous newline.
+  // The affected range starts from the previous newline. The search starts
+  // at Offset - 1, so that an edit which starts with a newline still starts
+  // the range at the beginning of the edited line.
   if (Offset > 0) {
-    auto AffectedRangeOffset = ImmBuf->getText().rfind('\n', Offset);
+    auto AffectedRangeOffset =
+        ImmBuf->getText().substr(0, Offset).rfind('\n');
     Impl.AffectedRange.first =
       AffectedRangeOffset != StringRef::npos ? AffectedRangeOffset + 1 : 0;
   }
@@ -2055,7 +2068,7 @@ void SwiftLangSupport::editorOpen(StringRef Name, llvm::MemoryBuffer *Buf,
 void SwiftLangSupport::editorClose(StringRef Name, bool RemoveCache) {
   auto Removed = EditorDocuments.remove(Name);
   if (!Removed)
-    IFaceGenContexts.remove(Name);
+    IFaceGenContexts.remove(Name, /*KeepClosed=*/!RemoveCache);
   if (Removed && RemoveCache)
     Removed->removeCachedAST();
   // FIXME: Report error if Name did not apply to anything ?
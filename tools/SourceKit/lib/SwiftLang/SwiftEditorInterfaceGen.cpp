@@ -25,6 +25,7 @@
 
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/FileSystem.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -76,6 +77,12 @@ public:
   PrintingDiagnosticConsumer DiagConsumer;
   CompilerInstance Instance;
   Module *Mod = nullptr;
+  // The options the interface of a module was printed with, and the
+  // modification time of the module file at the time.
+  Optional<std::string> Group;
+  Optional<std::string> InterestedUSR;
+  bool SynthesizedExtensions = false;
+  uint64_t ModuleFileModTime = 0;
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
@@ -334,6 +341,13 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
   return false;
 }
 
+static uint64_t getModTime(StringRef Filename) {
+  llvm::sys::fs::file_status Status;
+  if (Filename.empty() || llvm::sys::fs::status(Filename, Status))
+    return 0;
+  return Status.getLastModificationTime().toEpochTime();
+}
+
 static bool getHeaderInterfaceInfo(ASTContext &Ctx,
                                    StringRef HeaderName,
                                    SourceTextInfo &Info,
@@ -417,6 +431,13 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
     if (getModuleInterfaceInfo(Ctx, ModuleOrHeaderName, Group, IFaceGenCtx->Impl,
                                ErrMsg, SynthesizedExtensions, InterestedUSR))
       return nullptr;
+    if (Group)
+      IFaceGenCtx->Impl.Group = Group->str();
+    if (InterestedUSR)
+      IFaceGenCtx->Impl.InterestedUSR = InterestedUSR->str();
+    IFaceGenCtx->Impl.SynthesizedExtensions = SynthesizedExtensions;
+    IFaceGenCtx->Impl.ModuleFileModTime =
+        getModTime(IFaceGenCtx->Impl.Mod->getModuleFilename());
   } else {
     auto &FEOpts = Invocation.getFrontendOptions();
     if (FEOpts.ImplicitObjCHeaderPath.empty()) {
@@ -541,6 +562,26 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::canReuseFor(StringRef ModuleName,
+                                           Optional<StringRef> Group,
+                                           bool SynthesizedExtensions,
+                                           Optional<StringRef> InterestedUSR,
+                                           const CompilerInvocation &Invok) {
+  if (!matches(ModuleName, Invok))
+    return false;
+
+  if (Group.hasValue() != Impl.Group.hasValue() ||
+      (Group && *Group != *Impl.Group))
+    return false;
+  if (InterestedUSR.hasValue() != Impl.InterestedUSR.hasValue() ||
+      (InterestedUSR && *InterestedUSR != *Impl.InterestedUSR))
+    return false;
+  if (SynthesizedExtensions != Impl.SynthesizedExtensions)
+    return false;
+
+  return getModTime(Impl.Mod->getModuleFilename()) == Impl.ModuleFileModTime;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -625,9 +666,35 @@ void SwiftInterfaceGenMap::set(StringRef Name,
   IFaceGens[Name] = IFaceGen;
 }
 
-bool SwiftInterfaceGenMap::remove(StringRef Name) {
+/// The number of closed module interfaces SwiftInterfaceGenMap keeps. Each
+/// of them holds on to the AST of its module.
+static const unsigned MaxClosedInterfaces = 2;
+
+bool SwiftInterfaceGenMap::remove(StringRef Name, bool KeepClosed) {
   llvm::sys::ScopedLock L(Mtx);
-  return IFaceGens.erase(Name);
+  auto It = IFaceGens.find(Name);
+  if (It == IFaceGens.end())
+    return false;
+
+  if (KeepClosed && It->getValue()->isModule()) {
+    Closed.insert(Closed.begin(), It->getValue());
+    if (Closed.size() > MaxClosedInterfaces)
+      Closed.pop_back();
+  }
+  IFaceGens.erase(It);
+  return true;
+}
+
+SwiftInterfaceGenContextRef SwiftInterfaceGenMap::takeClosed(StringRef Name) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto It = Closed.begin(), E = Closed.end(); It != E; ++It) {
+    if ((*It)->getDocumentName() == Name) {
+      SwiftInterfaceGenContextRef IFaceGen = *It;
+      Closed.erase(It);
+      return IFaceGen;
+    }
+  }
+  return nullptr;
 }
 
 SwiftInterfaceGenContextRef
@@ -712,6 +779,24 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
+  // If the same interface was closed recently, show it again instead of
+  // printing the module again.
+  if (auto IFaceGenRef = IFaceGenContexts.takeClosed(Name)) {
+    if (IFaceGenRef->canReuseFor(ModuleName, Group, SynthesizedExtensions,
+                                 InterestedUSR, Invocation)) {
+      // A request that started before the interface was closed may still be
+      // using its AST.
+      Semaphore Done(0);
+      IFaceGenRef->accessASTAsync([&] {
+        IFaceGenRef->reportEditorInfo(Consumer);
+        Done.signal();
+      });
+      Done.wait();
+      IFaceGenContexts.set(Name, IFaceGenRef);
+      return;
+    }
+  }
+
   std::string ErrMsg;
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
@@ -750,6 +835,8 @@ public:
     Consumer->handleRequestError(Error.data());
   }
 
+  bool isBackground() const override { return true; }
+
   void handlePrimaryAST(ASTUnitRef AstUnit) override {
     std::string Error;
     auto IFaceGenRef = SwiftInterfaceGenContext::createForSwiftSource(Name,
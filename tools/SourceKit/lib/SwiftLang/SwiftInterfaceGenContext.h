@@ -60,6 +60,14 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Whether this is the interface of module \p ModuleName printed with the
+  /// same options for \p Invok, and the module file did not change since, so
+  /// that it can be shown again without printing the module again.
+  bool canReuseFor(StringRef ModuleName, Optional<StringRef> Group,
+                   bool SynthesizedExtensions,
+                   Optional<StringRef> InterestedUSR,
+                   const swift::CompilerInvocation &Invok);
+
   /// Note: requires exclusive access to the underlying AST.
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
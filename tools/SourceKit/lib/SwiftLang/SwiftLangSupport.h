@@ -34,6 +34,7 @@ namespace swift {
   class CompilerInstance;
   class CompilerInvocation;
   class Decl;
+  class PrintingDiagnosticConsumer;
   class Type;
   class AbstractStorageDecl;
   class SourceFile;
@@ -177,12 +178,21 @@ public:
 
 class SwiftInterfaceGenMap {
   llvm::StringMap<SwiftInterfaceGenContextRef> IFaceGens;
+  /// The module interfaces which were closed most recently, most recent
+  /// first. Printing the interface of a large module takes seconds, and
+  /// editors close and reopen the same interfaces all the time.
+  std::vector<SwiftInterfaceGenContextRef> Closed;
   mutable llvm::sys::Mutex Mtx;
 
 public:
   SwiftInterfaceGenContextRef get(StringRef Name) const;
   void set(StringRef Name, SwiftInterfaceGenContextRef IFaceGen);
-  bool remove(StringRef Name);
+  /// \param KeepClosed Whether to keep the interface of a module around after
+  /// it was removed, see takeClosed().
+  bool remove(StringRef Name, bool KeepClosed = false);
+  /// Returns the closed module interface with the document name \p Name, if
+  /// it was kept, and forgets about it.
+  SwiftInterfaceGenContextRef takeClosed(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
 };
@@ -196,6 +206,26 @@ struct SwiftCompletionCache
   ~SwiftCompletionCache();
 };
 
+/// The compiler instance of the last code completion. The next completion
+/// reuses its type-checked AST if it is in the same declaration of the same
+/// file with the same arguments, and the file only changed in that
+/// declaration.
+struct SwiftCompletionInstance {
+  std::unique_ptr<swift::CompilerInvocation> Invocation;
+  std::unique_ptr<swift::PrintingDiagnosticConsumer> PrintDiags;
+  std::unique_ptr<swift::CompilerInstance> CI;
+  std::vector<std::string> Args;
+  std::string FileName;
+  /// The text of the completion buffer, without the code completion point.
+  std::string Text;
+  /// The modification time and size of the other input files.
+  std::vector<std::pair<uint64_t, uint64_t>> InputStamps;
+  unsigned ReuseCount = 0;
+
+  SwiftCompletionInstance();
+  ~SwiftCompletionInstance();
+};
+
 struct SwiftPopularAPI : public ThreadSafeRefCountedBase<SwiftPopularAPI> {
   llvm::StringMap<CodeCompletion::PopularityFactor> nameToFactor;
 };
@@ -215,6 +245,8 @@ class SwiftLangSupport : public LangSupport {
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
   ThreadSafeRefCntPtr<SwiftCustomCompletions> CustomCompletions;
+  std::unique_ptr<SwiftCompletionInstance> CompletionInstance;
+  llvm::sys::Mutex CompletionInstanceMtx;
 
 public:
   explicit SwiftLangSupport(SourceKit::Context &SKCtx);
@@ -232,6 +264,17 @@ public:
     return CCCache;
   }
 
+  /// Take the compiler instance of the last code completion, if any, so that
+  /// concurrent completions don't use it at the same time.
+  std::unique_ptr<SwiftCompletionInstance> takeCompletionInstance() {
+    llvm::sys::ScopedLock L(CompletionInstanceMtx);
+    return std::move(CompletionInstance);
+  }
+  void setCompletionInstance(std::unique_ptr<SwiftCompletionInstance> Inst) {
+    llvm::sys::ScopedLock L(CompletionInstanceMtx);
+    CompletionInstance = std::move(Inst);
+  }
+
   static SourceKit::UIdent getUIDForDecl(const swift::Decl *D,
                                          bool IsRef = false);
   static SourceKit::UIdent getUIDForExtensionOfDecl(const swift::Decl *D);
@@ -941,10 +941,12 @@ static void resolveCursor(SwiftLangSupport &Lang,
         trace::initTraceFiles(SwiftArgs, CompIns);
         TracedOp.start(trace::OperationKind::CursorInfoForSource, SwiftArgs,
                        {std::make_pair("Offset", std::to_string(Offset))});
+        traceASTInfo(TracedOp);
       }
 
       SemaLocResolver Resolver(AstUnit->getPrimarySourceFile());
       SemaToken SemaTok = Resolver.resolve(Loc);
+      TracedOp.phase("resolve");
       if (SemaTok.isInvalid()) {
         Receiver({});
         return;
@@ -1106,6 +1108,7 @@ resolveCursorFromUSR(SwiftLangSupport &Lang, StringRef InputFile, StringRef USR,
         trace::initTraceFiles(SwiftArgs, CompIns);
         TracedOp.start(trace::OperationKind::CursorInfoForSource, SwiftArgs,
                        {std::make_pair("USR", USR)});
+        traceASTInfo(TracedOp);
       }
 
       if (USR.startswith("c:")) {
@@ -1117,6 +1120,7 @@ resolveCursorFromUSR(SwiftLangSupport &Lang, StringRef InputFile, StringRef USR,
       auto &context = CompIns.getASTContext();
       std::string error;
       Decl *D = ide::getDeclFromUSR(context, USR, error);
+      TracedOp.phase("resolve");
 
       if (!D) {
         Receiver({});
@@ -1296,6 +1300,7 @@ void SwiftLangSupport::findRelatedIdentifiersInFile(
           trace::initTraceFiles(SwiftArgs, CompInst);
           TracedOp.start(trace::OperationKind::RelatedIdents, SwiftArgs,
                         {std::make_pair("Offset", std::to_string(Offset))});
+          traceASTInfo(TracedOp);
         }
 
         unsigned BufferID = SrcFile.getBufferID().getValue();
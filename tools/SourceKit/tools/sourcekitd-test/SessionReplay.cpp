@@ -0,0 +1,235 @@
+//===--- SessionReplay.cpp - Record and replay request sessions -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SessionReplay.h"
+#include "TestOptions.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace sourcekitd_test;
+using namespace llvm;
+
+typedef std::chrono::steady_clock Clock;
+
+//===----------------------------------------------------------------------===//
+// Recording
+//===----------------------------------------------------------------------===//
+
+void sourcekitd_test::recordSessionRequest(StringRef Path,
+                                           sourcekitd_object_t Req) {
+  static Clock::time_point FirstRequest = Clock::now();
+  auto Offset = std::chrono::duration_cast<std::chrono::milliseconds>(
+      Clock::now() - FirstRequest).count();
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_Append | sys::fs::F_Text);
+  if (EC) {
+    errs() << "error opening '" << Path << "': " << EC.message() << '\n';
+    return;
+  }
+  char *Description = sourcekitd_request_description_copy(Req);
+  OS << "@ " << Offset << '\n' << Description << '\n';
+  free(Description);
+}
+
+//===----------------------------------------------------------------------===//
+// Replay
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct SessionEntry {
+  unsigned Offset;
+  std::string Kind;
+  std::string Text;
+  sourcekitd_object_t Request = nullptr;
+};
+
+struct LatencyStats {
+  std::vector<double> Milliseconds;
+  unsigned Errors = 0;
+  unsigned Cancelled = 0;
+};
+} // end anonymous namespace
+
+/// The value of key.request in the text of a request.
+static std::string getRequestKind(StringRef Text) {
+  size_t Pos = Text.find("key.request:");
+  if (Pos == StringRef::npos)
+    return "<unknown>";
+  StringRef Value = Text.substr(Pos + strlen("key.request:"));
+  Value = Value.substr(0, Value.find_first_of(",}\n")).trim();
+  return Value.str();
+}
+
+static bool parseSession(StringRef Buffer, std::vector<SessionEntry> &Entries) {
+  unsigned LineNo = 0;
+  while (!Buffer.empty()) {
+    StringRef Line;
+    std::tie(Line, Buffer) = Buffer.split('\n');
+    ++LineNo;
+
+    StringRef Trimmed = Line.trim();
+    if (Trimmed.startswith("@")) {
+      SessionEntry Entry;
+      if (Trimmed.drop_front().trim().getAsInteger(10, Entry.Offset)) {
+        errs() << "error: line " << LineNo << ": expected a time in ms\n";
+        return true;
+      }
+      Entries.push_back(std::move(Entry));
+      continue;
+    }
+    if (Entries.empty()) {
+      if (Trimmed.empty() || Trimmed.startswith("#"))
+        continue;
+      errs() << "error: line " << LineNo << ": expected '@ <ms>'\n";
+      return true;
+    }
+    Entries.back().Text += Line;
+    Entries.back().Text += '\n';
+  }
+
+  for (auto &Entry : Entries) {
+    Entry.Kind = getRequestKind(Entry.Text);
+    char *Err = nullptr;
+    Entry.Request = sourcekitd_request_create_from_yaml(Entry.Text.c_str(),
+                                                        &Err);
+    if (!Entry.Request) {
+      errs() << "error: invalid request at " << Entry.Offset << " ms: "
+             << (Err ? Err : "") << '\n';
+      free(Err);
+      return true;
+    }
+  }
+  return false;
+}
+
+/// The value below which \p Percent percent of the sorted \p Values are.
+static double percentile(ArrayRef<double> Values, unsigned Percent) {
+  size_t Rank = (Values.size() * Percent + 99) / 100;
+  return Values[std::max<size_t>(Rank, 1) - 1];
+}
+
+int sourcekitd_test::replaySession(const TestOptions &Opts) {
+  auto BufOrErr = MemoryBuffer::getFile(Opts.ReplayPath);
+  if (!BufOrErr) {
+    errs() << "error opening '" << Opts.ReplayPath << "': "
+           << BufOrErr.getError().message() << '\n';
+    return 1;
+  }
+  std::vector<SessionEntry> Entries;
+  if (parseSession((*BufOrErr)->getBuffer(), Entries))
+    return 1;
+
+  std::mutex Mtx;
+  std::condition_variable InFlightChanged;
+  unsigned InFlight = 0;
+  StringMap<LatencyStats> Stats;
+
+  auto recordResponse = [&](const SessionEntry &Entry, Clock::time_point Sent,
+                            sourcekitd_response_t Resp) {
+    double Elapsed = std::chrono::duration<double, std::milli>(
+        Clock::now() - Sent).count();
+    std::lock_guard<std::mutex> L(Mtx);
+    LatencyStats &S = Stats[Entry.Kind];
+    if (!sourcekitd_response_is_error(Resp))
+      S.Milliseconds.push_back(Elapsed);
+    else if (sourcekitd_response_error_get_kind(Resp) ==
+             SOURCEKITD_ERROR_REQUEST_CANCELLED)
+      ++S.Cancelled;
+    else
+      ++S.Errors;
+    sourcekitd_response_dispose(Resp);
+    --InFlight;
+    InFlightChanged.notify_all();
+  };
+
+  auto SessionStart = Clock::now();
+  for (unsigned Iteration = 0; Iteration != Opts.ReplayRepeat; ++Iteration) {
+    auto IterationStart = Clock::now();
+    for (auto &Entry : Entries) {
+      if (!Opts.ReplayNoDelay)
+        std::this_thread::sleep_until(
+            IterationStart + std::chrono::milliseconds(Entry.Offset));
+      {
+        std::unique_lock<std::mutex> L(Mtx);
+        InFlightChanged.wait(L, [&]{
+          return InFlight < Opts.ReplayConcurrency;
+        });
+        ++InFlight;
+      }
+
+      auto Sent = Clock::now();
+#if SOURCEKITD_HAS_BLOCKS
+      const SessionEntry *EntryPtr = &Entry;
+      sourcekitd_send_request(Entry.Request, nullptr,
+                              ^(sourcekitd_response_t Resp) {
+        recordResponse(*EntryPtr, Sent, Resp);
+      });
+#else
+      recordResponse(Entry, Sent, sourcekitd_send_request_sync(Entry.Request));
+#endif
+    }
+
+    // Let the session finish before starting over, since it may close the
+    // documents it opened.
+    std::unique_lock<std::mutex> L(Mtx);
+    InFlightChanged.wait(L, [&]{ return InFlight == 0; });
+  }
+  double Total = std::chrono::duration<double>(
+      Clock::now() - SessionStart).count();
+
+  for (auto &Entry : Entries)
+    sourcekitd_request_release(Entry.Request);
+
+  std::vector<StringRef> Kinds;
+  for (auto &S : Stats)
+    Kinds.push_back(S.getKey());
+  std::sort(Kinds.begin(), Kinds.end());
+
+  outs() << "Replayed " << Entries.size() * Opts.ReplayRepeat << " requests in "
+         << format("%.3f", Total) << " s (repeat " << Opts.ReplayRepeat
+         << ", concurrency " << Opts.ReplayConcurrency << ")\n";
+  outs() << format("%-44s %6s %6s %9s %9s %9s %9s %9s\n", "request", "count",
+                   "errors", "cancelled", "p50(ms)", "p90(ms)", "p99(ms)",
+                   "max(ms)");
+  bool HadErrors = false;
+  for (StringRef Kind : Kinds) {
+    LatencyStats &S = Stats[Kind];
+    HadErrors |= S.Errors != 0;
+    std::sort(S.Milliseconds.begin(), S.Milliseconds.end());
+    unsigned Count = S.Milliseconds.size() + S.Errors + S.Cancelled;
+    outs() << format("%-44s %6u %6u %9u ", Kind.str().c_str(), Count,
+                     S.Errors, S.Cancelled);
+    if (S.Milliseconds.empty()) {
+      outs() << format("%9s %9s %9s %9s\n", "-", "-", "-", "-");
+      continue;
+    }
+    outs() << format("%9.2f %9.2f %9.2f %9.2f\n",
+                     percentile(S.Milliseconds, 50),
+                     percentile(S.Milliseconds, 90),
+                     percentile(S.Milliseconds, 99),
+                     S.Milliseconds.back());
+  }
+  return HadErrors ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+//===--- SessionReplay.h - Record and replay request sessions ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A session file holds the requests of an editing session, each preceded by
+// a line with the time in milliseconds at which it was sent:
+//
+//   @ 0
+//   {
+//     key.request: source.request.editor.open,
+//     key.name: "/tmp/main.swift",
+//     key.sourcefile: "/tmp/main.swift"
+//   }
+//   @ 250
+//   {
+//     key.request: source.request.codecomplete,
+//     ...
+//   }
+//
+// The requests use the syntax of sourcekitd_request_create_from_yaml, which
+// is also what -json-request-path reads. Lines before the first request
+// which start with '#' are comments.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKITD_TEST_SESSIONREPLAY_H
+#define LLVM_SOURCEKITD_TEST_SESSIONREPLAY_H
+
+#include "sourcekitd/sourcekitd.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace sourcekitd_test {
+
+struct TestOptions;
+
+/// Append \p Req to the session file at \p Path, at the time since the
+/// first request this process recorded.
+void recordSessionRequest(llvm::StringRef Path, sourcekitd_object_t Req);
+
+/// Replay the session file Opts.ReplayPath and print the latency
+/// percentiles of each kind of request.
+///
+/// \returns non-zero if the session couldn't be read or a request failed.
+int replaySession(const TestOptions &Opts);
+
+}
+
+#endif
@@ -126,6 +126,7 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
         .Case("find-interface", SourceKitRequest::FindInterfaceDoc)
         .Case("open", SourceKitRequest::Open)
         .Case("edit", SourceKitRequest::Edit)
+        .Case("close", SourceKitRequest::Close)
         .Case("print-annotations", SourceKitRequest::PrintAnnotations)
         .Case("print-diags", SourceKitRequest::PrintDiags)
         .Case("extract-comment", SourceKitRequest::ExtractComment)
@@ -137,7 +138,7 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
                "complete.update/complete.cache.ondisk/complete.cache.setpopularapi/"
                "cursor/related-idents/syntax-map/structure/format/expand-placeholder/"
                "doc-info/sema/interface-gen/interface-gen-openfind-usr/find-interface/"
-               "open/edit/print-annotations/print-diags/extract-comment/module-groups\n";
+               "open/edit/close/print-annotations/print-diags/extract-comment/module-groups\n";
         return true;
       }
       break;
@@ -250,6 +251,34 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
       isAsyncRequest = true;
       break;
 
+    case OPT_record_session:
+      RecordSessionPath = InputArg->getValue();
+      break;
+
+    case OPT_replay:
+      ReplayPath = InputArg->getValue();
+      break;
+
+    case OPT_replay_concurrency:
+      if (StringRef(InputArg->getValue()).getAsInteger(10, ReplayConcurrency) ||
+          ReplayConcurrency == 0) {
+        llvm::errs() << "error: expected positive integer for "
+                        "'replay-concurrency'\n";
+        return true;
+      }
+      break;
+
+    case OPT_replay_repeat:
+      if (StringRef(InputArg->getValue()).getAsInteger(10, ReplayRepeat)) {
+        llvm::errs() << "error: expected integer for 'replay-repeat'\n";
+        return true;
+      }
+      break;
+
+    case OPT_replay_no_delay:
+      ReplayNoDelay = true;
+      break;
+
     case OPT_UNKNOWN:
       llvm::errs() << "error: unknown argument: "
                    << InputArg->getAsString(ParsedArgs) << '\n';
@@ -45,6 +45,7 @@ enum class SourceKitRequest {
   FindInterfaceDoc,
   Open,
   Edit,
+  Close,
   PrintAnnotations,
   PrintDiags,
   ExtractComment,
@@ -80,6 +81,11 @@ struct TestOptions {
   bool SimplifiedDemangling = false;
   bool SynthesizedExtensions = false;
   bool isAsyncRequest = false;
+  std::string RecordSessionPath;
+  std::string ReplayPath;
+  unsigned ReplayConcurrency = 1;
+  unsigned ReplayRepeat = 1;
+  bool ReplayNoDelay = false;
   bool parseArgs(llvm::ArrayRef<const char *> Args);
 };
 
@@ -12,6 +12,7 @@
 
 #include "sourcekitd/sourcekitd.h"
 
+#include "SessionReplay.h"
 #include "TestOptions.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "clang/Rewrite/Core/RewriteBuffer.h"
@@ -146,6 +147,7 @@ static sourcekitd_uid_t RequestEditorOpenSwiftTypeInterface;
 static sourcekitd_uid_t RequestEditorOpenHeaderInterface;
 static sourcekitd_uid_t RequestEditorExtractTextFromComment;
 static sourcekitd_uid_t RequestEditorReplaceText;
+static sourcekitd_uid_t RequestEditorClose;
 static sourcekitd_uid_t RequestEditorFormatText;
 static sourcekitd_uid_t RequestEditorExpandPlaceholder;
 static sourcekitd_uid_t RequestEditorFindUSR;
@@ -263,6 +265,7 @@ static int skt_main(int argc, const char **argv) {
   RequestEditorOpenHeaderInterface = sourcekitd_uid_get_from_cstr("source.request.editor.open.interface.header");
   RequestEditorExtractTextFromComment = sourcekitd_uid_get_from_cstr("source.request.editor.extract.comment");
   RequestEditorReplaceText = sourcekitd_uid_get_from_cstr("source.request.editor.replacetext");
+  RequestEditorClose = sourcekitd_uid_get_from_cstr("source.request.editor.close");
   RequestEditorFormatText = sourcekitd_uid_get_from_cstr("source.request.editor.formattext");
   RequestEditorExpandPlaceholder = sourcekitd_uid_get_from_cstr("source.request.editor.expand_placeholder");
   RequestEditorFindUSR = sourcekitd_uid_get_from_cstr("source.request.editor.find_usr");
@@ -364,7 +367,8 @@ static bool readPopularAPIList(StringRef filename,
   return false;
 }
 
-static int handleJsonRequestPath(StringRef QueryPath) {
+static int handleJsonRequestPath(StringRef QueryPath,
+                                 const TestOptions &Opts) {
   auto Buffer = getBufferForFilename(QueryPath)->getBuffer();
   char *Err = nullptr;
   auto Req = sourcekitd_request_create_from_yaml(Buffer.data(), &Err);
@@ -375,6 +379,8 @@ static int handleJsonRequestPath(StringRef QueryPath) {
     return 1;
   }
   sourcekitd_request_description_dump(Req);
+  if (!Opts.RecordSessionPath.empty())
+    recordSessionRequest(Opts.RecordSessionPath, Req);
   sourcekitd_response_t Resp = sourcekitd_send_request_sync(Req);
   auto Error = sourcekitd_response_is_error(Resp);
   sourcekitd_response_description_dump_filedesc(Resp, STDOUT_FILENO);
@@ -396,7 +402,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     return 1;
 
   if (!Opts.JsonRequestPath.empty())
-    return handleJsonRequestPath(Opts.JsonRequestPath);
+    return handleJsonRequestPath(Opts.JsonRequestPath, Opts);
+
+  if (!Opts.ReplayPath.empty())
+    return replaySession(Opts);
 
   if (Optargc < Args.size())
     Opts.CompilerArgs = Args.slice(Optargc+1);
@@ -600,6 +609,11 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
                                        Opts.ReplaceText.getValue().c_str());
     break;
 
+  case SourceKitRequest::Close:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestEditorClose);
+    sourcekitd_request_dictionary_set_string(Req, KeyName, SourceFile.c_str());
+    break;
+
   case SourceKitRequest::PrintAnnotations:
     return printAnnotations();
   case SourceKitRequest::PrintDiags:
@@ -709,6 +723,9 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
   if (Opts.PrintRequest)
     sourcekitd_request_description_dump(Req);
 
+  if (!Opts.RecordSessionPath.empty())
+    recordSessionRequest(Opts.RecordSessionPath, Req);
+
   if (!Opts.isAsyncRequest) {
     sourcekitd_response_t Resp = sourcekitd_send_request_sync(Req);
     sourcekitd_request_release(Req);
@@ -774,6 +791,9 @@ static bool handleResponse(sourcekitd_response_t Resp, const TestOptions &Opts,
       KeepResponseAlive = true;
       break;
 
+    case SourceKitRequest::Close:
+      break;
+
     case SourceKitRequest::DemangleNames:
       printDemangleResults(sourcekitd_response_get_value(Resp), outs());
       break;
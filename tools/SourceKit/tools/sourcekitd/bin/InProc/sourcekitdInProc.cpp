@@ -15,6 +15,7 @@
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/UIdent.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 
@@ -115,15 +116,46 @@ sourcekitd_response_t sourcekitd_send_request_sync(sourcekitd_object_t req) {
   return ReturnedResp;
 }
 
+// The handle of an asynchronous request is its ID in PendingRequests, so a
+// handle stays valid, without effect, after its response was delivered.
+static llvm::sys::Mutex PendingRequestsMtx;
+static llvm::DenseMap<uintptr_t, sourcekitd_response_receiver_t>
+    PendingRequests;
+static uintptr_t NextRequestID = 1;
+
+/// Removes the request from PendingRequests and returns its receiver, or null
+/// if it was already answered.
+static sourcekitd_response_receiver_t takePendingRequest(uintptr_t ID) {
+  llvm::sys::ScopedLock L(PendingRequestsMtx);
+  auto Found = PendingRequests.find(ID);
+  if (Found == PendingRequests.end())
+    return nullptr;
+  sourcekitd_response_receiver_t Receiver = Found->second;
+  PendingRequests.erase(Found);
+  return Receiver;
+}
+
 void sourcekitd_send_request(sourcekitd_object_t req,
                              sourcekitd_request_handle_t *out_handle,
                              sourcekitd_response_receiver_t receiver) {
-  // FIXME: Implement request handle.
+  uintptr_t ID;
+  {
+    llvm::sys::ScopedLock L(PendingRequestsMtx);
+    ID = NextRequestID++;
+    PendingRequests[ID] = Block_copy(receiver);
+  }
+  if (out_handle)
+    *out_handle = reinterpret_cast<sourcekitd_request_handle_t>(ID);
 
   sourcekitd_request_retain(req);
-  receiver = Block_copy(receiver);
   WorkQueue::dispatchConcurrent([=]{
     sourcekitd::handleRequest(req, [=](sourcekitd_response_t resp) {
+      auto receiver = takePendingRequest(ID);
+      if (!receiver) {
+        // The request was cancelled and the receiver got the error already.
+        sourcekitd_response_dispose(resp);
+        return;
+      }
       // The receiver accepts ownership of the response.
       receiver(resp);
       Block_release(receiver);
@@ -133,7 +165,13 @@ void sourcekitd_send_request(sourcekitd_object_t req,
 }
 
 void sourcekitd_cancel_request(sourcekitd_request_handle_t handle) {
-  // FIXME: Implement cancelling.
+  // FIXME: The request keeps running until it completes; only its response
+  // is dropped. Stale AST builds are cancelled by SwiftASTManager instead.
+  auto receiver = takePendingRequest(reinterpret_cast<uintptr_t>(handle));
+  if (!receiver)
+    return;
+  receiver(sourcekitd::createErrorRequestCancelled());
+  Block_release(receiver);
 }
 
 void
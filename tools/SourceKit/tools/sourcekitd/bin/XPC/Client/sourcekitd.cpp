@@ -15,6 +15,7 @@
 #include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/TimeValue.h"
@@ -156,11 +157,28 @@ sourcekitd_response_t sourcekitd_send_request_sync(sourcekitd_object_t req) {
   return resp;
 }
 
+// The handle of an asynchronous request is its ID in PendingRequests, so a
+// handle stays valid, without effect, after its response was delivered.
+static llvm::sys::Mutex PendingRequestsMtx;
+static llvm::DenseMap<uintptr_t, sourcekitd_response_receiver_t>
+    PendingRequests;
+static uintptr_t NextRequestID = 1;
+
+/// Removes the request from PendingRequests and returns its receiver, or null
+/// if it was already answered.
+static sourcekitd_response_receiver_t takePendingRequest(uintptr_t ID) {
+  llvm::sys::ScopedLock L(PendingRequestsMtx);
+  auto Found = PendingRequests.find(ID);
+  if (Found == PendingRequests.end())
+    return nullptr;
+  sourcekitd_response_receiver_t Receiver = Found->second;
+  PendingRequests.erase(Found);
+  return Receiver;
+}
+
 void sourcekitd_send_request(sourcekitd_object_t req,
                              sourcekitd_request_handle_t *out_handle,
                              sourcekitd_response_receiver_t receiver) {
-  // FIXME: Implement request handle.
-
   LOG_SECTION("sourcekitd_send_request-before", InfoHighPrio) {
     // Requests will be printed in Requests.cpp, print them out here as well.
     sourcekitd::printRequestObject(req, Log->getOS());
@@ -172,6 +190,15 @@ void sourcekitd_send_request(sourcekitd_object_t req,
     return;
   }
 
+  uintptr_t ID;
+  {
+    llvm::sys::ScopedLock L(PendingRequestsMtx);
+    ID = NextRequestID++;
+    PendingRequests[ID] = Block_copy(receiver);
+  }
+  if (out_handle)
+    *out_handle = reinterpret_cast<sourcekitd_request_handle_t>(ID);
+
   xpc_connection_t Conn = getGlobalConnection();
   xpc_object_t contents = xpc_array_create(nullptr, 0);
   xpc_array_append_value(contents, req);
@@ -184,6 +211,12 @@ void sourcekitd_send_request(sourcekitd_object_t req,
     = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
   xpc_connection_send_message_with_reply(Conn, msg, queue,
                                          ^(xpc_object_t reply) {
+    auto receiver = takePendingRequest(ID);
+    if (!receiver) {
+      // The request was cancelled and the receiver got the error already.
+      return;
+    }
+
     sourcekitd_response_t Resp = nullptr;
     if (xpc_get_type(reply) == XPC_TYPE_ERROR) {
       Resp = reply;
@@ -202,12 +235,19 @@ void sourcekitd_send_request(sourcekitd_object_t req,
     }
 
     receiver(Resp);
+    Block_release(receiver);
   });
   xpc_release(msg);
 }
 
 void sourcekitd_cancel_request(sourcekitd_request_handle_t handle) {
-  // FIXME: Implement cancelling.
+  // FIXME: Tell the service to stop working on the request; only its response
+  // is dropped. Stale AST builds are cancelled by the service on its own.
+  auto receiver = takePendingRequest(reinterpret_cast<uintptr_t>(handle));
+  if (!receiver)
+    return;
+  receiver(sourcekitd::createErrorRequestCancelled());
+  Block_release(receiver);
 }
 
 /// To avoid repeated crashes, used to notify the service to delay typechecking
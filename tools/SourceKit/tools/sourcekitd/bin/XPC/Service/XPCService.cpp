@@ -26,6 +26,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Threading.h"
 
+#include <atomic>
 #include <xpc/xpc.h>
 
 using namespace SourceKit;
@@ -259,6 +260,10 @@ static void sourcekitdServer_peer_event_handler(xpc_connection_t peer,
   }
 }
 
+/// Whether the client asked for the trace messages of the XPC tracer. Tracing
+/// can also be enabled for the tracing notifications alone.
+static std::atomic<bool> ClientTracingEnabled(false);
+
 static void getInitializationInfo(xpc_connection_t peer) {
   xpc_object_t contents = xpc_array_create(nullptr, 0);
   xpc_array_set_uint64(contents, XPC_ARRAY_APPEND,
@@ -291,6 +296,7 @@ static void getInitializationInfo(xpc_connection_t peer) {
   }
 
   if (TracingEnabled) {
+    ClientTracingEnabled = true;
     SourceKit::trace::enable();
   }
 }
@@ -370,7 +376,7 @@ void SKUIDToUIDMap::set(sourcekitd_uid_t SKDUID, UIdent UID) {
 }
 
 void sourcekitd::trace::sendTraceMessage(trace::sourcekitd_trace_message_t Msg) {
-  if (!SourceKit::trace::enabled()) {
+  if (!SourceKit::trace::enabled() || !ClientTracingEnabled) {
     xpc_release(Msg);
     return;
   }
@@ -32,6 +32,7 @@ protected:
   void addImpl(llvm::StringRef Val);
   void addImpl(SourceKit::UIdent Val);
   void addImpl(Optional<llvm::StringRef> Val);
+  void addImpl(Optional<SourceKit::UIdent> Val);
 
 private:
   unsigned getOffsetForString(llvm::StringRef Str);
@@ -120,6 +120,11 @@ extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyTypeUsr;
 extern SourceKit::UIdent KeyContainerTypeUsr;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyEnabled;
+extern SourceKit::UIdent KeyDuration;
+extern SourceKit::UIdent KeyPhases;
+extern SourceKit::UIdent KeyMetrics;
+extern SourceKit::UIdent KeyValue;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
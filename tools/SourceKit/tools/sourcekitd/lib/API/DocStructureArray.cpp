@@ -0,0 +1,554 @@
+//===--- DocStructureArray.cpp --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The buffer starts with the offsets of four compact arrays: the nodes, the
+// elements, the inherited types and the attributes. Node 0 stands for the
+// response dictionary which holds the top-level substructures. The nodes are
+// laid out breadth-first, so the substructures of a node, like its elements,
+// inherited types and attributes, are a range of one of the arrays, and a
+// nested array is identified by the index of the node which owns it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/DocStructureArray.h"
+#include "sourcekitd/CompactArray.h"
+#include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/UIdent.h"
+#include "DictionaryKeys.h"
+
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace SourceKit;
+using namespace sourcekitd;
+
+namespace {
+enum DocStructureTable {
+  NodeTable,
+  ElementTable,
+  InheritedTypeTable,
+  AttributeTable,
+  NumTables
+};
+
+struct StructureElement {
+  UIdent Kind;
+  unsigned Offset;
+  unsigned Length;
+};
+
+struct StructureNode {
+  unsigned Offset = 0;
+  unsigned Length = 0;
+  UIdent Kind;
+  UIdent AccessLevel;
+  UIdent SetterAccessLevel;
+  unsigned NameOffset = 0;
+  unsigned NameLength = 0;
+  unsigned BodyOffset = 0;
+  unsigned BodyLength = 0;
+  std::string DisplayName;
+  std::string TypeName;
+  std::string RuntimeName;
+  std::string SelectorName;
+  unsigned FirstInheritedType = 0;
+  unsigned NumInheritedTypes = 0;
+  unsigned FirstAttribute = 0;
+  unsigned NumAttributes = 0;
+  std::vector<StructureElement> Elements;
+  std::vector<unsigned> SubStructures;
+};
+} // end anonymous namespace
+
+static Optional<UIdent> getOptionalUID(UIdent UID) {
+  if (UID.isValid())
+    return UID;
+  return None;
+}
+
+static Optional<StringRef> getOptionalString(StringRef Str) {
+  if (!Str.empty())
+    return Str;
+  return None;
+}
+
+struct DocStructureArrayBuilder::Implementation {
+  typedef CompactArrayBuilder<unsigned,          // Offset
+                              unsigned,          // Length
+                              Optional<UIdent>,  // Kind
+                              Optional<UIdent>,  // AccessLevel
+                              Optional<UIdent>,  // SetterAccessLevel
+                              unsigned,          // NameOffset
+                              unsigned,          // NameLength
+                              unsigned,          // BodyOffset
+                              unsigned,          // BodyLength
+                              Optional<StringRef>, // DisplayName
+                              Optional<StringRef>, // TypeName
+                              Optional<StringRef>, // RuntimeName
+                              Optional<StringRef>, // SelectorName
+                              unsigned,          // FirstInheritedType
+                              unsigned,          // NumInheritedTypes
+                              unsigned,          // FirstAttribute
+                              unsigned,          // NumAttributes
+                              unsigned,          // FirstElement
+                              unsigned,          // NumElements
+                              unsigned,          // FirstSubStructure
+                              unsigned           // NumSubStructures
+                              > NodeArrayBuilder;
+
+  std::vector<StructureNode> Nodes;
+  /// The indices of the nodes which are not finished yet, starting with the
+  /// root.
+  SmallVector<unsigned, 16> OpenNodes;
+
+  CompactArrayBuilder<StringRef> InheritedTypes;
+  unsigned NumInheritedTypes = 0;
+  CompactArrayBuilder<UIdent> Attributes;
+  unsigned NumAttributes = 0;
+
+  Implementation() {
+    Nodes.emplace_back();
+    OpenNodes.push_back(0);
+  }
+};
+
+DocStructureArrayBuilder::DocStructureArrayBuilder()
+  : Impl(*new Implementation()) {
+
+}
+
+DocStructureArrayBuilder::~DocStructureArrayBuilder() {
+  delete &Impl;
+}
+
+void DocStructureArrayBuilder::beginSubStructure(unsigned Offset,
+                                                 unsigned Length,
+                                                 UIdent Kind,
+                                                 UIdent AccessLevel,
+                                                 UIdent SetterAccessLevel,
+                                                 unsigned NameOffset,
+                                                 unsigned NameLength,
+                                                 unsigned BodyOffset,
+                                                 unsigned BodyLength,
+                                                 StringRef DisplayName,
+                                                 StringRef TypeName,
+                                                 StringRef RuntimeName,
+                                                 StringRef SelectorName,
+                                             ArrayRef<StringRef> InheritedTypes,
+                                                 ArrayRef<UIdent> Attrs) {
+  unsigned Index = Impl.Nodes.size();
+  Impl.Nodes[Impl.OpenNodes.back()].SubStructures.push_back(Index);
+  Impl.OpenNodes.push_back(Index);
+  Impl.Nodes.emplace_back();
+
+  StructureNode &Node = Impl.Nodes.back();
+  Node.Offset = Offset;
+  Node.Length = Length;
+  Node.Kind = Kind;
+  Node.AccessLevel = AccessLevel;
+  Node.SetterAccessLevel = SetterAccessLevel;
+  Node.NameOffset = NameOffset;
+  Node.NameLength = NameLength;
+  Node.BodyOffset = BodyOffset;
+  Node.BodyLength = BodyLength;
+  Node.DisplayName = DisplayName;
+  Node.TypeName = TypeName;
+  Node.RuntimeName = RuntimeName;
+  Node.SelectorName = SelectorName;
+
+  // The inherited types and attributes are known up front, so they can go
+  // into their arrays right away.
+  Node.FirstInheritedType = Impl.NumInheritedTypes;
+  Node.NumInheritedTypes = InheritedTypes.size();
+  for (StringRef Name : InheritedTypes)
+    Impl.InheritedTypes.addEntry(Name);
+  Impl.NumInheritedTypes += InheritedTypes.size();
+
+  Node.FirstAttribute = Impl.NumAttributes;
+  Node.NumAttributes = Attrs.size();
+  for (UIdent Attr : Attrs)
+    Impl.Attributes.addEntry(Attr);
+  Impl.NumAttributes += Attrs.size();
+}
+
+void DocStructureArrayBuilder::addElement(UIdent Kind, unsigned Offset,
+                                          unsigned Length) {
+  assert(isInSubStructure() && "elements of the root aren't supported");
+  Impl.Nodes[Impl.OpenNodes.back()].Elements.push_back({Kind, Offset, Length});
+}
+
+void DocStructureArrayBuilder::endSubStructure() {
+  assert(isInSubStructure() && "no substructure to end");
+  Impl.OpenNodes.pop_back();
+}
+
+bool DocStructureArrayBuilder::isInSubStructure() const {
+  return Impl.OpenNodes.size() > 1;
+}
+
+bool DocStructureArrayBuilder::empty() const {
+  return Impl.Nodes.front().SubStructures.empty();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DocStructureArrayBuilder::createBuffer() {
+  auto &Nodes = Impl.Nodes;
+
+  // Lay out the nodes breadth-first, so that the substructures of each node
+  // come one after another.
+  std::vector<unsigned> Order;
+  std::vector<unsigned> FirstSubStructure;
+  Order.reserve(Nodes.size());
+  FirstSubStructure.reserve(Nodes.size());
+  Order.push_back(0);
+  for (size_t I = 0; I != Order.size(); ++I) {
+    FirstSubStructure.push_back(Order.size());
+    auto &SubStructures = Nodes[Order[I]].SubStructures;
+    Order.insert(Order.end(), SubStructures.begin(), SubStructures.end());
+  }
+
+  Implementation::NodeArrayBuilder NodeArray;
+  CompactArrayBuilder<UIdent, unsigned, unsigned> ElementArray;
+  unsigned NumElements = 0;
+  for (size_t I = 0, E = Order.size(); I != E; ++I) {
+    const StructureNode &Node = Nodes[Order[I]];
+    for (auto &Element : Node.Elements)
+      ElementArray.addEntry(Element.Kind, Element.Offset, Element.Length);
+
+    NodeArray.addEntry(Node.Offset,
+                       Node.Length,
+                       getOptionalUID(Node.Kind),
+                       getOptionalUID(Node.AccessLevel),
+                       getOptionalUID(Node.SetterAccessLevel),
+                       Node.NameOffset,
+                       Node.NameLength,
+                       Node.BodyOffset,
+                       Node.BodyLength,
+                       getOptionalString(Node.DisplayName),
+                       getOptionalString(Node.TypeName),
+                       getOptionalString(Node.RuntimeName),
+                       getOptionalString(Node.SelectorName),
+                       Node.FirstInheritedType,
+                       Node.NumInheritedTypes,
+                       Node.FirstAttribute,
+                       Node.NumAttributes,
+                       NumElements,
+                       unsigned(Node.Elements.size()),
+                       FirstSubStructure[I],
+                       unsigned(Node.SubStructures.size()));
+    NumElements += Node.Elements.size();
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> Tables[NumTables] = {
+    NodeArray.createBuffer(),
+    ElementArray.createBuffer(),
+    Impl.InheritedTypes.createBuffer(),
+    Impl.Attributes.createBuffer(),
+  };
+
+  // Keep each array 8-byte aligned, for the size at its start.
+  uint64_t TableOffsets[NumTables];
+  size_t BufSize = sizeof(TableOffsets);
+  for (unsigned I = 0; I != NumTables; ++I) {
+    TableOffsets[I] = BufSize;
+    BufSize += llvm::alignTo(Tables[I]->getBufferSize(), sizeof(uint64_t));
+  }
+
+  auto Buf = llvm::MemoryBuffer::getNewMemBuffer(BufSize);
+  char *BufPtr = (char*)Buf->getBufferStart();
+  memcpy(BufPtr, TableOffsets, sizeof(TableOffsets));
+  for (unsigned I = 0; I != NumTables; ++I)
+    memcpy(BufPtr + TableOffsets[I], Tables[I]->getBufferStart(),
+           Tables[I]->getBufferSize());
+  return Buf;
+}
+
+namespace {
+
+static void *getTable(void *Buf, DocStructureTable Table) {
+  return (char*)Buf + ((uint64_t*)Buf)[Table];
+}
+
+struct NodeEntry {
+  unsigned Offset;
+  unsigned Length;
+  sourcekitd_uid_t Kind;
+  sourcekitd_uid_t AccessLevel;
+  sourcekitd_uid_t SetterAccessLevel;
+  unsigned NameOffset;
+  unsigned NameLength;
+  unsigned BodyOffset;
+  unsigned BodyLength;
+  const char *DisplayName;
+  const char *TypeName;
+  const char *RuntimeName;
+  const char *SelectorName;
+  unsigned FirstInheritedType;
+  unsigned NumInheritedTypes;
+  unsigned FirstAttribute;
+  unsigned NumAttributes;
+  unsigned FirstElement;
+  unsigned NumElements;
+  unsigned FirstSubStructure;
+  unsigned NumSubStructures;
+
+  NodeEntry(void *Buf, size_t Index) {
+    CompactArrayReader<unsigned, unsigned,
+                       sourcekitd_uid_t, sourcekitd_uid_t, sourcekitd_uid_t,
+                       unsigned, unsigned, unsigned, unsigned,
+                       const char *, const char *, const char *, const char *,
+                       unsigned, unsigned, unsigned, unsigned,
+                       unsigned, unsigned, unsigned, unsigned>
+        Reader(getTable(Buf, NodeTable));
+    Reader.readEntries(Index,
+                       Offset, Length,
+                       Kind, AccessLevel, SetterAccessLevel,
+                       NameOffset, NameLength, BodyOffset, BodyLength,
+                       DisplayName, TypeName, RuntimeName, SelectorName,
+                       FirstInheritedType, NumInheritedTypes,
+                       FirstAttribute, NumAttributes,
+                       FirstElement, NumElements,
+                       FirstSubStructure, NumSubStructures);
+  }
+};
+
+/// The variant functions of a dictionary which is entry \c data[2] of one
+/// of the arrays; \p T provides dictionary_apply for it.
+template <typename T>
+struct DocStructureDictFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_DICTIONARY;
+  }
+
+  static bool dictionary_apply(sourcekitd_variant_t dict,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    return T::dictionary_apply((void*)dict.data[1], dict.data[2], applier);
+  }
+
+  static VariantFunctions Funcs;
+};
+
+template <typename T>
+VariantFunctions DocStructureDictFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*Struct_array_apply*/,
+  nullptr/*Struct_array_get_bool*/,
+  nullptr/*Struct_array_get_count*/,
+  nullptr/*Struct_array_get_int64*/,
+  nullptr/*Struct_array_get_string*/,
+  nullptr/*Struct_array_get_uid*/,
+  nullptr/*Struct_array_get_value*/,
+  nullptr/*Struct_bool_get_value*/,
+  dictionary_apply,
+  nullptr/*Struct_dictionary_get_bool*/,
+  nullptr/*Struct_dictionary_get_int64*/,
+  nullptr/*Struct_dictionary_get_string*/,
+  nullptr/*Struct_dictionary_get_value*/,
+  nullptr/*Struct_dictionary_get_uid*/,
+  nullptr/*Struct_string_get_length*/,
+  nullptr/*Struct_string_get_ptr*/,
+  nullptr/*Struct_int64_get_value*/,
+  nullptr/*Struct_uid_get_value*/
+};
+
+/// The variant functions of an array which belongs to node \c data[2];
+/// \p T provides the range of the array's entries with getRange, and the
+/// type of the entries as T::Entry.
+template <typename T>
+struct DocStructureArrayFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    unsigned First, Count;
+    T::getRange(NodeEntry((void*)array.data[1], array.data[2]), First, Count);
+    return Count;
+  }
+
+  static sourcekitd_variant_t
+  array_get_value(sourcekitd_variant_t array, size_t index) {
+    unsigned First, Count;
+    T::getRange(NodeEntry((void*)array.data[1], array.data[2]), First, Count);
+    assert(index < Count);
+    return {{ (uintptr_t)&DocStructureDictFuncs<typename T::Entry>::Funcs,
+              array.data[1], First + index }};
+  }
+
+  static VariantFunctions Funcs;
+};
+
+template <typename T>
+VariantFunctions DocStructureArrayFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*StructArray_array_apply*/,
+  nullptr/*StructArray_array_get_bool*/,
+  array_get_count,
+  nullptr/*StructArray_array_get_int64*/,
+  nullptr/*StructArray_array_get_string*/,
+  nullptr/*StructArray_array_get_uid*/,
+  array_get_value,
+  nullptr/*StructArray_bool_get_value*/,
+  nullptr/*StructArray_dictionary_apply*/,
+  nullptr/*StructArray_dictionary_get_bool*/,
+  nullptr/*StructArray_dictionary_get_int64*/,
+  nullptr/*StructArray_dictionary_get_string*/,
+  nullptr/*StructArray_dictionary_get_value*/,
+  nullptr/*StructArray_dictionary_get_uid*/,
+  nullptr/*StructArray_string_get_length*/,
+  nullptr/*StructArray_string_get_ptr*/,
+  nullptr/*StructArray_int64_get_value*/,
+  nullptr/*StructArray_uid_get_value*/
+};
+
+#define APPLY(K, Ty, Field)                              \
+  do {                                                   \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);          \
+    sourcekitd_variant_t var = make##Ty##Variant(Field); \
+    if (!applier(key, var)) return false;                \
+  } while (0)
+
+#define APPLY_ARRAY(K, Array, Index)                                   \
+  do {                                                                 \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);                        \
+    sourcekitd_variant_t var = {{                                      \
+        (uintptr_t)&DocStructureArrayFuncs<Array>::Funcs,              \
+        (uintptr_t)Buf, Index }};                                      \
+    if (!applier(key, var)) return false;                              \
+  } while (0)
+
+struct ElementEntry {
+  static bool dictionary_apply(void *Buf, size_t Index,
+                               sourcekitd_variant_dictionary_applier_t applier) {
+    sourcekitd_uid_t Kind;
+    unsigned Offset;
+    unsigned Length;
+    CompactArrayReader<sourcekitd_uid_t, unsigned, unsigned>
+        Reader(getTable(Buf, ElementTable));
+    Reader.readEntries(Index, Kind, Offset, Length);
+
+    APPLY(KeyKind, UID, Kind);
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    return true;
+  }
+};
+
+struct InheritedTypeEntry {
+  static bool dictionary_apply(void *Buf, size_t Index,
+                               sourcekitd_variant_dictionary_applier_t applier) {
+    const char *Name;
+    CompactArrayReader<const char *> Reader(getTable(Buf, InheritedTypeTable));
+    Reader.readEntries(Index, Name);
+
+    APPLY(KeyName, String, Name);
+    return true;
+  }
+};
+
+struct AttributeEntry {
+  static bool dictionary_apply(void *Buf, size_t Index,
+                               sourcekitd_variant_dictionary_applier_t applier) {
+    sourcekitd_uid_t Attr;
+    CompactArrayReader<sourcekitd_uid_t> Reader(getTable(Buf, AttributeTable));
+    Reader.readEntries(Index, Attr);
+
+    APPLY(KeyAttribute, UID, Attr);
+    return true;
+  }
+};
+
+struct ElementArray {
+  typedef ElementEntry Entry;
+  static void getRange(const NodeEntry &Node, unsigned &First,
+                       unsigned &Count) {
+    First = Node.FirstElement;
+    Count = Node.NumElements;
+  }
+};
+
+struct InheritedTypeArray {
+  typedef InheritedTypeEntry Entry;
+  static void getRange(const NodeEntry &Node, unsigned &First,
+                       unsigned &Count) {
+    First = Node.FirstInheritedType;
+    Count = Node.NumInheritedTypes;
+  }
+};
+
+struct AttributeArray {
+  typedef AttributeEntry Entry;
+  static void getRange(const NodeEntry &Node, unsigned &First,
+                       unsigned &Count) {
+    First = Node.FirstAttribute;
+    Count = Node.NumAttributes;
+  }
+};
+
+struct SubStructureEntry {
+  static bool dictionary_apply(void *Buf, size_t Index,
+                               sourcekitd_variant_dictionary_applier_t applier);
+};
+
+struct SubStructureArray {
+  typedef SubStructureEntry Entry;
+  static void getRange(const NodeEntry &Node, unsigned &First,
+                       unsigned &Count) {
+    First = Node.FirstSubStructure;
+    Count = Node.NumSubStructures;
+  }
+};
+
+bool SubStructureEntry::dictionary_apply(void *Buf, size_t Index,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+  NodeEntry Node(Buf, Index);
+
+  APPLY(KeyOffset, Int, Node.Offset);
+  APPLY(KeyLength, Int, Node.Length);
+  APPLY(KeyKind, UID, Node.Kind);
+  if (Node.AccessLevel)
+    APPLY(KeyAccessibility, UID, Node.AccessLevel);
+  if (Node.SetterAccessLevel)
+    APPLY(KeySetterAccessibility, UID, Node.SetterAccessLevel);
+  APPLY(KeyNameOffset, Int, Node.NameOffset);
+  APPLY(KeyNameLength, Int, Node.NameLength);
+  if (Node.BodyOffset != 0 || Node.BodyLength != 0) {
+    APPLY(KeyBodyOffset, Int, Node.BodyOffset);
+    APPLY(KeyBodyLength, Int, Node.BodyLength);
+  }
+  if (Node.DisplayName)
+    APPLY(KeyName, String, Node.DisplayName);
+  if (Node.TypeName)
+    APPLY(KeyTypeName, String, Node.TypeName);
+  if (Node.RuntimeName)
+    APPLY(KeyRuntimeName, String, Node.RuntimeName);
+  if (Node.SelectorName)
+    APPLY(KeySelectorName, String, Node.SelectorName);
+  if (Node.NumInheritedTypes)
+    APPLY_ARRAY(KeyInheritedTypes, InheritedTypeArray, Index);
+  if (Node.NumAttributes)
+    APPLY_ARRAY(KeyAttributes, AttributeArray, Index);
+  if (Node.NumElements)
+    APPLY_ARRAY(KeyElements, ElementArray, Index);
+  if (Node.NumSubStructures)
+    APPLY_ARRAY(KeySubStructure, SubStructureArray, Index);
+  return true;
+}
+
+#undef APPLY
+#undef APPLY_ARRAY
+
+} // end anonymous namespace
+
+VariantFunctions *sourcekitd::getVariantFunctionsForDocStructureArray() {
+  // The custom buffer's variant has index 0, the root node.
+  return &DocStructureArrayFuncs<SubStructureArray>::Funcs;
+}
@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 
@@ -20,6 +21,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 #include "SourceKit/SwiftLang/Factory.h"
 
@@ -32,7 +34,11 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 
 // FIXME: Portability.
 #include <dispatch/dispatch.h>
@@ -104,6 +110,8 @@ static LazySKDUID RequestBuildSettingsRegister(
     "source.request.buildsettings.register");
 static LazySKDUID RequestModuleGroups(
     "source.request.module.groups");
+static LazySKDUID RequestTracingNotifications(
+    "source.request.tracing.notifications");
 
 static LazySKDUID KindExpr("source.lang.swift.expr");
 static LazySKDUID KindStmt("source.lang.swift.stmt");
@@ -132,6 +140,137 @@ static void onDocumentUpdateNotification(StringRef DocumentName) {
   sourcekitd::postNotification(RespBuilder.createResponse());
 }
 
+//===----------------------------------------------------------------------===//
+// Tracing notifications
+//===----------------------------------------------------------------------===//
+
+typedef std::vector<std::pair<std::string, uint64_t>> TraceValues;
+
+static void addTraceValues(ResponseBuilder::Dictionary Dict, UIdent Key,
+                           const TraceValues &Values) {
+  auto Arr = Dict.setArray(Key);
+  for (auto &Value : Values) {
+    auto Elem = Arr.appendDictionary();
+    Elem.set(KeyName, Value.first);
+    Elem.set(KeyValue, int64_t(Value.second));
+  }
+}
+
+namespace {
+/// Posts a "source.notification.trace.operation" notification with the
+/// duration, phases and metrics of each traced operation when it finishes,
+/// once a client enabled them with source.request.tracing.notifications.
+class TraceNotificationConsumer : public trace::TraceConsumer {
+  struct Operation {
+    trace::OperationKind Kind;
+    std::string PrimaryFile;
+    std::chrono::steady_clock::time_point Start;
+    TraceValues Phases;
+    TraceValues Metrics;
+  };
+  std::mutex Mtx;
+  std::unordered_map<uint64_t, Operation> Operations;
+
+public:
+  std::atomic<bool> Enabled{false};
+
+  void operationStarted(uint64_t OpId, trace::OperationKind OpKind,
+                        const trace::SwiftInvocation &Inv,
+                        const trace::StringPairs &OpArgs) override {
+    if (!Enabled)
+      return;
+    std::lock_guard<std::mutex> L(Mtx);
+    Operations[OpId] = { OpKind, Inv.Args.PrimaryFile,
+                         std::chrono::steady_clock::now(), {}, {} };
+  }
+
+  void operationPhase(uint64_t OpId, StringRef Phase,
+                      uint64_t Nanoseconds) override {
+    std::lock_guard<std::mutex> L(Mtx);
+    auto Found = Operations.find(OpId);
+    if (Found != Operations.end())
+      Found->second.Phases.push_back({Phase, Nanoseconds / 1000});
+  }
+
+  void operationMetric(uint64_t OpId, StringRef Name,
+                       uint64_t Value) override {
+    std::lock_guard<std::mutex> L(Mtx);
+    auto Found = Operations.find(OpId);
+    if (Found != Operations.end())
+      Found->second.Metrics.push_back({Name, Value});
+  }
+
+  void operationFinished(uint64_t OpId) override {
+    Operation Op;
+    {
+      std::lock_guard<std::mutex> L(Mtx);
+      auto Found = Operations.find(OpId);
+      if (Found == Operations.end())
+        return;
+      Op = std::move(Found->second);
+      Operations.erase(Found);
+    }
+    if (!Enabled)
+      return;
+
+    static UIdent TraceOperationNotificationUID(
+        "source.notification.trace.operation");
+    auto Elapsed = std::chrono::steady_clock::now() - Op.Start;
+
+    ResponseBuilder RespBuilder;
+    auto Dict = RespBuilder.getDictionary();
+    Dict.set(KeyNotification, TraceOperationNotificationUID);
+    Dict.set(KeyName, trace::getOperationKindName(Op.Kind));
+    if (!Op.PrimaryFile.empty())
+      Dict.set(KeySourceFile, Op.PrimaryFile);
+    Dict.set(KeyDuration, int64_t(
+        std::chrono::duration_cast<std::chrono::microseconds>(Elapsed)
+            .count()));
+    addTraceValues(Dict, KeyPhases, Op.Phases);
+    addTraceValues(Dict, KeyMetrics, Op.Metrics);
+    sourcekitd::postNotification(RespBuilder.createResponse());
+  }
+};
+} // anonymous namespace
+
+static TraceNotificationConsumer TraceNotifications;
+
+/// Post a "source.notification.trace.request" notification with the latency
+/// of a request and the printed sizes of the request and its response.
+static void postRequestTraceNotification(
+    sourcekitd_object_t Req, sourcekitd_response_t Resp,
+    std::chrono::steady_clock::time_point Start) {
+  static UIdent TraceRequestNotificationUID(
+      "source.notification.trace.request");
+  auto Elapsed = std::chrono::steady_clock::now() - Start;
+
+  // The printed forms are only an approximation of what goes over the wire,
+  // but they are what the client gets to look at.
+  std::string Printed;
+  TraceValues Metrics;
+  {
+    llvm::raw_string_ostream OS(Printed);
+    sourcekitd::printRequestObject(Req, OS);
+  }
+  Metrics.push_back({"request.bytes", Printed.size()});
+  Printed.clear();
+  {
+    llvm::raw_string_ostream OS(Printed);
+    sourcekitd::printResponse(Resp, OS);
+  }
+  Metrics.push_back({"response.bytes", Printed.size()});
+
+  ResponseBuilder RespBuilder;
+  auto Dict = RespBuilder.getDictionary();
+  Dict.set(KeyNotification, TraceRequestNotificationUID);
+  if (sourcekitd_uid_t ReqUID = RequestDict(Req).getUID(KeyRequest))
+    Dict.set(KeyRequest, ReqUID);
+  Dict.set(KeyDuration, int64_t(
+      std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count()));
+  addTraceValues(Dict, KeyMetrics, Metrics);
+  sourcekitd::postNotification(RespBuilder.createResponse());
+}
+
 static SourceKit::Context *GlobalCtx = nullptr;
 
 void sourcekitd::initialize() {
@@ -139,6 +278,7 @@ void sourcekitd::initialize() {
                                      SourceKit::createSwiftLangSupport);
   GlobalCtx->getNotificationCenter().addDocumentUpdateNotificationReceiver(
     onDocumentUpdateNotification);
+  trace::registerConsumer(&TraceNotifications);
 }
 void sourcekitd::shutdown() {
   delete GlobalCtx;
@@ -254,13 +394,23 @@ void sourcekitd::handleRequest(sourcekitd_object_t Req,
     sourcekitd::printRequestObject(Req, Log->getOS());
   }
 
-  handleRequestImpl(Req, [Receiver](sourcekitd_response_t Resp) {
+  bool TraceRequest = TraceNotifications.Enabled;
+  auto Start = std::chrono::steady_clock::now();
+  if (TraceRequest)
+    sourcekitd_request_retain(Req);
+
+  handleRequestImpl(Req, [Receiver, Req, TraceRequest, Start](
+                             sourcekitd_response_t Resp) {
     LOG_SECTION("handleRequest-after", InfoHighPrio) {
       // Responses are big, print them out with info medium priority.
       if (Logger::isLoggingEnabledForLevel(Logger::Level::InfoMediumPrio))
         sourcekitd::printResponse(Resp, Log->getOS());
     }
 
+    if (TraceRequest) {
+      postRequestTraceNotification(Req, Resp, Start);
+      sourcekitd_request_release(Req);
+    }
     Receiver(Resp);
   });
 }
@@ -298,6 +448,60 @@ getInputBufForRequest(Optional<StringRef> SourceFile,
   return InputBuf;
 }
 
+//===----------------------------------------------------------------------===//
+// Background requests
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Runs the requests which nobody waits on interactively, such as indexing
+/// and doc info, at background priority and only a few at a time, so they
+/// don't take the threads and CPU that code completion and cursor info need.
+class BackgroundRequestQueue {
+  std::mutex Mtx;
+  std::deque<std::function<void()>> Pending;
+  unsigned Running = 0;
+  const unsigned Limit;
+
+  void run(std::function<void()> Fn) {
+    WorkQueue::dispatchConcurrent([this, Fn] {
+      Fn();
+      std::function<void()> Next;
+      {
+        std::lock_guard<std::mutex> L(Mtx);
+        if (Pending.empty()) {
+          --Running;
+          return;
+        }
+        Next = std::move(Pending.front());
+        Pending.pop_front();
+      }
+      run(std::move(Next));
+    }, WorkQueue::Priority::Background, /*isStackDeep=*/true);
+  }
+
+public:
+  explicit BackgroundRequestQueue(unsigned Limit) : Limit(Limit) {}
+
+  void dispatch(std::function<void()> Fn) {
+    {
+      std::lock_guard<std::mutex> L(Mtx);
+      if (Running == Limit) {
+        Pending.push_back(std::move(Fn));
+        return;
+      }
+      ++Running;
+    }
+    run(std::move(Fn));
+  }
+};
+} // end anonymous namespace
+
+static BackgroundRequestQueue &getBackgroundRequestQueue() {
+  // Leave at least half of the cores to interactive requests.
+  static BackgroundRequestQueue Queue(
+      std::max(1u, std::thread::hardware_concurrency() / 2));
+  return Queue;
+}
 
 static void
 handleSemanticRequest(RequestDict Req,
@@ -321,6 +525,19 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(RB.createResponse());
   }
 
+  if (ReqUID == RequestTracingNotifications) {
+    int64_t Enabled = true;
+    Req.getInt64(KeyEnabled, Enabled, /*isOptional=*/true);
+    TraceNotifications.Enabled = Enabled;
+    // Operations are only traced while tracing is enabled; this also affects
+    // the tracer of the XPC service.
+    if (Enabled)
+      trace::enable();
+    else
+      trace::disable();
+    return Rec(ResponseBuilder().createResponse());
+  }
+
   if (ReqUID == RequestCrashWithExit) {
     // 'exit' has the same effect as crashing but without the crash log.
     ::exit(1);
@@ -385,14 +602,24 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
   }
 
   if (ReqUID == RequestDocInfo) {
-    std::unique_ptr<llvm::MemoryBuffer>
-      InputBuf = getInputBufForRequest(SourceFile, SourceText, ErrBuf);
-    if (!InputBuf)
-      return Rec(createErrorRequestFailed(ErrBuf.c_str()));
-    StringRef ModuleName;
-    Optional<StringRef> ModuleNameOpt = Req.getString(KeyModuleName);
-    if (ModuleNameOpt.hasValue()) ModuleName = *ModuleNameOpt;
-    return Rec(reportDocInfo(InputBuf.get(), ModuleName, Args));
+    sourcekitd_request_retain(ReqObj);
+    getBackgroundRequestQueue().dispatch(
+      [ReqObj, Rec, SourceFile, SourceText, Args] {
+        RequestDict Req(ReqObj);
+        llvm::SmallString<64> ErrBuf;
+        std::unique_ptr<llvm::MemoryBuffer>
+          InputBuf = getInputBufForRequest(SourceFile, SourceText, ErrBuf);
+        if (!InputBuf) {
+          Rec(createErrorRequestFailed(ErrBuf.c_str()));
+        } else {
+          StringRef ModuleName;
+          Optional<StringRef> ModuleNameOpt = Req.getString(KeyModuleName);
+          if (ModuleNameOpt.hasValue()) ModuleName = *ModuleNameOpt;
+          Rec(reportDocInfo(InputBuf.get(), ModuleName, Args));
+        }
+        sourcekitd_request_release(ReqObj);
+      });
+    return;
   }
 
   if (ReqUID == RequestEditorOpen) {
@@ -646,8 +873,18 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
   // Run them under a malloc'ed stack.
 
   static WorkQueue SemaQueue{ WorkQueue::Dequeuing::Concurrent,
-                              "sourcekit.request.semantic" };
+                              "sourcekit.request.semantic",
+                              WorkQueue::Priority::High };
   sourcekitd_request_retain(ReqObj);
+  if (ReqUID == RequestIndex) {
+    getBackgroundRequestQueue().dispatch(
+      [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args] {
+        RequestDict Req(ReqObj);
+        handleSemanticRequest(Req, Rec, ReqUID, SourceFile, SourceText, Args);
+        sourcekitd_request_release(ReqObj);
+      });
+    return;
+  }
   SemaQueue.dispatch(
     [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args] {
       RequestDict Req(ReqObj);
@@ -1705,19 +1942,13 @@ class SKEditorConsumer : public EditorConsumer {
   ResponseBuilder::Dictionary Dict;
   TokenAnnotationsArrayBuilder SyntaxMap;
   TokenAnnotationsArrayBuilder SemanticAnnotations;
-
-  struct StructureNode {
-    ResponseBuilder::Dictionary Dict;
-    ResponseBuilder::Array SubStructures;
-    ResponseBuilder::Array Elements;
-
-    explicit StructureNode(ResponseBuilder::Dictionary Dict) : Dict(Dict) {}
-  };
-  std::vector<StructureNode> Structures;
+  DocStructureArrayBuilder DocStructure;
+  ResponseBuilder::Array TopLevelElements;
   ResponseBuilder::Array Diags;
   sourcekitd_response_t Error = nullptr;
 
   bool EnableSyntaxMap;
+  bool EnableStructure;
   bool EnableDiagnostics;
   bool SyntacticOnly;
 
@@ -1726,12 +1957,11 @@ public:
                    bool EnableStructure, bool EnableDiagnostics,
                    bool SyntacticOnly)
   : EnableSyntaxMap(EnableSyntaxMap),
+    EnableStructure(EnableStructure),
     EnableDiagnostics(EnableDiagnostics),
     SyntacticOnly(SyntacticOnly) {
 
     Dict = RespBuilder.getDictionary();
-    if (EnableStructure)
-      Structures.push_back(StructureNode{Dict});
   }
 
   SKEditorConsumer(ResponseReceiver RespReceiver, bool EnableSyntaxMap,
@@ -1931,6 +2161,11 @@ sourcekitd_response_t SKEditorConsumer::createResponse() {
         CustomBufferKind::TokenAnnotationsArray,
         SemanticAnnotations.createBuffer());
   }
+  if (EnableStructure && !DocStructure.empty()) {
+    Dict.setCustomBuffer(KeySubStructure,
+        CustomBufferKind::DocStructureArray,
+        DocStructure.createBuffer());
+  }
 
   return RespBuilder.createResponse();
 }
@@ -1977,73 +2212,35 @@ SKEditorConsumer::beginDocumentSubStructure(unsigned Offset,
                                             StringRef SelectorName,
                                             ArrayRef<StringRef> InheritedTypes,
                                             ArrayRef<UIdent> Attrs) {
-  if (Structures.empty())
-    return true;
-
-  auto &Parent = Structures.back();
-  if (Parent.SubStructures.isNull())
-    Parent.SubStructures = Parent.Dict.setArray(KeySubStructure);
-  auto Node = Parent.SubStructures.appendDictionary();
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
-  Node.set(KeyKind, Kind);
-  if (AccessLevel.isValid())
-    Node.set(KeyAccessibility, AccessLevel);
-  if (SetterAccessLevel.isValid())
-    Node.set(KeySetterAccessibility, SetterAccessLevel);
-  Node.set(KeyNameOffset, NameOffset);
-  Node.set(KeyNameLength, NameLength);
-  if (BodyOffset != 0 || BodyLength !=0) {
-    Node.set(KeyBodyOffset, BodyOffset);
-    Node.set(KeyBodyLength, BodyLength);
-  }
-
-  if (!DisplayName.empty())
-    Node.set(KeyName, DisplayName);
-
-  if (!TypeName.empty())
-    Node.set(KeyTypeName,TypeName);
-
-  if (!RuntimeName.empty())
-    Node.set(KeyRuntimeName, RuntimeName);
-
-  if (!SelectorName.empty())
-    Node.set(KeySelectorName, SelectorName);
-
-  if (!InheritedTypes.empty()) {
-    auto TypeArray = Node.setArray(KeyInheritedTypes);
-    for (const StringRef &TypeName : InheritedTypes) {
-      TypeArray.appendDictionary().set(KeyName, TypeName);
-    }
-  }
-  if (!Attrs.empty()) {
-    auto AttrArray = Node.setArray(KeyAttributes);
-    for (auto Attr : Attrs) {
-      auto AttrDict = AttrArray.appendDictionary();
-      AttrDict.set(KeyAttribute, Attr);
-    }
-  }
-  Structures.push_back(StructureNode{Node});
+  if (EnableStructure)
+    DocStructure.beginSubStructure(Offset, Length, Kind, AccessLevel,
+                                   SetterAccessLevel, NameOffset, NameLength,
+                                   BodyOffset, BodyLength, DisplayName,
+                                   TypeName, RuntimeName, SelectorName,
+                                   InheritedTypes, Attrs);
   return true;
 }
 
 bool SKEditorConsumer::endDocumentSubStructure() {
-  if (!Structures.empty())
-    Structures.pop_back();
-
+  if (EnableStructure)
+    DocStructure.endSubStructure();
   return true;
 }
 
 bool SKEditorConsumer::handleDocumentSubStructureElement(UIdent Kind,
                                                          unsigned Offset,
                                                          unsigned Length) {
-  if (Structures.empty())
+  if (!EnableStructure)
     return true;
 
-  auto &Parent = Structures.back();
-  if (Parent.Elements.isNull())
-    Parent.Elements = Parent.Dict.setArray(KeyElements);
-  auto Node = Parent.Elements.appendDictionary();
+  if (DocStructure.isInSubStructure()) {
+    DocStructure.addElement(Kind, Offset, Length);
+    return true;
+  }
+
+  if (TopLevelElements.isNull())
+    TopLevelElements = Dict.setArray(KeyElements);
+  auto Node = TopLevelElements.appendDictionary();
   Node.set(KeyKind, Kind);
   Node.set(KeyOffset, Offset);
   Node.set(KeyLength, Length);
@@ -134,6 +134,11 @@ UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyTypeUsr("key.typeusr");
 UIdent sourcekitd::KeyContainerTypeUsr("key.containertypeusr");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyEnabled("key.enabled");
+UIdent sourcekitd::KeyDuration("key.duration");
+UIdent sourcekitd::KeyPhases("key.phases");
+UIdent sourcekitd::KeyMetrics("key.metrics");
+UIdent sourcekitd::KeyValue("key.value");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -14,6 +14,7 @@
 #include "sourcekitd/sourcekitd.h"
 #include "sourcekitd/Internal.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 #include "sourcekitd/Logging.h"
@@ -233,13 +234,10 @@ private:
 
 class SKDCustomData: public SKDObject {
 public:
-  SKDCustomData(CustomBufferKind BufferKind, 
-                std::unique_ptr<llvm::MemoryBuffer>& MemBuf)
+  SKDCustomData(CustomBufferKind BufferKind,
+                std::unique_ptr<llvm::MemoryBuffer> MemBuf)
   : SKDObject(ObjectKind::CustomData), BufferKind(BufferKind),
-    BufferPtr(llvm::MemoryBuffer::getMemBufferCopy(
-                                                MemBuf->getBuffer(), 
-                                                MemBuf->getBufferIdentifier())) 
-    {}
+    BufferPtr(std::move(MemBuf)) {}
 
   SKDCustomData(SKDCustomData const&) = delete;
   SKDCustomData &operator=(SKDCustomData const&) = delete;
@@ -249,6 +247,7 @@ public:
       case CustomBufferKind::TokenAnnotationsArray:
       case CustomBufferKind::DocSupportAnnotationArray:
       case CustomBufferKind::CodeCompletionResultsArray:
+      case CustomBufferKind::DocStructureArray:
         return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
     llvm::report_fatal_error("sourcekitd object did not resolve to a known type");
@@ -649,7 +648,8 @@ void ResponseBuilder::Dictionary::setCustomBuffer(
       SourceKit::UIdent Key,
       CustomBufferKind Kind, std::unique_ptr<llvm::MemoryBuffer> MemBuf) {
   static_cast<SKDObject *>(Impl)->set(SKDUIDFromUIdent(Key), 
-                                      new SKDCustomData(Kind, MemBuf));
+                                      new SKDCustomData(Kind,
+                                                        std::move(MemBuf)));
 }
 
 ResponseBuilder::Array
@@ -927,6 +927,9 @@ static sourcekitd_variant_t variantFromSKDObject(SKDObjectRef Object) {
       case CustomBufferKind::CodeCompletionResultsArray:
         return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
           (uintptr_t)DataObject->getDataPtr(), 0 }};
+      case CustomBufferKind::DocStructureArray:
+        return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+          (uintptr_t)DataObject->getDataPtr(), 0 }};
     }
   }
   
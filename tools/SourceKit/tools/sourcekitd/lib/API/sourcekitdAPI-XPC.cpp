@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 #include "sourcekitd/RequestResponsePrinterBase.h"
@@ -20,6 +21,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <dispatch/dispatch.h>
 #include <vector>
 #include <xpc/xpc.h>
 
@@ -251,8 +253,16 @@ void ResponseBuilder::Dictionary::setCustomBuffer(
   BufPtr += sizeof(uint64_t);
   memcpy(BufPtr, MemBuf->getBufferStart(), MemBuf->getBufferSize());
 
-  xpc_object_t xdata = xpc_data_create(CustomBuf->getBufferStart(),
-                                       CustomBuf->getBufferSize());
+  // Hand the buffer over to XPC instead of having xpc_data_create copy it.
+  // Large dispatch data is sent to the client by mapping its pages rather
+  // than copying it into the message.
+  llvm::MemoryBuffer *BufOwner = CustomBuf.release();
+  dispatch_data_t ddata = dispatch_data_create(
+      BufOwner->getBufferStart(), BufOwner->getBufferSize(),
+      dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+      ^{ delete BufOwner; });
+  xpc_object_t xdata = xpc_data_create_with_dispatch_data(ddata);
+  dispatch_release(ddata);
   xpc_dictionary_set_value(Impl, Key.c_str(), xdata);
   xpc_release(xdata);
 }
@@ -593,6 +603,8 @@ static sourcekitd_variant_type_t XPCVar_get_type(sourcekitd_variant_t var) {
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
     case CustomBufferKind::CodeCompletionResultsArray:
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
+    case CustomBufferKind::DocStructureArray:
+      return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
   }
   
@@ -728,6 +740,9 @@ static sourcekitd_variant_t variantFromXPCObject(xpc_object_t obj) {
     case CustomBufferKind::CodeCompletionResultsArray:
       return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
                 (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
+    case CustomBufferKind::DocStructureArray:
+      return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+                (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
     }
   }
 
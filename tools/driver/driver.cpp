@@ -57,6 +57,10 @@ extern int autolink_extract_main(ArrayRef<const char *> Args, const char *Argv0,
 extern int modulewrap_main(ArrayRef<const char *> Args, const char *Argv0,
                            void *MainAddr);
 
+/// Run 'swift -frontend-server'.
+extern int frontend_server_main(ArrayRef<const char *> Args,
+                                const char *Argv0, void *MainAddr);
+
 /// Run 'swift-format'
 extern int swift_format_main(ArrayRef<const char *> Args, const char *Argv0,
                              void *MainAddr);
@@ -161,6 +165,11 @@ int main(int argc_, const char **argv_) {
                                                 argv.data()+argv.size()),
                              argv[0], (void *)(intptr_t)getExecutablePath);
     }
+    if (FirstArg == "-frontend-server") {
+      return frontend_server_main(llvm::makeArrayRef(argv.data()+2,
+                                                     argv.data()+argv.size()),
+                                  argv[0], (void *)(intptr_t)getExecutablePath);
+    }
     if (FirstArg == "-modulewrap") {
       return modulewrap_main(llvm::makeArrayRef(argv.data()+2,
                                                 argv.data()+argv.size()),
@@ -0,0 +1,321 @@
+//===--- frontend_server_main.cpp - Persistent frontend process -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// 'swift -frontend-server <socket>' starts a compile server which listens on
+// a Unix domain socket and runs the frontend jobs which the driver sends to it
+// with -frontend-server-socket <socket>.
+//
+// The server initializes LLVM once and forks a process for each job. The
+// job process starts from the initialized server instead of executing and
+// initializing a new compiler. It still runs in a separate process, so jobs
+// can run in parallel, don't share any compiler state and a crashing job
+// doesn't take down the server.
+//
+// The protocol is described in lib/Basic/Unix/TaskQueue.inc. The server exits
+// after being idle for a while.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/LLVM.h"
+#include "swift/FrontendTool/FrontendTool.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if !defined(__APPLE__)
+extern char **environ;
+#else
+#include <crt_externs.h> // for _NSGetEnviron
+#endif
+#endif
+
+using namespace swift;
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+
+/// The server exits if no job was running for this time.
+static const int IdleTimeoutSeconds = 10 * 60;
+
+/// Written to by the SIGCHLD handler to wake up the server loop.
+static int ChildExitedPipe[2];
+
+static void handleChildExited(int) {
+  int SavedErrno = errno;
+  char C = 0;
+  (void)write(ChildExitedPipe[1], &C, 1);
+  errno = SavedErrno;
+}
+
+/// Writes all of \p Data to \p FD.
+/// \returns true on error, false on success
+static bool writeAll(int FD, StringRef Data) {
+  while (!Data.empty()) {
+    ssize_t Written = write(FD, Data.data(), Data.size());
+    if (Written < 0) {
+      if (errno == EINTR)
+        continue;
+      return true;
+    }
+    Data = Data.drop_front(Written);
+  }
+  return false;
+}
+
+/// Reads exactly \p Size bytes from \p FD into \p Buffer.
+/// \returns true on error, false on success
+static bool readAll(int FD, std::string &Buffer, size_t Size) {
+  Buffer.resize(Size);
+  size_t Offset = 0;
+  while (Offset < Size) {
+    ssize_t ReadBytes = read(FD, &Buffer[Offset], Size - Offset);
+    if (ReadBytes < 0 && errno == EINTR)
+      continue;
+    if (ReadBytes <= 0)
+      return true;
+    Offset += ReadBytes;
+  }
+  return false;
+}
+
+/// Runs the job requested on the connection \p Conn. Called in the forked job
+/// process; never returns.
+static void runJob(int Conn, const char *Argv0, void *MainAddr) {
+  // Read the length of the request, then the request itself.
+  std::string LengthLine;
+  char C;
+  while (true) {
+    ssize_t ReadBytes = read(Conn, &C, 1);
+    if (ReadBytes < 0 && errno == EINTR)
+      continue;
+    if (ReadBytes <= 0 || LengthLine.size() > 20)
+      _exit(1);
+    if (C == '\n')
+      break;
+    LengthLine += C;
+  }
+  unsigned long long Length;
+  std::string Request;
+  if (StringRef(LengthLine).getAsInteger(10, Length) ||
+      readAll(Conn, Request, Length))
+    _exit(1);
+
+  // Split the request into its NUL-terminated strings. They point into
+  // Request, which lives until the process exits.
+  std::vector<char *> Strings;
+  for (size_t Pos = 0; Pos < Request.size();) {
+    Strings.push_back(&Request[Pos]);
+    Pos = Request.find('\0', Pos);
+    if (Pos == std::string::npos)
+      _exit(1);
+    ++Pos;
+  }
+
+  auto reject = [Conn] {
+    writeAll(Conn, "0\n");
+    _exit(1);
+  };
+
+  // The working directory, the executable and the argument count.
+  if (Strings.size() < 3)
+    reject();
+  const char *WorkingDirectory = Strings[0];
+  const char *ExecPath = Strings[1];
+  unsigned long long NumArgs, NumEnv;
+  if (StringRef(Strings[2]).getAsInteger(10, NumArgs) ||
+      Strings.size() < 4 + NumArgs ||
+      StringRef(Strings[3 + NumArgs]).getAsInteger(10, NumEnv) ||
+      Strings.size() != 4 + NumArgs + NumEnv)
+    reject();
+  ArrayRef<const char *> Args(const_cast<const char **>(&Strings[3]),
+                              NumArgs);
+
+  // Only run jobs which would otherwise execute this compiler.
+  std::string MainExecutable =
+      llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  if (!llvm::sys::fs::equivalent(ExecPath, MainExecutable) || Args.empty() ||
+      StringRef(Args[0]) != "-frontend" || chdir(WorkingDirectory) != 0)
+    reject();
+
+  if (writeAll(Conn, std::to_string(getpid()) + "\n"))
+    _exit(1);
+
+  // Take over the environment of the driver.
+  std::vector<char *> Env(Strings.begin() + 4 + NumArgs, Strings.end());
+  Env.push_back(nullptr);
+#if __APPLE__
+  *_NSGetEnviron() = Env.data();
+#else
+  environ = Env.data();
+#endif
+
+  // Like a task which is started by the driver, the job writes both stdout
+  // and stderr to the driver.
+  dup2(Conn, STDOUT_FILENO);
+  dup2(Conn, STDERR_FILENO);
+  close(Conn);
+
+  int Result = performFrontend(Args.drop_front(), Argv0, MainAddr);
+  llvm::outs().flush();
+  llvm::errs().flush();
+  exit(Result);
+}
+
+/// Sends the exit status of a job and closes its connection.
+static void finishJob(int Conn, int Status) {
+  std::string Trailer(1, '\0');
+  if (WIFEXITED(Status)) {
+    Trailer += 'X';
+    Trailer += std::to_string(WEXITSTATUS(Status));
+  } else {
+    Trailer += 'S';
+    Trailer +=
+        std::to_string(WIFSIGNALED(Status) ? WTERMSIG(Status) : SIGKILL);
+  }
+  writeAll(Conn, Trailer);
+  close(Conn);
+}
+
+int frontend_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                         void *MainAddr) {
+  if (Args.size() != 1) {
+    llvm::errs() << "usage: swift -frontend-server <socket path>\n";
+    return 1;
+  }
+  StringRef SocketPath = Args[0];
+
+  struct sockaddr_un Addr;
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Addr.sun_path)) {
+    llvm::errs() << "error: socket path is too long: " << SocketPath << '\n';
+    return 1;
+  }
+  memcpy(Addr.sun_path, SocketPath.data(), SocketPath.size());
+
+  int Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(Addr.sun_path);
+  if (Listener < 0 ||
+      bind(Listener, reinterpret_cast<struct sockaddr *>(&Addr),
+           sizeof(Addr)) != 0 ||
+      listen(Listener, SOMAXCONN) != 0) {
+    llvm::errs() << "error: cannot listen on " << SocketPath << ": "
+                 << strerror(errno) << '\n';
+    return 1;
+  }
+
+  // Do the initialization which every job needs once, before forking.
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  if (pipe(ChildExitedPipe) != 0)
+    return 1;
+  fcntl(ChildExitedPipe[0], F_SETFL, O_NONBLOCK);
+  fcntl(ChildExitedPipe[1], F_SETFL, O_NONBLOCK);
+  signal(SIGCHLD, handleChildExited);
+  // A driver which went away must not take down the server.
+  signal(SIGPIPE, SIG_IGN);
+
+  // The connections of the running jobs, by pid.
+  llvm::DenseMap<pid_t, int> RunningJobs;
+
+  while (true) {
+    struct pollfd PollFds[] = {
+      { Listener, POLLIN, 0 },
+      { ChildExitedPipe[0], POLLIN, 0 },
+    };
+    int Timeout = RunningJobs.empty() ? IdleTimeoutSeconds * 1000 : -1;
+    int ReadyFdCount = poll(PollFds, 2, Timeout);
+    if (ReadyFdCount < 0) {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+      break;
+    }
+    if (ReadyFdCount == 0)
+      break;
+
+    if (PollFds[1].revents & POLLIN) {
+      char Buffer[64];
+      while (read(ChildExitedPipe[0], Buffer, sizeof(Buffer)) > 0)
+        ;
+      int Status;
+      pid_t Pid;
+      while ((Pid = waitpid(-1, &Status, WNOHANG)) > 0) {
+        auto It = RunningJobs.find(Pid);
+        if (It == RunningJobs.end())
+          continue;
+        finishJob(It->second, Status);
+        RunningJobs.erase(It);
+      }
+    }
+
+    if (PollFds[0].revents & POLLIN) {
+      int Conn = accept(Listener, nullptr, nullptr);
+      if (Conn < 0)
+        continue;
+      pid_t Pid = fork();
+      if (Pid == 0) {
+        close(Listener);
+        close(ChildExitedPipe[0]);
+        close(ChildExitedPipe[1]);
+        // The drivers of the other running jobs only see the end of their
+        // output once every process holding their connection closed it.
+        for (auto &Job : RunningJobs)
+          close(Job.second);
+        signal(SIGCHLD, SIG_DFL);
+        signal(SIGPIPE, SIG_DFL);
+        runJob(Conn, Argv0, MainAddr);
+      }
+      if (Pid < 0) {
+        // The driver runs the job itself if it doesn't get a pid.
+        close(Conn);
+        continue;
+      }
+      RunningJobs[Pid] = Conn;
+    }
+  }
+
+  close(Listener);
+  unlink(Addr.sun_path);
+  return 0;
+}
+
+#else
+
+int frontend_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                         void *MainAddr) {
+  llvm::errs() << "error: -frontend-server is not supported on this "
+                  "platform\n";
+  return 1;
+}
+
+#endif
@@ -217,10 +217,18 @@ int main(int argc, char **argv) {
     std::unique_ptr<SerializedSILLoader> SL = SerializedSILLoader::create(
         CI.getASTContext(), CI.getSILModule(), nullptr);
 
-    if (extendedInfo.isSIB())
-      SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
-    else
-      SL->getAll();
+    // A function given by its mangled name can be looked up directly,
+    // which only deserializes its body and the declarations it refers to,
+    // instead of the whole module.
+    bool FoundFunction = FunctionName.size() &&
+                         StringRef(FunctionName).startswith("_T") &&
+                         SL->lookupSILFunction(FunctionName);
+    if (!FoundFunction) {
+      if (extendedInfo.isSIB())
+        SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
+      else
+        SL->getAll();
+    }
   }
 
   if (!FunctionName.empty())
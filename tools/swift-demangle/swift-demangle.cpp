@@ -19,12 +19,15 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <vector>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -55,21 +58,18 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<unsigned>
+NumThreads("num-threads",
+           llvm::cl::desc("Demangle standard input in large chunks using this "
+                          "many worker threads"),
+           llvm::cl::init(0));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
-}
-
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
-}
-
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
+                     swift::Demangle::NodeFactory &factory,
                      const swift::Demangle::DemangleOptions &options) {
   bool hadLeadingUnderscore = false;
   if (name.startswith("__")) {
@@ -77,55 +77,165 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     name = name.substr(1);
   }
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(name, factory);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
+  }
+}
+
+/// Is \p c a character that can appear in a mangled name after the "_T"?
+///
+/// This doesn't handle Unicode symbols, but maybe that's okay.
+static bool isMangledNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+/// Copy \p input to \p os, replacing every mangled name in it with its
+/// demangling.
+///
+/// This is equivalent to repeatedly matching the regex "_T[_a-zA-Z0-9$]+",
+/// but scans for candidate underscores with memchr, which is much faster
+/// than the regex engine on large inputs.
+static void demangleBuffer(llvm::raw_ostream &os, llvm::StringRef input,
+                           swift::Demangle::NodeFactory &factory,
+                           const swift::Demangle::DemangleOptions &options) {
+  const char *cur = input.begin();
+  const char *end = input.end();
+  const char *copyFrom = cur;
+  while (cur != end) {
+    auto *underscore =
+        static_cast<const char *>(memchr(cur, '_', end - cur));
+    if (!underscore)
+      break;
+    cur = underscore + 1;
+    if (end - underscore < 3 || underscore[1] != 'T' ||
+        !isMangledNameChar(underscore[2]))
+      continue;
+
+    const char *symbolEnd = underscore + 3;
+    while (symbolEnd != end && isMangledNameChar(*symbolEnd))
+      ++symbolEnd;
+
+    os << llvm::StringRef(copyFrom, underscore - copyFrom);
+    demangle(os, llvm::StringRef(underscore, symbolEnd - underscore), factory,
+             options);
+    factory.clear();
+    cur = copyFrom = symbolEnd;
+  }
+  os << llvm::StringRef(copyFrom, end - copyFrom);
+}
+
+/// Demangle standard input in large chunks, splitting each chunk at line
+/// boundaries across \p numThreads workers.  Each worker has its own arena
+/// and output buffer, and the buffers are written out in input order.
+static int demangleSTDINParallel(
+    unsigned numThreads, const swift::Demangle::DemangleOptions &options) {
+  const size_t chunkSizePerThread = 1 << 20;
+  std::vector<char> buffer;
+  std::vector<swift::Demangle::NodeFactory> factories(numThreads);
+  std::vector<std::string> outputs(numThreads);
+  size_t carried = 0;
+
+  while (true) {
+    buffer.resize(carried + chunkSizePerThread * numThreads);
+    size_t numRead = fread(buffer.data() + carried, 1,
+                           buffer.size() - carried, stdin);
+    if (ferror(stdin))
+      return EXIT_FAILURE;
+    bool atEOF = numRead == 0 || feof(stdin);
+    size_t size = carried + numRead;
+
+    // Only hand out complete lines; keep the tail for the next chunk, unless
+    // there won't be one.
+    llvm::StringRef chunk(buffer.data(), size);
+    if (!atEOF) {
+      size_t lastNewline = chunk.rfind('\n');
+      if (lastNewline != llvm::StringRef::npos)
+        chunk = chunk.substr(0, lastNewline + 1);
+    }
+
+    // Split the chunk into roughly equal, line-aligned pieces.
+    std::vector<llvm::StringRef> pieces;
+    llvm::StringRef rest = chunk;
+    for (unsigned i = 1; i < numThreads && !rest.empty(); ++i) {
+      size_t split = rest.find('\n', chunk.size() / numThreads);
+      if (split == llvm::StringRef::npos)
+        break;
+      pieces.push_back(rest.substr(0, split + 1));
+      rest = rest.substr(split + 1);
+    }
+    pieces.push_back(rest);
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1, e = pieces.size(); i < e; ++i) {
+      workers.emplace_back([&, i] {
+        outputs[i].clear();
+        llvm::raw_string_ostream os(outputs[i]);
+        demangleBuffer(os, pieces[i], factories[i], options);
+      });
+    }
+    {
+      outputs[0].clear();
+      llvm::raw_string_ostream os(outputs[0]);
+      demangleBuffer(os, pieces[0], factories[0], options);
+    }
+    for (auto &worker : workers)
+      worker.join();
+
+    for (unsigned i = 0, e = pieces.size(); i < e; ++i)
+      llvm::outs() << outputs[i];
+
+    if (atEOF)
+      break;
+
+    carried = size - chunk.size();
+    memmove(buffer.data(), buffer.data() + chunk.size(), carried);
   }
+
+  return EXIT_SUCCESS;
 }
 
 static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
-  // This doesn't handle Unicode symbols, but maybe that's okay.
-  llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+  if (NumThreads > 0)
+    return demangleSTDINParallel(NumThreads, options);
+
+  // Reuse the same arena for every symbol we demangle.
+  swift::Demangle::NodeFactory factory;
 
   while (true) {
     char *inputLine = NULL;
     size_t size;
     if (getline(&inputLine, &size, stdin) == -1 || size <= 0) {
-      if (errno == 0) {
+      // errno may be left over from an unrelated call, so ask the stream.
+      if (feof(stdin)) {
+        free(inputLine);
         break;
       }
 
       return EXIT_FAILURE;
     }
 
-    llvm::StringRef inputContents(inputLine);
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-
-    llvm::outs() << inputContents;
+    demangleBuffer(llvm::outs(), inputLine, factory, options);
     free(inputLine);
   }
 
@@ -149,8 +259,10 @@ int main(int argc, char **argv) {
     CompactMode = true;
     return demangleSTDIN(options);
   } else {
+    swift::Demangle::NodeFactory factory;
     for (llvm::StringRef name : InputNames) {
-      demangle(llvm::outs(), name, options);
+      demangle(llvm::outs(), name, factory, options);
+      factory.clear();
       llvm::outs() << '\n';
     }
 
@@ -42,7 +42,8 @@ using namespace Demangle;
 
 enum class ActionType {
   DumpReflectionSections,
-  DumpTypeLowering
+  DumpTypeLowering,
+  DumpFieldSummary
 };
 
 namespace options {
@@ -55,6 +56,10 @@ Action(llvm::cl::desc("Mode:"),
          clEnumValN(ActionType::DumpTypeLowering,
                     "dump-type-lowering",
                     "Dump the field layout for typeref strings read from stdin"),
+         clEnumValN(ActionType::DumpFieldSummary,
+                    "dump-field-summary",
+                    "Dump the number of fields and the size of each type "
+                    "as JSON"),
          clEnumValEnd),
        llvm::cl::init(ActionType::DumpReflectionSections));
 
@@ -132,6 +137,75 @@ static ReflectionInfo findReflectionInfo(const ObjectFile *objectFile) {
   };
 }
 
+static const char *getKindName(FieldDescriptorKind kind) {
+  switch (kind) {
+  case FieldDescriptorKind::Struct:
+    return "struct";
+  case FieldDescriptorKind::Class:
+    return "class";
+  case FieldDescriptorKind::Enum:
+  case FieldDescriptorKind::MultiPayloadEnum:
+    return "enum";
+  case FieldDescriptorKind::Protocol:
+  case FieldDescriptorKind::ClassProtocol:
+  case FieldDescriptorKind::ObjCProtocol:
+    return "protocol";
+  case FieldDescriptorKind::ObjCClass:
+    return "objc_class";
+  }
+  return "unknown";
+}
+
+static void writeJSONString(std::ostream &OS, StringRef str) {
+  OS << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      OS << '\\';
+    OS << c;
+  }
+  OS << '"';
+}
+
+/// Writes one JSON object per type with field metadata, in the order of the
+/// binaries, for tracking the number and size of types over time.
+///
+/// The size is only known for concrete structs and enums; it is the size of
+/// a value of the type, which doesn't include any out-of-line storage.
+static void dumpFieldSummary(TypeRefBuilder &builder,
+                             ArrayRef<std::string> binaryFilenames,
+                             ArrayRef<ReflectionInfo> infos,
+                             std::ostream &OS) {
+  OS << "[";
+  bool first = true;
+  for (unsigned i = 0, e = infos.size(); i != e; ++i) {
+    for (const auto &descriptor : infos[i].fieldmd) {
+      if (!descriptor.hasMangledTypeName())
+        continue;
+      auto mangledName = descriptor.getMangledTypeName();
+
+      OS << (first ? "\n" : ",\n") << "  {\"binary\": ";
+      first = false;
+      writeJSONString(OS, binaryFilenames[i]);
+      OS << ", \"type\": ";
+      writeJSONString(OS, Demangle::demangleTypeAsString(mangledName));
+      OS << ", \"kind\": \"" << getKindName(descriptor.Kind) << "\""
+         << ", \"fields\": " << descriptor.NumFields;
+
+      if (!descriptor.isClass() && !descriptor.isProtocol()) {
+        auto demangled = Demangle::demangleTypeAsNode(mangledName);
+        auto *typeRef = swift::remote::decodeMangledType(builder, demangled);
+        if (typeRef) {
+          auto *typeInfo = builder.getTypeConverter().getTypeInfo(typeRef);
+          if (typeInfo)
+            OS << ", \"size\": " << typeInfo->getSize();
+        }
+      }
+      OS << "}";
+    }
+  }
+  OS << "\n]\n";
+}
+
 static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
                                     StringRef arch,
                                     ActionType action,
@@ -143,6 +217,7 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
 
   // Construct the TypeRefBuilder
   TypeRefBuilder builder;
+  std::vector<ReflectionInfo> infos;
 
   for (auto binaryFilename : binaryFilenames) {
     auto binaryOwner = unwrap(createBinary(binaryFilename));
@@ -161,7 +236,10 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
       objectFile = objectOwner.get();
     }
 
-    builder.addReflectionInfo(findReflectionInfo(objectFile));
+    // The sections are used in place, in the memory of the (usually mapped)
+    // binaries.
+    infos.push_back(findReflectionInfo(objectFile));
+    builder.addReflectionInfo(infos.back());
 
     // Retain the objects that own section memory
     binaryOwners.push_back(std::move(binaryOwner));
@@ -198,6 +276,9 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
     }
     break;
   }
+  case ActionType::DumpFieldSummary:
+    dumpFieldSummary(builder, binaryFilenames, infos, OS);
+    break;
   }
 
   return EXIT_SUCCESS;
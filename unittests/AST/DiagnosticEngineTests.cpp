@@ -0,0 +1,86 @@
+//===--- DiagnosticEngineTests.cpp - Tests for the diagnostic engine ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/AST/DiagnosticsFrontend.h"
+#include "swift/Basic/DiagnosticConsumer.h"
+#include "swift/Basic/SourceManager.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+
+/// Records the text of every diagnostic it receives.
+class RecordingConsumer : public DiagnosticConsumer {
+public:
+  std::vector<std::string> Texts;
+
+  void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
+                        DiagnosticKind Kind, StringRef Text,
+                        const DiagnosticInfo &Info) override {
+    Texts.push_back(Text);
+  }
+};
+
+} // end anonymous namespace
+
+TEST(DiagnosticEngine, DiscardedWithoutConsumers) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+
+  EXPECT_TRUE(Diags.isDiagnosticDiscarded(diag::not_implemented.ID));
+  Diags.diagnose(SourceLoc(), diag::not_implemented, "feature");
+
+  // A discarded error still counts as an error.
+  EXPECT_TRUE(Diags.hadAnyError());
+}
+
+TEST(DiagnosticEngine, DiscardedSuppressedWarnings) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+
+  EXPECT_FALSE(Diags.isDiagnosticDiscarded(diag::warning_no_such_sdk.ID));
+  Diags.setSuppressWarnings(true);
+  EXPECT_TRUE(Diags.isDiagnosticDiscarded(diag::warning_no_such_sdk.ID));
+  EXPECT_FALSE(Diags.isDiagnosticDiscarded(diag::not_implemented.ID));
+
+  Diags.diagnose(SourceLoc(), diag::warning_no_such_sdk, "sdk");
+  Diags.diagnose(SourceLoc(), diag::not_implemented, "feature");
+  ASSERT_EQ(1u, Consumer.Texts.size());
+  EXPECT_EQ("INTERNAL ERROR: feature not implemented: feature",
+            Consumer.Texts[0]);
+}
+
+TEST(DiagnosticEngine, DiscardedInTransaction) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+  Diags.ignoreDiagnostic(diag::not_implemented.ID);
+  EXPECT_TRUE(Diags.isDiagnosticDiscarded(diag::not_implemented.ID));
+
+  {
+    // Tentative diagnostics are only classified when they are emitted.
+    DiagnosticTransaction Transaction(Diags);
+    EXPECT_FALSE(Diags.isDiagnosticDiscarded(diag::not_implemented.ID));
+    Diags.diagnose(SourceLoc(), diag::not_implemented, "feature");
+  }
+  EXPECT_TRUE(Consumer.Texts.empty());
+  EXPECT_FALSE(Diags.hadAnyError());
+}
@@ -0,0 +1,73 @@
+//===--- IdentifierTableTests.cpp - Tests for the identifier table --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/IdentifierTable.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+TEST(IdentifierTable, Uniquing) {
+  IdentifierTable Table;
+
+  const char *Foo = Table.get("foo");
+  EXPECT_STREQ("foo", Foo);
+  EXPECT_EQ(Foo, Table.get(std::string("foo")));
+  EXPECT_EQ(Foo, Table.get("foo", IdentifierTable::hashText("foo")));
+  EXPECT_NE(Foo, Table.get("fo"));
+  EXPECT_NE(Foo, Table.get("foobar"));
+  EXPECT_STREQ("", Table.get(""));
+}
+
+TEST(IdentifierTable, Growth) {
+  IdentifierTable Table;
+
+  std::vector<const char *> Entries;
+  for (unsigned i = 0; i != 10000; ++i)
+    Entries.push_back(Table.get("name" + std::to_string(i)));
+
+  for (unsigned i = 0; i != 10000; ++i) {
+    std::string Name = "name" + std::to_string(i);
+    EXPECT_EQ(Entries[i], Table.get(Name));
+    EXPECT_EQ(Name, Entries[i]);
+  }
+}
+
+TEST(IdentifierTable, ConcurrentInsertion) {
+  IdentifierTable Table;
+  const unsigned NumThreads = 8;
+  const unsigned NumNames = 2000;
+
+  // Every thread interns the same names, in a different order.
+  std::vector<std::vector<const char *>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned t = 0; t != NumThreads; ++t) {
+    Threads.emplace_back([&, t] {
+      Results[t].resize(NumNames);
+      for (unsigned n = 0; n != NumNames; ++n) {
+        unsigned i = (n * 7 + t * 13) % NumNames;
+        Results[t][i] = Table.get("name" + std::to_string(i));
+      }
+    });
+  }
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  for (unsigned i = 0; i != NumNames; ++i) {
+    EXPECT_EQ("name" + std::to_string(i), Results[0][i]);
+    for (unsigned t = 1; t != NumThreads; ++t)
+      EXPECT_EQ(Results[0][i], Results[t][i]);
+  }
+}
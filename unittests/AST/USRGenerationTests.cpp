@@ -0,0 +1,67 @@
+//===--- USRGenerationTests.cpp - Tests for caching of USRs ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestContext.h"
+#include "swift/AST/USRGeneration.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::unittest;
+
+static std::string printUSR(const ValueDecl *D, bool &failed) {
+  llvm::SmallString<64> buffer;
+  llvm::raw_svector_ostream OS(buffer);
+  failed = ide::printDeclUSR(D, OS);
+  return OS.str();
+}
+
+TEST(USRGeneration, CachedMangledNames) {
+  TestContext C;
+  auto *someStruct = C.makeNominal<StructDecl>("MyStruct");
+  unsigned USRKind = unsigned(DeclMangling::USR);
+  unsigned TypeUSRKind = unsigned(DeclMangling::TypeUSR);
+
+  EXPECT_FALSE(C.Ctx.getCachedMangledName(someStruct, USRKind).hasValue());
+
+  C.Ctx.setCachedMangledName(someStruct, USRKind, "s:first");
+  C.Ctx.setCachedMangledName(someStruct, TypeUSRKind, "s:second");
+  EXPECT_EQ("s:first", *C.Ctx.getCachedMangledName(someStruct, USRKind));
+  EXPECT_EQ("s:second", *C.Ctx.getCachedMangledName(someStruct, TypeUSRKind));
+}
+
+TEST(USRGeneration, DeclUSRIsCachedOnceTypeChecked) {
+  TestContext C;
+  auto *someStruct = C.makeNominal<StructDecl>("MyStruct");
+  unsigned USRKind = unsigned(DeclMangling::USR);
+
+  // Without a type, there is no USR yet, and nothing is remembered.
+  bool failed;
+  printUSR(someStruct, failed);
+  EXPECT_TRUE(failed);
+  EXPECT_FALSE(C.Ctx.getCachedMangledName(someStruct, USRKind).hasValue());
+
+  someStruct->computeType();
+  std::string USR = printUSR(someStruct, failed);
+  ASSERT_FALSE(failed);
+  EXPECT_EQ(0u, StringRef(USR).find("s:"));
+
+  auto cached = C.Ctx.getCachedMangledName(someStruct, USRKind);
+  ASSERT_TRUE(cached.hasValue());
+  EXPECT_EQ(USR, *cached);
+
+  // Later requests are answered from the cache.
+  C.Ctx.setCachedMangledName(someStruct, USRKind, "s:fromTheCache");
+  EXPECT_EQ("s:fromTheCache", printUSR(someStruct, failed));
+  EXPECT_FALSE(failed);
+}
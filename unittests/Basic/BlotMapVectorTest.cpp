@@ -624,6 +624,34 @@ struct ContiguousBlotMapVectorInfo {
   }
 };
 
+// Compacting the map removes the blotted entries and keeps the order of the
+// remaining ones.
+TEST(BlotMapVectorCustomTest, CompactTest) {
+  BlotMapVector<unsigned, unsigned> map;
+  for (unsigned i = 0; i < 8; ++i)
+    map[i] = i + 1;
+  map.blot(0);
+  map.blot(3);
+  map.blot(4);
+  map.compact();
+
+  EXPECT_EQ(5u, map.size());
+  EXPECT_EQ(5, std::distance(map.begin(), map.end()));
+  unsigned Expected[] = {1, 2, 5, 6, 7};
+  unsigned Index = 0;
+  for (auto &Entry : map) {
+    ASSERT_TRUE(Entry.hasValue());
+    EXPECT_EQ(Expected[Index++], Entry->first);
+  }
+
+  // The map still finds and inserts elements.
+  EXPECT_EQ(7u, map.find(6)->getValue().second);
+  EXPECT_TRUE(map.find(3) == map.end());
+  map[3] = 42;
+  EXPECT_EQ(42u, map.find(3)->getValue().second);
+  EXPECT_EQ(6u, map.size());
+}
+
 // Test that filling a small dense map with exactly the number of elements in
 // the map grows to have enough space for an empty bucket.
 TEST(BlotMapVectorCustomTest, SmallBlotMapVectorGrowTest) {
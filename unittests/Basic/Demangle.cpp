@@ -11,3 +11,34 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+TEST(Demangle, NodeFactoryReuse) {
+  NodeFactory Factory;
+  for (unsigned i = 0; i < 3; ++i) {
+    {
+      NodePointer Root = demangleSymbolAsNode("_TtV1a1b", Factory);
+      ASSERT_TRUE(Root != nullptr);
+      EXPECT_EQ(Node::Kind::Global, Root->getKind());
+      EXPECT_EQ("a.b", swift::Demangle::nodeToString(Root));
+    }
+    Factory.clear();
+  }
+}
+
+TEST(Demangle, ManyChildren) {
+  NodeFactory Factory;
+  {
+    NodePointer List = Factory.createNode(Node::Kind::TypeList);
+    for (unsigned i = 0; i < 20; ++i)
+      List->addChild(Factory.createNode(Node::Kind::Index, i));
+    ASSERT_EQ(20u, List->getNumChildren());
+    for (unsigned i = 0; i < 20; ++i)
+      EXPECT_EQ(i, List->getChild(i)->getIndex());
+  }
+
+  NodePointer HeapList = NodeFactory::create(Node::Kind::TypeList);
+  for (unsigned i = 0; i < 20; ++i)
+    HeapList->addChild(NodeFactory::create(Node::Kind::Index, i));
+  unsigned Expected = 0;
+  for (auto &Child : *HeapList)
+    EXPECT_EQ(Expected++, Child->getIndex());
+}
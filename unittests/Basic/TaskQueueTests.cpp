@@ -0,0 +1,116 @@
+//===--- TaskQueueTests.cpp - for swift/Basic/TaskQueue.h -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace swift;
+using namespace swift::sys;
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+
+namespace {
+
+/// Runs each of \p Scripts with /bin/sh in its own task, and collects the
+/// output each task streamed and the output it finished with.
+struct ShellTasks {
+  llvm::DenseMap<uintptr_t, std::string> Streamed;
+  llvm::DenseMap<uintptr_t, std::string> Finished;
+  llvm::DenseMap<uintptr_t, int> ReturnCodes;
+  bool Failed;
+
+  ShellTasks(ArrayRef<const char *> Scripts, unsigned NumberOfParallelTasks) {
+    // The queue refers to the arguments until the tasks have run.
+    std::vector<std::array<const char *, 2>> Args;
+    for (const char *Script : Scripts)
+      Args.push_back({{ "-c", Script }});
+
+    TaskQueue TQ(NumberOfParallelTasks);
+    for (uintptr_t i = 0, e = Args.size(); i != e; ++i)
+      TQ.addTask("/bin/sh", llvm::makeArrayRef(Args[i].data(), Args[i].size()),
+                 llvm::None, reinterpret_cast<void *>(i));
+
+    Failed = TQ.execute(
+        nullptr,
+        [&](ProcessId Pid, int ReturnCode, StringRef Output, void *Context) {
+          auto Index = reinterpret_cast<uintptr_t>(Context);
+          Finished[Index] = Output;
+          ReturnCodes[Index] = ReturnCode;
+          EXPECT_EQ(Streamed[Index], Output.str());
+          return TaskFinishedResponse::ContinueExecution;
+        },
+        nullptr,
+        [&](ProcessId Pid, StringRef Output, void *Context) {
+          Streamed[reinterpret_cast<uintptr_t>(Context)] += Output;
+          return TaskFinishedResponse::ContinueExecution;
+        });
+  }
+};
+
+} // end anonymous namespace
+
+TEST(TaskQueue, ManyParallelTasks) {
+  // More tasks than run at once, so that pipes are added to and removed from
+  // the waiter while others are still being waited for.
+  SmallVector<std::string, 32> Scripts;
+  for (unsigned i = 0; i != 32; ++i)
+    Scripts.push_back("echo task " + std::to_string(i));
+  SmallVector<const char *, 32> ScriptArgs;
+  for (auto &Script : Scripts)
+    ScriptArgs.push_back(Script.c_str());
+
+  ShellTasks Tasks(ScriptArgs, 8);
+  EXPECT_FALSE(Tasks.Failed);
+  ASSERT_EQ(32u, Tasks.Finished.size());
+  for (unsigned i = 0; i != 32; ++i) {
+    EXPECT_EQ("task " + std::to_string(i) + "\n", Tasks.Finished[i]);
+    EXPECT_EQ(0, Tasks.ReturnCodes[i]);
+  }
+}
+
+TEST(TaskQueue, OutputLargerThanOneRead) {
+  // 200000 bytes of output take several reads of the pipe.
+  const char *Scripts[] = {
+    "i=0; while [ $i -lt 20000 ]; do echo 123456789; i=$((i+1)); done",
+    "echo short",
+  };
+
+  ShellTasks Tasks(Scripts, 2);
+  EXPECT_FALSE(Tasks.Failed);
+  ASSERT_EQ(2u, Tasks.Finished.size());
+
+  std::string Expected;
+  for (unsigned i = 0; i != 20000; ++i)
+    Expected += "123456789\n";
+  EXPECT_EQ(Expected, Tasks.Finished[0]);
+  EXPECT_EQ("short\n", Tasks.Finished[1]);
+}
+
+TEST(TaskQueue, FailingTask) {
+  const char *Scripts[] = { "echo failing; exit 3", "echo passing" };
+
+  // The finished callback asks to continue, so the failure is only reported
+  // through the return code.
+  ShellTasks Tasks(Scripts, 0);
+  EXPECT_FALSE(Tasks.Failed);
+  EXPECT_EQ("failing\n", Tasks.Finished[0]);
+  EXPECT_EQ(3, Tasks.ReturnCodes[0]);
+  EXPECT_EQ("passing\n", Tasks.Finished[1]);
+  EXPECT_EQ(0, Tasks.ReturnCodes[1]);
+}
+
+#endif
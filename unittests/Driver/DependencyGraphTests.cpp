@@ -790,3 +790,181 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, DeclHashes) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-nominal: [c]\n"
+                                 "top-level-hashes: [[a, a1], [b, b1]]\n"
+                                 "nominal-hashes: [[c, c1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i1"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-nominal: [c]"),
+            LoadResult::UpToDate);
+  EXPECT_TRUE(graph.hasDeclHashes(0));
+  EXPECT_FALSE(graph.hasDeclHashes(1));
+
+  // A change that doesn't touch any provided declaration.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-nominal: [c]\n"
+                                 "top-level-hashes: [[a, a1], [b, b1]]\n"
+                                 "nominal-hashes: [[c, c1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i2"),
+            LoadResult::UpToDate);
+
+  // A change to 'b' only.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-nominal: [c]\n"
+                                 "top-level-hashes: [[a, a1], [b, b2]]\n"
+                                 "nominal-hashes: [[c, c1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i3"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_FALSE(graph.isMarked(3));
+}
+
+TEST(DependencyGraph, DeclHashesRemovedAndUnhashed) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-dynamic-lookup: [d]\n"
+                                 "top-level-hashes: [[a, a1], [b, b1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i1"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-dynamic-lookup: [d]"),
+            LoadResult::UpToDate);
+
+  // 'a' is gone, and 'd' has no hash, so both count as changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [b]\n"
+                                 "provides-dynamic-lookup: [d]\n"
+                                 "top-level-hashes: [[b, b1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i2"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_TRUE(contains(marked, 3));
+  EXPECT_FALSE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, DeclHashesFallback) {
+  DependencyGraph<uintptr_t> graph;
+
+  // Without hashes in the previous load, every provided name counts as
+  // changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: i1"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_FALSE(graph.hasDeclHashes(0));
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "top-level-hashes: [[a, a1], [b, b1]]\n"
+                                 "interface-hash: i2"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, DirectDependents) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a, b]\n"
+                                    "provides-nominal: [c]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-nominal: [c, a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> dependents;
+  graph.getDirectDependents(dependents, 0);
+  EXPECT_EQ(2u, dependents.size());
+  EXPECT_TRUE(contains(dependents, 1));
+  EXPECT_TRUE(contains(dependents, 3));
+
+  dependents.clear();
+  graph.getDirectDependents(dependents, 1);
+  EXPECT_EQ(1u, dependents.size());
+  EXPECT_TRUE(contains(dependents, 2));
+
+  dependents.clear();
+  graph.getDirectDependents(dependents, 2);
+  EXPECT_TRUE(dependents.empty());
+  dependents.clear();
+  graph.getDirectDependents(dependents, 4);
+  EXPECT_TRUE(dependents.empty());
+
+  // Looking at the dependents doesn't mark anything.
+  EXPECT_FALSE(graph.isMarked(0));
+  EXPECT_FALSE(graph.isMarked(1));
+}
+
+TEST(DependencyGraph, DeclHashesTypeLayoutChanged) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "top-level-hashes: [[a, a1], [b, b1]]\n"
+                                 "type-layout-hash: t1\n"
+                                 "interface-hash: i1"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // 'b' is a typealias whose underlying type changed. 'a' mentions it, so
+  // everything counts as changed even though the hash of 'a' is the same.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "top-level-hashes: [[a, a1], [b, b2]]\n"
+                                 "type-layout-hash: t2\n"
+                                 "interface-hash: i2"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
@@ -1,3 +1,4 @@
+#include "swift/AST/IdentifierTable.h"
 #include "swift/Basic/LangOptions.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/Lexer.h"
@@ -352,3 +353,52 @@ TEST_F(LexerTest, NestedPlaceholder) {
   std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
+
+TEST_F(LexerTest, LongCommentsAndStrings) {
+  // Long enough that the plain text is skipped in groups of eight bytes, with
+  // the interesting characters at different offsets within a group.
+  const char *Source =
+      "// a line comment which is long enough, with é in it\n"
+      "/* a block comment /* which is nested */ and has a * and a / */\n"
+      "\"a string literal with \\(interpolation) and an \\\"escape\\\"\"\n"
+      "    \t   identifierWhichIsLongEnough_ünd_more_of_it";
+  std::vector<tok> ExpectedTokens{
+    tok::comment, tok::comment, tok::string_literal, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ("// a line comment which is long enough, with é in it\n",
+            Toks[0].getText());
+  EXPECT_EQ("/* a block comment /* which is nested */ and has a * and a / */",
+            Toks[1].getText());
+  EXPECT_EQ("\"a string literal with \\(interpolation) and an "
+            "\\\"escape\\\"\"",
+            Toks[2].getText());
+  EXPECT_EQ("identifierWhichIsLongEnough_ünd_more_of_it", Toks[3].getText());
+  EXPECT_TRUE(Toks[3].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, UnterminatedLongStringLiteral) {
+  const char *Source = "\"a string literal which doesn't end\nfoo";
+  std::vector<tok> ExpectedTokens{ tok::unknown, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("foo", Toks[1].getText());
+}
+
+TEST_F(LexerTest, IdentifierHash) {
+  const char *Source = "let caf\u00e9 = abc_$1 + `var`";
+  std::vector<tok> ExpectedTokens{
+    tok::kw_let, tok::identifier, tok::equal, tok::identifier,
+    tok::oper_binary_spaced, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+
+  // Keywords and escaped identifiers are not hashed by the lexer.
+  EXPECT_FALSE(Toks[0].hasIdentifierHash());
+  EXPECT_FALSE(Toks[5].hasIdentifierHash());
+  for (unsigned i : {1, 3}) {
+    ASSERT_TRUE(Toks[i].hasIdentifierHash());
+    EXPECT_EQ(IdentifierTable::hashText(Toks[i].getText()),
+              Toks[i].getIdentifierHash());
+  }
+}
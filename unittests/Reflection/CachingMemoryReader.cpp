@@ -0,0 +1,133 @@
+//===--- CachingMemoryReader.cpp - CachingMemoryReader tests --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Remote/CachingMemoryReader.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace swift;
+using namespace remote;
+
+namespace {
+
+/// Presents a local buffer as remote memory at address 0 and counts the
+/// reads made from it.
+class BufferMemoryReader : public MemoryReader {
+public:
+  std::vector<uint8_t> Memory;
+  unsigned NumReads = 0;
+
+  BufferMemoryReader(size_t size) : Memory(size) {
+    for (size_t i = 0; i < size; ++i)
+      Memory[i] = uint8_t(i * 7 + 1);
+  }
+
+  uint8_t getPointerSize() override { return sizeof(void *); }
+  uint8_t getSizeSize() override { return sizeof(size_t); }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return RemoteAddress(uint64_t(0));
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++NumReads;
+    uint64_t addr = address.getAddressData();
+    if (addr > Memory.size() || size > Memory.size() - addr)
+      return false;
+    memcpy(dest, Memory.data() + addr, size);
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    ++NumReads;
+    uint64_t addr = address.getAddressData();
+    std::string result;
+    for (; addr < Memory.size() && Memory[addr]; ++addr)
+      result += char(Memory[addr]);
+    if (addr == Memory.size())
+      return false;
+    dest = result;
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+TEST(CachingMemoryReaderTest, ReadsArePageGranular) {
+  auto Buffer = std::make_shared<BufferMemoryReader>(256);
+  CachingMemoryReader Reader(Buffer, /*pageSize*/ 64);
+
+  uint32_t Value;
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(4)), &Value));
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(8)), &Value));
+  EXPECT_EQ(1u, Buffer->NumReads);
+
+  // A read spanning a page boundary reads the next page.
+  uint8_t Bytes[16];
+  ASSERT_TRUE(Reader.readBytes(RemoteAddress(uint64_t(56)), Bytes, 16));
+  EXPECT_EQ(2u, Buffer->NumReads);
+  EXPECT_EQ(0, memcmp(Bytes, Buffer->Memory.data() + 56, 16));
+}
+
+TEST(CachingMemoryReaderTest, UnreadablePages) {
+  auto Buffer = std::make_shared<BufferMemoryReader>(100);
+  CachingMemoryReader Reader(Buffer, /*pageSize*/ 64);
+
+  // The second page is cut off, but the bytes before its end are readable.
+  uint8_t Bytes[8];
+  EXPECT_TRUE(Reader.readBytes(RemoteAddress(uint64_t(90)), Bytes, 8));
+  EXPECT_EQ(0, memcmp(Bytes, Buffer->Memory.data() + 90, 8));
+  EXPECT_FALSE(Reader.readBytes(RemoteAddress(uint64_t(96)), Bytes, 8));
+}
+
+TEST(CachingMemoryReaderTest, ReadString) {
+  auto Buffer = std::make_shared<BufferMemoryReader>(256);
+  const char Name[] = "a string which crosses a page boundary";
+  memcpy(Buffer->Memory.data() + 50, Name, sizeof(Name));
+  CachingMemoryReader Reader(Buffer, /*pageSize*/ 64);
+
+  std::string Result;
+  ASSERT_TRUE(Reader.readString(RemoteAddress(uint64_t(50)), Result));
+  EXPECT_EQ(Name, Result);
+  EXPECT_EQ(2u, Buffer->NumReads);
+}
+
+TEST(CachingMemoryReaderTest, PrefetchAndInvalidate) {
+  auto Buffer = std::make_shared<BufferMemoryReader>(256);
+  CachingMemoryReader Reader(Buffer, /*pageSize*/ 64);
+
+  ASSERT_TRUE(Reader.prefetch(RemoteAddress(uint64_t(10)), 200));
+  EXPECT_EQ(1u, Buffer->NumReads);
+
+  uint8_t Byte;
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(200)), &Byte));
+  EXPECT_EQ(1u, Buffer->NumReads);
+
+  // Changed memory is only seen after invalidating it.
+  Buffer->Memory[200] = 0;
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(200)), &Byte));
+  EXPECT_NE(0, Byte);
+  Reader.invalidate(RemoteAddress(uint64_t(200)), 1);
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(200)), &Byte));
+  EXPECT_EQ(0, Byte);
+  EXPECT_EQ(2u, Buffer->NumReads);
+
+  // Other pages stay cached.
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(0)), &Byte));
+  EXPECT_EQ(2u, Buffer->NumReads);
+
+  Reader.invalidateAll();
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(0)), &Byte));
+  EXPECT_EQ(3u, Buffer->NumReads);
+}
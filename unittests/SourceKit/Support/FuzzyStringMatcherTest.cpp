@@ -51,6 +51,22 @@ TEST(FuzzyStringMatcher, SingleCharacterMatching) {
   EXPECT_FALSE(FuzzyStringMatcher("a").matchesCandidate(""));
 }
 
+TEST(FuzzyStringMatcher, CharacterMask) {
+  auto mayMatch = [](const char *pattern, const char *candidate) {
+    return FuzzyStringMatcher(pattern).mayMatchCandidate(
+        FuzzyStringMatcher::getCharacterMask(candidate));
+  };
+  EXPECT_TRUE(mayMatch("ASDF", "a_s_d_f"));
+  EXPECT_TRUE(mayMatch("asDf", "xASDF"));
+  EXPECT_TRUE(mayMatch("fdsa", "asdf")); // Order is not checked.
+  EXPECT_TRUE(mayMatch("", ""));
+  EXPECT_TRUE(mayMatch("a1_", "A_1"));
+  EXPECT_FALSE(mayMatch("asdf", "asd"));
+  EXPECT_FALSE(mayMatch("a", ""));
+  EXPECT_FALSE(mayMatch("a1", "a2"));
+  EXPECT_FALSE(mayMatch("a_", "a"));
+}
+
 TEST(FuzzyStringMatcher, UnicodeMatching) {
   // Single code point matching.
   EXPECT_TRUE(FuzzyStringMatcher(u8"\u2602a\U0002000Bz")
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/ImmutableTextBuffer.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace SourceKit;
@@ -43,3 +44,34 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, ReplaceAll) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "hello");
+
+  EdBuf->insert(5, " world");
+  EdBuf->replace(0, 11, "goodbye");
+  EdBuf->erase(0, 4);
+  ImmutableTextBufferRef Buf = EdBuf->getBuffer();
+  EXPECT_EQ(Buf->getText(), "bye");
+  EXPECT_EQ(Buf->getInternalBuffer()->getBufferEnd()[0], '\0');
+
+  Buf = EdBuf->erase(0, 3)->getBuffer();
+  EXPECT_EQ(Buf->getText(), "");
+}
+
+TEST(EditableTextBuffer, LineAndColumn) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "a\nbc\n");
+  ImmutableTextBufferRef Buf = EdBuf->getBuffer();
+
+  EXPECT_EQ(Buf->getLineAndColumn(0), std::make_pair(1U, 1U));
+  EXPECT_EQ(Buf->getLineAndColumn(1), std::make_pair(1U, 2U));
+  EXPECT_EQ(Buf->getLineAndColumn(2), std::make_pair(2U, 1U));
+  EXPECT_EQ(Buf->getLineAndColumn(4), std::make_pair(2U, 3U));
+  EXPECT_EQ(Buf->getLineAndColumn(5), std::make_pair(3U, 1U));
+  EXPECT_EQ(Buf->getLineAndColumn(6), std::make_pair(0U, 0U));
+
+  Buf = EdBuf->insert(0, "\n")->getBuffer();
+  EXPECT_EQ(Buf->getLineAndColumn(3), std::make_pair(3U, 1U));
+}
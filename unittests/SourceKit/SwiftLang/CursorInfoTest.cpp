@@ -92,6 +92,7 @@ struct TestCursorInfo {
   std::string Typename;
   std::string Filename;
   Optional<std::pair<unsigned, unsigned>> DeclarationLoc;
+  bool IsCancelled = false;
 };
 
 class CursorInfoTest : public ::testing::Test {
@@ -123,20 +124,26 @@ public:
     getLang().editorReplaceText(DocName, Buf.get(), Offset, Length, Consumer);
   }
 
-  TestCursorInfo getCursor(const char *DocName, unsigned Offset,
-                           ArrayRef<const char *> CArgs) {
+  void getCursorAsync(const char *DocName, unsigned Offset,
+                      ArrayRef<const char *> CArgs, TestCursorInfo &TestInfo,
+                      Semaphore &sema) {
     auto Args = makeArgs(DocName, CArgs);
-    Semaphore sema(0);
-
-    TestCursorInfo TestInfo;
     getLang().getCursorInfo(DocName, Offset, Args,
       [&](const CursorInfo &Info) {
         TestInfo.Name = Info.Name;
         TestInfo.Typename = Info.TypeName;
         TestInfo.Filename = Info.Filename;
         TestInfo.DeclarationLoc = Info.DeclarationLoc;
+        TestInfo.IsCancelled = Info.IsCancelled;
         sema.signal();
       });
+  }
+
+  TestCursorInfo getCursor(const char *DocName, unsigned Offset,
+                           ArrayRef<const char *> CArgs) {
+    Semaphore sema(0);
+    TestCursorInfo TestInfo;
+    getCursorAsync(DocName, Offset, CArgs, TestInfo, sema);
 
     bool expired = sema.wait(60 * 1000);
     if (expired)
@@ -339,3 +346,36 @@ TEST_F(CursorInfoTest, CursorInfoMustWaitDueToken) {
   EXPECT_EQ(FooOffs, Info.DeclarationLoc->first);
   EXPECT_EQ(strlen("fog"), Info.DeclarationLoc->second);
 }
+
+TEST_F(CursorInfoTest, EditDuringBuild) {
+  const char *DocName = "/test.swift";
+  const char *Contents =
+    "let value = foo\n"
+    "let foo = [0:0,0:0,0:0,0:0,0:0,0:0,0:0]\n";
+  const char *Args[] = { "-parse-as-library" };
+
+  open(DocName, Contents);
+  auto FooRefOffs = findOffset("foo", Contents);
+  auto FooOffs = findOffset("foo =", Contents);
+
+  // Start building the AST, then edit the file while it's being built.
+  Semaphore sema(0);
+  TestCursorInfo FirstInfo;
+  getCursorAsync(DocName, FooRefOffs, Args, FirstInfo, sema);
+  replaceText(DocName, FooOffs, strlen("foo"), "foo");
+
+  // The build for the first request is cancelled if it's still running, but
+  // the second request mustn't get stuck waiting for it.
+  auto Info = getCursor(DocName, FooRefOffs, Args);
+  EXPECT_STREQ("foo", Info.Name.c_str());
+  EXPECT_STREQ("[Int : Int]", Info.Typename.c_str());
+
+  bool expired = sema.wait(60 * 1000);
+  if (expired)
+    llvm::report_fatal_error("check took too long");
+  // The second request replaces the first one if it's still queued.
+  if (!FirstInfo.IsCancelled) {
+    EXPECT_STREQ("foo", FirstInfo.Name.c_str());
+    EXPECT_STREQ("[Int : Int]", FirstInfo.Typename.c_str());
+  }
+}
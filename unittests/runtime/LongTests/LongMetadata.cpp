@@ -0,0 +1,110 @@
+//===--- LongMetadata.cpp - Metadata instantiation throughput -------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Metadata.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+/// The general structure of a generic metadata.
+template <typename Instance>
+struct GenericMetadataTest {
+  GenericMetadata Header;
+  Instance Template;
+};
+
+static uint32_t Descriptor = 0;
+
+/// The distinct generic arguments that are instantiated.
+static const unsigned NumArguments = 256;
+static uint32_t Arguments[NumArguments];
+
+/// The number of lookups each thread performs.
+static const unsigned LookupsPerThread = 200000;
+
+/// Create a fresh pattern, with an empty cache, for a single-argument
+/// generic struct. The instantiated metadata lives in the pattern's cache, so
+/// patterns are never freed.
+static GenericMetadata *createPattern() {
+  auto pattern = new GenericMetadataTest<StructMetadata>{
+      // Header
+      {
+        // allocation function
+        [](GenericMetadata *pattern, const void *args) -> Metadata * {
+          auto metadata = swift_allocateGenericValueMetadata(pattern, args);
+          auto metadataWords = reinterpret_cast<const void**>(metadata);
+          auto argsWords = reinterpret_cast<const void* const*>(args);
+          metadataWords[2] = argsWords[0];
+          return metadata;
+        },
+        3 * sizeof(void*), // metadata size
+        1, // num arguments
+        0, // address point
+        nullptr, // prespecializations
+        {} // private data
+      },
+
+      // Fields
+      {
+        MetadataKind::Struct,
+        reinterpret_cast<const NominalTypeDescriptor*>(&Descriptor),
+        nullptr
+      }
+    };
+  return &pattern->Header;
+}
+
+/// Look up metadata for every argument in a different order on each thread.
+/// The first time a thread sees an argument, it checks that it got the same
+/// instance as every other thread.
+static void lookUpMetadata(GenericMetadata *pattern, unsigned seed,
+                           std::atomic<const Metadata *> *seen) {
+  for (unsigned i = 0; i < LookupsPerThread; ++i) {
+    unsigned index = (i * 31 + seed * 17) % NumArguments;
+    const void *args[] = { &Arguments[index] };
+    auto inst = swift_getGenericMetadata(pattern, args);
+
+    if (i < NumArguments) {
+      auto fields = reinterpret_cast<void * const *>(inst);
+      EXPECT_EQ(&Arguments[index], fields[2]);
+
+      const Metadata *expected = nullptr;
+      if (!seen[index].compare_exchange_strong(expected, inst))
+        EXPECT_EQ(expected, inst);
+    }
+  }
+}
+
+TEST(LongMetadataTest, getGenericMetadataThroughput) {
+  for (unsigned threadCount : { 1, 2, 4, 8, 16, 32, 64 }) {
+    auto pattern = createPattern();
+    std::atomic<const Metadata *> seen[NumArguments] = {};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t)
+      threads.emplace_back(lookUpMetadata, pattern, t, seen);
+    for (auto &thread : threads)
+      thread.join();
+    auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start).count();
+
+    double lookups = double(LookupsPerThread) * threadCount;
+    printf("%2u threads: %10.0f lookups/s (%.3fs)\n",
+           threadCount, lookups / elapsed, elapsed);
+  }
+}
@@ -181,6 +181,7 @@ GenericMetadataTest<StructMetadata> MetadataTest1 = {
     3 * sizeof(void*), // metadata size
     1, // num arguments
     0, // address point
+    nullptr, // prespecializations
     {} // private data
   },
 
@@ -290,6 +291,82 @@ TEST(MetadataTest, getGenericMetadata) {
     });
 }
 
+/// A statically instantiated cache entry for MetadataTest3, laid out like
+/// the entries which the runtime allocates: the key arguments, the entry
+/// header and the metadata.
+struct {
+  const void *Arguments[1];
+  const Metadata *Value;
+  size_t NumArguments;
+  StructMetadata Metadata;
+} PrespecializedEntry = {
+  { &Global2 },
+  &PrespecializedEntry.Metadata,
+  1,
+  {
+    MetadataKind::Struct,
+    reinterpret_cast<const NominalTypeDescriptor*>(&Global1),
+    nullptr
+  }
+};
+
+void *PrespecializedEntries[] = { &PrespecializedEntry.Value, nullptr };
+
+GenericMetadataTest<StructMetadata> MetadataTest3 = {
+  // Header
+  {
+    // allocation function
+    [](GenericMetadata *pattern, const void *args) -> Metadata * {
+      auto metadata = swift_allocateGenericValueMetadata(pattern, args);
+      auto metadataWords = reinterpret_cast<const void**>(metadata);
+      auto argsWords = reinterpret_cast<const void* const*>(args);
+      metadataWords[2] = argsWords[0];
+      return metadata;
+    },
+    3 * sizeof(void*), // metadata size
+    1, // num arguments
+    0, // address point
+    PrespecializedEntries, // prespecializations
+    {} // private data
+  },
+
+  // Fields
+  {
+    MetadataKind::Struct,
+    reinterpret_cast<const NominalTypeDescriptor*>(&Global1),
+    nullptr
+  }
+};
+
+TEST(MetadataTest, getGenericMetadataPrespecialized) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest3;
+
+  void *args[] = { &Global2 };
+
+  // The statically emitted instantiation is used as is.
+  RaceTest_ExpectEqual<const Metadata *>(
+    [&]() -> const Metadata * {
+      auto inst = swift_getGenericMetadata(metadataTemplate, args);
+      EXPECT_EQ(&PrespecializedEntry.Metadata, inst);
+      return inst;
+    });
+
+  // Other arguments are still instantiated from the pattern.
+  args[0] = &Global3;
+
+  RaceTest_ExpectEqual<const Metadata *>(
+    [&]() -> const Metadata * {
+      auto inst = static_cast<const StructMetadata*>
+        (swift_getGenericMetadata(metadataTemplate, args));
+      EXPECT_NE(&PrespecializedEntry.Metadata, inst);
+
+      auto fields = reinterpret_cast<void * const *>(inst);
+      EXPECT_EQ(&Global3, fields[2]);
+
+      return inst;
+    });
+}
+
 FullMetadata<ClassMetadata> MetadataTest2 = {
   { { nullptr }, { &_TWVBo } },
   { { { MetadataKind::Class } }, nullptr, /*rodata*/ 1,
@@ -575,6 +652,7 @@ struct {
     sizeof(GenericSubclass.Pattern) + sizeof(GenericSubclass.Suffix), // pattern size
     1, // num arguments
     sizeof(HeapMetadataHeader), // address point
+    nullptr, // prespecializations
     {} // private data
   },
   { { { &destroySubclass }, { &_TWVBo } },
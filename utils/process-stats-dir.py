@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+# utils/process-stats-dir.py - Summarize -stats-output-dir -*- python -*-
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+
+# Reads the JSON files which the driver and frontend jobs write to the
+# directory given with -stats-output-dir, and prints the sum of each timer
+# and counter over all jobs, or one CSV row per job.
+
+from __future__ import print_function
+
+import argparse
+import csv
+import json
+import os
+import sys
+
+
+def flatten(record):
+    """Return the numeric fields of a job's record, with the LLVM statistics
+    prefixed by "llvm."
+    """
+    values = {}
+    for key, value in record.items():
+        if key == 'llvm':
+            for name, count in value.items():
+                values['llvm.' + name] = count
+        elif isinstance(value, (int, float)):
+            values[key] = value
+    return values
+
+
+def load_records(directories):
+    """Yield the (program, job, values) of each stats file"""
+    for directory in directories:
+        for root, dirs, files in os.walk(directory):
+            for filename in sorted(files):
+                if not (filename.startswith('stats-') and
+                        filename.endswith('.json')):
+                    continue
+                with open(os.path.join(root, filename)) as f:
+                    record = json.load(f)
+                yield (record.get('program', ''), record.get('job', ''),
+                       flatten(record))
+
+
+def merge(records):
+    """Sum up the values of all records, counting the jobs of each program.
+    Memory peaks are combined with max instead.
+    """
+    merged = {}
+    for program, _, values in records:
+        key = 'Jobs.' + program
+        merged[key] = merged.get(key, 0) + 1
+        for name, value in values.items():
+            if name.startswith('Memory.'):
+                merged[name] = max(merged.get(name, 0), value)
+            else:
+                merged[name] = merged.get(name, 0) + value
+    return merged
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Summarize the statistics written with -stats-output-dir')
+    parser.add_argument(
+        '--by-job', action='store_true',
+        help='print one CSV row per job instead of the sum over all jobs')
+    parser.add_argument(
+        '--filter', default='',
+        help='only print the values whose names start with this prefix')
+    parser.add_argument('directories', nargs='+', help='stats directories')
+    args = parser.parse_args()
+
+    records = list(load_records(args.directories))
+    if not records:
+        print('no stats files found', file=sys.stderr)
+        return 1
+
+    if args.by_job:
+        names = sorted(set(name for _, _, values in records
+                           for name in values
+                           if name.startswith(args.filter)))
+        writer = csv.writer(sys.stdout)
+        writer.writerow(['program', 'job'] + names)
+        for program, job, values in records:
+            writer.writerow([program, job] +
+                            [values.get(name, 0) for name in names])
+        return 0
+
+    merged = merge(records)
+    json.dump(dict((name, value) for name, value in merged.items()
+                   if name.startswith(args.filter)),
+              sys.stdout, indent=2, sort_keys=True)
+    print()
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+# swift-demangle-throughput.py - Measure swift-demangle throughput -*- python -*-
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ----------------------------------------------------------------------------
+#
+# Builds a large symbolication-style input out of the demangler test corpus
+# and reports how many megabytes per second swift-demangle gets through it,
+# once for each requested thread count. With --min-mb-per-sec the script
+# fails if any run is slower than the given rate, so it can be used to catch
+# throughput regressions.
+#
+# ----------------------------------------------------------------------------
+
+from __future__ import print_function
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+SWIFT_SOURCE_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_CORPUS = os.path.join(SWIFT_SOURCE_ROOT, 'test', 'Demangle', 'Inputs',
+                              'manglings.txt')
+
+
+def make_input(corpus, size_mb):
+    """Write a temporary file of roughly size_mb megabytes in which every
+    mangled name from the corpus appears embedded in a line of noise, the way
+    it would in a crash log or profile."""
+    symbols = []
+    with open(corpus) as f:
+        for line in f:
+            if '--->' in line:
+                symbols.append(line.split('--->')[0].strip())
+
+    out = tempfile.NamedTemporaryFile(mode='w', suffix='.txt', delete=False)
+    target = size_mb * 1024 * 1024
+    written = 0
+    frame = 0
+    while written < target:
+        for symbol in symbols:
+            line = '%-4d libswiftCore.dylib 0x%016x %s + %d\n' % (
+                frame % 64, 0x100000000 + frame * 16, symbol, frame % 997)
+            out.write(line)
+            written += len(line)
+            frame += 1
+    out.close()
+    return out.name, written
+
+
+def measure(swift_demangle, input_path, threads, repeat):
+    """Return the best wall-clock time in seconds over `repeat` runs."""
+    command = [swift_demangle]
+    if threads:
+        command.append('-num-threads=%d' % threads)
+    best = None
+    with open(os.devnull, 'w') as devnull:
+        for _ in range(repeat):
+            with open(input_path) as stdin:
+                start = time.time()
+                subprocess.check_call(command, stdin=stdin, stdout=devnull)
+                elapsed = time.time() - start
+            if best is None or elapsed < best:
+                best = elapsed
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure the throughput of swift-demangle on standard '
+                    'input.')
+    parser.add_argument(
+        'swift_demangle', metavar='<swift-demangle>',
+        help='path to the swift-demangle binary to measure')
+    parser.add_argument(
+        '--corpus', default=DEFAULT_CORPUS, metavar='<path>',
+        help='manglings file in the format of test/Demangle/Inputs/'
+             'manglings.txt (default: %(default)s)')
+    parser.add_argument(
+        '--size-mb', type=int, default=64, metavar='<n>',
+        help='approximate size of the generated input (default: %(default)s)')
+    parser.add_argument(
+        '--threads', default='0,1,2,4,8', metavar='<n,n,...>',
+        help='comma-separated -num-threads values to measure; 0 selects the '
+             'line-at-a-time mode (default: %(default)s)')
+    parser.add_argument(
+        '--repeat', type=int, default=3, metavar='<n>',
+        help='number of runs per configuration; the fastest is reported '
+             '(default: %(default)s)')
+    parser.add_argument(
+        '--min-mb-per-sec', type=float, default=None, metavar='<rate>',
+        help='exit with an error if any configuration is slower than this')
+    args = parser.parse_args()
+
+    input_path, size = make_input(args.corpus, args.size_mb)
+    failed = False
+    try:
+        print('%-10s %10s %10s' % ('threads', 'seconds', 'MB/s'))
+        for threads in [int(t) for t in args.threads.split(',')]:
+            seconds = measure(args.swift_demangle, input_path, threads,
+                              args.repeat)
+            rate = size / (1024.0 * 1024.0) / seconds
+            print('%-10d %10.3f %10.1f' % (threads, seconds, rate))
+            if args.min_mb_per_sec is not None and rate < args.min_mb_per_sec:
+                failed = True
+    finally:
+        os.unlink(input_path)
+
+    if failed:
+        print('error: throughput below %.1f MB/s' % args.min_mb_per_sec,
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,75 @@
+#include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace swift;
+
+/// Calls \p fn \p iterations times and prints the nanoseconds per call.
+template <class Fn>
+static void measure(const char *name, size_t numBits, unsigned iterations,
+                    Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  size_t sink = 0;
+  for (unsigned i = 0; i != iterations; ++i)
+    sink += fn();
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+    std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+  llvm::outs() << name << " " << numBits << " bits: "
+               << llvm::format("%.1f", ns) << " ns (" << (sink & 1) << ")\n";
+}
+
+static ClusteredBitVector makePattern(size_t numBits, unsigned seed) {
+  ClusteredBitVector result;
+  while (result.size() < numBits) {
+    auto n = std::min(numBits - result.size(), size_t(1 + seed % 13));
+    if (seed & 1)
+      result.appendSetBits(n);
+    else
+      result.appendClearBits(n);
+    seed = seed * 1103515245 + 12345;
+  }
+  return result;
+}
+
+// Times the operations which enum layout performs most often, on vectors of
+// several sizes.
+int main() {
+  const unsigned iterations = 200000;
+  for (size_t numBits : {24, 64, 129, 512, 4096}) {
+    auto a = makePattern(numBits, 1);
+    auto b = makePattern(numBits, 2);
+
+    measure("append-constant", numBits, iterations, [&] {
+      ClusteredBitVector v;
+      v.appendClearBits(3);
+      v.appendSetBits(numBits);
+      return v.size();
+    });
+    measure("append-unaligned", numBits, iterations, [&] {
+      ClusteredBitVector v;
+      v.appendSetBits(5);
+      v.append(a);
+      return v.size();
+    });
+    measure("and-or", numBits, iterations, [&] {
+      ClusteredBitVector v = a;
+      v &= b;
+      v |= a;
+      return v.count();
+    });
+    measure("enumerate", numBits, iterations, [&] {
+      size_t sum = 0;
+      auto e = a.enumerateSetBits();
+      while (auto i = e.findNext())
+        sum += *i;
+      return sum;
+    });
+    auto apint = a.asAPInt();
+    measure("from-apint", numBits, iterations, [&] {
+      return ClusteredBitVector::fromAPInt(apint).size();
+    });
+  }
+}
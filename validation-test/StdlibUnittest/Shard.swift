@@ -0,0 +1,49 @@
+// RUN: %target-build-swift %s -o %t.out
+// RUN: %target-run %t.out --stdlib-unittest-shard 0/2 | %FileCheck --check-prefix=CHECK-0 %s
+// RUN: %target-run %t.out --stdlib-unittest-shard 1/2 | %FileCheck --check-prefix=CHECK-1 %s
+// RUN: %target-run %t.out --stdlib-unittest-filter b --stdlib-unittest-shard 1/2 | %FileCheck --check-prefix=CHECK-FILTER %s
+// REQUIRES: executable_test
+
+// CHECK-0: StdlibUnittest: running shard 0 of 2{{$}}
+// CHECK-0-NOT: Shard.b
+// CHECK-0: [       OK ] Shard.a{{$}}
+// CHECK-0-NOT: Shard.b
+// CHECK-0: [       OK ] Shard.c{{$}}
+// CHECK-0-NOT: Shard.b
+// CHECK-0: Shard: All tests passed
+
+// CHECK-1: StdlibUnittest: running shard 1 of 2{{$}}
+// CHECK-1-NOT: Shard.a
+// CHECK-1: [       OK ] Shard.b{{$}}
+// CHECK-1-NOT: Shard.c
+// CHECK-1: [       OK ] Shard.bd{{$}}
+// CHECK-1-NOT: Shard.c
+// CHECK-1: Shard: All tests passed
+
+// CHECK-FILTER: StdlibUnittest: running shard 1 of 2{{$}}
+// CHECK-FILTER-NOT: Shard.b{{$}}
+// CHECK-FILTER: [       OK ] Shard.bd{{$}}
+// CHECK-FILTER: Shard: All tests passed
+
+import StdlibUnittest
+
+
+var ShardTestSuite = TestSuite("Shard")
+
+ShardTestSuite.test("a") {
+  expectEqual(1, 1)
+}
+
+ShardTestSuite.test("b") {
+  expectEqual(1, 1)
+}
+
+ShardTestSuite.test("c") {
+  expectEqual(1, 1)
+}
+
+ShardTestSuite.test("bd") {
+  expectEqual(1, 1)
+}
+
+runAllTests()
@@ -88,6 +88,28 @@ HashingTestSuite.test("_squeezeHashValue/Int") {
   checkRange(16)
 }
 
+HashingTestSuite.test("_combineHashValues/GoldenValues") {
+#if arch(i386) || arch(arm)
+  expectEqual(Int(bitPattern: 0x8dc4_164d), _combineHashValues(0, 0))
+#elseif arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+  expectEqual(Int(bitPattern: 0xb2b2_4f68_8dc4_164d),
+              _combineHashValues(0, 0))
+  expectEqual(Int(bitPattern: 0x7cd7_d06c_54e5_e1aa),
+              _combineHashValues(1, 2))
+  expectEqual(Int(bitPattern: 0x5629_0b56_af01_5649),
+              _combineHashValues(2, 1))
+  expectEqual(Int(bitPattern: 0x9f71_565d_899d_bd2f),
+              _combineHashValues(-1, -1))
+#else
+  fatalError("unimplemented")
+#endif
+}
+
+HashingTestSuite.test("_combineHashValues/order") {
+  expectNotEqual(_combineHashValues(1, 2), _combineHashValues(2, 1))
+  expectNotEqual(0, _combineHashValues(42, 42))
+}
+
 HashingTestSuite.test("String/hashValue/topBitsSet") {
 #if _runtime(_ObjC)
 #if arch(x86_64) || arch(arm64)